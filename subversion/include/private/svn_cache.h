@@ -33,6 +33,7 @@
 
 #include "svn_types.h"
 #include "svn_error.h"
+#include "svn_io.h"
 #include "svn_iter.h"
 #include "svn_config.h"
 #include "svn_string.h"
@@ -310,6 +311,28 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
                                   svn_boolean_t allow_blocking_writes,
                                   apr_pool_t *result_pool);
 
+/**
+ * Like svn_cache__membuffer_cache_create(), but place the cache in an
+ * anonymous shared memory segment and synchronize all access with
+ * cross-process locks, so that the creating process and every process
+ * fork()ed off it after this call share one cache.  The result is
+ * always thread-safe and writers wait for the lock, hence there are no
+ * @a thread_safe and @a allow_blocking_writes parameters.
+ *
+ * Attaching processes that are not descendants of the creator is not
+ * supported.  Returns an error on platforms without anonymous shared
+ * memory or cross-process mutexes; callers should then fall back to a
+ * per-process cache.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         apr_pool_t *result_pool);
+
 /**
  * @defgroup Standard priority classes for #svn_cache__create_membuffer_cache.
  * @{
@@ -378,6 +401,27 @@ svn_cache__create_membuffer_cache(svn_cache__t **cache_p,
                                   apr_pool_t *result_pool,
                                   apr_pool_t *scratch_pool);
 
+/**
+ * Creates a two-level cache in @a *cache_p, allocated in @a result_pool,
+ * composing the fully constructed caches @a front and @a back.  Both
+ * tiers must use the same key length and value (de-)serialization;
+ * typically @a front is a small, fast cache (e.g. a membuffer cache)
+ * and @a back a large, slower one (e.g. memcached).
+ *
+ * Reads query @a front first and fall back to @a back; hits in @a back
+ * get promoted into @a front.  Writes go through to both tiers, so data
+ * evicted from @a front can still be served from @a back.
+ *
+ * These caches do not support svn_cache__iter.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_cache__create_two_level(svn_cache__t **cache_p,
+                            svn_cache__t *front,
+                            svn_cache__t *back,
+                            apr_pool_t *result_pool);
+
 /**
  * Creates a null-cache instance in @a *cache_p, allocated from
  * @a result_pool.  The given @c id is the only data stored in it and can
@@ -433,6 +477,26 @@ svn_cache__get(void **value,
                const void *key,
                apr_pool_t *result_pool);
 
+/**
+ * Fetches the values indexed by the @a count elements of @a keys from
+ * @a cache into @a values, setting the corresponding @a found elements
+ * to TRUE for all entries found in the cache.  @a values[i] will be
+ * NULL and @a found[i] FALSE for all entries not found; individual
+ * @a keys elements may be NULL and are guaranteed misses.  The values
+ * are copied into @a result_pool using the deserialize function
+ * provided to the cache's constructor.
+ *
+ * This is equivalent to @a count calls to svn_cache__get() but backends
+ * may process the whole batch with less synchronization overhead.
+ */
+svn_error_t *
+svn_cache__get_many(void **values,
+                    svn_boolean_t *found,
+                    svn_cache__t *cache,
+                    const void *const *keys,
+                    apr_size_t count,
+                    apr_pool_t *result_pool);
+
 /**
  * Looks for an entry indexed by @a key in @a cache,  setting @a *found
  * to TRUE if an entry has been found and FALSE otherwise.  @a key may be
@@ -464,6 +528,25 @@ svn_cache__set(svn_cache__t *cache,
                void *value,
                apr_pool_t *scratch_pool);
 
+/**
+ * Same as svn_cache__set() but use the eviction @a priority given here
+ * for this entry instead of the priority class that @a cache has been
+ * created with.  See #SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY etc.
+ *
+ * Use this when the cost of re-creating individual entries varies a lot
+ * within the same cache, e.g. to make cheap-to-rebuild entries yield to
+ * expensive ones under memory pressure.  Caches that do not support
+ * per-entry priorities simply behave like svn_cache__set().
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_cache__set_with_priority(svn_cache__t *cache,
+                             const void *key,
+                             void *value,
+                             apr_uint32_t priority,
+                             apr_pool_t *scratch_pool);
+
 /**
  * Iterates over the elements currently in @a cache, calling @a func
  * for each one until there are no more elements or @a func returns an
@@ -544,6 +627,31 @@ svn_cache__format_info(const svn_cache__info_t *info,
                        svn_boolean_t access_only,
                        apr_pool_t *result_pool);
 
+/**
+ * Write a plain-text report on all cache instances created by this
+ * process to @a stream: per-instance (i.e. per-namespace) access and
+ * hit-rate statistics, followed by the aggregated size, fill-level and
+ * occupancy-histogram data of the global membuffer cache, if any.
+ * Instances that never saw any access are omitted.  Use
+ * @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_cache__write_stats_report(svn_stream_t *stream,
+                              apr_pool_t *scratch_pool);
+
+/**
+ * If the SVN_CACHE_STATS environment variable names a file, write the
+ * report of svn_cache__write_stats_report() to that file.  Errors are
+ * silently ignored; this is a pure diagnostic aid and must never affect
+ * the host process' outcome.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_cache__maybe_write_stats_report(apr_pool_t *scratch_pool);
+
 /**
  * Access the process-global (singleton) membuffer cache. The first call
  * will automatically allocate the cache using the current cache config.
@@ -554,6 +662,19 @@ svn_cache__format_info(const svn_cache__info_t *info,
 struct svn_membuffer_t *
 svn_cache__get_global_membuffer_cache(void);
 
+/**
+ * Request that the global membuffer cache be placed in shared memory,
+ * such that all processes fork()ed off after its creation share it (see
+ * svn_cache__membuffer_cache_create_shared()).  Must be called before
+ * the first call to svn_cache__get_global_membuffer_cache() and has no
+ * effect afterwards.  Where shared memory is not available, the global
+ * cache silently remains process-local.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_cache__set_global_membuffer_cache_shared(void);
+
 /**
  * Return total access and size stats over all membuffer caches as they
  * share the underlying data buffer.  The result will be allocated in POOL.
@@ -570,6 +691,31 @@ svn_cache__membuffer_get_global_info(apr_pool_t *pool);
 svn_error_t *
 svn_cache__membuffer_clear(svn_membuffer_t *cache);
 
+/**
+ * Write a warm-start image of all current contents of @a cache to the
+ * file at @a path, replacing any previous file at that location
+ * atomically.  Use @a scratch_pool for temporary allocations.
+ *
+ * The image is specific to machine and build; it can only be read back
+ * by a compatible process via svn_cache__membuffer_load_image().
+ */
+svn_error_t *
+svn_cache__membuffer_dump_image(svn_membuffer_t *cache,
+                                const char *path,
+                                apr_pool_t *scratch_pool);
+
+/**
+ * Populate @a cache from the warm-start image file at @a path, written
+ * by a previous call to svn_cache__membuffer_dump_image().  Entries are
+ * added through the standard insertion path, i.e. the configuration of
+ * @a cache may differ from the cache that wrote the image.  Use
+ * @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_cache__membuffer_load_image(svn_membuffer_t *cache,
+                                const char *path,
+                                apr_pool_t *scratch_pool);
+
 /** @} */
 
 
@@ -108,6 +108,70 @@ svn_txdelta__read_raw_window_len(apr_size_t *window_len,
                                  svn_stream_t *stream,
                                  apr_pool_t *pool);
 
+/** Same as svn_txdelta2(), but compute windows of @a window_size bytes
+ * instead of the standard 100 KB.  @a window_size is clamped to the range
+ * our svndiff decoders accept (100 KB to 16 MB).
+ *
+ * Note that svndiff decoders of previous releases reject windows larger
+ * than the standard size, so large windows must only be sent to peers
+ * and stored in repositories known to be read by this release or newer.
+ */
+void
+svn_txdelta__sized(svn_txdelta_stream_t **stream,
+                   svn_stream_t *source,
+                   svn_stream_t *target,
+                   svn_boolean_t calculate_checksum,
+                   apr_size_t window_size,
+                   apr_pool_t *pool);
+
+/** Same as svn_txdelta2(), but if threading is available, compute the
+ * delta windows on a background thread so that their computation overlaps
+ * with the consumption of the stream.  Falls back to a synchronous stream
+ * where threads are not available.
+ *
+ * Once the first window has been requested, @a source and @a target may
+ * only be accessed through the returned stream until either the stream
+ * has been read to its end or svn_txdelta__pipelined_close() has been
+ * called on it.
+ */
+void
+svn_txdelta__pipelined(svn_txdelta_stream_t **stream,
+                       svn_stream_t *source,
+                       svn_stream_t *target,
+                       svn_boolean_t calculate_checksum,
+                       apr_pool_t *pool);
+
+/** Stop the background delta computation for @a stream, a stream returned
+ * by svn_txdelta__pipelined(), and release @a source and @a target for
+ * direct use again.  @a stream must not be read after this call.
+ *
+ * Reading @a stream to its end implies this; an explicit call is only
+ * needed when abandoning a partially read stream.
+ */
+void
+svn_txdelta__pipelined_close(svn_txdelta_stream_t *stream);
+
+/** Same as svn_txdelta_to_svndiff3(), but if threading is available,
+ * compress and encode the windows on a background thread so that the
+ * producer can go on computing the next window in the meantime.
+ *
+ * All writes to @a output still happen on the producer's thread:  the
+ * handler flushes finished windows, in order, when called with the next
+ * window, and flushes the remainder when called with the NULL window.
+ * @a output therefore may be a protocol stream on a shared connection.
+ *
+ * Falls back to the synchronous encoder where threads are not available,
+ * for uncompressed svndiff (@a svndiff_version 0) and when no worker
+ * thread can be created.
+ */
+void
+svn_txdelta__to_svndiff_pipelined(svn_txdelta_window_handler_t *handler,
+                                  void **handler_baton,
+                                  svn_stream_t *output,
+                                  int svndiff_version,
+                                  int compression_level,
+                                  apr_pool_t *pool);
+
 /* Return a debug editor that wraps @a wrapped_editor.
  *
  * The debug editor simply prints an indication of what callbacks are being
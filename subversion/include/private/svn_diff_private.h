@@ -113,6 +113,33 @@ svn_diff__display_prop_diffs(svn_stream_t *outstream,
                              void *cancel_baton,
                              apr_pool_t *scratch_pool);
 
+/** An opaque cache carrying the tokenization state (line boundaries and
+ * token hashes) of one in-memory data source between calls of
+ * svn_diff__mem_string_diff_cached().
+ */
+typedef struct svn_diff__mem_cache_t svn_diff__mem_cache_t;
+
+/** Return a new, empty tokenization cache allocated in @a result_pool. */
+svn_diff__mem_cache_t *
+svn_diff__mem_cache_create(apr_pool_t *result_pool);
+
+/** Like svn_diff_mem_string_diff(), but remember the tokenization of
+ * @a modified in @a cache and reuse it when a later call passes the same
+ * buffer back as @a original, as happens for every step when a chain of
+ * revisions is diffed pairwise (e.g. by blame).
+ *
+ * The caller must keep the buffer passed as @a modified unmodified and
+ * alive until the next call with the same @a cache (or until @a cache
+ * is destroyed); the cached state references it directly.
+ */
+svn_error_t *
+svn_diff__mem_string_diff_cached(svn_diff_t **diff,
+                                 svn_diff__mem_cache_t *cache,
+                                 const svn_string_t *original,
+                                 const svn_string_t *modified,
+                                 const svn_diff_file_options_t *options,
+                                 apr_pool_t *pool);
+
 /** Create a hunk object that adds a single line without newline.  Return the
  * new object in @a *hunk.
  *
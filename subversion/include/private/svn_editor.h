@@ -526,6 +526,29 @@ typedef svn_error_t *(*svn_editor_cb_add_file_t)(
   svn_revnum_t replaces_rev,
   apr_pool_t *scratch_pool);
 
+/** One file addition within a batched svn_editor_add_files() drive.
+ * The members carry the same values as the respective parameters of
+ * svn_editor_add_file().
+ * @since New in 1.15.
+ */
+typedef struct svn_editor_file_t
+{
+  const char *relpath;
+  const svn_checksum_t *checksum;
+  svn_stream_t *contents;
+  apr_hash_t *props;
+  svn_revnum_t replaces_rev;
+} svn_editor_file_t;
+
+/** @see svn_editor_add_files(), svn_editor_t.
+ * @a files is an array of #svn_editor_file_t *.
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_editor_cb_add_files_t)(
+  void *baton,
+  const apr_array_header_t *files,
+  apr_pool_t *scratch_pool);
+
 /** @see svn_editor_add_symlink(), svn_editor_t.
  * @since New in 1.8.
  */
@@ -685,6 +708,17 @@ svn_editor_setcb_add_file(svn_editor_t *editor,
                           svn_editor_cb_add_file_t callback,
                           apr_pool_t *scratch_pool);
 
+/** Sets the #svn_editor_cb_add_files_t callback in @a editor
+ * to @a callback.
+ * @a scratch_pool is used for temporary allocations (if any).
+ * @see also svn_editor_setcb_many().
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_editor_setcb_add_files(svn_editor_t *editor,
+                           svn_editor_cb_add_files_t callback,
+                           apr_pool_t *scratch_pool);
+
 /** Sets the #svn_editor_cb_add_symlink_t callback in @a editor
  * to @a callback.
  * @a scratch_pool is used for temporary allocations (if any).
@@ -816,6 +850,11 @@ typedef struct svn_editor_cb_many_t
   svn_editor_cb_complete_t cb_complete;
   svn_editor_cb_abort_t cb_abort;
 
+  /* Optional batch callback; may be NULL, in which case
+     svn_editor_add_files() falls back to CB_ADD_FILE per element.
+     Added after the 1.8 members; in-tree use only. */
+  svn_editor_cb_add_files_t cb_add_files;
+
 } svn_editor_cb_many_t;
 
 /** Sets all the callback functions in @a editor at once, according to the
@@ -894,6 +933,23 @@ svn_editor_add_file(svn_editor_t *editor,
                     apr_hash_t *props,
                     svn_revnum_t replaces_rev);
 
+/** Drive @a editor's #svn_editor_cb_add_files_t callback, if the
+ * receiver provides one, or its #svn_editor_cb_add_file_t callback
+ * once per element otherwise.
+ *
+ * @a files is an array of #svn_editor_file_t *, each subject to the
+ * same rules as the parameters of svn_editor_add_file().  Batching
+ * lets receivers amortize their per-node setup over many additions;
+ * semantically the call is identical to driving svn_editor_add_file()
+ * for each element in array order.
+ *
+ * For all restrictions on driving the editor, see #svn_editor_t.
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_editor_add_files(svn_editor_t *editor,
+                     const apr_array_header_t *files);
+
 /** Drive @a editor's #svn_editor_cb_add_symlink_t callback.
  *
  * Create a new symbolic link at @a relpath, with a link target of @a
@@ -47,6 +47,22 @@ svn_error__is_tracing_link(const svn_error_t *err);
 svn_error_t *
 svn_error__wrap_zlib(int zerr, const char *function, const char *message);
 
+/**
+ * Return a shared, statically allocated error object with code
+ * @a apr_err, or an ordinary error created with svn_error_create() if
+ * no singleton exists for that code.
+ *
+ * Singletons exist only for pure control flow codes that callers catch
+ * and dismiss, such as #SVN_ERR_CEASE_INVOCATION and #SVN_ERR_ITER_BREAK.
+ * They carry neither message nor source location nor pool, so creating
+ * them is free; svn_error_clear() is a no-op for them and wrapping or
+ * composing them promotes the result to an ordinary, dynamically
+ * allocated error.  In maintainer mode, this always returns an ordinary
+ * error such that source locations and error leak detection keep working.
+ */
+svn_error_t *
+svn_error__sentinel(apr_status_t apr_err);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -31,8 +31,10 @@
 
 #include <apr_pools.h>
 #include <apr_hash.h>
+#include <apr_file_io.h>
 
 #include "svn_types.h"
+#include "svn_checksum.h"
 #include "svn_error.h"
 #include "svn_fs.h"
 #include "svn_iter.h"
@@ -313,6 +315,10 @@ typedef struct svn_fs_fs__ioctl_get_stats_input_t
 {
   svn_fs_progress_notify_func_t progress_func;
   void *progress_baton;
+
+  /* Scan up to this many packed shards concurrently.  0 / 1 mean serial
+   * processing.  Ignored on builds without thread support. */
+  apr_size_t num_threads;
 } svn_fs_fs__ioctl_get_stats_input_t;
 
 typedef struct svn_fs_fs__ioctl_get_stats_output_t
@@ -364,6 +370,70 @@ typedef struct svn_fs_fs__ioctl_build_rep_cache_input_t
 /* See svn_fs_fs__build_rep_cache(). */
 SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_BUILD_REP_CACHE, SVN_FS_TYPE_FSFS, 1004);
 
+typedef struct svn_fs_fs__ioctl_get_raw_contents_input_t
+{
+  /* Revision root containing the file.  Txn roots are not supported. */
+  svn_fs_root_t *root;
+
+  /* Path of the file within ROOT. */
+  const char *path;
+} svn_fs_fs__ioctl_get_raw_contents_input_t;
+
+typedef struct svn_fs_fs__ioctl_get_raw_contents_output_t
+{
+  /* TRUE, if the raw on-disk contents can be used verbatim, i.e. the
+   * file's representation is a non-deltified, non-compressed fulltext.
+   * If FALSE, all other output fields are undefined. */
+  svn_boolean_t available;
+
+  /* Rev / pack file opened for reading, positioned at OFFSET.
+   * Allocated in the ioctl's RESULT_POOL. */
+  apr_file_t *file;
+
+  /* Start offset of the fulltext within FILE. */
+  apr_off_t offset;
+
+  /* Length of the fulltext in bytes. */
+  svn_filesize_t len;
+} svn_fs_fs__ioctl_get_raw_contents_output_t;
+
+/* See svn_fs_fs__get_plain_rep_location(). */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_GET_RAW_CONTENTS, SVN_FS_TYPE_FSFS, 1005);
+
+typedef struct svn_fs_fs__ioctl_find_rep_input_t
+{
+  /* SHA1 fulltext checksum to look up. */
+  svn_checksum_t *checksum;
+} svn_fs_fs__ioctl_find_rep_input_t;
+
+typedef struct svn_fs_fs__ioctl_find_rep_output_t
+{
+  /* TRUE, if the repository already contains a representation with the
+   * given fulltext checksum.  If FALSE, all other output fields are
+   * undefined.
+   *
+   * Note that this is always FALSE if rep-sharing is disabled or the
+   * rep-cache.db has not been built; a negative answer never proves the
+   * content is new. */
+  svn_boolean_t found;
+
+  /* Revision that the canonical representation was committed in. */
+  svn_revnum_t revision;
+
+  /* Item index of that representation within REVISION. */
+  apr_uint64_t item_index;
+
+  /* Size of the fulltext in bytes. */
+  svn_filesize_t expanded_size;
+} svn_fs_fs__ioctl_find_rep_output_t;
+
+/* Checksum-to-representation lookup in the rep-cache.db, intended as a
+ * cheap copy-candidate test for diff and merge: equal checksums identify
+ * equal content without comparing fulltexts.  The rep-cache keys content
+ * by checksum only, so the answer is the canonical representation's
+ * location, not a path list. */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_FIND_REP, SVN_FS_TYPE_FSFS, 1006);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
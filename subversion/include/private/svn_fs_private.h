@@ -69,6 +69,25 @@ svn_error_t *
 svn_fs__path_valid(const char *path, apr_pool_t *pool);
 
 
+/* Quick-reject check for history scans: set *MAY_TOUCH to FALSE if the
+ * revision that ROOT refers to definitely changed none of the paths in
+ * PATHS (an array of "/"-prefixed const char * fspaths), none of their
+ * ancestors and none of their descendants.  Set it to TRUE if it may
+ * have.
+ *
+ * This is allowed to give false positives but never false negatives.
+ * Backends without a cheap summary of the changed paths, as well as
+ * transaction roots, simply answer TRUE.  Use SCRATCH_POOL for
+ * temporary allocations.
+ *
+ * @since New in 1.15. */
+svn_error_t *
+svn_fs__changes_may_touch_paths(svn_boolean_t *may_touch,
+                                svn_fs_root_t *root,
+                                const apr_array_header_t *paths,
+                                apr_pool_t *scratch_pool);
+
+
 
 /** Editors
  *
@@ -195,6 +214,29 @@ svn_fs__get_mergeinfo_for_path(svn_mergeinfo_t *mergeinfo,
                                apr_pool_t *result_pool,
                                apr_pool_t *scratch_pool);
 
+/** Set @a *iprops to the properties @a path would inherit from its parent
+ * directories in @a root, as an array of #svn_prop_inherited_item_t *
+ * elements in depth-first order, i.e. the repository root first.  Parents
+ * without properties are omitted and the @c path_or_url members carry
+ * fspaths without the leading '/'.
+ *
+ * No authorization filtering is applied; callers that enforce authz must
+ * filter the result themselves.  @a path must be a canonical absolute
+ * fspath.
+ *
+ * FS backends may answer this from a per-revision rollup cache instead of
+ * walking the parent chain.
+ *
+ * Allocate @a *iprops in @a result_pool while using @a scratch_pool for
+ * temporaries.
+ */
+svn_error_t *
+svn_fs__get_inherited_props(apr_array_header_t **iprops,
+                            svn_fs_root_t *root,
+                            const char *path,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
 /** Determine the previous location of @a path under @a root and return it
  * as @a *node_path under @a *node_root.  This may be called for arbitrary
  * nodes but is intended for nodes that got deleted in @a root, i.e. when
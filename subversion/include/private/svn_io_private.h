@@ -84,6 +84,57 @@ svn_error_t *
 svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
+/** Try to make @a dst a copy-on-write clone of @a src, going through a
+ * unique intermediate file in @a tmp_dir that is renamed into place
+ * (creating missing parent directories of @a dst).  On success set
+ * @a *cloned to TRUE.
+ *
+ * On platforms and filesystems without cloning support set @a *cloned
+ * to FALSE without returning an error and without touching @a dst; the
+ * caller is expected to fall back to an ordinary copy.  @a tmp_dir must
+ * be on the same filesystem as both @a src and @a dst.
+ */
+svn_error_t *
+svn_io__clone_file(svn_boolean_t *cloned,
+                   const char *dst,
+                   const char *src,
+                   const char *tmp_dir,
+                   apr_pool_t *pool);
+
+/** Overwrite the existing file @a dst with the content of @a src,
+ * rewriting only the 64 KB blocks that differ and truncating @a dst to
+ * the length of @a src.  On success set @a *patched to TRUE.
+ *
+ * If @a dst cannot be opened for updating, set @a *patched to FALSE
+ * without returning an error; the caller is expected to fall back to a
+ * full copy.
+ *
+ * Unlike a copy to a temporary file followed by a rename, this is NOT
+ * atomic: an interrupted call leaves @a dst with mixed content.  Only
+ * use it where a crash recovery procedure is guaranteed to re-run the
+ * operation, e.g. from the working copy work queue.
+ */
+svn_error_t *
+svn_io__copy_file_differential(svn_boolean_t *patched,
+                               const char *dst,
+                               const char *src,
+                               apr_pool_t *pool);
+
+/** Create @a dst as a hard link to @a src, creating missing parent
+ * directories of @a dst.  On success set @a *linked to TRUE.
+ *
+ * Hard linking is inherently best-effort - the paths may live on
+ * different filesystems, the link count may be exhausted or @a dst may
+ * have sprung into existence concurrently.  In all such cases set
+ * @a *linked to FALSE without returning an error; the caller is
+ * expected to fall back to an ordinary copy.
+ */
+svn_error_t *
+svn_io__link_file(svn_boolean_t *linked,
+                  const char *dst,
+                  const char *src,
+                  apr_pool_t *pool);
+
 
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
@@ -127,6 +178,45 @@ svn_stream__install_get_info(apr_finfo_t *finfo,
                              apr_int32_t wanted,
                              apr_pool_t *scratch_pool);
 
+/* Return a write-only stream that forwards everything written to it to
+   WRAPPED on a private worker thread, so that the cost of the wrapped
+   stream - e.g. checksumming and disk I/O - runs concurrently with the
+   producer.  Writes get copied into an internal, bounded buffer ring;
+   a full ring throttles the producer to the worker's pace.
+
+   Closing the returned stream drains the ring, stops the worker, closes
+   WRAPPED on the caller's thread and reports any write error that the
+   worker encountered.  The close handler is idempotent.  WRAPPED must
+   not be accessed by the caller until then.
+
+   Returns WRAPPED itself where threads are unavailable or the worker
+   cannot be created, so callers wanting to close the wrapper only on
+   specific paths can test for that by comparing the streams.
+
+   The returned stream is allocated in RESULT_POOL. */
+svn_stream_t *
+svn_stream__pipelined_write(svn_stream_t *wrapped,
+                            apr_pool_t *result_pool);
+
+/* Return a read-only stream that reads ahead from WRAPPED on a private
+   worker thread, so that the cost of the wrapped stream - e.g. disk or
+   network I/O and decompression - runs concurrently with the consumer.
+   The worker fills an internal, bounded buffer ring; a full ring
+   throttles it to the consumer's pace.
+
+   Closing the returned stream stops the worker and closes WRAPPED on
+   the caller's thread.  The close handler is idempotent.  WRAPPED must
+   not be accessed by the caller until then.
+
+   Returns WRAPPED itself where threads are unavailable or the worker
+   cannot be created, so callers wanting to close the wrapper only on
+   specific paths can test for that by comparing the streams.
+
+   The returned stream is allocated in RESULT_POOL. */
+svn_stream_t *
+svn_stream__pipelined_read(svn_stream_t *wrapped,
+                           apr_pool_t *result_pool);
+
 /* Internal version of svn_stream_from_aprfile2() supporting the
    additional TRUNCATE_ON_SEEK argument. */
 svn_stream_t *
@@ -264,6 +264,15 @@ svn_log__list(const char *path, svn_revnum_t revision,
               apr_array_header_t *patterns, svn_depth_t depth,
               apr_uint32_t dirent_fields, apr_pool_t *pool);
 
+/**
+ * Return a log string for a recursive proplist action.
+ *
+ * @since New in 1.15.
+ */
+const char *
+svn_log__proplist(const char *path, svn_revnum_t revision,
+                  svn_depth_t depth, apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
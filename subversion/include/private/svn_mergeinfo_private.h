@@ -89,6 +89,21 @@ svn_error_t *
 svn_mergeinfo__canonicalize_ranges(svn_mergeinfo_t mergeinfo,
                                    apr_pool_t *scratch_pool);
 
+/** Like svn_mergeinfo_parse(), but backed by a process-global cache of
+ * parsed mergeinfo keyed by the checksum of @a input.  Large svn:mergeinfo
+ * properties get parsed over and over during merges; a cache hit replaces
+ * the parse by a copy from a compact binary form.
+ *
+ * Falls back to plain parsing when the global membuffer cache is disabled.
+ * Allocate @a *mergeinfo in @a result_pool and use @a scratch_pool for
+ * temporary allocations.
+ */
+svn_error_t *
+svn_mergeinfo__parse_cached(svn_mergeinfo_t *mergeinfo,
+                            const char *input,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
 /* Set inheritability of all rangelists in MERGEINFO to INHERITABLE.
    If MERGEINFO is NULL do nothing.  If a rangelist in MERGEINFO is
    NULL leave it alone. */
@@ -0,0 +1,139 @@
+/*
+ * svn_perf.h :  lightweight, compile-time optional performance probes
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_PERF_H
+#define SVN_PERF_H
+
+#include <apr_time.h>
+
+#include "svn_error.h"
+#include "svn_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* This is a tiny instrumentation facility for hot code paths:  a fixed
+ * set of probes, each with a hit counter plus a log2 histogram of call
+ * durations.  It is intended for tuning caches and I/O behaviour on
+ * individual installations without attaching external tracing tools.
+ *
+ * The probes compile to nothing unless SVN_ENABLE_PERF_COUNTERS has
+ * been defined at build time (e.g. via CFLAGS), so release builds pay
+ * no cost whatsoever.  When enabled, samples are taken with
+ * apr_time_now(); that is a few dozen ns per probe - cheap enough for
+ * the call granularity we instrument but deliberately not for
+ * per-instruction use.
+ *
+ * The counters are process-global and updated without synchronization.
+ * Under multi-threaded operation, individual updates may get lost; the
+ * resulting numbers are approximations, which is fine for the intended
+ * tuning use case.
+ */
+
+/* The complete set of probes.  When adding one, extend PROBE_NAMES in
+ * perf.c accordingly. */
+typedef enum svn_perf__probe_t
+{
+  /* svn_fs_fs__get_contents() invocations */
+  svn_perf__probe_fs_get_contents = 0,
+
+  /* open_path() DAG traversals in libsvn_fs_fs */
+  svn_perf__probe_fs_open_path,
+
+  /* blocking reads from an ra_svn connection */
+  svn_perf__probe_ra_svn_read,
+
+  /* (vectored) writes to an ra_svn connection */
+  svn_perf__probe_ra_svn_write,
+
+  /* sqlite3_step() executions, i.e. wc_db statement runs */
+  svn_perf__probe_sqlite_step,
+
+  /* number of probes; must be last */
+  svn_perf__probe__last
+} svn_perf__probe_t;
+
+#ifdef SVN_ENABLE_PERF_COUNTERS
+
+/* Increment the hit counter of PROBE. */
+void
+svn_perf__count(svn_perf__probe_t probe);
+
+/* Return the current timestamp, to be passed to svn_perf__sample(). */
+apr_time_t
+svn_perf__now(void);
+
+/* Record a duration sample for PROBE, started at START. */
+void
+svn_perf__sample(svn_perf__probe_t probe,
+                 apr_time_t start);
+
+#endif /* SVN_ENABLE_PERF_COUNTERS */
+
+/* Write a plain-text report of all probes to STREAM.  If the probes
+ * have not been compiled in, say so in the report instead.
+ * Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_perf__write_report(svn_stream_t *stream,
+                       apr_pool_t *scratch_pool);
+
+/* If the probes have been compiled in and the SVN_PERF_REPORT
+ * environment variable names a file, write the report to that file.
+ * Errors are silently ignored; this is a pure diagnostic aid and must
+ * never affect the host process' outcome. */
+void
+svn_perf__maybe_write_report(apr_pool_t *scratch_pool);
+
+/* Instrumentation macros.  Usage:
+ *
+ *   SVN_PERF_TIMER(timer);           (among the declarations)
+ *   ...
+ *   SVN_PERF_TIMER_START(timer);
+ *   err = do_expensive_thing();
+ *   SVN_PERF_TIMER_STOP(svn_perf__probe_xyz, timer);
+ *
+ * SVN_PERF_COUNT() bumps a probe's counter without taking a duration
+ * sample.  All of these are no-ops when the probes are compiled out.
+ */
+#ifdef SVN_ENABLE_PERF_COUNTERS
+
+#define SVN_PERF_TIMER(name) apr_time_t name = 0
+#define SVN_PERF_TIMER_START(name) ((name) = svn_perf__now())
+#define SVN_PERF_TIMER_STOP(probe, name) svn_perf__sample((probe), (name))
+#define SVN_PERF_COUNT(probe) svn_perf__count(probe)
+
+#else
+
+#define SVN_PERF_TIMER(name) apr_time_t name = 0
+#define SVN_PERF_TIMER_START(name) ((void)(name))
+#define SVN_PERF_TIMER_STOP(probe, name) ((void)(name))
+#define SVN_PERF_COUNT(probe) ((void)0)
+
+#endif /* SVN_ENABLE_PERF_COUNTERS */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_PERF_H */
@@ -159,6 +159,37 @@ svn_error_t *
 svn_ra__register_editor_shim_callbacks(svn_ra_session_t *ra_session,
                                        svn_delta_shim_callbacks_t *callbacks);
 
+/** One (path, revision) pair to probe with svn_ra__check_paths().
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_ra__path_rev_t
+{
+  /** The path to check, relative to the session URL. */
+  const char *path;
+
+  /** The revision to check it in; may be #SVN_INVALID_REVNUM for HEAD. */
+  svn_revnum_t revision;
+} svn_ra__path_rev_t;
+
+/** Like calling svn_ra_check_path() for each element of @a path_revs
+ * (an array of #svn_ra__path_rev_t *), but give the RA layer the chance
+ * to answer all probes in fewer round trips.  ra_svn, for instance,
+ * pipelines the requests over its connection.
+ *
+ * Set @a *kinds to an array of svn_node_kind_t, parallel to
+ * @a path_revs, allocated in @a result_pool.  Use @a scratch_pool for
+ * temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra__check_paths(apr_array_header_t **kinds,
+                    svn_ra_session_t *session,
+                    const apr_array_header_t *path_revs,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool);
+
 
 /* Using information from BATON, provide the (file's) pristine contents
    for REPOS_RELPATH. They are returned in *CONTENTS, and correspond to
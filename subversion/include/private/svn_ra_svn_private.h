@@ -178,6 +178,64 @@ svn_ra_svn__write_cstring(svn_ra_svn_conn_t *conn,
                           apr_pool_t *pool,
                           const char *s);
 
+/** Transport frame compression methods, negotiated via the
+ * #SVN_RA_SVN_CAP_FRAME_COMPRESSION_LZ4 and
+ * #SVN_RA_SVN_CAP_FRAME_COMPRESSION_ZSTD capabilities.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_RA_SVN__FRAME_COMPRESSION_NONE 0
+#define SVN_RA_SVN__FRAME_COMPRESSION_LZ4  1
+#define SVN_RA_SVN__FRAME_COMPRESSION_ZSTD 2
+
+/** Return the best transport frame compression method supported by both
+ * sides of @a conn, based on the capabilities negotiated so far:
+ * #SVN_RA_SVN__FRAME_COMPRESSION_ZSTD, #SVN_RA_SVN__FRAME_COMPRESSION_LZ4
+ * or #SVN_RA_SVN__FRAME_COMPRESSION_NONE.
+ *
+ * @since New in 1.15.
+ */
+int
+svn_ra_svn__preferred_frame_compression(svn_ra_svn_conn_t *conn);
+
+/** Enable transport frame compression on @a conn using @a method, which
+ * must not be #SVN_RA_SVN__FRAME_COMPRESSION_NONE.  Flushes any buffered
+ * writes uncompressed first; both sides must switch at the same point in
+ * the protocol.  Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__enable_frame_compression(svn_ra_svn_conn_t *conn,
+                                     int method,
+                                     apr_pool_t *scratch_pool);
+
+/** Return TRUE if @a conn supports zero-copy file transmission via
+ * svn_ra_svn__write_from_file().
+ *
+ * @since New in 1.15.
+ */
+svn_boolean_t
+svn_ra_svn__can_sendfile(svn_ra_svn_conn_t *conn);
+
+/** Write @a len bytes from @a file, starting at @a offset, over the net
+ * as a single string item, bypassing user-space copies where the
+ * connection supports it.  The caller must have verified the capability
+ * with svn_ra_svn__can_sendfile() first.
+ *
+ * Any buffered writes are flushed before the transfer; an error implies
+ * that the connection framing may be inconsistent and the connection
+ * must be dropped.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__write_from_file(svn_ra_svn_conn_t *conn,
+                            apr_pool_t *pool,
+                            apr_file_t *file,
+                            apr_off_t offset,
+                            svn_filesize_t len);
+
 /** Write a word over the net.
  *
  * Writes will be buffered until the next read or flush.
@@ -371,6 +429,22 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
  * set if either @a error_on_disconnect is FALSE and the connection got
  * closed, or if the command being handled has the "terminate" flag set
  * in the command table.
+ *
+ * If @a cmd_name is not NULL, set @a *cmd_name to the command word read
+ * off the wire, allocated in @a pool, or to NULL if none could be read.
+ * The word is reported even for unknown commands.
+ */
+svn_error_t *
+svn_ra_svn__handle_command2(svn_boolean_t *terminate,
+                            const char **cmd_name,
+                            apr_hash_t *cmd_hash,
+                            void *baton,
+                            svn_ra_svn_conn_t *conn,
+                            svn_boolean_t error_on_disconnect,
+                            apr_pool_t *pool);
+
+/** Like svn_ra_svn__handle_command2() but without the @a cmd_name
+ * output parameter.
  */
 svn_error_t *
 svn_ra_svn__handle_command(svn_boolean_t *terminate,
@@ -380,6 +454,16 @@ svn_ra_svn__handle_command(svn_boolean_t *terminate,
                            svn_boolean_t error_on_disconnect,
                            apr_pool_t *pool);
 
+/** Return in @a *bytes_in and @a *bytes_out the number of bytes received
+ * and sent over @a conn while processing the current (or most recently
+ * completed) command.  The counters are reset whenever a new command is
+ * read off the wire.
+ */
+void
+svn_ra_svn__get_command_io_counters(apr_uint64_t *bytes_in,
+                                    apr_uint64_t *bytes_out,
+                                    svn_ra_svn_conn_t *conn);
+
 /** Accept commands over the network and handle them according to @a
  * commands.  Command handlers will be passed @a conn, a subpool of @a
  * pool (cleared after each command is handled), the parameters of the
@@ -530,6 +614,24 @@ svn_ra_svn__write_cmd_add_file(svn_ra_svn_conn_t *conn,
                                const char *copy_path,
                                svn_revnum_t copy_rev);
 
+/** Send a "put-file" command over connection @a conn.  Add a new file
+ * node named @a path under the directory identified by @a parent_token,
+ * set the properties given by the #svn_prop_t elements of @a props, if
+ * non-NULL apply the complete svndiff-encoded contents @a text, and
+ * close the file again with the optional @a text_checksum.  This is the
+ * compact equivalent of an add-file ... close-file sequence for small
+ * files and requires the receiver to announce #SVN_RA_SVN_CAP_PUT_FILE.
+ * Use @a pool for allocations.
+ */
+svn_error_t *
+svn_ra_svn__write_cmd_put_file(svn_ra_svn_conn_t *conn,
+                               apr_pool_t *pool,
+                               const char *path,
+                               const svn_string_t *parent_token,
+                               const apr_array_header_t *props,
+                               const char *text_checksum,
+                               const svn_string_t *text);
+
 /** Send a "open-file" command over connection @a conn.  Associate to
  * @a token the file node named @a path under the directory identified by
  * @a parent_token in revision @a rev.
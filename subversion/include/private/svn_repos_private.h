@@ -188,8 +188,12 @@ svn_repos__get_logs_compat(svn_repos_t *repos,
  * Instances handed out are read-only and may be given to multiple callers
  * from multiple threads.  Configuration objects no longer referenced by
  * any user may linger for a while before being cleaned up.
+ *
+ * File-backed configurations are revalidated by file attributes (mtime
+ * and size), so repeated access to an unchanged file costs a single
+ * stat() instead of re-reading and re-hashing its contents.
  */
-typedef svn_object_pool__t svn_repos__config_pool_t;
+typedef struct svn_repos__config_pool_t svn_repos__config_pool_t;
 
 /* Create a new configuration pool object with a lifetime determined by
  * POOL and return it in *CONFIG_POOL.
@@ -369,6 +373,55 @@ svn_repos__dump_node_record(svn_stream_t *dump_stream,
                             svn_boolean_t content_length_always,
                             apr_pool_t *scratch_pool);
 
+/* Magic bytes written at the very beginning of a compressed dump file
+ * as produced by svn_repos_dump_fs5() with COMPRESS enabled.  The body
+ * of such a file is a sequence of zstd-compressed blocks, each preceded
+ * by its compressed size as a 4 byte big-endian integer.  A zero-sized
+ * block terminates the sequence; it is followed by a plain-text revision
+ * index (one "REVISION OFFSET\n" line per dumped revision, OFFSET being
+ * the absolute file offset of the first block of that revision), the
+ * absolute file offset of that index as an 8 byte big-endian integer
+ * and, finally, SVN_REPOS__DUMP_ZSTD_TRAILER_MAGIC.
+ *
+ * Blocks never span revision boundaries, so decompression of any
+ * revision - and of the dump file preamble preceding the first one -
+ * may start directly at its indexed offset.
+ */
+#define SVN_REPOS__DUMP_ZSTD_MAGIC "SVN-dump-zstd-v1\n"
+
+/* Magic bytes terminating a compressed dump file, cf.
+ * SVN_REPOS__DUMP_ZSTD_MAGIC. */
+#define SVN_REPOS__DUMP_ZSTD_TRAILER_MAGIC "SVN-dump-zstd-index\n"
+
+/* Maximum size, in bytes, of an uncompressed block in a compressed
+ * dump file. */
+#define SVN_REPOS__DUMP_ZSTD_BLOCK_SIZE (1024 * 1024)
+
+/* Set @a *dump_stream to a readable stream that delivers the plain-text
+ * dump data contained in @a source.
+ *
+ * If @a source does not start with SVN_REPOS__DUMP_ZSTD_MAGIC, the
+ * returned stream simply replays @a source unmodified.  Otherwise, it
+ * decompresses the container transparently.  If, in addition, @a source
+ * is backed by a seekable file and @a start_rev is a valid revision
+ * number beyond the first revision in the container, use the embedded
+ * revision index to skip straight from the dump file preamble to
+ * @a start_rev, and stop delivering data after @a end_rev (if valid)
+ * rather than decompressing the remainder of the file.
+ *
+ * Allocate the stream in @a result_pool and use @a scratch_pool for
+ * temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos__compressed_dump_stream(svn_stream_t **dump_stream,
+                                  svn_stream_t *source,
+                                  svn_revnum_t start_rev,
+                                  svn_revnum_t end_rev,
+                                  apr_pool_t *result_pool,
+                                  apr_pool_t *scratch_pool);
+
 /**
  * Get a dump editor @a editor along with a @a edit_baton allocated in
  * @a pool.  The editor will write output to @a stream.
@@ -390,6 +443,103 @@ svn_repos__get_dump_editor(const svn_delta_editor_t **editor,
                            const char *update_anchor_relpath,
                            apr_pool_t *pool);
 
+/**
+ * Parse @a token, a resume token produced by an earlier call to
+ * svn_repos__get_logs_resumable(), and set @a *next_rev to the revision
+ * at which the next page of that log walk should start.  Return
+ * #SVN_ERR_REPOS_BAD_ARGS if @a token is not a valid resume token.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_repos__log_resume_token_parse(svn_revnum_t *next_rev,
+                                  const char *token,
+                                  apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_repos_get_logs5(), but resumable in pages of @a limit
+ * revisions.
+ *
+ * If @a resume_token is not @c NULL, it must be a token returned by an
+ * earlier call with otherwise identical arguments; the walk then
+ * continues where that call left off instead of re-sending (and
+ * re-scanning) the revisions already delivered.
+ *
+ * If @a limit cut the walk short and revisions remain in the requested
+ * range, set @a *resume_token_out to an opaque token, allocated in
+ * @a result_pool, which a later call can pass as @a resume_token.  Set
+ * it to @c NULL when the walk is complete.
+ *
+ * Tokens do not capture any server state; they only record the range
+ * position, so handing one to a query with different paths or flags
+ * yields well-defined but probably unwanted results.
+ */
+svn_error_t *
+svn_repos__get_logs_resumable(svn_repos_t *repos,
+                              const apr_array_header_t *paths,
+                              svn_revnum_t start,
+                              svn_revnum_t end,
+                              int limit,
+                              svn_boolean_t strict_node_history,
+                              svn_boolean_t include_merged_revisions,
+                              const apr_array_header_t *revprops,
+                              const char *resume_token,
+                              const char **resume_token_out,
+                              svn_repos_authz_func_t authz_read_func,
+                              void *authz_read_baton,
+                              svn_repos_path_change_receiver_t
+                                path_change_receiver,
+                              void *path_change_receiver_baton,
+                              svn_repos_log_entry_receiver_t
+                                revision_receiver,
+                              void *revision_receiver_baton,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
+/**
+ * Callback type to be used with svn_repos__proplist().  It will be invoked
+ * for every node that carries versioned properties, with @a path being its
+ * repository path, @a kind its node kind and @a props its non-empty
+ * property hash, mapping <tt>const char *</tt> names to
+ * <tt>svn_string_t *</tt> values.
+ *
+ * @a baton is the baton that was passed to svn_repos__proplist();
+ * @a scratch_pool will be cleared between invocations.
+ */
+typedef svn_error_t *(*svn_repos__proplist_receiver_t)(
+  const char *path,
+  svn_node_kind_t kind,
+  apr_hash_t *props,
+  void *baton,
+  apr_pool_t *scratch_pool);
+
+/**
+ * Walk the sub-tree starting at @a path under @a root down to the given
+ * @a depth.  For every node that has versioned properties, call
+ * @a receiver with @a receiver_baton and the full property list; nodes
+ * without properties are skipped.  The walk happens entirely within the
+ * repository layer, so a deep tree costs a single request instead of one
+ * per directory.
+ *
+ * If @a authz_read_func is not @c NULL, use it with @a authz_read_baton
+ * to determine which sub-trees may be reported; inaccessible ones are
+ * silently omitted.
+ *
+ * @a cancel_func and @a cancel_baton have their usual meaning; use
+ * @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_repos__proplist(svn_fs_root_t *root,
+                    const char *path,
+                    svn_depth_t depth,
+                    svn_repos_authz_func_t authz_read_func,
+                    void *authz_read_baton,
+                    svn_repos__proplist_receiver_t receiver,
+                    void *receiver_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
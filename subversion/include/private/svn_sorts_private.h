@@ -72,6 +72,52 @@ svn_sort__hash(apr_hash_t *ht,
                                       const svn_sort__item_t *),
                apr_pool_t *pool);
 
+/** A snapshot of a hash table whose contents got sorted by key once at
+ * construction time.  It supports iteration in key order via @c items as
+ * well as binary search lookup, i.e. there is no need to convert it back
+ * into a hash or to re-sort it when both access patterns are required.
+ *
+ * @note Private. For use by Subversion's own code only.
+ */
+typedef struct svn_sort__sorted_hash_t
+{
+  /** All key/value pairs of the hash as @c svn_sort__item_t elements,
+   * in the order defined by @c comparison_func.  Storage is shared with
+   * the original hash, not copied. */
+  apr_array_header_t *items;
+
+  /** The ordering of @c items. */
+  int (*comparison_func)(const svn_sort__item_t *,
+                         const svn_sort__item_t *);
+
+  /** Lookup location hint, see svn_sort__array_lookup(). */
+  int hint;
+} svn_sort__sorted_hash_t;
+
+/** Return a sorted snapshot of @a ht, ordered by @a comparison_func and
+ * allocated in @a pool.  See svn_sort__hash() for the constraints on
+ * @a comparison_func.
+ *
+ * @note Private. For use by Subversion's own code only.
+ */
+svn_sort__sorted_hash_t *
+svn_sort__sorted_hash(apr_hash_t *ht,
+                      int (*comparison_func)(const svn_sort__item_t *,
+                                             const svn_sort__item_t *),
+                      apr_pool_t *pool);
+
+/** Return the value stored for @a key of length @a klen in
+ * @a sorted_hash, or NULL if there is no such key.  @a klen may be
+ * #APR_HASH_KEY_STRING.  This is a binary search; repeated lookups in
+ * ascending key order are O(1) amortized due to the location hint.
+ *
+ * @note Private. For use by Subversion's own code only.
+ */
+void *
+svn_sort__sorted_hash_find(svn_sort__sorted_hash_t *sorted_hash,
+                           const void *key,
+                           apr_ssize_t klen);
+
 /* Sort APR array @a array using ordering defined by @a comparison_func.
  * @a comparison_func is defined as for the C stdlib function qsort().
  */
@@ -80,6 +126,22 @@ svn_sort__array(apr_array_header_t *array,
                 int (*comparison_func)(const void *,
                                        const void *));
 
+/* Sort APR array @a array using ordering defined by @a comparison_func.
+ * @a comparison_func is defined as for the C stdlib function qsort().
+ *
+ * Unlike svn_sort__array(), this uses a stable merge sort with an
+ * insertion sort fast path for small ranges and, for very large arrays
+ * on builds with thread support, sorts sub-ranges in concurrent worker
+ * threads.  Use it for bulk data such as the per-pack-file item lists.
+ * @a scratch_pool is used for the temporary merge buffer and for thread
+ * management.
+ */
+void
+svn_sort__array_parallel(apr_array_header_t *array,
+                         int (*comparison_func)(const void *,
+                                                const void *),
+                         apr_pool_t *scratch_pool);
+
 /** Return the lowest index at which the element @a *key should be inserted into
  * the array @a array, according to the ordering defined by @a compare_func.
  * The array must already be sorted in the ordering defined by @a compare_func.
@@ -115,6 +177,44 @@ svn_sort__array_lookup(const apr_array_header_t *array,
                        int *hint,
                        int (*compare_func)(const void *, const void *));
 
+/** Define a static function @a fn_name with the same semantics as
+ * svn_sort__bsearch_lower_bound() but specialized for arrays of
+ * @a elt_type elements sorted by a key of scalar type @a key_type.
+ * @a key_of_elt names a macro or function mapping a
+ * <tt>const elt_type *</tt> to its @a key_type key.
+ *
+ * The generated function takes the array and the key and returns the
+ * lowest index at which an element with that key should be inserted.
+ * Since the comparison gets expanded inline, this eliminates the
+ * indirect call from the innermost search loop.  Use it instead of the
+ * generic function in hot paths where the comparison is trivial, e.g.
+ * a plain integer compare.
+ *
+ * @note Private. For use by Subversion's own code only.
+ */
+#define SVN_SORT__MAKE_BSEARCH_LOWER_BOUND(fn_name, elt_type,             \
+                                           key_type, key_of_elt)          \
+static APR_INLINE int                                                     \
+fn_name(const apr_array_header_t *array,                                  \
+        key_type key)                                                     \
+{                                                                         \
+  const elt_type *base = (const elt_type *)array->elts;                   \
+  int lower = 0;                                                          \
+  int upper = array->nelts - 1;                                           \
+                                                                          \
+  /* Binary search for the lowest position at which to insert KEY. */     \
+  while (lower <= upper)                                                  \
+    {                                                                     \
+      int try = lower + (upper - lower) / 2;                              \
+      if (key_of_elt(&base[try]) < key)                                   \
+        lower = try + 1;                                                  \
+      else                                                                \
+        upper = try - 1;                                                  \
+    }                                                                     \
+                                                                          \
+  return lower;                                                           \
+}
+
 
 /** Insert a shallow copy of @a *new_element into the array @a array at the index
  * @a insert_index, growing the array and shuffling existing elements along to
@@ -96,6 +96,28 @@ svn_sqlite__insert(apr_int64_t *row_id, svn_sqlite__stmt_t *stmt);
 svn_error_t *
 svn_sqlite__update(int *affected_rows, svn_sqlite__stmt_t *stmt);
 
+/* Callback for svn_sqlite__stmt_run_batch().  Bind the parameters of STMT
+   for row number ROW_IDX (0 based).  The statement's bindings have been
+   cleared before each invocation.  Allocations may use SCRATCH_POOL, which
+   is cleared between rows. */
+typedef svn_error_t *(*svn_sqlite__bind_row_func_t)(svn_sqlite__stmt_t *stmt,
+                                                    int row_idx,
+                                                    void *baton,
+                                                    apr_pool_t *scratch_pool);
+
+/* Run the insert/update/delete statement STMT_IDX of DB once per row for
+   ROW_COUNT rows, calling BIND_ROW_FUNC with BATON to bind each row's
+   parameters.  The whole batch executes inside a single savepoint, and the
+   stepping loop avoids the per-call reset and error wrapping overhead of
+   svn_sqlite__insert() and friends.  The statement must not return rows. */
+svn_error_t *
+svn_sqlite__stmt_run_batch(svn_sqlite__db_t *db,
+                           int stmt_idx,
+                           int row_count,
+                           svn_sqlite__bind_row_func_t bind_row_func,
+                           void *baton,
+                           apr_pool_t *scratch_pool);
+
 /* Return in *VERSION the version of the schema in DB. Use SCRATCH_POOL
    for temporary allocations.  */
 svn_error_t *
@@ -131,6 +131,49 @@ svn_membuf__nzero(svn_membuf_t *membuf, apr_size_t size);
 svn_string_t *
 svn_stringbuf__morph_into_string(svn_stringbuf_t *strbuf);
 
+/** An arena that hands out small #svn_stringbuf_t objects carved from
+ * large contiguous blocks, with batch reset.
+ *
+ * Parser hot loops build millions of short string buffers; allocating
+ * each one individually from a pool costs an allocator round trip per
+ * string and the memory cannot be recycled short of clearing the whole
+ * pool.  An arena carves header and an inline buffer out of one block
+ * in a few instructions and svn_stringbuf__arena_reset() makes all of
+ * that memory reusable again in O(1), e.g. once per parsed item.
+ *
+ * Buffers returned from an arena are ordinary string buffers: if one
+ * outgrows its inline capacity, it transparently migrates to the
+ * arena's pool via the usual doubling reallocation.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_stringbuf__arena_t svn_stringbuf__arena_t;
+
+/** Create a new arena allocating blocks of roughly @a block_size bytes
+ * from @a pool.  @a block_size is a tuning hint and may be 0 for a
+ * reasonable default; it limits the largest string buffer that can be
+ * carved from the arena rather than allocated individually.
+ */
+svn_stringbuf__arena_t *
+svn_stringbuf__arena_create(apr_size_t block_size, apr_pool_t *pool);
+
+/** Return an empty #svn_stringbuf_t with room for at least @a capacity
+ * bytes plus the terminating NUL, carved from @a arena if it is small
+ * enough and allocated from the arena's pool otherwise.
+ *
+ * The buffer remains valid until the next svn_stringbuf__arena_reset()
+ * call or the destruction of the arena's pool, whichever comes first.
+ */
+svn_stringbuf_t *
+svn_stringbuf__arena_buf(svn_stringbuf__arena_t *arena, apr_size_t capacity);
+
+/** Invalidate all string buffers carved from @a arena and make their
+ * memory available for carving again.  Buffers that migrated to the
+ * arena's pool by outgrowing their inline capacity are not recycled.
+ */
+void
+svn_stringbuf__arena_reset(svn_stringbuf__arena_t *arena);
+
 /** Utility macro to define static svn_string_t objects.  @a value must
  * be a static string; the "" in the macro declaration tries to ensure this.
  *
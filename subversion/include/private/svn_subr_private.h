@@ -28,12 +28,100 @@
 #include "svn_io.h"
 #include "svn_config.h"
 
+#define APR_WANT_IOVEC
+#include <apr_want.h>
+
 
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
 
+/** Iteration pools
+ *
+ * @defgroup svn_iterpool Iteration pool support
+ * @{
+ */
+
+/** Create an iteration sub-pool of @a parent_pool that is backed by its
+ * own private, unsynchronized allocator with an unlimited free list.
+ *
+ * Blocks released by svn_pool_clear() remain on that free list, ready
+ * for immediate reuse by the next iteration.  This makes the clear
+ * little more than a pointer reset: no allocator mutex needs to be
+ * taken and no memory is handed back to the OS while the loop runs.
+ * Use this instead of svn_pool_create() for pools that get cleared
+ * many times per second in tight loops.
+ *
+ * The memory footprint of the pool is bounded by its largest iteration
+ * and only released upon the pool's destruction, so don't use this for
+ * long-lived pools.  The private allocator gets destroyed together
+ * with the pool.
+ *
+ * @since New in 1.15.
+ */
+apr_pool_t *
+svn_pool__create_iterpool(apr_pool_t *parent_pool);
+
+/** @} */
+
+/** Pool accounting
+ *
+ * @defgroup svn_pool_accounting Pool memory accounting
+ * @{
+ */
+
+/** Return the number of bytes currently allocated in @a pool and all
+ * of its sub-pools.
+ *
+ * Exact per-pool accounting is only available from APR when it has
+ * been compiled with pool debugging (APR_POOL_DEBUG); plain builds
+ * return 0.  Callers should treat a zero result as "not available"
+ * and fall back to process-level metrics.
+ *
+ * @since New in 1.15.
+ */
+apr_size_t
+svn_pool__bytes_used(apr_pool_t *pool);
+
+/** @} */
+
+/** Cancellation support
+ *
+ * @defgroup svn_cancel_support Cancellation support
+ * @{
+ */
+
+/** Set @a *throttled_func / @a *throttled_baton to a cancellation
+ * callback that forwards to @a cancel_func / @a cancel_baton at most
+ * every ~200 milliseconds and answers the calls in between with an
+ * inline counter check.
+ *
+ * Intended for hot loops that poll for cancellation once per node or
+ * delta window: application-supplied callbacks can be arbitrarily
+ * expensive (some GUI clients stat files or pump an event loop), and
+ * forwarding a bounded number of times per second keeps the loop cheap
+ * while still reacting to a cancellation request promptly.  The stride
+ * between forwarded calls adapts automatically to the observed call
+ * rate.
+ *
+ * If @a cancel_func is NULL, @a *throttled_func and @a *throttled_baton
+ * are set to NULL.  The returned callback is not thread-safe; wrap the
+ * callback separately for each loop that polls it.
+ *
+ * Allocate the result in @a result_pool.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_cancel__create_throttled(svn_cancel_func_t *throttled_func,
+                             void **throttled_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *result_pool);
+
+/** @} */
+
 /** Spill-to-file Buffers
  *
  * @defgroup svn_spillbuf_t Spill-to-file Buffers
@@ -95,12 +183,20 @@ svn_spillbuf__create(apr_size_t blocksize,
                      apr_size_t maxsize,
                      apr_pool_t *result_pool);
 
-/* Create a spill buffer, with extra parameters.  */
+/* Create a spill buffer, with extra parameters.
+
+   If MMAP_READBACK is TRUE and the platform supports memory-mapped files,
+   content will be read back from the spill file through a sliding mmap
+   window instead of buffered file I/O, i.e. without copying the data into
+   a private block first.  This is an advantage for consumers that merely
+   forward large amounts of spilled content (e.g. to a network socket).
+   On platforms without mmap support the flag is ignored.  */
 svn_spillbuf_t *
 svn_spillbuf__create_extended(apr_size_t blocksize,
                               apr_size_t maxsize,
                               svn_boolean_t delete_on_close,
                               svn_boolean_t spill_all_contents,
+                              svn_boolean_t mmap_readback,
                               const char* dirpath,
                               apr_pool_t *result_pool);
 
@@ -142,6 +238,26 @@ svn_spillbuf__read(const char **data,
                    apr_pool_t *scratch_pool);
 
 
+/* Gather up to @a *nvecs blocks of content from the spill buffer into
+   @a vecs, without copying. On input, @a *nvecs gives the capacity of
+   @a vecs; on output it is set to the number of entries actually filled,
+   which will be zero if no content remains. The referenced data must be
+   fully consumed by the caller and remains valid under the same rules as
+   for svn_spillbuf__read().
+
+   This is most useful together with mmap readback (see
+   svn_spillbuf__create_extended()) for writev()-style consumers; it
+   avoids one svn_spillbuf__read() round-trip per block.
+
+   If @a *nvecs is not positive, then SVN_ERR_INCORRECT_PARAMS is
+   returned.  */
+svn_error_t *
+svn_spillbuf__read_iovec(struct iovec *vecs,
+                         int *nvecs,
+                         svn_spillbuf_t *buf,
+                         apr_pool_t *scratch_pool);
+
+
 /* Callback for reading content out of the spill buffer. Set @a stop if
    you want to stop the processing (and will call svn_spillbuf__process
    again, at a later time).  */
@@ -382,6 +498,98 @@ svn_hash__make(apr_pool_t *pool);
 
 /** @} */
 
+/**
+ * @defgroup svn_hash_fast Open-addressing hash container
+ * @{
+ */
+
+/** An open-addressing hash container mapping string keys to void *
+ * values.  Compared to apr_hash_t, it uses a pre-sized power-of-two
+ * index without per-entry allocations, and it iterates in stable
+ * insertion order.  Intended for hot, insert-mostly containers such as
+ * the FS changed-paths tracking.
+ *
+ * Keys are copied into the container upon insertion; values are
+ * referenced, not copied.  There is no way to remove the memory of
+ * deleted entries short of destroying the pool.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_hash__fast_t svn_hash__fast_t;
+
+/** Return a new, empty container allocated in @a pool and pre-sized
+ * such that @a expected_entries entries can be added without growing
+ * the index.
+ *
+ * @since New in 1.15.
+ */
+svn_hash__fast_t *
+svn_hash__fast_make(apr_size_t expected_entries,
+                    apr_pool_t *pool);
+
+/** Return the value stored for the key given by @a key and @a klen in
+ * @a hash, or NULL if there is none.  @a klen may be
+ * #APR_HASH_KEY_STRING.
+ *
+ * @since New in 1.15.
+ */
+void *
+svn_hash__fast_get(const svn_hash__fast_t *hash,
+                   const char *key,
+                   apr_ssize_t klen);
+
+/** Store @a value for the key given by @a key and @a klen in @a hash,
+ * replacing any previous value.  A NULL @a value deletes the key.
+ * @a klen may be #APR_HASH_KEY_STRING.  The key is copied into the
+ * container's pool; @a value must have a sufficient lifetime.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_hash__fast_set(svn_hash__fast_t *hash,
+                   const char *key,
+                   apr_ssize_t klen,
+                   void *value);
+
+/** Return the number of keys with a non-NULL value in @a hash.
+ *
+ * @since New in 1.15.
+ */
+apr_size_t
+svn_hash__fast_count(const svn_hash__fast_t *hash);
+
+/** Return the number of iteration positions in @a hash, i.e. the
+ * valid range of the @a idx parameter to svn_hash__fast_entry().
+ * This includes positions of deleted entries.
+ *
+ * @since New in 1.15.
+ */
+apr_size_t
+svn_hash__fast_size(const svn_hash__fast_t *hash);
+
+/** Return the value of the entry at iteration position @a idx in
+ * @a hash, and set @a *key and @a *klen to its key and key length,
+ * respectively.  @a key and @a klen may each be NULL.  A NULL return
+ * value denotes a deleted entry, which callers should skip.  Entries
+ * iterate in insertion order.
+ *
+ * @since New in 1.15.
+ */
+void *
+svn_hash__fast_entry(const svn_hash__fast_t *hash,
+                     apr_size_t idx,
+                     const char **key,
+                     apr_ssize_t *klen);
+
+/** Return the pool that @a hash allocates its entries in.
+ *
+ * @since New in 1.15.
+ */
+apr_pool_t *
+svn_hash__fast_pool(const svn_hash__fast_t *hash);
+
+/** @} */
+
 /**
  * @defgroup svn_hash_read Reading serialized hash tables
  * @{
@@ -505,6 +713,18 @@ svn_version__at_least(const svn_version_t *version,
 /* Slowest, best compression method & level provided by zlib. */
 #define SVN__COMPRESSION_ZLIB_MAX     9
 
+/* Fastest, least effective compression level provided by zstd. */
+#define SVN__COMPRESSION_ZSTD_MIN     1
+
+/* Default zstd compression level.  This is what upstream zstd uses when
+   no explicit level has been given and offers a good speed/ratio
+   trade-off for wire transfers. */
+#define SVN__COMPRESSION_ZSTD_DEFAULT 3
+
+/* Slowest, best compression level provided by zstd.  Suitable for
+   write-once data such as pack files. */
+#define SVN__COMPRESSION_ZSTD_MAX     19
+
 /* Encode VAL into the buffer P using the variable-length 7b/8b unsigned
    integer format.  Return the incremented value of P after the
    encoded bytes have been written.  P must point to a buffer of size
@@ -591,6 +811,26 @@ svn__decompress_lz4(const void *data, apr_size_t len,
                     svn_stringbuf_t *out,
                     apr_size_t limit);
 
+/* Same as svn__compress_zlib(), but use zstd compression at the given
+ * COMPRESSION_LEVEL.  Levels outside the range from
+ * SVN__COMPRESSION_ZSTD_MIN to SVN__COMPRESSION_ZSTD_MAX will be clamped
+ * to it.  Returns an SVN_ERR_UNSUPPORTED_FEATURE error if Subversion
+ * was compiled without zstd support.
+ */
+svn_error_t *
+svn__compress_zstd(const void *data, apr_size_t len,
+                   svn_stringbuf_t *out,
+                   int compression_level);
+
+/* Same as svn__decompress_zlib(), but use zstd compression.  Returns an
+ * SVN_ERR_UNSUPPORTED_FEATURE error if Subversion was compiled without
+ * zstd support.
+ */
+svn_error_t *
+svn__decompress_zstd(const void *data, apr_size_t len,
+                     svn_stringbuf_t *out,
+                     apr_size_t limit);
+
 /** @} */
 
 /**
@@ -732,6 +972,18 @@ const char *svn_xml__compiled_version(void);
 /* Return the xml (expat) version we run against. */
 const char *svn_xml__runtime_version(void);
 
+/* Append the LEN bytes of DATA to *OUTSTR (allocating *OUTSTR in POOL
+ * if it is NULL), without scanning for chars that would need escaping.
+ * Only for cdata the caller knows to be free of '&', '<', '>' and
+ * '\r', e.g. content it generated itself or validated on input;
+ * behaves like svn_xml_escape_cdata_cstring() in every other respect.
+ */
+void
+svn_xml__escape_cdata_verbatim(svn_stringbuf_t **outstr,
+                               const char *data,
+                               apr_size_t len,
+                               apr_pool_t *pool);
+
 /* Return the zlib version we compiled against. */
 const char *svn_zlib__compiled_version(void);
 
@@ -746,6 +998,14 @@ const char *svn_lz4__compiled_version(void);
  */
 int svn_lz4__runtime_version(void);
 
+/* Return the zstd version we compiled against, or NULL if Subversion
+ * was compiled without zstd support. */
+const char *svn_zstd__compiled_version(void);
+
+/* Return the zstd version we run against, or NULL if Subversion was
+ * compiled without zstd support. */
+const char *svn_zstd__runtime_version(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
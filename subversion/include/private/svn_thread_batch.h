@@ -0,0 +1,152 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_thread_batch.h
+ * @brief Running a sequence of independent tasks on worker thread batches
+ */
+
+#ifndef SVN_THREAD_BATCH_H
+#define SVN_THREAD_BATCH_H
+
+#include <apr_thread_proc.h>
+
+#include "svn_error.h"
+#include "svn_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Run a sequence of independent tasks on batches of worker threads.
+ *
+ * The runner repeatedly fills a batch of up to @c num_threads tasks,
+ * waits for all of them, hands the completed batch to a serial
+ * processing callback, and destroys the per-task pools - in success
+ * and error cases alike.  In particular, it never returns with worker
+ * threads still running: if setting up or spawning a task fails
+ * mid-batch, the tasks already started are joined and their errors
+ * composed before the failure is raised.
+ *
+ * Everything except the work function runs on the calling thread, so
+ * callbacks may freely use non-thread-safe state such as notification
+ * or cancellation functions.
+ *
+ * If APR provides no thread support, the tasks are simply run one by
+ * one on the calling thread, with unchanged batching semantics.
+ */
+
+/** One task run by svn_thread_batch__run(). */
+typedef struct svn_thread_batch__task_t
+{
+  /** Private root pool of this task, with a thread-safe allocator.
+   * The task baton and everything the worker allocates lives here.
+   * Managed by the runner. */
+  apr_pool_t *pool;
+
+  /** The task baton provided by the init function. */
+  void *baton;
+
+  /** Error raised by the work function, if any.  The process function
+   * takes ownership, see svn_thread_batch__collect(). */
+  svn_error_t *result;
+
+  /* Internals of the runner. */
+  svn_error_t *(*work_func)(void *baton, apr_pool_t *task_pool);
+  apr_thread_t *thread;
+} svn_thread_batch__task_t;
+
+/** Called on the spawning thread, in task order, to set up the next
+ * task.  Set @a *baton to a baton allocated in @a task_pool describing
+ * the work to do, or to @c NULL if there is no more work.  @a context
+ * is the context given to svn_thread_batch__run(); use @a scratch_pool
+ * for temporary allocations.
+ *
+ * An error aborts the current batch after all tasks already started
+ * have been joined.
+ */
+typedef svn_error_t *(*svn_thread_batch__init_func_t)(
+  void **baton,
+  void *context,
+  apr_pool_t *task_pool,
+  apr_pool_t *scratch_pool);
+
+/** Called on a worker thread to perform the task described by @a baton.
+ * This must only touch state reachable from @a baton and @a task_pool;
+ * in particular, it must not allocate from a pool shared with another
+ * thread.
+ */
+typedef svn_error_t *(*svn_thread_batch__work_func_t)(
+  void *baton,
+  apr_pool_t *task_pool);
+
+/** Called on the spawning thread after all tasks of a batch have been
+ * joined, with @a tasks an array of svn_thread_batch__task_t *, in task
+ * order.  This owns the workers' @c result errors - return them composed
+ * (see svn_thread_batch__collect()) or clear them - and typically applies
+ * the tasks' global state changes serially.  @a context is the context
+ * given to svn_thread_batch__run(); @a scratch_pool lives until the end
+ * of the batch.
+ *
+ * This may make more work available to the init function, e.g. to retry
+ * tasks; the run only ends once a batch comes up empty.
+ *
+ * Not called for batches whose setup failed; the runner then composes
+ * the workers' errors into the setup error itself.
+ */
+typedef svn_error_t *(*svn_thread_batch__process_func_t)(
+  apr_array_header_t *tasks,
+  void *context,
+  apr_pool_t *scratch_pool);
+
+/** Return the @c result errors of all @a tasks, composed in task order,
+ * and remove them from the tasks.  Returns #SVN_NO_ERROR if no task
+ * failed.  Intended for use in #svn_thread_batch__process_func_t.
+ */
+svn_error_t *
+svn_thread_batch__collect(apr_array_header_t *tasks);
+
+/** Run tasks provided by @a init_func through @a work_func on batches
+ * of up to @a num_threads worker threads, processing each completed
+ * batch with @a process_func, until @a init_func reports the end of
+ * the work or an error occurs.  Pass @a context to all callbacks.
+ *
+ * If @a cancel_func is not @c NULL, poll it between batches - from the
+ * calling thread only, since cancellation funcs tend to not be
+ * thread-safe.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_thread_batch__run(apr_size_t num_threads,
+                      svn_thread_batch__init_func_t init_func,
+                      svn_thread_batch__work_func_t work_func,
+                      svn_thread_batch__process_func_t process_func,
+                      void *context,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_THREAD_BATCH_H */
@@ -1051,6 +1051,77 @@ svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
                                           apr_pool_t *result_pool,
                                           apr_pool_t *scratch_pool);
 
+/* Fetch callback for svn_wc__pristines_hydrate(): write the text of
+   REPOS_RELPATH (relative to the repository root) at REVISION to
+   CONTENTS.  The callback must not close CONTENTS; the caller does. */
+typedef svn_error_t *(*svn_wc__pristine_fetch_t)(void *baton,
+                                                 svn_stream_t *contents,
+                                                 const char *repos_relpath,
+                                                 svn_revnum_t revision,
+                                                 apr_pool_t *scratch_pool);
+
+/* Set *MISSING to TRUE if the pristine store of the working copy
+   containing LOCAL_ABSPATH lacks the file for one or more pristine texts
+   referenced by the BASE tree, for example because the store was
+   dehydrated.  This is a cheap way to find out whether a call to
+   svn_wc__pristines_hydrate() (and hence a repository connection) would
+   be needed. */
+svn_error_t *
+svn_wc__pristines_missing(svn_boolean_t *missing,
+                          svn_wc_context_t *wc_ctx,
+                          const char *local_abspath,
+                          apr_pool_t *scratch_pool);
+
+/* Fetch, verify and install every pristine text that is referenced by
+   the BASE tree of the working copy containing LOCAL_ABSPATH but absent
+   from the pristine store on disk.  FETCH_FUNC/FETCH_BATON provides the
+   text of a repository path at a revision; the fetched text must match
+   the recorded SHA-1 checksum or this function fails.
+
+   If FETCHED_COUNT is not null, set *FETCHED_COUNT to the number of
+   texts installed. */
+svn_error_t *
+svn_wc__pristines_hydrate(int *fetched_count,
+                          svn_wc_context_t *wc_ctx,
+                          const char *local_abspath,
+                          svn_wc__pristine_fetch_t fetch_func,
+                          void *fetch_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *scratch_pool);
+
+/* Remove from disk the pristine texts of the working copy containing
+   LOCAL_ABSPATH that can be fetched from the repository again, keeping
+   the texts of locally modified files and of local copies and moves.
+   See svn_wc__db_pristine_dehydrate().  If REMOVED_COUNT is not null,
+   set *REMOVED_COUNT to the number of pristine files removed. */
+svn_error_t *
+svn_wc__pristines_dehydrate(int *removed_count,
+                            svn_wc_context_t *wc_ctx,
+                            const char *local_abspath,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *scratch_pool);
+
+/* Set *STORED to FALSE iff the working copy containing LOCAL_ABSPATH
+   records that its pristine store has been dehydrated.  This only reads
+   the recorded mode; it does not look for missing files on disk. */
+svn_error_t *
+svn_wc__pristines_stored(svn_boolean_t *stored,
+                         svn_wc_context_t *wc_ctx,
+                         const char *local_abspath,
+                         apr_pool_t *scratch_pool);
+
+/* Record in the working copy containing LOCAL_ABSPATH that its pristine
+   store is hydrated again, so that it is no longer treated as a
+   'store-pristines = no' working copy.  The caller must first ensure
+   that no pristine text is missing; see svn_wc__pristines_hydrate().
+   This is a no-op on a working copy that was never dehydrated. */
+svn_error_t *
+svn_wc__pristines_mark_stored(svn_wc_context_t *wc_ctx,
+                              const char *local_abspath,
+                              apr_pool_t *scratch_pool);
+
 /* Gets an array of const char *repos_relpaths of descendants of LOCAL_ABSPATH,
  * which must be the op root of an addition, copy or move. The descendants
  * returned are at the same op_depth, but are to be deleted by the commit
@@ -1499,6 +1570,11 @@ svn_wc__get_status_editor(const svn_delta_editor_t **editor,
  * empty directory, and so bypass a number of conflict checks that are
  * unnecessary in this case.
  *
+ * If @a verify_base_checksums is FALSE, do not re-read and re-checksum
+ * the locally stored pristine base before applying an incoming delta to
+ * it.  The pristine contents were verified when they were stored, so
+ * this re-verification only guards against later local corruption.
+ *
  * If @a fetch_dirents_func is not NULL, the update editor may call this
  * callback, when asked to perform a depth restricted update. It will do this
  * before returning the editor to allow using the primary ra session for this.
@@ -1520,6 +1596,7 @@ svn_wc__get_update_editor(const svn_delta_editor_t **editor,
                           svn_boolean_t adds_as_modification,
                           svn_boolean_t server_performs_filtering,
                           svn_boolean_t clean_checkout,
+                          svn_boolean_t verify_base_checksums,
                           const char *diff3_cmd,
                           const apr_array_header_t *preserved_exts,
                           svn_wc_dirents_func_t fetch_dirents_func,
@@ -1562,6 +1639,7 @@ svn_wc__get_switch_editor(const svn_delta_editor_t **editor,
                           svn_boolean_t depth_is_sticky,
                           svn_boolean_t allow_unver_obstructions,
                           svn_boolean_t server_performs_filtering,
+                          svn_boolean_t verify_base_checksums,
                           const char *diff3_cmd,
                           const apr_array_header_t *preserved_exts,
                           svn_wc_dirents_func_t fetch_dirents_func,
@@ -6015,6 +6015,34 @@ svn_client_propset_remote(const char *propname,
                           svn_client_ctx_t *ctx,
                           apr_pool_t *scratch_pool);
 
+/**
+ * Like svn_client_propset_remote(), but set @a propname to @a propval
+ * on each (<tt>const char *</tt>) URL in @a urls, creating a single new
+ * revision covering all of them.
+ *
+ * All URLs must live in the same repository.  The property change for
+ * every target is driven through one commit editor, so the number of
+ * client/server round trips does not grow with the number of targets.
+ *
+ * The same restrictions as for svn_client_propset_remote() apply to
+ * each target: @a base_revision_for_url must be a valid revision
+ * number, and "svn:eol-style" and "svn:keywords" cannot be set this
+ * way.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_client_propset_urls_remote(const char *propname,
+                               const svn_string_t *propval,
+                               const apr_array_header_t *urls,
+                               svn_boolean_t skip_checks,
+                               svn_revnum_t base_revision_for_url,
+                               const apr_hash_t *revprop_table,
+                               svn_commit_callback2_t commit_callback,
+                               void *commit_baton,
+                               svn_client_ctx_t *ctx,
+                               apr_pool_t *scratch_pool);
+
 /**
  * Set @a propname to @a propval on each (const char *) target in @a
  * targets.  The targets must be all working copy paths.  A @a propval
@@ -117,6 +117,8 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_SERF_LOG_COMPONENTS       "serf-log-components"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_SERF_LOG_LEVEL            "serf-log-level"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_VERIFY_BASE_CHECKSUMS     "verify-base-checksums"
 
 
 #define SVN_CONFIG_CATEGORY_CONFIG          "config"
@@ -161,6 +163,12 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_MEMORY_CACHE_SIZE         "memory-cache-size"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_DIFF_IGNORE_CONTENT_TYPE  "diff-ignore-content-type"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_BLAME_CACHE_DIR           "blame-cache-dir"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_CHECKOUT_WORKERS          "checkout-workers"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_EXPORT_WORKERS            "export-workers"
 #define SVN_CONFIG_SECTION_TUNNELS              "tunnels"
 #define SVN_CONFIG_SECTION_AUTO_PROPS           "auto-props"
 /** @since New in 1.8. */
@@ -171,6 +179,12 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_SQLITE_EXCLUSIVE_CLIENTS  "exclusive-locking-clients"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_SQLITE_BUSY_TIMEOUT       "busy-timeout"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_SQLITE_WAL                "wal-mode"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_SHARED_PRISTINE_STORE     "shared-pristine-store"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_STORE_PRISTINES           "store-pristines"
 /** @} */
 
 /** @name Repository conf directory configuration files strings
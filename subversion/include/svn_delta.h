@@ -526,7 +526,10 @@ svn_txdelta_apply(svn_stream_t *source,
  *
  * @since New in 1.7.  Since 1.10, @a svndiff_version can be 2 for the
  * svndiff2 format.  @a compression_level is currently ignored if
- * @a svndiff_version is set to 2.
+ * @a svndiff_version is set to 2.  Since 1.15, @a svndiff_version can
+ * be 3 for the zstd-based svndiff3 format, provided that Subversion
+ * has been compiled with zstd support; in that case,
+ * @a compression_level is interpreted as the zstd compression level.
  */
 void
 svn_txdelta_to_svndiff3(svn_txdelta_window_handler_t *handler,
@@ -487,6 +487,15 @@ typedef struct svn_diff_file_options_t
    *
    * @since New in 1.9 */
   int context_size;
+
+  /** Whether to use the histogram diff algorithm instead of the default
+   * LCS algorithm when comparing two sources.  Histogram diff anchors
+   * matches on low-occurrence lines and is much faster on inputs with
+   * many repeated lines (e.g. machine-generated files), at the cost of
+   * not always producing a minimal diff.  The default is @c FALSE.
+   *
+   * @since New in 1.15 */
+  svn_boolean_t use_histogram_diff;
 } svn_diff_file_options_t;
 
 /** Allocate a @c svn_diff_file_options_t structure in @a pool, initializing
@@ -511,6 +520,8 @@ svn_diff_file_options_create(apr_pool_t *pool);
  * - --show-c-function, -p @since New in 1.5.
  * - --context, -U ARG @since New in 1.9.
  * - --unified, -u (for compatibility, does nothing).
+ * - --diff-algorithm ARG, with ARG one of 'myers' or 'histogram'
+ *   @since New in 1.15.
  */
 svn_error_t *
 svn_diff_file_options_parse(svn_diff_file_options_t *options,
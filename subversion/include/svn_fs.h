@@ -146,6 +146,36 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_BLOCK_READ           "fsfs-block-read"
 
+/** Enable / disable page-cache-friendly bulk reads in FSFS repositories.
+ *
+ * When enabled, the OS will be advised that rev / pack file contents
+ * opened through this filesystem object get read sequentially and at
+ * most once, and that their cached pages may be dropped again when the
+ * respective file gets closed.  Intended for bulk maintenance operations
+ * such as 'svnadmin dump' and 'svnadmin pack' running next to a live
+ * server, so their large sequential scans don't evict the server's hot
+ * working set from the page cache.  Ignored on platforms that do not
+ * support the respective hints.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_BULK_READS           "fsfs-bulk-reads"
+
+/** Select the cache eviction priority context for a FSFS repository.
+ *
+ * "low" marks this filesystem object as belonging to a maintenance
+ * operation (verify, dump, pack, ...): everything it inserts into a
+ * shared membuffer cache uses the lowest eviction priority, so a bulk
+ * scan cannot displace the working set of a live server sharing that
+ * cache.  "high" marks an interactive server context and promotes
+ * default-priority cache content to the high priority class.  Any
+ * other value, or the absence of this option, keeps the built-in
+ * per-cache priorities.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_CACHE_PRIORITY       "fsfs-cache-priority"
+
 /** String with a decimal representation of the FSFS format shard size.
  * Zero ("0") means that a repository with linear layout should be created.
  *
@@ -2323,6 +2353,51 @@ svn_fs_dir_entries(apr_hash_t **entries_p,
                    const char *path,
                    apr_pool_t *pool);
 
+/** A directory entry as returned by svn_fs_dir_entries_full(), i.e. an
+ * #svn_fs_dirent_t extended by the node-revision essentials that tree
+ * walkers typically query for every entry.
+ *
+ * The first three members match #svn_fs_dirent_t.
+ *
+ * @since New in 1.15. */
+typedef struct svn_fs_dirent_full_t
+{
+
+  /** The name of this directory entry.  */
+  const char *name;
+
+  /** The node revision ID it names.  */
+  const svn_fs_id_t *id;
+
+  /** The node kind. */
+  svn_node_kind_t kind;
+
+  /** Length of the file, 0 for directories.  */
+  svn_filesize_t size;
+
+  /** Does the node have any properties? */
+  svn_boolean_t has_props;
+
+  /** Revision in which this node revision was created. */
+  svn_revnum_t created_rev;
+
+} svn_fs_dirent_full_t;
+
+/** Same as svn_fs_dir_entries(), but the values of @a *entries_p are
+ * pointers to #svn_fs_dirent_full_t structures.
+ *
+ * FS backends may be able to answer this in a single batched pass over
+ * their caches.  Prefer it over svn_fs_dir_entries() followed by
+ * per-entry svn_fs_file_length() etc. calls when walking trees.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_dir_entries_full(apr_hash_t **entries_p,
+                        svn_fs_root_t *root,
+                        const char *path,
+                        apr_pool_t *pool);
+
 /** Take the #svn_fs_dirent_t structures in @a entries as returned by
  * #svn_fs_dir_entries for @a root and determine an optimized ordering
  * in which data access would most likely be efficient.  Set @a *ordered_p
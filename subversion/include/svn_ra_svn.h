@@ -50,6 +50,7 @@ extern "C" {
 #define SVN_RA_SVN_CAP_EDIT_PIPELINE "edit-pipeline"
 #define SVN_RA_SVN_CAP_SVNDIFF1 "svndiff1"
 #define SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED "accepts-svndiff2"
+#define SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED "accepts-svndiff3"
 #define SVN_RA_SVN_CAP_ABSENT_ENTRIES "absent-entries"
 /* maps to SVN_RA_CAPABILITY_COMMIT_REVPROPS: */
 #define SVN_RA_SVN_CAP_COMMIT_REVPROPS "commit-revprops"
@@ -71,6 +72,15 @@ extern "C" {
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
 /* maps to SVN_RA_CAPABILITY_LIST */
 #define SVN_RA_SVN_CAP_LIST "list"
+/* The receiver accepts small added files as single put-file editor
+ * commands instead of the usual add-file ... close-file sequence. */
+#define SVN_RA_SVN_CAP_PUT_FILE "put-file"
+/* The sender accepts transport-level compression of whole protocol
+ * frames using the respective algorithm.  Negotiated during the
+ * initial handshake; all traffic after the client's greeting response
+ * is framed when both sides support a common algorithm. */
+#define SVN_RA_SVN_CAP_FRAME_COMPRESSION_LZ4 "frame-compression-lz4"
+#define SVN_RA_SVN_CAP_FRAME_COMPRESSION_ZSTD "frame-compression-zstd"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
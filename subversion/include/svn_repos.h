@@ -3342,10 +3342,51 @@ svn_repos_verify_fs(svn_repos_t *repos,
  * @a cancel_baton as argument to see if the client wishes to cancel
  * the dump.
  *
+ * If @a num_threads is greater than 1, produce the records of up to
+ * that many revisions concurrently while a single writer emits them to
+ * @a stream strictly in revision order.  The output is identical to a
+ * serial dump.  When combined with @a filter_func, the callback may be
+ * invoked from multiple threads concurrently and must therefore be
+ * reentrant.  On builds without thread support, the value is ignored.
+ *
+ * If @a compress is @c TRUE, wrap the emitted records into a container
+ * of zstd-compressed blocks with an embedded revision index.  Blocks
+ * never span revision boundaries, so the index allows a later load to
+ * seek directly to a revision range (and allows decompressing distinct
+ * revisions in parallel).  'svnadmin load' reads such containers
+ * transparently.
+ *
  * Use @a scratch_pool for temporary allocation.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_dump_fs5(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   apr_size_t num_threads,
+                   svn_boolean_t compress,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *scratch_pool);
+
+/**
+ * Similar to svn_repos_dump_fs5(), but with @a num_threads set to 1
+ * and @a compress set to @c FALSE.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_stream_t *stream,
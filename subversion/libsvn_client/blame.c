@@ -36,7 +36,11 @@
 #include "svn_props.h"
 #include "svn_hash.h"
 #include "svn_sorts.h"
+#include "svn_config.h"
+#include "svn_io.h"
+#include "svn_checksum.h"
 
+#include "private/svn_diff_private.h"
 #include "private/svn_wc_private.h"
 
 #include "svn_private_config.h"
@@ -74,6 +78,14 @@ struct diff_baton {
   const struct rev *rev;
 };
 
+/* Size (in bytes) up to which revisions of the file are kept and diffed
+   in memory.  This avoids two tempfile round-trips per revision, which
+   easily dominates the client-side cost when blaming files with long
+   histories.  Larger revisions (and merge-aware blames, which need their
+   intermediate results to outlive several iterations) use tempfiles as
+   before. */
+#define MAX_INMEMORY_CONTENTS_SIZE (8 * 1024 * 1024)
+
 /* The baton used for a file revision. Lives the entire operation */
 struct file_rev_baton {
   svn_revnum_t start_rev, end_rev;
@@ -81,8 +93,20 @@ struct file_rev_baton {
   const char *target;
   svn_client_ctx_t *ctx;
   const svn_diff_file_options_t *diff_options;
-  /* name of file containing the previous revision of the file */
+  /* name of file containing the previous revision of the file;
+     NULL if the previous revision is kept in LAST_CONTENTS instead */
   const char *last_filename;
+  /* contents of the previous revision of the file, if it is being kept
+     in memory; NULL otherwise */
+  svn_stringbuf_t *last_contents;
+  /* if TRUE, keep revisions in tempfiles rather than in memory */
+  svn_boolean_t use_tempfiles;
+  /* carries the tokenization of each revision over to the next in-memory
+     diff, so that every revision is tokenized and hashed only once */
+  svn_diff__mem_cache_t *diff_cache;
+  /* if TRUE, CHAIN was pre-seeded from the on-disk blame cache and the
+     first revision delivered by the server is already attributed */
+  svn_boolean_t chain_seeded;
   struct rev *last_rev;   /* the rev of the last modification */
   struct blame_chain *chain;      /* the original blame chain. */
   const char *repos_root_url;    /* To construct a url */
@@ -115,7 +139,8 @@ struct delta_baton {
   void *wrapped_baton;
   struct file_rev_baton *file_rev_baton;
   svn_stream_t *source_stream;  /* the delta source */
-  const char *filename;
+  const char *filename;         /* tempfile with the delta result, or NULL */
+  svn_stringbuf_t *content;     /* in-memory delta result, or NULL */
   svn_boolean_t is_merged_revision;
   struct rev *rev;     /* the rev struct for the current revision */
 };
@@ -282,20 +307,27 @@ static const svn_diff_output_fns_t output_fns = {
         output_diff_modified
 };
 
-/* Add the blame for the diffs between LAST_FILE and CUR_FILE to CHAIN,
-   for revision REV.  LAST_FILE may be NULL in which
-   case blame is added for every line of CUR_FILE. */
+/* Add the blame for the diffs between the previous and the current revision
+   of the file to CHAIN, for revision REV.  The revisions are given either
+   as files LAST_FILE and CUR_FILE or as in-memory contents LAST_CONTENT
+   and CUR_CONTENT; the unused representation is NULL.  Both LAST_FILE and
+   LAST_CONTENT may be NULL, in which case blame is added for every line of
+   the current revision.  If DIFF_CACHE is not NULL, in-memory diffs reuse
+   the tokenization of LAST_CONTENT computed by the previous call. */
 static svn_error_t *
 add_file_blame(const char *last_file,
                const char *cur_file,
+               svn_stringbuf_t *last_content,
+               svn_stringbuf_t *cur_content,
                struct blame_chain *chain,
                struct rev *rev,
                const svn_diff_file_options_t *diff_options,
+               svn_diff__mem_cache_t *diff_cache,
                svn_cancel_func_t cancel_func,
                void *cancel_baton,
                apr_pool_t *pool)
 {
-  if (!last_file)
+  if (!last_file && !last_content)
     {
       SVN_ERR_ASSERT(chain->blame == NULL);
       chain->blame = blame_create(chain, rev, 0);
@@ -308,9 +340,28 @@ add_file_blame(const char *last_file,
       diff_baton.chain = chain;
       diff_baton.rev = rev;
 
-      /* We have a previous file.  Get the diff and adjust blame info. */
-      SVN_ERR(svn_diff_file_diff_2(&diff, last_file, cur_file,
-                                   diff_options, pool));
+      /* We have a previous revision.  Get the diff and adjust blame info. */
+      if (cur_content)
+        {
+          svn_string_t last_str;
+          svn_string_t cur_str;
+
+          last_str.data = last_content ? last_content->data : "";
+          last_str.len = last_content ? last_content->len : 0;
+          cur_str.data = cur_content->data;
+          cur_str.len = cur_content->len;
+
+          if (diff_cache)
+            SVN_ERR(svn_diff__mem_string_diff_cached(&diff, diff_cache,
+                                                     &last_str, &cur_str,
+                                                     diff_options, pool));
+          else
+            SVN_ERR(svn_diff_mem_string_diff(&diff, &last_str, &cur_str,
+                                             diff_options, pool));
+        }
+      else
+        SVN_ERR(svn_diff_file_diff_2(&diff, last_file, cur_file,
+                                     diff_options, pool));
       SVN_ERR(svn_diff_output2(diff, &diff_baton, &output_fns,
                                cancel_func, cancel_baton));
     }
@@ -318,6 +369,29 @@ add_file_blame(const char *last_file,
   return SVN_NO_ERROR;
 }
 
+/* Write FRB->last_contents to a tempfile allocated in POOL, make it the
+   new FRB->last_filename and switch FRB to tempfile mode.  POOL must be
+   the pool that FRB->last_contents was allocated in, so that the tempfile
+   lives exactly as long as the buffer it replaces would have. */
+static svn_error_t *
+spill_to_tempfile(struct file_rev_baton *frb,
+                  apr_pool_t *pool)
+{
+  svn_stream_t *tempfile;
+  apr_size_t len = frb->last_contents->len;
+
+  SVN_ERR(svn_stream_open_unique(&tempfile, &frb->last_filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 pool, pool));
+  SVN_ERR(svn_stream_write(tempfile, frb->last_contents->data, &len));
+  SVN_ERR(svn_stream_close(tempfile));
+
+  frb->last_contents = NULL;
+  frb->use_tempfiles = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
 /* Record the blame information for the revision in BATON->file_rev_baton.
  */
 static svn_error_t *
@@ -342,11 +416,20 @@ update_blame(void *baton)
     chain = frb->chain;
 
   /* Process this file. */
-  SVN_ERR(add_file_blame(frb->last_filename,
-                         dbaton->filename, chain, dbaton->rev,
-                         frb->diff_options,
-                         frb->ctx->cancel_func, frb->ctx->cancel_baton,
-                         frb->currpool));
+  if (frb->chain_seeded && !frb->last_filename && !frb->last_contents)
+    {
+      /* First revision delivered after a blame cache hit: the seeded
+         chain already attributes its lines, so just adopt the contents
+         as the base for diffing the revisions that follow. */
+    }
+  else
+    SVN_ERR(add_file_blame(frb->last_filename,
+                           dbaton->filename,
+                           frb->last_contents, dbaton->content,
+                           chain, dbaton->rev,
+                           frb->diff_options, frb->diff_cache,
+                           frb->ctx->cancel_func, frb->ctx->cancel_baton,
+                           frb->currpool));
 
   /* If we are including merged revisions, and the current revision is not a
      merged one, we need to add its blame info to the chain for the original
@@ -356,8 +439,9 @@ update_blame(void *baton)
       apr_pool_t *tmppool;
 
       SVN_ERR(add_file_blame(frb->last_original_filename,
-                             dbaton->filename, frb->chain, dbaton->rev,
-                             frb->diff_options,
+                             dbaton->filename, NULL, NULL,
+                             frb->chain, dbaton->rev,
+                             frb->diff_options, NULL,
                              frb->ctx->cancel_func, frb->ctx->cancel_baton,
                              frb->currpool));
 
@@ -374,8 +458,17 @@ update_blame(void *baton)
 
   /* Prepare for next revision. */
 
-  /* Remember the file name so we can diff it with the next revision. */
+  /* Remember the contents so we can diff them with the next revision. */
   frb->last_filename = dbaton->filename;
+  frb->last_contents = dbaton->content;
+
+  /* If this revision has grown too large to keep in memory, spill it to
+     a tempfile and diff from files from here on.  The tempfile goes into
+     the buffer's own pool (the current pool, about to become the last
+     pool), which gives it the same lifetime the buffer would have had. */
+  if (frb->last_contents
+      && frb->last_contents->len > MAX_INMEMORY_CONTENTS_SIZE)
+    SVN_ERR(spill_to_tempfile(frb, frb->currpool));
 
   /* Switch pools. */
   {
@@ -495,12 +588,25 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
   delta_baton = apr_pcalloc(frb->currpool, sizeof(*delta_baton));
 
   /* Prepare the text delta window handler. */
-  if (frb->last_filename)
-    SVN_ERR(svn_stream_open_readonly(&delta_baton->source_stream, frb->last_filename,
-                                     frb->currpool, pool));
+  if (frb->use_tempfiles)
+    {
+      if (frb->last_filename)
+        SVN_ERR(svn_stream_open_readonly(&delta_baton->source_stream,
+                                         frb->last_filename,
+                                         frb->currpool, pool));
+      else
+        /* Means empty stream below. */
+        delta_baton->source_stream = NULL;
+    }
   else
-    /* Means empty stream below. */
-    delta_baton->source_stream = NULL;
+    {
+      if (frb->last_contents)
+        delta_baton->source_stream = svn_stream_from_stringbuf(
+                                       frb->last_contents, frb->currpool);
+      else
+        /* Means empty stream below. */
+        delta_baton->source_stream = NULL;
+    }
   last_stream = svn_stream_disown(delta_baton->source_stream, pool);
 
   if (frb->include_merged_revisions && !merged_revision)
@@ -508,9 +614,17 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
   else
     filepool = frb->currpool;
 
-  SVN_ERR(svn_stream_open_unique(&cur_stream, &delta_baton->filename, NULL,
-                                 svn_io_file_del_on_pool_cleanup,
-                                 filepool, filepool));
+  if (frb->use_tempfiles)
+    SVN_ERR(svn_stream_open_unique(&cur_stream, &delta_baton->filename, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   filepool, filepool));
+  else
+    {
+      /* Apply the delta to an in-memory buffer, avoiding two tempfile
+         round-trips per revision. */
+      delta_baton->content = svn_stringbuf_create_empty(filepool);
+      cur_stream = svn_stream_from_stringbuf(delta_baton->content, filepool);
+    }
 
   /* Wrap the window handler with our own. */
   delta_baton->file_rev_baton = frb;
@@ -549,7 +663,8 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
     {
       /* We shouldn't get more than one revision outside the
          specified range (unless we alsoe receive merged revisions) */
-      SVN_ERR_ASSERT((frb->last_filename == NULL)
+      SVN_ERR_ASSERT((frb->last_filename == NULL
+                      && frb->last_contents == NULL)
                      || frb->include_merged_revisions);
 
       /* The file existed before start_rev; generate no blame info for
@@ -655,6 +770,300 @@ normalize_blames(struct blame_chain *chain,
     }
 }
 
+
+/*** The persistent blame cache. ***/
+
+/* Hash keys used in blame cache files.  A cache file is the flat hash
+   dump produced by svn_hash_write2(), following the storage idiom of the
+   auth area:
+     realm       the full cache key, to guard against digest collisions
+     end-rev     the revision the cached blame chain corresponds to
+     blame       space-separated "start revision" pairs, in chunk order
+     rev:N:PROP  revision property PROP of revision N  */
+#define BLAME_CACHE_KEY_REALM       "realm"
+#define BLAME_CACHE_KEY_END_REV     "end-rev"
+#define BLAME_CACHE_KEY_BLAME       "blame"
+#define BLAME_CACHE_KEY_REV_PREFIX  "rev:"
+
+/* Set *CACHE_PATH to the blame cache file for the file blamed via
+   RA_SESSION, or to NULL if no blame cache directory is configured in
+   CTX->config.  Set *REALMSTRING to the full cache key; it identifies
+   the blamed file by repository UUID and repository-relative path and
+   records the parameters the cached chain depends on.  As in the auth
+   area, the file name is the MD5 digest of *REALMSTRING. */
+static svn_error_t *
+blame_cache_path(const char **cache_path,
+                 const char **realmstring,
+                 svn_ra_session_t *ra_session,
+                 svn_revnum_t start_revnum,
+                 const svn_diff_file_options_t *diff_options,
+                 svn_client_ctx_t *ctx,
+                 apr_pool_t *pool)
+{
+  svn_config_t *cfg;
+  const char *cache_dir;
+  const char *uuid;
+  const char *session_url;
+  const char *repos_root_url;
+  const char *relpath;
+  svn_checksum_t *checksum;
+
+  *cache_path = NULL;
+  *realmstring = NULL;
+
+  cfg = ctx->config ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                    : NULL;
+  svn_config_get(cfg, &cache_dir, SVN_CONFIG_SECTION_MISCELLANY,
+                 SVN_CONFIG_OPTION_BLAME_CACHE_DIR, NULL);
+  if (!cache_dir || !*cache_dir)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_ra_get_uuid2(ra_session, &uuid, pool));
+  SVN_ERR(svn_ra_get_session_url(ra_session, &session_url, pool));
+  SVN_ERR(svn_ra_get_repos_root2(ra_session, &repos_root_url, pool));
+  relpath = svn_uri_skip_ancestor(repos_root_url, session_url, pool);
+
+  /* The chain also depends on the start boundary (older lines are
+     reported as unattributed) and on the whitespace/eol handling of the
+     diffs, so those become part of the key. */
+  *realmstring = apr_psprintf(pool, "%s\n/%s\n%ld\n%d %d",
+                              uuid, relpath ? relpath : "", start_revnum,
+                              diff_options ? (int)diff_options->ignore_space
+                                           : 0,
+                              diff_options
+                                ? (int)diff_options->ignore_eol_style : 0);
+
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_md5, *realmstring,
+                       strlen(*realmstring), pool));
+  *cache_path = svn_dirent_join(svn_dirent_canonicalize(cache_dir, pool),
+                                svn_checksum_to_cstring(checksum, pool),
+                                pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Seed FRB->chain from the cache file CACHE_PATH, if it exists, matches
+   REALMSTRING and holds a chain no younger than END_REVNUM.  On success,
+   set *CACHED_END to the cached end revision and FRB->chain_seeded to
+   TRUE; the caller then starts fetching revisions at *CACHED_END instead
+   of at the beginning of the history.  Unreadable, mismatching or
+   corrupt cache files are silently ignored. */
+static svn_error_t *
+read_blame_cache(svn_revnum_t *cached_end,
+                 struct file_rev_baton *frb,
+                 const char *cache_path,
+                 const char *realmstring,
+                 svn_revnum_t end_revnum,
+                 apr_pool_t *scratch_pool)
+{
+  svn_node_kind_t kind;
+  svn_stream_t *stream;
+  apr_hash_t *hash;
+  apr_hash_t *revs;
+  apr_hash_index_t *hi;
+  const svn_string_t *realm;
+  const svn_string_t *end_rev_str;
+  const svn_string_t *chunks_str;
+  apr_array_header_t *tokens;
+  struct blame *tail = NULL;
+  svn_revnum_t end_rev;
+  svn_error_t *err;
+  int i;
+
+  *cached_end = SVN_INVALID_REVNUM;
+
+  SVN_ERR(svn_io_check_path(cache_path, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  err = svn_stream_open_readonly(&stream, cache_path, scratch_pool,
+                                 scratch_pool);
+  if (!err)
+    {
+      hash = apr_hash_make(scratch_pool);
+      err = svn_hash_read2(hash, stream, SVN_HASH_TERMINATOR, scratch_pool);
+      err = svn_error_compose_create(err, svn_stream_close(stream));
+    }
+  if (err)
+    {
+      /* A broken cache is no worse than no cache. */
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  realm = svn_hash_gets(hash, BLAME_CACHE_KEY_REALM);
+  end_rev_str = svn_hash_gets(hash, BLAME_CACHE_KEY_END_REV);
+  chunks_str = svn_hash_gets(hash, BLAME_CACHE_KEY_BLAME);
+  if (!realm || strcmp(realm->data, realmstring) != 0
+      || !end_rev_str || !chunks_str)
+    return SVN_NO_ERROR;
+
+  /* Only a history we can extend forwards is usable. */
+  end_rev = SVN_STR_TO_REV(end_rev_str->data);
+  if (!SVN_IS_VALID_REVNUM(end_rev) || end_rev > end_revnum)
+    return SVN_NO_ERROR;
+
+  /* Collect the cached revision properties, keyed by revision number. */
+  revs = apr_hash_make(scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, hash); hi; hi = apr_hash_next(hi))
+    {
+      const char *key = apr_hash_this_key(hi);
+      const svn_string_t *value = apr_hash_this_val(hi);
+      const char *revnum_str;
+      char *next;
+      struct rev *rev;
+
+      if (strncmp(key, BLAME_CACHE_KEY_REV_PREFIX,
+                  strlen(BLAME_CACHE_KEY_REV_PREFIX)) != 0)
+        continue;
+
+      revnum_str = key + strlen(BLAME_CACHE_KEY_REV_PREFIX);
+      next = strchr(revnum_str, ':');
+      if (!next)
+        return SVN_NO_ERROR;  /* corrupt; ignore the whole cache */
+
+      revnum_str = apr_pstrndup(scratch_pool, revnum_str,
+                                next - revnum_str);
+      rev = svn_hash_gets(revs, revnum_str);
+      if (!rev)
+        {
+          rev = apr_pcalloc(frb->mainpool, sizeof(*rev));
+          rev->revision = SVN_STR_TO_REV(revnum_str);
+          rev->rev_props = apr_hash_make(frb->mainpool);
+          svn_hash_sets(revs, apr_pstrdup(scratch_pool, revnum_str), rev);
+        }
+
+      svn_hash_sets(rev->rev_props,
+                    apr_pstrdup(frb->mainpool, next + 1),
+                    svn_string_dup(value, frb->mainpool));
+    }
+
+  /* Rebuild the blame chain. */
+  tokens = svn_cstring_split(chunks_str->data, " ", TRUE, scratch_pool);
+  if (tokens->nelts == 0 || tokens->nelts % 2 != 0)
+    return SVN_NO_ERROR;
+
+  for (i = 0; i < tokens->nelts; i += 2)
+    {
+      apr_int64_t start, revision;
+      struct blame *chunk;
+      struct rev *rev;
+
+      err = svn_cstring_atoi64(&start,
+                               APR_ARRAY_IDX(tokens, i, const char *));
+      if (!err)
+        err = svn_cstring_atoi64(&revision,
+                                 APR_ARRAY_IDX(tokens, i + 1, const char *));
+      if (err || (tail ? start <= tail->start : start != 0))
+        {
+          /* Corrupt chunk list; discard the partial seed. */
+          svn_error_clear(err);
+          frb->chain->blame = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      if (SVN_IS_VALID_REVNUM((svn_revnum_t)revision))
+        {
+          rev = svn_hash_gets(revs,
+                              apr_psprintf(scratch_pool, "%ld",
+                                           (svn_revnum_t)revision));
+          if (!rev)
+            {
+              rev = apr_pcalloc(frb->mainpool, sizeof(*rev));
+              rev->revision = (svn_revnum_t)revision;
+              rev->rev_props = apr_hash_make(frb->mainpool);
+            }
+        }
+      else
+        {
+          /* A line older than the start revision; reported without
+             attribution, just as file_rev_handler would. */
+          rev = apr_pcalloc(frb->mainpool, sizeof(*rev));
+          rev->revision = SVN_INVALID_REVNUM;
+        }
+
+      chunk = blame_create(frb->chain, rev, (apr_off_t)start);
+      if (tail)
+        tail->next = chunk;
+      else
+        frb->chain->blame = chunk;
+      tail = chunk;
+    }
+
+  frb->chain_seeded = TRUE;
+  *cached_end = end_rev;
+
+  return SVN_NO_ERROR;
+}
+
+/* Write FRB->chain, valid through END_REVNUM, to the cache file
+   CACHE_PATH, keyed by REALMSTRING.  Use the tmpfile-and-rename dance of
+   the auth store so that concurrent readers never see a half-written
+   cache file. */
+static svn_error_t *
+write_blame_cache(struct file_rev_baton *frb,
+                  const char *cache_path,
+                  const char *realmstring,
+                  svn_revnum_t end_revnum,
+                  apr_pool_t *scratch_pool)
+{
+  apr_hash_t *hash = apr_hash_make(scratch_pool);
+  svn_stringbuf_t *chunks = svn_stringbuf_create_empty(scratch_pool);
+  struct blame *walk;
+  svn_stream_t *stream;
+  const char *tmp_path;
+
+  for (walk = frb->chain->blame; walk; walk = walk->next)
+    {
+      svn_revnum_t revision = walk->rev ? walk->rev->revision
+                                        : SVN_INVALID_REVNUM;
+
+      if (chunks->len > 0)
+        svn_stringbuf_appendbyte(chunks, ' ');
+      svn_stringbuf_appendcstr(chunks,
+                               apr_psprintf(scratch_pool,
+                                            "%" APR_OFF_T_FMT " %ld",
+                                            walk->start, revision));
+
+      if (walk->rev && walk->rev->rev_props)
+        {
+          apr_hash_index_t *hi;
+
+          for (hi = apr_hash_first(scratch_pool, walk->rev->rev_props);
+               hi;
+               hi = apr_hash_next(hi))
+            {
+              svn_hash_sets(hash,
+                            apr_psprintf(scratch_pool,
+                                         BLAME_CACHE_KEY_REV_PREFIX "%ld:%s",
+                                         revision,
+                                         (const char *)apr_hash_this_key(hi)),
+                            apr_hash_this_val(hi));
+            }
+        }
+    }
+
+  svn_hash_sets(hash, BLAME_CACHE_KEY_REALM,
+                svn_string_create(realmstring, scratch_pool));
+  svn_hash_sets(hash, BLAME_CACHE_KEY_END_REV,
+                svn_string_createf(scratch_pool, "%ld", end_revnum));
+  svn_hash_sets(hash, BLAME_CACHE_KEY_BLAME,
+                svn_string_create_from_buf(chunks, scratch_pool));
+
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(cache_path,
+                                                         scratch_pool),
+                                      scratch_pool));
+  SVN_ERR(svn_stream_open_unique(&stream, &tmp_path,
+                                 svn_dirent_dirname(cache_path, scratch_pool),
+                                 svn_io_file_del_on_pool_cleanup,
+                                 scratch_pool, scratch_pool));
+  SVN_ERR(svn_hash_write2(hash, stream, SVN_HASH_TERMINATOR, scratch_pool));
+  SVN_ERR(svn_stream_close(stream));
+  SVN_ERR(svn_io_file_rename2(tmp_path, cache_path, FALSE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_client_blame6(svn_revnum_t *start_revnum_p,
                   svn_revnum_t *end_revnum_p,
@@ -678,6 +1087,9 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   svn_stream_t *last_stream;
   svn_stream_t *stream;
   const char *target_abspath_or_url;
+  const char *cache_path;
+  const char *cache_realm;
+  svn_revnum_t cached_end;
 
   if (start->kind == svn_opt_revision_unspecified
       || end->kind == svn_opt_revision_unspecified)
@@ -779,6 +1191,13 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   frb.diff_options = diff_options;
   frb.include_merged_revisions = include_merged_revisions;
   frb.last_filename = NULL;
+  frb.last_contents = NULL;
+  /* The merge-aware code keeps two lines of history side by side and
+     rotates their tempfiles through dedicated pools; it stays on the
+     tempfile path.  Plain blames diff in memory. */
+  frb.use_tempfiles = include_merged_revisions;
+  frb.diff_cache = frb.use_tempfiles ? NULL : svn_diff__mem_cache_create(pool);
+  frb.chain_seeded = FALSE;
   frb.last_rev = NULL;
   frb.last_original_filename = NULL;
   frb.chain = apr_palloc(pool, sizeof(*frb.chain));
@@ -811,17 +1230,43 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
       frb.prevfilepool = svn_pool_create(pool);
     }
 
+  /* If a blame cache directory is configured, try to seed the chain with
+     the result of an earlier run, so that we only have to fetch and diff
+     the revisions committed since then. */
+  cache_path = NULL;
+  cache_realm = NULL;
+  cached_end = SVN_INVALID_REVNUM;
+  if (!include_merged_revisions && !frb.backwards)
+    {
+      SVN_ERR(blame_cache_path(&cache_path, &cache_realm, ra_session,
+                               start_revnum, diff_options, ctx, pool));
+      if (cache_path)
+        SVN_ERR(read_blame_cache(&cached_end, &frb, cache_path, cache_realm,
+                                 end_revnum, pool));
+    }
+
   /* Collect all blame information.
      We need to ensure that we get one revision before the start_rev,
      if available so that we can know what was actually changed in the start
-     revision. */
+     revision.  On a cache hit we start at the cached end revision instead;
+     its contents come across as the first reported revision and serve as
+     the base for the newer deltas. */
   SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
-                                frb.backwards ? start_revnum
-                                              : MAX(0, start_revnum-1),
+                                SVN_IS_VALID_REVNUM(cached_end)
+                                  ? cached_end
+                                  : (frb.backwards ? start_revnum
+                                                   : MAX(0, start_revnum-1)),
                                 end_revnum,
                                 include_merged_revisions,
                                 file_rev_handler, &frb, pool));
 
+  /* Remember the result for the next run.  This happens before any
+     local modifications are merged in below; the cache only describes
+     committed history. */
+  if (cache_path)
+    SVN_ERR(write_blame_cache(&frb, cache_path, cache_realm, end_revnum,
+                              pool));
+
   if (end->kind == svn_opt_revision_working)
     {
       /* If the local file is modified we have to call the handler on the
@@ -841,6 +1286,11 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
           svn_boolean_t normalize_eols = FALSE;
           const char *temppath;
 
+          /* The working copy file is diffed from a tempfile; make sure the
+             last repository revision is available as a file, too. */
+          if (frb.last_contents)
+            SVN_ERR(spill_to_tempfile(&frb, frb.lastpool));
+
           if (status->prop_status != svn_wc_status_none)
             {
               const svn_string_t *eol_style;
@@ -874,7 +1324,8 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
           SVN_ERR(svn_stream_copy3(wcfile, tempfile, ctx->cancel_func,
                                    ctx->cancel_baton, pool));
 
-          SVN_ERR(add_file_blame(frb.last_filename, temppath, frb.chain, NULL,
+          SVN_ERR(add_file_blame(frb.last_filename, temppath, NULL, NULL,
+                                 frb.chain, NULL,
                                  frb.diff_options,
                                  ctx->cancel_func, ctx->cancel_baton, pool));
 
@@ -885,14 +1336,19 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   /* Report the blame to the caller. */
 
   /* The callback has to have been called at least once. */
-  SVN_ERR_ASSERT(frb.last_filename != NULL);
+  SVN_ERR_ASSERT(frb.last_filename != NULL || frb.last_contents != NULL);
 
   /* Create a pool for the iteration below. */
   iterpool = svn_pool_create(pool);
 
-  /* Open the last file and get a stream. */
-  SVN_ERR(svn_stream_open_readonly(&last_stream, frb.last_filename,
-                                   pool, pool));
+  /* Open the last revision and get a stream.  (The in-memory contents
+     live in frb.lastpool, which is not destroyed until after the
+     iteration below.) */
+  if (frb.last_contents)
+    last_stream = svn_stream_from_stringbuf(frb.last_contents, pool);
+  else
+    SVN_ERR(svn_stream_open_readonly(&last_stream, frb.last_filename,
+                                     pool, pool));
   stream = svn_subst_stream_translated(last_stream,
                                        "\n", TRUE, NULL, FALSE, pool);
 
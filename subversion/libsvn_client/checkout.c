@@ -27,9 +27,14 @@
 
 /*** Includes. ***/
 
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+
+#include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_wc.h"
 #include "svn_client.h"
+#include "svn_config.h"
 #include "svn_ra.h"
 #include "svn_types.h"
 #include "svn_error.h"
@@ -64,6 +69,424 @@ initialize_area(const char *local_abspath,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/*** Parallel checkout engine. ***/
+
+/* Hard limit on the number of concurrent checkout workers.  Each worker
+ * costs an RA session, an open repository connection and a wc.db
+ * connection, so there is little point in going higher. */
+#define CHECKOUT_MAX_WORKERS 16
+
+/* Serializes the notification and cancellation callbacks of the original
+ * client context for use from multiple worker threads. */
+struct co_callback_baton
+{
+  apr_thread_mutex_t *mutex;
+
+  /* The original client context's callbacks.  Either func may be NULL. */
+  svn_wc_notify_func2_t notify_func;
+  void *notify_baton;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+};
+
+/* Implements svn_wc_notify_func2_t.  Forward NOTIFY to the original
+ * notification callback in the co_callback_baton given in BATON, one
+ * worker at a time. */
+static void
+co_notify_func(void *baton,
+               const svn_wc_notify_t *notify,
+               apr_pool_t *pool)
+{
+  struct co_callback_baton *cb = baton;
+
+  apr_thread_mutex_lock(cb->mutex);
+  cb->notify_func(cb->notify_baton, notify, pool);
+  apr_thread_mutex_unlock(cb->mutex);
+}
+
+/* Implements svn_cancel_func_t.  Forward to the original cancellation
+ * callback in the co_callback_baton given in BATON, one worker at a
+ * time. */
+static svn_error_t *
+co_cancel_func(void *baton)
+{
+  struct co_callback_baton *cb = baton;
+  svn_error_t *err;
+
+  apr_thread_mutex_lock(cb->mutex);
+  err = cb->cancel_func(cb->cancel_baton);
+  apr_thread_mutex_unlock(cb->mutex);
+
+  return svn_error_trace(err);
+}
+
+/* The list of subtrees to fetch, shared by all workers. */
+struct co_scheduler
+{
+  apr_thread_mutex_t *mutex;
+
+  /* Array of 'const char *' absolute subtree paths still to fetch.
+   * Workers grab the next unclaimed entry, so a worker that finishes a
+   * small subtree early simply moves on to the next one. */
+  apr_array_header_t *targets;
+
+  /* Index of the next unclaimed entry in TARGETS.  Protected by MUTEX. */
+  int next;
+
+  /* Set when any worker failed; makes the remaining workers stop after
+   * the subtree they are currently fetching.  Protected by MUTEX. */
+  svn_boolean_t aborted;
+
+  /* The revision to check out - already resolved to a number, so all
+   * workers see the same tree even if HEAD moves. */
+  const svn_opt_revision_t *revision;
+
+  /* Options inherited from the checkout request. */
+  svn_boolean_t ignore_externals;
+  svn_boolean_t allow_unver_obstructions;
+};
+
+/* A single checkout worker. */
+struct co_worker
+{
+  struct co_scheduler *scheduler;
+
+  /* Private client context, sharing the auth baton with the original one
+   * but using its own wc context and serialized callbacks. */
+  svn_client_ctx_t *ctx;
+
+  /* Private RA session, opened before the worker thread starts. */
+  svn_ra_session_t *session;
+
+  /* Root pool private to this worker, so its allocations don't race
+   * with those of other threads. */
+  apr_pool_t *pool;
+
+  /* First error encountered by this worker. */
+  svn_error_t *err;
+
+  apr_thread_t *thread;
+};
+
+/* Thread function:  Fetch subtrees from the scheduler of the co_worker
+ * given in DATA until none are left or the checkout got aborted. */
+static void * APR_THREAD_FUNC
+co_worker_thread(apr_thread_t *thread,
+                 void *data)
+{
+  struct co_worker *worker = data;
+  struct co_scheduler *scheduler = worker->scheduler;
+  apr_pool_t *iterpool = svn_pool_create(worker->pool);
+
+  while (TRUE)
+    {
+      const char *target;
+      svn_boolean_t sleep_ignored = FALSE;
+      int idx;
+
+      apr_thread_mutex_lock(scheduler->mutex);
+      idx = scheduler->aborted ? scheduler->targets->nelts
+                               : scheduler->next++;
+      apr_thread_mutex_unlock(scheduler->mutex);
+
+      if (idx >= scheduler->targets->nelts)
+        break;
+
+      target = APR_ARRAY_IDX(scheduler->targets, idx, const char *);
+      svn_pool_clear(iterpool);
+
+      /* Deepen the subtree stub created by the initial sparse checkout
+       * to full depth.  The update reparents our session as needed. */
+      worker->err = svn_client__update_internal(
+                        NULL, &sleep_ignored, target,
+                        scheduler->revision, svn_depth_infinity, TRUE,
+                        scheduler->ignore_externals,
+                        scheduler->allow_unver_obstructions,
+                        TRUE /* adds_as_modification */,
+                        FALSE, FALSE, worker->session,
+                        worker->ctx, iterpool);
+      if (worker->err)
+        {
+          apr_thread_mutex_lock(scheduler->mutex);
+          scheduler->aborted = TRUE;
+          apr_thread_mutex_unlock(scheduler->mutex);
+          break;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Determine how many checkout workers the user asked for in CTX's config
+ * and set *WORKERS to that number, clamped to CHECKOUT_MAX_WORKERS.
+ * *WORKERS <= 1 means the parallel engine stays off. */
+static svn_error_t *
+co_get_worker_count(int *workers,
+                    svn_client_ctx_t *ctx)
+{
+  svn_config_t *cfg = ctx->config
+                      ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                      : NULL;
+  apr_int64_t value;
+
+  SVN_ERR(svn_config_get_int64(cfg, &value,
+                               SVN_CONFIG_SECTION_MISCELLANY,
+                               SVN_CONFIG_OPTION_CHECKOUT_WORKERS, 0));
+  if (value > CHECKOUT_MAX_WORKERS)
+    value = CHECKOUT_MAX_WORKERS;
+  if (value < 0)
+    value = 0;
+
+  /* Multiple wc.db connections don't mix with exclusive SQLite locking. */
+  if (value > 1 && cfg)
+    {
+      svn_boolean_t exclusive;
+      SVN_ERR(svn_config_get_bool(cfg, &exclusive,
+                                  SVN_CONFIG_SECTION_WORKING_COPY,
+                                  SVN_CONFIG_OPTION_SQLITE_EXCLUSIVE,
+                                  FALSE));
+      if (exclusive)
+        value = 0;
+    }
+
+  *workers = (int)value;
+
+  return SVN_NO_ERROR;
+}
+
+/* Create a client context for one worker, based on CTX, and return it in
+ * *WORKER_CTX_P, allocated in RESULT_POOL.  The new context shares CTX's
+ * auth baton, serializes notification / cancellation through CB and has
+ * its own wc context. */
+static svn_error_t *
+co_create_worker_context(svn_client_ctx_t **worker_ctx_p,
+                         svn_client_ctx_t *ctx,
+                         struct co_callback_baton *cb,
+                         apr_pool_t *result_pool)
+{
+  svn_client_ctx_t *worker_ctx;
+  apr_hash_t *cfg_hash = NULL;
+
+  /* Give each worker a private copy of the configuration:  option
+   * expansion mutates svn_config_t internals, so the original must not
+   * be read from multiple threads. */
+  if (ctx->config)
+    {
+      svn_config_t *cfg;
+
+      SVN_ERR(svn_config_copy_config(&cfg_hash, ctx->config, result_pool));
+
+      /* Keep externals checked out by this worker from starting nested
+       * parallel engines of their own. */
+      cfg = svn_hash_gets(cfg_hash, SVN_CONFIG_CATEGORY_CONFIG);
+      if (cfg)
+        svn_config_set(cfg, SVN_CONFIG_SECTION_MISCELLANY,
+                       SVN_CONFIG_OPTION_CHECKOUT_WORKERS, "0");
+    }
+
+  SVN_ERR(svn_client_create_context2(&worker_ctx, cfg_hash, result_pool));
+
+  worker_ctx->auth_baton = ctx->auth_baton;
+  worker_ctx->client_name = ctx->client_name;
+  worker_ctx->check_tunnel_func = ctx->check_tunnel_func;
+  worker_ctx->open_tunnel_func = ctx->open_tunnel_func;
+  worker_ctx->tunnel_baton = ctx->tunnel_baton;
+
+  if (cb->notify_func)
+    {
+      worker_ctx->notify_func2 = co_notify_func;
+      worker_ctx->notify_baton2 = cb;
+    }
+  if (cb->cancel_func)
+    {
+      worker_ctx->cancel_func = co_cancel_func;
+      worker_ctx->cancel_baton = cb;
+    }
+
+  *worker_ctx_p = worker_ctx;
+
+  return SVN_NO_ERROR;
+}
+
+/* Check out a full-depth working copy of PATHREV into the freshly
+ * initialized LOCAL_ABSPATH using WORKERS parallel RA sessions.
+ *
+ * This runs in three phases:  a serial sparse checkout of the tree root
+ * at depth 'immediates', a parallel phase in which the workers claim the
+ * top-level subtrees from a shared list and deepen them to full depth
+ * through independent RA sessions and wc contexts, and a final serial
+ * update that restores the root's sticky depth to 'infinity'.  Every
+ * phase pins the same resolved revision, so the result is identical to a
+ * serial checkout.  If anything fails, the working copy is left in the
+ * same state as an interrupted checkout, i.e. a plain 'svn update' will
+ * complete it.
+ *
+ * RA_SESSION is the already open session for PATHREV; IGNORE_EXTERNALS
+ * and ALLOW_UNVER_OBSTRUCTIONS are as for the checkout itself.  Set
+ * *RESULT_REV (if not NULL) to the checked out revision and *USED to
+ * TRUE if the parallel engine ran - it degrades to FALSE if the tree
+ * root has too few subdirectories to win anything by parallelism. */
+static svn_error_t *
+parallel_checkout(svn_revnum_t *result_rev,
+                  svn_boolean_t *used,
+                  const char *local_abspath,
+                  const svn_client__pathrev_t *pathrev,
+                  const svn_opt_revision_t *revision,
+                  svn_boolean_t ignore_externals,
+                  svn_boolean_t allow_unver_obstructions,
+                  int workers,
+                  svn_ra_session_t *ra_session,
+                  svn_client_ctx_t *ctx,
+                  apr_pool_t *scratch_pool)
+{
+  struct co_scheduler scheduler = { 0 };
+  struct co_callback_baton cb = { 0 };
+  struct co_worker *worker_list;
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+  apr_pool_t *pool = svn_pool_create(scratch_pool);
+  svn_boolean_t sleep_ignored = FALSE;
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_status_t status;
+  int started;
+  int i;
+
+  *used = FALSE;
+
+  /* Find the top-level subdirectories to hand out to the workers. */
+  SVN_ERR(svn_ra_get_dir2(ra_session, &dirents, NULL, NULL, "",
+                          pathrev->rev, SVN_DIRENT_KIND, pool));
+
+  scheduler.targets = apr_array_make(pool, apr_hash_count(dirents),
+                                     sizeof(const char *));
+  for (hi = apr_hash_first(pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      svn_dirent_t *dirent = apr_hash_this_val(hi);
+
+      if (dirent->kind == svn_node_dir)
+        APR_ARRAY_PUSH(scheduler.targets, const char *)
+          = svn_dirent_join(local_abspath, name, pool);
+    }
+
+  /* With fewer than two subtrees there is nothing to parallelize. */
+  if (scheduler.targets->nelts < 2)
+    {
+      svn_pool_destroy(pool);
+      return SVN_NO_ERROR;
+    }
+  if (workers > scheduler.targets->nelts)
+    workers = scheduler.targets->nelts;
+
+  /* Phase 1:  Fetch the root and its immediate children, leaving the
+   * subdirectories behind as empty stubs. */
+  SVN_ERR(svn_client__update_internal(NULL, &sleep_ignored, local_abspath,
+                                      revision, svn_depth_immediates, TRUE,
+                                      ignore_externals,
+                                      allow_unver_obstructions,
+                                      TRUE /* adds_as_modification */,
+                                      FALSE, FALSE, ra_session,
+                                      ctx, pool));
+
+  status = apr_thread_mutex_create(&scheduler.mutex,
+                                   APR_THREAD_MUTEX_DEFAULT, pool);
+  if (status)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_wrap_apr(status, _("Can't create checkout mutex"));
+    }
+
+  cb.mutex = scheduler.mutex;
+  cb.notify_func = ctx->notify_func2;
+  cb.notify_baton = ctx->notify_baton2;
+  cb.cancel_func = ctx->cancel_func;
+  cb.cancel_baton = ctx->cancel_baton;
+
+  scheduler.revision = revision;
+  scheduler.ignore_externals = ignore_externals;
+  scheduler.allow_unver_obstructions = allow_unver_obstructions;
+
+  /* Set up the workers:  private context and RA session each.  Opening
+   * the sessions serially here keeps all auth traffic on this thread. */
+  worker_list = apr_pcalloc(pool, workers * sizeof(*worker_list));
+  for (i = 0; i < workers; i++)
+    {
+      struct co_worker *worker = &worker_list[i];
+
+      /* Everything the worker thread touches must come from a pool with
+       * a thread-safe allocator, i.e. a root pool. */
+      worker->pool = svn_pool_create(NULL);
+      worker->scheduler = &scheduler;
+
+      err = co_create_worker_context(&worker->ctx, ctx, &cb,
+                                     worker->pool);
+      if (!err)
+        err = svn_client_open_ra_session2(&worker->session, pathrev->url,
+                                          NULL, worker->ctx,
+                                          worker->pool, pool);
+      if (err)
+        break;
+    }
+
+  /* Phase 2:  Let the workers deepen the subtrees concurrently. */
+  started = 0;
+  if (!err)
+    for (i = 0; i < workers; i++)
+      {
+        status = apr_thread_create(&worker_list[i].thread, NULL,
+                                   co_worker_thread, &worker_list[i],
+                                   worker_list[i].pool);
+        if (status)
+          {
+            /* The workers already running will drain the list. */
+            worker_list[i].thread = NULL;
+            break;
+          }
+        started++;
+      }
+
+  if (!err && started == 0)
+    err = svn_error_wrap_apr(status, _("Can't create checkout thread"));
+
+  for (i = 0; i < workers; i++)
+    {
+      apr_status_t thread_status;
+
+      if (worker_list[i].thread)
+        apr_thread_join(&thread_status, worker_list[i].thread);
+      err = svn_error_compose_create(err, worker_list[i].err);
+      worker_list[i].err = SVN_NO_ERROR;
+      if (worker_list[i].pool)
+        svn_pool_destroy(worker_list[i].pool);
+    }
+  SVN_ERR(err);
+
+  /* Phase 3:  Restore the root's sticky depth to 'infinity'.  All
+   * subtrees are complete and at the pinned revision, so the server has
+   * nothing to send and this degrades to a depth bump plus a sweep for
+   * anything a worker might have missed. */
+  SVN_ERR(svn_client__update_internal(result_rev, &sleep_ignored,
+                                      local_abspath, revision,
+                                      svn_depth_infinity, TRUE,
+                                      ignore_externals,
+                                      allow_unver_obstructions,
+                                      TRUE /* adds_as_modification */,
+                                      FALSE, FALSE, ra_session,
+                                      ctx, pool));
+
+  svn_pool_destroy(pool);
+  *used = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
 
 svn_error_t *
 svn_client__checkout_internal(svn_revnum_t *result_rev,
@@ -81,6 +504,7 @@ svn_client__checkout_internal(svn_revnum_t *result_rev,
 {
   svn_node_kind_t kind;
   svn_client__pathrev_t *pathrev;
+  svn_boolean_t fresh_checkout = FALSE;
   svn_opt_revision_t resolved_rev = { svn_opt_revision_number };
 
   /* Sanity check.  Without these, the checkout is meaningless. */
@@ -146,6 +570,7 @@ svn_client__checkout_internal(svn_revnum_t *result_rev,
       SVN_ERR(svn_io_make_dir_recursively(local_abspath, scratch_pool));
       SVN_ERR(initialize_area(local_abspath, pathrev, depth, ctx,
                               scratch_pool));
+      fresh_checkout = TRUE;
     }
   else if (kind == svn_node_dir)
     {
@@ -159,6 +584,7 @@ svn_client__checkout_internal(svn_revnum_t *result_rev,
         {
           SVN_ERR(initialize_area(local_abspath, pathrev, depth, ctx,
                                   scratch_pool));
+          fresh_checkout = TRUE;
         }
       else
         {
@@ -185,6 +611,35 @@ svn_client__checkout_internal(svn_revnum_t *result_rev,
                                                       scratch_pool));
     }
 
+#if APR_HAS_THREADS
+  /* For brand-new full-depth working copies, the user may opt into the
+     parallel checkout engine via the 'checkout-workers' config option.
+     It is equivalent to the serial code below, merely faster; should it
+     fail, the working copy is restartable just like any interrupted
+     checkout. */
+  if (fresh_checkout
+      && (depth == svn_depth_infinity || depth == svn_depth_unknown))
+    {
+      int workers;
+
+      SVN_ERR(co_get_worker_count(&workers, ctx));
+      if (workers > 1)
+        {
+          svn_boolean_t used;
+
+          *timestamp_sleep = TRUE;
+          SVN_ERR(parallel_checkout(result_rev, &used, local_abspath,
+                                    pathrev, &resolved_rev,
+                                    ignore_externals,
+                                    allow_unver_obstructions,
+                                    workers, ra_session, ctx,
+                                    scratch_pool));
+          if (used)
+            return SVN_NO_ERROR;
+        }
+    }
+#endif
+
   /* Have update fix the incompleteness. */
   SVN_ERR(svn_client__update_internal(result_rev, timestamp_sleep,
                                       local_abspath, &resolved_rev, depth,
@@ -63,6 +63,16 @@ typedef struct svn_client__private_ctx_t
   /* Total number of bytes transferred over network across all RA sessions. */
   apr_off_t total_progress;
 
+  /* Maps "URL@REV" to the location_history_t of that location, as used
+     by svn_client__get_youngest_common_ancestor().  The history of a
+     node at a fixed peg revision is immutable, so entries never go
+     stale.  Allocated in POOL below; NULL until the first ancestry
+     query through this context. */
+  apr_hash_t *location_history_cache;
+
+  /* The pool that this context lives in; also holds the cache above. */
+  apr_pool_t *pool;
+
   /* The public context. */
   svn_client_ctx_t public_ctx;
 } svn_client__private_ctx_t;
@@ -1008,6 +1018,38 @@ svn_client__dirent_fetcher(void *baton,
                            apr_pool_t *result_pool,
                            apr_pool_t *scratch_pool);
 
+/* Set *VERIFY to the value of the 'verify-base-checksums' setting from
+   CTX->CONFIG's 'servers' configuration that applies to the host of URL,
+   or to TRUE if there is no such setting.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_client__get_verify_base_checksums(svn_boolean_t *verify,
+                                      const char *url,
+                                      svn_client_ctx_t *ctx,
+                                      apr_pool_t *scratch_pool);
+
+/* Set *STORE_PRISTINES to the value of the 'store-pristines' setting
+   from the 'working-copy' section of CTX->CONFIG, or to TRUE if there
+   is no such setting. */
+svn_error_t *
+svn_client__get_store_pristines(svn_boolean_t *store_pristines,
+                                svn_client_ctx_t *ctx);
+
+/* Fetch ("hydrate") every pristine text that is referenced by the BASE
+   tree of the working copy containing LOCAL_ABSPATH but absent from its
+   pristine store, e.g. because the store was dehydrated under
+   'store-pristines = no'.  A no-op without repository access when the
+   store is intact.
+
+   RA_SESSION may be parented anywhere within the working copy's
+   repository and is reparented back afterwards; if it is NULL a session
+   is opened when one is needed. */
+svn_error_t *
+svn_client__hydrate_pristines(const char *local_abspath,
+                              svn_ra_session_t *ra_session,
+                              svn_client_ctx_t *ctx,
+                              apr_pool_t *scratch_pool);
+
 /* Retrieve log messages using the first provided (non-NULL) callback
    in the set of *CTX->log_msg_func3, CTX->log_msg_func2, or
    CTX->log_msg_func.  Other arguments same as
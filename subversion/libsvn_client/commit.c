@@ -737,6 +737,26 @@ svn_client_commit6(const apr_array_header_t *targets,
                                                   base_abspath,
                                                   pool);
 
+  /* In a 'store-pristines = no' working copy, the text bases we send
+     deltas against may be absent; fetch them before the harvest.  The
+     working copy itself records whether it was dehydrated, so this works
+     even after the config option has been flipped back. */
+  {
+    svn_boolean_t stored;
+
+    SVN_ERR(svn_wc__pristines_stored(&stored, ctx->wc_ctx, base_abspath,
+                                     pool));
+    if (!stored)
+      {
+        cmt_err = svn_error_trace(
+                    svn_client__hydrate_pristines(base_abspath, NULL, ctx,
+                                                  iterpool));
+        if (cmt_err)
+          goto cleanup;
+        svn_pool_clear(iterpool);
+      }
+  }
+
   /* Crawl the working copy for commit items. */
   cmt_err = svn_error_trace(
               harvest_committables(&commit_items, &committables_by_path,
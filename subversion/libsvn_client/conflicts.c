@@ -41,6 +41,7 @@
 #include "client.h"
 
 #include "private/svn_diff_tree.h"
+#include "private/svn_error_private.h"
 #include "private/svn_ra_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_token.h"
@@ -1102,7 +1103,7 @@ find_deleted_rev(void *baton,
       b->replacing_node_kind = replacing_node_kind;
 
       /* We're done. Abort the log operation. */
-      return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+      return svn_error__sentinel(SVN_ERR_CEASE_INVOCATION);
     }
 
   return SVN_NO_ERROR;
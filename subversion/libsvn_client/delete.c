@@ -279,6 +279,11 @@ struct repos_deletables_t
 {
   svn_ra_session_t *ra_session;
   apr_array_header_t *target_uris;
+
+  /* The repository relpaths of TARGET_URIS, as a parallel array of
+     svn_ra__path_rev_t * probing HEAD.  Used to verify the targets'
+     existence in one batched request per repository. */
+  apr_array_header_t *target_path_revs;
 };
 
 
@@ -302,7 +307,7 @@ delete_urls_multi_repos(const apr_array_header_t *uris,
       const char *uri = APR_ARRAY_IDX(uris, i, const char *);
       struct repos_deletables_t *repos_deletables = NULL;
       const char *repos_relpath;
-      svn_node_kind_t kind;
+      svn_ra__path_rev_t *path_rev;
 
       for (hi = apr_hash_first(pool, deletables); hi; hi = apr_hash_next(hi))
         {
@@ -348,6 +353,8 @@ delete_urls_multi_repos(const apr_array_header_t *uris,
           repos_deletables = apr_pcalloc(pool, sizeof(*repos_deletables));
           repos_deletables->ra_session = ra_session;
           repos_deletables->target_uris = target_uris;
+          repos_deletables->target_path_revs =
+            apr_array_make(pool, 1, sizeof(svn_ra__path_rev_t *));
           svn_hash_sets(deletables, repos_root, repos_deletables);
         }
 
@@ -358,12 +365,33 @@ delete_urls_multi_repos(const apr_array_header_t *uris,
         return svn_error_createf(SVN_ERR_RA_ILLEGAL_URL, NULL,
                                  _("URL '%s' not within a repository"), uri);
 
-      /* Now, test to see if the thing actually exists in HEAD. */
-      SVN_ERR(svn_ra_check_path(repos_deletables->ra_session, repos_relpath,
-                                SVN_INVALID_REVNUM, &kind, pool));
-      if (kind == svn_node_none)
-        return svn_error_createf(SVN_ERR_FS_NOT_FOUND, NULL,
-                                 _("URL '%s' does not exist"), uri);
+      /* Queue the existence probe; they run batched per repository
+         below instead of one round trip per target here. */
+      path_rev = apr_pcalloc(pool, sizeof(*path_rev));
+      path_rev->path = apr_pstrdup(pool, repos_relpath);
+      path_rev->revision = SVN_INVALID_REVNUM;
+      APR_ARRAY_PUSH(repos_deletables->target_path_revs,
+                     svn_ra__path_rev_t *) = path_rev;
+    }
+
+  /* Now, test to see if the targets actually exist in HEAD, with one
+     batched request per repository. */
+  for (hi = apr_hash_first(pool, deletables); hi; hi = apr_hash_next(hi))
+    {
+      struct repos_deletables_t *repos_deletables = apr_hash_this_val(hi);
+      apr_array_header_t *kinds;
+
+      SVN_ERR(svn_ra__check_paths(&kinds, repos_deletables->ra_session,
+                                  repos_deletables->target_path_revs,
+                                  pool, pool));
+      for (i = 0; i < kinds->nelts; i++)
+        {
+          if (APR_ARRAY_IDX(kinds, i, svn_node_kind_t) == svn_node_none)
+            return svn_error_createf(SVN_ERR_FS_NOT_FOUND, NULL,
+                                     _("URL '%s' does not exist"),
+                                     APR_ARRAY_IDX(repos_deletables->target_uris,
+                                                   i, const char *));
+        }
     }
 
   /* Now we iterate over the DELETABLES hash, issuing a commit for
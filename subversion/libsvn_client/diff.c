@@ -33,6 +33,11 @@
 #include <apr_strings.h>
 #include <apr_pools.h>
 #include <apr_hash.h>
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
+#endif
 #include "svn_types.h"
 #include "svn_hash.h"
 #include "svn_wc.h"
@@ -746,9 +751,388 @@ typedef struct diff_writer_info_t
   svn_cancel_func_t cancel_func;
   void *cancel_baton;
 
+  /* Background text-diff workers, or NULL if all diffs are produced
+     inline.  See the 'Parallel text diffing' section below. */
+  struct diff_parallelizer_t *parallel;
+
   struct diff_driver_info_t ddi;
 } diff_writer_info_t;
 
+/*** Parallel text diffing ***/
+
+/* Tree diffs of big merges change thousands of files, and the text diffs
+ * of those files are independent of each other.  The parallelizer below
+ * hands the internal text diffs to a small pool of worker threads, each of
+ * which produces its part of the output into a private buffer.  The walker
+ * thread flushes those buffers to the output stream strictly in scheduling
+ * order, and drains all of them before anything else (property diffs,
+ * binary notices, external diff output) is written inline, so the output
+ * is byte-for-byte the same as in the serial case.
+ */
+#if APR_HAS_THREADS
+
+/* Number of background threads computing text diffs. */
+#define DIFF_PARALLEL_THREAD_COUNT 4
+
+/* Maximum number of scheduled diffs that have not been flushed yet. */
+#define DIFF_PARALLEL_MAX_PENDING 64
+
+/* Don't schedule a file pair whose combined size exceeds this; holding
+   many such contents and their output in memory isn't worth it. */
+#define DIFF_PARALLEL_MAX_FILE_SIZE (16 * 1024 * 1024)
+
+/* Life cycle of a diff_task_t. */
+typedef enum diff_task_state_t
+{
+  diff_task_queued,   /* waiting for a worker */
+  diff_task_running,  /* a worker is diffing right now */
+  diff_task_done      /* OUTPUT and ERR are valid */
+} diff_task_state_t;
+
+/* One deferred text diff. */
+typedef struct diff_task_t
+{
+  /* Private pool holding everything below.  While the task is being
+     processed, the worker allocates from this pool only. */
+  apr_pool_t *pool;
+
+  /* The two texts to diff. */
+  const svn_string_t *original;
+  const svn_string_t *modified;
+
+  /* Pre-formatted header pieces, cf. diff_content_changed(). */
+  const char *index_path;
+  const char *label1;
+  const char *label2;
+
+  /* Shared, read-only while any task is in flight. */
+  const char *header_encoding;
+  const svn_diff_file_options_t *opts;
+
+  diff_task_state_t state;
+
+  /* The formatted diff (empty if the texts turned out identical) and the
+     error to propagate instead, if any; valid once STATE is
+     diff_task_done. */
+  svn_stringbuf_t *output;
+  svn_error_t *err;
+} diff_task_t;
+
+struct diff_parallelizer_t
+{
+  /* Thread-safe root pool holding all shared state. */
+  apr_pool_t *pool;
+
+  /* MUTEX guards all queue state below; COND signals any change to it. */
+  apr_thread_mutex_t *mutex;
+  apr_thread_cond_t *cond;
+
+  /* FIFO queue of diff_task_t *.  NEXT_TO_RUN indexes the first task no
+     worker has picked up yet, NEXT_TO_FLUSH the first task whose output
+     has not been written yet.  Flushed entries are NULLed out. */
+  apr_array_header_t *queue;
+  int next_to_run;
+  int next_to_flush;
+
+  /* Tell the workers to terminate. */
+  svn_boolean_t quit;
+
+  apr_thread_t *threads[DIFF_PARALLEL_THREAD_COUNT];
+  int thread_count;
+};
+
+/* Thread function: take tasks off the queue of the diff_parallelizer_t
+   given as DATA and produce their diff output. */
+static void * APR_THREAD_FUNC
+diff_parallel_worker(apr_thread_t *thread, void *data)
+{
+  struct diff_parallelizer_t *dp = data;
+
+  apr_thread_mutex_lock(dp->mutex);
+  while (!dp->quit)
+    {
+      diff_task_t *task;
+
+      if (dp->next_to_run >= dp->queue->nelts)
+        {
+          apr_thread_cond_wait(dp->cond, dp->mutex);
+          continue;
+        }
+
+      task = APR_ARRAY_IDX(dp->queue, dp->next_to_run, diff_task_t *);
+      dp->next_to_run++;
+      task->state = diff_task_running;
+      apr_thread_mutex_unlock(dp->mutex);
+
+      {
+        svn_diff_t *diff;
+        svn_error_t *err;
+
+        task->output = svn_stringbuf_create_empty(task->pool);
+
+        err = svn_diff_mem_string_diff(&diff, task->original, task->modified,
+                                       task->opts, task->pool);
+        if (!err && svn_diff_contains_diffs(diff))
+          {
+            svn_stream_t *out = svn_stream_from_stringbuf(task->output,
+                                                          task->pool);
+
+            err = print_diff_index_header(out, task->header_encoding,
+                                          task->index_path, "", task->pool);
+            if (!err)
+              err = svn_diff_mem_string_output_unified3(
+                      out, diff, TRUE /*with_diff_header*/,
+                      NULL /*hunk_delimiter*/,
+                      task->label1, task->label2,
+                      task->header_encoding,
+                      task->original, task->modified,
+                      task->opts->context_size,
+                      NULL, NULL, /* no cancelation on worker threads */
+                      task->pool);
+          }
+
+        task->err = err;
+      }
+
+      apr_thread_mutex_lock(dp->mutex);
+      task->state = diff_task_done;
+      apr_thread_cond_broadcast(dp->cond);
+    }
+  apr_thread_mutex_unlock(dp->mutex);
+
+  return NULL;
+}
+
+#endif /* APR_HAS_THREADS */
+
+/* Write the output of all tasks scheduled with DWI->PARALLEL to
+ * DWI->OUTSTREAM, in scheduling order, waiting for workers as needed.
+ * No-op if nothing is pending.  Every code path that writes to
+ * DWI->OUTSTREAM directly must call this first, so deferred output can
+ * never end up behind output of a later node.
+ */
+static svn_error_t *
+diff_parallel_flush(diff_writer_info_t *dwi, apr_pool_t *scratch_pool)
+{
+#if APR_HAS_THREADS
+  struct diff_parallelizer_t *dp = dwi->parallel;
+
+  if (!dp)
+    return SVN_NO_ERROR;
+
+  while (TRUE)
+    {
+      diff_task_t *task;
+      svn_error_t *err;
+
+      apr_thread_mutex_lock(dp->mutex);
+      if (dp->next_to_flush >= dp->queue->nelts)
+        {
+          /* All flushed; reset the queue so it won't grow forever. */
+          dp->queue->nelts = 0;
+          dp->next_to_run = 0;
+          dp->next_to_flush = 0;
+          apr_thread_mutex_unlock(dp->mutex);
+          break;
+        }
+
+      task = APR_ARRAY_IDX(dp->queue, dp->next_to_flush, diff_task_t *);
+      while (task->state != diff_task_done)
+        apr_thread_cond_wait(dp->cond, dp->mutex);
+      APR_ARRAY_IDX(dp->queue, dp->next_to_flush, diff_task_t *) = NULL;
+      dp->next_to_flush++;
+      apr_thread_mutex_unlock(dp->mutex);
+
+      err = task->err;
+      if (!err && task->output->len > 0)
+        {
+          apr_size_t len = task->output->len;
+
+          err = svn_stream_write(dwi->outstream, task->output->data, &len);
+        }
+
+      svn_pool_destroy(task->pool);
+      SVN_ERR(err);
+    }
+#endif /* APR_HAS_THREADS */
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Try to schedule a background diff of TMPFILE1 vs. TMPFILE2 with
+ * DWI->PARALLEL, to be output with the given INDEX_PATH and labels.  Set
+ * *SCHEDULED accordingly; if the pair does not qualify (e.g. too large),
+ * the caller shall produce the diff inline.  To be called from the walker
+ * thread only.
+ */
+static svn_error_t *
+diff_parallel_schedule(svn_boolean_t *scheduled,
+                       diff_writer_info_t *dwi,
+                       const char *tmpfile1,
+                       const char *tmpfile2,
+                       const char *index_path,
+                       const char *label1,
+                       const char *label2,
+                       apr_pool_t *scratch_pool)
+{
+  struct diff_parallelizer_t *dp = dwi->parallel;
+  apr_finfo_t finfo1, finfo2;
+  apr_pool_t *task_pool;
+  diff_task_t *task;
+  svn_stringbuf_t *original;
+  svn_stringbuf_t *modified;
+  svn_string_t *original_str;
+  svn_string_t *modified_str;
+  svn_boolean_t queue_full;
+
+  *scheduled = FALSE;
+
+  SVN_ERR(svn_io_stat(&finfo1, tmpfile1, APR_FINFO_SIZE, scratch_pool));
+  SVN_ERR(svn_io_stat(&finfo2, tmpfile2, APR_FINFO_SIZE, scratch_pool));
+  if (finfo1.size + finfo2.size > DIFF_PARALLEL_MAX_FILE_SIZE)
+    return SVN_NO_ERROR;
+
+  apr_thread_mutex_lock(dp->mutex);
+  queue_full = (dp->queue->nelts - dp->next_to_flush
+                >= DIFF_PARALLEL_MAX_PENDING);
+  apr_thread_mutex_unlock(dp->mutex);
+
+  /* Too much output waiting in memory; drain it before piling up more. */
+  if (queue_full)
+    SVN_ERR(diff_parallel_flush(dwi, scratch_pool));
+
+  task_pool = svn_pool_create(dp->pool);
+  task = apr_pcalloc(task_pool, sizeof(*task));
+  task->pool = task_pool;
+
+  SVN_ERR(svn_stringbuf_from_file2(&original, tmpfile1, task_pool));
+  SVN_ERR(svn_stringbuf_from_file2(&modified, tmpfile2, task_pool));
+
+  original_str = apr_pcalloc(task_pool, sizeof(*original_str));
+  original_str->data = original->data;
+  original_str->len = original->len;
+  modified_str = apr_pcalloc(task_pool, sizeof(*modified_str));
+  modified_str->data = modified->data;
+  modified_str->len = modified->len;
+
+  task->original = original_str;
+  task->modified = modified_str;
+  task->index_path = apr_pstrdup(task_pool, index_path);
+  task->label1 = apr_pstrdup(task_pool, label1);
+  task->label2 = apr_pstrdup(task_pool, label2);
+  task->header_encoding = dwi->header_encoding;
+  task->opts = dwi->options.for_internal;
+  task->state = diff_task_queued;
+
+  apr_thread_mutex_lock(dp->mutex);
+  APR_ARRAY_PUSH(dp->queue, diff_task_t *) = task;
+  apr_thread_cond_broadcast(dp->cond);
+  apr_thread_mutex_unlock(dp->mutex);
+
+  *scheduled = TRUE;
+  return SVN_NO_ERROR;
+}
+
+/* Construct a parallelizer for DWI.  Leave DWI->PARALLEL at NULL if
+   background threads are not available. */
+static void
+diff_parallelizer_create(diff_writer_info_t *dwi)
+{
+  apr_pool_t *pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  struct diff_parallelizer_t *dp = apr_pcalloc(pool, sizeof(*dp));
+  apr_threadattr_t *tattr;
+  apr_status_t status;
+  int i;
+
+  dp->pool = pool;
+  dp->queue = apr_array_make(pool, DIFF_PARALLEL_MAX_PENDING,
+                             sizeof(diff_task_t *));
+
+  status = apr_thread_mutex_create(&dp->mutex, APR_THREAD_MUTEX_DEFAULT,
+                                   pool);
+  if (!status)
+    status = apr_thread_cond_create(&dp->cond, pool);
+  if (!status)
+    status = apr_threadattr_create(&tattr, pool);
+  if (status)
+    {
+      svn_pool_destroy(pool);
+      return;
+    }
+
+  for (i = 0; i < DIFF_PARALLEL_THREAD_COUNT; i++)
+    if (apr_thread_create(&dp->threads[i], tattr, diff_parallel_worker, dp,
+                          pool))
+      break;
+  dp->thread_count = i;
+
+  if (i == 0)
+    {
+      svn_pool_destroy(pool);
+      return;
+    }
+
+  dwi->parallel = dp;
+}
+
+#endif /* APR_HAS_THREADS */
+
+/* Flush any diff output still pending on the parallelizer of PROCESSOR's
+ * diff writer (unless ERR is already set), then stop its worker threads
+ * and release everything they hold.  Return ERR, composed with any error
+ * the flush produced.  No-op if the writer never ran in parallel mode.
+ */
+static svn_error_t *
+diff_writer_finish(svn_error_t *err,
+                   const svn_diff_tree_processor_t *processor)
+{
+#if APR_HAS_THREADS
+  diff_writer_info_t *dwi = processor->baton;
+  struct diff_parallelizer_t *dp = dwi->parallel;
+  int i;
+
+  if (!dp)
+    return svn_error_trace(err);
+
+  if (!err)
+    err = diff_parallel_flush(dwi, dp->pool);
+
+  apr_thread_mutex_lock(dp->mutex);
+  dp->quit = TRUE;
+  /* Nobody is going to consume the unflushed tasks anymore. */
+  while (dp->next_to_flush < dp->queue->nelts)
+    {
+      diff_task_t *task
+        = APR_ARRAY_IDX(dp->queue, dp->next_to_flush, diff_task_t *);
+
+      dp->next_to_flush++;
+      if (task)
+        {
+          while (task->state == diff_task_running)
+            apr_thread_cond_wait(dp->cond, dp->mutex);
+          if (task->state == diff_task_done)
+            svn_error_clear(task->err);
+        }
+    }
+  apr_thread_cond_broadcast(dp->cond);
+  apr_thread_mutex_unlock(dp->mutex);
+
+  for (i = 0; i < dp->thread_count; i++)
+    {
+      apr_status_t ignored;
+
+      apr_thread_join(&ignored, dp->threads[i]);
+    }
+
+  dwi->parallel = NULL;
+  svn_pool_destroy(dp->pool);
+#endif /* APR_HAS_THREADS */
+
+  return svn_error_trace(err);
+}
+
 /* An helper for diff_dir_props_changed, diff_file_changed and diff_file_added
  */
 static svn_error_t *
@@ -773,6 +1157,8 @@ diff_props_changed(const char *diff_relpath,
 
   if (props->nelts > 0)
     {
+      SVN_ERR(diff_parallel_flush(dwi, scratch_pool));
+
       /* We're using the revnums from the dwi since there's
        * no revision argument to the svn_wc_diff_callback_t
        * dir_props_changed(). */
@@ -861,7 +1247,14 @@ transform_link_to_git(const char **new_tmpfile,
 
    If FORCE_DIFF is TRUE, always write a diff, even for empty diffs.
 
-   Set *WROTE_HEADER to TRUE if a diff header was written */
+   If ALLOW_DEFER is TRUE, the internal text diff may be handed to
+   DWI->PARALLEL (if enabled) and written out later, in order.  Only pass
+   TRUE if no further output for this node follows, since that output
+   would overtake the deferred diff.
+
+   Set *WROTE_HEADER to TRUE if a diff header was written.  (If the diff
+   was deferred, nothing has been written yet and *WROTE_HEADER stays
+   FALSE.) */
 static svn_error_t *
 diff_content_changed(svn_boolean_t *wrote_header,
                      const char *diff_relpath,
@@ -873,6 +1266,7 @@ diff_content_changed(svn_boolean_t *wrote_header,
                      apr_hash_t *right_props,
                      svn_diff_operation_kind_t operation,
                      svn_boolean_t force_diff,
+                     svn_boolean_t allow_defer,
                      const char *copyfrom_path,
                      svn_revnum_t copyfrom_rev,
                      diff_writer_info_t *dwi,
@@ -940,6 +1334,8 @@ diff_content_changed(svn_boolean_t *wrote_header,
 
   if (! dwi->force_binary && (mt1_binary || mt2_binary))
     {
+      SVN_ERR(diff_parallel_flush(dwi, scratch_pool));
+
       /* Print out the diff header. */
       SVN_ERR(print_diff_index_header(outstream, dwi->header_encoding,
                                       index_path, "", scratch_pool));
@@ -1017,6 +1413,8 @@ diff_content_changed(svn_boolean_t *wrote_header,
       svn_stream_t *stream;
       int exitcode;
 
+      SVN_ERR(diff_parallel_flush(dwi, scratch_pool));
+
       /* Print out the diff header. */
       SVN_ERR(print_diff_index_header(outstream, dwi->header_encoding,
                                       index_path, "", scratch_pool));
@@ -1078,6 +1476,25 @@ diff_content_changed(svn_boolean_t *wrote_header,
     {
       svn_diff_t *diff;
 
+#if APR_HAS_THREADS
+      if (allow_defer && dwi->parallel
+          && !force_diff
+          && !dwi->use_git_diff_format
+          && !dwi->options.for_internal->show_c_function)
+        {
+          svn_boolean_t scheduled;
+
+          SVN_ERR(diff_parallel_schedule(&scheduled, dwi,
+                                         tmpfile1, tmpfile2,
+                                         index_path, label1, label2,
+                                         scratch_pool));
+          if (scheduled)
+            return SVN_NO_ERROR;
+        }
+#endif /* APR_HAS_THREADS */
+
+      SVN_ERR(diff_parallel_flush(dwi, scratch_pool));
+
       SVN_ERR(svn_diff_file_diff_2(&diff, tmpfile1, tmpfile2,
                                    dwi->options.for_internal,
                                    scratch_pool));
@@ -1145,6 +1562,8 @@ diff_file_changed(const char *relpath,
                                  right_source->revision,
                                  left_props, right_props,
                                  svn_diff_op_modified, FALSE,
+                                 prop_changes->nelts == 0
+                                   || dwi->ignore_properties /* allow_defer */,
                                  NULL,
                                  SVN_INVALID_REVNUM, dwi,
                                  scratch_pool));
@@ -1188,6 +1607,7 @@ diff_file_added(const char *relpath,
         index_path = svn_dirent_join(dwi->ddi.anchor, relpath,
                                      scratch_pool);
 
+      SVN_ERR(diff_parallel_flush(dwi, scratch_pool));
       SVN_ERR(print_diff_index_header(dwi->outstream, dwi->header_encoding,
                                       index_path, " (added)",
                                       scratch_pool));
@@ -1228,6 +1648,7 @@ diff_file_added(const char *relpath,
                                     ? svn_diff_op_moved
                                     : svn_diff_op_copied,
                                  TRUE /* force diff output */,
+                                 FALSE /* allow_defer */,
                                  copyfrom_source->moved_from_relpath
                                     ? copyfrom_source->moved_from_relpath
                                     : copyfrom_source->repos_relpath,
@@ -1241,6 +1662,7 @@ diff_file_added(const char *relpath,
                                  left_props, right_props,
                                  svn_diff_op_added,
                                  TRUE /* force diff output */,
+                                 FALSE /* allow_defer */,
                                  NULL, SVN_INVALID_REVNUM,
                                  dwi, scratch_pool));
 
@@ -1276,6 +1698,7 @@ diff_file_deleted(const char *relpath,
         index_path = svn_dirent_join(dwi->ddi.anchor, relpath,
                                      scratch_pool);
 
+      SVN_ERR(diff_parallel_flush(dwi, scratch_pool));
       SVN_ERR(print_diff_index_header(dwi->outstream, dwi->header_encoding,
                                       index_path, " (deleted)",
                                       scratch_pool));
@@ -1297,6 +1720,7 @@ diff_file_deleted(const char *relpath,
                                      left_props,
                                      NULL,
                                      svn_diff_op_deleted, FALSE,
+                                     FALSE /* allow_defer */,
                                      NULL, SVN_INVALID_REVNUM,
                                      dwi,
                                      scratch_pool));
@@ -1866,6 +2290,21 @@ diff_wc_wc(const char *path1,
                           "or between the working versions of two paths"
                           )));
 
+  /* In a 'store-pristines = no' working copy, the text bases we are
+     about to diff against may be absent; fetch them first.  The working
+     copy itself records whether it was dehydrated, so this works even
+     after the config option has been flipped back.  With an intact
+     store this stays offline, like it always was. */
+  {
+    svn_boolean_t stored;
+
+    SVN_ERR(svn_wc__pristines_stored(&stored, ctx->wc_ctx, abspath1,
+                                     scratch_pool));
+    if (!stored)
+      SVN_ERR(svn_client__hydrate_pristines(abspath1, NULL, ctx,
+                                            scratch_pool));
+  }
+
   SVN_ERR(svn_wc__diff7(TRUE,
                         ctx->wc_ctx, abspath1, depth,
                         ignore_ancestry, changelists,
@@ -2817,13 +3256,21 @@ svn_client_diff7(const apr_array_header_t *options,
                              outstream, errstream,
                              ctx, pool));
 
-  return svn_error_trace(do_diff(ddi,
-                                 path_or_url1, path_or_url2,
-                                 revision1, revision2,
-                                 &peg_revision, TRUE /* no_peg_revision */,
-                                 depth, ignore_ancestry, changelists,
-                                 TRUE /* text_deltas */,
-                                 diff_processor, ctx, pool, pool));
+#if APR_HAS_THREADS
+  if (!properties_only
+      && !((diff_writer_info_t *)diff_processor->baton)->diff_cmd)
+    diff_parallelizer_create(diff_processor->baton);
+#endif
+
+  return svn_error_trace(diff_writer_finish(
+                           do_diff(ddi,
+                                   path_or_url1, path_or_url2,
+                                   revision1, revision2,
+                                   &peg_revision, TRUE /* no_peg_revision */,
+                                   depth, ignore_ancestry, changelists,
+                                   TRUE /* text_deltas */,
+                                   diff_processor, ctx, pool, pool),
+                           diff_processor));
 }
 
 svn_error_t *
@@ -2877,13 +3324,21 @@ svn_client_diff_peg7(const apr_array_header_t *options,
                              outstream, errstream,
                              ctx, pool));
 
-  return svn_error_trace(do_diff(ddi,
-                                 path_or_url, path_or_url,
-                                 start_revision, end_revision,
-                                 peg_revision, FALSE /* no_peg_revision */,
-                                 depth, ignore_ancestry, changelists,
-                                 TRUE /* text_deltas */,
-                                 diff_processor, ctx, pool, pool));
+#if APR_HAS_THREADS
+  if (!properties_only
+      && !((diff_writer_info_t *)diff_processor->baton)->diff_cmd)
+    diff_parallelizer_create(diff_processor->baton);
+#endif
+
+  return svn_error_trace(diff_writer_finish(
+                           do_diff(ddi,
+                                   path_or_url, path_or_url,
+                                   start_revision, end_revision,
+                                   peg_revision, FALSE /* no_peg_revision */,
+                                   depth, ignore_ancestry, changelists,
+                                   TRUE /* text_deltas */,
+                                   diff_processor, ctx, pool, pool),
+                           diff_processor));
 }
 
 svn_error_t *
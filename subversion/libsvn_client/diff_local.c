@@ -144,10 +144,11 @@ inner_dir_diff(const char *left_abspath,
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_hash_t *left_dirents;
   apr_hash_t *right_dirents;
-  apr_array_header_t *sorted_dirents;
+  svn_sort__sorted_hash_t *left_sorted;
+  svn_sort__sorted_hash_t *right_sorted;
   svn_error_t *err;
   svn_depth_t depth_below_here;
-  int i;
+  int li, ri;
 
   SVN_ERR_ASSERT(depth >= svn_depth_files && depth <= svn_depth_infinity);
 
@@ -195,32 +196,60 @@ inner_dir_diff(const char *left_abspath,
   else
     depth_below_here = svn_depth_infinity;
 
-  sorted_dirents = svn_sort__hash(apr_hash_merge(iterpool, left_dirents,
-                                                 right_dirents, NULL, NULL),
-                                  svn_sort_compare_items_as_paths,
-                                  scratch_pool);
-
-  for (i = 0; i < sorted_dirents->nelts; i++)
+  /* Instead of merging the two hashes into a third one just to sort it,
+   * sort both listings individually and walk them in parallel. */
+  left_sorted = svn_sort__sorted_hash(left_dirents,
+                                      svn_sort_compare_items_as_paths,
+                                      scratch_pool);
+  right_sorted = svn_sort__sorted_hash(right_dirents,
+                                       svn_sort_compare_items_as_paths,
+                                       scratch_pool);
+
+  li = 0;
+  ri = 0;
+  while (li < left_sorted->items->nelts || ri < right_sorted->items->nelts)
     {
-      svn_sort__item_t* elt = &APR_ARRAY_IDX(sorted_dirents, i, svn_sort__item_t);
+      const svn_sort__item_t *left_item
+        = li < left_sorted->items->nelts
+        ? &APR_ARRAY_IDX(left_sorted->items, li, svn_sort__item_t)
+        : NULL;
+      const svn_sort__item_t *right_item
+        = ri < right_sorted->items->nelts
+        ? &APR_ARRAY_IDX(right_sorted->items, ri, svn_sort__item_t)
+        : NULL;
       svn_io_dirent2_t *left_dirent;
       svn_io_dirent2_t *right_dirent;
+      const char *name;
       const char *child_left_abspath;
       const char *child_right_abspath;
+      int diff;
+
+      if (!right_item)
+        diff = -1;
+      else if (!left_item)
+        diff = 1;
+      else
+        diff = svn_sort_compare_items_as_paths(left_item, right_item);
+
+      left_dirent = diff <= 0 ? left_item->value : NULL;
+      right_dirent = diff >= 0 ? right_item->value : NULL;
+      name = diff <= 0 ? left_item->key : right_item->key;
+
+      if (diff <= 0)
+        ++li;
+      if (diff >= 0)
+        ++ri;
 
       svn_pool_clear(iterpool);
 
       if (ctx->cancel_func)
         SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
 
-      if (svn_wc_is_adm_dir(elt->key, iterpool))
+      if (svn_wc_is_adm_dir(name, iterpool))
         continue;
 
-      left_dirent = right_only ? NULL : svn_hash_gets(left_dirents, elt->key);
-      right_dirent = left_only ? NULL : svn_hash_gets(right_dirents, elt->key);
-
-      child_left_abspath = svn_dirent_join(left_abspath, elt->key, iterpool);
-      child_right_abspath = svn_dirent_join(right_abspath, elt->key, iterpool);
+      child_left_abspath = svn_dirent_join(left_abspath, name, iterpool);
+      child_right_abspath = svn_dirent_join(right_abspath, name, iterpool);
 
       if (((left_dirent == NULL) != (right_dirent == NULL))
           || (left_dirent->kind != right_dirent->kind))
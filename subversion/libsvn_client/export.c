@@ -29,6 +29,8 @@
 
 #include <apr_file_io.h>
 #include <apr_md5.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
 #include "svn_types.h"
 #include "svn_client.h"
 #include "svn_string.h"
@@ -40,11 +42,13 @@
 #include "svn_subst.h"
 #include "svn_time.h"
 #include "svn_props.h"
+#include "svn_config.h"
 #include "client.h"
 
 #include "svn_private_config.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_delta_private.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_wc_private.h"
 
 #ifndef ENABLE_EV2_IMPL
@@ -492,6 +496,116 @@ open_root_internal(const char *path,
 
 /* ---------------------------------------------------------------------- */
 
+
+/*** Export checkpoints. ***/
+
+/* While a directory export is in progress, a sidecar file next to the
+ * export target records every directory whose subtree has been fully
+ * delivered.  If the export is interrupted, a later invocation of the
+ * very same export (same URL and resolved revision) finds the sidecar
+ * and describes the completed subtrees to the update reporter, so the
+ * server only re-sends what is still missing.  The sidecar is deleted
+ * once the export completes.
+ */
+
+/* Version number of the checkpoint file format. */
+#define EXPORT_CHECKPOINT_FORMAT 1
+
+/* Suffix appended to the export target path to name the sidecar. */
+#define EXPORT_CHECKPOINT_SUFFIX ".svn-export-checkpoint"
+
+/* Set *COMPLETED_DIRS to an array of 'const char *' relpaths of the
+ * completed directories recorded in the checkpoint file CHECKPOINT_PATH,
+ * allocated in RESULT_POOL.  Set it to NULL if there is no checkpoint,
+ * if the checkpoint does not describe an export of FROM_URL at REVISION,
+ * or if it records no completed directories yet.
+ */
+static svn_error_t *
+read_export_checkpoint(apr_array_header_t **completed_dirs,
+                       const char *checkpoint_path,
+                       const char *from_url,
+                       svn_revnum_t revision,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *contents;
+  apr_array_header_t *lines;
+  apr_array_header_t *dirs;
+  svn_error_t *err;
+  int i;
+
+  *completed_dirs = NULL;
+
+  err = svn_stringbuf_from_file2(&contents, checkpoint_path, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* The first three lines are format number, URL and revision.  A
+   * checkpoint is only usable for the very same export; treat anything
+   * else (including a corrupted header) as "no checkpoint". */
+  lines = svn_cstring_split(contents->data, "\n", FALSE, scratch_pool);
+  if (lines->nelts < 3
+      || atoi(APR_ARRAY_IDX(lines, 0, const char *))
+         != EXPORT_CHECKPOINT_FORMAT
+      || strcmp(APR_ARRAY_IDX(lines, 1, const char *), from_url) != 0
+      || SVN_STR_TO_REV(APR_ARRAY_IDX(lines, 2, const char *)) != revision)
+    return SVN_NO_ERROR;
+
+  dirs = apr_array_make(result_pool, lines->nelts - 3, sizeof(const char *));
+  for (i = 3; i < lines->nelts; i++)
+    {
+      const char *line = APR_ARRAY_IDX(lines, i, const char *);
+
+      if (line[0] != '\0')
+        APR_ARRAY_PUSH(dirs, const char *) = apr_pstrdup(result_pool, line);
+    }
+
+  if (dirs->nelts > 0)
+    *completed_dirs = dirs;
+
+  return SVN_NO_ERROR;
+}
+
+/* Open the checkpoint file CHECKPOINT_PATH for appending, returning it
+ * in *FILE, allocated in RESULT_POOL.  If RESUMING, the file exists and
+ * already carries a valid header; otherwise (re-)create it with a header
+ * describing an export of FROM_URL at REVISION.
+ */
+static svn_error_t *
+open_export_checkpoint(apr_file_t **file,
+                       const char *checkpoint_path,
+                       svn_boolean_t resuming,
+                       const char *from_url,
+                       svn_revnum_t revision,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  if (resuming)
+    {
+      SVN_ERR(svn_io_file_open(file, checkpoint_path,
+                               APR_WRITE | APR_APPEND, APR_OS_DEFAULT,
+                               result_pool));
+    }
+  else
+    {
+      const char *header = apr_psprintf(scratch_pool, "%d\n%s\n%ld\n",
+                                        EXPORT_CHECKPOINT_FORMAT,
+                                        from_url, revision);
+
+      SVN_ERR(svn_io_file_open(file, checkpoint_path,
+                               APR_WRITE | APR_CREATE | APR_TRUNCATE,
+                               APR_OS_DEFAULT, result_pool));
+      SVN_ERR(svn_io_file_write_full(*file, header, strlen(header), NULL,
+                                     scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 
 /*** A dedicated 'export' editor, which does no .svn/ accounting.  ***/
 
@@ -511,6 +625,10 @@ struct edit_baton
   void *cancel_baton;
   svn_wc_notify_func2_t notify_func;
   void *notify_baton;
+
+  /* Checkpoint sidecar recording completed directories, or NULL if
+     this export is not checkpointed. */
+  apr_file_t *checkpoint_file;
 };
 
 
@@ -644,6 +762,57 @@ add_directory(const char *path,
 }
 
 
+/* Build a dir baton for a directory which already exists on disk.
+ * The server only opens directories (rather than adding them) when a
+ * checkpointed export is resumed and parts of the subtree have been
+ * described as already present. */
+static svn_error_t *
+open_directory(const char *path,
+               void *parent_baton,
+               svn_revnum_t base_revision,
+               apr_pool_t *pool,
+               void **baton)
+{
+  struct dir_baton *pb = parent_baton;
+  struct edit_baton *eb = pb->edit_baton;
+  struct dir_baton *db = apr_pcalloc(pool, sizeof(*db));
+
+  db->path = svn_dirent_join(eb->root_path, path, pool);
+  db->edit_baton = eb;
+  *baton = db;
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Record the directory as completed in the checkpoint sidecar, if we
+ * keep one.  The driver closes a directory only after delivering its
+ * entire subtree, so a recorded directory never needs re-fetching. */
+static svn_error_t *
+close_directory(void *dir_baton,
+                apr_pool_t *pool)
+{
+  struct dir_baton *db = dir_baton;
+  struct edit_baton *eb = db->edit_baton;
+  const char *relpath;
+
+  if (! eb->checkpoint_file)
+    return SVN_NO_ERROR;
+
+  /* Completion of the export root is implied by the sidecar going away. */
+  relpath = svn_dirent_skip_ancestor(eb->root_path, db->path);
+  if (relpath && relpath[0] != '\0')
+    {
+      const char *line = apr_pstrcat(pool, relpath, "\n", SVN_VA_NULL);
+
+      SVN_ERR(svn_io_file_write_full(eb->checkpoint_file, line,
+                                     strlen(line), NULL, pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Build a file baton. */
 static svn_error_t *
 add_file(const char *path,
@@ -909,6 +1078,8 @@ get_editor_ev1(const svn_delta_editor_t **export_editor,
   editor->set_target_revision = set_target_revision;
   editor->open_root = open_root;
   editor->add_directory = add_directory;
+  editor->open_directory = open_directory;
+  editor->close_directory = close_directory;
   editor->add_file = add_file;
   editor->apply_textdelta = apply_textdelta;
   editor->close_file = close_file;
@@ -1281,6 +1452,94 @@ export_file(const char *from_url,
   return SVN_NO_ERROR;
 }
 
+/* Describe the subtrees recorded in COMPLETED_DIRS (an array of
+ * 'const char *' relpaths below TO_PATH) to REPORTER/REPORT_BATON as
+ * already present at REVISION, so the server skips them.  Must be
+ * called after the initial set_path() on "" and before finish_report().
+ *
+ * Only the top-most completed directories are described; reporting them
+ * covers their recorded descendants.  Their intermediate parent
+ * directories are described as empty, as the reporter requires parents
+ * to be reported before children.  Recorded directories which no longer
+ * exist on disk are ignored, so their contents are fetched again.
+ */
+static svn_error_t *
+report_completed_dirs(const svn_ra_reporter3_t *reporter,
+                      void *report_baton,
+                      const apr_array_header_t *completed_dirs,
+                      const char *to_path,
+                      svn_revnum_t revision,
+                      apr_pool_t *scratch_pool)
+{
+  apr_hash_t *completed = apr_hash_make(scratch_pool);
+  apr_hash_t *to_report = apr_hash_make(scratch_pool);
+  apr_array_header_t *sorted;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < completed_dirs->nelts; i++)
+    svn_hash_sets(completed,
+                  APR_ARRAY_IDX(completed_dirs, i, const char *), "");
+
+  for (i = 0; i < completed_dirs->nelts; i++)
+    {
+      const char *relpath = APR_ARRAY_IDX(completed_dirs, i, const char *);
+      const char *parent;
+      svn_boolean_t covered = FALSE;
+      svn_node_kind_t kind;
+
+      svn_pool_clear(iterpool);
+
+      /* Skip directories below another completed directory. */
+      for (parent = svn_relpath_dirname(relpath, iterpool);
+           parent[0] != '\0';
+           parent = svn_relpath_dirname(parent, iterpool))
+        if (svn_hash_gets(completed, parent))
+          {
+            covered = TRUE;
+            break;
+          }
+      if (covered)
+        continue;
+
+      /* Someone may have removed the directory since the interrupted
+         run wrote the checkpoint; claiming to still have it would leave
+         a hole in the exported tree. */
+      SVN_ERR(svn_io_check_path(svn_dirent_join(to_path, relpath, iterpool),
+                                &kind, iterpool));
+      if (kind != svn_node_dir)
+        continue;
+
+      svn_hash_sets(to_report, apr_pstrdup(scratch_pool, relpath), "c");
+
+      /* Describe intermediate parents as present-but-empty. */
+      for (parent = svn_relpath_dirname(relpath, scratch_pool);
+           parent[0] != '\0';
+           parent = svn_relpath_dirname(parent, scratch_pool))
+        if (! svn_hash_gets(to_report, parent))
+          svn_hash_sets(to_report, parent, "i");
+    }
+
+  /* Path order satisfies the reporter's parents-before-children rule. */
+  sorted = svn_sort__hash(to_report, svn_sort_compare_items_as_paths,
+                          scratch_pool);
+  for (i = 0; i < sorted->nelts; i++)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i,
+                                                    svn_sort__item_t);
+      const char *marker = item->value;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(reporter->set_path(report_baton, item->key, revision,
+                                 svn_depth_infinity,
+                                 *marker == 'i' /* start_empty */,
+                                 NULL, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 export_directory(const char *from_url,
                  const char *to_path,
@@ -1299,9 +1558,28 @@ export_directory(const char *from_url,
   const svn_ra_reporter3_t *reporter;
   void *report_baton;
   svn_node_kind_t kind;
+  const char *checkpoint_path = NULL;
+  apr_array_header_t *completed_dirs = NULL;
 
   SVN_ERR_ASSERT(svn_path_is_url(from_url));
 
+  /* Checkpoint full-depth exports, so an interrupted run can be resumed
+   * by repeating the same command.  (Ev2 exports shim through Ev1-style
+   * drives, but don't report completions; they still honour an existing
+   * checkpoint and re-create it with just the header.) */
+  if (depth == svn_depth_infinity)
+    {
+      checkpoint_path = apr_pstrcat(scratch_pool, to_path,
+                                    EXPORT_CHECKPOINT_SUFFIX, SVN_VA_NULL);
+      SVN_ERR(read_export_checkpoint(&completed_dirs, checkpoint_path,
+                                     from_url, loc->rev,
+                                     scratch_pool, scratch_pool));
+
+      /* Resuming means exporting into the partially filled target. */
+      if (completed_dirs)
+        eb->overwrite = TRUE;
+    }
+
   if (!ENABLE_EV2_IMPL)
     SVN_ERR(get_editor_ev1(&export_editor, &edit_baton, eb, ctx,
                            scratch_pool, scratch_pool));
@@ -1309,6 +1587,12 @@ export_directory(const char *from_url,
     SVN_ERR(get_editor_ev2(&export_editor, &edit_baton, eb, ctx,
                            scratch_pool, scratch_pool));
 
+  if (checkpoint_path)
+    SVN_ERR(open_export_checkpoint(&eb->checkpoint_file, checkpoint_path,
+                                   completed_dirs != NULL,
+                                   from_url, loc->rev,
+                                   scratch_pool, scratch_pool));
+
   /* Manufacture a basic 'report' to the update reporter. */
   SVN_ERR(svn_ra_do_update3(ra_session,
                             &reporter, &report_baton,
@@ -1327,8 +1611,20 @@ export_directory(const char *from_url,
                              TRUE, /* "help, my dir is empty!" */
                              NULL, scratch_pool));
 
+  if (completed_dirs)
+    SVN_ERR(report_completed_dirs(reporter, report_baton, completed_dirs,
+                                  to_path, loc->rev, scratch_pool));
+
   SVN_ERR(reporter->finish_report(report_baton, scratch_pool));
 
+  /* The export is complete; the checkpoint has served its purpose. */
+  if (checkpoint_path)
+    {
+      SVN_ERR(svn_io_file_close(eb->checkpoint_file, scratch_pool));
+      eb->checkpoint_file = NULL;
+      SVN_ERR(svn_io_remove_file2(checkpoint_path, TRUE, scratch_pool));
+    }
+
   /* Special case: Due to our sly export/checkout method of updating an
    * empty directory, no target will have been created if the exported
    * item is itself an empty directory (export_editor->open_root never
@@ -1360,6 +1656,424 @@ export_directory(const char *from_url,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/*** Parallel export engine. ***/
+
+/* Hard limit on the number of concurrent export workers.  Each worker
+ * costs an RA session and an open repository connection, so there is
+ * little point in going higher. */
+#define EXPORT_MAX_WORKERS 16
+
+/* Serializes the notification and cancellation callbacks of the original
+ * client context for use from multiple worker threads. */
+struct exp_callback_baton
+{
+  apr_thread_mutex_t *mutex;
+
+  /* The original client context's callbacks.  Either func may be NULL. */
+  svn_wc_notify_func2_t notify_func;
+  void *notify_baton;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+};
+
+/* Implements svn_wc_notify_func2_t.  Forward NOTIFY to the original
+ * notification callback in the exp_callback_baton given in BATON, one
+ * worker at a time.  Per-subtree completion notifications are dropped;
+ * the caller sends a single one for the whole export. */
+static void
+exp_notify_func(void *baton,
+                const svn_wc_notify_t *notify,
+                apr_pool_t *pool)
+{
+  struct exp_callback_baton *cb = baton;
+
+  if (notify->action == svn_wc_notify_update_completed)
+    return;
+
+  apr_thread_mutex_lock(cb->mutex);
+  cb->notify_func(cb->notify_baton, notify, pool);
+  apr_thread_mutex_unlock(cb->mutex);
+}
+
+/* Implements svn_cancel_func_t.  Forward to the original cancellation
+ * callback in the exp_callback_baton given in BATON, one worker at a
+ * time. */
+static svn_error_t *
+exp_cancel_func(void *baton)
+{
+  struct exp_callback_baton *cb = baton;
+  svn_error_t *err;
+
+  apr_thread_mutex_lock(cb->mutex);
+  err = cb->cancel_func(cb->cancel_baton);
+  apr_thread_mutex_unlock(cb->mutex);
+
+  return svn_error_trace(err);
+}
+
+/* One top-level subdirectory to export. */
+struct exp_target
+{
+  /* URL of the subdirectory in the repository. */
+  const char *url;
+
+  /* Local path to export it to. */
+  const char *to_path;
+};
+
+/* The list of subtrees to fetch, shared by all workers. */
+struct exp_scheduler
+{
+  apr_thread_mutex_t *mutex;
+
+  /* Array of 'struct exp_target' entries still to fetch.  Workers grab
+   * the next unclaimed entry, so a worker that finishes a small subtree
+   * early simply moves on to the next one. */
+  apr_array_header_t *targets;
+
+  /* Index of the next unclaimed entry in TARGETS.  Protected by MUTEX. */
+  int next;
+
+  /* Set when any worker failed; makes the remaining workers stop after
+   * the subtree they are currently fetching.  Protected by MUTEX. */
+  svn_boolean_t aborted;
+
+  /* The revision to export - resolved to a number, so all workers see
+   * the same tree even if HEAD moves. */
+  svn_opt_revision_t revision;
+
+  /* Options inherited from the export request. */
+  svn_boolean_t overwrite;
+  svn_boolean_t ignore_externals;
+  svn_boolean_t ignore_keywords;
+  const char *native_eol;
+};
+
+/* A single export worker. */
+struct exp_worker
+{
+  struct exp_scheduler *scheduler;
+
+  /* Private client context, sharing the auth baton with the original one
+   * but using serialized callbacks. */
+  svn_client_ctx_t *ctx;
+
+  /* Root pool private to this worker, so its allocations don't race
+   * with those of other threads. */
+  apr_pool_t *pool;
+
+  /* First error encountered by this worker. */
+  svn_error_t *err;
+
+  apr_thread_t *thread;
+};
+
+/* Thread function:  Export subtrees from the scheduler of the exp_worker
+ * given in DATA until none are left or the export got aborted. */
+static void * APR_THREAD_FUNC
+exp_worker_thread(apr_thread_t *thread,
+                  void *data)
+{
+  struct exp_worker *worker = data;
+  struct exp_scheduler *scheduler = worker->scheduler;
+  apr_pool_t *iterpool = svn_pool_create(worker->pool);
+
+  while (TRUE)
+    {
+      const struct exp_target *target;
+      int idx;
+
+      apr_thread_mutex_lock(scheduler->mutex);
+      idx = scheduler->aborted ? scheduler->targets->nelts
+                               : scheduler->next++;
+      apr_thread_mutex_unlock(scheduler->mutex);
+
+      if (idx >= scheduler->targets->nelts)
+        break;
+
+      target = &APR_ARRAY_IDX(scheduler->targets, idx, struct exp_target);
+      svn_pool_clear(iterpool);
+
+      worker->err = svn_client_export5(NULL, target->url, target->to_path,
+                                       &scheduler->revision,
+                                       &scheduler->revision,
+                                       scheduler->overwrite,
+                                       scheduler->ignore_externals,
+                                       scheduler->ignore_keywords,
+                                       svn_depth_infinity,
+                                       scheduler->native_eol,
+                                       worker->ctx, iterpool);
+      if (worker->err)
+        {
+          apr_thread_mutex_lock(scheduler->mutex);
+          scheduler->aborted = TRUE;
+          apr_thread_mutex_unlock(scheduler->mutex);
+          break;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Determine how many export workers the user asked for in CTX's config
+ * and set *WORKERS to that number, clamped to EXPORT_MAX_WORKERS.
+ * *WORKERS <= 1 means the parallel engine stays off. */
+static svn_error_t *
+exp_get_worker_count(int *workers,
+                     svn_client_ctx_t *ctx)
+{
+  svn_config_t *cfg = ctx->config
+                      ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                      : NULL;
+  apr_int64_t value;
+
+  SVN_ERR(svn_config_get_int64(cfg, &value,
+                               SVN_CONFIG_SECTION_MISCELLANY,
+                               SVN_CONFIG_OPTION_EXPORT_WORKERS, 0));
+  if (value > EXPORT_MAX_WORKERS)
+    value = EXPORT_MAX_WORKERS;
+  if (value < 0)
+    value = 0;
+
+  *workers = (int)value;
+
+  return SVN_NO_ERROR;
+}
+
+/* Create a client context for one worker, based on CTX, and return it in
+ * *WORKER_CTX_P, allocated in RESULT_POOL.  The new context shares CTX's
+ * auth baton and serializes notification / cancellation through CB. */
+static svn_error_t *
+exp_create_worker_context(svn_client_ctx_t **worker_ctx_p,
+                          svn_client_ctx_t *ctx,
+                          struct exp_callback_baton *cb,
+                          apr_pool_t *result_pool)
+{
+  svn_client_ctx_t *worker_ctx;
+  apr_hash_t *cfg_hash = NULL;
+
+  /* Give each worker a private copy of the configuration:  option
+   * expansion mutates svn_config_t internals, so the original must not
+   * be read from multiple threads. */
+  if (ctx->config)
+    {
+      svn_config_t *cfg;
+
+      SVN_ERR(svn_config_copy_config(&cfg_hash, ctx->config, result_pool));
+
+      /* Keep the subtree exports run by this worker from starting
+       * nested parallel engines of their own. */
+      cfg = svn_hash_gets(cfg_hash, SVN_CONFIG_CATEGORY_CONFIG);
+      if (cfg)
+        svn_config_set(cfg, SVN_CONFIG_SECTION_MISCELLANY,
+                       SVN_CONFIG_OPTION_EXPORT_WORKERS, "0");
+    }
+
+  SVN_ERR(svn_client_create_context2(&worker_ctx, cfg_hash, result_pool));
+
+  worker_ctx->auth_baton = ctx->auth_baton;
+  worker_ctx->client_name = ctx->client_name;
+  worker_ctx->check_tunnel_func = ctx->check_tunnel_func;
+  worker_ctx->open_tunnel_func = ctx->open_tunnel_func;
+  worker_ctx->tunnel_baton = ctx->tunnel_baton;
+
+  if (cb->notify_func)
+    {
+      worker_ctx->notify_func2 = exp_notify_func;
+      worker_ctx->notify_baton2 = cb;
+    }
+  if (cb->cancel_func)
+    {
+      worker_ctx->cancel_func = exp_cancel_func;
+      worker_ctx->cancel_baton = cb;
+    }
+
+  *worker_ctx_p = worker_ctx;
+
+  return SVN_NO_ERROR;
+}
+
+/* Export the directory at LOC into TO_PATH using WORKERS parallel RA
+ * sessions.
+ *
+ * This runs in two phases:  a serial export of the tree root at depth
+ * 'files', and a parallel phase in which the workers claim the
+ * top-level subdirectories from a shared list and export them through
+ * independent RA sessions.  Every subtree export pins LOC's resolved
+ * revision, so the result is identical to a serial export.  Externals
+ * of the subtrees are handled by the workers; externals defined on the
+ * root itself are exported serially at the end.
+ *
+ * EB and RA_SESSION are the edit baton and session svn_client_export5()
+ * set up for LOC; the remaining options are as for the export itself.
+ * Set *USED to TRUE if the parallel engine ran - it degrades to FALSE
+ * if the tree root has too few subdirectories to win anything by
+ * parallelism. */
+static svn_error_t *
+parallel_export(svn_boolean_t *used,
+                const char *from_url,
+                const char *to_path,
+                struct edit_baton *eb,
+                svn_client__pathrev_t *loc,
+                svn_ra_session_t *ra_session,
+                svn_boolean_t overwrite,
+                svn_boolean_t ignore_externals,
+                svn_boolean_t ignore_keywords,
+                const char *native_eol,
+                int workers,
+                svn_client_ctx_t *ctx,
+                apr_pool_t *scratch_pool)
+{
+  struct exp_scheduler scheduler = { 0 };
+  struct exp_callback_baton cb = { 0 };
+  struct exp_worker *worker_list;
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+  apr_pool_t *pool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_status_t status = APR_SUCCESS;
+  int started;
+  int i;
+
+  *used = FALSE;
+
+  /* Find the top-level subdirectories to hand out to the workers. */
+  SVN_ERR(svn_ra_get_dir2(ra_session, &dirents, NULL, NULL, "",
+                          loc->rev, SVN_DIRENT_KIND, pool));
+
+  scheduler.targets = apr_array_make(pool, apr_hash_count(dirents),
+                                     sizeof(struct exp_target));
+  for (hi = apr_hash_first(pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      svn_dirent_t *dirent = apr_hash_this_val(hi);
+
+      if (dirent->kind == svn_node_dir)
+        {
+          struct exp_target *target
+            = &APR_ARRAY_PUSH(scheduler.targets, struct exp_target);
+
+          target->url = svn_path_url_add_component2(loc->url, name, pool);
+          target->to_path = svn_dirent_join(to_path, name, pool);
+        }
+    }
+
+  /* With fewer than two subtrees there is nothing to parallelize. */
+  if (scheduler.targets->nelts < 2)
+    {
+      svn_pool_destroy(pool);
+      return SVN_NO_ERROR;
+    }
+  if (workers > scheduler.targets->nelts)
+    workers = scheduler.targets->nelts;
+
+  /* Phase 1:  Export the root and its immediate files.  This also
+   * collects the externals defined on the root into EB->EXTERNALS. */
+  SVN_ERR(export_directory(from_url, to_path, eb, loc, ra_session,
+                           TRUE /* ignore_externals, handled below */,
+                           ignore_keywords, svn_depth_files,
+                           native_eol, ctx, pool));
+
+  status = apr_thread_mutex_create(&scheduler.mutex,
+                                   APR_THREAD_MUTEX_DEFAULT, pool);
+  if (status)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_wrap_apr(status, _("Can't create export mutex"));
+    }
+
+  cb.mutex = scheduler.mutex;
+  cb.notify_func = ctx->notify_func2;
+  cb.notify_baton = ctx->notify_baton2;
+  cb.cancel_func = ctx->cancel_func;
+  cb.cancel_baton = ctx->cancel_baton;
+
+  scheduler.revision.kind = svn_opt_revision_number;
+  scheduler.revision.value.number = loc->rev;
+  scheduler.overwrite = overwrite;
+  scheduler.ignore_externals = ignore_externals;
+  scheduler.ignore_keywords = ignore_keywords;
+  scheduler.native_eol = native_eol;
+
+  /* Set up the workers.  Creating the contexts serially here keeps the
+   * config and auth plumbing on this thread. */
+  worker_list = apr_pcalloc(pool, workers * sizeof(*worker_list));
+  for (i = 0; i < workers; i++)
+    {
+      struct exp_worker *worker = &worker_list[i];
+
+      /* Everything the worker thread touches must come from a pool with
+       * a thread-safe allocator, i.e. a root pool. */
+      worker->pool = svn_pool_create(NULL);
+      worker->scheduler = &scheduler;
+
+      err = exp_create_worker_context(&worker->ctx, ctx, &cb,
+                                      worker->pool);
+      if (err)
+        break;
+    }
+
+  /* Phase 2:  Let the workers export the subtrees concurrently. */
+  started = 0;
+  if (!err)
+    for (i = 0; i < workers; i++)
+      {
+        status = apr_thread_create(&worker_list[i].thread, NULL,
+                                   exp_worker_thread, &worker_list[i],
+                                   worker_list[i].pool);
+        if (status)
+          {
+            /* The workers already running will drain the list. */
+            worker_list[i].thread = NULL;
+            break;
+          }
+        started++;
+      }
+
+  if (!err && started == 0)
+    err = svn_error_wrap_apr(status, _("Can't create export thread"));
+
+  for (i = 0; i < workers; i++)
+    {
+      apr_status_t thread_status;
+
+      if (worker_list[i].thread)
+        apr_thread_join(&thread_status, worker_list[i].thread);
+      err = svn_error_compose_create(err, worker_list[i].err);
+      worker_list[i].err = SVN_NO_ERROR;
+      if (worker_list[i].pool)
+        svn_pool_destroy(worker_list[i].pool);
+    }
+  SVN_ERR(err);
+
+  /* Externals defined on the root itself; the workers have already
+   * covered everything defined within their subtrees. */
+  if (! ignore_externals && apr_hash_count(eb->externals))
+    {
+      const char *to_abspath;
+
+      SVN_ERR(svn_dirent_get_absolute(&to_abspath, to_path, pool));
+      SVN_ERR(svn_client__export_externals(eb->externals,
+                                           from_url,
+                                           to_abspath, eb->repos_root_url,
+                                           svn_depth_infinity, native_eol,
+                                           ignore_keywords,
+                                           ctx, pool));
+    }
+
+  svn_pool_destroy(pool);
+  *used = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
 
 
 /*** Public Interfaces ***/
@@ -1435,10 +2149,29 @@ svn_client_export5(svn_revnum_t *result_rev,
         }
       else if (kind == svn_node_dir)
         {
-          SVN_ERR(export_directory(from_url, to_path,
-                                   eb, loc, ra_session,
-                                   ignore_externals, ignore_keywords, depth,
-                                   native_eol, ctx, pool));
+          svn_boolean_t used = FALSE;
+
+#if APR_HAS_THREADS
+          /* Full exports of big trees can use multiple connections. */
+          if (depth == svn_depth_infinity)
+            {
+              int workers;
+
+              SVN_ERR(exp_get_worker_count(&workers, ctx));
+              if (workers > 1)
+                SVN_ERR(parallel_export(&used, from_url, to_path,
+                                        eb, loc, ra_session,
+                                        overwrite, ignore_externals,
+                                        ignore_keywords, native_eol,
+                                        workers, ctx, pool));
+            }
+#endif
+
+          if (! used)
+            SVN_ERR(export_directory(from_url, to_path,
+                                     eb, loc, ra_session,
+                                     ignore_externals, ignore_keywords, depth,
+                                     native_eol, ctx, pool));
         }
       else if (kind == svn_node_none)
         {
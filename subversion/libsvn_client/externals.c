@@ -38,9 +38,11 @@
 #include "svn_path.h"
 #include "svn_props.h"
 #include "svn_config.h"
+#include "svn_sorts.h"
 #include "client.h"
 
 #include "svn_private_config.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_wc_private.h"
 
 
@@ -745,6 +747,12 @@ handle_external_item_removal(const svn_client_ctx_t *ctx,
   return svn_error_trace(err);
 }
 
+/* Handles the change of a single external NEW_ITEM.  *RA_SESSION_P may
+   be NULL or an existing session; it will be reparented or replaced by
+   whatever session this function ends up using, so that a caller
+   processing several externals from the same repository pays for the
+   connection setup only once.  Sessions opened here are allocated in
+   SESSION_POOL which must outlive the (per-item) SCRATCH_POOL. */
 static svn_error_t *
 handle_external_item_change(svn_client_ctx_t *ctx,
                             const char *repos_root_url,
@@ -753,10 +761,12 @@ handle_external_item_change(svn_client_ctx_t *ctx,
                             const char *local_abspath,
                             const char *old_defining_abspath,
                             const svn_wc_external_item2_t *new_item,
-                            svn_ra_session_t *ra_session,
+                            svn_ra_session_t **ra_session_p,
                             svn_boolean_t *timestamp_sleep,
+                            apr_pool_t *session_pool,
                             apr_pool_t *scratch_pool)
 {
+  svn_ra_session_t *ra_session = *ra_session_p;
   svn_client__pathrev_t *new_loc;
   const char *new_url;
   svn_node_kind_t ext_kind;
@@ -805,11 +815,14 @@ handle_external_item_change(svn_client_ctx_t *ctx,
     }
 
   if (!ra_session)
-    SVN_ERR(svn_client__ra_session_from_path2(&ra_session, &new_loc,
-                                              new_url, NULL,
-                                              &(new_item->peg_revision),
-                                              &(new_item->revision), ctx,
-                                              scratch_pool));
+    {
+      SVN_ERR(svn_client__ra_session_from_path2(&ra_session, &new_loc,
+                                                new_url, NULL,
+                                                &(new_item->peg_revision),
+                                                &(new_item->revision), ctx,
+                                                session_pool));
+      *ra_session_p = ra_session;
+    }
 
   SVN_ERR(svn_ra_check_path(ra_session, "", new_loc->rev, &ext_kind,
                             scratch_pool));
@@ -912,7 +925,8 @@ handle_external_item_change(svn_client_ctx_t *ctx,
                                                       NULL,
                                                       &(new_item->peg_revision),
                                                       &(new_item->revision),
-                                                      ctx, scratch_pool));
+                                                      ctx, session_pool));
+            *ra_session_p = ra_session;
           }
 
         SVN_ERR(switch_file_external(local_abspath,
@@ -958,6 +972,98 @@ wrap_external_error(const svn_client_ctx_t *ctx,
   return err;
 }
 
+/* An external item from a single svn:externals definition together with
+   its resolved URL and its position within that definition. */
+typedef struct sortable_external_t
+{
+  svn_wc_external_item2_t *item;
+  const char *resolved_url;
+  int order;
+} sortable_external_t;
+
+/* Implements the comparison function for qsort(), sorting
+   sortable_external_t by resolved URL and using the original definition
+   order as the tie breaker. */
+static int
+compare_sortable_externals(const void *lhs, const void *rhs)
+{
+  const sortable_external_t *lhs_ext = lhs;
+  const sortable_external_t *rhs_ext = rhs;
+  int diff = strcmp(lhs_ext->resolved_url, rhs_ext->resolved_url);
+
+  return diff ? diff : lhs_ext->order - rhs_ext->order;
+}
+
+/* Reorder the svn_wc_external_item2_t * in EXTERNALS, defined on the
+   directory PARENT_DIR_URL in the repository at REPOS_ROOT_URL, so that
+   items from the same repository become adjacent while their relative
+   definition order is retained.  Processing them in this order lets the
+   item handler serve a whole group with one RA session instead of
+   opening a new connection whenever consecutive items name different
+   hosts.
+
+   Leave EXTERNALS alone if any target paths nest - their definition
+   order may matter then - or if some URL does not resolve; the item
+   loop will report the latter with the proper context. */
+static svn_error_t *
+group_externals_by_repository(apr_array_header_t *externals,
+                              const char *repos_root_url,
+                              const char *parent_dir_url,
+                              apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *sortable;
+  apr_array_header_t *targets;
+  int i;
+
+  sortable = apr_array_make(scratch_pool, externals->nelts,
+                            sizeof(sortable_external_t));
+  targets = apr_array_make(scratch_pool, externals->nelts,
+                           sizeof(const char *));
+
+  for (i = 0; i < externals->nelts; i++)
+    {
+      svn_wc_external_item2_t *item
+        = APR_ARRAY_IDX(externals, i, svn_wc_external_item2_t *);
+      sortable_external_t wrapped;
+      svn_error_t *err;
+
+      err = svn_wc__resolve_relative_external_url(&wrapped.resolved_url,
+                                                  item, repos_root_url,
+                                                  parent_dir_url,
+                                                  scratch_pool,
+                                                  scratch_pool);
+      if (err)
+        {
+          svn_error_clear(err);
+          return SVN_NO_ERROR;
+        }
+
+      wrapped.item = item;
+      wrapped.order = i;
+      APR_ARRAY_PUSH(sortable, sortable_external_t) = wrapped;
+      APR_ARRAY_PUSH(targets, const char *) = item->target_dir;
+    }
+
+  /* Nested target paths?  Then the definition order may be significant
+     and we don't touch it. */
+  svn_sort__array(targets, svn_sort_compare_paths);
+  for (i = 1; i < targets->nelts; i++)
+    {
+      const char *predecessor = APR_ARRAY_IDX(targets, i - 1, const char *);
+      const char *target = APR_ARRAY_IDX(targets, i, const char *);
+
+      if (svn_relpath_skip_ancestor(predecessor, target))
+        return SVN_NO_ERROR;
+    }
+
+  svn_sort__array(sortable, compare_sortable_externals);
+  for (i = 0; i < externals->nelts; i++)
+    APR_ARRAY_IDX(externals, i, svn_wc_external_item2_t *)
+      = APR_ARRAY_IDX(sortable, i, sortable_external_t).item;
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 handle_externals_change(svn_client_ctx_t *ctx,
                         const char *repos_root_url,
@@ -974,6 +1080,7 @@ handle_externals_change(svn_client_ctx_t *ctx,
   int i;
   apr_pool_t *iterpool;
   const char *url;
+  svn_ra_session_t *cached_session = ra_session;
 
   iterpool = svn_pool_create(scratch_pool);
 
@@ -998,6 +1105,12 @@ handle_externals_change(svn_client_ctx_t *ctx,
 
   SVN_ERR_ASSERT(url);
 
+  /* Group the items by repository, so the session cached across the
+     loop below serves each repository with a single connection. */
+  if (new_desc && new_desc->nelts > 1)
+    SVN_ERR(group_externals_by_repository(new_desc, repos_root_url, url,
+                                          scratch_pool));
+
   for (i = 0; new_desc && (i < new_desc->nelts); i++)
     {
       const char *old_defining_abspath;
@@ -1036,9 +1149,9 @@ handle_externals_change(svn_client_ctx_t *ctx,
                                                   local_abspath, url,
                                                   target_abspath,
                                                   old_defining_abspath,
-                                                  new_item, ra_session,
+                                                  new_item, &cached_session,
                                                   timestamp_sleep,
-                                                  iterpool),
+                                                  scratch_pool, iterpool),
                       iterpool));
 
       /* And remove already processed items from the to-remove hash */
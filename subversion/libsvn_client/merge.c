@@ -54,6 +54,7 @@
 #include "client.h"
 #include "mergeinfo.h"
 
+#include "private/svn_error_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_client_private.h"
@@ -800,7 +801,8 @@ filter_self_referential_mergeinfo(apr_array_header_t **props,
       /* Non-empty mergeinfo; filter self-referential mergeinfo out. */
 
       /* Parse the incoming mergeinfo to allow easier manipulation. */
-      err = svn_mergeinfo_parse(&mergeinfo, prop->value->data, iterpool);
+      err = svn_mergeinfo__parse_cached(&mergeinfo, prop->value->data,
+                                        iterpool, iterpool);
 
       if (err)
         {
@@ -3195,7 +3197,7 @@ verify_touched_by_del_check(void *baton,
 
       default:
         delb->found_edit = TRUE;
-        return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+        return svn_error__sentinel(SVN_ERR_CEASE_INVOCATION);
     }
 }
 
@@ -6411,8 +6413,8 @@ get_wc_explicit_mergeinfo_catalog(apr_hash_t **subtrees_with_mergeinfo,
 
       svn_pool_clear(iterpool);
 
-      err = svn_mergeinfo_parse(&mergeinfo, mergeinfo_string->data,
-                                result_pool);
+      err = svn_mergeinfo__parse_cached(&mergeinfo, mergeinfo_string->data,
+                                        result_pool, iterpool);
       if (err)
         {
           if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
@@ -12234,7 +12236,7 @@ operative_rev_receiver(void *baton,
      the youngest merged rev is non-inheritable, the *same* non-inheritable
      rev will be found as the oldest eligible rev -- and
      find_last_merged_location() handles that situation. */
-  return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+  return svn_error__sentinel(SVN_ERR_CEASE_INVOCATION);
 }
 
 /* Wrapper around svn_client__mergeinfo_log. All arguments are as per
@@ -97,7 +97,8 @@ svn_client__parse_mergeinfo(svn_mergeinfo_t *mergeinfo,
   SVN_ERR(svn_wc_prop_get2(&propval, wc_ctx, local_abspath, SVN_PROP_MERGEINFO,
                            scratch_pool, scratch_pool));
   if (propval)
-    SVN_ERR(svn_mergeinfo_parse(mergeinfo, propval->data, result_pool));
+    SVN_ERR(svn_mergeinfo__parse_cached(mergeinfo, propval->data,
+                                        result_pool, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -441,8 +442,9 @@ svn_client__get_wc_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
                                               ctx->wc_ctx, node_abspath,
                                               result_pool, scratch_pool));
 
-          SVN_ERR(svn_mergeinfo_parse(&subtree_mergeinfo, propval->data,
-                                      result_pool));
+          SVN_ERR(svn_mergeinfo__parse_cached(&subtree_mergeinfo,
+                                              propval->data,
+                                              result_pool, scratch_pool));
 
           /* If the target had no explicit/inherited mergeinfo and this is the
              first subtree with mergeinfo found, then the catalog will still
@@ -44,6 +44,7 @@
 
 #include "svn_private_config.h"
 #include "private/svn_eol_private.h"
+#include "private/svn_error_private.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_diff_private.h"
@@ -98,6 +99,15 @@ typedef struct target_content_t {
   /* An array containing hunk_info_t structures for hunks already matched. */
   apr_array_header_t *hunks;
 
+  /* Maps a line of unpatched content (after keyword contraction) to an
+   * apr_array_header_t of svn_linenum_t listing every line with that
+   * content, in ascending order.  Built on demand by scan_for_match();
+   * NULL until the first open-ended exact-match scan. */
+  apr_hash_t *line_index;
+
+  /* The pool this structure was allocated in; also holds LINE_INDEX. */
+  apr_pool_t *pool;
+
   /* True if end-of-file was reached while reading from the unpatched
    * content. */
   svn_boolean_t eof;
@@ -763,6 +773,7 @@ init_prop_target(prop_patch_target_t **prop_target,
   content->lines = apr_array_make(result_pool, 0, sizeof(apr_off_t));
   content->hunks = apr_array_make(result_pool, 0, sizeof(hunk_info_t *));
   content->keywords = apr_hash_make(result_pool);
+  content->pool = result_pool;
 
   new_prop_target = apr_pcalloc(result_pool, sizeof(*new_prop_target));
   new_prop_target->name = apr_pstrdup(result_pool, prop_name);
@@ -1033,6 +1044,7 @@ init_patch_target(patch_target_t **patch_target,
   content->lines = apr_array_make(result_pool, 0, sizeof(apr_off_t));
   content->hunks = apr_array_make(result_pool, 0, sizeof(hunk_info_t *));
   content->keywords = apr_hash_make(result_pool);
+  content->pool = result_pool;
 
   target = apr_pcalloc(result_pool, sizeof(*target));
 
@@ -1665,6 +1677,139 @@ match_hunk(svn_boolean_t *matched, target_content_t *content,
   return SVN_NO_ERROR;
 }
 
+/* Ensure that CONTENT->LINE_INDEX exists, building it if necessary by
+ * reading the unpatched content from the beginning to EOF.  As a side
+ * effect, this marks every line's offset in CONTENT->LINES, making all
+ * subsequent seeks cheap.  The index, its keys and the line number
+ * arrays are allocated in CONTENT->POOL.
+ * Do temporary allocations in SCRATCH_POOL. */
+static svn_error_t *
+ensure_line_index(target_content_t *content, apr_pool_t *scratch_pool)
+{
+  svn_linenum_t saved_line = content->current_line;
+  svn_boolean_t saved_eof = content->eof;
+  apr_pool_t *iterpool;
+
+  if (content->line_index)
+    return SVN_NO_ERROR;
+
+  content->line_index = apr_hash_make(content->pool);
+
+  SVN_ERR(seek_to_line(content, 1, scratch_pool));
+  iterpool = svn_pool_create(scratch_pool);
+  while (! content->eof)
+    {
+      const char *line;
+      svn_linenum_t line_number = content->current_line;
+      apr_array_header_t *occurrences;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(readline(content, &line, iterpool, iterpool));
+      if (content->eof && *line == '\0')
+        break;
+
+      occurrences = svn_hash_gets(content->line_index, line);
+      if (occurrences == NULL)
+        {
+          occurrences = apr_array_make(content->pool, 1,
+                                       sizeof(svn_linenum_t));
+          svn_hash_sets(content->line_index,
+                        apr_pstrdup(content->pool, line), occurrences);
+        }
+      APR_ARRAY_PUSH(occurrences, svn_linenum_t) = line_number;
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Restore the read position, including the EOF state it had. */
+  SVN_ERR(seek_to_line(content, saved_line, scratch_pool));
+  content->eof = saved_eof;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *FIRST_LINE to the keyword-contracted first line of the original
+ * (or, if MATCH_MODIFIED is set, the modified) text of HUNK, allocated
+ * in RESULT_POOL.  Set *INDEXABLE to TRUE if that line exists and can
+ * serve as a key into CONTENT->LINE_INDEX, i.e. the hunk text is not
+ * empty.  The hunk's text is rewound afterwards.
+ * Do temporary allocations in SCRATCH_POOL. */
+static svn_error_t *
+hunk_first_line(const char **first_line,
+                svn_boolean_t *indexable,
+                svn_diff_hunk_t *hunk,
+                target_content_t *content,
+                svn_boolean_t match_modified,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *hunk_line;
+  svn_boolean_t hunk_eof;
+
+  if (match_modified)
+    {
+      svn_diff_hunk_reset_modified_text(hunk);
+      SVN_ERR(svn_diff_hunk_readline_modified_text(hunk, &hunk_line,
+                                                   NULL, &hunk_eof,
+                                                   scratch_pool,
+                                                   scratch_pool));
+      svn_diff_hunk_reset_modified_text(hunk);
+    }
+  else
+    {
+      svn_diff_hunk_reset_original_text(hunk);
+      SVN_ERR(svn_diff_hunk_readline_original_text(hunk, &hunk_line,
+                                                   NULL, &hunk_eof,
+                                                   scratch_pool,
+                                                   scratch_pool));
+      svn_diff_hunk_reset_original_text(hunk);
+    }
+
+  if (hunk_eof || hunk_line->len == 0)
+    {
+      *first_line = "";
+      *indexable = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_subst_translate_cstring2(hunk_line->data, first_line,
+                                       NULL, FALSE, content->keywords,
+                                       FALSE, result_pool));
+  *indexable = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if a match of HUNK-length lines at LINE would overlap a
+ * previously matched hunk in CONTENT.  MATCH_MODIFIED selects which
+ * hunk text determines the length, as in match_hunk(). */
+static svn_boolean_t
+match_is_taken(const target_content_t *content,
+               svn_linenum_t line,
+               svn_boolean_t match_modified)
+{
+  int i;
+
+  for (i = 0; i < content->hunks->nelts; i++)
+    {
+      const hunk_info_t *hi;
+      svn_linenum_t length;
+
+      hi = APR_ARRAY_IDX(content->hunks, i, const hunk_info_t *);
+
+      if (match_modified)
+        length = svn_diff_hunk_get_modified_length(hi->hunk);
+      else
+        length = svn_diff_hunk_get_original_length(hi->hunk);
+
+      if (! hi->rejected &&
+          line >= hi->matched_line &&
+          line < (hi->matched_line + length))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 /* Scan lines of CONTENT for a match of the original text of HUNK,
  * up to but not including the specified UPPER_LINE. Use fuzz factor FUZZ.
  * If UPPER_LINE is zero scan until EOF occurs when reading from TARGET.
@@ -1693,6 +1838,66 @@ scan_for_match(svn_linenum_t *matched_line,
 
   *matched_line = 0;
   iterpool = svn_pool_create(pool);
+
+  /* With exact matching and a scan range of more than one line, the
+   * hunk can only match where its first line occurs in the target.
+   * Consult the line index and try just those candidate lines instead
+   * of attempting a match at every line of the scan range - with many
+   * hunks on a large target, the difference is night and day. */
+  if (fuzz == 0 && ! ignore_whitespace && content->readline != NULL
+      && (upper_line == 0 || upper_line > content->current_line + 1))
+    {
+      const char *first_line;
+      svn_boolean_t indexable;
+      svn_linenum_t start_line = content->current_line;
+
+      SVN_ERR(hunk_first_line(&first_line, &indexable, hunk, content,
+                              match_modified, pool, iterpool));
+      if (indexable)
+        {
+          apr_array_header_t *candidates;
+          int i;
+
+          SVN_ERR(ensure_line_index(content, iterpool));
+          svn_pool_clear(iterpool);
+
+          candidates = svn_hash_gets(content->line_index, first_line);
+          for (i = 0; candidates && i < candidates->nelts; i++)
+            {
+              svn_linenum_t candidate
+                = APR_ARRAY_IDX(candidates, i, svn_linenum_t);
+              svn_boolean_t matched;
+
+              if (candidate < start_line)
+                continue;
+              if (upper_line > 0 && candidate >= upper_line)
+                break;
+
+              svn_pool_clear(iterpool);
+
+              if (cancel_func)
+                SVN_ERR(cancel_func(cancel_baton));
+
+              SVN_ERR(seek_to_line(content, candidate, iterpool));
+              SVN_ERR(match_hunk(&matched, content, hunk, fuzz,
+                                 ignore_whitespace, match_modified,
+                                 iterpool));
+
+              /* Don't allow hunks to match at overlapping locations. */
+              if (matched &&
+                  ! match_is_taken(content, candidate, match_modified))
+                {
+                  *matched_line = candidate;
+                  if (match_first)
+                    break;
+                }
+            }
+          svn_pool_destroy(iterpool);
+
+          return SVN_NO_ERROR;
+        }
+    }
+
   while ((content->current_line < upper_line || upper_line == 0) &&
          ! content->eof)
     {
@@ -1705,37 +1910,14 @@ scan_for_match(svn_linenum_t *matched_line,
 
       SVN_ERR(match_hunk(&matched, content, hunk, fuzz, ignore_whitespace,
                          match_modified, iterpool));
-      if (matched)
-        {
-          svn_boolean_t taken = FALSE;
-          int i;
-
-          /* Don't allow hunks to match at overlapping locations. */
-          for (i = 0; i < content->hunks->nelts; i++)
-            {
-              const hunk_info_t *hi;
-              svn_linenum_t length;
-
-              hi = APR_ARRAY_IDX(content->hunks, i, const hunk_info_t *);
-
-              if (match_modified)
-                length = svn_diff_hunk_get_modified_length(hi->hunk);
-              else
-                length = svn_diff_hunk_get_original_length(hi->hunk);
 
-              taken = (! hi->rejected &&
-                       content->current_line >= hi->matched_line &&
-                       content->current_line < (hi->matched_line + length));
-              if (taken)
-                break;
-            }
-
-          if (! taken)
-            {
-              *matched_line = content->current_line;
-              if (match_first)
-                break;
-            }
+      /* Don't allow hunks to match at overlapping locations. */
+      if (matched &&
+          ! match_is_taken(content, content->current_line, match_modified))
+        {
+          *matched_line = content->current_line;
+          if (match_first)
+            break;
         }
 
       if (! content->eof)
@@ -3524,7 +3706,7 @@ can_delete_callback(void *baton,
 
         cb->must_keep = TRUE;
 
-        return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+        return svn_error__sentinel(SVN_ERR_CEASE_INVOCATION);
     }
 }
 
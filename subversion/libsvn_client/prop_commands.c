@@ -44,6 +44,7 @@
 #include "private/svn_wc_private.h"
 #include "private/svn_ra_private.h"
 #include "private/svn_client_private.h"
+#include "private/svn_client_mtcc.h"
 
 
 /*** Code. ***/
@@ -403,6 +404,126 @@ svn_client_propset_remote(const char *propname,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_client_propset_urls_remote(const char *propname,
+                               const svn_string_t *propval,
+                               const apr_array_header_t *urls,
+                               svn_boolean_t skip_checks,
+                               svn_revnum_t base_revision_for_url,
+                               const apr_hash_t *revprop_table,
+                               svn_commit_callback2_t commit_callback,
+                               void *commit_baton,
+                               svn_client_ctx_t *ctx,
+                               apr_pool_t *scratch_pool)
+{
+  svn_client__mtcc_t *mtcc;
+  const char *common_url;
+  const char *message;
+  apr_hash_t *commit_revprops;
+  apr_pool_t *iterpool;
+  int i;
+
+  if (urls->nelts == 0)
+    return SVN_NO_ERROR;
+
+  if (urls->nelts == 1)
+    return svn_error_trace(svn_client_propset_remote(
+                             propname, propval,
+                             APR_ARRAY_IDX(urls, 0, const char *),
+                             skip_checks, base_revision_for_url,
+                             revprop_table, commit_callback, commit_baton,
+                             ctx, scratch_pool));
+
+  SVN_ERR(check_prop_name(propname, propval));
+
+  /* See svn_client_propset_remote() for the rationale behind these two
+     restrictions; they apply equally to every target of the batch. */
+  if (! SVN_IS_VALID_REVNUM(base_revision_for_url))
+    return svn_error_create(SVN_ERR_CLIENT_BAD_REVISION, NULL,
+                            _("Setting property on non-local targets "
+                              "needs a base revision"));
+
+  if ((strcmp(propname, SVN_PROP_EOL_STYLE) == 0) ||
+      (strcmp(propname, SVN_PROP_KEYWORDS) == 0))
+    return svn_error_createf(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                             _("Setting property '%s' on non-local "
+                               "targets is not supported"), propname);
+
+  /* Find the tightest URL enclosing all targets; that becomes the root
+     of the single edit drive carrying all the property changes. */
+  common_url = APR_ARRAY_IDX(urls, 0, const char *);
+  for (i = 0; i < urls->nelts; i++)
+    {
+      const char *url = APR_ARRAY_IDX(urls, i, const char *);
+
+      if (!svn_path_is_url(url))
+        return svn_error_create(SVN_ERR_ILLEGAL_TARGET, NULL,
+                                _("Targets must be URLs"));
+
+      common_url = svn_uri_get_longest_ancestor(common_url, url,
+                                                scratch_pool);
+    }
+
+  if (*common_url == '\0')
+    return svn_error_create(SVN_ERR_ILLEGAL_TARGET, NULL,
+                            _("All targets must be in the same repository"));
+
+  /* Create a new commit item per target and get the log message. */
+  if (SVN_CLIENT__HAS_LOG_MSG_FUNC(ctx))
+    {
+      const char *tmp_file;
+      apr_array_header_t *commit_items
+        = apr_array_make(scratch_pool, urls->nelts,
+                         sizeof(svn_client_commit_item3_t *));
+
+      for (i = 0; i < urls->nelts; i++)
+        {
+          svn_client_commit_item3_t *item
+            = svn_client_commit_item3_create(scratch_pool);
+
+          item->url = APR_ARRAY_IDX(urls, i, const char *);
+          item->kind = svn_node_unknown;
+          item->state_flags = SVN_CLIENT_COMMIT_ITEM_PROP_MODS;
+          APR_ARRAY_PUSH(commit_items, svn_client_commit_item3_t *) = item;
+        }
+
+      SVN_ERR(svn_client__get_log_msg(&message, &tmp_file, commit_items,
+                                      ctx, scratch_pool));
+      if (! message)
+        return SVN_NO_ERROR;
+    }
+  else
+    message = "";
+
+  SVN_ERR(svn_client__ensure_revprop_table(&commit_revprops, revprop_table,
+                                           message, ctx, scratch_pool));
+
+  SVN_ERR(svn_client__mtcc_create(&mtcc, common_url, base_revision_for_url,
+                                  ctx, scratch_pool, scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < urls->nelts; i++)
+    {
+      const char *url = APR_ARRAY_IDX(urls, i, const char *);
+      const char *relpath;
+
+      svn_pool_clear(iterpool);
+
+      if (ctx->cancel_func)
+        SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
+
+      relpath = svn_uri_skip_ancestor(common_url, url, iterpool);
+      SVN_ERR(svn_client__mtcc_add_propset(relpath, propname, propval,
+                                           skip_checks, mtcc, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_client__mtcc_commit(commit_revprops,
+                                                 commit_callback,
+                                                 commit_baton,
+                                                 mtcc, scratch_pool));
+}
+
 static svn_error_t *
 check_and_set_revprop(svn_revnum_t *set_rev,
                       svn_ra_session_t *ra_session,
@@ -24,7 +24,9 @@
 
 
 #include <apr_pools.h>
+#include <apr_uri.h>
 
+#include "svn_config.h"
 #include "svn_error.h"
 #include "svn_hash.h"
 #include "svn_pools.h"
@@ -1000,6 +1002,68 @@ svn_client__calc_youngest_common_ancestor(svn_client__pathrev_t **ancestor_p,
   return SVN_NO_ERROR;
 }
 
+/* The cached full history of one location, as stored in the client
+   context's location_history_cache.  See get_history_memoized(). */
+typedef struct location_history_t
+{
+  /* History of the location in mergeinfo form, covering its whole
+     lifetime down to revision 0 resp. its initial addition. */
+  svn_mergeinfo_t history;
+
+  /* Whether the history reaches back to revision 0. */
+  svn_boolean_t has_rev_zero_history;
+} location_history_t;
+
+/* Like svn_client__get_history_as_mergeinfo() for the full history of
+   LOC, but memoize the result in CTX's private context.  A node's
+   history at a fixed peg revision is immutable, so within the lifetime
+   of one client context - typically one CLI operation - each location's
+   get-location-segments walk is issued at most once, no matter how many
+   ancestry queries a merge or conflict resolution performs. */
+static svn_error_t *
+get_history_memoized(apr_hash_t **history,
+                     svn_boolean_t *has_rev_zero_history,
+                     const svn_client__pathrev_t *loc,
+                     svn_ra_session_t *session,
+                     svn_client_ctx_t *ctx,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  svn_client__private_ctx_t *private_ctx = svn_client__get_private_ctx(ctx);
+  const char *key = apr_psprintf(scratch_pool, "%s@%ld", loc->url, loc->rev);
+  location_history_t *entry;
+
+  if (private_ctx->location_history_cache)
+    entry = svn_hash_gets(private_ctx->location_history_cache, key);
+  else
+    entry = NULL;
+
+  if (!entry)
+    {
+      apr_pool_t *cache_pool;
+
+      if (!private_ctx->location_history_cache)
+        private_ctx->location_history_cache
+          = apr_hash_make(private_ctx->pool);
+      cache_pool = apr_hash_pool_get(private_ctx->location_history_cache);
+
+      entry = apr_pcalloc(cache_pool, sizeof(*entry));
+      SVN_ERR(svn_client__get_history_as_mergeinfo(&entry->history,
+                                                   &entry->has_rev_zero_history,
+                                                   loc,
+                                                   SVN_INVALID_REVNUM,
+                                                   SVN_INVALID_REVNUM,
+                                                   session, ctx, cache_pool));
+      svn_hash_sets(private_ctx->location_history_cache,
+                    apr_pstrdup(cache_pool, key), entry);
+    }
+
+  *history = svn_mergeinfo_dup(entry->history, result_pool);
+  *has_rev_zero_history = entry->has_rev_zero_history;
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_client__get_youngest_common_ancestor(svn_client__pathrev_t **ancestor_p,
                                          const svn_client__pathrev_t *loc1,
@@ -1030,18 +1094,14 @@ svn_client__get_youngest_common_ancestor(svn_client__pathrev_t **ancestor_p,
 
   /* We're going to cheat and use history-as-mergeinfo because it
      saves us a bunch of annoying custom data comparisons and such. */
-  SVN_ERR(svn_client__get_history_as_mergeinfo(&history1,
-                                               &has_rev_zero_history1,
-                                               loc1,
-                                               SVN_INVALID_REVNUM,
-                                               SVN_INVALID_REVNUM,
-                                               session, ctx, scratch_pool));
-  SVN_ERR(svn_client__get_history_as_mergeinfo(&history2,
-                                               &has_rev_zero_history2,
-                                               loc2,
-                                               SVN_INVALID_REVNUM,
-                                               SVN_INVALID_REVNUM,
-                                               session, ctx, scratch_pool));
+  SVN_ERR(get_history_memoized(&history1,
+                               &has_rev_zero_history1,
+                               loc1, session, ctx,
+                               scratch_pool, scratch_pool));
+  SVN_ERR(get_history_memoized(&history2,
+                               &has_rev_zero_history2,
+                               loc2, session, ctx,
+                               scratch_pool, scratch_pool));
   /* Close the ra session if we opened one. */
   if (sesspool)
     svn_pool_destroy(sesspool);
@@ -1198,3 +1258,36 @@ svn_client__ra_make_cb_baton(svn_wc_context_t *wc_ctx,
 
   return reb;
 }
+
+
+svn_error_t *
+svn_client__get_verify_base_checksums(svn_boolean_t *verify,
+                                      const char *url,
+                                      svn_client_ctx_t *ctx,
+                                      apr_pool_t *scratch_pool)
+{
+  svn_config_t *servers = NULL;
+  const char *server_group;
+  apr_uri_t uri;
+
+  /* Re-verifying stored pristine contents is the default. */
+  *verify = TRUE;
+
+  if (ctx->config)
+    servers = svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_SERVERS);
+  if (servers == NULL || url == NULL)
+    return SVN_NO_ERROR;
+
+  if (apr_uri_parse(scratch_pool, url, &uri) || uri.hostname == NULL)
+    return SVN_NO_ERROR;
+
+  server_group = svn_config_find_group(servers, uri.hostname,
+                                       SVN_CONFIG_SECTION_GROUPS,
+                                       scratch_pool);
+
+  return svn_error_trace(svn_config_get_server_setting_bool(
+                           servers, verify,
+                           server_group, /* NULL is OK */
+                           SVN_CONFIG_OPTION_VERIFY_BASE_CHECKSUMS,
+                           TRUE));
+}
@@ -114,6 +114,7 @@ switch_internal(svn_revnum_t *result_rev,
   const char *preserved_exts_str;
   apr_array_header_t *preserved_exts;
   svn_boolean_t server_supports_depth;
+  svn_boolean_t verify_base_checksums;
   struct svn_client__dirent_fetcher_baton_t dfb;
   svn_config_t *cfg = ctx->config
                       ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
@@ -306,12 +307,24 @@ switch_internal(svn_revnum_t *result_rev,
   dfb.anchor_url = anchor_url;
   dfb.target_revision = switch_loc->rev;
 
+  /* See if the user trusts the stored pristines of this server's data
+     enough to skip re-verifying them before deltas get applied. */
+  SVN_ERR(svn_client__get_verify_base_checksums(&verify_base_checksums,
+                                                anchor_url, ctx, pool));
+
+  /* The editor applies incoming deltas against stored pristines; if any
+     are missing from the store (e.g. in a 'store-pristines = no' working
+     copy), restore them before the drive starts. */
+  SVN_ERR(svn_client__hydrate_pristines(anchor_abspath, ra_session, ctx,
+                                        pool));
+
   SVN_ERR(svn_wc__get_switch_editor(&switch_editor, &switch_edit_baton,
                                     &revnum, ctx->wc_ctx, anchor_abspath,
                                     target, switch_loc->url, wcroot_iprops,
                                     use_commit_times, depth,
                                     depth_is_sticky, allow_unver_obstructions,
                                     server_supports_depth,
+                                    verify_base_checksums,
                                     diff3_cmd, preserved_exts,
                                     svn_client__dirent_fetcher, &dfb,
                                     conflicted_paths ? record_conflict : NULL,
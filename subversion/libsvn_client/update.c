@@ -92,6 +92,96 @@ svn_client__dirent_fetcher(void *baton,
 
 /*** Code. ***/
 
+svn_error_t *
+svn_client__get_store_pristines(svn_boolean_t *store_pristines,
+                                svn_client_ctx_t *ctx)
+{
+  svn_config_t *cfg = ctx->config
+                      ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                      : NULL;
+
+  return svn_error_trace(
+           svn_config_get_bool(cfg, store_pristines,
+                               SVN_CONFIG_SECTION_WORKING_COPY,
+                               SVN_CONFIG_OPTION_STORE_PRISTINES,
+                               TRUE));
+}
+
+/* Baton for hydrate_fetch_func. */
+struct hydrate_fetch_baton_t
+{
+  /* Session parented at the root of the working copy's repository. */
+  svn_ra_session_t *ra_session;
+};
+
+/* Implements svn_wc__pristine_fetch_t: fetch REPOS_RELPATH@REVISION
+   over the RA session in BATON. */
+static svn_error_t *
+hydrate_fetch_func(void *baton,
+                   svn_stream_t *contents,
+                   const char *repos_relpath,
+                   svn_revnum_t revision,
+                   apr_pool_t *scratch_pool)
+{
+  struct hydrate_fetch_baton_t *hfb = baton;
+
+  return svn_error_trace(svn_ra_get_file(hfb->ra_session, repos_relpath,
+                                         revision, contents, NULL, NULL,
+                                         scratch_pool));
+}
+
+svn_error_t *
+svn_client__hydrate_pristines(const char *local_abspath,
+                              svn_ra_session_t *ra_session,
+                              svn_client_ctx_t *ctx,
+                              apr_pool_t *scratch_pool)
+{
+  svn_boolean_t missing;
+  svn_boolean_t store_pristines;
+
+  SVN_ERR(svn_wc__pristines_missing(&missing, ctx->wc_ctx, local_abspath,
+                                    scratch_pool));
+  if (missing)
+    {
+      struct hydrate_fetch_baton_t hfb;
+      const char *repos_root_url;
+      const char *old_url = NULL;
+
+      /* The recorded repository paths are relative to the repository root,
+         so that is where the session must point. */
+      SVN_ERR(svn_client_get_repos_root(&repos_root_url, NULL, local_abspath,
+                                        ctx, scratch_pool, scratch_pool));
+
+      if (ra_session)
+        SVN_ERR(svn_client__ensure_ra_session_url(&old_url, ra_session,
+                                                  repos_root_url,
+                                                  scratch_pool));
+      else
+        SVN_ERR(svn_client_open_ra_session2(&ra_session, repos_root_url,
+                                            local_abspath, ctx,
+                                            scratch_pool, scratch_pool));
+
+      hfb.ra_session = ra_session;
+      SVN_ERR(svn_wc__pristines_hydrate(NULL, ctx->wc_ctx, local_abspath,
+                                        hydrate_fetch_func, &hfb,
+                                        ctx->cancel_func, ctx->cancel_baton,
+                                        scratch_pool));
+
+      if (old_url)
+        SVN_ERR(svn_ra_reparent(ra_session, old_url, scratch_pool));
+    }
+
+  /* If the user has turned pristine storage back on, the store is complete
+     again as of here: record that in the working copy, so that it is no
+     longer treated as dehydrated once this client walks away. */
+  SVN_ERR(svn_client__get_store_pristines(&store_pristines, ctx));
+  if (store_pristines)
+    SVN_ERR(svn_wc__pristines_mark_stored(ctx->wc_ctx, local_abspath,
+                                          scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Set *CLEAN_CHECKOUT to FALSE only if LOCAL_ABSPATH is a non-empty
    folder. ANCHOR_ABSPATH is the w/c root and LOCAL_ABSPATH will still
    be considered empty, if it is equal to ANCHOR_ABSPATH and only
@@ -314,6 +404,7 @@ update_internal(svn_revnum_t *result_rev,
   svn_revnum_t revnum;
   svn_boolean_t use_commit_times;
   svn_boolean_t clean_checkout = FALSE;
+  svn_boolean_t verify_base_checksums;
   const char *diff3_cmd;
   apr_hash_t *wcroot_iprops;
   svn_opt_revision_t opt_rev;
@@ -519,6 +610,18 @@ update_internal(svn_revnum_t *result_rev,
                                             revnum, depth, ra_session,
                                             ctx, scratch_pool, scratch_pool));
 
+  /* See if the user trusts the stored pristines of this server's data
+     enough to skip re-verifying them before deltas get applied. */
+  SVN_ERR(svn_client__get_verify_base_checksums(&verify_base_checksums,
+                                                anchor_url, ctx,
+                                                scratch_pool));
+
+  /* The editor applies incoming deltas against stored pristines; if any
+     are missing from the store (e.g. in a 'store-pristines = no' working
+     copy), restore them before the drive starts. */
+  SVN_ERR(svn_client__hydrate_pristines(anchor_abspath, ra_session, ctx,
+                                        scratch_pool));
+
   /* Fetch the update editor.  If REVISION is invalid, that's okay;
      the RA driver will call editor->set_target_revision later on. */
   SVN_ERR(svn_wc__get_update_editor(&update_editor, &update_edit_baton,
@@ -529,6 +632,7 @@ update_internal(svn_revnum_t *result_rev,
                                     adds_as_modification,
                                     server_supports_depth,
                                     clean_checkout,
+                                    verify_base_checksums,
                                     diff3_cmd, preserved_exts,
                                     svn_client__dirent_fetcher, &dfb,
                                     conflicted_paths ? record_conflict : NULL,
@@ -576,6 +680,19 @@ update_internal(svn_revnum_t *result_rev,
                                repos_root_url, ra_session, ctx, scratch_pool));
     }
 
+  /* In a 'store-pristines = no' working copy, drop the texts we can
+     fetch from the repository again; only those needed to work offline
+     (locally modified files, local copies and moves) stay behind. */
+  {
+    svn_boolean_t store_pristines;
+
+    SVN_ERR(svn_client__get_store_pristines(&store_pristines, ctx));
+    if (!store_pristines)
+      SVN_ERR(svn_wc__pristines_dehydrate(NULL, ctx->wc_ctx, anchor_abspath,
+                                          ctx->cancel_func, ctx->cancel_baton,
+                                          scratch_pool));
+  }
+
   /* Let everyone know we're finished here (unless we're asked not to). */
   if (ctx->notify_func2 && notify_summary)
     {
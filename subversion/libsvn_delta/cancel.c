@@ -23,6 +23,8 @@
 
 #include "svn_delta.h"
 
+#include "private/svn_subr_private.h"
+
 struct edit_baton
 {
   const svn_delta_editor_t *wrapped_editor;
@@ -383,8 +385,11 @@ svn_delta_get_cancellation_editor(svn_cancel_func_t cancel_func,
 
       eb->wrapped_editor = wrapped_editor;
       eb->wrapped_edit_baton = wrapped_edit_baton;
-      eb->cancel_func = cancel_func;
-      eb->cancel_baton = cancel_baton;
+
+      /* This editor polls once per visited node; throttle the calls
+         that actually reach the (potentially expensive) callback. */
+      svn_cancel__create_throttled(&eb->cancel_func, &eb->cancel_baton,
+                                   cancel_func, cancel_baton, pool);
 
       *editor = tree_editor;
       *edit_baton = eb;
@@ -459,13 +459,88 @@ process_actions(struct ev2_edit_baton *eb,
   return SVN_NO_ERROR;
 }
 
+/* Return whether CHANGE is a plain file addition (or replacement) that
+   can be carried by svn_editor_add_files():  no copyfrom source, no
+   unlock side effect.  */
+static svn_boolean_t
+change_is_batchable_add(const struct change_node *change)
+{
+  return change->action == RESTRUCTURE_ADD
+         && change->kind == svn_node_file
+         && change->copyfrom_path == NULL
+         && !change->unlock;
+}
+
+/* Append an svn_editor_file_t for the file addition CHANGE of
+   REPOS_RELPATH to BATCH.  All allocations - including the opened
+   contents stream - are made in BATCH's pool, which must live until
+   the batch is flushed.  */
+static svn_error_t *
+append_file_add(apr_array_header_t *batch,
+                const char *repos_relpath,
+                const struct change_node *change,
+                apr_pool_t *batch_pool)
+{
+  svn_editor_file_t *file = apr_pcalloc(batch_pool, sizeof(*file));
+
+  if (change->contents_abspath)
+    {
+      svn_checksum_t *checksum;
+
+      /* ### the checksum might be in CHANGE->CHECKSUM  */
+      SVN_ERR(svn_io_file_checksum2(&checksum, change->contents_abspath,
+                                    svn_checksum_sha1, batch_pool));
+      file->checksum = checksum;
+      SVN_ERR(svn_stream_open_readonly(&file->contents,
+                                       change->contents_abspath,
+                                       batch_pool, batch_pool));
+    }
+  else
+    {
+      file->contents = svn_stream_empty(batch_pool);
+      file->checksum = svn_checksum_empty_checksum(svn_checksum_sha1,
+                                                   batch_pool);
+    }
+
+  file->relpath = apr_pstrdup(batch_pool, repos_relpath);
+  file->props = change->props != NULL ? change->props
+                                      : apr_hash_make(batch_pool);
+  file->replaces_rev = change->deleting;
+
+  APR_ARRAY_PUSH(batch, svn_editor_file_t *) = file;
+
+  return SVN_NO_ERROR;
+}
+
+/* If BATCH contains any pending file additions, drive them into EB's
+   editor and empty BATCH, releasing the batch data from BATCH_POOL. */
+static svn_error_t *
+flush_file_adds(struct ev2_edit_baton *eb,
+                apr_array_header_t *batch,
+                apr_pool_t *batch_pool)
+{
+  if (batch->nelts == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_editor_add_files(eb->editor, batch));
+
+  apr_array_clear(batch);
+  svn_pool_clear(batch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 run_ev2_actions(struct ev2_edit_baton *eb,
                 apr_pool_t *scratch_pool)
 {
   apr_pool_t *iterpool;
+  apr_pool_t *batch_pool;
+  apr_array_header_t *batch;
 
   iterpool = svn_pool_create(scratch_pool);
+  batch_pool = svn_pool_create(scratch_pool);
+  batch = apr_array_make(scratch_pool, 16, sizeof(svn_editor_file_t *));
 
   /* Possibly pick up where we left off. Occasionally, we do some of these
      as part of close_edit() and then some more as part of abort_edit()  */
@@ -477,10 +552,25 @@ run_ev2_actions(struct ev2_edit_baton *eb,
       const struct change_node *change = svn_hash_gets(eb->changes,
                                                        repos_relpath);
 
+      /* Coalesce runs of plain file additions into one batched editor
+         call, so batch-aware receivers can amortize their per-node
+         overhead.  Any other change flushes the pending batch first to
+         preserve the drive order.  */
+      if (change_is_batchable_add(change))
+        {
+          SVN_ERR(append_file_add(batch, repos_relpath, change, batch_pool));
+          continue;
+        }
+
+      SVN_ERR(flush_file_adds(eb, batch, batch_pool));
+
       svn_pool_clear(iterpool);
 
       SVN_ERR(process_actions(eb, repos_relpath, change, iterpool));
     }
+  SVN_ERR(flush_file_adds(eb, batch, batch_pool));
+
+  svn_pool_destroy(batch_pool);
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
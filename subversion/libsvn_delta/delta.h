@@ -44,6 +44,15 @@ extern "C" {
 
 #define SVN_DELTA_WINDOW_SIZE 102400
 
+/* The largest window size our svndiff decoders accept.  We keep emitting
+   SVN_DELTA_WINDOW_SIZE windows by default because decoders of existing
+   releases reject anything larger, but accepting up to this size today
+   allows a future release to negotiate large windows for big binary
+   artifacts without per-window overhead 200x that of the payload.
+   See svn_txdelta__sized(). */
+
+#define SVN_DELTA_WINDOW_SIZE_MAX (16 * 1024 * 1024)
+
 
 /* Context/baton for building an operation sequence. */
 
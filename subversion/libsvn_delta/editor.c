@@ -310,6 +310,16 @@ svn_editor_setcb_add_file(svn_editor_t *editor,
 }
 
 
+svn_error_t *
+svn_editor_setcb_add_files(svn_editor_t *editor,
+                           svn_editor_cb_add_files_t callback,
+                           apr_pool_t *scratch_pool)
+{
+  editor->funcs.cb_add_files = callback;
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_editor_setcb_add_symlink(svn_editor_t *editor,
                              svn_editor_cb_add_symlink_t callback,
@@ -544,6 +554,68 @@ svn_editor_add_file(svn_editor_t *editor,
 }
 
 
+svn_error_t *
+svn_editor_add_files(svn_editor_t *editor,
+                     const apr_array_header_t *files)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  /* Without a batch-aware receiver this is mere sugar for driving the
+     single-file callback once per element. */
+  if (!editor->funcs.cb_add_files)
+    {
+      for (i = 0; i < files->nelts; i++)
+        {
+          const svn_editor_file_t *file
+            = APR_ARRAY_IDX(files, i, const svn_editor_file_t *);
+
+          SVN_ERR(svn_editor_add_file(editor, file->relpath, file->checksum,
+                                      file->contents, file->props,
+                                      file->replaces_rev));
+        }
+
+      return SVN_NO_ERROR;
+    }
+
+  for (i = 0; i < files->nelts; i++)
+    {
+      const svn_editor_file_t *file
+        = APR_ARRAY_IDX(files, i, const svn_editor_file_t *);
+
+      SVN_ERR_ASSERT(svn_relpath_is_canonical(file->relpath));
+      SVN_ERR_ASSERT(file->checksum != NULL
+                        && file->checksum->kind == SVN_EDITOR_CHECKSUM_KIND);
+      SVN_ERR_ASSERT(file->contents != NULL);
+      SVN_ERR_ASSERT(file->props != NULL);
+      SHOULD_NOT_BE_FINISHED(editor);
+      SHOULD_ALLOW_ADD(editor, file->relpath);
+      VERIFY_PARENT_MAY_EXIST(editor, file->relpath);
+      CHECK_UNKNOWN_CHILD(editor, file->relpath);
+    }
+
+  SVN_ERR(check_cancel(editor));
+
+  START_CALLBACK(editor);
+  err = editor->funcs.cb_add_files(editor->baton, files,
+                                   editor->scratch_pool);
+  END_CALLBACK(editor);
+
+  for (i = 0; i < files->nelts; i++)
+    {
+      const svn_editor_file_t *file
+        = APR_ARRAY_IDX(files, i, const svn_editor_file_t *);
+
+      MARK_COMPLETED(editor, file->relpath);
+      MARK_PARENT_STABLE(editor, file->relpath);
+      CLEAR_INCOMPLETE(editor, file->relpath);
+    }
+
+  svn_pool_clear(editor->scratch_pool);
+  return svn_error_trace(err);
+}
+
+
 svn_error_t *
 svn_editor_add_symlink(svn_editor_t *editor,
                        const char *relpath,
@@ -205,7 +205,8 @@ struct svn_delta_path_driver_state_t
   svn_delta_path_driver_cb_func2_t callback_func;
   void *callback_baton;
   apr_array_header_t *db_stack;
-  const char *last_path;
+  svn_stringbuf_t *last_path;  /* reused from step to step; NULL before
+                                  the first step */
   apr_pool_t *pool;  /* at least the lifetime of the entire drive */
 };
 
@@ -260,7 +261,7 @@ svn_delta_path_driver_step(svn_delta_path_driver_state_t *state,
        current one.  For the first iteration, this is just the
        empty string. ***/
   if (state->last_path)
-    common = svn_relpath_get_longest_ancestor(state->last_path, relpath,
+    common = svn_relpath_get_longest_ancestor(state->last_path->data, relpath,
                                               scratch_pool);
   common_len = strlen(common);
 
@@ -269,9 +270,10 @@ svn_delta_path_driver_step(svn_delta_path_driver_state_t *state,
        Sometimes there is nothing to do here (like, for the first
        iteration, or when the last path was an ancestor of the
        current one). ***/
-  if ((state->last_path) && (strlen(state->last_path) > common_len))
+  if ((state->last_path) && (state->last_path->len > common_len))
     {
-      const char *rel = state->last_path + (common_len ? (common_len + 1) : 0);
+      const char *rel = state->last_path->data
+                        + (common_len ? (common_len + 1) : 0);
       int count = count_components(rel);
       while (count--)
         {
@@ -338,8 +340,14 @@ svn_delta_path_driver_step(svn_delta_path_driver_state_t *state,
   /*** Step E - Save our state for the next iteration.  If our
        caller opened or added PATH as a directory, that becomes
        our LAST_PATH.  Otherwise, we use PATH's parent
-       directory. ***/
-  state->last_path = apr_pstrdup(state->pool, db ? relpath : pdir);
+       directory.
+
+       Reuse the buffer from the last step so that a drive over very many
+       paths does not accumulate one copy of each path in POOL. ***/
+  if (state->last_path)
+    svn_stringbuf_set(state->last_path, db ? relpath : pdir);
+  else
+    state->last_path = svn_stringbuf_create(db ? relpath : pdir, state->pool);
 
   return SVN_NO_ERROR;
 }
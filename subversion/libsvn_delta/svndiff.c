@@ -24,6 +24,12 @@
 
 #include <assert.h>
 #include <string.h>
+#include <apr.h>
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
+#endif
 #include "svn_delta.h"
 #include "svn_io.h"
 #include "delta.h"
@@ -39,13 +45,16 @@
 static const char SVNDIFF_V0[] = { 'S', 'V', 'N', 0 };
 static const char SVNDIFF_V1[] = { 'S', 'V', 'N', 1 };
 static const char SVNDIFF_V2[] = { 'S', 'V', 'N', 2 };
+static const char SVNDIFF_V3[] = { 'S', 'V', 'N', 3 };
 
 #define SVNDIFF_HEADER_SIZE (sizeof(SVNDIFF_V0))
 
 static const char *
 get_svndiff_header(int version)
 {
-  if (version == 2)
+  if (version == 3)
+    return SVNDIFF_V3;
+  else if (version == 2)
     return SVNDIFF_V2;
   else if (version == 1)
     return SVNDIFF_V1;
@@ -70,9 +79,10 @@ struct encoder_baton {
 /* This is at least as big as the largest size for a single instruction. */
 #define MAX_INSTRUCTION_LEN (2*SVN__MAX_ENCODED_UINT_LEN+1)
 /* This is at least as big as the largest possible instructions
-   section: in theory, the instructions could be SVN_DELTA_WINDOW_SIZE
+   section: in theory, the instructions could be SVN_DELTA_WINDOW_SIZE_MAX
    1-byte copy-from-source instructions (though this is very unlikely). */
-#define MAX_INSTRUCTION_SECTION_LEN (SVN_DELTA_WINDOW_SIZE*MAX_INSTRUCTION_LEN)
+#define MAX_INSTRUCTION_SECTION_LEN \
+  ((apr_size_t)SVN_DELTA_WINDOW_SIZE_MAX*MAX_INSTRUCTION_LEN)
 
 
 /* Append an encoded integer to a string.  */
@@ -198,7 +208,15 @@ encode_window(svn_stringbuf_t **instructions_p,
   append_encoded_int(header, window->sview_offset);
   append_encoded_int(header, window->sview_len);
   append_encoded_int(header, window->tview_len);
-  if (version == 2)
+  if (version == 3)
+    {
+      svn_stringbuf_t *compressed_instructions;
+      compressed_instructions = svn_stringbuf_create_empty(pool);
+      SVN_ERR(svn__compress_zstd(instructions->data, instructions->len,
+                                 compressed_instructions, compression_level));
+      instructions = compressed_instructions;
+    }
+  else if (version == 2)
     {
       svn_stringbuf_t *compressed_instructions;
       compressed_instructions = svn_stringbuf_create_empty(pool);
@@ -217,7 +235,16 @@ encode_window(svn_stringbuf_t **instructions_p,
   append_encoded_int(header, instructions->len);
 
   /* Encode the data. */
-  if (version == 2)
+  if (version == 3)
+    {
+      svn_stringbuf_t *compressed = svn_stringbuf_create_empty(pool);
+
+      SVN_ERR(svn__compress_zstd(window->new_data->data,
+                                 window->new_data->len,
+                                 compressed, compression_level));
+      newdata = svn_stringbuf__morph_into_string(compressed);
+    }
+  else if (version == 2)
     {
       svn_stringbuf_t *compressed = svn_stringbuf_create_empty(pool);
 
@@ -344,6 +371,396 @@ svn_txdelta_to_svndiff(svn_stream_t *output,
                           SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, pool);
 }
 
+#if APR_HAS_THREADS
+
+/* ----- Pipelined text delta to svndiff -----
+ *
+ * A window handler that moves the expensive part of svndiff encoding -
+ * in particular the compression of the instruction and data sections -
+ * onto a private worker thread.  The producer's handler call merely
+ * queues a copy of the window in a small ring and returns; finished
+ * windows are written to the output stream from the producer's thread,
+ * in window order, whenever the producer comes back with the next
+ * window (and, finally, when it sends the end-of-delta NULL window).
+ *
+ * Keeping all OUTPUT access on the producer's thread matters:  the
+ * stream typically writes protocol chunks onto a shared connection,
+ * which other code on that thread may also be writing to.
+ */
+
+/* Number of windows that may sit between the producer and the encoding
+   worker.  Windows are large (up to SVN_DELTA_WINDOW_SIZE plus the
+   encoded copy), so keep this small. */
+#define SVNDIFF_PIPELINE_DEPTH 4
+
+/* What a pipeline slot currently holds. */
+enum pipelined_slot_state
+{
+  slot_empty = 0,
+  slot_filled,    /* an input window, waiting to be encoded */
+  slot_encoded    /* encoded sections, waiting to be written out */
+};
+
+/* One entry of the window ring. */
+struct pipelined_slot
+{
+  /* Sub-pool holding WINDOW and the encoded sections; cleared after the
+     slot content has been written out. */
+  apr_pool_t *pool;
+
+  enum pipelined_slot_state state;
+
+  /* The window to encode (a deep copy owned by POOL). */
+  svn_txdelta_window_t *window;
+
+  /* The encoder output for WINDOW, as produced by encode_window(). */
+  svn_stringbuf_t *header;
+  svn_stringbuf_t *instructions;
+  const svn_string_t *newdata;
+};
+
+/* The extended encoder baton for pipelined svndiff streams. */
+struct pipelined_baton
+{
+  svn_stream_t *output;
+  svn_boolean_t header_done;
+  int version;
+  int compression_level;
+
+  /* Root pool, with a thread-safe allocator, owning everything the
+     worker touches. */
+  apr_pool_t *thread_pool;
+
+  /* Synchronizes SLOTS, ABORTED, EOF and ERR between the two threads. */
+  apr_thread_mutex_t *mutex;
+  apr_thread_cond_t *cond;
+
+  apr_thread_t *thread;
+  svn_boolean_t joined;
+
+  /* Tells the worker to quit without draining the remaining windows. */
+  svn_boolean_t aborted;
+
+  /* No further windows will be queued. */
+  svn_boolean_t eof;
+
+  /* First error raised by the worker. */
+  svn_error_t *err;
+
+  /* The window ring.  PUT is the next slot the producer fills, TAKE the
+     next slot to write out.  Both only ever advance to a slot whose
+     STATE allows it, so the empty ring and the full ring cannot be
+     confused. */
+  struct pipelined_slot slots[SVNDIFF_PIPELINE_DEPTH];
+  int put;
+  int take;
+};
+
+/* Thread function:  Encode queued windows of the pipelined_baton given
+   in DATA, in ring order, until the end of the delta or an abort. */
+static void * APR_THREAD_FUNC
+pipelined_encode_worker(apr_thread_t *thread, void *data)
+{
+  struct pipelined_baton *pb = data;
+  int idx = 0;
+  svn_boolean_t more = TRUE;
+
+  while (more)
+    {
+      struct pipelined_slot *slot = &pb->slots[idx];
+      svn_error_t *err;
+
+      apr_thread_mutex_lock(pb->mutex);
+      while (slot->state != slot_filled && !pb->aborted && !pb->eof)
+        apr_thread_cond_wait(pb->cond, pb->mutex);
+      more = (slot->state == slot_filled) && !pb->aborted;
+      apr_thread_mutex_unlock(pb->mutex);
+
+      if (!more)
+        break;
+
+      /* The slot is ours until we flip its state; encode unlocked. */
+      err = encode_window(&slot->instructions, &slot->header,
+                          &slot->newdata, slot->window,
+                          pb->version, pb->compression_level, slot->pool);
+
+      apr_thread_mutex_lock(pb->mutex);
+      if (err)
+        {
+          pb->err = svn_error_compose_create(pb->err, err);
+          pb->aborted = TRUE;
+          more = FALSE;
+        }
+      else
+        slot->state = slot_encoded;
+      apr_thread_cond_broadcast(pb->cond);
+      apr_thread_mutex_unlock(pb->mutex);
+
+      idx = (idx + 1) % SVNDIFF_PIPELINE_DEPTH;
+    }
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Write the encoded sections of SLOT to PB's output stream, preceded by
+   the svndiff stream header if that has not been sent yet.  Called on
+   the producer's thread only. */
+static svn_error_t *
+pipelined_write_slot(struct pipelined_baton *pb,
+                     struct pipelined_slot *slot)
+{
+  apr_size_t len;
+
+  if (!pb->header_done)
+    {
+      len = SVNDIFF_HEADER_SIZE;
+      SVN_ERR(svn_stream_write(pb->output, get_svndiff_header(pb->version),
+                               &len));
+      pb->header_done = TRUE;
+    }
+
+  len = slot->header->len;
+  SVN_ERR(svn_stream_write(pb->output, slot->header->data, &len));
+  if (slot->instructions->len > 0)
+    {
+      len = slot->instructions->len;
+      SVN_ERR(svn_stream_write(pb->output, slot->instructions->data, &len));
+    }
+  if (slot->newdata->len > 0)
+    {
+      len = slot->newdata->len;
+      SVN_ERR(svn_stream_write(pb->output, slot->newdata->data, &len));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Stop and join PB's worker thread, if that did not happen yet. */
+static void
+pipelined_join(struct pipelined_baton *pb)
+{
+  apr_status_t ignored;
+
+  if (pb->joined)
+    return;
+
+  apr_thread_mutex_lock(pb->mutex);
+  pb->eof = TRUE;
+  apr_thread_cond_broadcast(pb->cond);
+  apr_thread_mutex_unlock(pb->mutex);
+
+  apr_thread_join(&ignored, pb->thread);
+  pb->joined = TRUE;
+}
+
+/* Pool cleanup handler:  make sure the worker is gone and the shared
+   memory released even if the delta got abandoned in mid-flight. */
+static apr_status_t
+pipelined_encoder_cleanup(void *data)
+{
+  struct pipelined_baton *pb = data;
+
+  if (pb->thread_pool == NULL)
+    return APR_SUCCESS;       /* the NULL window already cleaned up */
+
+  apr_thread_mutex_lock(pb->mutex);
+  pb->aborted = TRUE;
+  apr_thread_cond_broadcast(pb->cond);
+  apr_thread_mutex_unlock(pb->mutex);
+
+  pipelined_join(pb);
+  svn_error_clear(pb->err);
+  pb->err = NULL;
+  svn_pool_destroy(pb->thread_pool);
+  pb->thread_pool = NULL;
+
+  return APR_SUCCESS;
+}
+
+/* Implements svn_txdelta_window_handler_t for pipelined svndiff
+   streams. */
+static svn_error_t *
+pipelined_window_handler(svn_txdelta_window_t *window, void *baton)
+{
+  struct pipelined_baton *pb = baton;
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_size_t len;
+
+  apr_thread_mutex_lock(pb->mutex);
+
+  if (window != NULL)
+    {
+      /* Wait for a free slot.  While waiting, write out any window the
+         worker has finished - TAKE order is window order. */
+      while (pb->slots[pb->put].state != slot_empty && !pb->aborted)
+        {
+          struct pipelined_slot *slot = &pb->slots[pb->take];
+
+          if (slot->state == slot_encoded)
+            {
+              /* Until the state flips back to empty, the slot is ours;
+                 write without blocking the worker. */
+              apr_thread_mutex_unlock(pb->mutex);
+              err = pipelined_write_slot(pb, slot);
+              apr_thread_mutex_lock(pb->mutex);
+              if (err)
+                {
+                  pb->aborted = TRUE;
+                  break;
+                }
+
+              svn_pool_clear(slot->pool);
+              slot->state = slot_empty;
+              pb->take = (pb->take + 1) % SVNDIFF_PIPELINE_DEPTH;
+              apr_thread_cond_broadcast(pb->cond);
+            }
+          else
+            apr_thread_cond_wait(pb->cond, pb->mutex);
+        }
+
+      if (!err && !pb->aborted)
+        {
+          struct pipelined_slot *slot = &pb->slots[pb->put];
+
+          slot->window = svn_txdelta_window_dup(window, slot->pool);
+          slot->state = slot_filled;
+          pb->put = (pb->put + 1) % SVNDIFF_PIPELINE_DEPTH;
+          apr_thread_cond_broadcast(pb->cond);
+        }
+      else if (!err)
+        {
+          /* The worker failed; report its error here. */
+          err = pb->err;
+          pb->err = SVN_NO_ERROR;
+        }
+      apr_thread_mutex_unlock(pb->mutex);
+
+      return svn_error_trace(err);
+    }
+
+  /* End of the delta:  drain the ring, ... */
+  pb->eof = TRUE;
+  apr_thread_cond_broadcast(pb->cond);
+  while (!pb->aborted && pb->slots[pb->take].state != slot_empty)
+    {
+      struct pipelined_slot *slot = &pb->slots[pb->take];
+
+      if (slot->state == slot_encoded)
+        {
+          apr_thread_mutex_unlock(pb->mutex);
+          err = pipelined_write_slot(pb, slot);
+          apr_thread_mutex_lock(pb->mutex);
+          if (err)
+            {
+              pb->aborted = TRUE;
+              break;
+            }
+
+          svn_pool_clear(slot->pool);
+          slot->state = slot_empty;
+          pb->take = (pb->take + 1) % SVNDIFF_PIPELINE_DEPTH;
+          apr_thread_cond_broadcast(pb->cond);
+        }
+      else
+        apr_thread_cond_wait(pb->cond, pb->mutex);
+    }
+  apr_thread_mutex_unlock(pb->mutex);
+
+  /* ... stop the worker and pick up anything it choked on, ... */
+  pipelined_join(pb);
+  err = svn_error_compose_create(err, pb->err);
+  pb->err = SVN_NO_ERROR;
+  if (err)
+    return svn_error_trace(err);
+
+  /* ... then finish the stream just like window_handler() would.  Even
+     an empty delta consists of the svndiff header. */
+  if (!pb->header_done)
+    {
+      len = SVNDIFF_HEADER_SIZE;
+      SVN_ERR(svn_stream_write(pb->output, get_svndiff_header(pb->version),
+                               &len));
+      pb->header_done = TRUE;
+    }
+  SVN_ERR(svn_stream_close(pb->output));
+
+  svn_pool_destroy(pb->thread_pool);
+  pb->thread_pool = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
+void
+svn_txdelta__to_svndiff_pipelined(svn_txdelta_window_handler_t *handler,
+                                  void **handler_baton,
+                                  svn_stream_t *output,
+                                  int svndiff_version,
+                                  int compression_level,
+                                  apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  struct pipelined_baton *pb;
+  apr_threadattr_t *tattr;
+  apr_status_t status;
+  svn_boolean_t started;
+  int i;
+
+  /* Uncompressed svndiff0 encoding is too cheap to be worth a thread
+     handoff. */
+  if (svndiff_version == 0)
+    {
+      svn_txdelta_to_svndiff3(handler, handler_baton, output,
+                              svndiff_version, compression_level, pool);
+      return;
+    }
+
+  pb = apr_pcalloc(pool, sizeof(*pb));
+
+  /* All state shared with the worker must come from a thread-safe
+     allocator. */
+  pb->thread_pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  pb->output = output;
+  pb->version = svndiff_version;
+  pb->compression_level = compression_level;
+
+  for (i = 0; i < SVNDIFF_PIPELINE_DEPTH; i++)
+    pb->slots[i].pool = svn_pool_create(pb->thread_pool);
+
+  status = apr_thread_mutex_create(&pb->mutex, APR_THREAD_MUTEX_DEFAULT,
+                                   pb->thread_pool);
+  if (!status)
+    status = apr_thread_cond_create(&pb->cond, pb->thread_pool);
+  if (!status)
+    status = apr_threadattr_create(&tattr, pb->thread_pool);
+  if (!status)
+    status = apr_thread_create(&pb->thread, tattr, pipelined_encode_worker,
+                               pb, pb->thread_pool);
+  started = (status == APR_SUCCESS);
+
+  /* If we can't get a worker, degrade to the synchronous encoder.
+     Pipelining is an optimization only. */
+  if (!started)
+    {
+      svn_pool_destroy(pb->thread_pool);
+      svn_txdelta_to_svndiff3(handler, handler_baton, output,
+                              svndiff_version, compression_level, pool);
+      return;
+    }
+
+  apr_pool_cleanup_register(pool, pb, pipelined_encoder_cleanup,
+                            apr_pool_cleanup_null);
+
+  *handler = pipelined_window_handler;
+  *handler_baton = pb;
+#else
+  svn_txdelta_to_svndiff3(handler, handler_baton, output, svndiff_version,
+                          compression_level, pool);
+#endif
+}
+
 
 /* ----- svndiff to text delta ----- */
 
@@ -565,13 +982,29 @@ decode_window(svn_txdelta_window_t *window, svn_filesize_t sview_offset,
 
   insend = data + inslen;
 
-  if (version == 2)
+  if (version == 3)
+    {
+      svn_stringbuf_t *instout = svn_stringbuf_create_empty(pool);
+      svn_stringbuf_t *ndout = svn_stringbuf_create_empty(pool);
+
+      SVN_ERR(svn__decompress_zstd(insend, newlen, ndout,
+                                   SVN_DELTA_WINDOW_SIZE_MAX));
+      SVN_ERR(svn__decompress_zstd(data, insend - data, instout,
+                                   MAX_INSTRUCTION_SECTION_LEN));
+
+      newlen = ndout->len;
+      data = (unsigned char *)instout->data;
+      insend = (unsigned char *)instout->data + instout->len;
+
+      new_data = svn_stringbuf__morph_into_string(ndout);
+    }
+  else if (version == 2)
     {
       svn_stringbuf_t *instout = svn_stringbuf_create_empty(pool);
       svn_stringbuf_t *ndout = svn_stringbuf_create_empty(pool);
 
       SVN_ERR(svn__decompress_lz4(insend, newlen, ndout,
-                                  SVN_DELTA_WINDOW_SIZE));
+                                  SVN_DELTA_WINDOW_SIZE_MAX));
       SVN_ERR(svn__decompress_lz4(data, insend - data, instout,
                                   MAX_INSTRUCTION_SECTION_LEN));
 
@@ -587,7 +1020,7 @@ decode_window(svn_txdelta_window_t *window, svn_filesize_t sview_offset,
       svn_stringbuf_t *ndout = svn_stringbuf_create_empty(pool);
 
       SVN_ERR(svn__decompress_zlib(insend, newlen, ndout,
-                                   SVN_DELTA_WINDOW_SIZE));
+                                   SVN_DELTA_WINDOW_SIZE_MAX));
       SVN_ERR(svn__decompress_zlib(data, insend - data, instout,
                                    MAX_INSTRUCTION_SECTION_LEN));
 
@@ -653,6 +1086,8 @@ write_handler(void *baton,
         db->version = 1;
       else if (memcmp(buffer, SVNDIFF_V2 + db->header_bytes, nheader) == 0)
         db->version = 2;
+      else if (memcmp(buffer, SVNDIFF_V3 + db->header_bytes, nheader) == 0)
+        db->version = 3;
       else
         return svn_error_create(SVN_ERR_SVNDIFF_INVALID_HEADER, NULL,
                                 _("Svndiff has invalid header"));
@@ -710,10 +1145,10 @@ write_handler(void *baton,
           if (p == NULL)
               break;
 
-          if (tview_len > SVN_DELTA_WINDOW_SIZE ||
-              sview_len > SVN_DELTA_WINDOW_SIZE ||
+          if (tview_len > SVN_DELTA_WINDOW_SIZE_MAX ||
+              sview_len > SVN_DELTA_WINDOW_SIZE_MAX ||
               /* for svndiff1, newlen includes the original length */
-              newlen > SVN_DELTA_WINDOW_SIZE + SVN__MAX_ENCODED_UINT_LEN ||
+              newlen > SVN_DELTA_WINDOW_SIZE_MAX + SVN__MAX_ENCODED_UINT_LEN ||
               inslen > MAX_INSTRUCTION_SECTION_LEN)
             return svn_error_create(
                      SVN_ERR_SVNDIFF_CORRUPT_WINDOW, NULL,
@@ -921,10 +1356,10 @@ read_window_header(svn_stream_t *stream, svn_filesize_t *sview_offset,
   SVN_ERR(read_one_size(inslen, header_len, stream));
   SVN_ERR(read_one_size(newlen, header_len, stream));
 
-  if (*tview_len > SVN_DELTA_WINDOW_SIZE ||
-      *sview_len > SVN_DELTA_WINDOW_SIZE ||
+  if (*tview_len > SVN_DELTA_WINDOW_SIZE_MAX ||
+      *sview_len > SVN_DELTA_WINDOW_SIZE_MAX ||
       /* for svndiff1, newlen includes the original length */
-      *newlen > SVN_DELTA_WINDOW_SIZE + SVN__MAX_ENCODED_UINT_LEN ||
+      *newlen > SVN_DELTA_WINDOW_SIZE_MAX + SVN__MAX_ENCODED_UINT_LEN ||
       *inslen > MAX_INSTRUCTION_SECTION_LEN)
     return svn_error_create(SVN_ERR_SVNDIFF_CORRUPT_WINDOW, NULL,
                             _("Svndiff contains a too-large window"));
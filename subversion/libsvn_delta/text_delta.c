@@ -27,12 +27,20 @@
 
 #include <apr_general.h>        /* for APR_INLINE */
 #include <apr_md5.h>            /* for, um...MD5 stuff */
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
+#endif
 
 #include "svn_delta.h"
 #include "svn_io.h"
 #include "svn_pools.h"
 #include "svn_checksum.h"
 
+#include "private/svn_delta_private.h"
+#include "private/svn_subr_private.h"
+
 #include "delta.h"
 
 
@@ -56,6 +64,8 @@ struct txdelta_baton {
   svn_boolean_t more;           /* TRUE if there are more data in the pool. */
   svn_filesize_t pos;           /* Offset of next read in source file. */
   char *buf;                    /* Buffer for input data. */
+  apr_size_t window_size;       /* Bytes of source and target data per
+                                   window, usually SVN_DELTA_WINDOW_SIZE. */
 
   svn_checksum_ctx_t *context;  /* If not NULL, the context for computing
                                    the checksum. */
@@ -359,14 +369,14 @@ txdelta_next_window(svn_txdelta_window_t **window,
                     apr_pool_t *pool)
 {
   struct txdelta_baton *b = baton;
-  apr_size_t source_len = SVN_DELTA_WINDOW_SIZE;
-  apr_size_t target_len = SVN_DELTA_WINDOW_SIZE;
+  apr_size_t source_len = b->window_size;
+  apr_size_t target_len = b->window_size;
 
   /* Read the source stream. */
   if (b->more_source)
     {
       SVN_ERR(svn_stream_read_full(b->source, b->buf, &source_len));
-      b->more_source = (source_len == SVN_DELTA_WINDOW_SIZE);
+      b->more_source = (source_len == b->window_size);
     }
   else
     source_len = 0;
@@ -435,12 +445,18 @@ svn_txdelta_run(svn_stream_t *source,
   tb.more_source = TRUE;
   tb.more = TRUE;
   tb.pos = 0;
-  tb.buf = apr_palloc(scratch_pool, 2 * SVN_DELTA_WINDOW_SIZE);
+  tb.window_size = SVN_DELTA_WINDOW_SIZE;
+  tb.buf = apr_palloc(scratch_pool, 2 * tb.window_size);
   tb.result_pool = result_pool;
 
   if (checksum != NULL)
     tb.context = svn_checksum_ctx_create(checksum_kind, scratch_pool);
 
+  /* This loop polls once per delta window; throttle the calls that
+     actually reach the (potentially expensive) callback. */
+  svn_cancel__create_throttled(&cancel_func, &cancel_baton,
+                               cancel_func, cancel_baton, scratch_pool);
+
   do
     {
       /* free the window (if any) */
@@ -467,19 +483,27 @@ svn_txdelta_run(svn_stream_t *source,
 
 
 void
-svn_txdelta2(svn_txdelta_stream_t **stream,
-             svn_stream_t *source,
-             svn_stream_t *target,
-             svn_boolean_t calculate_checksum,
-             apr_pool_t *pool)
+svn_txdelta__sized(svn_txdelta_stream_t **stream,
+                   svn_stream_t *source,
+                   svn_stream_t *target,
+                   svn_boolean_t calculate_checksum,
+                   apr_size_t window_size,
+                   apr_pool_t *pool)
 {
   struct txdelta_baton *b = apr_pcalloc(pool, sizeof(*b));
 
+  /* Keep the window size within what svndiff decoders accept. */
+  if (window_size < SVN_DELTA_WINDOW_SIZE)
+    window_size = SVN_DELTA_WINDOW_SIZE;
+  else if (window_size > SVN_DELTA_WINDOW_SIZE_MAX)
+    window_size = SVN_DELTA_WINDOW_SIZE_MAX;
+
   b->source = source;
   b->target = target;
   b->more_source = TRUE;
   b->more = TRUE;
-  b->buf = apr_palloc(pool, 2 * SVN_DELTA_WINDOW_SIZE);
+  b->window_size = window_size;
+  b->buf = apr_palloc(pool, 2 * b->window_size);
   b->context = calculate_checksum
              ? svn_checksum_ctx_create(svn_checksum_md5, pool)
              : NULL;
@@ -489,6 +513,17 @@ svn_txdelta2(svn_txdelta_stream_t **stream,
                                       txdelta_md5_digest, pool);
 }
 
+void
+svn_txdelta2(svn_txdelta_stream_t **stream,
+             svn_stream_t *source,
+             svn_stream_t *target,
+             svn_boolean_t calculate_checksum,
+             apr_pool_t *pool)
+{
+  svn_txdelta__sized(stream, source, target, calculate_checksum,
+                     SVN_DELTA_WINDOW_SIZE, pool);
+}
+
 void
 svn_txdelta(svn_txdelta_stream_t **stream,
             svn_stream_t *source,
@@ -499,6 +534,322 @@ svn_txdelta(svn_txdelta_stream_t **stream,
 }
 
 
+/* Pipelined delta streams.
+ *
+ * A background thread drives an ordinary txdelta stream and keeps up to
+ * PIPELINE_DEPTH windows computed ahead of the consumer, so that window
+ * computation overlaps with whatever the consumer does with the windows
+ * (typically network or disk I/O).  Only the background thread ever
+ * touches the wrapped stream and its SOURCE / TARGET; the two threads
+ * communicate exclusively through the slot ring below and only ever
+ * allocate from pools owned by their respective side.
+ */
+
+#if APR_HAS_THREADS
+
+/* Maximum number of windows that the background thread may run ahead
+   of the consumer.  2 already gives full overlap: one window being
+   consumed while the next one is being computed. */
+#define PIPELINE_DEPTH 2
+
+/* A single entry of the producer / consumer ring.  POOL is owned and
+   cleared by the background thread only; the consumer merely reads the
+   window before releasing the slot. */
+typedef struct pipeline_slot_t
+{
+  /* Window computed by the background thread, allocated in POOL.
+     NULL marks the end of the delta stream. */
+  svn_txdelta_window_t *window;
+
+  /* Sub-pool of the worker's root pool holding WINDOW. */
+  apr_pool_t *pool;
+} pipeline_slot_t;
+
+/* Stream baton for a pipelined delta stream. */
+struct pipeline_baton {
+  /* The wrapped single-threaded delta stream.  Only the background
+     thread may use this once that thread has been started. */
+  svn_txdelta_stream_t *wrapped;
+
+  /* Thread-safe root pool owning WRAPPED, the slot pools and all
+     synchronization objects.  Destroyed by pipeline_cleanup. */
+  apr_pool_t *thread_pool;
+
+  /* The background thread; valid iff STARTED. */
+  apr_thread_t *thread;
+
+  /* Protects all ring state below; COND signals changes to it. */
+  apr_thread_mutex_t *mutex;
+  apr_thread_cond_t *cond;
+
+  /* Ring of pre-computed windows. */
+  pipeline_slot_t slots[PIPELINE_DEPTH];
+  int put;                  /* Slot that the worker fills next. */
+  int take;                 /* Slot that the consumer reads next. */
+  int count;                /* Number of filled slots. */
+
+  /* The worker stopped producing windows (end of stream or error). */
+  svn_boolean_t eof;
+
+  /* The consumer abandoned the stream; worker shall terminate ASAP. */
+  svn_boolean_t aborted;
+
+  /* Error encountered by the worker, to be handed to the consumer with
+     the respective slot.  Cleared by pipeline_cleanup if never taken. */
+  svn_error_t *err;
+
+  /* TRUE iff the background thread has been started / joined.
+     If STARTED is FALSE, the stream degrades to a plain synchronous
+     wrapper around WRAPPED. */
+  svn_boolean_t started;
+  svn_boolean_t joined;
+
+  /* MD5 digest of the reconstructed target, copied from WRAPPED by the
+     worker upon successful completion.  Valid iff HAS_DIGEST - which
+     the consumer may only evaluate after joining the worker. */
+  unsigned char digest[APR_MD5_DIGESTSIZE];
+  svn_boolean_t has_digest;
+};
+
+/* Thread function driving the wrapped stream of the pipeline_baton
+   given as DATA until end-of-stream, error or abortion. */
+static void * APR_THREAD_FUNC
+pipeline_worker(apr_thread_t *thread, void *data)
+{
+  struct pipeline_baton *pb = data;
+  svn_boolean_t more = TRUE;
+
+  while (more)
+    {
+      svn_txdelta_window_t *window;
+      svn_error_t *err;
+      int idx;
+
+      /* Wait for a free slot - or for the consumer to give up. */
+      apr_thread_mutex_lock(pb->mutex);
+      while (pb->count == PIPELINE_DEPTH && !pb->aborted)
+        apr_thread_cond_wait(pb->cond, pb->mutex);
+      if (pb->aborted)
+        {
+          apr_thread_mutex_unlock(pb->mutex);
+          return NULL;
+        }
+      idx = pb->put;
+      apr_thread_mutex_unlock(pb->mutex);
+
+      /* The consumer released this slot, i.e. no longer references the
+         previous window in it.  Compute the next one. */
+      svn_pool_clear(pb->slots[idx].pool);
+      err = svn_txdelta_next_window(&window, pb->wrapped,
+                                    pb->slots[idx].pool);
+      if (err)
+        window = NULL;
+
+      if (!err && window == NULL)
+        {
+          /* Complete coverage; preserve the digest before the consumer
+             may tear us down. */
+          const unsigned char *digest = svn_txdelta_md5_digest(pb->wrapped);
+          if (digest)
+            {
+              memcpy(pb->digest, digest, sizeof(pb->digest));
+              pb->has_digest = TRUE;
+            }
+        }
+
+      /* Publish the window (or the error / end marker). */
+      apr_thread_mutex_lock(pb->mutex);
+      pb->slots[idx].window = window;
+      pb->put = (idx + 1) % PIPELINE_DEPTH;
+      pb->count++;
+      if (err || window == NULL)
+        {
+          pb->err = err;
+          pb->eof = TRUE;
+          more = FALSE;
+        }
+      apr_thread_cond_signal(pb->cond);
+      apr_thread_mutex_unlock(pb->mutex);
+    }
+
+  return NULL;
+}
+
+/* Terminate and join PB's background thread, if it is still running. */
+static void
+pipeline_join(struct pipeline_baton *pb)
+{
+  apr_status_t ignored;
+
+  if (!pb->started || pb->joined)
+    return;
+
+  apr_thread_mutex_lock(pb->mutex);
+  pb->aborted = TRUE;
+  apr_thread_cond_signal(pb->cond);
+  apr_thread_mutex_unlock(pb->mutex);
+
+  apr_thread_join(&ignored, pb->thread);
+  pb->joined = TRUE;
+}
+
+/* Pool cleanup handler: make sure the worker is gone before its pools
+   get destroyed, even if the stream was abandoned in mid-flight. */
+static apr_status_t
+pipeline_cleanup(void *data)
+{
+  struct pipeline_baton *pb = data;
+
+  pipeline_join(pb);
+  svn_error_clear(pb->err);
+  pb->err = NULL;
+  svn_pool_destroy(pb->thread_pool);
+
+  return APR_SUCCESS;
+}
+
+/* Implements svn_txdelta_next_window_fn_t for pipelined streams. */
+static svn_error_t *
+pipelined_next_window(svn_txdelta_window_t **window,
+                      void *baton,
+                      apr_pool_t *pool)
+{
+  struct pipeline_baton *pb = baton;
+  svn_txdelta_window_t *result;
+  int idx;
+
+  /* Thread never got started?  Simply forward the request. */
+  if (!pb->started)
+    return svn_error_trace(svn_txdelta_next_window(window, pb->wrapped,
+                                                   pool));
+
+  /* Wait for the worker to deliver the next window. */
+  apr_thread_mutex_lock(pb->mutex);
+  while (pb->count == 0 && !pb->eof)
+    apr_thread_cond_wait(pb->cond, pb->mutex);
+
+  if (pb->count == 0)
+    {
+      /* Excess read after end-of-stream (or after a worker error whose
+         slot has already been consumed). */
+      svn_error_t *err = pb->err;
+      pb->err = NULL;
+      apr_thread_mutex_unlock(pb->mutex);
+
+      pipeline_join(pb);
+      *window = NULL;
+      return svn_error_trace(err);
+    }
+
+  idx = pb->take;
+  result = pb->slots[idx].window;
+  apr_thread_mutex_unlock(pb->mutex);
+
+  /* Copy the window into the caller's pool.  The slot may not be
+     released before that copy completed. */
+  *window = result ? svn_txdelta_window_dup(result, pool) : NULL;
+
+  apr_thread_mutex_lock(pb->mutex);
+  pb->take = (idx + 1) % PIPELINE_DEPTH;
+  pb->count--;
+  apr_thread_cond_signal(pb->cond);
+  apr_thread_mutex_unlock(pb->mutex);
+
+  if (*window == NULL)
+    {
+      /* End of stream or worker error; either way, the worker already
+         terminated and the join completes immediately. */
+      svn_error_t *err = pb->err;
+      pb->err = NULL;
+
+      pipeline_join(pb);
+      return svn_error_trace(err);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_md5_digest_fn_t for pipelined streams. */
+static const unsigned char *
+pipelined_md5_digest(void *baton)
+{
+  struct pipeline_baton *pb = baton;
+
+  if (!pb->started)
+    return svn_txdelta_md5_digest(pb->wrapped);
+
+  /* The join provides the necessary synchronization with the worker's
+     write to HAS_DIGEST / DIGEST. */
+  if (!pb->joined || !pb->has_digest)
+    return NULL;
+
+  return pb->digest;
+}
+
+#endif /* APR_HAS_THREADS */
+
+void
+svn_txdelta__pipelined(svn_txdelta_stream_t **stream,
+                       svn_stream_t *source,
+                       svn_stream_t *target,
+                       svn_boolean_t calculate_checksum,
+                       apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  struct pipeline_baton *pb = apr_pcalloc(pool, sizeof(*pb));
+  apr_threadattr_t *tattr;
+  apr_status_t status;
+  int i;
+
+  /* All state shared with the worker must come from a thread-safe
+     allocator. */
+  pb->thread_pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+
+  /* The wrapped stream, including its checksum result, lives entirely
+     in worker-owned memory. */
+  svn_txdelta2(&pb->wrapped, source, target, calculate_checksum,
+               pb->thread_pool);
+
+  for (i = 0; i < PIPELINE_DEPTH; i++)
+    pb->slots[i].pool = svn_pool_create(pb->thread_pool);
+
+  status = apr_thread_mutex_create(&pb->mutex, APR_THREAD_MUTEX_DEFAULT,
+                                   pb->thread_pool);
+  if (!status)
+    status = apr_thread_cond_create(&pb->cond, pb->thread_pool);
+  if (!status)
+    status = apr_threadattr_create(&tattr, pb->thread_pool);
+  if (!status)
+    status = apr_thread_create(&pb->thread, tattr, pipeline_worker, pb,
+                               pb->thread_pool);
+
+  /* If we can't get a worker, degrade to synchronous pass-through
+     (STARTED remains FALSE).  Pipelining is an optimization only. */
+  pb->started = (status == APR_SUCCESS);
+
+  apr_pool_cleanup_register(pool, pb, pipeline_cleanup,
+                            apr_pool_cleanup_null);
+
+  *stream = svn_txdelta_stream_create(pb, pipelined_next_window,
+                                      pipelined_md5_digest, pool);
+#else
+  svn_txdelta2(stream, source, target, calculate_checksum, pool);
+#endif
+}
+
+void
+svn_txdelta__pipelined_close(svn_txdelta_stream_t *stream)
+{
+#if APR_HAS_THREADS
+  struct pipeline_baton *pb = stream->baton;
+
+  pipeline_join(pb);
+  svn_error_clear(pb->err);
+  pb->err = NULL;
+#endif
+}
+
+
 
 /* Functions for implementing a "target push" delta. */
 
@@ -628,17 +979,29 @@ size_buffer(char **buf, apr_size_t *buf_size,
 static APR_INLINE char *
 patterning_copy(char *target, const char *source, apr_size_t len)
 {
+  apr_size_t overlap = target - source;
+
+  /* Degenerated but common case: a run of a single repeated byte.
+     memset is the fastest way to produce that. */
+  if (overlap == 1)
+    {
+      memset(target, *source, len);
+      return target + len;
+    }
+
   /* If the source and target overlap, repeat the overlapping pattern
-     in the target buffer. Always copy from the source buffer because
-     presumably it will be in the L1 cache after the first iteration
-     and doing this should avoid pipeline stalls due to write/read
-     dependencies. */
-  const apr_size_t overlap = target - source;
+     in the target buffer.  Each iteration makes another copy of the
+     pattern available in the target buffer, i.e. the distance between
+     SOURCE and TARGET - and with it the amount we may copy at once -
+     doubles with every iteration.  That turns the fixed-stride loop
+     this used to be into a logarithmic number of ever larger memcpy()s
+     for short patterns. */
   while (len > overlap)
     {
       memcpy(target, source, overlap);
       target += overlap;
       len -= overlap;
+      overlap = target - source;
     }
 
   /* Copy any remaining source pattern. */
@@ -666,19 +1029,38 @@ svn_txdelta_apply_instructions(svn_txdelta_window_t *window,
 
   for (op = window->ops; op < window->ops + window->num_ops; op++)
     {
-      const apr_size_t buf_len = (op->length < *tlen - tpos
-                                  ? op->length : *tlen - tpos);
+      apr_size_t length = op->length;
+      const apr_size_t offset = op->offset;
+      const enum svn_delta_action action = op->action_code;
+      apr_size_t buf_len;
+
+      /* Delta streams often contain runs of instructions that read
+       * adjacent ranges of the same area, e.g. when the op length got
+       * limited by MAX_INSTRUCTION_LEN or the xdelta match length.
+       * Fuse such runs into a single copy: the result is the same as
+       * executing them one by one (for target copies because each
+       * output byte still only depends on bytes written before it),
+       * but the per-instruction overhead is paid only once.  */
+      while (op + 1 < window->ops + window->num_ops
+             && op[1].action_code == action
+             && op[1].offset == offset + length)
+        {
+          ++op;
+          length += op->length;
+        }
+
+      buf_len = (length < *tlen - tpos ? length : *tlen - tpos);
 
       /* Check some invariants common to all instructions.  */
-      assert(tpos + op->length <= window->tview_len);
+      assert(tpos + length <= window->tview_len);
 
-      switch (op->action_code)
+      switch (action)
         {
         case svn_txdelta_source:
           /* Copy from source area.  */
           assert(sbuf);
-          assert(op->offset + op->length <= window->sview_len);
-          memcpy(tbuf + tpos, sbuf + op->offset, buf_len);
+          assert(offset + length <= window->sview_len);
+          memcpy(tbuf + tpos, sbuf + offset, buf_len);
           break;
 
         case svn_txdelta_target:
@@ -688,15 +1070,15 @@ svn_txdelta_apply_instructions(svn_txdelta_window_t *window,
            * Note that most copies won't have overlapping source and
            * target ranges (they are just a result of self-compressed
            * data) but a small percentage will.  */
-          assert(op->offset < tpos);
-          patterning_copy(tbuf + tpos, tbuf + op->offset, buf_len);
+          assert(offset < tpos);
+          patterning_copy(tbuf + tpos, tbuf + offset, buf_len);
           break;
 
         case svn_txdelta_new:
           /* Copy from window new area.  */
-          assert(op->offset + op->length <= window->new_data->len);
+          assert(offset + length <= window->new_data->len);
           memcpy(tbuf + tpos,
-                 window->new_data->data + op->offset,
+                 window->new_data->data + offset,
                  buf_len);
           break;
 
@@ -704,7 +1086,7 @@ svn_txdelta_apply_instructions(svn_txdelta_window_t *window,
           assert(!"Invalid delta instruction code");
         }
 
-      tpos += op->length;
+      tpos += length;
       if (tpos >= *tlen)
         return;                 /* The buffer is full. */
     }
@@ -295,13 +295,19 @@ find_match(const struct blocks *blocks,
                                     max_delta);
 
   /* See if we can extend backwards (max MATCH_BLOCKSIZE-1 steps because A's
-     content has been sampled only every MATCH_BLOCKSIZE positions).  */
-  while (apos > 0 && bpos > pending_insert_start && a[apos-1] == b[bpos-1])
-    {
-      --apos;
-      --bpos;
-      ++delta;
-    }
+     content has been sampled only every MATCH_BLOCKSIZE positions).  Use
+     the chunky comparison primitive instead of a byte-wise loop. */
+  {
+    apr_size_t max_reverse = apos < bpos - pending_insert_start
+                           ? apos
+                           : bpos - pending_insert_start;
+    apr_size_t reverse = svn_cstring__reverse_match_length(a + apos, b + bpos,
+                                                           max_reverse);
+
+    apos -= reverse;
+    bpos -= reverse;
+    delta += reverse;
+  }
 
   *aposp = apos;
   *bposp = bpos;
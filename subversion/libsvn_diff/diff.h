@@ -115,6 +115,45 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
               apr_pool_t *pool);
 
 
+/*
+ * Calculate a common subsequence between POSITION_LIST1 and POSITION_LIST2
+ * using the histogram algorithm: matches are anchored on the tokens with
+ * the fewest occurrences and the sources are split recursively around each
+ * anchor.  This is much faster than svn_diff__lcs() on sources with many
+ * repeated tokens, but the result is not guaranteed to be the longest
+ * common subsequence.
+ *
+ * The arguments and the returned structure are as for svn_diff__lcs();
+ * token count arrays are not needed.
+ */
+svn_diff__lcs_t *
+svn_diff__lcs_histogram(svn_diff__position_t *position_list1, /* tail (ring) */
+                        svn_diff__position_t *position_list2, /* tail (ring) */
+                        svn_diff__token_index_t num_tokens,
+                        apr_off_t prefix_lines,
+                        apr_off_t suffix_lines,
+                        apr_pool_t *pool);
+
+/*
+ * Variants of svn_diff_diff_2() and svn_diff_diff3_2() that allow the
+ * caller to select the histogram algorithm (see svn_diff__lcs_histogram)
+ * instead of the default LCS algorithm.  The public functions wrap these
+ * with USE_HISTOGRAM set to FALSE.
+ */
+svn_error_t *
+svn_diff__diff_2_internal(svn_diff_t **diff,
+                          void *diff_baton,
+                          const svn_diff_fns2_t *vtable,
+                          svn_boolean_t use_histogram,
+                          apr_pool_t *pool);
+
+svn_error_t *
+svn_diff__diff3_2_internal(svn_diff_t **diff,
+                           void *diff_baton,
+                           const svn_diff_fns2_t *vtable,
+                           svn_boolean_t use_histogram,
+                           apr_pool_t *pool);
+
 /*
  * Returns number of tokens in a tree
  */
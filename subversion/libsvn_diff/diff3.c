@@ -247,11 +247,165 @@ svn_diff__resolve_conflict(svn_diff_t *hunk,
 }
 
 
+/* Return TRUE if the token streams POSITION_LIST1 and POSITION_LIST2
+ * (rings as produced by svn_diff__get_tokens(), pointers to the tail)
+ * are identical.
+ */
+static svn_boolean_t
+position_rings_identical(const svn_diff__position_t *position_list1,
+                         const svn_diff__position_t *position_list2)
+{
+  const svn_diff__position_t *position1;
+  const svn_diff__position_t *position2;
+
+  if (position_list1 == NULL || position_list2 == NULL)
+    return position_list1 == position_list2;
+
+  position1 = position_list1->next;
+  position2 = position_list2->next;
+  while (TRUE)
+    {
+      if (position1->token_index != position2->token_index)
+        return FALSE;
+
+      if (position1 == position_list1 || position2 == position_list2)
+        return position1 == position_list1 && position2 == position_list2;
+
+      position1 = position1->next;
+      position2 = position2->next;
+    }
+}
+
+/* Prepend a new lcs chunk of LENGTH lines at the free-standing offsets
+ * POS0_OFFSET and POS1_OFFSET to LCS and return it.
+ */
+static svn_diff__lcs_t *
+prepend_lcs_chunk(svn_diff__lcs_t *lcs, apr_off_t length,
+                  apr_off_t pos0_offset, apr_off_t pos1_offset,
+                  apr_pool_t *pool)
+{
+  svn_diff__lcs_t *new_lcs = apr_palloc(pool, sizeof(*new_lcs));
+
+  new_lcs->position[0] = apr_pcalloc(pool, sizeof(*new_lcs->position[0]));
+  new_lcs->position[0]->offset = pos0_offset;
+  new_lcs->position[1] = apr_pcalloc(pool, sizeof(*new_lcs->position[1]));
+  new_lcs->position[1]->offset = pos1_offset;
+  new_lcs->length = length;
+  new_lcs->refcount = 1;
+  new_lcs->next = lcs;
+
+  return new_lcs;
+}
+
+/* Build the LCS chain svn_diff__lcs() would return for the identical
+ * token streams POSITION_LIST1 and POSITION_LIST2, without running the
+ * O(ND) algorithm:  a single chunk covering the whole stream, framed by
+ * the usual prefix, suffix and EOF links.
+ */
+static svn_diff__lcs_t *
+lcs_trivially_identical(svn_diff__position_t *position_list1,
+                        svn_diff__position_t *position_list2,
+                        apr_off_t prefix_lines,
+                        apr_off_t suffix_lines,
+                        apr_pool_t *pool)
+{
+  svn_diff__lcs_t *lcs;
+
+  /* The EOF link with its sentinel positions. */
+  lcs = apr_palloc(pool, sizeof(*lcs));
+  lcs->position[0] = apr_pcalloc(pool, sizeof(*lcs->position[0]));
+  lcs->position[0]->offset = position_list1
+                             ? position_list1->offset + suffix_lines + 1
+                             : prefix_lines + suffix_lines + 1;
+  lcs->position[1] = apr_pcalloc(pool, sizeof(*lcs->position[1]));
+  lcs->position[1]->offset = position_list2
+                             ? position_list2->offset + suffix_lines + 1
+                             : prefix_lines + suffix_lines + 1;
+  lcs->length = 0;
+  lcs->refcount = 1;
+  lcs->next = NULL;
+
+  if (suffix_lines)
+    lcs = prepend_lcs_chunk(lcs, suffix_lines,
+                            lcs->position[0]->offset - suffix_lines,
+                            lcs->position[1]->offset - suffix_lines,
+                            pool);
+
+  if (position_list1 != NULL)
+    {
+      /* One chunk spanning all tokens, anchored on the ring heads so
+       * that the merge logic can resume position list walks from it. */
+      svn_diff__lcs_t *new_lcs = apr_palloc(pool, sizeof(*new_lcs));
+
+      new_lcs->position[0] = position_list1->next;
+      new_lcs->position[1] = position_list2->next;
+      new_lcs->length = position_list1->offset
+                        - position_list1->next->offset + 1;
+      new_lcs->refcount = 1;
+      new_lcs->next = lcs;
+      lcs = new_lcs;
+    }
+
+  if (prefix_lines)
+    lcs = prepend_lcs_chunk(lcs, prefix_lines, 1, 1, pool);
+
+  return lcs;
+}
+
+/* Return a copy of LCS, a chain for original vs. modified, rewritten to
+ * describe original vs. latest for the case that latest's token stream
+ * is identical to modified's.  POSITION_LIST is latest's ring.  Chunk
+ * positions that live in modified's ring get replaced by the
+ * corresponding latest node (the rings match 1:1, including offsets);
+ * the free-standing prefix, suffix and EOF positions are copied.
+ */
+static svn_diff__lcs_t *
+lcs_remap_positions(const svn_diff__lcs_t *lcs,
+                    svn_diff__position_t *position_list,
+                    apr_pool_t *pool)
+{
+  svn_diff__lcs_t *result = NULL;
+  svn_diff__lcs_t **result_ref = &result;
+  svn_diff__position_t *position = position_list ? position_list->next : NULL;
+
+  for (; lcs != NULL; lcs = lcs->next)
+    {
+      svn_diff__lcs_t *chunk = apr_palloc(pool, sizeof(*chunk));
+
+      chunk->position[0] = lcs->position[0];
+      chunk->length = lcs->length;
+      chunk->refcount = 1;
+
+      if (lcs->position[1]->next != NULL)
+        {
+          /* A ring node.  The chunks come in increasing offset order,
+           * so a single forward walk finds each counterpart. */
+          while (position->offset < lcs->position[1]->offset)
+            position = position->next;
+          chunk->position[1] = position;
+        }
+      else
+        {
+          chunk->position[1] = apr_pcalloc(pool,
+                                           sizeof(*chunk->position[1]));
+          chunk->position[1]->offset = lcs->position[1]->offset;
+        }
+
+      *result_ref = chunk;
+      result_ref = &chunk->next;
+    }
+
+  *result_ref = NULL;
+
+  return result;
+}
+
 svn_error_t *
-svn_diff_diff3_2(svn_diff_t **diff,
-                 void *diff_baton,
-                 const svn_diff_fns2_t *vtable,
-                 apr_pool_t *pool)
+svn_diff__diff3_2_internal(svn_diff_t **diff,
+                           void *diff_baton,
+                           const svn_diff_fns2_t *vtable,
+                           svn_boolean_t use_histogram,
+                           apr_pool_t *pool)
 {
   svn_diff__tree_t *tree;
   svn_diff__position_t *position_list[3];
@@ -262,6 +416,7 @@ svn_diff_diff3_2(svn_diff_t **diff,
                                         svn_diff_datasource_latest};
   svn_diff__lcs_t *lcs_om;
   svn_diff__lcs_t *lcs_ol;
+  svn_boolean_t om_identical;
   apr_pool_t *subpool;
   apr_pool_t *treepool;
   apr_off_t prefix_lines = 0;
@@ -314,13 +469,40 @@ svn_diff_diff3_2(svn_diff_t **diff,
   token_counts[2] = svn_diff__get_token_counts(position_list[2], num_tokens,
                                                subpool);
 
-  /* Get the lcs for original-modified and original-latest */
-  lcs_om = svn_diff__lcs(position_list[0], position_list[1], token_counts[0],
-                         token_counts[1], num_tokens, prefix_lines,
-                         suffix_lines, subpool);
-  lcs_ol = svn_diff__lcs(position_list[0], position_list[2], token_counts[0],
-                         token_counts[2], num_tokens, prefix_lines,
-                         suffix_lines, subpool);
+  /* Get the lcs for original-modified and original-latest.  Updates
+   * with local mods usually leave one side token-identical to another
+   * in the non-common region; detect those cases with a linear scan
+   * instead of discovering them the expensive way. */
+  om_identical = position_rings_identical(position_list[0],
+                                          position_list[1]);
+  if (om_identical)
+    lcs_om = lcs_trivially_identical(position_list[0], position_list[1],
+                                     prefix_lines, suffix_lines, subpool);
+  else if (use_histogram)
+    lcs_om = svn_diff__lcs_histogram(position_list[0], position_list[1],
+                                     num_tokens, prefix_lines,
+                                     suffix_lines, subpool);
+  else
+    lcs_om = svn_diff__lcs(position_list[0], position_list[1],
+                           token_counts[0], token_counts[1], num_tokens,
+                           prefix_lines, suffix_lines, subpool);
+
+  if (position_rings_identical(position_list[0], position_list[2]))
+    lcs_ol = lcs_trivially_identical(position_list[0], position_list[2],
+                                     prefix_lines, suffix_lines, subpool);
+  else if (!om_identical
+           && position_rings_identical(position_list[1], position_list[2]))
+    /* Both sides made the same change; the second LCS is the first one
+     * with its modified positions swapped for their latest twins. */
+    lcs_ol = lcs_remap_positions(lcs_om, position_list[2], subpool);
+  else if (use_histogram)
+    lcs_ol = svn_diff__lcs_histogram(position_list[0], position_list[2],
+                                     num_tokens, prefix_lines,
+                                     suffix_lines, subpool);
+  else
+    lcs_ol = svn_diff__lcs(position_list[0], position_list[2],
+                           token_counts[0], token_counts[2], num_tokens,
+                           prefix_lines, suffix_lines, subpool);
 
   /* Produce a merged diff */
   {
@@ -530,3 +712,13 @@ svn_diff_diff3_2(svn_diff_t **diff,
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_diff_diff3_2(svn_diff_t **diff,
+                 void *diff_baton,
+                 const svn_diff_fns2_t *vtable,
+                 apr_pool_t *pool)
+{
+  return svn_error_trace(svn_diff__diff3_2_internal(diff, diff_baton, vtable,
+                                                    FALSE, pool));
+}
@@ -80,6 +80,14 @@ typedef struct svn_diff__file_baton_t
     apr_file_t *file;  /* handle of this file */
     apr_off_t size;    /* total raw size in bytes of this file */
 
+#if APR_HAS_MMAP
+    /* The entire file, mapped into memory in a single piece, or NULL if
+       the file is small or could not be mapped.  If non-NULL, the chunk
+       buffer below simply points into this mapping and chunk switches
+       never copy data or touch the disk. */
+    apr_mmap_t *mm;
+#endif
+
     /* The current chunk: CHUNK_SIZE bytes except for the last chunk. */
     int chunk;     /* the current chunk number, zero-based */
     char *buffer;  /* a buffer containing the current chunk */
@@ -151,6 +159,39 @@ read_chunk(apr_file_t *file,
                                 NULL, NULL, scratch_pool);
 }
 
+/* TRUE if FILE (a struct file_info *) is backed by a memory mapping. */
+#if APR_HAS_MMAP
+#define file_is_mapped(file) ((file)->mm != NULL)
+#else
+#define file_is_mapped(file) FALSE
+#endif
+
+/* Make the chunk window of FILE (buffer and endp) cover chunk CHUNK, which
+ * contains LENGTH bytes.  If the whole file is memory-mapped, just aim the
+ * window at the right piece of the mapping; otherwise read the chunk from
+ * disk into FILE's private buffer.  The caller is responsible for updating
+ * FILE->chunk and the curp pointer.
+ */
+static APR_INLINE svn_error_t *
+seek_chunk(struct file_info *file, int chunk, apr_off_t length,
+           apr_pool_t *scratch_pool)
+{
+#if APR_HAS_MMAP
+  if (file->mm)
+    {
+      file->buffer = (char *)file->mm->mm + chunk_to_offset(chunk);
+      file->endp = file->buffer + length;
+      return SVN_NO_ERROR;
+    }
+#endif
+
+  SVN_ERR(read_chunk(file->file, file->buffer, length,
+                     chunk_to_offset(chunk), scratch_pool));
+  file->endp = file->buffer + length;
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Map or read a file at PATH. *BUFFER will point to the file
  * contents; if the file was mapped, *FILE and *MM will contain the
@@ -288,10 +329,7 @@ increment_chunk(struct file_info *file, apr_pool_t *pool)
       file->chunk++;
       length = file->chunk == last_chunk ?
         offset_in_chunk(file->size) : CHUNK_SIZE;
-      SVN_ERR(read_chunk(file->file, file->buffer,
-                         length, chunk_to_offset(file->chunk),
-                         pool));
-      file->endp = file->buffer + length;
+      SVN_ERR(seek_chunk(file, file->chunk, length, pool));
       file->curp = file->buffer;
     }
 
@@ -315,10 +353,7 @@ decrement_chunk(struct file_info *file, apr_pool_t *pool)
     {
       /* Read previous chunk and reset pointers. */
       file->chunk--;
-      SVN_ERR(read_chunk(file->file, file->buffer,
-                         CHUNK_SIZE, chunk_to_offset(file->chunk),
-                         pool));
-      file->endp = file->buffer + CHUNK_SIZE;
+      SVN_ERR(seek_chunk(file, file->chunk, CHUNK_SIZE, pool));
       file->curp = file->endp - 1;
     }
 
@@ -554,6 +589,9 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
       file_for_suffix[i].path = file[i].path;
       file_for_suffix[i].file = file[i].file;
       file_for_suffix[i].size = file[i].size;
+#if APR_HAS_MMAP
+      file_for_suffix[i].mm = file[i].mm;
+#endif
       file_for_suffix[i].chunk =
         (int) offset_to_chunk(file_for_suffix[i].size); /* last chunk */
       length[i] = offset_in_chunk(file_for_suffix[i].size);
@@ -571,13 +609,13 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
         }
       else
         {
-          /* There is at least more than 1 chunk,
-             so allocate full chunk size buffer */
-          file_for_suffix[i].buffer = apr_palloc(pool, CHUNK_SIZE);
-          SVN_ERR(read_chunk(file_for_suffix[i].file,
-                             file_for_suffix[i].buffer, length[i],
-                             chunk_to_offset(file_for_suffix[i].chunk),
-                             pool));
+          /* There is at least more than 1 chunk, so allocate a full chunk
+             size buffer, unless the file is mapped in its entirety and the
+             window can simply point into the mapping */
+          if (!file_is_mapped(&file_for_suffix[i]))
+            file_for_suffix[i].buffer = apr_palloc(pool, CHUNK_SIZE);
+          SVN_ERR(seek_chunk(&file_for_suffix[i], file_for_suffix[i].chunk,
+                             length[i], pool));
         }
       file_for_suffix[i].endp = file_for_suffix[i].buffer + length[i];
       file_for_suffix[i].curp = file_for_suffix[i].endp - 1;
@@ -799,10 +837,35 @@ datasources_open(void *baton,
       SVN_ERR(svn_io_file_size_get(&filesize, file->file, file_baton->pool));
       file->size = filesize;
       length[i] = filesize > CHUNK_SIZE ? CHUNK_SIZE : filesize;
-      file->buffer = apr_palloc(file_baton->pool, (apr_size_t) length[i]);
-      SVN_ERR(read_chunk(file->file, file->buffer,
-                         length[i], 0, file_baton->pool));
-      file->endp = file->buffer + length[i];
+
+#if APR_HAS_MMAP
+      /* Map multi-chunk files in one piece, so token scanning and compares
+       * run over a contiguous mapping instead of re-reading chunks from
+       * disk.  We cannot do this if whitespace or eol-style normalization
+       * is enabled, because svn_diff__normalize_buffer() normalizes the
+       * chunk buffer in place, which the read-only mapping won't allow.
+       * On failure, just fall back to chunked reading. */
+      file->mm = NULL;
+      if (filesize > CHUNK_SIZE && filesize <= APR_SIZE_MAX
+          && ! file_baton->options->ignore_space
+          && ! file_baton->options->ignore_eol_style)
+        {
+          apr_mmap_t *mm;
+          if (apr_mmap_create(&mm, file->file, 0, (apr_size_t) filesize,
+                              APR_MMAP_READ, file_baton->pool) == APR_SUCCESS)
+            file->mm = mm;
+        }
+#endif /* APR_HAS_MMAP */
+
+      if (!file_is_mapped(file))
+        {
+          file->buffer = apr_palloc(file_baton->pool, (apr_size_t) length[i]);
+          SVN_ERR(read_chunk(file->file, file->buffer,
+                             length[i], 0, file_baton->pool));
+          file->endp = file->buffer + length[i];
+        }
+      else
+        SVN_ERR(seek_chunk(file, 0, length[i], file_baton->pool));
       file->curp = file->buffer;
       /* Set suffix_start_chunk to a guard value, so if suffix scanning is
        * skipped because one of the files is empty, or because of
@@ -953,12 +1016,9 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
         h = svn__adler32(h, c, length);
       }
 
-      curp = endp = file->buffer;
       file->chunk++;
       length = file->chunk == last_chunk ?
         offset_in_chunk(file->size) : CHUNK_SIZE;
-      endp += length;
-      file->endp = endp;
 
       /* Issue #4283: Normally we should have checked for reaching the skipped
          suffix here, but because we assume that a suffix always starts on a
@@ -968,16 +1028,17 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
          When changing things here, make sure the whitespace settings are
          applied, or we might not reach the exact suffix boundary as token
          boundary. */
-      SVN_ERR(read_chunk(file->file,
-                         curp, length,
-                         chunk_to_offset(file->chunk),
-                         file_baton->pool));
+      SVN_ERR(seek_chunk(file, file->chunk, length, file_baton->pool));
+      curp = file->buffer;
+      endp = file->endp;
 
-      /* If the last chunk ended in a CR, we're done. */
+      /* If the last chunk ended in a CR, we're done.  (An empty final
+         chunk can occur if the file size is an exact multiple of
+         CHUNK_SIZE; don't read past it.) */
       if (had_cr)
         {
           eol = curp;
-          if (*curp == '\n')
+          if (curp < endp && *curp == '\n')
             ++eol;
           break;
         }
@@ -1073,6 +1134,18 @@ token_compare(void *baton, void *token1, void *token2, int *compare)
           length[i] = total_length;
           raw_length[i] = 0;
         }
+#if APR_HAS_MMAP
+      else if (file[i]->mm)
+        {
+          /* The whole file is mapped, so the entire token is in memory
+           * no matter which chunk it starts in.
+           */
+          bufp[i] = (char *)file[i]->mm->mm + offset[i];
+
+          length[i] = total_length;
+          raw_length[i] = 0;
+        }
+#endif /* APR_HAS_MMAP */
       else
         {
           apr_off_t skipped;
@@ -1181,6 +1254,7 @@ static const svn_diff_fns2_t svn_diff__file_vtable =
 
 /* Id for the --ignore-eol-style option, which doesn't have a short name. */
 #define SVN_DIFF__OPT_IGNORE_EOL_STYLE 256
+#define SVN_DIFF__OPT_DIFF_ALGORITHM 257
 
 /* Options supported by svn_diff_file_options_parse(). */
 static const apr_getopt_option_t diff_options[] =
@@ -1188,6 +1262,7 @@ static const apr_getopt_option_t diff_options[] =
   { "ignore-space-change", 'b', 0, NULL },
   { "ignore-all-space", 'w', 0, NULL },
   { "ignore-eol-style", SVN_DIFF__OPT_IGNORE_EOL_STYLE, 0, NULL },
+  { "diff-algorithm", SVN_DIFF__OPT_DIFF_ALGORITHM, 1, NULL },
   { "show-c-function", 'p', 0, NULL },
   /* ### For compatibility; we don't support the argument to -u, because
    * ### we don't have optional argument support. */
@@ -1292,6 +1367,16 @@ svn_diff_file_options_parse(svn_diff_file_options_t *options,
         case SVN_DIFF__OPT_IGNORE_EOL_STYLE:
           options->ignore_eol_style = TRUE;
           break;
+        case SVN_DIFF__OPT_DIFF_ALGORITHM:
+          if (strcmp(opt_arg, "histogram") == 0)
+            options->use_histogram_diff = TRUE;
+          else if (strcmp(opt_arg, "myers") == 0)
+            options->use_histogram_diff = FALSE;
+          else
+            return svn_error_createf(SVN_ERR_INVALID_DIFF_OPTION, NULL,
+                                     _("Unknown diff algorithm '%s'"),
+                                     opt_arg);
+          break;
         case 'p':
           options->show_c_function = TRUE;
           break;
@@ -1326,7 +1411,8 @@ svn_diff_file_diff_2(svn_diff_t **diff,
   baton.files[1].path = modified;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff_2_internal(diff, &baton, &svn_diff__file_vtable,
+                                    options->use_histogram_diff, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -1348,7 +1434,8 @@ svn_diff_file_diff3_2(svn_diff_t **diff,
   baton.files[2].path = latest;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff3_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff3_2_internal(diff, &baton, &svn_diff__file_vtable,
+                                     options->use_histogram_diff, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -66,6 +66,15 @@ typedef struct diff_mem_baton_t
 
   /* Options for normalized comparison of the data sources */
   const svn_diff_file_options_t *normalization_options;
+
+  /* Per-token hashes of each source computed by an earlier call, or NULL
+     to normalize and hash each token on the fly.  See
+     svn_diff__mem_string_diff_cached(). */
+  const apr_uint32_t *token_hashes[4];
+
+  /* If not NULL, record the hash of each token of the modified source
+     here (the array has one slot per token). */
+  apr_uint32_t *record_hashes;
 } diff_mem_baton_t;
 
 
@@ -124,21 +133,32 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
                           svn_diff_datasource_e datasource)
 {
   diff_mem_baton_t *mem_baton = baton;
-  source_tokens_t *src = &(mem_baton->sources[datasource_to_index(datasource)]);
+  int idx = datasource_to_index(datasource);
+  source_tokens_t *src = &(mem_baton->sources[idx]);
 
   if ((apr_size_t)src->tokens->nelts > src->next_token)
     {
       /* There are actually tokens to be returned */
-      char *buf = mem_baton->normalization_buf[0];
       svn_string_t *tok = (*token)
         = APR_ARRAY_IDX(src->tokens, src->next_token, svn_string_t *);
-      apr_off_t len = tok->len;
-      svn_diff__normalize_state_t state
-        = svn_diff__normalize_state_normal;
 
-      svn_diff__normalize_buffer(&buf, &len, &state, tok->data,
-                                 mem_baton->normalization_options);
-      *hash = svn__adler32(0, buf, len);
+      if (mem_baton->token_hashes[idx])
+        *hash = mem_baton->token_hashes[idx][src->next_token];
+      else
+        {
+          char *buf = mem_baton->normalization_buf[0];
+          apr_off_t len = tok->len;
+          svn_diff__normalize_state_t state
+            = svn_diff__normalize_state_normal;
+
+          svn_diff__normalize_buffer(&buf, &len, &state, tok->data,
+                                     mem_baton->normalization_options);
+          *hash = svn__adler32(0, buf, len);
+
+          if (mem_baton->record_hashes
+              && datasource == svn_diff_datasource_modified)
+            mem_baton->record_hashes[src->next_token] = *hash;
+        }
       src->next_token++;
     }
   else
@@ -292,8 +312,11 @@ svn_diff_mem_string_diff(svn_diff_t **diff,
   alloc_normalization_bufs(&baton, 2, pool);
 
   baton.normalization_options = options;
+  baton.token_hashes[0] = baton.token_hashes[1] = NULL;
+  baton.record_hashes = NULL;
 
-  return svn_diff_diff_2(diff, &baton, &svn_diff__mem_vtable, pool);
+  return svn_diff__diff_2_internal(diff, &baton, &svn_diff__mem_vtable,
+                                   options->use_histogram_diff, pool);
 }
 
 svn_error_t *
@@ -312,8 +335,12 @@ svn_diff_mem_string_diff3(svn_diff_t **diff,
   alloc_normalization_bufs(&baton, 3, pool);
 
   baton.normalization_options = options;
+  baton.token_hashes[0] = baton.token_hashes[1]
+    = baton.token_hashes[2] = NULL;
+  baton.record_hashes = NULL;
 
-  return svn_diff_diff3_2(diff, &baton, &svn_diff__mem_vtable, pool);
+  return svn_diff__diff3_2_internal(diff, &baton, &svn_diff__mem_vtable,
+                                    options->use_histogram_diff, pool);
 }
 
 
@@ -335,11 +362,116 @@ svn_diff_mem_string_diff4(svn_diff_t **diff,
   alloc_normalization_bufs(&baton, 4, pool);
 
   baton.normalization_options = options;
+  baton.token_hashes[0] = baton.token_hashes[1]
+    = baton.token_hashes[2] = baton.token_hashes[3] = NULL;
+  baton.record_hashes = NULL;
 
   return svn_diff_diff4_2(diff, &baton, &svn_diff__mem_vtable, pool);
 }
 
 
+/* Carries the tokenization (line boundaries and normalized token hashes)
+   of one source buffer from one svn_diff__mem_string_diff_cached() call
+   to the next, so that callers which diff a chain of revisions pairwise
+   only tokenize each revision once. */
+struct svn_diff__mem_cache_t
+{
+  /* The cached token state.  TOKENS.tokens lives in TOKEN_POOL[ACTIVE];
+     the other token pool is recycled for the next call's modified side. */
+  source_tokens_t tokens;
+  apr_uint32_t *hashes;
+  apr_pool_t *token_pool[2];
+  int active;
+
+  /* Identity of the buffer TOKENS describes, and the normalization
+     options its hashes were computed under.  DATA is NULL while the
+     cache is empty (or after a failed call). */
+  const char *data;
+  apr_size_t len;
+  svn_diff_file_ignore_space_t ignore_space;
+  svn_boolean_t ignore_eol_style;
+};
+
+svn_diff__mem_cache_t *
+svn_diff__mem_cache_create(apr_pool_t *result_pool)
+{
+  svn_diff__mem_cache_t *cache = apr_pcalloc(result_pool, sizeof(*cache));
+
+  cache->token_pool[0] = svn_pool_create(result_pool);
+  cache->token_pool[1] = svn_pool_create(result_pool);
+
+  return cache;
+}
+
+svn_error_t *
+svn_diff__mem_string_diff_cached(svn_diff_t **diff,
+                                 svn_diff__mem_cache_t *cache,
+                                 const svn_string_t *original,
+                                 const svn_string_t *modified,
+                                 const svn_diff_file_options_t *options,
+                                 apr_pool_t *pool)
+{
+  diff_mem_baton_t baton;
+  apr_pool_t *modified_pool = cache->token_pool[1 - cache->active];
+  svn_error_t *err;
+
+  /* Reuse the cached tokenization for ORIGINAL if it describes this very
+     buffer and its hashes were computed under the same normalization
+     options.  (The cached svn_string_t tokens point into the buffer
+     itself, which the caller guarantees is still alive.) */
+  if (cache->data == original->data
+      && cache->len == original->len
+      && cache->ignore_space == options->ignore_space
+      && cache->ignore_eol_style == options->ignore_eol_style)
+    {
+      baton.sources[0] = cache->tokens;
+      baton.sources[0].next_token = 0;
+      baton.sources[0].source = original;
+      baton.token_hashes[0] = cache->hashes;
+    }
+  else
+    {
+      fill_source_tokens(&baton.sources[0], original, pool);
+      baton.token_hashes[0] = NULL;
+    }
+
+  /* Tokenize MODIFIED into the cache's spare pool so the result survives
+     this call, and have the diff core record the token hashes it computes
+     anyway. */
+  svn_pool_clear(modified_pool);
+  fill_source_tokens(&baton.sources[1], modified, modified_pool);
+  baton.token_hashes[1] = NULL;
+  baton.record_hashes = apr_palloc(modified_pool,
+                                   baton.sources[1].tokens->nelts
+                                     * sizeof(*baton.record_hashes));
+
+  alloc_normalization_bufs(&baton, 2, pool);
+
+  baton.normalization_options = options;
+
+  err = svn_diff__diff_2_internal(diff, &baton, &svn_diff__mem_vtable,
+                                  options->use_histogram_diff, pool);
+  if (err)
+    {
+      /* The recorded hashes may be incomplete; drop the cache. */
+      cache->data = NULL;
+      return svn_error_trace(err);
+    }
+
+  /* Remember the tokenization of MODIFIED; the next call is expected to
+     pass the same buffer back as ORIGINAL. */
+  cache->active = 1 - cache->active;
+  cache->tokens = baton.sources[1];
+  cache->hashes = baton.record_hashes;
+  cache->data = modified->data;
+  cache->len = modified->len;
+  cache->ignore_space = options->ignore_space;
+  cache->ignore_eol_style = options->ignore_eol_style;
+
+  return SVN_NO_ERROR;
+}
+
+
 typedef enum unified_output_e
 {
   unified_output_context = 0,
@@ -0,0 +1,382 @@
+/*
+ * histogram.c :  histogram variant of the lcs algorithm
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#include <apr.h>
+#include <apr_pools.h>
+#include <apr_general.h>
+
+#include "svn_pools.h"
+
+#include "diff.h"
+
+/*
+ * The histogram algorithm, as popularized by jgit: instead of computing
+ * a true longest common subsequence like svn_diff__lcs() does, pick the
+ * token that occurs least often in the region under consideration as an
+ * anchor, find the longest match around it, and recurse into the regions
+ * before and after the match.
+ *
+ * The worst cases of the O(NP) LCS algorithm are sources consisting
+ * largely of repeated tokens: the number of deletions P grows with the
+ * source length and the quadratic term takes over.  The histogram
+ * approach degrades gracefully on such input because repeated tokens are
+ * exactly the ones it avoids anchoring on.  The price is that the
+ * resulting common subsequence is not guaranteed to be the longest one,
+ * i.e. a diff may come out slightly larger than the minimal diff.
+ *
+ * The result is returned in the same svn_diff__lcs_t chain format that
+ * svn_diff__lcs() produces, including the EOF sentinel chunk and the
+ * prefix/suffix chunks, so it is a drop-in replacement for all consumers
+ * of that structure.
+ */
+
+/* A work item on the explicit recursion stack: either a region still to
+ * be split, or a match to be emitted.  Matches are interleaved with the
+ * regions on the stack so that popping items in LIFO order emits all
+ * matches from left to right. */
+typedef struct hist_work_t
+{
+  svn_boolean_t is_match;
+
+  /* For regions: half-open index ranges into the position arrays. */
+  apr_off_t lo0, hi0;
+  apr_off_t lo1, hi1;
+
+  /* For matches: the matched index ranges [start, start + length). */
+  apr_off_t start0, start1;
+  apr_off_t length;
+} hist_work_t;
+
+/* Push a region work item onto STACK, unless it is trivially empty on
+ * either side (in which case it cannot contribute any matches). */
+static void
+push_region(apr_array_header_t *stack,
+            apr_off_t lo0, apr_off_t hi0,
+            apr_off_t lo1, apr_off_t hi1)
+{
+  hist_work_t *item;
+
+  if (lo0 >= hi0 || lo1 >= hi1)
+    return;
+
+  item = &APR_ARRAY_PUSH(stack, hist_work_t);
+  item->is_match = FALSE;
+  item->lo0 = lo0;
+  item->hi0 = hi0;
+  item->lo1 = lo1;
+  item->hi1 = hi1;
+}
+
+/* Push a match work item onto STACK. */
+static void
+push_match(apr_array_header_t *stack,
+           apr_off_t start0, apr_off_t start1, apr_off_t length)
+{
+  hist_work_t *item = &APR_ARRAY_PUSH(stack, hist_work_t);
+
+  item->is_match = TRUE;
+  item->start0 = start0;
+  item->start1 = start1;
+  item->length = length;
+}
+
+/* Append a match of LENGTH tokens starting at POSITION0 and POSITION1 to
+ * the lcs chain ending at *TAIL_REF, merging it into the last chunk when
+ * the two are contiguous.  Allocate new chunks in POOL. */
+static void
+append_match(svn_diff__lcs_t **tail_ref,
+             svn_diff__position_t *position0,
+             svn_diff__position_t *position1,
+             apr_off_t length,
+             apr_pool_t *pool)
+{
+  svn_diff__lcs_t *tail = *tail_ref;
+  svn_diff__lcs_t *new_lcs;
+
+  if (tail
+      && tail->position[0]->offset + tail->length == position0->offset
+      && tail->position[1]->offset + tail->length == position1->offset)
+    {
+      tail->length += length;
+      return;
+    }
+
+  new_lcs = apr_palloc(pool, sizeof(*new_lcs));
+  new_lcs->position[0] = position0;
+  new_lcs->position[1] = position1;
+  new_lcs->length = length;
+  new_lcs->refcount = 1;
+  new_lcs->next = NULL;
+  if (tail)
+    tail->next = new_lcs;
+  *tail_ref = new_lcs;
+}
+
+/* As prepend_lcs() in lcs.c: return a new chunk for LINES tokens at
+ * POS0_OFFSET and POS1_OFFSET, prepended to LCS. */
+static svn_diff__lcs_t *
+prepend_lcs(svn_diff__lcs_t *lcs, apr_off_t lines,
+            apr_off_t pos0_offset, apr_off_t pos1_offset,
+            apr_pool_t *pool)
+{
+  svn_diff__lcs_t *new_lcs;
+
+  SVN_ERR_ASSERT_NO_RETURN(lines > 0);
+
+  new_lcs = apr_palloc(pool, sizeof(*new_lcs));
+  new_lcs->position[0] = apr_pcalloc(pool, sizeof(*new_lcs->position[0]));
+  new_lcs->position[0]->offset = pos0_offset;
+  new_lcs->position[1] = apr_pcalloc(pool, sizeof(*new_lcs->position[1]));
+  new_lcs->position[1]->offset = pos1_offset;
+  new_lcs->length = lines;
+  new_lcs->refcount = 1;
+  new_lcs->next = lcs;
+
+  return new_lcs;
+}
+
+
+svn_diff__lcs_t *
+svn_diff__lcs_histogram(svn_diff__position_t *position_list1,
+                        svn_diff__position_t *position_list2,
+                        svn_diff__token_index_t num_tokens,
+                        apr_off_t prefix_lines,
+                        apr_off_t suffix_lines,
+                        apr_pool_t *pool)
+{
+  apr_off_t length[2];
+  svn_diff__position_t **lines[2];
+  svn_diff__position_t *current;
+  svn_diff__token_index_t *count[2];
+  apr_array_header_t *stack;
+  svn_diff__lcs_t *eof_lcs;
+  svn_diff__lcs_t *head = NULL;
+  svn_diff__lcs_t *tail = NULL;
+  apr_pool_t *subpool;
+  apr_off_t i;
+
+  /* Since EOF is always a sync point we tack on an EOF link
+   * with sentinel positions, exactly as svn_diff__lcs() does.
+   */
+  eof_lcs = apr_palloc(pool, sizeof(*eof_lcs));
+  eof_lcs->position[0] = apr_pcalloc(pool, sizeof(*eof_lcs->position[0]));
+  eof_lcs->position[0]->offset = position_list1
+                                 ? position_list1->offset + suffix_lines + 1
+                                 : prefix_lines + suffix_lines + 1;
+  eof_lcs->position[1] = apr_pcalloc(pool, sizeof(*eof_lcs->position[1]));
+  eof_lcs->position[1]->offset = position_list2
+                                 ? position_list2->offset + suffix_lines + 1
+                                 : prefix_lines + suffix_lines + 1;
+  eof_lcs->length = 0;
+  eof_lcs->refcount = 1;
+  eof_lcs->next = NULL;
+
+  if (position_list1 == NULL || position_list2 == NULL)
+    {
+      svn_diff__lcs_t *lcs = eof_lcs;
+
+      if (suffix_lines)
+        lcs = prepend_lcs(lcs, suffix_lines,
+                          lcs->position[0]->offset - suffix_lines,
+                          lcs->position[1]->offset - suffix_lines,
+                          pool);
+      if (prefix_lines)
+        lcs = prepend_lcs(lcs, prefix_lines, 1, 1, pool);
+
+      return lcs;
+    }
+
+  subpool = svn_pool_create(pool);
+
+  /* Unroll the position rings into arrays for random access.  The
+   * position nodes themselves are kept: consumers such as the diff3
+   * conflict resolver walk the chunk positions' NEXT pointers, so the
+   * chunks must reference the real list nodes. */
+  length[0] = position_list1->offset - position_list1->next->offset + 1;
+  length[1] = position_list2->offset - position_list2->next->offset + 1;
+
+  lines[0] = apr_palloc(subpool,
+                        (apr_size_t)length[0] * sizeof(**lines));
+  i = 0;
+  current = position_list1->next;
+  do
+    {
+      lines[0][i++] = current;
+      current = current->next;
+    }
+  while (current != position_list1->next);
+
+  lines[1] = apr_palloc(subpool,
+                        (apr_size_t)length[1] * sizeof(**lines));
+  i = 0;
+  current = position_list2->next;
+  do
+    {
+      lines[1][i++] = current;
+      current = current->next;
+    }
+  while (current != position_list2->next);
+
+  /* Per-token occurrence counts for the region being split.  They are
+   * zeroed again after each region by rescanning it, so the arrays only
+   * have to be cleared once. */
+  count[0] = apr_pcalloc(subpool, num_tokens * sizeof(**count));
+  count[1] = apr_pcalloc(subpool, num_tokens * sizeof(**count));
+
+  stack = apr_array_make(subpool, 64, sizeof(hist_work_t));
+  push_region(stack, 0, length[0], 0, length[1]);
+
+  while (stack->nelts > 0)
+    {
+      hist_work_t work = APR_ARRAY_IDX(stack, stack->nelts - 1, hist_work_t);
+      svn_diff__token_index_t best_token = -1;
+      svn_diff__token_index_t best_count = 0;
+      apr_off_t anchor = 0;
+      apr_off_t best_start0 = 0;
+      apr_off_t best_start1 = 0;
+      apr_off_t best_length = 0;
+      apr_off_t j;
+
+      stack->nelts--;
+
+      if (work.is_match)
+        {
+          append_match(&tail, lines[0][work.start0], lines[1][work.start1],
+                       work.length, pool);
+          if (!head)
+            head = tail;
+          continue;
+        }
+
+      /* Count the occurrences of each token within the region. */
+      for (i = work.lo0; i < work.hi0; i++)
+        count[0][lines[0][i]->token_index]++;
+      for (j = work.lo1; j < work.hi1; j++)
+        count[1][lines[1][j]->token_index]++;
+
+      /* Find the rarest token that occurs on both sides, and remember
+       * its first occurrence as the anchor. */
+      for (i = work.lo0; i < work.hi0; i++)
+        {
+          svn_diff__token_index_t token = lines[0][i]->token_index;
+          svn_diff__token_index_t occurrences;
+
+          if (count[1][token] == 0)
+            continue;
+
+          occurrences = count[0][token] + count[1][token];
+          if (best_token < 0 || occurrences < best_count)
+            {
+              best_token = token;
+              best_count = occurrences;
+              anchor = i;
+            }
+        }
+
+      /* Reset the counts for the next region. */
+      for (i = work.lo0; i < work.hi0; i++)
+        count[0][lines[0][i]->token_index] = 0;
+      for (j = work.lo1; j < work.hi1; j++)
+        count[1][lines[1][j]->token_index] = 0;
+
+      /* No token in common: the whole region is a modification. */
+      if (best_token < 0)
+        continue;
+
+      /* Find the longest match around the anchor, trying each
+       * occurrence of the anchor token on the other side.  The anchor
+       * token is the rarest one, so this loop is cheap. */
+      for (j = work.lo1; j < work.hi1; j++)
+        {
+          apr_off_t start0, start1, end0, end1;
+
+          if (lines[1][j]->token_index != best_token)
+            continue;
+
+          start0 = anchor;
+          start1 = j;
+          while (start0 > work.lo0 && start1 > work.lo1
+                 && lines[0][start0 - 1]->token_index
+                    == lines[1][start1 - 1]->token_index)
+            {
+              start0--;
+              start1--;
+            }
+
+          end0 = anchor + 1;
+          end1 = j + 1;
+          while (end0 < work.hi0 && end1 < work.hi1
+                 && lines[0][end0]->token_index
+                    == lines[1][end1]->token_index)
+            {
+              end0++;
+              end1++;
+            }
+
+          if (end0 - start0 > best_length)
+            {
+              best_length = end0 - start0;
+              best_start0 = start0;
+              best_start1 = start1;
+            }
+        }
+
+      /* Split around the match.  Push in reverse order so that the
+       * left region is processed first and matches are emitted from
+       * left to right. */
+      push_region(stack, best_start0 + best_length, work.hi0,
+                  best_start1 + best_length, work.hi1);
+      push_match(stack, best_start0, best_start1, best_length);
+      push_region(stack, work.lo0, best_start0, work.lo1, best_start1);
+    }
+
+  svn_pool_destroy(subpool);
+
+  /* Terminate the chain the same way svn_diff__lcs() does. */
+  if (suffix_lines)
+    {
+      svn_diff__lcs_t *suffix_lcs
+        = prepend_lcs(eof_lcs, suffix_lines,
+                      eof_lcs->position[0]->offset - suffix_lines,
+                      eof_lcs->position[1]->offset - suffix_lines,
+                      pool);
+      /* prepend_lcs() links the EOF chunk behind the suffix chunk. */
+      if (tail)
+        tail->next = suffix_lcs;
+      else
+        head = suffix_lcs;
+    }
+  else
+    {
+      if (tail)
+        tail->next = eof_lcs;
+      else
+        head = eof_lcs;
+    }
+
+  if (prefix_lines)
+    return prepend_lcs(head, prefix_lines, 1, 1, pool);
+  else
+    return head;
+}
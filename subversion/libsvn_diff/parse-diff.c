@@ -1044,7 +1044,10 @@ parse_pretty_mergeinfo_line(svn_boolean_t *found_mergeinfo,
  * is the first belonging to a certain property, then PROP_NAME and
  * PROP_OPERATION will be set too. If we have a text hunk, PROP_NAME will be
  * NULL.  If IGNORE_WHITESPACE is TRUE, lines without leading spaces will be
- * treated as context lines.  Allocate results in RESULT_POOL.
+ * treated as context lines.  The returned hunk reads its text through
+ * HUNKS_FILE, a separate handle to the same file, so that hunk reads do
+ * not disturb the parser's position or read buffer.
+ * Allocate results in RESULT_POOL.
  * Use SCRATCH_POOL for all other allocations. */
 static svn_error_t *
 parse_next_hunk(svn_diff_hunk_t **hunk,
@@ -1053,6 +1056,7 @@ parse_next_hunk(svn_diff_hunk_t **hunk,
                 svn_diff_operation_kind_t *prop_operation,
                 svn_patch_t *patch,
                 apr_file_t *apr_file,
+                apr_file_t *hunks_file,
                 svn_boolean_t ignore_whitespace,
                 apr_pool_t *result_pool,
                 apr_pool_t *scratch_pool)
@@ -1410,7 +1414,7 @@ parse_next_hunk(svn_diff_hunk_t **hunk,
         }
 
       (*hunk)->patch = patch;
-      (*hunk)->apr_file = apr_file;
+      (*hunk)->apr_file = hunks_file;
       (*hunk)->leading_context = leading_context;
       (*hunk)->trailing_context = trailing_context;
       (*hunk)->diff_text_range.start = start;
@@ -1952,6 +1956,14 @@ struct svn_patch_file_t
   /* The APR file handle to the patch file. */
   apr_file_t *apr_file;
 
+  /* A second, independently buffered handle to the same file, handed
+   * out to the parsed hunks for reading their text ranges.  Hunk reads
+   * seek around within their range while the parser advances linearly;
+   * with a single shared handle each of those seeks would invalidate
+   * the (4kB) APR read buffer and degrade hunk reading to one syscall
+   * per line. */
+  apr_file_t *hunks_file;
+
   /* The file offset at which the next patch is expected. */
   apr_off_t next_patch_offset;
 };
@@ -1967,6 +1979,9 @@ svn_diff_open_patch_file(svn_patch_file_t **patch_file,
   SVN_ERR(svn_io_file_open(&p->apr_file, local_abspath,
                            APR_READ | APR_BUFFERED, APR_OS_DEFAULT,
                            result_pool));
+  SVN_ERR(svn_io_file_open(&p->hunks_file, local_abspath,
+                           APR_READ | APR_BUFFERED, APR_OS_DEFAULT,
+                           result_pool));
   p->next_patch_offset = 0;
   *patch_file = p;
 
@@ -1977,10 +1992,12 @@ svn_diff_open_patch_file(svn_patch_file_t **patch_file,
  * Parsing stops if no valid next hunk can be found.
  * If IGNORE_WHITESPACE is TRUE, lines without
  * leading spaces will be treated as context lines.
+ * The stored hunks read their text through HUNKS_FILE.
  * Allocate results in RESULT_POOL.
  * Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
 parse_hunks(svn_patch_t *patch, apr_file_t *apr_file,
+            apr_file_t *hunks_file,
             svn_boolean_t ignore_whitespace,
             apr_pool_t *result_pool, apr_pool_t *scratch_pool)
 {
@@ -2001,8 +2018,8 @@ parse_hunks(svn_patch_t *patch, apr_file_t *apr_file,
       svn_pool_clear(iterpool);
 
       SVN_ERR(parse_next_hunk(&hunk, &is_property, &prop_name, &prop_operation,
-                              patch, apr_file, ignore_whitespace, result_pool,
-                              iterpool));
+                              patch, apr_file, hunks_file, ignore_whitespace,
+                              result_pool, iterpool));
 
       if (hunk && is_property)
         {
@@ -2035,6 +2052,7 @@ parse_hunks(svn_patch_t *patch, apr_file_t *apr_file,
 
 static svn_error_t *
 parse_binary_patch(svn_patch_t *patch, apr_file_t *apr_file,
+                   apr_file_t *hunks_file,
                    svn_boolean_t reverse,
                    apr_pool_t *result_pool, apr_pool_t *scratch_pool)
 {
@@ -2046,7 +2064,7 @@ parse_binary_patch(svn_patch_t *patch, apr_file_t *apr_file,
   svn_boolean_t in_blob = FALSE;
   svn_boolean_t in_src = FALSE;
 
-  bpatch->apr_file = apr_file;
+  bpatch->apr_file = hunks_file;
 
   patch->prop_patches = apr_hash_make(result_pool);
 
@@ -2343,12 +2361,14 @@ svn_diff_parse_next_patch(svn_patch_t **patch_p,
     {
       if (state == state_binary_patch_found)
         {
-          SVN_ERR(parse_binary_patch(patch, patch_file->apr_file, reverse,
+          SVN_ERR(parse_binary_patch(patch, patch_file->apr_file,
+                                     patch_file->hunks_file, reverse,
                                      result_pool, iterpool));
           /* And fall through in property parsing */
         }
 
-      SVN_ERR(parse_hunks(patch, patch_file->apr_file, ignore_whitespace,
+      SVN_ERR(parse_hunks(patch, patch_file->apr_file,
+                          patch_file->hunks_file, ignore_whitespace,
                           result_pool, iterpool));
     }
 
@@ -2374,6 +2394,7 @@ svn_error_t *
 svn_diff_close_patch_file(svn_patch_file_t *patch_file,
                           apr_pool_t *scratch_pool)
 {
+  SVN_ERR(svn_io_file_close(patch_file->hunks_file, scratch_pool));
   return svn_error_trace(svn_io_file_close(patch_file->apr_file,
                                            scratch_pool));
 }
@@ -354,17 +354,18 @@ add_directory_cb(void *baton,
 }
 
 
-/* This implements svn_editor_cb_add_file_t */
+/* Create a new file at RELPATH in EB's txn, with the given CONTENTS,
+   CHECKSUM, PROPS and REPLACES_REV as per svn_editor_add_file().
+   Common implementation for the single and the batched callback. */
 static svn_error_t *
-add_file_cb(void *baton,
-            const char *relpath,
-            const svn_checksum_t *checksum,
-            svn_stream_t *contents,
-            apr_hash_t *props,
-            svn_revnum_t replaces_rev,
-            apr_pool_t *scratch_pool)
+add_one_file(struct edit_baton *eb,
+             const char *relpath,
+             const svn_checksum_t *checksum,
+             svn_stream_t *contents,
+             apr_hash_t *props,
+             svn_revnum_t replaces_rev,
+             apr_pool_t *scratch_pool)
 {
-  struct edit_baton *eb = baton;
   const char *fspath = FSPATH(relpath, scratch_pool);
   svn_fs_root_t *root;
 
@@ -389,6 +390,51 @@ add_file_cb(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* This implements svn_editor_cb_add_file_t */
+static svn_error_t *
+add_file_cb(void *baton,
+            const char *relpath,
+            const svn_checksum_t *checksum,
+            svn_stream_t *contents,
+            apr_hash_t *props,
+            svn_revnum_t replaces_rev,
+            apr_pool_t *scratch_pool)
+{
+  struct edit_baton *eb = baton;
+
+  return svn_error_trace(add_one_file(eb, relpath, checksum, contents,
+                                      props, replaces_rev, scratch_pool));
+}
+
+/* This implements svn_editor_cb_add_files_t */
+static svn_error_t *
+add_files_cb(void *baton,
+             const apr_array_header_t *files,
+             apr_pool_t *scratch_pool)
+{
+  struct edit_baton *eb = baton;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  /* One editor call instead of one per file:  the driver's per-call
+     overhead is paid once and all per-file scratch data lives in a
+     single recycled iterpool. */
+  for (i = 0; i < files->nelts; i++)
+    {
+      const svn_editor_file_t *file
+        = APR_ARRAY_IDX(files, i, const svn_editor_file_t *);
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(add_one_file(eb, file->relpath, file->checksum,
+                           file->contents, file->props,
+                           file->replaces_rev, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 
 /* This implements svn_editor_cb_add_symlink_t */
 static svn_error_t *
@@ -696,7 +742,8 @@ make_editor(svn_editor_t **editor,
     copy_cb,
     move_cb,
     complete_cb,
-    abort_cb
+    abort_cb,
+    add_files_cb
   };
   struct edit_baton *eb = apr_pcalloc(result_pool, sizeof(*eb));
 
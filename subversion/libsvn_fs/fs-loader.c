@@ -37,6 +37,7 @@
 #include "svn_version.h"
 #include "svn_fs.h"
 #include "svn_path.h"
+#include "svn_props.h"
 #include "svn_xml.h"
 #include "svn_pools.h"
 #include "svn_string.h"
@@ -46,6 +47,7 @@
 #include "private/svn_fs_private.h"
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_utf_private.h"
 #include "private/svn_mutex.h"
 #include "private/svn_subr_private.h"
@@ -1216,6 +1218,21 @@ svn_fs_paths_changed3(svn_fs_path_change_iterator_t **iterator,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs__changes_may_touch_paths(svn_boolean_t *may_touch,
+                                svn_fs_root_t *root,
+                                const apr_array_header_t *paths,
+                                apr_pool_t *scratch_pool)
+{
+  if (root->vtable->changes_may_touch_paths)
+    return svn_error_trace(root->vtable->changes_may_touch_paths(
+                             may_touch, root, paths, scratch_pool));
+
+  /* The backend cannot give quick answers; be conservative. */
+  *may_touch = TRUE;
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_check_path(svn_node_kind_t *kind_p, svn_fs_root_t *root,
                   const char *path, apr_pool_t *pool)
@@ -1441,6 +1458,50 @@ svn_fs__get_mergeinfo_for_path(svn_mergeinfo_t *mergeinfo,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs__get_inherited_props(apr_array_header_t **iprops,
+                            svn_fs_root_t *root,
+                            const char *path,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  apr_array_header_t *inherited_props;
+  const char *parent_path = path;
+
+  if (root->vtable->node_inherited_proplist)
+    return svn_error_trace(root->vtable->node_inherited_proplist(
+                             iprops, root, path, result_pool, scratch_pool));
+
+  /* Generic implementation: one proplist query per parent directory. */
+  iterpool = svn_pool_create(scratch_pool);
+  inherited_props = apr_array_make(result_pool, 1,
+                                   sizeof(svn_prop_inherited_item_t *));
+  while (!(parent_path[0] == '/' && parent_path[1] == '\0'))
+    {
+      apr_hash_t *parent_properties;
+
+      svn_pool_clear(iterpool);
+      parent_path = svn_fspath__dirname(parent_path, scratch_pool);
+
+      SVN_ERR(root->vtable->node_proplist(&parent_properties, root,
+                                          parent_path, result_pool));
+      if (parent_properties && apr_hash_count(parent_properties))
+        {
+          svn_prop_inherited_item_t *i_props =
+            apr_pcalloc(result_pool, sizeof(*i_props));
+          i_props->path_or_url = apr_pstrdup(result_pool, parent_path + 1);
+          i_props->prop_hash = parent_properties;
+          /* Build the output array in depth-first order. */
+          SVN_ERR(svn_sort__array_insert2(inherited_props, &i_props, 0));
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  *iprops = inherited_props;
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_merge(const char **conflict_p, svn_fs_root_t *source_root,
              const char *source_path, svn_fs_root_t *target_root,
@@ -1462,6 +1523,52 @@ svn_fs_dir_entries(apr_hash_t **entries_p, svn_fs_root_t *root,
                                                    pool));
 }
 
+svn_error_t *
+svn_fs_dir_entries_full(apr_hash_t **entries_p, svn_fs_root_t *root,
+                        const char *path, apr_pool_t *pool)
+{
+  apr_hash_t *entries;
+  apr_hash_t *full_entries;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool;
+
+  if (root->vtable->dir_entries_full)
+    return svn_error_trace(root->vtable->dir_entries_full(entries_p, root,
+                                                          path, pool));
+
+  /* Fall back to assembling the result from per-entry queries. */
+  SVN_ERR(root->vtable->dir_entries(&entries, root, path, pool));
+
+  full_entries = apr_hash_make(pool);
+  iterpool = svn_pool_create(pool);
+  for (hi = apr_hash_first(pool, entries); hi; hi = apr_hash_next(hi))
+    {
+      const svn_fs_dirent_t *dirent = apr_hash_this_val(hi);
+      svn_fs_dirent_full_t *full = apr_pcalloc(pool, sizeof(*full));
+      const char *entry_path;
+
+      svn_pool_clear(iterpool);
+      entry_path = svn_fspath__join(path, dirent->name, iterpool);
+
+      full->name = dirent->name;
+      full->id = dirent->id;
+      full->kind = dirent->kind;
+      if (dirent->kind == svn_node_file)
+        SVN_ERR(root->vtable->file_length(&full->size, root, entry_path,
+                                          iterpool));
+      SVN_ERR(root->vtable->node_has_props(&full->has_props, root,
+                                           entry_path, iterpool));
+      SVN_ERR(root->vtable->node_created_rev(&full->created_rev, root,
+                                             entry_path, iterpool));
+
+      svn_hash_sets(full_entries, full->name, full);
+    }
+  svn_pool_destroy(iterpool);
+
+  *entries_p = full_entries;
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_dir_optimal_order(apr_array_header_t **ordered_p,
                          svn_fs_root_t *root,
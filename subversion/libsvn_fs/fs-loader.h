@@ -318,6 +318,12 @@ typedef struct root_vtable_t
                                  svn_fs_root_t *root,
                                  apr_pool_t *result_pool,
                                  apr_pool_t *scratch_pool);
+  /* Optional quick-reject check, see svn_fs__changes_may_touch_paths().
+     May be NULL. */
+  svn_error_t *(*changes_may_touch_paths)(svn_boolean_t *may_touch,
+                                          svn_fs_root_t *root,
+                                          const apr_array_header_t *paths,
+                                          apr_pool_t *scratch_pool);
 
   /* Generic node operations */
   svn_error_t *(*check_path)(svn_node_kind_t *kind_p, svn_fs_root_t *root,
@@ -365,6 +371,13 @@ typedef struct root_vtable_t
                                 const char *path, apr_pool_t *pool);
   svn_error_t *(*node_has_props)(svn_boolean_t *has_props, svn_fs_root_t *root,
                                  const char *path, apr_pool_t *scratch_pool);
+  /* Optional rolled-up variant of node_proplist covering all parents of
+     a node, see svn_fs__get_inherited_props().  May be NULL. */
+  svn_error_t *(*node_inherited_proplist)(apr_array_header_t **iprops,
+                                          svn_fs_root_t *root,
+                                          const char *path,
+                                          apr_pool_t *result_pool,
+                                          apr_pool_t *scratch_pool);
   svn_error_t *(*change_node_prop)(svn_fs_root_t *root, const char *path,
                                    const char *name,
                                    const svn_string_t *value,
@@ -440,6 +453,13 @@ typedef struct root_vtable_t
                                 svn_fs_mergeinfo_receiver_t receiver,
                                 void *baton,
                                 apr_pool_t *scratch_pool);
+
+  /* Batched directory reading.  May be NULL, in which case the FS
+     loader falls back to dir_entries plus per-entry queries.
+     Added after the 1.8 members. */
+  svn_error_t *(*dir_entries_full)(apr_hash_t **entries_p,
+                                   svn_fs_root_t *root,
+                                   const char *path, apr_pool_t *pool);
 } root_vtable_t;
 
 
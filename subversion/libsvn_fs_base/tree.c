@@ -5511,6 +5511,7 @@ base_get_mergeinfo(svn_fs_root_t *root,
 static root_vtable_t root_vtable = {
   base_paths_changed,
   NULL,
+  NULL,
   base_check_path,
   base_node_history,
   base_node_id,
@@ -5526,6 +5527,7 @@ static root_vtable_t root_vtable = {
   base_node_prop,
   base_node_proplist,
   base_node_has_props,
+  NULL,
   base_change_node_prop,
   base_props_changed,
   base_dir_entries,
@@ -5542,6 +5544,7 @@ static root_vtable_t root_vtable = {
   base_get_file_delta_stream,
   base_merge,
   base_get_mergeinfo,
+  NULL                                    /* dir_entries_full */
 };
 
 
@@ -24,11 +24,17 @@
 
 #include <assert.h>
 
+#include <apr_thread_cond.h>
+#include <apr_portable.h>
+
 #include "svn_hash.h"
 #include "svn_ctype.h"
 #include "svn_sorts.h"
+#include "private/svn_cache.h"
 #include "private/svn_delta_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_mutex.h"
+#include "private/svn_perf.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_temp_serializer.h"
@@ -379,6 +385,42 @@ svn_fs_fs__fixup_expanded_size(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__get_plain_rep_location(svn_boolean_t *available,
+                                  apr_file_t **file,
+                                  apr_off_t *offset,
+                                  svn_filesize_t *len,
+                                  svn_fs_t *fs,
+                                  representation_t *rep,
+                                  apr_pool_t *pool)
+{
+  svn_fs_fs__revision_file_t *rev_file;
+  svn_fs_fs__rep_header_t *rep_header;
+
+  *available = FALSE;
+
+  /* No rep means empty contents; uncommitted reps may still change. */
+  if (rep == NULL || svn_fs_fs__id_txn_used(&rep->txn_id))
+    return SVN_NO_ERROR;
+
+  /* Look at the representation header to see whether this is a fulltext. */
+  SVN_ERR(open_and_seek_representation(&rev_file, fs, rep, pool));
+  SVN_ERR(svn_fs_fs__read_rep_header(&rep_header, rev_file->stream,
+                                     pool, pool));
+  if (rep_header->type != svn_fs_fs__rep_plain)
+    return svn_error_trace(svn_fs_fs__close_revision_file(rev_file));
+
+  /* PLAIN rep.  Reading the header moved the file pointer to the first
+     fulltext byte. */
+  SVN_ERR(svn_io_file_get_offset(offset, rev_file->file, pool));
+
+  *file = rev_file->file;
+  *len = rep->size;
+  *available = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
 /* Correct known issues with committed NODEREV in FS.
  * Uses SCRATCH_POOL for temporaries.
  */
@@ -417,6 +459,21 @@ get_node_revision_body(node_revision_t **noderev_p,
   if (svn_fs_fs__id_is_txn(id))
     {
       apr_file_t *file;
+      const char *txn_key = NULL;
+
+      /* We may have read or written this noderev before within the same
+       * transaction.  If so, skip the disk access. */
+      if (ffd->txn_node_cache)
+        {
+          txn_key = svn_fs_fs__id_unparse(id, scratch_pool)->data;
+          SVN_ERR(svn_cache__get((void **) noderev_p,
+                                 &is_cached,
+                                 ffd->txn_node_cache,
+                                 txn_key,
+                                 result_pool));
+          if (is_cached)
+            return SVN_NO_ERROR;
+        }
 
       /* This is a transaction node-rev.  Its storage logic is very
          different from that of rev / pack files. */
@@ -440,6 +497,14 @@ get_node_revision_body(node_revision_t **noderev_p,
                                                                FALSE,
                                                                scratch_pool),
                                       result_pool, scratch_pool));
+
+      /* The noderev is not in cache, yet. Add it, if caching has been
+         enabled. */
+      if (ffd->txn_node_cache)
+        SVN_ERR(svn_cache__set(ffd->txn_node_cache,
+                               txn_key,
+                               *noderev_p,
+                               scratch_pool));
     }
   else
     {
@@ -1165,6 +1230,195 @@ svn_fs_fs__rep_chain_length(int *chain_length,
   return SVN_NO_ERROR;
 }
 
+/* Maximum number of reconstructions tracked concurrently per filesystem.
+ * If the table is full, further reconstructions simply proceed without
+ * single-flighting - correct, just not deduplicated. */
+#define INFLIGHT_REPS_MAX 16
+
+/* One fulltext reconstruction currently in progress. */
+typedef struct inflight_rep_t
+{
+  /* The fulltext cache key of the rep being reconstructed. */
+  pair_cache_key_t key;
+
+#if APR_HAS_THREADS
+  /* The thread doing the reconstruction.  A thread reading the same rep
+   * through two streams at once must not wait for itself. */
+  apr_os_thread_t owner;
+#endif
+} inflight_rep_t;
+
+/* Process-wide registry of fulltext reconstructions in progress for one
+ * filesystem, lives in the common pool.  See fs_fs_shared_data_t. */
+struct svn_fs_fs__inflight_reps_t
+{
+  /* Protects all members below. */
+  svn_mutex__t *mutex;
+
+#if APR_HAS_THREADS
+  /* Signalled whenever an entry has been removed from ENTRIES. */
+  apr_thread_cond_t *cond;
+#endif
+
+  /* The first COUNT elements describe the reconstructions in progress. */
+  inflight_rep_t entries[INFLIGHT_REPS_MAX];
+  int count;
+};
+
+svn_error_t *
+svn_fs_fs__inflight_reps_create(struct svn_fs_fs__inflight_reps_t **table,
+                                apr_pool_t *result_pool)
+{
+  struct svn_fs_fs__inflight_reps_t *result
+    = apr_pcalloc(result_pool, sizeof(*result));
+
+  SVN_ERR(svn_mutex__init(&result->mutex, TRUE, result_pool));
+
+#if APR_HAS_THREADS
+  {
+    apr_status_t status = apr_thread_cond_create(&result->cond, result_pool);
+    if (status)
+      return svn_error_wrap_apr(status, _("Can't create condition variable"));
+  }
+#endif
+
+  *table = result;
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Return the index of KEY in TABLE or -1 if there is no such entry.
+ * The caller must hold TABLE->MUTEX. */
+static int
+inflight_rep_find(struct svn_fs_fs__inflight_reps_t *table,
+                  const pair_cache_key_t *key)
+{
+  int i;
+  for (i = 0; i < table->count; ++i)
+    if (   table->entries[i].key.revision == key->revision
+        && table->entries[i].key.second == key->second)
+      return i;
+
+  return -1;
+}
+
+#endif
+
+/* How long a reader may wait for another thread's reconstruction of the
+ * same fulltext.  The other thread de-registers only once its client has
+ * consumed the entire stream, which may take arbitrarily long over a slow
+ * or stalled connection - so the wait must be bounded and we fall back to
+ * reconstructing the text ourselves: duplicated work, but correct and not
+ * hostage to somebody else's network pace. */
+#define INFLIGHT_REP_TIMEOUT apr_time_from_msec(500)
+
+/* Single-flight entry point:  If another thread is currently
+ * reconstructing the rep addressed by KEY, block for a limited time and
+ * report that in *WAITED - the caller should then re-try its cache
+ * lookup.  Otherwise, register the reconstruction in TABLE and set
+ * *REGISTERED; the caller must eventually de-register it through
+ * inflight_rep_end().  Without thread support, this is a no-op. */
+static svn_error_t *
+inflight_rep_begin(svn_boolean_t *registered,
+                   svn_boolean_t *waited,
+                   struct svn_fs_fs__inflight_reps_t *table,
+                   const pair_cache_key_t *key)
+{
+#if APR_HAS_THREADS
+  apr_time_t deadline = 0;
+#endif
+
+  *registered = FALSE;
+  *waited = FALSE;
+
+#if APR_HAS_THREADS
+  SVN_ERR(svn_mutex__lock(table->mutex));
+
+  while (TRUE)
+    {
+      int i = inflight_rep_find(table, key);
+      if (i >= 0)
+        {
+          apr_status_t status;
+          apr_time_t now;
+
+          /* Don't wait for our own thread - that would deadlock. */
+          if (apr_os_thread_equal(table->entries[i].owner,
+                                  apr_os_thread_current()))
+            break;
+
+          /* Once the time budget is used up, simply proceed without
+           * registration: the key is taken, and a second entry for it
+           * would confuse inflight_rep_end(). */
+          now = apr_time_now();
+          if (deadline == 0)
+            deadline = now + INFLIGHT_REP_TIMEOUT;
+          else if (now >= deadline)
+            break;
+
+          *waited = TRUE;
+          status = apr_thread_cond_timedwait(table->cond,
+                                             svn_mutex__get(table->mutex),
+                                             deadline - now);
+          if (status && !APR_STATUS_IS_TIMEUP(status))
+            return svn_error_trace(svn_mutex__unlock(table->mutex,
+                        svn_error_wrap_apr(status,
+                                _("Can't wait on condition variable"))));
+
+          /* Spurious wake-ups are handled by simply looking again. */
+          continue;
+        }
+
+      if (table->count < INFLIGHT_REPS_MAX)
+        {
+          table->entries[table->count].key = *key;
+          table->entries[table->count].owner = apr_os_thread_current();
+          table->count++;
+          *registered = TRUE;
+        }
+
+      break;
+    }
+
+  SVN_ERR(svn_mutex__unlock(table->mutex, SVN_NO_ERROR));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* De-register the reconstruction of the rep addressed by KEY from TABLE
+ * and wake up everybody waiting for it.  No-op if there is no such
+ * registration (anymore). */
+static svn_error_t *
+inflight_rep_end(struct svn_fs_fs__inflight_reps_t *table,
+                 const pair_cache_key_t *key)
+{
+#if APR_HAS_THREADS
+  int i;
+
+  SVN_ERR(svn_mutex__lock(table->mutex));
+
+  i = inflight_rep_find(table, key);
+  if (i >= 0)
+    {
+      apr_status_t status;
+
+      table->entries[i] = table->entries[--table->count];
+      status = apr_thread_cond_broadcast(table->cond);
+      if (status)
+        return svn_error_trace(svn_mutex__unlock(table->mutex,
+                    svn_error_wrap_apr(status,
+                            _("Can't broadcast condition variable"))));
+    }
+
+  SVN_ERR(svn_mutex__unlock(table->mutex, SVN_NO_ERROR));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 struct rep_read_baton
 {
   /* The FS from which we're reading. */
@@ -1221,6 +1475,18 @@ struct rep_read_baton
      window stream before we continue normal operation. */
   svn_filesize_t fulltext_delivered;
 
+  /* TRUE while this reconstruction is registered in the shared in-flight
+     table, i.e. while concurrent readers of the same rep are waiting for
+     us to populate the fulltext cache. */
+  svn_boolean_t inflight_registered;
+
+  /* Reconstruction cost bookkeeping, used to pick the fulltext cache
+     admission priority:  total number of delta windows fetched and
+     combined for this rep, and total number of bytes produced while
+     applying them. */
+  apr_uint64_t windows_combined;
+  apr_uint64_t windows_bytes_written;
+
   /* Used for temporary allocations during the read. */
   apr_pool_t *pool;
 
@@ -1341,6 +1607,66 @@ get_cached_window(svn_txdelta_window_t **window_p,
   return SVN_NO_ERROR;
 }
 
+/* Try to fetch the windows number CHUNK_INDEX for all representations
+ * in RS_LIST from the txdelta window cache in a single batch lookup.
+ * Return them in *WINDOWS with one element per representation; elements
+ * for windows that could not be found in cache will be NULL.  The rep
+ * states in RS_LIST remain untouched - it is up to the caller to update
+ * them for the windows it actually consumes.  Allocate the windows in
+ * RESULT_POOL and use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+get_cached_windows(apr_array_header_t **windows,
+                   apr_array_header_t *rs_list,
+                   int chunk_index,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  svn_cache__t *window_cache = NULL;
+  window_cache_key_t *keys;
+  const void **key_ptrs;
+  void **values;
+  svn_boolean_t *found;
+  int i;
+
+  *windows = apr_array_make(result_pool, rs_list->nelts,
+                            sizeof(svn_fs_fs__txdelta_cached_window_t *));
+
+  keys = apr_pcalloc(scratch_pool, rs_list->nelts * sizeof(*keys));
+  key_ptrs = apr_palloc(scratch_pool, rs_list->nelts * sizeof(*key_ptrs));
+  values = apr_palloc(scratch_pool, rs_list->nelts * sizeof(*values));
+  found = apr_palloc(scratch_pool, rs_list->nelts * sizeof(*found));
+
+  for (i = 0; i < rs_list->nelts; ++i)
+    {
+      rep_state_t *rs = APR_ARRAY_IDX(rs_list, i, rep_state_t *);
+
+      /* All reps that enabled caching at all use the same instance. */
+      if (rs->window_cache)
+        {
+          window_cache = rs->window_cache;
+          get_window_key(&keys[i], rs);
+          keys[i].chunk_index = chunk_index;
+          key_ptrs[i] = &keys[i];
+        }
+      else
+        {
+          /* txdelta window has not been enabled for this rep */
+          key_ptrs[i] = NULL;
+        }
+    }
+
+  if (window_cache)
+    SVN_ERR(svn_cache__get_many(values, found, window_cache, key_ptrs,
+                                rs_list->nelts, result_pool));
+
+  for (i = 0; i < rs_list->nelts; ++i)
+    APR_ARRAY_PUSH(*windows, svn_fs_fs__txdelta_cached_window_t *)
+      = (window_cache && found[i]) ? values[i] : NULL;
+
+  return SVN_NO_ERROR;
+}
+
 /* Store the WINDOW read for the rep state RS in the current FSFS
  * session's cache.  This will be a no-op if no cache has been given.
  * Temporary allocations will be made from SCRATCH_POOL. */
@@ -1533,7 +1859,10 @@ rep_read_get_baton(struct rep_read_baton **rb_p,
   b->filehandle_pool = svn_pool_create(pool);
   b->fulltext_cache = NULL;
   b->fulltext_delivered = 0;
+  b->inflight_registered = FALSE;
   b->current_fulltext = NULL;
+  b->windows_combined = 0;
+  b->windows_bytes_written = 0;
 
   /* Save our output baton. */
   *rb_p = b;
@@ -1541,6 +1870,92 @@ rep_read_get_baton(struct rep_read_baton **rb_p,
   return SVN_NO_ERROR;
 }
 
+/* qsort()-compatible comparison function, ordering rep_state_t elements
+ * by revision and item index, i.e. roughly by on-disk position. */
+static int
+compare_rep_position(const void *lhs,
+                     const void *rhs)
+{
+  const rep_state_t *lhs_rs = *(const rep_state_t *const *)lhs;
+  const rep_state_t *rhs_rs = *(const rep_state_t *const *)rhs;
+
+  if (lhs_rs->revision != rhs_rs->revision)
+    return lhs_rs->revision < rhs_rs->revision ? -1 : 1;
+
+  if (lhs_rs->item_index != rhs_rs->item_index)
+    return lhs_rs->item_index < rhs_rs->item_index ? -1 : 1;
+
+  return 0;
+}
+
+/* Prefetch the svndiff data for all reps in RS_LIST into the window
+ * caches.  The delta combiner will walk the chain from the newest to
+ * the oldest rep for every window, paying one disk seek per step on a
+ * cold cache.  Issuing the block reads for the whole chain up front -
+ * in on-disk order - turns that serial seek pattern into one mostly
+ * sequential sweep and makes the subsequent window reads cache hits.
+ * This is a no-op unless the block-read feature is active.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+prefetch_rep_list(apr_array_header_t *rs_list,
+                  apr_pool_t *scratch_pool)
+{
+  int i;
+  apr_array_header_t *to_fetch;
+  apr_pool_t *iterpool;
+
+  /* Select the reps actually worth prefetching. */
+  to_fetch = apr_array_make(scratch_pool, rs_list->nelts,
+                            sizeof(rep_state_t *));
+  for (i = 0; i < rs_list->nelts; ++i)
+    {
+      rep_state_t *rs = APR_ARRAY_IDX(rs_list, i, rep_state_t *);
+      window_cache_key_t key = { 0 };
+      svn_boolean_t found = FALSE;
+
+      /* Prefetching only works for committed reps and requires the
+         block / window caches to keep the data for the combiner. */
+      if (   !SVN_IS_VALID_REVNUM(rs->revision)
+          || !rs->raw_window_cache
+          || !rs->window_cache
+          || !use_block_read(rs->sfile->fs))
+        continue;
+
+      /* Reps whose first window is already cached will be served from
+         the cache anyway - don't touch the disk for them. */
+      get_window_key(&key, rs);
+      SVN_ERR(svn_cache__has_key(&found, rs->window_cache, &key,
+                                 scratch_pool));
+      if (!found)
+        SVN_ERR(svn_cache__has_key(&found, rs->raw_window_cache, &key,
+                                   scratch_pool));
+
+      if (!found)
+        APR_ARRAY_PUSH(to_fetch, rep_state_t *) = rs;
+    }
+
+  /* A single uncached rep does not benefit from being read early. */
+  if (to_fetch->nelts < 2)
+    return SVN_NO_ERROR;
+
+  /* Read the blocks in on-disk order. */
+  svn_sort__array(to_fetch, compare_rep_position);
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < to_fetch->nelts; ++i)
+    {
+      rep_state_t *rs = APR_ARRAY_IDX(to_fetch, i, rep_state_t *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(auto_open_shared_file(rs->sfile));
+      SVN_ERR(block_read(NULL, rs->sfile->fs, rs->revision, rs->item_index,
+                         rs->sfile->rfile, iterpool, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Skip forwards to THIS_CHUNK in REP_STATE and then read the next delta
    window into *NWIN.  Note that RS->CHUNK_INDEX will be THIS_CHUNK rather
    than THIS_CHUNK + 1 when this function returns. */
@@ -1640,6 +2055,7 @@ read_plain_window(svn_stringbuf_t **nwin, rep_state_t *rs,
                   apr_pool_t *scratch_pool)
 {
   apr_off_t offset;
+  const char *mapped;
 
   /* RS->FILE may be shared between RS instances -> make sure we point
    * to the right data. */
@@ -1647,12 +2063,22 @@ read_plain_window(svn_stringbuf_t **nwin, rep_state_t *rs,
   SVN_ERR(auto_set_start_offset(rs, scratch_pool));
 
   offset = rs->start + rs->current;
-  SVN_ERR(rs_aligned_seek(rs, NULL, offset, scratch_pool));
 
   /* Read the plain data. */
   *nwin = svn_stringbuf_create_ensure(size, result_pool);
-  SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, (*nwin)->data, size,
-                                 NULL, NULL, result_pool));
+  SVN_ERR(svn_fs_fs__rev_file_mapped_range(&mapped, rs->sfile->rfile,
+                                           offset, size));
+  if (mapped)
+    {
+      /* Copy straight from the memory mapping - no syscalls involved. */
+      memcpy((*nwin)->data, mapped, size);
+    }
+  else
+    {
+      SVN_ERR(rs_aligned_seek(rs, NULL, offset, scratch_pool));
+      SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, (*nwin)->data,
+                                     size, NULL, NULL, result_pool));
+    }
   (*nwin)->data[size] = 0;
 
   /* Update RS. */
@@ -1682,6 +2108,7 @@ get_combined_window(svn_stringbuf_t **result,
   apr_pool_t *pool, *new_pool, *window_pool;
   int i;
   apr_array_header_t *windows;
+  apr_array_header_t *cached_windows;
   svn_stringbuf_t *source, *buf = rb->base_window;
   rep_state_t *rs;
   apr_pool_t *iterpool;
@@ -1693,15 +2120,76 @@ get_combined_window(svn_stringbuf_t **result,
   window_pool = svn_pool_create(rb->pool);
   windows = apr_array_make(window_pool, 0, sizeof(svn_txdelta_window_t *));
   iterpool = svn_pool_create(rb->pool);
+
+  /* Another reader may have already combined this very chunk of this
+     very rep - the combination loop below caches its final result per
+     chunk.  If so, use the cached chunk and leave the deeper chain
+     levels alone; read_delta_window() can skip forward should a later
+     chunk miss the cache.  A PLAIN base rep, however, is read strictly
+     sequentially and would go out of sync, hence the SRC_STATE
+     restriction. */
+  if (rb->src_state == NULL && rb->rs_list->nelts > 0)
+    {
+      svn_boolean_t is_cached = FALSE;
+
+      rs = APR_ARRAY_IDX(rb->rs_list, 0, rep_state_t *);
+      if (rs->combined_cache && SVN_IS_VALID_REVNUM(rs->revision))
+        {
+          window_cache_key_t key = { 0 };
+          get_window_key(&key, rs);
+          key.chunk_index = rb->chunk_index;
+          SVN_ERR(svn_cache__get((void **)&buf, &is_cached,
+                                 rs->combined_cache, &key, rb->pool));
+        }
+
+      if (is_cached)
+        {
+          svn_txdelta_window_t *window;
+
+          /* We must still move the top-level rep past this chunk's
+             window to keep its read position in sync for subsequent
+             chunks.  This will usually be a txdelta window cache hit. */
+          SVN_ERR(read_delta_window(&window, rb->chunk_index, rs,
+                                    iterpool, iterpool));
+          rs->chunk_index++;
+          rb->windows_combined++;
+
+          svn_pool_destroy(iterpool);
+          svn_pool_destroy(window_pool);
+
+          *result = buf;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  /* Probe the txdelta window cache for the whole delta chain in a single
+     batched lookup instead of one lookup per rep. */
+  SVN_ERR(get_cached_windows(&cached_windows, rb->rs_list, rb->chunk_index,
+                             window_pool, iterpool));
+
   for (i = 0; i < rb->rs_list->nelts; ++i)
     {
       svn_txdelta_window_t *window;
+      svn_fs_fs__txdelta_cached_window_t *cached_window
+        = APR_ARRAY_IDX(cached_windows, i,
+                        svn_fs_fs__txdelta_cached_window_t *);
 
       svn_pool_clear(iterpool);
 
       rs = APR_ARRAY_IDX(rb->rs_list, i, rep_state_t *);
-      SVN_ERR(read_delta_window(&window, rb->chunk_index, rs, window_pool,
-                                iterpool));
+      if (cached_window)
+        {
+          window = cached_window->window;
+
+          /* manipulate the RS as if we just read the data */
+          rs->current = cached_window->end_offset;
+          rs->chunk_index = rb->chunk_index;
+        }
+      else
+        {
+          SVN_ERR(read_delta_window(&window, rb->chunk_index, rs,
+                                    window_pool, iterpool));
+        }
 
       APR_ARRAY_PUSH(windows, svn_txdelta_window_t *) = window;
       if (window->src_ops == 0)
@@ -1711,6 +2199,9 @@ get_combined_window(svn_stringbuf_t **result,
         }
     }
 
+  /* Remember how deep into the chain we actually had to go. */
+  rb->windows_combined += windows->nelts;
+
   /* Combine in the windows from the other delta reps. */
   pool = svn_pool_create(rb->pool);
   for (--i; i >= 0; --i)
@@ -1749,6 +2240,7 @@ get_combined_window(svn_stringbuf_t **result,
 
       svn_txdelta_apply_instructions(window, source ? source->data : NULL,
                                      buf->data, &buf->len);
+      rb->windows_bytes_written += buf->len;
       if (buf->len != window->tview_len)
         return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
                                 _("svndiff window length is "
@@ -1760,6 +2252,14 @@ get_combined_window(svn_stringbuf_t **result,
       if (   (rb->chunk_index == 0) && (rs->current == rs->size)
           && SVN_IS_VALID_REVNUM(rs->revision))
         SVN_ERR(set_cached_combined_window(buf, rs, new_pool));
+      else if (   i == 0
+               && rb->src_state == NULL
+               && SVN_IS_VALID_REVNUM(rs->revision))
+        /* For multi-chunk reps, cache the fully combined chunk of the
+           requested rep itself.  Other readers of the same hot file can
+           then skip the recombination of the whole chain for this chunk
+           (see the shortcut above). */
+        SVN_ERR(set_cached_combined_window(buf, rs, new_pool));
 
       rs->chunk_index++;
 
@@ -1785,6 +2285,42 @@ fulltext_size_is_cachable(fs_fs_data_t *ffd, svn_filesize_t size)
       && svn_cache__is_cachable(ffd->fulltext_cache, (apr_size_t)size);
 }
 
+/* De-register RB's reconstruction from the shared in-flight table if it
+ * is still registered.  Idempotent. */
+static svn_error_t *
+release_inflight_rep(struct rep_read_baton *rb)
+{
+  if (rb->inflight_registered)
+    {
+      fs_fs_data_t *ffd = rb->fs->fsap_data;
+
+      rb->inflight_registered = FALSE;
+      SVN_ERR(inflight_rep_end(ffd->shared->inflight_reps,
+                               &rb->fulltext_cache_key));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Pool cleanup handler on the rep_read_baton's scratch pool:  Make sure
+ * that even an abandoned or failed stream does not leave its in-flight
+ * registration behind, blocking other readers indefinitely. */
+static apr_status_t
+cleanup_inflight_rep(void *baton)
+{
+  struct rep_read_baton *rb = baton;
+  svn_error_t *err = release_inflight_rep(rb);
+
+  if (err)
+    {
+      apr_status_t result = err->apr_err;
+      svn_error_clear(err);
+      return result;
+    }
+
+  return APR_SUCCESS;
+}
+
 /* Close method used on streams returned by read_representation().
  */
 static svn_error_t *
@@ -2101,6 +2637,33 @@ skip_contents(struct rep_read_baton *baton,
   return svn_error_trace(err);
 }
 
+/* Return the fulltext cache priority class for the contents that RB has
+   just reconstructed.  The idea is to let cheap-to-rebuild fulltexts
+   yield cache space to expensive ones:  a plain rep or a self-contained
+   single window costs little more than a file read, while a deep delta
+   chain costs one window fetch plus one combine step per chain element
+   and per 100kB chunk. */
+static apr_uint32_t
+fulltext_cache_priority(struct rep_read_baton *rb)
+{
+  /* Average number of windows combined per delivered chunk, i.e. the
+     effective depth of the delta chain.  Round the chunk count up so
+     short fulltexts count as one chunk. */
+  apr_uint64_t chunks = rb->len / SVN_DELTA_WINDOW_SIZE + 1;
+  apr_uint64_t depth = rb->windows_combined / chunks;
+
+  /* Deep chains, as well as chains that shuffled many times the final
+     fulltext size through the combiner, are expensive to re-create. */
+  if (depth >= 8 || rb->windows_bytes_written > 8 * (apr_uint64_t)rb->len)
+    return SVN_CACHE__MEMBUFFER_HIGH_PRIORITY;
+
+  /* Re-creating this fulltext takes hardly more than re-reading it. */
+  if (depth <= 1)
+    return SVN_CACHE__MEMBUFFER_LOW_PRIORITY;
+
+  return SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY;
+}
+
 /* BATON is of type `rep_read_baton'; read the next *LEN bytes of the
    representation and store them in *BUF.  Sum as we read and verify
    the MD5 sum at the end.  This is a READ_FULL_FN for svn_stream_t. */
@@ -2120,8 +2683,35 @@ rep_read_contents(void *baton,
       if (cached)
         return SVN_NO_ERROR;
 
-      /* Cache miss.  From now on, we will never read from the fulltext
-       * cache for this representation anymore. */
+      /* Cache miss.  If another thread is already reconstructing these
+       * very contents, wait for it to finish and re-try the cache
+       * instead of duplicating its work.  Either way, register our own
+       * reconstruction so later readers can wait for us in turn. */
+      if (!rb->inflight_registered)
+        {
+          svn_boolean_t waited;
+          fs_fs_data_t *ffd = rb->fs->fsap_data;
+
+          SVN_ERR(inflight_rep_begin(&rb->inflight_registered, &waited,
+                                     ffd->shared->inflight_reps,
+                                     &rb->fulltext_cache_key));
+          if (rb->inflight_registered)
+            apr_pool_cleanup_register(rb->pool, rb, cleanup_inflight_rep,
+                                      apr_pool_cleanup_null);
+
+          if (waited)
+            {
+              SVN_ERR(get_contents_from_fulltext(&cached, rb, buf, len));
+              if (cached)
+                {
+                  SVN_ERR(release_inflight_rep(rb));
+                  return SVN_NO_ERROR;
+                }
+            }
+        }
+
+      /* From now on, we will never read from the fulltext cache for
+       * this representation anymore. */
       rb->fulltext_cache = NULL;
     }
 
@@ -2129,11 +2719,19 @@ rep_read_contents(void *baton,
   if (!rb->rs_list)
     {
       /* Window stream not initialized, yet.  Do it now. */
+      apr_pool_t *scratch_pool;
+
       rb->len = rb->rep.expanded_size;
       SVN_ERR(build_rep_list(&rb->rs_list, &rb->base_window,
                              &rb->src_state, rb->fs, &rb->rep,
                              rb->filehandle_pool));
 
+      /* Now that the delta chain is known, issue the reads for all its
+       * windows ahead of the combiner. */
+      scratch_pool = svn_pool_create(rb->pool);
+      SVN_ERR(prefetch_rep_list(rb->rs_list, scratch_pool));
+      svn_pool_destroy(scratch_pool);
+
       /* In case we did read from the fulltext cache before, make the
        * window stream catch up.  Also, initialize the fulltext buffer
        * if we want to cache the fulltext at the end. */
@@ -2202,9 +2800,15 @@ rep_read_contents(void *baton,
   if (rb->off == rb->len && rb->current_fulltext)
     {
       fs_fs_data_t *ffd = rb->fs->fsap_data;
-      SVN_ERR(svn_cache__set(ffd->fulltext_cache, &rb->fulltext_cache_key,
-                             rb->current_fulltext, rb->pool));
+      SVN_ERR(svn_cache__set_with_priority(ffd->fulltext_cache,
+                                           &rb->fulltext_cache_key,
+                                           rb->current_fulltext,
+                                           fulltext_cache_priority(rb),
+                                           rb->pool));
       rb->current_fulltext = NULL;
+
+      /* The cache can satisfy waiting readers now; unblock them. */
+      SVN_ERR(release_inflight_rep(rb));
     }
 
   return SVN_NO_ERROR;
@@ -2217,6 +2821,10 @@ svn_fs_fs__get_contents(svn_stream_t **contents_p,
                         svn_boolean_t cache_fulltext,
                         apr_pool_t *pool)
 {
+  /* The construction below is cheap; the interesting part is how often
+   * contents are requested at all, e.g. when judging cache sizes. */
+  SVN_PERF_COUNT(svn_perf__probe_fs_get_contents);
+
   if (! rep)
     {
       *contents_p = svn_stream_empty(pool);
@@ -2483,11 +3091,27 @@ svn_fs_fs__get_file_delta_stream(svn_txdelta_stream_t **stream_p,
   rep_state_t *rep_state;
   svn_fs_fs__rep_header_t *rep_header;
   fs_fs_data_t *ffd = fs->fsap_data;
+  svn_boolean_t target_is_cached = FALSE;
+
+  /* When no SOURCE is given, we may serve the request either from a stored
+     self-delta or from the fulltext cache.  Prefer the cache only if it
+     actually holds the contents; otherwise, forwarding the stored delta is
+     much cheaper than reconstructing the fulltext and re-deltifying it. */
+  if (!source && target->data_rep && ffd->fulltext_cache
+      && SVN_IS_VALID_REVNUM(target->data_rep->revision)
+      && fulltext_size_is_cachable(ffd, target->data_rep->expanded_size))
+    {
+      pair_cache_key_t fulltext_cache_key = { 0 };
+
+      fulltext_cache_key.revision = target->data_rep->revision;
+      fulltext_cache_key.second = target->data_rep->item_index;
+      SVN_ERR(svn_cache__has_key(&target_is_cached, ffd->fulltext_cache,
+                                 &fulltext_cache_key, pool));
+    }
 
   /* Try a shortcut: if the target is stored as a delta against the source,
-     then just use that delta.  However, prefer using the fulltext cache
-     whenever that is available. */
-  if (target->data_rep && (source || ! ffd->fulltext_cache))
+     then just use that delta. */
+  if (target->data_rep && (source || ! target_is_cached))
     {
       /* Read target's base rep if any. */
       SVN_ERR(create_rep_state(&rep_state, &rep_header, NULL,
@@ -2834,6 +3458,132 @@ locate_dir_cache(svn_fs_t *fs,
     }
 }
 
+/* Number of entries per block in the sharded representation of
+ * directories too large for the regular directory cache. */
+#define DIR_ENTRIES_PER_BLOCK 1024
+
+/* Store the committed directory contents DIR of NODEREV in FS in the
+ * block-sharded caches: one svn_fs_fs__dir_data_t per block of up to
+ * DIR_ENTRIES_PER_BLOCK sorted entries plus an index of the first entry
+ * name in each block.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+block_cache_dir(svn_fs_t *fs,
+                node_revision_t *noderev,
+                svn_fs_fs__dir_data_t *dir,
+                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  pair_cache_key_t pair_key = { 0 };
+  dir_block_key_t block_key = { 0 };
+  svn_fs_fs__dir_index_t dir_index;
+  apr_int64_t block;
+
+  dir_index.count = dir->entries->nelts;
+  dir_index.block_count = (dir_index.count + DIR_ENTRIES_PER_BLOCK - 1)
+                          / DIR_ENTRIES_PER_BLOCK;
+  dir_index.names = apr_palloc(scratch_pool,
+                               dir_index.block_count
+                                 * sizeof(*dir_index.names));
+
+  block_key.revision = noderev->data_rep->revision;
+  block_key.item_index = noderev->data_rep->item_index;
+
+  for (block = 0; block < dir_index.block_count; ++block)
+    {
+      svn_fs_fs__dir_data_t block_dir;
+      int first = (int)(block * DIR_ENTRIES_PER_BLOCK);
+      int count = MIN(DIR_ENTRIES_PER_BLOCK, dir->entries->nelts - first);
+
+      /* Wrap the sub-range as a "proper" APR array - without copying
+       * the entries. */
+      apr_array_header_t *sub
+        = apr_array_make(scratch_pool, 0, sizeof(svn_fs_dirent_t *));
+      sub->elts = dir->entries->elts + first * sub->elt_size;
+      sub->nelts = count;
+      sub->nalloc = count;
+
+      dir_index.names[block]
+        = APR_ARRAY_IDX(sub, 0, svn_fs_dirent_t *)->name;
+
+      block_dir.entries = sub;
+      block_dir.txn_filesize = SVN_INVALID_FILESIZE;
+
+      block_key.block = block;
+      SVN_ERR(svn_cache__set(ffd->dir_block_cache, &block_key, &block_dir,
+                             scratch_pool));
+    }
+
+  /* Store the index last such that it will only refer to blocks that
+   * have at least been cached once. */
+  pair_key.revision = noderev->data_rep->revision;
+  pair_key.second = noderev->data_rep->item_index;
+  SVN_ERR(svn_cache__set(ffd->dir_index_cache, &pair_key, &dir_index,
+                         scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Try to find the directory entry NAME of the committed NODEREV in FS
+ * in the block-sharded directory caches.  If the lookup gave a definite
+ * answer, set *FOUND to TRUE and *DIRENT to the entry, allocated in
+ * RESULT_POOL, or to NULL if the entry does not exist.  Set *FOUND to
+ * FALSE otherwise.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+block_cached_dir_entry(svn_fs_dirent_t **dirent,
+                       svn_boolean_t *found,
+                       svn_fs_t *fs,
+                       node_revision_t *noderev,
+                       const char *name,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  pair_cache_key_t pair_key = { 0 };
+  dir_block_key_t block_key = { 0 };
+  extract_dir_entry_baton_t baton;
+  apr_int64_t block;
+  svn_boolean_t index_found;
+
+  *found = FALSE;
+
+  /* Which block may contain NAME? */
+  pair_key.revision = noderev->data_rep->revision;
+  pair_key.second = noderev->data_rep->item_index;
+  SVN_ERR(svn_cache__get_partial((void **)&block, &index_found,
+                                 ffd->dir_index_cache, &pair_key,
+                                 svn_fs_fs__find_dir_block,
+                                 (void *)name, scratch_pool));
+  if (! index_found)
+    return SVN_NO_ERROR;
+
+  if (block < 0)
+    {
+      /* NAME sorts before all entries in the directory, i.e. the index
+       * is authoritative for the miss. */
+      *dirent = NULL;
+      *found = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  /* Look for NAME in the only block that may contain it.  A hit with a
+   * NULL entry is authoritative as well because the block covers the
+   * whole name range assigned to it by the index. */
+  block_key.revision = noderev->data_rep->revision;
+  block_key.item_index = noderev->data_rep->item_index;
+  block_key.block = block;
+
+  baton.name = name;
+  baton.txn_filesize = SVN_INVALID_FILESIZE;
+  SVN_ERR(svn_cache__get_partial((void **)dirent, found,
+                                 ffd->dir_block_cache, &block_key,
+                                 svn_fs_fs__extract_dir_entry, &baton,
+                                 result_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__rep_contents_dir(apr_array_header_t **entries_p,
                             svn_fs_t *fs,
@@ -2841,6 +3591,7 @@ svn_fs_fs__rep_contents_dir(apr_array_header_t **entries_p,
                             apr_pool_t *result_pool,
                             apr_pool_t *scratch_pool)
 {
+  fs_fs_data_t *ffd = fs->fsap_data;
   pair_cache_key_t pair_key = { 0 };
   const void *key;
   svn_fs_fs__dir_data_t *dir;
@@ -2879,9 +3630,16 @@ svn_fs_fs__rep_contents_dir(apr_array_header_t **entries_p,
    *
    * Don't even attempt to serialize very large directories; it would cause
    * an unnecessary memory allocation peak.  150 bytes/entry is about right.
+   * Immutable directories of that size still get sharded into blocks to
+   * speed up future single-entry lookups.
    */
   if (cache && svn_cache__is_cachable(cache, 150 * dir->entries->nelts))
     SVN_ERR(svn_cache__set(cache, key, dir, scratch_pool));
+  else if (ffd->dir_index_cache
+           && dir->entries->nelts > 0
+           && noderev->data_rep
+           && ! svn_fs_fs__id_txn_used(&noderev->data_rep->txn_id))
+    SVN_ERR(block_cache_dir(fs, noderev, dir, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -2904,9 +3662,15 @@ svn_fs_fs__rep_contents_dir_entry(svn_fs_dirent_t **dirent,
                                   apr_pool_t *result_pool,
                                   apr_pool_t *scratch_pool)
 {
+  fs_fs_data_t *ffd = fs->fsap_data;
   extract_dir_entry_baton_t baton;
   svn_boolean_t found = FALSE;
 
+  /* May we use the block-sharded caches for this directory? */
+  svn_boolean_t committed
+    =    noderev->data_rep
+      && ! svn_fs_fs__id_txn_used(&noderev->data_rep->txn_id);
+
   /* find the cache we may use */
   pair_cache_key_t pair_key = { 0 };
   const void *key;
@@ -2929,6 +3693,15 @@ svn_fs_fs__rep_contents_dir_entry(svn_fs_dirent_t **dirent,
                                      result_pool));
     }
 
+  /* Directories too large for CACHE may still be cached in blocks
+   * (committed, i.e. immutable, directories only). */
+  if ((! found || baton.out_of_date) && committed && ffd->dir_index_cache)
+    {
+      baton.out_of_date = FALSE;
+      SVN_ERR(block_cached_dir_entry(dirent, &found, fs, noderev, name,
+                                     result_pool, scratch_pool));
+    }
+
   /* fetch data from disk if we did not find it in the cache */
   if (! found || baton.out_of_date)
     {
@@ -2944,9 +3717,13 @@ svn_fs_fs__rep_contents_dir_entry(svn_fs_dirent_t **dirent,
        *
        * Don't even attempt to serialize very large directories; it would
        * cause an unnecessary memory allocation peak.  150 bytes / entry is
-       * about right. */
+       * about right.  Shard immutable directories of that size into
+       * blocks instead such that the next lookup can be served from the
+       * cache after all. */
       if (cache && svn_cache__is_cachable(cache, 150 * dir.entries->nelts))
         SVN_ERR(svn_cache__set(cache, key, &dir, scratch_pool));
+      else if (committed && ffd->dir_index_cache && dir.entries->nelts > 0)
+        SVN_ERR(block_cache_dir(fs, noderev, &dir, scratch_pool));
 
       /* find desired entry and return a copy in POOL, if found */
       entry = svn_fs_fs__find_dir_entry(dir.entries, name, NULL);
@@ -3000,6 +3777,19 @@ svn_fs_fs__get_proplist(apr_hash_t **proplist_p,
       representation_t *rep = noderev->prop_rep;
       pair_cache_key_t key = { 0 };
 
+      /* Fast path for empty property lists.  They serialize to just the
+         terminator line, "END\n", i.e. 4 bytes.  EXPANDED_SIZE has been
+         made reliable by fixup_node_revision(), and no non-empty
+         property list can serialize to as few bytes, so we can return
+         the result without touching the rep layer or the cache.  Nodes
+         without properties are the common case; prop reads are issued
+         per node in every editor drive. */
+      if (rep->expanded_size == 4)
+        {
+          *proplist_p = apr_hash_make(pool);
+          return SVN_NO_ERROR;
+        }
+
       key.revision = rep->revision;
       key.second = rep->item_index;
       if (ffd->properties_cache && SVN_IS_VALID_REVNUM(rep->revision))
@@ -3197,6 +3987,380 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
   return SVN_NO_ERROR;
 }
 
+/* Set the 3 filter bits derived from HASH in the bit array BITS of
+ * SVN_FS_FS__CHANGES_BLOOM_BITS length. */
+static void
+bloom_insert(apr_uint64_t *bits,
+             apr_uint32_t hash)
+{
+  apr_uint32_t idx = hash & (SVN_FS_FS__CHANGES_BLOOM_BITS - 1);
+  apr_uint32_t step = ((hash >> 16) | 1) & (SVN_FS_FS__CHANGES_BLOOM_BITS - 1);
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      bits[idx / 64] |= ((apr_uint64_t)1 << (idx % 64));
+      idx = (idx + step) & (SVN_FS_FS__CHANGES_BLOOM_BITS - 1);
+    }
+}
+
+/* Return TRUE if all 3 filter bits derived from HASH are set in the bit
+ * array BITS of SVN_FS_FS__CHANGES_BLOOM_BITS length. */
+static svn_boolean_t
+bloom_test(const apr_uint64_t *bits,
+           apr_uint32_t hash)
+{
+  apr_uint32_t idx = hash & (SVN_FS_FS__CHANGES_BLOOM_BITS - 1);
+  apr_uint32_t step = ((hash >> 16) | 1) & (SVN_FS_FS__CHANGES_BLOOM_BITS - 1);
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      if (!(bits[idx / 64] & ((apr_uint64_t)1 << (idx % 64))))
+        return FALSE;
+      idx = (idx + step) & (SVN_FS_FS__CHANGES_BLOOM_BITS - 1);
+    }
+
+  return TRUE;
+}
+
+void
+svn_fs_fs__changes_bloom_add_path(svn_fs_fs__changes_bloom_t *bloom,
+                                  const char *path)
+{
+  apr_size_t len = strlen(path);
+  apr_size_t i;
+
+  bloom_insert(bloom->exact, svn__fnv1a_32(path, len));
+
+  /* Everything that has PATH in its sub-tree, i.e. PATH and each of its
+     parent directories, incl. "/". */
+  bloom_insert(bloom->subtree, svn__fnv1a_32(path, len));
+  for (i = len; i > 1; i--)
+    if (path[i - 1] == '/')
+      bloom_insert(bloom->subtree, svn__fnv1a_32(path, i - 1));
+  bloom_insert(bloom->subtree, svn__fnv1a_32("/", 1));
+}
+
+svn_boolean_t
+svn_fs_fs__changes_bloom_may_touch(const svn_fs_fs__changes_bloom_t *bloom,
+                                   const char *path)
+{
+  apr_size_t len = strlen(path);
+  apr_size_t i;
+
+  /* "/" is an ancestor of every change. */
+  if (len <= 1)
+    return TRUE;
+
+  /* PATH itself or one of its descendants changed? */
+  if (bloom_test(bloom->subtree, svn__fnv1a_32(path, len)))
+    return TRUE;
+
+  /* A proper ancestor of PATH changed, e.g. by a copy or a property
+     modification on a parent directory? */
+  for (i = len; i > 1; i--)
+    if (path[i - 1] == '/')
+      if (bloom_test(bloom->exact, svn__fnv1a_32(path, i - 1)))
+        return TRUE;
+
+  return bloom_test(bloom->exact, svn__fnv1a_32("/", 1));
+}
+
+svn_error_t *
+svn_fs_fs__get_changes_bloom(svn_fs_fs__changes_bloom_t **bloom_p,
+                             svn_fs_t *fs,
+                             svn_revnum_t rev,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_boolean_t found = FALSE;
+  svn_fs_fs__changes_bloom_t *bloom;
+  svn_fs_fs__changes_index_t *index;
+  svn_fs_fs__changes_context_t *context;
+  apr_array_header_t *offsets;
+  apr_array_header_t *first_paths;
+  svn_stringbuf_t *prev_path;
+  apr_pool_t *iterpool;
+
+  pair_cache_key_t key;
+  key.revision = rev;
+  key.second = 0;
+
+  /* try cache lookup first */
+
+  if (ffd->changes_bloom_cache)
+    {
+      SVN_ERR(svn_cache__get((void **)bloom_p, &found,
+                             ffd->changes_bloom_cache, &key, result_pool));
+      if (found)
+        return SVN_NO_ERROR;
+    }
+
+  /* Summarize the changed-paths list of REV.  While at it, record the
+     block directory of the list, i.e. the first path and start offset
+     of every block, so later readers may fetch individual blocks. */
+
+  bloom = apr_pcalloc(result_pool, sizeof(*bloom));
+  index = apr_pcalloc(scratch_pool, sizeof(*index));
+  index->sorted = TRUE;
+  offsets = apr_array_make(scratch_pool, 16, sizeof(apr_off_t));
+  first_paths = apr_array_make(scratch_pool, 16, sizeof(const char *));
+  prev_path = svn_stringbuf_create_empty(scratch_pool);
+  iterpool = svn_pool_create(scratch_pool);
+
+  SVN_ERR(svn_fs_fs__create_changes_context(&context, fs, rev, scratch_pool));
+  while (!context->eol)
+    {
+      apr_array_header_t *changes;
+      apr_off_t start_offset = context->next_offset;
+      int i;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__get_changes(&changes, context, iterpool, iterpool));
+      if (changes->nelts > 0)
+        {
+          change_t *first = APR_ARRAY_IDX(changes, 0, change_t *);
+          APR_ARRAY_PUSH(offsets, apr_off_t) = start_offset;
+          APR_ARRAY_PUSH(first_paths, const char *)
+            = apr_pstrdup(scratch_pool, first->path.data);
+        }
+
+      for (i = 0; i < changes->nelts; ++i)
+        {
+          change_t *change = APR_ARRAY_IDX(changes, i, change_t *);
+          svn_fs_fs__changes_bloom_add_path(bloom, change->path.data);
+
+          /* Committed lists should be sorted but e.g. old servers did
+             not guarantee that.  Verify instead of relying on it. */
+          if (   (i > 0 || context->next > changes->nelts)
+              && strcmp(prev_path->data, change->path.data) > 0)
+            index->sorted = FALSE;
+          svn_stringbuf_set(prev_path, change->path.data);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  index->count = offsets->nelts;
+  index->offsets = (apr_off_t *)offsets->elts;
+  index->paths = (const char **)first_paths->elts;
+
+  /* cache for future reference */
+
+  if (ffd->changes_bloom_cache)
+    SVN_ERR(svn_cache__set(ffd->changes_bloom_cache, &key, bloom,
+                           scratch_pool));
+  if (ffd->changes_index_cache)
+    SVN_ERR(svn_cache__set(ffd->changes_index_cache, &key, index,
+                           scratch_pool));
+
+  *bloom_p = bloom;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the index of the last block in INDEX whose first path is less
+ * than or equal to PATH, i.e. the only block that could contain an exact
+ * match for PATH.  INDEX must describe a sorted list with at least one
+ * block. */
+static int
+changes_index_lookup(const svn_fs_fs__changes_index_t *index,
+                     const char *path)
+{
+  int lower = 0;
+  int upper = index->count - 1;
+
+  while (lower < upper)
+    {
+      int current = lower + (upper - lower + 1) / 2;
+      if (strcmp(index->paths[current], path) <= 0)
+        lower = current;
+      else
+        upper = current - 1;
+    }
+
+  return lower;
+}
+
+/* Fetch the BLOCK-th block of the changed-paths list read by CONTEXT
+ * into *CHANGES, seeking directly to it using the offsets in INDEX.
+ * Allocate the result in RESULT_POOL and use SCRATCH_POOL for
+ * temporaries. */
+static svn_error_t *
+get_changes_block(apr_array_header_t **changes,
+                  svn_fs_fs__changes_context_t *context,
+                  const svn_fs_fs__changes_index_t *index,
+                  int block,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  context->next = (apr_size_t)block * SVN_FS_FS__CHANGES_BLOCK_SIZE;
+  context->next_offset = index->offsets[block];
+  context->eol = FALSE;
+
+  return svn_error_trace(svn_fs_fs__get_changes(changes, context,
+                                                result_pool, scratch_pool));
+}
+
+/* Scan the sorted block CHANGES for PATH (of LEN chars) itself or any
+ * of its descendants.  Set *TOUCHED if there is such a change.  Set
+ * *PAST_END if the block extends beyond the last path that could match,
+ * i.e. no further blocks need to be considered. */
+static void
+scan_block_for_subtree(svn_boolean_t *touched,
+                       svn_boolean_t *past_end,
+                       const apr_array_header_t *changes,
+                       const char *path,
+                       apr_size_t len)
+{
+  int i;
+
+  for (i = 0; i < changes->nelts; ++i)
+    {
+      const change_t *change = APR_ARRAY_IDX(changes, i, change_t *);
+      int diff = strncmp(change->path.data, path, len);
+
+      if (diff > 0)
+        {
+          *past_end = TRUE;
+          return;
+        }
+
+      if (diff == 0)
+        {
+          if (change->path.len == len || change->path.data[len] == '/')
+            {
+              *touched = TRUE;
+              return;
+            }
+
+          /* Anything below PATH would sort before this entry. */
+          if ((unsigned char)change->path.data[len] > '/')
+            {
+              *past_end = TRUE;
+              return;
+            }
+        }
+    }
+}
+
+/* Set *TOUCHED if the sorted changed-paths list accessed through CONTEXT
+ * and described by INDEX contains an entry for exactly PATH.  This
+ * fetches at most one block.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+block_contains_path(svn_boolean_t *touched,
+                    svn_fs_fs__changes_context_t *context,
+                    const svn_fs_fs__changes_index_t *index,
+                    const char *path,
+                    apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *changes;
+  int i;
+
+  SVN_ERR(get_changes_block(&changes, context, index,
+                            changes_index_lookup(index, path),
+                            scratch_pool, scratch_pool));
+  for (i = 0; i < changes->nelts; ++i)
+    {
+      const change_t *change = APR_ARRAY_IDX(changes, i, change_t *);
+      int diff = strcmp(change->path.data, path);
+
+      if (diff == 0)
+        {
+          *touched = TRUE;
+          break;
+        }
+      if (diff > 0)
+        break;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__changes_path_touched(svn_boolean_t *touched,
+                                svn_boolean_t *known,
+                                svn_fs_t *fs,
+                                svn_revnum_t rev,
+                                const char *path,
+                                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_fs_fs__changes_index_t *index;
+  svn_fs_fs__changes_context_t *context;
+  svn_boolean_t found = FALSE;
+  svn_boolean_t past_end = FALSE;
+  apr_size_t len = strlen(path);
+  apr_pool_t *iterpool;
+  apr_size_t i;
+  int block;
+
+  pair_cache_key_t key;
+  key.revision = rev;
+  key.second = 0;
+
+  *touched = FALSE;
+  *known = FALSE;
+
+  /* Without a cached block directory for REV, we cannot restrict the
+     read to individual blocks; the caller will have to scan the full
+     list.  The same applies if the on-disk list turned out not to be
+     sorted. */
+  if (ffd->changes_index_cache)
+    SVN_ERR(svn_cache__get((void **)&index, &found,
+                           ffd->changes_index_cache, &key, scratch_pool));
+  if (!found || !index->sorted || index->count == 0)
+    return SVN_NO_ERROR;
+
+  *known = TRUE;
+
+  /* "/" is an ancestor of every change and the list is not empty. */
+  if (len <= 1)
+    {
+      *touched = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_fs_fs__create_changes_context(&context, fs, rev,
+                                            scratch_pool));
+  iterpool = svn_pool_create(scratch_pool);
+
+  /* PATH itself or one of its descendants changed?  They form one
+     contiguous run of candidate blocks starting at the block that would
+     contain PATH itself. */
+  for (block = changes_index_lookup(index, path);
+       !*touched && !past_end && block < index->count;
+       ++block)
+    {
+      apr_array_header_t *changes;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(get_changes_block(&changes, context, index, block,
+                                iterpool, iterpool));
+      scan_block_for_subtree(touched, &past_end, changes, path, len);
+    }
+
+  /* A proper ancestor of PATH changed, e.g. by a copy or a property
+     modification on a parent directory? */
+  for (i = len; i > 1 && !*touched; i--)
+    if (path[i - 1] == '/')
+      {
+        svn_pool_clear(iterpool);
+        SVN_ERR(block_contains_path(touched, context, index,
+                                    apr_pstrmemdup(iterpool, path, i - 1),
+                                    iterpool));
+      }
+
+  if (!*touched)
+    SVN_ERR(block_contains_path(touched, context, index, "/", iterpool));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Inialize the representation read state RS for the given REP_HEADER and
  * p2l index ENTRY.  If not NULL, assign FILE and STREAM to RS.
  * Use RESULT_POOL for allocations.
@@ -3328,18 +4492,48 @@ cache_windows(svn_fs_t *fs,
           apr_off_t start_offset = rs->start + rs->current;
           apr_size_t window_len;
           char *buf;
+          const char *mapped;
 
-          /* navigate to the current window */
-          SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, iterpool));
-          SVN_ERR(svn_txdelta__read_raw_window_len(&window_len,
-                                                   rs->sfile->rfile->stream,
-                                                   iterpool));
-
-          /* Read the raw window. */
-          buf = apr_palloc(iterpool, window_len + 1);
-          SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, iterpool));
-          SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buf,
-                                         window_len, NULL, NULL, iterpool));
+          SVN_ERR(svn_fs_fs__rev_file_mapped_range(&mapped,
+                                      rs->sfile->rfile, start_offset,
+                                      (apr_size_t)(rs->size - rs->current)));
+          if (mapped)
+            {
+              /* Determine the window size from the mapped pages and copy
+               * the raw window from there - no syscalls involved.  The
+               * copy is still needed because the cache serializer expects
+               * a NUL-terminated buffer. */
+              svn_string_t raw;
+              svn_stream_t *stream;
+
+              raw.data = mapped;
+              raw.len = (apr_size_t)(rs->size - rs->current);
+              stream = svn_stream_from_string(&raw, iterpool);
+              SVN_ERR(svn_txdelta__read_raw_window_len(&window_len, stream,
+                                                       iterpool));
+              if (window_len > raw.len)
+                return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                                  _("Reading one svndiff window read beyond "
+                                    "the end of the representation"));
+
+              buf = apr_palloc(iterpool, window_len + 1);
+              memcpy(buf, mapped, window_len);
+            }
+          else
+            {
+              /* navigate to the current window */
+              SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, iterpool));
+              SVN_ERR(svn_txdelta__read_raw_window_len(&window_len,
+                                                      rs->sfile->rfile->stream,
+                                                       iterpool));
+
+              /* Read the raw window. */
+              buf = apr_palloc(iterpool, window_len + 1);
+              SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, iterpool));
+              SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buf,
+                                             window_len, NULL, NULL,
+                                             iterpool));
+            }
           buf[window_len] = 0;
 
           /* update relative offset in representation */
@@ -3404,6 +4598,7 @@ block_read_windows(svn_fs_fs__rep_header_t *rep_header,
     {
       svn_stringbuf_t *plaintext;
       svn_boolean_t is_cached;
+      const char *mapped;
 
       /* already in cache? */
       SVN_ERR(svn_cache__has_key(&is_cached, rs.combined_cache,
@@ -3412,15 +4607,27 @@ block_read_windows(svn_fs_fs__rep_header_t *rep_header,
       if (is_cached)
         return SVN_NO_ERROR;
 
-      /* for larger reps, the header may have crossed a block boundary.
-       * make sure we still read blocks properly aligned, i.e. don't use
-       * plain seek here. */
-      SVN_ERR(aligned_seek(fs, rev_file->file, NULL, offset, scratch_pool));
-
       plaintext = svn_stringbuf_create_ensure(rs.size, result_pool);
-      SVN_ERR(svn_io_file_read_full2(rev_file->file, plaintext->data,
-                                     rs.size, &plaintext->len, NULL,
-                                     result_pool));
+      SVN_ERR(svn_fs_fs__rev_file_mapped_range(&mapped, rev_file, offset,
+                                               (apr_size_t)rs.size));
+      if (mapped)
+        {
+          /* Copy straight from the memory mapping - no syscalls involved. */
+          memcpy(plaintext->data, mapped, (apr_size_t)rs.size);
+          plaintext->len = (apr_size_t)rs.size;
+        }
+      else
+        {
+          /* for larger reps, the header may have crossed a block boundary.
+           * make sure we still read blocks properly aligned, i.e. don't use
+           * plain seek here. */
+          SVN_ERR(aligned_seek(fs, rev_file->file, NULL, offset,
+                               scratch_pool));
+
+          SVN_ERR(svn_io_file_read_full2(rev_file->file, plaintext->data,
+                                         rs.size, &plaintext->len, NULL,
+                                         result_pool));
+        }
       plaintext->data[plaintext->len] = 0;
       rs.current += rs.size;
 
@@ -3496,31 +4703,46 @@ block_read_contents(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
-/* For the given REV_FILE in FS, in *STREAM return a stream covering the
- * item specified by ENTRY.  Also, verify the item's content by low-level
- * checksum.  Allocate the result in POOL.
+/* For the given REV_FILE in FS, return the raw, unparsed text of the
+ * item specified by ENTRY in *TEXT.  Also, verify the item's content by
+ * low-level checksum.  Allocate the result in POOL.
  */
 static svn_error_t *
-read_item(svn_stream_t **stream,
-          svn_fs_t *fs,
-          svn_fs_fs__revision_file_t *rev_file,
-          svn_fs_fs__p2l_entry_t* entry,
-          apr_pool_t *pool)
+read_item_raw(svn_string_t **text,
+              svn_fs_t *fs,
+              svn_fs_fs__revision_file_t *rev_file,
+              svn_fs_fs__p2l_entry_t* entry,
+              apr_pool_t *pool)
 {
   apr_uint32_t digest;
   svn_checksum_t *expected, *actual;
   apr_uint32_t plain_digest;
+  const char *mapped;
+  svn_string_t *result = apr_palloc(pool, sizeof(*result));
+
+  /* If the rev / pack file has been mapped into memory, serve the item
+   * directly from the mapping - no seek, read or copy involved. */
+  SVN_ERR(svn_fs_fs__rev_file_mapped_range(&mapped, rev_file, entry->offset,
+                                           (apr_size_t)entry->size));
+  if (mapped)
+    {
+      result->data = mapped;
+      result->len = (apr_size_t)entry->size;
+    }
+  else
+    {
+      /* Read item into a NUL-terminated buffer. */
+      char *buffer = apr_palloc(pool, entry->size + 1);
+      SVN_ERR(svn_io_file_read_full2(rev_file->file, buffer, entry->size,
+                                     NULL, NULL, pool));
+      buffer[entry->size] = 0;
+
+      result->data = buffer;
+      result->len = (apr_size_t)entry->size;
+    }
 
-  /* Read item into string buffer. */
-  svn_stringbuf_t *text = svn_stringbuf_create_ensure(entry->size, pool);
-  text->len = entry->size;
-  text->data[text->len] = 0;
-  SVN_ERR(svn_io_file_read_full2(rev_file->file, text->data, text->len,
-                                 NULL, NULL, pool));
-
-  /* Return (construct, calculate) stream and checksum. */
-  *stream = svn_stream_from_stringbuf(text, pool);
-  digest = svn__fnv1a_32x4(text->data, text->len);
+  *text = result;
+  digest = svn__fnv1a_32x4(result->data, result->len);
 
   /* Checksums will match most of the time. */
   if (entry->fnv1_checksum == digest)
@@ -3546,6 +4768,25 @@ read_item(svn_stream_t **stream,
                  entry->item.revision);
 }
 
+/* For the given REV_FILE in FS, in *STREAM return a stream covering the
+ * item specified by ENTRY.  Also, verify the item's content by low-level
+ * checksum.  Allocate the result in POOL.
+ */
+static svn_error_t *
+read_item(svn_stream_t **stream,
+          svn_fs_t *fs,
+          svn_fs_fs__revision_file_t *rev_file,
+          svn_fs_fs__p2l_entry_t* entry,
+          apr_pool_t *pool)
+{
+  svn_string_t *text;
+
+  SVN_ERR(read_item_raw(&text, fs, rev_file, entry, pool));
+  *stream = svn_stream_from_string(text, pool);
+
+  return SVN_NO_ERROR;
+}
+
 /* If not already cached, read the changed paths list addressed by ENTRY in
  * FS and cache it if it has no more than SVN_FS_FS__CHANGES_BLOCK_SIZE
  * entries and caching is enabled.  Read the data from REV_FILE.
@@ -3625,7 +4866,7 @@ block_read_noderev(node_revision_t **noderev_p,
                    apr_pool_t *scratch_pool)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
-  svn_stream_t *stream;
+  svn_string_t *text;
 
   pair_cache_key_t key = { 0 };
   key.revision = entry->item.revision;
@@ -3644,11 +4885,11 @@ block_read_noderev(node_revision_t **noderev_p,
         return SVN_NO_ERROR;
     }
 
-  SVN_ERR(read_item(&stream, fs, rev_file, entry, scratch_pool));
-
-  /* read node rev from revision file */
-  SVN_ERR(svn_fs_fs__read_noderev(noderev_p, stream,
-                                  result_pool, scratch_pool));
+  /* Parse the node rev straight from the item buffer, bypassing the
+   * intermediate stream object. */
+  SVN_ERR(read_item_raw(&text, fs, rev_file, entry, scratch_pool));
+  SVN_ERR(svn_fs_fs__parse_noderev(noderev_p, text,
+                                   result_pool, scratch_pool));
   SVN_ERR(fixup_node_revision(fs, *noderev_p, scratch_pool));
 
   if (ffd->node_revision_cache)
@@ -30,6 +30,14 @@
 
 
 
+/* Set *TABLE to a new in-flight reconstruction registry (see the
+   INFLIGHT_REPS member of fs_fs_shared_data_t), allocated in
+   RESULT_POOL.  RESULT_POOL must be suitable for process-wide, shared
+   data, i.e. normally the common pool. */
+svn_error_t *
+svn_fs_fs__inflight_reps_create(struct svn_fs_fs__inflight_reps_t **table,
+                                apr_pool_t *result_pool);
+
 /* Resolve a FSFS quirk: if REP in FS is a "PLAIN" representation, its
  * EXPANDED_SIZE element may be 0, in which case its value has to be taken
  * from SIZE.
@@ -81,6 +89,21 @@ svn_fs_fs__rep_chain_length(int *chain_length,
                             svn_fs_t *fs,
                             apr_pool_t *scratch_pool);
 
+/* If REP in FS is a non-deltified, non-compressed fulltext ("PLAIN")
+   representation, set *AVAILABLE to TRUE, set *FILE to the rev / pack
+   file containing it, positioned at the first fulltext byte, set
+   *OFFSET to that position and *LEN to the fulltext length in bytes.
+   Otherwise, set *AVAILABLE to FALSE and leave the other output
+   parameters undefined.  Allocate *FILE in POOL. */
+svn_error_t *
+svn_fs_fs__get_plain_rep_location(svn_boolean_t *available,
+                                  apr_file_t **file,
+                                  apr_off_t *offset,
+                                  svn_filesize_t *len,
+                                  svn_fs_t *fs,
+                                  representation_t *rep,
+                                  apr_pool_t *pool);
+
 /* Set *CONTENTS_P to be a readable svn_stream_t that receives the text
    representation REP as seen in filesystem FS.  If CACHE_FULLTEXT is
    not set, bypass fulltext cache lookup for this rep and don't put the
@@ -188,4 +211,44 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
                        apr_pool_t *result_pool,
                        apr_pool_t *scratch_pool);
 
+/* Add the changed path PATH (a "/"-prefixed fspath) to the bloom filter
+ * BLOOM. */
+void
+svn_fs_fs__changes_bloom_add_path(svn_fs_fs__changes_bloom_t *bloom,
+                                  const char *path);
+
+/* Return FALSE if the revision summarized by BLOOM definitely changed
+ * neither PATH (a "/"-prefixed fspath) nor any of its ancestors or
+ * descendants.  Return TRUE if it may have. */
+svn_boolean_t
+svn_fs_fs__changes_bloom_may_touch(const svn_fs_fs__changes_bloom_t *bloom,
+                                   const char *path);
+
+/* Set *BLOOM_P to the bloom filter summarizing the changed paths of REV
+ * in FS, either taken from cache or built from the changed-paths list
+ * (and then cached).  Allocate the result in RESULT_POOL and use
+ * SCRATCH_POOL for temporaries. */
+svn_error_t *
+svn_fs_fs__get_changes_bloom(svn_fs_fs__changes_bloom_t **bloom_p,
+                             svn_fs_t *fs,
+                             svn_revnum_t rev,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
+/* Give a definite answer to the question whether REV in FS changed PATH
+ * (a "/"-prefixed fspath), one of its ancestors or one of its
+ * descendants, fetching only the blocks of the changed-paths list that
+ * can contain the respective entries.  This requires the block directory
+ * of REV's list to be cached (svn_fs_fs__get_changes_bloom constructs
+ * it); if it isn't, or if the on-disk list is not sorted, set *KNOWN to
+ * FALSE and leave *TOUCHED undefined.  Otherwise, set *KNOWN to TRUE and
+ * *TOUCHED to the answer.  Use SCRATCH_POOL for temporaries. */
+svn_error_t *
+svn_fs_fs__changes_path_touched(svn_boolean_t *touched,
+                                svn_boolean_t *known,
+                                svn_fs_t *fs,
+                                svn_revnum_t rev,
+                                const char *path,
+                                apr_pool_t *scratch_pool);
+
 #endif
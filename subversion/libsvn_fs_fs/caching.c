@@ -312,6 +312,37 @@ create_cache(svn_cache__t **cache_p,
   if (priority == 0)
     priority = SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY;
 
+  /* Apply the request-context hint, if the FS got opened with one.
+   * Maintenance operations drop everything to the lowest priority so
+   * their bulk scans cannot evict an interactive server's working set
+   * from a shared membuffer; interactive servers promote their
+   * default-priority data.  Data that is cheap to reconstruct keeps
+   * its low priority either way. */
+  if (fs->config)
+    {
+      const char *context = svn_hash__get_cstring(fs->config,
+                                      SVN_FS_CONFIG_FSFS_CACHE_PRIORITY,
+                                      NULL);
+      if (context && strcmp(context, "low") == 0)
+        priority = SVN_CACHE__MEMBUFFER_LOW_PRIORITY;
+      else if (context && strcmp(context, "high") == 0
+               && priority == SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY)
+        priority = SVN_CACHE__MEMBUFFER_HIGH_PRIORITY;
+    }
+
+  /* Apply this repository's configured weight.  Membuffer eviction
+   * compares entry priorities across all repositories sharing the
+   * buffer, so scaling every priority class uniformly lets a small but
+   * hot repository retain its working set under pressure from bulk
+   * operations on larger, lower-weighted neighbours. */
+  {
+    fs_fs_data_t *ffd = fs->fsap_data;
+
+    if (ffd->cache_weight != 100 && ffd->cache_weight > 0)
+      priority = (apr_uint32_t)(priority * (apr_uint64_t)ffd->cache_weight
+                                / 100);
+  }
+
   if (memcache)
     {
       SVN_ERR(svn_cache__create_memcache(cache_p, memcache,
@@ -320,6 +351,22 @@ create_cache(svn_cache__t **cache_p,
       error_handler = no_handler
                     ? NULL
                     : warn_and_continue_on_cache_errors;
+
+      /* If there also is a membuffer, use it as a fast first tier in
+       * front of the large memcached store instead of bypassing it.
+       * Repeated access then gets served from process memory while the
+       * long tail of the working set survives in the second tier. */
+      if (membuffer)
+        {
+          svn_cache__t *front;
+
+          SVN_ERR(svn_cache__create_membuffer_cache(
+                    &front, membuffer, serializer, deserializer,
+                    klen, prefix, priority, FALSE, has_namespace,
+                    result_pool, scratch_pool));
+          SVN_ERR(svn_cache__create_two_level(cache_p, front, *cache_p,
+                                              result_pool));
+        }
     }
   else if (membuffer)
     {
@@ -453,6 +500,38 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        no_handler,
                        fs->pool, pool));
 
+  /* Block index for immutable directories too large for DIR_CACHE;
+     a few dozen bytes per cached block. */
+  SVN_ERR(create_cache(&(ffd->dir_index_cache),
+                       NULL,
+                       membuffer,
+                       1, 8,
+                       svn_fs_fs__serialize_dir_index,
+                       svn_fs_fs__deserialize_dir_index,
+                       sizeof(pair_cache_key_t),
+                       apr_pstrcat(pool, prefix, "DIRINDEX", SVN_VA_NULL),
+                       SVN_CACHE__MEMBUFFER_HIGH_PRIORITY,
+                       has_namespace,
+                       fs,
+                       no_handler,
+                       fs->pool, pool));
+
+  /* Sorted entry blocks for those directories; roughly 150 bytes per
+     entry, i.e. ~200kB per cached block. */
+  SVN_ERR(create_cache(&(ffd->dir_block_cache),
+                       NULL,
+                       membuffer,
+                       1, 8,
+                       svn_fs_fs__serialize_dir_entries,
+                       svn_fs_fs__deserialize_dir_entries,
+                       sizeof(dir_block_key_t),
+                       apr_pstrcat(pool, prefix, "DIRBLOCKS", SVN_VA_NULL),
+                       SVN_CACHE__MEMBUFFER_HIGH_PRIORITY,
+                       has_namespace,
+                       fs,
+                       no_handler,
+                       fs->pool, pool));
+
   /* 8 kBytes per entry (1000 revs / shared, one file offset per rev).
      Covering about 8 pack files gives us an "o.k." hit rate. */
   SVN_ERR(create_cache(&(ffd->packed_offset_cache),
@@ -515,6 +594,56 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        no_handler,
                        fs->pool, pool));
 
+  /* initialize the changed-paths bloom filter cache, if caching has been
+     enabled */
+  SVN_ERR(create_cache(&(ffd->changes_bloom_cache),
+                       NULL,
+                       membuffer,
+                       1, 64, /* 256 bytes / entry */
+                       svn_fs_fs__serialize_changes_bloom,
+                       svn_fs_fs__deserialize_changes_bloom,
+                       sizeof(pair_cache_key_t),
+                       apr_pstrcat(pool, prefix, "CHANGESBLOOM",
+                                   SVN_VA_NULL),
+                       SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                       has_namespace,
+                       fs,
+                       no_handler,
+                       fs->pool, pool));
+
+  /* initialize the changed-paths block directory cache, if caching has
+     been enabled */
+  SVN_ERR(create_cache(&(ffd->changes_index_cache),
+                       NULL,
+                       membuffer,
+                       1, 64, /* ~50 bytes / block */
+                       svn_fs_fs__serialize_changes_index,
+                       svn_fs_fs__deserialize_changes_index,
+                       sizeof(pair_cache_key_t),
+                       apr_pstrcat(pool, prefix, "CHANGESINDEX",
+                                   SVN_VA_NULL),
+                       SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                       has_namespace,
+                       fs,
+                       no_handler,
+                       fs->pool, pool));
+
+  /* initialize the lock digest file cache; entries are invalidated by
+     their file attributes, so sharing them between processes is safe */
+  SVN_ERR(create_cache(&(ffd->lock_digest_cache),
+                       NULL,
+                       membuffer,
+                       1, 16, /* ~200 bytes / lock or index entry */
+                       svn_fs_fs__serialize_lock_digest,
+                       svn_fs_fs__deserialize_lock_digest,
+                       APR_HASH_KEY_STRING,
+                       apr_pstrcat(pool, prefix, "LOCKDIGEST", SVN_VA_NULL),
+                       SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                       TRUE, /* contents is short-lived */
+                       fs,
+                       no_handler,
+                       fs->pool, pool));
+
   /* if enabled, cache revprops */
   SVN_ERR(create_cache(&(ffd->revprop_cache),
                        NULL,
@@ -530,6 +659,23 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        no_handler,
                        fs->pool, pool));
 
+  /* cache revprop pack manifests; values are the raw manifest file
+     contents, i.e. ~12 bytes per revision in the shard */
+  SVN_ERR(create_cache(&(ffd->revprop_manifest_cache),
+                       NULL,
+                       membuffer,
+                       8, 2, /* ~12 kBytes / entry, capa for ~16 shards */
+                       /* Values are svn_stringbuf_t */
+                       NULL, NULL,
+                       sizeof(pair_cache_key_t),
+                       apr_pstrcat(pool, prefix, "REVPROP-MANIFEST",
+                                   SVN_VA_NULL),
+                       SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                       TRUE, /* contents is short-lived */
+                       fs,
+                       no_handler,
+                       fs->pool, pool));
+
   /* if enabled, cache fulltext and other derived information */
   if (cache_fulltexts)
     {
@@ -601,10 +747,26 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                            fs,
                            no_handler,
                            fs->pool, pool));
+
+      SVN_ERR(create_cache(&(ffd->iprops_cache),
+                           NULL,
+                           membuffer,
+                           0, 0, /* Do not use the inprocess cache */
+                           svn_fs_fs__serialize_iprops,
+                           svn_fs_fs__deserialize_iprops,
+                           APR_HASH_KEY_STRING,
+                           apr_pstrcat(pool, prefix, "IPROPS",
+                                       SVN_VA_NULL),
+                           SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                           has_namespace,
+                           fs,
+                           no_handler,
+                           fs->pool, pool));
     }
   else
     {
       ffd->properties_cache = NULL;
+      ffd->iprops_cache = NULL;
     }
 
   /* if enabled, cache text deltas and their combinations */
@@ -839,6 +1001,7 @@ svn_fs_fs__initialize_txn_caches(svn_fs_t *fs,
   if (ffd->txn_dir_cache != NULL || ffd->concurrent_transactions)
     {
       ffd->txn_dir_cache = NULL;
+      ffd->txn_node_cache = NULL;
       ffd->concurrent_transactions = TRUE;
 
       return SVN_NO_ERROR;
@@ -856,7 +1019,7 @@ svn_fs_fs__initialize_txn_caches(svn_fs_t *fs,
                          "fsfs:", fs->uuid,
                          "/", fs->path,
                          ":", txn_id,
-                         ":", "TXNDIR",
+                         ":",
                          SVN_VA_NULL);
   else
     prefix = apr_pstrcat(pool,
@@ -864,7 +1027,7 @@ svn_fs_fs__initialize_txn_caches(svn_fs_t *fs,
                          "/", fs->path,
                          ":", txn_id,
                          ":", svn_uuid_generate(pool),
-                         ":", "TXNDIR",
+                         ":",
                          SVN_VA_NULL);
 
   /* create a txn-local directory cache */
@@ -875,15 +1038,32 @@ svn_fs_fs__initialize_txn_caches(svn_fs_t *fs,
                        svn_fs_fs__serialize_txndir_entries,
                        svn_fs_fs__deserialize_dir_entries,
                        APR_HASH_KEY_STRING,
-                       prefix,
+                       apr_pstrcat(pool, prefix, "TXNDIR", SVN_VA_NULL),
+                       SVN_CACHE__MEMBUFFER_HIGH_PRIORITY,
+                       TRUE, /* The TXN-ID is our namespace. */
+                       fs,
+                       TRUE,
+                       pool, pool));
+
+  /* create a txn-local node revision cache, so reading back what the
+     transaction just wrote does not hit the txn files on disk */
+  SVN_ERR(create_cache(&ffd->txn_node_cache,
+                       NULL,
+                       svn_cache__get_global_membuffer_cache(),
+                       1024, 8,
+                       svn_fs_fs__serialize_node_revision,
+                       svn_fs_fs__deserialize_node_revision,
+                       APR_HASH_KEY_STRING,
+                       apr_pstrcat(pool, prefix, "TXNNODE", SVN_VA_NULL),
                        SVN_CACHE__MEMBUFFER_HIGH_PRIORITY,
                        TRUE, /* The TXN-ID is our namespace. */
                        fs,
                        TRUE,
                        pool, pool));
 
-  /* reset the transaction-specific cache if the pool gets cleaned up. */
+  /* reset the transaction-specific caches if the pool gets cleaned up. */
   init_txn_callbacks(fs, &(ffd->txn_dir_cache), pool);
+  init_txn_callbacks(fs, &(ffd->txn_node_cache), pool);
 
   return SVN_NO_ERROR;
 }
@@ -896,4 +1076,5 @@ svn_fs_fs__reset_txn_caches(svn_fs_t *fs)
 
   fs_fs_data_t *ffd = fs->fsap_data;
   ffd->txn_dir_cache = NULL;
+  ffd->txn_node_cache = NULL;
 }
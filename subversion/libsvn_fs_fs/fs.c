@@ -34,6 +34,8 @@
 #include "svn_pools.h"
 #include "fs.h"
 #include "fs_fs.h"
+#include "batch_fsync.h"
+#include "cached_data.h"
 #include "tree.h"
 #include "lock.h"
 #include "hotcopy.h"
@@ -124,6 +126,11 @@ fs_serialized_init(svn_fs_t *fs, apr_pool_t *common_pool, apr_pool_t *pool)
          transaction list and free transaction pointer. */
       SVN_ERR(svn_mutex__init(&ffsd->txn_list_lock, TRUE, common_pool));
 
+      /* Tracks fulltext reconstructions in progress, so concurrent
+         readers of the same rep don't duplicate each other's work. */
+      SVN_ERR(svn_fs_fs__inflight_reps_create(&ffsd->inflight_reps,
+                                              common_pool));
+
       key = apr_pstrdup(common_pool, key);
       status = apr_pool_userdata_set(ffsd, key, NULL, common_pool);
       if (status)
@@ -272,6 +279,7 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
 
           output = apr_pcalloc(result_pool, sizeof(*output));
           SVN_ERR(svn_fs_fs__get_stats(&output->stats, fs,
+                                       input->num_threads,
                                        input->progress_func,
                                        input->progress_baton,
                                        cancel_func, cancel_baton,
@@ -328,6 +336,65 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
           *output_p = NULL;
           return SVN_NO_ERROR;
         }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_GET_RAW_CONTENTS.code)
+        {
+          svn_fs_fs__ioctl_get_raw_contents_input_t *input = input_void;
+          svn_fs_fs__ioctl_get_raw_contents_output_t *output
+            = apr_pcalloc(result_pool, sizeof(*output));
+          const svn_fs_id_t *id;
+          node_revision_t *noderev;
+
+          /* Txn contents are mutable; only committed data qualifies. */
+          if (svn_fs_is_revision_root(input->root))
+            {
+              SVN_ERR(svn_fs_fs__node_id(&id, input->root, input->path,
+                                         scratch_pool));
+              SVN_ERR(svn_fs_fs__get_node_revision(&noderev, fs, id,
+                                                   scratch_pool,
+                                                   scratch_pool));
+              if (noderev->kind == svn_node_file)
+                SVN_ERR(svn_fs_fs__get_plain_rep_location(&output->available,
+                                                          &output->file,
+                                                          &output->offset,
+                                                          &output->len,
+                                                          fs,
+                                                          noderev->data_rep,
+                                                          result_pool));
+            }
+
+          *output_p = output;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_FIND_REP.code)
+        {
+          svn_fs_fs__ioctl_find_rep_input_t *input = input_void;
+          svn_fs_fs__ioctl_find_rep_output_t *output
+            = apr_pcalloc(result_pool, sizeof(*output));
+          fs_fs_data_t *ffd = fs->fsap_data;
+          svn_boolean_t cache_exists = FALSE;
+
+          if (ffd->rep_sharing_allowed)
+            SVN_ERR(svn_fs_fs__exists_rep_cache(&cache_exists, fs,
+                                                scratch_pool));
+
+          if (cache_exists)
+            {
+              representation_t *rep;
+
+              SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, input->checksum,
+                                                   scratch_pool));
+              if (rep)
+                {
+                  output->found = TRUE;
+                  output->revision = rep->revision;
+                  output->item_index = rep->item_index;
+                  output->expanded_size = rep->expanded_size;
+                }
+            }
+
+          *output_p = output;
+          return SVN_NO_ERROR;
+        }
     }
 
   return svn_error_create(SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE, NULL, NULL);
@@ -705,6 +772,8 @@ svn_fs_fs__init(const svn_version_t *loader_version,
                              loader_version->major);
   SVN_ERR(svn_ver_check_list2(fs_version(), checklist, svn_ver_equal));
 
+  SVN_ERR(svn_fs_fs__batch_fsync_init(common_pool));
+
   *vtable = &library_vtable;
   return SVN_NO_ERROR;
 }
@@ -100,6 +100,7 @@ extern "C" {
 /* Names of sections and options in fsfs.conf. */
 #define CONFIG_SECTION_CACHES            "caches"
 #define CONFIG_OPTION_FAIL_STOP          "fail-stop"
+#define CONFIG_OPTION_CACHE_WEIGHT       "cache-weight"
 #define CONFIG_SECTION_REP_SHARING       "rep-sharing"
 #define CONFIG_OPTION_ENABLE_REP_SHARING "enable-rep-sharing"
 #define CONFIG_SECTION_DELTIFICATION     "deltification"
@@ -107,12 +108,23 @@ extern "C" {
 #define CONFIG_OPTION_ENABLE_PROPS_DELTIFICATION "enable-props-deltification"
 #define CONFIG_OPTION_MAX_DELTIFICATION_WALK     "max-deltification-walk"
 #define CONFIG_OPTION_MAX_LINEAR_DELTIFICATION   "max-linear-deltification"
+#define CONFIG_OPTION_MAX_DELTA_CHAIN_LENGTH     "max-delta-chain-length"
+#define CONFIG_OPTION_PROBE_DELTA_BASES          "probe-delta-bases"
 #define CONFIG_OPTION_COMPRESSION_LEVEL  "compression-level"
 #define CONFIG_SECTION_PACKED_REVPROPS   "packed-revprops"
 #define CONFIG_OPTION_REVPROP_PACK_SIZE  "revprop-pack-size"
 #define CONFIG_OPTION_COMPRESS_PACKED_REVPROPS  "compress-packed-revprops"
 #define CONFIG_SECTION_IO                "io"
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
+#define CONFIG_OPTION_USE_MMAP           "use-mmap"
+#define CONFIG_OPTION_BATCH_FSYNC        "batch-fsync"
+#define CONFIG_OPTION_HOTCOPY_THREADS    "hotcopy-threads"
+#define CONFIG_OPTION_HOTCOPY_SKIP_IMMUTABLE "hotcopy-skip-immutable"
+#define CONFIG_SECTION_TRANSACTIONS      "transactions"
+#define CONFIG_OPTION_TXN_SCRATCH_DIR    "scratch-dir"
+#define CONFIG_SECTION_PACKING           "packing"
+#define CONFIG_OPTION_PACK_THREADS       "pack-threads"
+#define CONFIG_OPTION_VERIFY_THREADS     "verify-threads"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
 #define CONFIG_OPTION_P2L_PAGE_SIZE      "p2l-page-size"
 #define CONFIG_SECTION_DEBUG             "debug"
@@ -127,7 +139,7 @@ extern "C" {
    Note: If you bump this, please update the switch statement in
          svn_fs_fs__create() as well.
  */
-#define SVN_FS_FS__FORMAT_NUMBER   8
+#define SVN_FS_FS__FORMAT_NUMBER   9
 
 /* The minimum format number that supports svndiff version 1.  */
 #define SVN_FS_FS__MIN_SVNDIFF1_FORMAT 2
@@ -200,6 +212,11 @@ extern "C" {
     database. */
 #define SVN_FS_FS__MIN_REP_CACHE_SCHEMA_V2_FORMAT 8
 
+/* The minimum format number that supports svndiff version 3 (zstd).
+   Older formats must not contain svndiff3 representations because
+   released libraries that open them would fail mid-read. */
+#define SVN_FS_FS__MIN_SVNDIFF3_FORMAT 9
+
 /* On most operating systems apr implements file locks per process, not
    per file.  On Windows apr implements the locking as per file handle
    locks, so we don't have to add our own mutex for just in-process
@@ -275,6 +292,13 @@ typedef struct fs_fs_shared_data_t
      txn-current file. */
   svn_mutex__t *txn_current_lock;
 
+  /* Registry of fulltext reconstructions currently in progress in this
+     process, so that concurrent readers of the same uncached rep can
+     wait for the first one to populate the fulltext cache instead of
+     each combining the same delta chain.  Opaque to everyone but
+     cached_data.c; synchronization is internal to the object. */
+  struct svn_fs_fs__inflight_reps_t *inflight_reps;
+
   /* The common pool, under which this object is allocated, subpools
      of which are used to allocate the transaction objects. */
   apr_pool_t *common_pool;
@@ -296,6 +320,24 @@ typedef struct pair_cache_key_t
   apr_int64_t second;
 } pair_cache_key_t;
 
+/* Key type for the caches that shard oversized directories into blocks.
+   Extends pair_cache_key_t by the block number within the directory.
+
+   Note: Cache keys should require no padding. */
+typedef struct dir_block_key_t
+{
+  /* The directory rep's revision.  Use the 64 data type to prevent
+     padding. */
+  apr_int64_t revision;
+
+  /* The directory rep's item index within REVISION. */
+  apr_int64_t item_index;
+
+  /* Number of the entries block, starting at 0.  Use the 64 data type
+     to prevent padding. */
+  apr_int64_t block;
+} dir_block_key_t;
+
 /* Key type that identifies a txdelta window.
 
    Note: Cache keys should require no padding. */
@@ -315,7 +357,8 @@ typedef enum compression_type_t
 {
   compression_type_none,
   compression_type_zlib,
-  compression_type_lz4
+  compression_type_lz4,
+  compression_type_zstd
 } compression_type_t;
 
 /* Private (non-shared) FSFS-specific data for each svn_fs_t object.
@@ -347,6 +390,12 @@ typedef struct fs_fs_data_t
    * (not just the one bit that we need, atm). */
   svn_boolean_t use_block_read;
 
+  /* If set, advise the OS that rev / pack files get read sequentially,
+   * at most once, and that their cached pages may be dropped again upon
+   * close.  Used by bulk maintenance operations to keep their scans from
+   * evicting hot data from the page cache. */
+  svn_boolean_t bulk_reads;
+
   /* The revision that was youngest, last time we checked. */
   svn_revnum_t youngest_rev_cache;
 
@@ -360,6 +409,12 @@ typedef struct fs_fs_data_t
      e.g. memcached may be ignored as caching is an optional feature. */
   svn_boolean_t fail_stop;
 
+  /* Relative weight, in percent, of this repository's entries in a cache
+     shared with other repositories.  100 is neutral; larger values make
+     this repository's data survive eviction pressure from repositories
+     with smaller values.  Limited to [1, 10000]. */
+  apr_int64_t cache_weight;
+
   /* A cache of revision root IDs, mapping from (svn_revnum_t *) to
      (svn_fs_id_t *).  (Not threadsafe.) */
   svn_cache__t *rev_root_id_cache;
@@ -376,6 +431,15 @@ typedef struct fs_fs_data_t
      names to (svn_fs_dirent_t *). */
   svn_cache__t *dir_cache;
 
+  /* Cache for the entry name index of immutable directories too large
+     for DIR_CACHE; maps (revision, item_index) to
+     svn_fs_fs__dir_index_t. */
+  svn_cache__t *dir_index_cache;
+
+  /* Cache for sorted blocks of immutable directories too large for
+     DIR_CACHE; maps dir_block_key_t to svn_fs_fs__dir_data_t. */
+  svn_cache__t *dir_block_cache;
+
   /* Fulltext cache; currently only used with memcached.  Maps from
      rep key (revision/offset) to svn_stringbuf_t. */
   svn_cache__t *fulltext_cache;
@@ -389,9 +453,17 @@ typedef struct fs_fs_data_t
      will be written to the cache but the getter returns apr_hash_t. */
   svn_cache__t *revprop_cache;
 
+  /* Cache for packed revprop manifests.  Maps from (shard start rev,
+     prefix) to the raw manifest file contents as svn_stringbuf_t. */
+  svn_cache__t *revprop_manifest_cache;
+
   /* Node properties cache.  Maps from rep key to apr_hash_t. */
   svn_cache__t *properties_cache;
 
+  /* Inherited properties rollup cache.  Maps from (rev, path) to an
+     apr_array_header_t of svn_prop_inherited_item_t *. */
+  svn_cache__t *iprops_cache;
+
   /* Pack manifest cache; a cache mapping (svn_revnum_t) shard number to
      a manifest; and a manifest is a mapping from (svn_revnum_t) revision
      number offset within a shard to (apr_off_t) byte-offset in the
@@ -416,6 +488,19 @@ typedef struct fs_fs_data_t
      the key is the (revision, first-element-in-block) pair. */
   svn_cache__t *changes_cache;
 
+  /* Cache for svn_fs_fs__changes_bloom_t objects; the key is the
+     (revision, 0) pair. */
+  svn_cache__t *changes_bloom_cache;
+
+  /* Cache for svn_fs_fs__changes_index_t objects; the key is the
+     (revision, 0) pair. */
+  svn_cache__t *changes_index_cache;
+
+  /* Cache for svn_fs_fs__lock_digest_t objects; the key is the name of
+     the respective lock digest file, i.e. the MD5 digest of the locked
+     FS path. */
+  svn_cache__t *lock_digest_cache;
+
   /* Cache for svn_fs_fs__rep_header_t objects; the key is a
      (revision, item index) pair */
   svn_cache__t *rep_header_cache;
@@ -456,6 +541,11 @@ typedef struct fs_fs_data_t
      unparsed FS ID to ###x.  NULL outside transactions. */
   svn_cache__t *txn_dir_cache;
 
+  /* Temporary cache for the transaction's own mutable node revisions;
+     maps from unparsed FS ID to NODE_REVISION_T.  NULL outside
+     transactions. */
+  svn_cache__t *txn_node_cache;
+
   /* Data shared between all svn_fs_t objects for a given filesystem. */
   fs_fs_shared_data_t *shared;
 
@@ -493,10 +583,21 @@ typedef struct fs_fs_data_t
    * deltification history after which skip deltas will be used. */
   apr_int64_t max_linear_deltification;
 
+  /* Delta chain length at which we force a fulltext snapshot instead of
+   * deltifying, bounding the number of windows to combine upon reading.
+   * 0 means to derive the limit from max_linear_deltification. */
+  apr_int64_t max_delta_chain_length;
+
+  /* Whether to run a content similarity probe over multiple delta base
+   * candidates when storing file contents, instead of trusting the
+   * revision-distance heuristics alone. */
+  svn_boolean_t probe_delta_bases;
+
   /* Compression type to use with txdelta storage format in new revs. */
   compression_type_t delta_compression_type;
 
-  /* Compression level (currently, only used with compression_type_zlib). */
+  /* Compression level (currently, only used with compression_type_zlib
+     and compression_type_zstd). */
   int delta_compression_level;
 
   /* Pack after every commit. */
@@ -514,6 +615,41 @@ typedef struct fs_fs_data_t
   /* Ensure that all filesystem changes are written to disk. */
   svn_boolean_t flush_to_disk;
 
+  /* Whether to aggregate the fsyncs at the end of a commit and run them
+     concurrently instead of issuing them serially as we go.  Only
+     relevant if flush_to_disk has been set. */
+  svn_boolean_t batch_fsync;
+
+  /* Number of worker threads to use when packing shards.  Values <= 1
+     mean "pack single-threaded". */
+  apr_int64_t pack_threads;
+
+  /* Number of worker threads to use when verifying the metadata of
+     rev / pack files.  Values <= 1 mean "verify single-threaded". */
+  apr_int64_t verify_threads;
+
+  /* Whether rev / pack files shall be memory-mapped for reading instead
+     of being accessed through buffered file I/O. */
+  svn_boolean_t use_mmap;
+
+  /* Number of shards to copy concurrently, i.e. the I/O depth, when this
+     filesystem is the source of a hotcopy.  Values <= 1 mean "copy
+     single-threaded". */
+  apr_int64_t hotcopy_threads;
+
+  /* During incremental hotcopy, skip re-examining revision data that the
+     destination's 'current' and 'min-unpacked-rev' markers prove to be
+     already present, relying on rev and pack files being immutable.
+     Mutable data (revprops) is still checked file by file. */
+  svn_boolean_t hotcopy_skip_immutable;
+
+  /* If not NULL, the directory that holds the transaction scratch
+     directories (node-revs, props, children files and proto indexes)
+     instead of db/transactions, e.g. a tmpfs location.  Proto revision
+     files stay inside the repository so moving them into place at
+     commit remains a same-device rename. */
+  const char *txn_scratch_dir;
+
   /* Pointer to svn_fs_open. */
   svn_error_t *(*svn_fs_open_)(svn_fs_t **, const char *, apr_hash_t *,
                                apr_pool_t *, apr_pool_t *);
@@ -658,6 +794,76 @@ typedef struct change_t
   svn_fs_path_change2_t info;
 } change_t;
 
+/* Number of bits in each of the two halves of a changed-paths bloom
+   filter.  Must be a power of two. */
+#define SVN_FS_FS__CHANGES_BLOOM_BITS 1024
+
+/* A compact summary of the paths changed in one revision.  It gives a
+   definite "no" or a conservative "maybe" to the question whether the
+   revision touched a given path, one of its ancestors or one of its
+   descendants, without parsing the changed-paths list.  Its size is
+   fixed (a few cache lines), independent of the size of the change
+   list; filters of huge revisions merely degrade towards "maybe". */
+typedef struct svn_fs_fs__changes_bloom_t
+{
+  /* Set for every changed path and each of its parent directories,
+     i.e. for everything that has a changed path in its sub-tree. */
+  apr_uint64_t subtree[SVN_FS_FS__CHANGES_BLOOM_BITS / 64];
+
+  /* Set for the changed paths themselves only. */
+  apr_uint64_t exact[SVN_FS_FS__CHANGES_BLOOM_BITS / 64];
+} svn_fs_fs__changes_bloom_t;
+
+/* A block directory of a revision's changed-paths list (only used at the
+   cache interface).  It records, for each block of up to
+   SVN_FS_FS__CHANGES_BLOCK_SIZE changes, the path of the block's first
+   change and the block's start offset within the list.  Since committed
+   lists are written in ascending path order, this allows filtered readers
+   to binary-search for the blocks relevant to a given path and fetch only
+   those instead of the full list. */
+typedef struct svn_fs_fs__changes_index_t
+{
+  /* Number of non-empty blocks in the changed-paths list. */
+  int count;
+
+  /* TRUE if the on-disk list is sorted by path in ascending byte order.
+     Lists written by old or 3rd-party code may not be; those directories
+     must not be used for binary search. */
+  svn_boolean_t sorted;
+
+  /* Array of COUNT byte offsets, relative to the start of the changed-
+     paths list, at which the respective block begins. */
+  apr_off_t *offsets;
+
+  /* Array of COUNT paths; element i is the path of the first change in
+     block i. */
+  const char **paths;
+} svn_fs_fs__changes_index_t;
+
+/* All data stored in a lock digest file (only used at the cache interface),
+   together with the attributes of the file it was read from.  A cached
+   instance is valid only as long as the on-disk file still has the recorded
+   mtime and size; this keeps readers coherent with lock changes made by
+   other processes. */
+typedef struct svn_fs_fs__lock_digest_t
+{
+  /* Modification time of the digest file when it was read. */
+  apr_time_t mtime;
+
+  /* Size of the digest file when it was read. */
+  svn_filesize_t size;
+
+  /* Lock on the path itself, or NULL if the path is not locked. */
+  svn_lock_t *lock;
+
+  /* Number of locked paths in this path's sub-tree. */
+  int count;
+
+  /* Array of COUNT digest file names, one per locked path in the
+     sub-tree. */
+  const char **children;
+} svn_fs_fs__lock_digest_t;
+
 
 /*** Context for reading changed paths lists iteratively. */
 typedef struct svn_fs_fs__changes_context_t
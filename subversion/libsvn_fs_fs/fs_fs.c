@@ -693,7 +693,8 @@ parse_compression_option(compression_type_t *compression_type_p,
   int level;
   svn_boolean_t is_valid = TRUE;
 
-  /* compression = none | lz4 | zlib | zlib-1 ... zlib-9 */
+  /* compression = none | lz4 | zlib | zlib-1 ... zlib-9
+   *             | zstd | zstd-1 ... zstd-19 */
   if (strcmp(value, "none") == 0)
     {
       type = compression_type_none;
@@ -704,6 +705,26 @@ parse_compression_option(compression_type_t *compression_type_p,
       type = compression_type_lz4;
       level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
     }
+  else if (strncmp(value, "zstd", 4) == 0)
+    {
+      const char *p = value + 4;
+
+      type = compression_type_zstd;
+      if (*p == 0)
+        {
+          level = SVN__COMPRESSION_ZSTD_DEFAULT;
+        }
+      else if (*p == '-')
+        {
+          p++;
+          SVN_ERR(svn_cstring_atoi(&level, p));
+          if (level < SVN__COMPRESSION_ZSTD_MIN
+              || level > SVN__COMPRESSION_ZSTD_MAX)
+            is_valid = FALSE;
+        }
+      else
+        is_valid = FALSE;
+    }
   else if (strncmp(value, "zlib", 4) == 0)
     {
       const char *p = value + 4;
@@ -780,6 +801,19 @@ read_config(fs_fs_data_t *ffd,
                                    CONFIG_SECTION_DELTIFICATION,
                                    CONFIG_OPTION_MAX_LINEAR_DELTIFICATION,
                                    SVN_FS_FS_MAX_LINEAR_DELTIFICATION));
+      SVN_ERR(svn_config_get_int64(config, &ffd->max_delta_chain_length,
+                                   CONFIG_SECTION_DELTIFICATION,
+                                   CONFIG_OPTION_MAX_DELTA_CHAIN_LENGTH,
+                                   0));
+
+      /* Sanitize: negative values behave like the default. */
+      if (ffd->max_delta_chain_length < 0)
+        ffd->max_delta_chain_length = 0;
+
+      SVN_ERR(svn_config_get_bool(config, &ffd->probe_delta_bases,
+                                  CONFIG_SECTION_DELTIFICATION,
+                                  CONFIG_OPTION_PROBE_DELTA_BASES,
+                                  FALSE));
     }
   else
     {
@@ -787,6 +821,8 @@ read_config(fs_fs_data_t *ffd,
       ffd->deltify_properties = FALSE;
       ffd->max_deltification_walk = SVN_FS_FS_MAX_DELTIFICATION_WALK;
       ffd->max_linear_deltification = SVN_FS_FS_MAX_LINEAR_DELTIFICATION;
+      ffd->max_delta_chain_length = 0;
+      ffd->probe_delta_bases = FALSE;
     }
 
   /* Initialize revprop packing settings in ffd. */
@@ -861,6 +897,80 @@ read_config(fs_fs_data_t *ffd,
       ffd->pack_after_commit = FALSE;
     }
 
+  /* Whether to memory-map rev / pack files for reading.  This is
+     independent of the repository format. */
+  SVN_ERR(svn_config_get_bool(config, &ffd->use_mmap,
+                              CONFIG_SECTION_IO,
+                              CONFIG_OPTION_USE_MMAP, FALSE));
+
+  /* Whether to aggregate and parallelize the fsyncs at the end of a
+     commit.  Also format-independent. */
+  SVN_ERR(svn_config_get_bool(config, &ffd->batch_fsync,
+                              CONFIG_SECTION_IO,
+                              CONFIG_OPTION_BATCH_FSYNC, FALSE));
+
+  /* Number of shards to copy concurrently when this filesystem is the
+     source of a hotcopy.  Also format-independent. */
+  SVN_ERR(svn_config_get_int64(config, &ffd->hotcopy_threads,
+                               CONFIG_SECTION_IO,
+                               CONFIG_OPTION_HOTCOPY_THREADS, 1));
+
+  /* Sanitize (also caps the number of concurrently open file handles). */
+  if (ffd->hotcopy_threads < 1)
+    ffd->hotcopy_threads = 1;
+  if (ffd->hotcopy_threads > 64)
+    ffd->hotcopy_threads = 64;
+
+  /* Whether incremental hotcopy may skip re-examining immutable revision
+     data that is already present in the destination. */
+  SVN_ERR(svn_config_get_bool(config, &ffd->hotcopy_skip_immutable,
+                              CONFIG_SECTION_IO,
+                              CONFIG_OPTION_HOTCOPY_SKIP_IMMUTABLE, FALSE));
+
+  /* Optional location for transaction scratch data, e.g. on tmpfs.
+     Also format-independent. */
+  {
+    const char *txn_scratch_dir;
+
+    svn_config_get(config, &txn_scratch_dir,
+                   CONFIG_SECTION_TRANSACTIONS,
+                   CONFIG_OPTION_TXN_SCRATCH_DIR, NULL);
+    if (txn_scratch_dir && *txn_scratch_dir)
+      ffd->txn_scratch_dir = svn_dirent_internal_style(txn_scratch_dir,
+                                                       result_pool);
+    else
+      ffd->txn_scratch_dir = NULL;
+  }
+
+  /* Initialize packing settings in ffd. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
+    {
+      SVN_ERR(svn_config_get_int64(config, &ffd->pack_threads,
+                                   CONFIG_SECTION_PACKING,
+                                   CONFIG_OPTION_PACK_THREADS, 1));
+
+      /* Sanitize (also caps the number of concurrently open temp files). */
+      if (ffd->pack_threads < 1)
+        ffd->pack_threads = 1;
+      if (ffd->pack_threads > 64)
+        ffd->pack_threads = 64;
+
+      SVN_ERR(svn_config_get_int64(config, &ffd->verify_threads,
+                                   CONFIG_SECTION_PACKING,
+                                   CONFIG_OPTION_VERIFY_THREADS, 1));
+
+      /* Sanitize (also caps the number of concurrently open file handles). */
+      if (ffd->verify_threads < 1)
+        ffd->verify_threads = 1;
+      if (ffd->verify_threads > 64)
+        ffd->verify_threads = 64;
+    }
+  else
+    {
+      ffd->pack_threads = 1;
+      ffd->verify_threads = 1;
+    }
+
   /* Initialize compression settings in ffd. */
   if (ffd->format >= SVN_FS_FS__MIN_DELTIFICATION_FORMAT)
     {
@@ -891,6 +1001,20 @@ read_config(fs_fs_data_t *ffd,
                                       _("Compression type 'lz4' requires "
                                         "filesystem format 8 or higher"));
             }
+          if (ffd->delta_compression_type == compression_type_zstd)
+            {
+#ifndef SVN_HAVE_ZSTD
+              return svn_error_create(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                      _("Compression type 'zstd' requires "
+                                        "Subversion to be built with zstd "
+                                        "support"));
+#else
+              if (ffd->format < SVN_FS_FS__MIN_SVNDIFF3_FORMAT)
+                return svn_error_create(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                        _("Compression type 'zstd' requires "
+                                          "filesystem format 9 or higher"));
+#endif
+            }
         }
       else if (compression_level_val)
         {
@@ -946,6 +1070,13 @@ read_config(fs_fs_data_t *ffd,
                               CONFIG_SECTION_CACHES, CONFIG_OPTION_FAIL_STOP,
                               FALSE));
 
+  /* Relative weight of this repository in a shared cache. */
+  SVN_ERR(svn_config_get_int64(config, &ffd->cache_weight,
+                               CONFIG_SECTION_CACHES,
+                               CONFIG_OPTION_CACHE_WEIGHT,
+                               100));
+  ffd->cache_weight = MIN(MAX(1, ffd->cache_weight), 10000);
+
   return SVN_NO_ERROR;
 }
 
@@ -978,6 +1109,13 @@ write_config(svn_fs_t *fs,
 "### configured (and ignoring it with file:// access).  To make"             NL
 "### Subversion never ignore cache errors, uncomment this line."             NL
 "# " CONFIG_OPTION_FAIL_STOP " = true"                                       NL
+"### When multiple repositories share one server-side cache, eviction"       NL
+"### treats their entries by relative weight, in percent.  Raising the"      NL
+"### weight of a small but frequently used repository lets it retain its"    NL
+"### working set under pressure from bulk operations on larger"              NL
+"### repositories; lowering it makes the repository yield cache space"       NL
+"### first.  The neutral default is 100; valid values are 1 to 10000."       NL
+"# " CONFIG_OPTION_CACHE_WEIGHT " = 100"                                     NL
 ""                                                                           NL
 "[" CONFIG_SECTION_REP_SHARING "]"                                           NL
 "### To conserve space, the filesystem can optionally avoid storing"         NL
@@ -1056,19 +1194,49 @@ write_config(svn_fs_t *fs,
 "### For 1.8, the default value is 16; earlier versions use 1."              NL
 "# " CONFIG_OPTION_MAX_LINEAR_DELTIFICATION " = 16"                          NL
 "###"                                                                        NL
+"### Reading a node stored as a delta must combine all deltas down the"      NL
+"### chain to the nearest fulltext.  Where rep-sharing lets such chains"     NL
+"### grow long, e.g. for small files changed in tens of thousands of"        NL
+"### revisions, read latency grows with them.  Once the chain behind the"    NL
+"### chosen delta base has reached the length configured here, the new"      NL
+"### node will be stored as fulltext instead, bounding the read cost at"     NL
+"### some expense in disk space.  Smaller values trade disk space for"       NL
+"### lower worst-case read latency."                                         NL
+"### A value of 0 (the default) limits chains to twice the"                  NL
+"### " CONFIG_OPTION_MAX_LINEAR_DELTIFICATION " value plus 2."               NL
+"# " CONFIG_OPTION_MAX_DELTA_CHAIN_LENGTH " = 0"                             NL
+"###"                                                                        NL
+"### The delta base is normally picked by revision distance alone.  For"     NL
+"### contents that oscillate between a small number of states, e.g."         NL
+"### periodic database dumps, the nearest ancestor can be the least"         NL
+"### similar one and produce deltas many times larger than necessary."       NL
+"### When enabled, this setting compares a sample of the incoming file"      NL
+"### content against several candidate bases using a cheap similarity"       NL
+"### sketch and deltifies against the most similar one.  This adds a"        NL
+"### small amount of read I/O to each file commit."                          NL
+"### The default value is false."                                            NL
+"# " CONFIG_OPTION_PROBE_DELTA_BASES " = false"                              NL
+"###"                                                                        NL
 "### After deltification, we compress the data to minimize on-disk size."    NL
 "### This setting controls the compression algorithm, which will be used in" NL
 "### future revisions.  It can be used to either disable compression or to"  NL
-"### select between available algorithms (zlib, lz4).  zlib is a general-"   NL
-"### purpose compression algorithm.  lz4 is a fast compression algorithm"    NL
-"### which should be preferred for repositories with large and, possibly,"   NL
-"### incompressible files.  Note that the compression ratio of lz4 is"       NL
-"### usually lower than the one provided by zlib, but using it can"          NL
+"### select between available algorithms (zlib, lz4, zstd).  zlib is a"     NL
+"### general-purpose compression algorithm.  lz4 is a fast compression"      NL
+"### algorithm which should be preferred for repositories with large and,"   NL
+"### possibly, incompressible files.  Note that the compression ratio of"    NL
+"### lz4 is usually lower than the one provided by zlib, but using it can"   NL
 "### significantly speed up commits as well as reading the data."            NL
-"### lz4 compression algorithm is supported, starting from format 8"         NL
-"### repositories, available in Subversion 1.10 and higher."                 NL
+"### zstd combines a compression ratio comparable to zlib with speeds"       NL
+"### much closer to lz4; higher zstd levels such as zstd-19 maximize the"    NL
+"### on-disk savings for write-once data, e.g. in repositories that get"     NL
+"### packed after every commit, at the expense of commit speed.  zstd is"    NL
+"### only available if Subversion has been built with zstd support and"      NL
+"### only such builds will be able to read the repository."                  NL
+"### lz4 and zstd compression algorithms are supported, starting from"       NL
+"### format 8 repositories, available in Subversion 1.10 and higher."        NL
 "### The syntax of this option is:"                                          NL
 "###   " CONFIG_OPTION_COMPRESSION " = none | lz4 | zlib | zlib-1 ... zlib-9" NL
+"###                                 | zstd | zstd-1 ... zstd-19"            NL
 "### Versions prior to Subversion 1.10 will ignore this option."             NL
 "### The default value is 'lz4' if supported by the repository format and"   NL
 "### 'zlib' otherwise.  'zlib' is currently equivalent to 'zlib-5'."         NL
@@ -1099,6 +1267,10 @@ write_config(svn_fs_t *fs,
 "### To save disk space, packed revprop files may be compressed.  Standard"  NL
 "### revprops tend to allow for very effective compression.  Reading and"    NL
 "### even more so writing, become significantly more CPU intensive."         NL
+"### Revprops of a whole pack file group are compressed as a single"         NL
+"### block, amortizing the compression overhead of the many small"           NL
+"### property lists within a shard; 'svnadmin pack' uses the maximum zlib"   NL
+"### level for these write-once files."                                      NL
 "### Compressing packed revprops is disabled by default."                    NL
 "# " CONFIG_OPTION_COMPRESS_PACKED_REVPROPS " = false"                       NL
 ""                                                                           NL
@@ -1148,6 +1320,91 @@ write_config(svn_fs_t *fs,
 "### Must be a power of 2."                                                  NL
 "### p2l-page-size is given in kBytes and with a default of 1024 kBytes."    NL
 "# " CONFIG_OPTION_P2L_PAGE_SIZE " = 1024"                                   NL
+"###"                                                                        NL
+"### When set to true, rev and pack files will be memory-mapped for"         NL
+"### reading where the APR supports it.  Data and index contents can then"   NL
+"### be served directly from the OS page cache without per-access syscall"   NL
+"### and copy overhead.  This is most useful on read-heavy servers whose"    NL
+"### repositories fit largely into the file system cache.  On 32 bit"       NL
+"### systems, large pack files may exhaust the address space, so this"       NL
+"### should only be enabled on 64 bit servers."                              NL
+"### use-mmap is false by default."                                          NL
+"# " CONFIG_OPTION_USE_MMAP " = false"                                       NL
+"###"                                                                        NL
+"### When set to true, the fsyncs issued at the end of a commit will be"     NL
+"### aggregated and run concurrently instead of serially in the order the"   NL
+"### files got written.  On storage with high sync latency, e.g. SANs or"    NL
+"### network filesystems, this can cut the sync overhead per commit"         NL
+"### roughly in half.  The revision is made visible in the 'current' file"   NL
+"### only after all its data has been flushed, so the commit guarantees"     NL
+"### remain unchanged.  Requires thread support in APR to have an effect."   NL
+"### This setting is ignored if flushing has been disabled altogether via"   NL
+"### SVN_FS_CONFIG_NO_FLUSH_TO_DISK."                                        NL
+"### batch-fsync is false by default."                                       NL
+"# " CONFIG_OPTION_BATCH_FSYNC " = false"                                    NL
+"###"                                                                        NL
+"### Number of shards to copy concurrently when this repository is the"      NL
+"### source of 'svnadmin hotcopy', i.e. the I/O depth of the copy."          NL
+"### Storage arrays and network filesystems often absorb writes from"        NL
+"### several streams much faster than from a single one, so raising this"    NL
+"### can cut the hotcopy time of large repositories drastically.  When"      NL
+"### set to more than 1, the destination's 'current' file is updated"        NL
+"### only once at the very end of the hotcopy instead of shard by shard."    NL
+"### Requires thread support in APR to have an effect."                      NL
+"### hotcopy-threads is 1 by default, i.e. copy one shard at a time."        NL
+"# " CONFIG_OPTION_HOTCOPY_THREADS " = 1"                                    NL
+"###"                                                                        NL
+"### When set to true, incremental hotcopies from this repository will"      NL
+"### not re-examine revision data that the destination's 'current' and"      NL
+"### 'min-unpacked-rev' markers prove to be already present.  Rev and"       NL
+"### pack files are immutable once written, so only mutable data, i.e."      NL
+"### revision properties, is still compared file by file.  This turns"       NL
+"### the incremental hotcopy of a mostly unchanged repository from a"        NL
+"### full stat scan into a copy of just the new data.  Leave this off"       NL
+"### if you rely on incremental hotcopy to repair a destination whose"       NL
+"### revision data may have been damaged or truncated."                      NL
+"### hotcopy-skip-immutable is false by default."                            NL
+"# " CONFIG_OPTION_HOTCOPY_SKIP_IMMUTABLE " = false"                         NL
+""                                                                           NL
+"[" CONFIG_SECTION_PACKING "]"                                               NL
+"### Parameters in this section control the behavior of the offline"         NL
+"### maintenance operations 'svnadmin pack' and 'svnadmin verify'."          NL
+"###"                                                                        NL
+"### Number of shards to pack concurrently.  Packing the revision data of"   NL
+"### independent shards is an embarrassingly parallel task;  only the"       NL
+"### final switch-over to the packed data needs to be serialized.  On"       NL
+"### repositories with many unpacked shards, using one thread per spare"     NL
+"### CPU core can reduce the total pack time drastically.  Values larger"    NL
+"### than 1 require thread support in APR and temporarily use up to"         NL
+"### pack-threads times the single-threaded amount of memory and temp"       NL
+"### disk space."                                                            NL
+"### pack-threads is 1 by default, i.e. pack one shard at a time."           NL
+"# " CONFIG_OPTION_PACK_THREADS " = 1"                                       NL
+"###"                                                                        NL
+"### Number of rev / pack files whose metadata shall be verified"            NL
+"### concurrently by 'svnadmin verify'.  The index cross-checks and"         NL
+"### checksum verification for separate files are independent of one"        NL
+"### another and scale almost linearly with the number of spare CPU"         NL
+"### cores.  Values larger than 1 require thread support in APR and"         NL
+"### will use proportionally more memory and open file handles."             NL
+"### verify-threads is 1 by default, i.e. verify one file at a time."        NL
+"# " CONFIG_OPTION_VERIFY_THREADS " = 1"                                     NL
+""                                                                           NL
+"[" CONFIG_SECTION_TRANSACTIONS "]"                                          NL
+"### Directory to hold in-progress transaction scratch data instead of"      NL
+"### the repository's db/transactions directory.  Pointing this at a"        NL
+"### fast device such as a tmpfs removes the many small scratch writes"      NL
+"### a commit performs from the repository's storage; only the final"        NL
+"### revision data is moved into the repository at commit time.  Proto"      NL
+"### revision files always stay inside the repository, so that move is"      NL
+"### a durable same-device rename on 1.5+ format repositories; where a"      NL
+"### move does cross devices, a copy with an fsync is used instead."         NL
+"### The directory must be private to this repository and must not be"       NL
+"### shared between repositories.  If the scratch device is cleared,"        NL
+"### e.g. by a reboot, any transactions in progress at that time are"        NL
+"### lost; committed revisions are unaffected."                              NL
+"### scratch-dir is empty by default, i.e. use db/transactions."             NL
+"# " CONFIG_OPTION_TXN_SCRATCH_DIR " ="                                      NL
 ""                                                                           NL
 "[" CONFIG_SECTION_DEBUG "]"                                                 NL
 "###"                                                                        NL
@@ -1171,6 +1428,9 @@ read_global_config(svn_fs_t *fs)
   ffd->use_block_read = svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_FSFS_BLOCK_READ,
                                            FALSE);
+  ffd->bulk_reads = svn_hash__get_bool(fs->config,
+                                       SVN_FS_CONFIG_FSFS_BULK_READS,
+                                       FALSE);
   ffd->flush_to_disk = !svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                                            FALSE);
@@ -1952,6 +2212,13 @@ svn_fs_fs__create(svn_fs_t *fs,
           case 9: format = 7;
                   break;
 
+          case 10:
+          case 11:
+          case 12:
+          case 13:
+          case 14: format = 8;
+                  break;
+
           default:format = SVN_FS_FS__FORMAT_NUMBER;
         }
 
@@ -2323,8 +2590,11 @@ svn_fs_fs__info_format(int *fs_format,
     case 8:
       (*supports_version)->minor = 10;
       break;
+    case 9:
+      (*supports_version)->minor = 15;
+      break;
 #ifdef SVN_DEBUG
-# if SVN_FS_FS__FORMAT_NUMBER != 8
+# if SVN_FS_FS__FORMAT_NUMBER != 9
 #  error "Need to add a 'case' statement here"
 # endif
 #endif
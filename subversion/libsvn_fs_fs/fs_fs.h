@@ -305,13 +305,16 @@ void
 svn_fs_fs__reset_txn_caches(svn_fs_t *fs);
 
 /* Scan all contents of the repository FS and return statistics in *STATS,
- * allocated in RESULT_POOL.  Report progress through PROGRESS_FUNC with
- * PROGRESS_BATON, if PROGRESS_FUNC is not NULL.
+ * allocated in RESULT_POOL.  Scan up to NUM_THREADS packed shards
+ * concurrently; 0 / 1 mean serial processing and the value is ignored on
+ * builds without thread support.  Report progress through PROGRESS_FUNC
+ * with PROGRESS_BATON, if PROGRESS_FUNC is not NULL.
  * Use SCRATCH_POOL for temporary allocations.
  */
 svn_error_t *
 svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
                      svn_fs_t *fs,
+                     apr_size_t num_threads,
                      svn_fs_progress_notify_func_t progress_func,
                      void *progress_baton,
                      svn_cancel_func_t cancel_func,
@@ -19,9 +19,13 @@
  *    under the License.
  * ====================================================================
  */
+#include <apr_thread_proc.h>
+
 #include "svn_pools.h"
 #include "svn_path.h"
 #include "svn_dirent_uri.h"
+#include "svn_sorts.h"
+#include "private/svn_thread_batch.h"
 
 #include "fs_fs.h"
 #include "hotcopy.h"
@@ -280,7 +284,11 @@ hotcopy_copy_shard_file(svn_boolean_t *skipped_p,
 /* Copy a packed shard containing revision REV, and which contains
  * MAX_FILES_PER_DIR revisions, from SRC_FS to DST_FS.
  * Update *DST_MIN_UNPACKED_REV in case the shard is new in DST_FS.
- * Do not re-copy data which already exists in DST_FS.
+ * DST_MIN_UNPACKED_REV may be NULL if the caller takes care of the
+ * min-unpacked-rev file itself.
+ * Do not re-copy data which already exists in DST_FS.  If COPY_REV_DATA
+ * is FALSE, don't even look at the (immutable) packed revision data and
+ * only copy the revprops.
  * Set *SKIPPED_P to FALSE only if at least one part of the shard
  * was copied, do not change the value in *SKIPPED_P otherwise.
  * SKIPPED_P may be NULL if not required.
@@ -292,6 +300,7 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
                           svn_fs_t *dst_fs,
                           svn_revnum_t rev,
                           int max_files_per_dir,
+                          svn_boolean_t copy_rev_data,
                           apr_pool_t *scratch_pool)
 {
   const char *src_subdir;
@@ -303,17 +312,21 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
   fs_fs_data_t *src_ffd = src_fs->fsap_data;
 
   /* Copy the packed shard. */
-  src_subdir = svn_dirent_join(src_fs->path, PATH_REVS_DIR, scratch_pool);
-  dst_subdir = svn_dirent_join(dst_fs->path, PATH_REVS_DIR, scratch_pool);
-  packed_shard = apr_psprintf(scratch_pool, "%ld" PATH_EXT_PACKED_SHARD,
-                              rev / max_files_per_dir);
-  src_subdir_packed_shard = svn_dirent_join(src_subdir, packed_shard,
-                                            scratch_pool);
-  SVN_ERR(hotcopy_io_copy_dir_recursively(skipped_p, src_subdir_packed_shard,
-                                          dst_subdir, packed_shard,
-                                          TRUE /* copy_perms */,
-                                          NULL /* cancel_func */, NULL,
-                                          scratch_pool));
+  if (copy_rev_data)
+    {
+      src_subdir = svn_dirent_join(src_fs->path, PATH_REVS_DIR, scratch_pool);
+      dst_subdir = svn_dirent_join(dst_fs->path, PATH_REVS_DIR, scratch_pool);
+      packed_shard = apr_psprintf(scratch_pool, "%ld" PATH_EXT_PACKED_SHARD,
+                                  rev / max_files_per_dir);
+      src_subdir_packed_shard = svn_dirent_join(src_subdir, packed_shard,
+                                                scratch_pool);
+      SVN_ERR(hotcopy_io_copy_dir_recursively(skipped_p,
+                                              src_subdir_packed_shard,
+                                              dst_subdir, packed_shard,
+                                              TRUE /* copy_perms */,
+                                              NULL /* cancel_func */, NULL,
+                                              scratch_pool));
+    }
 
   /* Copy revprops belonging to revisions in this pack. */
   src_subdir = svn_dirent_join(src_fs->path, PATH_REVPROPS_DIR, scratch_pool);
@@ -358,7 +371,7 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
     }
 
   /* If necessary, update the min-unpacked rev file in the hotcopy. */
-  if (*dst_min_unpacked_rev < rev + max_files_per_dir)
+  if (dst_min_unpacked_rev && *dst_min_unpacked_rev < rev + max_files_per_dir)
     {
       *dst_min_unpacked_rev = rev + max_files_per_dir;
       SVN_ERR(svn_fs_fs__write_min_unpacked_rev(dst_fs,
@@ -532,6 +545,293 @@ remove_folder(const char *path,
   return svn_error_trace(err);
 }
 
+#if APR_HAS_THREADS
+/* A unit of concurrent hotcopy work: either one packed shard or the
+ * unpacked revision (and revprop) files of one shard. */
+struct hotcopy_task_baton
+{
+  svn_fs_t *src_fs;
+  svn_fs_t *dst_fs;
+  svn_boolean_t incremental;
+  int max_files_per_dir;
+  const char *src_revs_dir;
+  const char *dst_revs_dir;
+  const char *src_revprops_dir;
+  const char *dst_revprops_dir;
+
+  /* Copy the packed shard starting at START_REV instead of the unpacked
+     revision files START_REV .. END_REV? */
+  svn_boolean_t packed;
+
+  /* For packed tasks: copy the pack itself or only the revprops (FALSE
+     when the destination is known to contain the immutable pack)? */
+  svn_boolean_t copy_rev_data;
+
+  /* For unpacked tasks: first revision whose rev file must be copied.
+     Rev files of older revisions are known to exist in the destination
+     and only their revprops are copied. */
+  svn_revnum_t first_mutable_rev;
+
+  /* Revision range covered by this task, both inclusive. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+
+  /* Did the task copy at least one file? */
+  svn_boolean_t skipped;
+};
+
+/* Copy the revision range described by TASK from TASK->SRC_FS to
+ * TASK->DST_FS without updating any global destination state ('current'
+ * and min-unpacked-rev remain untouched).  Use POOL for temporary
+ * allocations.
+ */
+static svn_error_t *
+hotcopy_task_body(struct hotcopy_task_baton *task,
+                  apr_pool_t *pool)
+{
+  if (task->packed)
+    {
+      fs_fs_data_t *dst_ffd = task->dst_fs->fsap_data;
+
+      /* Copy the packed shard.  The min-unpacked-rev file is handled
+       * by the caller, before and after running the tasks. */
+      SVN_ERR(hotcopy_copy_packed_shard(&task->skipped, NULL,
+                                        task->src_fs, task->dst_fs,
+                                        task->start_rev,
+                                        task->max_files_per_dir,
+                                        task->copy_rev_data,
+                                        pool));
+
+      /* Remove revision files which are now packed. */
+      if (task->incremental)
+        {
+          SVN_ERR(hotcopy_remove_rev_files(task->dst_fs, task->start_rev,
+                                           task->end_rev + 1,
+                                           task->max_files_per_dir, pool));
+          if (dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+            SVN_ERR(hotcopy_remove_revprop_files(task->dst_fs,
+                                                 task->start_rev,
+                                                 task->end_rev + 1,
+                                                 task->max_files_per_dir,
+                                                 pool));
+        }
+
+      /* Now that all revisions have moved into the pack, the original
+       * rev dir can be removed. */
+      SVN_ERR(remove_folder(svn_fs_fs__path_rev_shard(task->dst_fs,
+                                                      task->start_rev,
+                                                      pool),
+                            NULL, NULL, pool));
+      if (task->start_rev > 0
+          && dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+        SVN_ERR(remove_folder(svn_fs_fs__path_revprops_shard(task->dst_fs,
+                                                             task->start_rev,
+                                                             pool),
+                              NULL, NULL, pool));
+    }
+  else
+    {
+      apr_pool_t *iterpool = svn_pool_create(pool);
+      svn_revnum_t rev;
+
+      /* Copy pairs of non-packed revisions and revprop files. */
+      for (rev = task->start_rev; rev <= task->end_rev; rev++)
+        {
+          svn_pool_clear(iterpool);
+
+          if (rev >= task->first_mutable_rev)
+            SVN_ERR(hotcopy_copy_shard_file(&task->skipped,
+                                            task->src_revs_dir,
+                                            task->dst_revs_dir, rev,
+                                            task->max_files_per_dir,
+                                            iterpool));
+          SVN_ERR(hotcopy_copy_shard_file(&task->skipped,
+                                          task->src_revprops_dir,
+                                          task->dst_revprops_dir, rev,
+                                          task->max_files_per_dir,
+                                          iterpool));
+        }
+      svn_pool_destroy(iterpool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_batch__work_func_t.  Copy the revision range
+ * described by BATON, a struct hotcopy_task_baton. */
+static svn_error_t *
+hotcopy_task(void *baton,
+             apr_pool_t *task_pool)
+{
+  return svn_error_trace(hotcopy_task_body(baton, task_pool));
+}
+
+/* Baton for the task dispatcher callbacks, carrying the parameters of
+ * hotcopy_revisions_concurrently() plus the shard cursor. */
+struct hotcopy_batch_baton
+{
+  svn_fs_t *src_fs;
+  svn_fs_t *dst_fs;
+  svn_revnum_t src_youngest;
+  svn_revnum_t dst_youngest;
+  svn_boolean_t incremental;
+  svn_revnum_t src_min_unpacked_rev;
+  svn_revnum_t dst_min_unpacked_rev;
+  const char *src_revs_dir;
+  const char *dst_revs_dir;
+  const char *src_revprops_dir;
+  const char *dst_revprops_dir;
+
+  /* Shall we trust the destination's 'current' and 'min-unpacked-rev'
+   * markers and not re-examine the immutable revision data they cover? */
+  svn_boolean_t skip_immutable;
+
+  /* First revision of the next shard to dispatch a task for. */
+  svn_revnum_t next_rev;
+
+  /* Notification callback, may be NULL. */
+  svn_fs_hotcopy_notify_t notify_func;
+  void *notify_baton;
+};
+
+/* Implements svn_thread_batch__init_func_t with CONTEXT being a struct
+ * hotcopy_batch_baton.  Describe the copy of the next shard - packed or
+ * unpacked - in *BATON. */
+static svn_error_t *
+init_hotcopy_task(void **baton,
+                  void *context,
+                  apr_pool_t *task_pool,
+                  apr_pool_t *scratch_pool)
+{
+  struct hotcopy_batch_baton *bb = context;
+  fs_fs_data_t *src_ffd = bb->src_fs->fsap_data;
+  int max_files_per_dir = src_ffd->max_files_per_dir;
+  struct hotcopy_task_baton *task;
+
+  if (bb->next_rev > bb->src_youngest)
+    return SVN_NO_ERROR;
+
+  task = apr_pcalloc(task_pool, sizeof(*task));
+  task->src_fs = bb->src_fs;
+  task->dst_fs = bb->dst_fs;
+  task->incremental = bb->incremental;
+  task->max_files_per_dir = max_files_per_dir;
+  task->src_revs_dir = bb->src_revs_dir;
+  task->dst_revs_dir = bb->dst_revs_dir;
+  task->src_revprops_dir = bb->src_revprops_dir;
+  task->dst_revprops_dir = bb->dst_revprops_dir;
+  task->skipped = TRUE;
+
+  task->start_rev = bb->next_rev;
+  task->first_mutable_rev
+    = bb->skip_immutable ? bb->dst_youngest + 1 : 0;
+  if (bb->next_rev < bb->src_min_unpacked_rev)
+    {
+      task->packed = TRUE;
+      task->end_rev = bb->next_rev + max_files_per_dir - 1;
+
+      /* The pack itself is immutable; copy it only if it was
+       * not already packed in the destination. */
+      task->copy_rev_data
+        = !(bb->skip_immutable
+            && task->end_rev < bb->dst_min_unpacked_rev);
+    }
+  else
+    {
+      /* Unpacked revisions, up to the end of the shard. */
+      task->end_rev = MIN(bb->src_youngest,
+                          (bb->next_rev / max_files_per_dir + 1)
+                            * max_files_per_dir - 1);
+    }
+  bb->next_rev = task->end_rev + 1;
+
+  *baton = task;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_batch__process_func_t with CONTEXT being a
+ * struct hotcopy_batch_baton.  Notify about the revision ranges copied
+ * by TASKS from this thread only and in ascending revision order. */
+static svn_error_t *
+process_hotcopy_tasks(apr_array_header_t *tasks,
+                      void *context,
+                      apr_pool_t *scratch_pool)
+{
+  struct hotcopy_batch_baton *bb = context;
+  int i;
+
+  SVN_ERR(svn_thread_batch__collect(tasks));
+
+  if (bb->notify_func)
+    for (i = 0; i < tasks->nelts; ++i)
+      {
+        struct hotcopy_task_baton *task
+          = APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *)->baton;
+
+        if (!task->skipped)
+          bb->notify_func(bb->notify_baton, task->start_rev, task->end_rev,
+                          scratch_pool);
+      }
+
+  return SVN_NO_ERROR;
+}
+
+/* Copy all shards (packed and unpacked) up to SRC_YOUNGEST from SRC_FS
+ * to DST_FS, running up to SRC_FS's hotcopy-threads shard copies
+ * concurrently.  Assume that revisions up to SRC_MIN_UNPACKED_REV are
+ * packed in the source.  In contrast to the sequential implementation,
+ * do not checkpoint intermediate progress in the destination's 'current'
+ * and min-unpacked-rev files; the caller updates both once all tasks
+ * have completed.  Other parameters are as in hotcopy_revisions().
+ */
+static svn_error_t *
+hotcopy_revisions_concurrently(svn_fs_t *src_fs,
+                               svn_fs_t *dst_fs,
+                               svn_revnum_t src_youngest,
+                               svn_revnum_t dst_youngest,
+                               svn_boolean_t incremental,
+                               svn_revnum_t src_min_unpacked_rev,
+                               svn_revnum_t dst_min_unpacked_rev,
+                               const char *src_revs_dir,
+                               const char *dst_revs_dir,
+                               const char *src_revprops_dir,
+                               const char *dst_revprops_dir,
+                               svn_fs_hotcopy_notify_t notify_func,
+                               void* notify_baton,
+                               svn_cancel_func_t cancel_func,
+                               void* cancel_baton,
+                               apr_pool_t *pool)
+{
+  fs_fs_data_t *src_ffd = src_fs->fsap_data;
+  struct hotcopy_batch_baton baton;
+
+  baton.src_fs = src_fs;
+  baton.dst_fs = dst_fs;
+  baton.src_youngest = src_youngest;
+  baton.dst_youngest = dst_youngest;
+  baton.incremental = incremental;
+  baton.src_min_unpacked_rev = src_min_unpacked_rev;
+  baton.dst_min_unpacked_rev = dst_min_unpacked_rev;
+  baton.src_revs_dir = src_revs_dir;
+  baton.dst_revs_dir = dst_revs_dir;
+  baton.src_revprops_dir = src_revprops_dir;
+  baton.dst_revprops_dir = dst_revprops_dir;
+  baton.skip_immutable = incremental && src_ffd->hotcopy_skip_immutable;
+  baton.next_rev = 0;
+  baton.notify_func = notify_func;
+  baton.notify_baton = notify_baton;
+
+  return svn_error_trace(
+           svn_thread_batch__run((apr_size_t)src_ffd->hotcopy_threads,
+                                 init_hotcopy_task,
+                                 hotcopy_task,
+                                 process_hotcopy_tasks,
+                                 &baton,
+                                 cancel_func, cancel_baton,
+                                 pool));
+}
+#endif
+
 /* Copy the revision and revprop files (possibly sharded / packed) from
  * SRC_FS to DST_FS.  Do not re-copy data which already exists in DST_FS.
  * When copying packed or unpacked shards, checkpoint the result in DST_FS
@@ -561,9 +861,15 @@ hotcopy_revisions(svn_fs_t *src_fs,
   int max_files_per_dir = src_ffd->max_files_per_dir;
   svn_revnum_t src_min_unpacked_rev;
   svn_revnum_t dst_min_unpacked_rev;
+  svn_revnum_t dst_min_unpacked_at_start;
   svn_revnum_t rev;
   apr_pool_t *iterpool;
 
+  /* Shall we trust the destination's 'current' and 'min-unpacked-rev'
+   * markers and not re-examine the immutable revision data they cover? */
+  svn_boolean_t skip_immutable = incremental
+                                 && src_ffd->hotcopy_skip_immutable;
+
   /* Copy the min unpacked rev, and read its value. */
   if (src_ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
     {
@@ -593,9 +899,30 @@ hotcopy_revisions(svn_fs_t *src_fs,
       dst_min_unpacked_rev = 0;
     }
 
+  /* Shards below this watermark were already packed in the destination
+   * when we started, i.e. their immutable pack files are known to exist
+   * there. */
+  dst_min_unpacked_at_start = dst_min_unpacked_rev;
+
   if (cancel_func)
     SVN_ERR(cancel_func(cancel_baton));
 
+#if APR_HAS_THREADS
+  /* If so configured, copy independent shards concurrently.  That mode
+   * foregoes the per-shard 'current' checkpoints; the only revision
+   * ordering barrier is the final 'current' update by our caller. */
+  if (src_ffd->hotcopy_threads > 1 && max_files_per_dir > 0)
+    return svn_error_trace(hotcopy_revisions_concurrently(
+                               src_fs, dst_fs, src_youngest, dst_youngest,
+                               incremental,
+                               src_min_unpacked_rev,
+                               dst_min_unpacked_at_start,
+                               src_revs_dir, dst_revs_dir,
+                               src_revprops_dir, dst_revprops_dir,
+                               notify_func, notify_baton,
+                               cancel_func, cancel_baton, pool));
+#endif
+
   /*
    * Copy the necessary rev files.
    */
@@ -607,6 +934,13 @@ hotcopy_revisions(svn_fs_t *src_fs,
       svn_boolean_t skipped = TRUE;
       svn_revnum_t pack_end_rev;
 
+      /* Don't re-stat the pack files of shards that were already packed
+       * in the destination when we started - their contents can't have
+       * changed.  Revprops are mutable and still copied below. */
+      svn_boolean_t copy_rev_data
+        = !(skip_immutable
+            && rev + max_files_per_dir <= dst_min_unpacked_at_start);
+
       svn_pool_clear(iterpool);
 
       if (cancel_func)
@@ -616,7 +950,7 @@ hotcopy_revisions(svn_fs_t *src_fs,
       SVN_ERR(hotcopy_copy_packed_shard(&skipped, &dst_min_unpacked_rev,
                                         src_fs, dst_fs,
                                         rev, max_files_per_dir,
-                                        iterpool));
+                                        copy_rev_data, iterpool));
 
       pack_end_rev = rev + max_files_per_dir - 1;
 
@@ -690,11 +1024,13 @@ hotcopy_revisions(svn_fs_t *src_fs,
        * hotcopy with an ENOENT (revision file moved to a pack, so it is no
        * longer where we expect it to be). */
 
-      /* Copy the rev file. */
-      SVN_ERR(hotcopy_copy_shard_file(&skipped,
-                                      src_revs_dir, dst_revs_dir, rev,
-                                      max_files_per_dir,
-                                      iterpool));
+      /* Copy the rev file.  Rev files are immutable, so skip those the
+       * destination's 'current' proves to exist there already. */
+      if (!skip_immutable || rev > dst_youngest)
+        SVN_ERR(hotcopy_copy_shard_file(&skipped,
+                                        src_revs_dir, dst_revs_dir, rev,
+                                        max_files_per_dir,
+                                        iterpool));
       /* Copy the revprop file. */
       SVN_ERR(hotcopy_copy_shard_file(&skipped,
                                       src_revprops_dir, dst_revprops_dir,
@@ -186,6 +186,13 @@ struct svn_fs_fs__packed_number_stream_t
   /* underlying data file containing the packed values */
   apr_file_t *file;
 
+#if APR_HAS_MMAP
+  /* Read-only mapping of FILE, or NULL.  When given, numbers are decoded
+   * directly from the mapped pages, bypassing the seek / read syscalls
+   * and the intermediate copy buffer of the plain file code path. */
+  apr_mmap_t *mmap;
+#endif
+
   /* Offset within FILE at which the stream data starts
    * (i.e. which offset will reported as offset 0 by packed_stream_offset). */
   apr_off_t stream_start;
@@ -246,6 +253,106 @@ stream_error_create(svn_fs_fs__packed_number_stream_t *stream,
  * function into packed_stream_get() because it prevents the latter from
  * being inlined itself.
  */
+#if APR_HAS_MMAP
+/* Variant of packed_stream_read() for mmap-backed streams:  Decode up to
+ * MAX_NUMBER_PREFETCH numbers directly from the mapped pages at
+ * STREAM->NEXT_OFFSET and buffer them.  No seeks, reads or data copies
+ * are involved.
+ */
+SVN__PREVENT_INLINE
+static svn_error_t *
+packed_stream_read_mmap(svn_fs_fs__packed_number_stream_t *stream)
+{
+  const unsigned char *data = stream->mmap->mm;
+  apr_size_t bytes_left = MAX_NUMBER_PREFETCH;
+  apr_off_t block_left;
+  apr_size_t i;
+  value_position_pair_t *target;
+
+  /* all buffered data will have been read starting here */
+  stream->start_offset = stream->next_offset;
+  data += stream->next_offset;
+
+  /* decode at least one number but, if feasible, don't cross block
+   * boundaries.  This keeps the decode batches aligned with those of the
+   * plain file code path, i.e. with the OS page cache granularity.
+   */
+  block_left = stream->block_size
+               - (stream->next_offset % stream->block_size);
+  if (block_left >= 10 && block_left < bytes_left)
+    bytes_left = (apr_size_t)block_left;
+
+  /* Don't read beyond the end of the file section that belongs to this
+   * index / stream. */
+  bytes_left = (apr_size_t)MIN(bytes_left,
+                               stream->stream_end - stream->next_offset);
+
+  /* if the last number is incomplete, exclude it from this batch */
+  while (bytes_left > 0 && data[bytes_left-1] >= 0x80)
+    --bytes_left;
+
+  /* we call read() only if get() requires more data.  So, there must be
+   * at least *one* further number. */
+  if SVN__PREDICT_FALSE(bytes_left == 0)
+    {
+      const char *file_name;
+      SVN_ERR(svn_io_file_name_get(&file_name, stream->file,
+                                   stream->pool));
+      return svn_error_createf(SVN_ERR_FS_INDEX_CORRUPTION, NULL,
+                               _("Unexpected end of index file %s at "
+                                 "offset 0x%s"), file_name,
+                               apr_psprintf(stream->pool,
+                                            "%" APR_UINT64_T_HEX_FMT,
+                                            (apr_uint64_t)
+                                              stream->next_offset));
+    }
+
+  /* parse the mapped data and expand into the stream buffer */
+  target = stream->buffer;
+  for (i = 0; i < bytes_left;)
+    {
+      if (data[i] < 0x80)
+        {
+          /* numbers < 128 are relatively frequent and particularly easy
+           * to decode.  Give them special treatment. */
+          target->value = data[i];
+          ++i;
+          target->total_len = i;
+          ++target;
+        }
+      else
+        {
+          apr_uint64_t value = 0;
+          apr_uint64_t shift = 0;
+          while (data[i] >= 0x80)
+            {
+              value += ((apr_uint64_t)data[i] & 0x7f) << shift;
+              shift += 7;
+              ++i;
+            }
+
+          target->value = value + ((apr_uint64_t)data[i] << shift);
+          ++i;
+          target->total_len = i;
+          ++target;
+
+          /* let's catch corrupted data early.  It would surely cause
+           * havoc further down the line. */
+          if SVN__PREDICT_FALSE(shift > 8 * sizeof(value))
+            return svn_error_createf(SVN_ERR_FS_INDEX_CORRUPTION, NULL,
+                                     _("Corrupt index: number too large"));
+       }
+    }
+
+  /* update stream state */
+  stream->used = target - stream->buffer;
+  stream->next_offset = stream->start_offset + i;
+  stream->current = 0;
+
+  return SVN_NO_ERROR;
+}
+#endif
+
 SVN__PREVENT_INLINE
 static svn_error_t *
 packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
@@ -258,6 +365,11 @@ packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
   apr_off_t block_left = 0;
   apr_status_t err;
 
+#if APR_HAS_MMAP
+  if (stream->mmap)
+    return svn_error_trace(packed_stream_read_mmap(stream));
+#endif
+
   /* all buffered data will have been read starting here */
   stream->start_offset = stream->next_offset;
 
@@ -344,13 +456,15 @@ packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
 }
 
 /* Create and open a packed number stream reading from offsets START to
- * END in FILE and return it in *STREAM.  Access the file in chunks of
- * BLOCK_SIZE bytes.  Expect the stream to be prefixed by STREAM_PREFIX.
+ * END in the rev / pack file provided by REV_FILE and return it in
+ * *STREAM.  Access the file in chunks of BLOCK_SIZE bytes.  Expect the
+ * stream to be prefixed by STREAM_PREFIX.  If REV_FILE has been mapped
+ * into memory, decode directly from the mapping instead of reading.
  * Allocate *STREAM in RESULT_POOL and use SCRATCH_POOL for temporaries.
  */
 static svn_error_t *
 packed_stream_open(svn_fs_fs__packed_number_stream_t **stream,
-                   apr_file_t *file,
+                   svn_fs_fs__revision_file_t *rev_file,
                    apr_off_t start,
                    apr_off_t end,
                    const char *stream_prefix,
@@ -361,6 +475,7 @@ packed_stream_open(svn_fs_fs__packed_number_stream_t **stream,
   char buffer[STREAM_PREFIX_LEN + 1] = { 0 };
   apr_size_t len = strlen(stream_prefix);
   svn_fs_fs__packed_number_stream_t *result;
+  apr_file_t *file = rev_file->file;
 
   /* If this is violated, we forgot to adjust STREAM_PREFIX_LEN after
    * changing the index header prefixes. */
@@ -386,6 +501,15 @@ packed_stream_open(svn_fs_fs__packed_number_stream_t **stream,
   result->stream_start = start + len;
   result->stream_end = end;
 
+#if APR_HAS_MMAP
+  /* Only use the mapping if it actually covers this index section;
+   * it may be shorter e.g. if the file grew after being mapped. */
+  result->mmap = (   rev_file->mmap
+                  && (apr_off_t)rev_file->mmap->size >= end)
+               ? rev_file->mmap
+               : NULL;
+#endif
+
   result->used = 0;
   result->current = 0;
   result->start_offset = result->stream_start;
@@ -946,7 +1070,7 @@ auto_open_l2p_index(svn_fs_fs__revision_file_t *rev_file,
 
       SVN_ERR(svn_fs_fs__auto_read_footer(rev_file));
       SVN_ERR(packed_stream_open(&rev_file->l2p_stream,
-                                 rev_file->file,
+                                 rev_file,
                                  rev_file->l2p_offset,
                                  rev_file->p2l_offset,
                                  L2P_STREAM_PREFIX,
@@ -2138,7 +2262,7 @@ auto_open_p2l_index(svn_fs_fs__revision_file_t *rev_file,
 
       SVN_ERR(svn_fs_fs__auto_read_footer(rev_file));
       SVN_ERR(packed_stream_open(&rev_file->p2l_stream,
-                                 rev_file->file,
+                                 rev_file,
                                  rev_file->p2l_offset,
                                  rev_file->footer_offset,
                                  P2L_STREAM_PREFIX,
@@ -2635,19 +2759,18 @@ get_p2l_keys(p2l_page_info_baton_t *page_info_p,
   return SVN_NO_ERROR;
 }
 
-/* qsort-compatible compare function that compares the OFFSET of the
- * svn_fs_fs__p2l_entry_t in *LHS with the apr_off_t in *RHS. */
-static int
-compare_start_p2l_entry(const void *lhs,
-                        const void *rhs)
-{
-  const svn_fs_fs__p2l_entry_t *entry = lhs;
-  apr_off_t start = *(const apr_off_t*)rhs;
-  apr_off_t diff = entry->offset - start;
+/* Map a svn_fs_fs__p2l_entry_t * to its start OFFSET, for use with
+ * SVN_SORT__MAKE_BSEARCH_LOWER_BOUND. */
+#define P2L_ENTRY_OFFSET(entry) ((entry)->offset)
 
-  /* restrict result to int */
-  return diff < 0 ? -1 : (diff == 0 ? 0 : 1);
-}
+/* Binary search over arrays of svn_fs_fs__p2l_entry_t, ordered by their
+ * OFFSET member.  This runs in the innermost loop of every P2L lookup,
+ * so expand the comparison inline instead of paying for the comparator
+ * callback of the generic svn_sort__bsearch_lower_bound(). */
+SVN_SORT__MAKE_BSEARCH_LOWER_BOUND(p2l_entry_lower_bound,
+                                   svn_fs_fs__p2l_entry_t,
+                                   apr_off_t,
+                                   P2L_ENTRY_OFFSET)
 
 /* From the PAGE_ENTRIES array of svn_fs_fs__p2l_entry_t, ordered
  * by their OFFSET member, copy all elements overlapping the range
@@ -2659,8 +2782,7 @@ append_p2l_entries(apr_array_header_t *entries,
                    apr_off_t block_end)
 {
   const svn_fs_fs__p2l_entry_t *entry;
-  int idx = svn_sort__bsearch_lower_bound(page_entries, &block_start,
-                                          compare_start_p2l_entry);
+  int idx = p2l_entry_lower_bound(page_entries, block_start);
 
   /* start at the first entry that overlaps with BLOCK_START */
   if (idx > 0)
@@ -2924,18 +3046,6 @@ svn_fs_fs__p2l_index_lookup(apr_array_header_t **entries,
   return SVN_NO_ERROR;
 }
 
-/* compare_fn_t comparing a svn_fs_fs__p2l_entry_t at LHS with an offset
- * RHS.
- */
-static int
-compare_p2l_entry_offsets(const void *lhs, const void *rhs)
-{
-  const svn_fs_fs__p2l_entry_t *entry = (const svn_fs_fs__p2l_entry_t *)lhs;
-  apr_off_t offset = *(const apr_off_t *)rhs;
-
-  return entry->offset < offset ? -1 : (entry->offset == offset ? 0 : 1);
-}
-
 /* Cached data extraction utility.  DATA is a P2L index page, e.g. an APR
  * array of svn_fs_fs__p2l_entry_t elements.  Return the entry for the item,
  * allocated in RESULT_POOL, starting at OFFSET or NULL if that's not an
@@ -2951,14 +3061,20 @@ get_p2l_entry_from_cached_page(const void *data,
   const apr_array_header_t *page = data;
   apr_array_header_t *entries = apr_pmemdup(scratch_pool, page,
                                             sizeof(*page));
-  svn_fs_fs__p2l_entry_t *entry;
+  svn_fs_fs__p2l_entry_t *entry = NULL;
+  int idx;
 
   entries->elts = (char *)svn_temp_deserializer__ptr(page,
                                      (const void *const *)&page->elts);
 
   /* search of the offset we want */
-  entry = svn_sort__array_lookup(entries, &offset, NULL,
-      (int (*)(const void *, const void *))compare_p2l_entry_offsets);
+  idx = p2l_entry_lower_bound(entries, (apr_off_t)offset);
+  if (idx < entries->nelts)
+    {
+      entry = &APR_ARRAY_IDX(entries, idx, svn_fs_fs__p2l_entry_t);
+      if (entry->offset != (apr_off_t)offset)
+        entry = NULL;
+    }
 
   /* return it, if it is a perfect match */
   return entry ? apr_pmemdup(result_pool, entry, sizeof(*entry)) : NULL;
@@ -3015,12 +3131,19 @@ svn_fs_fs__p2l_entry_lookup(svn_fs_fs__p2l_entry_t **entry_p,
        * data to speed up future lookups. */
       apr_array_header_t *entries = apr_array_make(result_pool, 1,
                                                    sizeof(**entry_p));
+      int idx;
       SVN_ERR(p2l_index_lookup(entries, rev_file, fs, revision, offset,
                                offset + 1, scratch_pool));
 
       /* Find the entry that we want. */
-      *entry_p = svn_sort__array_lookup(entries, &offset, NULL,
-          (int (*)(const void *, const void *))compare_p2l_entry_offsets);
+      idx = p2l_entry_lower_bound(entries, offset);
+      if (idx < entries->nelts)
+        {
+          svn_fs_fs__p2l_entry_t *entry
+            = &APR_ARRAY_IDX(entries, idx, svn_fs_fs__p2l_entry_t);
+          if (entry->offset == offset)
+            *entry_p = entry;
+        }
     }
 
   return SVN_NO_ERROR;
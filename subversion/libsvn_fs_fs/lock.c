@@ -332,6 +332,83 @@ read_digest_file(apr_hash_t **children_p,
 
 
 
+/* Variant of read_digest_file() that consults FS's lock digest cache
+   before opening the file at DIGEST_PATH.  Cached entries are validated
+   against the file's current mtime and size, so lock changes made by
+   other processes are picked up reliably; only the stat() needed for
+   that validation remains on cache hits.  Use POOL for allocations. */
+static svn_error_t *
+read_digest_file_cached(apr_hash_t **children_p,
+                        svn_lock_t **lock_p,
+                        svn_fs_t *fs,
+                        const char *digest_path,
+                        apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const svn_io_dirent2_t *dirent;
+  const char *key;
+  svn_fs_fs__lock_digest_t *digest;
+  svn_boolean_t found = FALSE;
+  int i;
+
+  if (! ffd->lock_digest_cache)
+    return svn_error_trace(read_digest_file(children_p, lock_p, fs->path,
+                                            digest_path, pool));
+
+  if (lock_p)
+    *lock_p = NULL;
+  if (children_p)
+    *children_p = apr_hash_make(pool);
+
+  SVN_ERR(svn_io_stat_dirent2(&dirent, digest_path, FALSE, TRUE,
+                              pool, pool));
+  if (dirent->kind == svn_node_none)
+    return SVN_NO_ERROR;
+
+  /* The file name is the digest of the locked path, i.e. unique in FS. */
+  key = svn_dirent_basename(digest_path, NULL);
+  SVN_ERR(svn_cache__get((void **)&digest, &found, ffd->lock_digest_cache,
+                         key, pool));
+
+  if (! found
+      || digest->mtime != dirent->mtime
+      || digest->size != dirent->filesize)
+    {
+      /* Cache miss or the file changed since we read it last.
+         (Re-)read the file and cache its contents. */
+      apr_hash_t *children;
+      svn_lock_t *lock;
+      apr_hash_index_t *hi;
+
+      SVN_ERR(read_digest_file(&children, &lock, fs->path, digest_path,
+                               pool));
+
+      digest = apr_pcalloc(pool, sizeof(*digest));
+      digest->mtime = dirent->mtime;
+      digest->size = dirent->filesize;
+      digest->lock = lock;
+      digest->count = (int)apr_hash_count(children);
+      digest->children = apr_palloc(pool, digest->count
+                                          * sizeof(*digest->children));
+
+      i = 0;
+      for (hi = apr_hash_first(pool, children); hi; hi = apr_hash_next(hi))
+        digest->children[i++] = apr_hash_this_key(hi);
+
+      SVN_ERR(svn_cache__set(ffd->lock_digest_cache, key, digest, pool));
+    }
+
+  if (lock_p)
+    *lock_p = digest->lock;
+  if (children_p)
+    for (i = 0; i < digest->count; ++i)
+      svn_hash_sets(*children_p, digest->children[i], (void *)1);
+
+  return SVN_NO_ERROR;
+}
+
+
+
 /*** Lock helper functions (path here are still FS paths, not on-disk
      schema-supporting paths) ***/
 
@@ -473,14 +550,11 @@ get_lock(svn_lock_t **lock_p,
 {
   svn_lock_t *lock = NULL;
   const char *digest_path;
-  svn_node_kind_t kind;
 
   SVN_ERR(digest_path_from_path(&digest_path, fs->path, path, pool));
-  SVN_ERR(svn_io_check_path(digest_path, &kind, pool));
 
   *lock_p = NULL;
-  if (kind != svn_node_none)
-    SVN_ERR(read_digest_file(NULL, &lock, fs->path, digest_path, pool));
+  SVN_ERR(read_digest_file_cached(NULL, &lock, fs, digest_path, pool));
 
   if (! lock)
     return must_exist ? SVN_FS__ERR_NO_SUCH_LOCK(fs, path) : SVN_NO_ERROR;
@@ -551,7 +625,7 @@ walk_locks(svn_fs_t *fs,
   svn_lock_t *lock;
 
   /* First, send up any locks in the current digest file. */
-  SVN_ERR(read_digest_file(&children, &lock, fs->path, digest_path, pool));
+  SVN_ERR(read_digest_file_cached(&children, &lock, fs, digest_path, pool));
 
   if (lock && lock_expired(lock))
     {
@@ -574,8 +648,8 @@ walk_locks(svn_fs_t *fs,
       const char *digest = apr_hash_this_key(hi);
       svn_pool_clear(subpool);
 
-      SVN_ERR(read_digest_file
-              (NULL, &lock, fs->path,
+      SVN_ERR(read_digest_file_cached
+              (NULL, &lock, fs,
                digest_path_from_digest(fs->path, digest, subpool), subpool));
 
       if (lock && lock_expired(lock))
@@ -914,19 +914,19 @@ read_rep_offsets(representation_t **rep_p,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_fs_fs__read_noderev(node_revision_t **noderev_p,
-                        svn_stream_t *stream,
-                        apr_pool_t *result_pool,
-                        apr_pool_t *scratch_pool)
+/* Populate a new node revision object in *NODEREV_P, allocated in
+   RESULT_POOL, from the header name -> value mapping in HEADERS.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+parse_noderev(node_revision_t **noderev_p,
+              apr_hash_t *headers,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
 {
-  apr_hash_t *headers;
   node_revision_t *noderev;
   char *value;
   const char *noderev_id;
 
-  SVN_ERR(read_header_block(&headers, stream, scratch_pool));
-
   noderev = apr_pcalloc(result_pool, sizeof(*noderev));
 
   /* Read the node-rev id. */
@@ -936,8 +936,6 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
       return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
                               _("Missing id field in node-rev"));
 
-  SVN_ERR(svn_stream_close(stream));
-
   SVN_ERR(svn_fs_fs__id_parse(&noderev->id, value, result_pool));
   noderev_id = value; /* for error messages later */
 
@@ -1059,6 +1057,64 @@ svn_fs_fs__read_noderev(node_revision_t **noderev_p,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__read_noderev(node_revision_t **noderev_p,
+                        svn_stream_t *stream,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  apr_hash_t *headers;
+
+  SVN_ERR(read_header_block(&headers, stream, scratch_pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  return svn_error_trace(parse_noderev(noderev_p, headers, result_pool,
+                                       scratch_pool));
+}
+
+svn_error_t *
+svn_fs_fs__parse_noderev(node_revision_t **noderev_p,
+                         const svn_string_t *text,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  apr_hash_t *headers = svn_hash__make(scratch_pool);
+  const char *pos = text->data;
+  const char *end = text->data + text->len;
+
+  /* Split the header block into lines without going through the
+     byte-wise svn_stream_readline machinery. */
+  while (pos < end)
+    {
+      const char *eol = memchr(pos, '\n', end - pos);
+      apr_size_t line_len = eol ? eol - pos : end - pos;
+      char *line, *colon;
+
+      if (line_len == 0)
+        break; /* end of header block */
+
+      /* Copy the line once; name and value will point into that copy. */
+      line = apr_pstrmemdup(scratch_pool, pos, line_len);
+      colon = memchr(line, ':', line_len);
+
+      /* Same checks as in read_header_block:  there must be a colon and
+         room for the separating space after it. */
+      if (!colon || colon + 2 > line + line_len)
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("Found malformed header '%s' in "
+                                   "revision file"),
+                                 line);
+
+      *colon = '\0';
+      apr_hash_set(headers, line, colon - line, colon + 2);
+
+      pos += line_len + (eol ? 1 : 0);
+    }
+
+  return svn_error_trace(parse_noderev(noderev_p, headers, result_pool,
+                                       scratch_pool));
+}
+
 /* Return a textual representation of the DIGEST of given KIND.
  * Allocate the result in RESULT_POOL.
  */
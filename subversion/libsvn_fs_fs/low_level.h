@@ -147,6 +147,17 @@ svn_fs_fs__read_noderev(node_revision_t **noderev,
                         apr_pool_t *result_pool,
                         apr_pool_t *scratch_pool);
 
+/* Parse a node-revision directly from the in-memory header block TEXT,
+   which must cover the complete item as stored in the rev / pack file.
+   This is equivalent to svn_fs_fs__read_noderev on a stream over TEXT
+   but bypasses the byte-wise stream line reading.  Set *NODEREV to the
+   new structure, allocated in RESULT_POOL. */
+svn_error_t *
+svn_fs_fs__parse_noderev(node_revision_t **noderev,
+                         const svn_string_t *text,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool);
+
 /* Write the node-revision NODEREV into the stream OUTFILE, compatible with
    filesystem format FORMAT.  Only write mergeinfo-related metadata if
    INCLUDE_MERGEINFO is true.  Temporary allocations are from SCRATCH_POOL. */
@@ -22,6 +22,8 @@
 #include <assert.h>
 #include <string.h>
 
+#include <apr_thread_proc.h>
+
 #include "svn_pools.h"
 #include "svn_dirent_uri.h"
 #include "svn_sorts.h"
@@ -30,6 +32,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_thread_batch.h"
 
 #include "fs_fs.h"
 #include "pack.h"
@@ -72,8 +75,9 @@
  *
  * In short, we store items in the following order:
  * - changed paths lists
- * - node property
- * - directory properties
+ * - node properties, those referenced from HEAD noderevs first and in
+ *   noderev placement order
+ * - directory properties, ordered the same way
  * - directory representations corresponding noderevs, lexical path order
  *   with special treatment of "trunk" and "branches"
  * - same for file representations
@@ -119,6 +123,9 @@ typedef struct path_order_t
 
   /* item ID of the representation containing the new data. May be (0, 0). */
   svn_fs_fs__id_part_t rep_id;
+
+  /* item ID of the property representation. May be (0, 0). */
+  svn_fs_fs__id_part_t prop_id;
 } path_order_t;
 
 /* Represents a reference from item FROM to item TO.  FROM may be a noderev
@@ -765,6 +772,14 @@ copy_node_to_temp(pack_context_t *context,
       path_order->expanded_size = noderev->data_rep->expanded_size;
     }
 
+  /* remember the property rep, if this pack file contains it.  We will
+   * use it to apply the same affinity ordering to the props buckets. */
+  if (noderev->prop_rep && noderev->prop_rep->revision >= context->start_rev)
+    {
+      path_order->prop_id.revision = noderev->prop_rep->revision;
+      path_order->prop_id.number = noderev->prop_rep->item_index;
+    }
+
   /* Sort path is the key used for ordering noderevs and associated reps.
    * It will not be stored in the final pack file. */
   sort_path = tweak_path_for_ordering(noderev->created_path, pool);
@@ -1022,17 +1037,20 @@ sort_reps(pack_context_t *context)
       return;
     }
 
+  temp_pool = svn_pool_create(context->info_pool);
+
   /* Sort containers by path and IDs, respectively.
    */
-  svn_sort__array(context->path_order,
-                  (int (*)(const void *, const void *))compare_path_order);
-  svn_sort__array(context->references,
-                  (int (*)(const void *, const void *))compare_references);
+  svn_sort__array_parallel(context->path_order,
+                  (int (*)(const void *, const void *))compare_path_order,
+                  temp_pool);
+  svn_sort__array_parallel(context->references,
+                  (int (*)(const void *, const void *))compare_references,
+                  temp_pool);
 
   /* Directories are already in front; sort directories section and files
    * section separately but use the same heuristics (see sub-function).
    */
-  temp_pool = svn_pool_create(context->info_pool);
   count = context->path_order->nelts;
   temp = apr_pcalloc(temp_pool, count * sizeof(*temp));
   path_order = (void *)context->path_order->elts;
@@ -1065,13 +1083,133 @@ compare_p2l_info(const svn_fs_fs__p2l_entry_t * const * lhs,
 }
 
 /* Sort svn_fs_fs__p2l_entry_t * array ENTRIES by age.  Place the latest
- * items first.
+ * items first.  Use SCRATCH_POOL for temporary allocations.
  */
 static void
-sort_items(apr_array_header_t *entries)
+sort_items(apr_array_header_t *entries,
+           apr_pool_t *scratch_pool)
+{
+  svn_sort__array_parallel(entries,
+                  (int (*)(const void *, const void *))compare_p2l_info,
+                  scratch_pool);
+}
+
+/* implements compare_fn_t.  Sort ascendingly by item revision and number.
+ */
+static int
+compare_p2l_info_id(const svn_fs_fs__p2l_entry_t * const * lhs_p,
+                    const svn_fs_fs__p2l_entry_t * const * rhs_p)
 {
-  svn_sort__array(entries,
-                  (int (*)(const void *, const void *))compare_p2l_info);
+  const svn_fs_fs__p2l_entry_t * lhs = *lhs_p;
+  const svn_fs_fs__p2l_entry_t * rhs = *rhs_p;
+
+  if (lhs->item.revision != rhs->item.revision)
+    return lhs->item.revision < rhs->item.revision ? -1 : 1;
+
+  if (lhs->item.number != rhs->item.number)
+    return lhs->item.number < rhs->item.number ? -1 : 1;
+
+  return 0;
+}
+
+/* implements compare_fn_t.  Assume ascending order by item revision and
+ * number (i.e. COMPARE_P2L_INFO_ID order).
+ */
+static int
+compare_p2l_info_to_id(const svn_fs_fs__p2l_entry_t * const * lhs_p,
+                       const svn_fs_fs__id_part_t * rhs_p)
+{
+  const svn_fs_fs__p2l_entry_t * lhs = *lhs_p;
+
+  if (lhs->item.revision != rhs_p->revision)
+    return lhs->item.revision < rhs_p->revision ? -1 : 1;
+
+  if (lhs->item.number != rhs_p->number)
+    return lhs->item.number < rhs_p->number ? -1 : 1;
+
+  return 0;
+}
+
+/* Reorder the property reps in ENTRIES for access affinity:  Props that
+ * HEAD noderevs refer to come first and in the same order in which the
+ * noderevs themselves will be placed, i.e. roughly path order.  A cold
+ * checkout reads exactly those props and reads them in that order, so
+ * they now form one contiguous region instead of being scattered by
+ * change revision.  Everything else (props of non-HEAD noderevs) keeps
+ * the "newest first" order at the end of the bucket.
+ *
+ * Call this after sort_reps() only; it relies on CONTEXT->PATH_ORDER
+ * being in final placement order with the HEAD nodes classified.
+ */
+static void
+sort_prop_items(pack_context_t *context,
+                apr_array_header_t *entries)
+{
+  apr_pool_t *temp_pool;
+  apr_array_header_t *lookup;
+  svn_fs_fs__p2l_entry_t **first;
+  svn_fs_fs__p2l_entry_t **sorted;
+  svn_boolean_t *picked;
+  int i, dest;
+
+  /* The logic below would be pointless for empty buckets. */
+  if (entries->nelts == 0 || context->path_order->nelts == 0)
+    return;
+
+  temp_pool = svn_pool_create(context->info_pool);
+
+  /* ID-ordered copy of ENTRIES, so we can find the prop rep entries
+   * referenced by the noderevs with a binary search. */
+  lookup = apr_array_copy(temp_pool, entries);
+  svn_sort__array_parallel(lookup,
+                  (int (*)(const void *, const void *))compare_p2l_info_id,
+                  temp_pool);
+  first = (svn_fs_fs__p2l_entry_t **)lookup->elts;
+
+  picked = apr_pcalloc(temp_pool, lookup->nelts * sizeof(*picked));
+  sorted = apr_palloc(temp_pool, entries->nelts * sizeof(*sorted));
+  dest = 0;
+
+  /* Pick the props referenced by HEAD noderevs in placement order.
+   * Props from the respective other bucket simply won't be found here. */
+  for (i = 0; i < context->path_order->nelts; ++i)
+    {
+      const path_order_t *path_order
+        = APR_ARRAY_IDX(context->path_order, i, path_order_t *);
+      svn_fs_fs__p2l_entry_t **found;
+
+      if (!path_order->is_head || path_order->prop_id.number == 0)
+        continue;
+
+      found = svn_sort__array_lookup(lookup, &path_order->prop_id, NULL,
+                (int (*)(const void *, const void *))compare_p2l_info_to_id);
+
+      /* Multiple noderevs may share the same prop rep; pick it once. */
+      if (found && !picked[found - first])
+        {
+          picked[found - first] = TRUE;
+          sorted[dest++] = *found;
+        }
+    }
+
+  /* Append the remaining items in their previous order. */
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      svn_fs_fs__p2l_entry_t *entry
+        = APR_ARRAY_IDX(entries, i, svn_fs_fs__p2l_entry_t *);
+      svn_fs_fs__p2l_entry_t **found
+        = svn_sort__array_lookup(lookup, &entry->item, NULL,
+                (int (*)(const void *, const void *))compare_p2l_info_to_id);
+
+      if (!picked[found - first])
+        sorted[dest++] = entry;
+    }
+
+  /* We now know the final ordering. */
+  assert(dest == entries->nelts);
+  memcpy(entries->elts, sorted, entries->nelts * sizeof(*sorted));
+
+  svn_pool_destroy(temp_pool);
 }
 
 /* Return the remaining unused bytes in the current block in CONTEXT's
@@ -1429,13 +1567,18 @@ pack_range(pack_context_t *context,
 
   /* phase 3: placement.
    * Use "newest first" placement for simple items. */
-  sort_items(context->changes);
-  sort_items(context->file_props);
-  sort_items(context->dir_props);
+  sort_items(context->changes, revpool);
+  sort_items(context->file_props, revpool);
+  sort_items(context->dir_props, revpool);
 
   /* follow dependencies recursively for noderevs and data representations */
   sort_reps(context);
 
+  /* with the noderev placement known, bring the props that HEAD refers
+   * to into the same affinity order */
+  sort_prop_items(context, context->file_props);
+  sort_prop_items(context, context->dir_props);
+
   /* phase 4: copy bucket data to pack file.  Write P2L index. */
   SVN_ERR(store_items(context, context->changes_file, context->changes,
                       revpool));
@@ -1871,6 +2014,9 @@ struct pack_baton
   const char *revsprops_dir;
   apr_int64_t shard;
 
+  /* Additional entries valid when entering pack_shard_data(). */
+  const char *rev_pack_file_dir;
+
   /* Additional entries valid when entering synced_pack_shard(). */
   const char *rev_shard_path;
 };
@@ -1904,13 +2050,17 @@ synced_pack_shard(void *baton,
                     apr_psprintf(pool, "%" APR_INT64_T_FMT, pb->shard),
                     pool);
 
+      /* Pack files are written once and read many times, so spend the
+       * extra CPU on the best zlib level for a permanently smaller shard.
+       * The frequently rewritten, latency-sensitive files use the default
+       * level instead (see repack_revprops). */
       SVN_ERR(svn_fs_fs__pack_revprops_shard(revprops_pack_file_dir,
                                              revprops_shard_path,
                                              pb->shard,
                                              ffd->max_files_per_dir,
                                              pack_size_limit,
                                              ffd->compress_packed_revprops
-                                               ? SVN__COMPRESSION_ZLIB_DEFAULT
+                                               ? SVN__COMPRESSION_ZLIB_MAX
                                                : SVN__COMPRESSION_NONE,
                                              ffd->flush_to_disk,
                                              pb->cancel_func,
@@ -1957,25 +2107,13 @@ synced_pack_shard(void *baton,
   return SVN_NO_ERROR;
 }
 
-/* Pack the shard described by BATON.
- *
- * If for some reason we detect a partial packing already performed,
- * we remove the pack file and start again.
- */
-static svn_error_t *
-pack_shard(struct pack_baton *baton,
-           apr_pool_t *pool)
+/* Derive the shard-specific paths in BATON from BATON->SHARD, allocated
+ * in POOL. */
+static void
+init_pack_shard_paths(struct pack_baton *baton,
+                      apr_pool_t *pool)
 {
-  fs_fs_data_t *ffd = baton->fs->fsap_data;
-  const char *rev_pack_file_dir;
-
-  /* Notify caller we're starting to pack this shard. */
-  if (baton->notify_func)
-    SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
-                               svn_fs_pack_notify_start, pool));
-
-  /* Some useful paths. */
-  rev_pack_file_dir = svn_dirent_join(baton->revs_dir,
+  baton->rev_pack_file_dir = svn_dirent_join(baton->revs_dir,
                   apr_psprintf(pool,
                                "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
                                baton->shard),
@@ -1985,13 +2123,40 @@ pack_shard(struct pack_baton *baton,
                                                        "%" APR_INT64_T_FMT,
                                                        baton->shard),
                                           pool);
+}
+
+/* Pack the revision data of the shard described by BATON into the
+ * temporary BATON->REV_PACK_FILE_DIR.  This phase does not change any
+ * globally visible filesystem state, so it may run without the write
+ * lock and concurrently for independent shards.
+ */
+static svn_error_t *
+pack_shard_data(struct pack_baton *baton,
+                apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = baton->fs->fsap_data;
 
   /* pack the revision content */
-  SVN_ERR(pack_rev_shard(baton->fs, rev_pack_file_dir, baton->rev_shard_path,
+  SVN_ERR(pack_rev_shard(baton->fs, baton->rev_pack_file_dir,
+                         baton->rev_shard_path,
                          baton->shard, ffd->max_files_per_dir,
                          baton->max_mem, ffd->flush_to_disk,
                          baton->cancel_func, baton->cancel_baton, pool));
 
+  return SVN_NO_ERROR;
+}
+
+/* Switch over to the packed data of the shard described by BATON and
+ * notify the caller.  Requires the data packing phase for that shard to
+ * have completed.  Must be called in strictly ascending shard order
+ * because it bumps the min-unpacked-rev watermark.
+ */
+static svn_error_t *
+pack_shard_finalize(struct pack_baton *baton,
+                    apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = baton->fs->fsap_data;
+
   /* For newer repo formats, we only acquired the pack lock so far.
      Before modifying the repo state by switching over to the packed
      data, we need to acquire the global (write) lock. */
@@ -2001,7 +2166,7 @@ pack_shard(struct pack_baton *baton,
   else
     SVN_ERR(synced_pack_shard(baton, pool));
 
-  /* Notify caller we're starting to pack this shard. */
+  /* Notify caller we're done packing this shard. */
   if (baton->notify_func)
     SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
                                svn_fs_pack_notify_end, pool));
@@ -2009,6 +2174,134 @@ pack_shard(struct pack_baton *baton,
   return SVN_NO_ERROR;
 }
 
+/* Pack the shard described by BATON.
+ *
+ * If for some reason we detect a partial packing already performed,
+ * we remove the pack file and start again.
+ */
+static svn_error_t *
+pack_shard(struct pack_baton *baton,
+           apr_pool_t *pool)
+{
+  /* Notify caller we're starting to pack this shard. */
+  if (baton->notify_func)
+    SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
+                               svn_fs_pack_notify_start, pool));
+
+  /* Some useful paths. */
+  init_pack_shard_paths(baton, pool);
+
+  SVN_ERR(pack_shard_data(baton, pool));
+  SVN_ERR(pack_shard_finalize(baton, pool));
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+/* Baton for the task dispatcher callbacks: the main pack baton plus the
+ * end of the shard range to pack. */
+struct pack_batch_baton
+{
+  /* The main pack baton.  Its SHARD field is the next shard to
+     dispatch a task for. */
+  struct pack_baton *pb;
+
+  /* First shard not to pack. */
+  apr_int64_t last_shard;
+};
+
+/* Implements svn_thread_batch__init_func_t with CONTEXT being a struct
+ * pack_batch_baton.  Set *BATON to a private copy of the main pack
+ * baton with the shard fields set up for the next shard to pack, and
+ * send the start notification for that shard. */
+static svn_error_t *
+init_pack_task(void **baton,
+               void *context,
+               apr_pool_t *task_pool,
+               apr_pool_t *scratch_pool)
+{
+  struct pack_batch_baton *bb = context;
+  struct pack_baton *pb = bb->pb;
+  struct pack_baton *task;
+
+  if (pb->shard >= bb->last_shard)
+    return SVN_NO_ERROR;
+
+  task = apr_palloc(task_pool, sizeof(*task));
+  *task = *pb;
+  task->cancel_func = NULL;
+  task->cancel_baton = NULL;
+  init_pack_shard_paths(task, task_pool);
+  ++pb->shard;
+
+  /* Notify caller we're starting to pack this shard. */
+  if (pb->notify_func)
+    SVN_ERR(pb->notify_func(pb->notify_baton, task->shard,
+                            svn_fs_pack_notify_start, scratch_pool));
+
+  *baton = task;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_batch__work_func_t.  Pack the revision data of
+ * the shard described by BATON, a struct pack_baton. */
+static svn_error_t *
+pack_shard_data_task(void *baton,
+                     apr_pool_t *task_pool)
+{
+  return svn_error_trace(pack_shard_data(baton, task_pool));
+}
+
+/* Implements svn_thread_batch__process_func_t.  Apply the global state
+ * changes of TASKS strictly in shard order as required by the
+ * min-unpacked-rev watermark semantics. */
+static svn_error_t *
+process_packed_tasks(apr_array_header_t *tasks,
+                     void *context,
+                     apr_pool_t *scratch_pool)
+{
+  svn_error_t *err = svn_thread_batch__collect(tasks);
+  int i;
+
+  for (i = 0; i < tasks->nelts && !err; ++i)
+    {
+      svn_thread_batch__task_t *task
+        = APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *);
+
+      err = svn_error_trace(pack_shard_finalize(task->baton, scratch_pool));
+    }
+
+  return err;
+}
+
+/* Pack all shards from PB->SHARD up to, but not including, LAST_SHARD,
+ * running the data packing phase of up to PB->FS's pack-threads shards
+ * concurrently.  The global switch-over to the packed data remains
+ * strictly serialized in ascending shard order.  Use POOL for temporary
+ * allocations.
+ */
+static svn_error_t *
+pack_shards_concurrently(struct pack_baton *pb,
+                         apr_int64_t last_shard,
+                         apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = pb->fs->fsap_data;
+  struct pack_batch_baton baton;
+
+  baton.pb = pb;
+  baton.last_shard = last_shard;
+
+  return svn_error_trace(svn_thread_batch__run((apr_size_t)ffd->pack_threads,
+                                               init_pack_task,
+                                               pack_shard_data_task,
+                                               process_packed_tasks,
+                                               &baton,
+                                               pb->cancel_func,
+                                               pb->cancel_baton,
+                                               pool));
+}
+#endif
+
 /* Read the youngest rev and the first non-packed rev info for FS from disk.
    Set *FULLY_PACKED when there is no completed unpacked shard.
    Use SCRATCH_POOL for temporary allocations.
@@ -2080,8 +2373,17 @@ pack_body(void *baton,
     pb->revsprops_dir = svn_dirent_join(pb->fs->path, PATH_REVPROPS_DIR,
                                         pool);
 
+  pb->shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
+
+#if APR_HAS_THREADS
+  /* If so configured, pack independent shards concurrently. */
+  if (ffd->pack_threads > 1 && completed_shards - pb->shard > 1)
+    return svn_error_trace(pack_shards_concurrently(pb, completed_shards,
+                                                    pool));
+#endif
+
   iterpool = svn_pool_create(pool);
-  for (pb->shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
+  for (;
        pb->shard < completed_shards;
        pb->shard++)
     {
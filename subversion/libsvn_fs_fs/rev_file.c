@@ -31,6 +31,37 @@
 #include "private/svn_io_private.h"
 #include "svn_private_config.h"
 
+#include <apr_portable.h>
+#if APR_HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+
+/* Advise the OS that APR_FILE will be read sequentially, in a single
+ * pass.  Best-effort; a no-op where posix_fadvise() is unavailable. */
+static void
+hint_sequential_read(apr_file_t *apr_file)
+{
+#ifdef POSIX_FADV_SEQUENTIAL
+  apr_os_file_t fd;
+
+  if (apr_os_file_get(&fd, apr_file) == APR_SUCCESS)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+/* Advise the OS that the contents of APR_FILE are no longer needed and
+ * that its cached pages may be dropped.  Best-effort. */
+static void
+hint_dontneed(apr_file_t *apr_file)
+{
+#ifdef POSIX_FADV_DONTNEED
+  apr_os_file_t fd;
+
+  if (apr_os_file_get(&fd, apr_file) == APR_SUCCESS)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
 /* Initialize the *FILE structure for REVISION in filesystem FS.  Set its
  * pool member to the provided POOL. */
 static void
@@ -46,6 +77,9 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
 
   file->file = NULL;
   file->stream = NULL;
+#if APR_HAS_MMAP
+  file->mmap = NULL;
+#endif
   file->p2l_stream = NULL;
   file->l2p_stream = NULL;
   file->block_size = ffd->block_size;
@@ -54,6 +88,7 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
   file->p2l_offset = -1;
   file->p2l_checksum = NULL;
   file->footer_offset = -1;
+  file->bulk_reads = ffd->bulk_reads;
   file->pool = pool;
 }
 
@@ -160,6 +195,35 @@ open_pack_or_rev_file(svn_fs_fs__revision_file_t *file,
                                                   result_pool);
           file->is_packed = svn_fs_fs__is_packed_rev(fs, rev);
 
+          /* Bulk operations read this file front to back, once. */
+          if (file->bulk_reads && !writable)
+            hint_sequential_read(apr_file);
+
+#if APR_HAS_MMAP
+          /* If so configured, try to map the file into memory.  Should
+           * that fail for whatever reason (empty file, address space
+           * exhausted, file system does not support it), silently keep
+           * using the buffered file - the mapping is an optimization
+           * only and FILE->FILE remains fully functional. */
+          if (ffd->use_mmap && !writable)
+            {
+              apr_finfo_t finfo;
+
+              err = svn_io_file_info_get(&finfo, APR_FINFO_SIZE, apr_file,
+                                         scratch_pool);
+              if (!err && finfo.size > 0)
+                {
+                  apr_mmap_t *mm;
+                  if (!apr_mmap_create(&mm, apr_file, 0,
+                                       (apr_size_t)finfo.size,
+                                       APR_MMAP_READ, result_pool))
+                    file->mmap = mm;
+                }
+
+              svn_error_clear(err);
+            }
+#endif
+
           return SVN_NO_ERROR;
         }
 
@@ -227,6 +291,25 @@ svn_fs_fs__open_pack_or_rev_file_writable(svn_fs_fs__revision_file_t** file,
                                                result_pool, scratch_pool));
 }
 
+svn_error_t *
+svn_fs_fs__rev_file_mapped_range(const char **data,
+                                 svn_fs_fs__revision_file_t *file,
+                                 apr_off_t offset,
+                                 apr_size_t size)
+{
+  *data = NULL;
+
+#if APR_HAS_MMAP
+  if (   file->mmap
+      && offset >= 0
+      && size <= file->mmap->size
+      && (apr_size_t)offset <= file->mmap->size - size)
+    *data = (const char *)file->mmap->mm + offset;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__auto_read_footer(svn_fs_fs__revision_file_t *file)
 {
@@ -235,24 +318,45 @@ svn_fs_fs__auto_read_footer(svn_fs_fs__revision_file_t *file)
       apr_off_t filesize = 0;
       unsigned char footer_length;
       svn_stringbuf_t *footer;
+      const char *mapped;
 
       /* Determine file size. */
       SVN_ERR(svn_io_file_seek(file->file, APR_END, &filesize, file->pool));
 
       /* Read last byte (containing the length of the footer). */
-      SVN_ERR(svn_io_file_aligned_seek(file->file, file->block_size, NULL,
-                                       filesize - 1, file->pool));
-      SVN_ERR(svn_io_file_read_full2(file->file, &footer_length,
-                                     sizeof(footer_length), NULL, NULL,
-                                     file->pool));
+      SVN_ERR(svn_fs_fs__rev_file_mapped_range(&mapped, file,
+                                               filesize - 1, 1));
+      if (mapped)
+        {
+          footer_length = *(const unsigned char *)mapped;
+        }
+      else
+        {
+          SVN_ERR(svn_io_file_aligned_seek(file->file, file->block_size, NULL,
+                                           filesize - 1, file->pool));
+          SVN_ERR(svn_io_file_read_full2(file->file, &footer_length,
+                                         sizeof(footer_length), NULL, NULL,
+                                         file->pool));
+        }
 
       /* Read footer. */
       footer = svn_stringbuf_create_ensure(footer_length, file->pool);
-      SVN_ERR(svn_io_file_aligned_seek(file->file, file->block_size, NULL,
-                                       filesize - 1 - footer_length,
-                                       file->pool));
-      SVN_ERR(svn_io_file_read_full2(file->file, footer->data, footer_length,
-                                     &footer->len, NULL, file->pool));
+      SVN_ERR(svn_fs_fs__rev_file_mapped_range(&mapped, file,
+                                               filesize - 1 - footer_length,
+                                               footer_length));
+      if (mapped)
+        {
+          svn_stringbuf_appendbytes(footer, mapped, footer_length);
+        }
+      else
+        {
+          SVN_ERR(svn_io_file_aligned_seek(file->file, file->block_size, NULL,
+                                           filesize - 1 - footer_length,
+                                           file->pool));
+          SVN_ERR(svn_io_file_read_full2(file->file, footer->data,
+                                         footer_length, &footer->len, NULL,
+                                         file->pool));
+        }
       footer->data[footer->len] = '\0';
 
       /* Extract index locations. */
@@ -295,8 +399,25 @@ svn_fs_fs__close_revision_file(svn_fs_fs__revision_file_t *file)
 {
   if (file->stream)
     SVN_ERR(svn_stream_close(file->stream));
+#if APR_HAS_MMAP
+  if (file->mmap)
+    {
+      apr_status_t status = apr_mmap_delete(file->mmap);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't unmap revision file"));
+
+      file->mmap = NULL;
+    }
+#endif
   if (file->file)
-    SVN_ERR(svn_io_file_close(file->file, file->pool));
+    {
+      /* In bulk read mode, we are done with this file's data; don't
+       * let it linger in the page cache at the expense of hot data. */
+      if (file->bulk_reads)
+        hint_dontneed(file->file);
+
+      SVN_ERR(svn_io_file_close(file->file, file->pool));
+    }
 
   file->file = NULL;
   file->stream = NULL;
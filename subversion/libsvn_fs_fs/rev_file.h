@@ -23,6 +23,8 @@
 #ifndef SVN_LIBSVN_FS__REV_FILE_H
 #define SVN_LIBSVN_FS__REV_FILE_H
 
+#include <apr_mmap.h>
+
 #include "svn_fs.h"
 #include "id.h"
 
@@ -57,6 +59,13 @@ typedef struct svn_fs_fs__revision_file_t
   /* stream based on FILE and not NULL exactly when FILE is not NULL */
   svn_stream_t *stream;
 
+#if APR_HAS_MMAP
+  /* Read-only memory mapping of the whole rev / pack file, if the
+   * "use-mmap" option has been enabled and mapping the file succeeded.
+   * NULL otherwise.  Never set for writable or txn proto-rev files. */
+  apr_mmap_t *mmap;
+#endif
+
   /* the opened P2L index stream or NULL.  Always NULL for txns. */
   svn_fs_fs__packed_number_stream_t *p2l_stream;
 
@@ -90,10 +99,26 @@ typedef struct svn_fs_fs__revision_file_t
    * been called, yet. */
   apr_off_t footer_offset;
 
+  /* Copied from FS->FFD->BULK_READS upon creation.  If set, tell the OS
+   * that we read this file sequentially, at most once, and that it may
+   * drop the cached pages again when we close the file. */
+  svn_boolean_t bulk_reads;
+
   /* pool containing this object */
   apr_pool_t *pool;
 } svn_fs_fs__revision_file_t;
 
+/* If FILE is memory-mapped and the range [OFFSET, OFFSET+SIZE) lies fully
+ * within the mapping, set *DATA to the in-memory location of that range.
+ * Set it to NULL otherwise, i.e. the caller must fall back to reading
+ * through FILE->FILE.  The returned pointer shares the lifetime of FILE.
+ */
+svn_error_t *
+svn_fs_fs__rev_file_mapped_range(const char **data,
+                                 svn_fs_fs__revision_file_t *file,
+                                 apr_off_t offset,
+                                 apr_size_t size);
+
 /* Open the correct revision file for REV.  If the filesystem FS has
  * been packed, *FILE will be set to the packed file; otherwise, set *FILE
  * to the revision file for REV.  Return SVN_ERR_FS_NO_SUCH_REVISION if the
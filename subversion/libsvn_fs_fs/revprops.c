@@ -56,9 +56,11 @@ svn_fs_fs__upgrade_pack_revprops(svn_fs_t *fs,
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   const char *revsprops_dir = svn_dirent_join(fs->path, PATH_REVPROPS_DIR,
                                               scratch_pool);
+  /* Same rationale as in synced_pack_shard: pack files are write-once,
+   * read-many, so use the best zlib level. */
   int compression_level = ffd->compress_packed_revprops
-                           ? SVN_DELTA_COMPRESSION_LEVEL_DEFAULT
-                           : SVN_DELTA_COMPRESSION_LEVEL_NONE;
+                           ? SVN__COMPRESSION_ZLIB_MAX
+                           : SVN__COMPRESSION_NONE;
 
   /* first, pack all revprops shards to match the packed revision shards */
   for (shard = 0; shard < first_unpacked_shard; ++shard)
@@ -320,12 +322,15 @@ get_min_filename_len(packed_revprops_t *revprops)
 }
 
 /* Given FS and REVPROPS->REVISION, fill the FILENAME, FOLDER and MANIFEST
- * members. Use RESULT_POOL for allocating results and SCRATCH_POOL for
+ * members.  If REFRESH is set, don't use a cached manifest but re-read it
+ * from disk and update the cache - use this after possibly concurrent
+ * writes.  Use RESULT_POOL for allocating results and SCRATCH_POOL for
  * temporaries.
  */
 static svn_error_t *
 get_revprop_packname(svn_fs_t *fs,
                      packed_revprops_t *revprops,
+                     svn_boolean_t refresh,
                      apr_pool_t *result_pool,
                      apr_pool_t *scratch_pool)
 {
@@ -336,6 +341,8 @@ get_revprop_packname(svn_fs_t *fs,
   char *buffer, *buffer_end;
   const char **filenames, **filenames_end;
   apr_size_t min_filename_len;
+  pair_cache_key_t key;
+  svn_boolean_t is_cached = FALSE;
 
   /* Determine the dimensions. Rev 0 is excluded from the first shard. */
   rev_count = ffd->max_files_per_dir;
@@ -360,7 +367,27 @@ get_revprop_packname(svn_fs_t *fs,
   manifest_file_path
     = svn_dirent_join(revprops->folder, PATH_MANIFEST, result_pool);
 
-  SVN_ERR(svn_fs_fs__read_content(&content, manifest_file_path, result_pool));
+  /* Try to find the manifest in the cache.  It is keyed by the shard
+   * start revision plus the current revprop generation, so stale entries
+   * get evicted whenever the revprops change. */
+  SVN_ERR(prepare_revprop_cache(fs, scratch_pool));
+  key.revision = revprops->manifest_start;
+  key.second = ffd->revprop_prefix;
+
+  if (!refresh)
+    SVN_ERR(svn_cache__get((void **)&content, &is_cached,
+                           ffd->revprop_manifest_cache, &key, result_pool));
+
+  if (!is_cached)
+    {
+      SVN_ERR(svn_fs_fs__read_content(&content, manifest_file_path,
+                                      result_pool));
+
+      /* Cache the raw file contents before the destructive parse below.
+       * Reads get their own private copy from the cache. */
+      SVN_ERR(svn_cache__set(ffd->revprop_manifest_cache, &key, content,
+                             scratch_pool));
+    }
 
   /* There CONTENT must have a certain minimal size and there no
    * unterminated lines at the end of the file.  Both guarantees also
@@ -643,7 +670,7 @@ read_pack_revprop(packed_revprops_t **revprops,
       /* there might have been concurrent writes.
        * Re-read the manifest and the pack file.
        */
-      SVN_ERR(get_revprop_packname(fs, result, pool, iterpool));
+      SVN_ERR(get_revprop_packname(fs, result, i > 0, pool, iterpool));
       file_path  = svn_dirent_join(result->folder,
                                    result->filename,
                                    iterpool);
@@ -20,6 +20,8 @@
  * ====================================================================
  */
 
+#include <apr_thread_proc.h>
+
 #include "svn_dirent_uri.h"
 #include "svn_fs.h"
 #include "svn_pools.h"
@@ -28,6 +30,7 @@
 #include "private/svn_cache.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
+#include "private/svn_thread_batch.h"
 
 #include "index.h"
 #include "pack.h"
@@ -182,9 +185,25 @@ typedef struct query_t
   /* First non-packed revision. */
   svn_revnum_t min_unpacked_rev;
 
-  /* all revisions */
+  /* First revision covered by REVISIONS.  This is 0 for the main query
+   * and the start of the assigned revision range for the sub-queries
+   * used by concurrent scans. */
+  svn_revnum_t first_revision;
+
+  /* all revisions, i.e. REVISIONS[i] describes FIRST_REVISION + i */
   apr_array_header_t *revisions;
 
+  /* In sub-queries: references to representations before FIRST_REVISION,
+   * as rep_ref_t * with only REVISION and ITEM_INDEX being used.  They
+   * can only be counted once the full revision array has been merged.
+   * NULL for the main query. */
+  apr_array_header_t *pending_uses;
+
+  /* In sub-queries: delta chain links whose base lies before
+   * FIRST_REVISION, as rep_ref_t *.  Resolved during the final merge.
+   * NULL for the main query. */
+  apr_array_header_t *pending_refs;
+
   /* empty representation.
    * Used as a dummy base for DELTA reps without base. */
   rep_stats_t *null_base;
@@ -255,6 +274,40 @@ add_to_histogram(svn_fs_fs__histogram_t *histogram,
   histogram->lines[(apr_size_t)shift].sum += size;
 }
 
+/* If the representation of REP_SIZE bytes for PATH in REVISION is large
+ * enough, insert it into the largest changes ranking in STATS.
+ */
+static void
+store_largest_change(svn_fs_fs__stats_t *stats,
+                     apr_uint64_t rep_size,
+                     svn_revnum_t revision,
+                     const char *path)
+{
+  apr_size_t i;
+  svn_fs_fs__largest_changes_t *largest_changes = stats->largest_changes;
+  svn_fs_fs__large_change_info_t *info;
+
+  if (rep_size < largest_changes->min_size)
+    return;
+
+  info = largest_changes->changes[largest_changes->count - 1];
+  info->size = rep_size;
+  info->revision = revision;
+  svn_stringbuf_set(info->path, path);
+
+  /* linear insertion but not too bad since count is low and insertions
+   * near the end are more likely than close to front */
+  for (i = largest_changes->count - 1; i > 0; --i)
+    if (largest_changes->changes[i-1]->size >= rep_size)
+      break;
+    else
+      largest_changes->changes[i] = largest_changes->changes[i-1];
+
+  largest_changes->changes[i] = info;
+  largest_changes->min_size
+    = largest_changes->changes[largest_changes->count-1]->size;
+}
+
 /* Update data aggregators in STATS with this representation of type KIND,
  * on-disk REP_SIZE and expanded node size EXPANDED_SIZE for PATH in REVSION.
  * PLAIN_ADDED indicates whether the node has a deltification predecessor.
@@ -269,28 +322,7 @@ add_change(svn_fs_fs__stats_t *stats,
            svn_boolean_t plain_added)
 {
   /* identify largest reps */
-  if (rep_size >= stats->largest_changes->min_size)
-    {
-      apr_size_t i;
-      svn_fs_fs__largest_changes_t *largest_changes = stats->largest_changes;
-      svn_fs_fs__large_change_info_t *info
-        = largest_changes->changes[largest_changes->count - 1];
-      info->size = rep_size;
-      info->revision = revision;
-      svn_stringbuf_set(info->path, path);
-
-      /* linear insertion but not too bad since count is low and insertions
-       * near the end are more likely than close to front */
-      for (i = largest_changes->count - 1; i > 0; --i)
-        if (largest_changes->changes[i-1]->size >= rep_size)
-          break;
-        else
-          largest_changes->changes[i] = largest_changes->changes[i-1];
-
-      largest_changes->changes[i] = info;
-      largest_changes->min_size
-        = largest_changes->changes[largest_changes->count-1]->size;
-    }
+  store_largest_change(stats, rep_size, revision, path);
 
   /* global histograms */
   add_to_histogram(&stats->rep_size_histogram, rep_size);
@@ -393,7 +425,14 @@ find_representation(int *idx,
   info = revision_info ? *revision_info : NULL;
   if (info == NULL || info->revision != revision)
     {
-      info = APR_ARRAY_IDX(query->revisions, revision, revision_info_t*);
+      /* Queries restricted to a sub-range cannot resolve references to
+       * revisions before that range. */
+      if (revision < query->first_revision)
+        return NULL;
+
+      info = APR_ARRAY_IDX(query->revisions,
+                           revision - query->first_revision,
+                           revision_info_t*);
       if (revision_info)
         *revision_info = info;
     }
@@ -441,6 +480,21 @@ parse_representation(rep_stats_t **representation,
   /* look it up */
   result = find_representation(&idx, query, &revision_info, rep->revision,
                                rep->item_index);
+  if (!result && rep->revision < query->first_revision)
+    {
+      /* Reference into a revision range scanned by some other thread.
+       * The rep itself will be picked up by the noderevs of its own
+       * revision; just record the extra reference for the final merge. */
+      rep_ref_t *use = apr_pcalloc(query->pending_uses->pool, sizeof(*use));
+      use->revision = rep->revision;
+      use->item_index = rep->item_index;
+      APR_ARRAY_PUSH(query->pending_uses, rep_ref_t *) = use;
+
+      *representation = NULL;
+
+      return SVN_NO_ERROR;
+    }
+
   if (!result)
     {
       /* not parsed, yet (probably a rep in the same revision).
@@ -471,7 +525,21 @@ parse_representation(rep_stats_t **representation,
           result->header_size = header->header_size;
 
           /* Determine length of the delta chain. */
-          if (header->type == svn_fs_fs__rep_delta)
+          if (header->type == svn_fs_fs__rep_delta
+              && header->base_revision < query->first_revision)
+            {
+              /* The base lives in a revision range scanned by some other
+               * thread; resolve the chain length during the final merge. */
+              rep_ref_t *ref = apr_pcalloc(query->pending_refs->pool,
+                                           sizeof(*ref));
+              ref->revision = rep->revision;
+              ref->item_index = rep->item_index;
+              ref->base_revision = header->base_revision;
+              ref->base_item_index = header->base_item_index;
+              ref->header_size = header->header_size;
+              APR_ARRAY_PUSH(query->pending_refs, rep_ref_t *) = ref;
+            }
+          else if (header->type == svn_fs_fs__rep_delta)
             {
               int base_idx;
               rep_stats_t *base_rep
@@ -629,7 +697,7 @@ read_noderev(query_t *query,
                                    result_pool, scratch_pool));
 
       /* if we are the first to use this rep, mark it as "text rep" */
-      if (++text->ref_count == 1)
+      if (text && ++text->ref_count == 1)
         text->kind = noderev->kind == svn_node_dir ? dir_rep : file_rep;
     }
 
@@ -640,7 +708,7 @@ read_noderev(query_t *query,
                                    result_pool, scratch_pool));
 
       /* if we are the first to use this rep, mark it as "prop rep" */
-      if (++props->ref_count == 1)
+      if (props && ++props->ref_count == 1)
         props->kind = noderev->kind == svn_node_dir ? dir_property_rep
                                                     : file_property_rep;
     }
@@ -972,6 +1040,15 @@ resolve_representation_refs(query_t *query,
         {
           rep->chain_length = 1;
         }
+      else if (ref->base_revision < query->first_revision)
+        {
+          /* Deltified against a revision range scanned by some other
+           * thread.  Leave the resolution to the final merge, which
+           * covers the full revision array. */
+          rep_ref_t *pending = apr_pmemdup(query->pending_refs->pool,
+                                           ref, sizeof(*ref));
+          APR_ARRAY_PUSH(query->pending_refs, rep_ref_t *) = pending;
+        }
       else
         {
           rep_stats_t *base;
@@ -1034,7 +1111,8 @@ read_log_rev_or_packfile(query_t *query,
 
   /* record the whole pack size in the first rev so the total sum will
      still be correct */
-  APR_ARRAY_IDX(query->revisions, base, revision_info_t*)->end = max_offset;
+  APR_ARRAY_IDX(query->revisions, base - query->first_revision,
+                revision_info_t*)->end = max_offset;
 
   /* for all offsets in the file, get the P2L index entries and process
      the interesting items (change lists, noderevs) */
@@ -1070,7 +1148,8 @@ read_log_rev_or_packfile(query_t *query,
             continue;
 
           /* read and process interesting items */
-          info = APR_ARRAY_IDX(query->revisions, entry->item.revision,
+          info = APR_ARRAY_IDX(query->revisions,
+                               entry->item.revision - query->first_revision,
                                revision_info_t*);
 
           if (entry->type == SVN_FS_FS__ITEM_TYPE_NODEREV)
@@ -1196,8 +1275,8 @@ read_revisions(query_t *query,
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   svn_revnum_t revision;
 
-  /* read all packed revs */
-  for ( revision = 0
+  /* read all packed revs (unless a concurrent scan covered them already) */
+  for ( revision = query->revisions->nelts
       ; revision < query->min_unpacked_rev
       ; revision += query->shard_size)
     {
@@ -1376,9 +1455,373 @@ create_query(query_t **query,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+/* Open a private FS instance accessing the same on-disk data as FS and
+ * return it in *RESULT, allocated in POOL.  FS objects must not be shared
+ * between threads, so each stats worker gets an instance of its own,
+ * including a private equivalent of the process-wide shared data.
+ */
+static svn_error_t *
+open_worker_fs(svn_fs_t **result,
+               svn_fs_t *fs,
+               apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = apr_pcalloc(pool, sizeof(*ffd));
+  fs_fs_shared_data_t *ffsd;
+  svn_fs_t *worker_fs = apr_pcalloc(pool, sizeof(*worker_fs));
+
+  worker_fs->pool = pool;
+  worker_fs->path = apr_pstrdup(pool, fs->path);
+  worker_fs->config = fs->config;
+  worker_fs->warning = fs->warning;
+  worker_fs->warning_baton = fs->warning_baton;
+
+  ffd->flush_to_disk = TRUE;
+  worker_fs->fsap_data = ffd;
+
+  SVN_ERR(svn_fs_fs__open(worker_fs, worker_fs->path, pool));
+  SVN_ERR(svn_fs_fs__initialize_caches(worker_fs, pool));
+
+  /* The instance is only ever used by a single thread, so it does not
+   * need to share locks and in-flight data with other FS objects. */
+  ffsd = apr_pcalloc(pool, sizeof(*ffsd));
+  ffsd->common_pool = pool;
+  SVN_ERR(svn_mutex__init(&ffsd->fs_write_lock,
+                          SVN_FS_FS__USE_LOCK_MUTEX, pool));
+  SVN_ERR(svn_mutex__init(&ffsd->fs_pack_lock,
+                          SVN_FS_FS__USE_LOCK_MUTEX, pool));
+  SVN_ERR(svn_mutex__init(&ffsd->txn_current_lock,
+                          SVN_FS_FS__USE_LOCK_MUTEX, pool));
+  SVN_ERR(svn_mutex__init(&ffsd->txn_list_lock, TRUE, pool));
+  SVN_ERR(svn_fs_fs__inflight_reps_create(&ffsd->inflight_reps, pool));
+  ffd->shared = ffsd;
+
+  *result = worker_fs;
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for pack_stats_task(), holding everything a worker thread needs
+ * to scan one pack file. */
+typedef struct stats_task_baton_t
+{
+  /* The filesystem to scan.  Used as a template only; the task opens a
+     private instance of it. */
+  svn_fs_t *fs;
+
+  /* First revision in the pack file and the number of revisions in it. */
+  svn_revnum_t base;
+  int count;
+
+  /* Sub-query holding the results of the scan, restricted to the task's
+     revision range.  Merged into the main query by the main thread. */
+  query_t *query;
+
+  /* Private root pool of this task, with a thread-safe allocator. */
+  apr_pool_t *pool;
+} stats_task_baton_t;
+
+/* The work-horse of a stats task: scan the pack file described by TASK
+ * and collect the results in TASK->QUERY. */
+static svn_error_t *
+stats_task_body(stats_task_baton_t *task)
+{
+  svn_fs_t *fs;
+  query_t *query;
+
+  SVN_ERR(open_worker_fs(&fs, task->fs, task->pool));
+
+  /* Set up a sub-query covering just this task's revision range. */
+  query = apr_pcalloc(task->pool, sizeof(*query));
+  query->fs = fs;
+  query->shard_size = task->count;
+  query->head = task->base + task->count - 1;
+  query->min_unpacked_rev = task->base + task->count;
+  query->first_revision = task->base;
+  query->revisions = apr_array_make(task->pool, task->count,
+                                    sizeof(revision_info_t *));
+  query->null_base = apr_pcalloc(task->pool, sizeof(*query->null_base));
+  query->stats = create_stats(task->pool);
+  query->pending_uses = apr_array_make(task->pool, 16, sizeof(rep_ref_t *));
+  query->pending_refs = apr_array_make(task->pool, 16, sizeof(rep_ref_t *));
+  task->query = query;
+
+  if (svn_fs_fs__use_log_addressing(fs))
+    SVN_ERR(read_log_rev_or_packfile(query, task->base, task->count,
+                                     task->pool, task->pool));
+  else
+    SVN_ERR(read_phys_pack_file(query, task->base, task->pool, task->pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_batch__work_func_t.  Scan the pack file
+ * described by BATON, a stats_task_baton_t. */
+static svn_error_t *
+pack_stats_task(void *baton,
+                apr_pool_t *task_pool)
+{
+  return svn_error_trace(stats_task_body(baton));
+}
+
+/* Add the brackets collected in SOURCE to TARGET.
+ */
+static void
+add_histogram(svn_fs_fs__histogram_t *target,
+              const svn_fs_fs__histogram_t *source)
+{
+  int i;
+
+  target->total.count += source->total.count;
+  target->total.sum += source->total.sum;
+  for (i = 0; i < 64; ++i)
+    {
+      target->lines[i].count += source->lines[i].count;
+      target->lines[i].sum += source->lines[i].sum;
+    }
+}
+
+/* Fold the distribution data collected in SOURCE into TARGET.  Aggregate
+ * values are not touched here; they will be derived from the merged
+ * revision info at the very end.  Use SCRATCH_POOL for temporaries.
+ */
+static void
+merge_stats(svn_fs_fs__stats_t *target,
+            const svn_fs_fs__stats_t *source,
+            apr_pool_t *scratch_pool)
+{
+  apr_size_t i;
+  apr_hash_index_t *hi;
+  apr_pool_t *hash_pool = apr_hash_pool_get(target->by_extension);
+
+  /* histograms */
+  add_histogram(&target->rep_size_histogram, &source->rep_size_histogram);
+  add_histogram(&target->node_size_histogram, &source->node_size_histogram);
+  add_histogram(&target->added_rep_size_histogram,
+                &source->added_rep_size_histogram);
+  add_histogram(&target->added_node_size_histogram,
+                &source->added_node_size_histogram);
+  add_histogram(&target->unused_rep_histogram,
+                &source->unused_rep_histogram);
+  add_histogram(&target->file_histogram, &source->file_histogram);
+  add_histogram(&target->file_rep_histogram, &source->file_rep_histogram);
+  add_histogram(&target->file_prop_histogram,
+                &source->file_prop_histogram);
+  add_histogram(&target->file_prop_rep_histogram,
+                &source->file_prop_rep_histogram);
+  add_histogram(&target->dir_histogram, &source->dir_histogram);
+  add_histogram(&target->dir_rep_histogram, &source->dir_rep_histogram);
+  add_histogram(&target->dir_prop_histogram, &source->dir_prop_histogram);
+  add_histogram(&target->dir_prop_rep_histogram,
+                &source->dir_prop_rep_histogram);
+
+  /* largest changes */
+  for (i = 0; i < source->largest_changes->count; ++i)
+    {
+      svn_fs_fs__large_change_info_t *change
+        = source->largest_changes->changes[i];
+
+      /* skip unused entries */
+      if (change->revision == SVN_INVALID_REVNUM)
+        continue;
+
+      store_largest_change(target, change->size, change->revision,
+                           change->path->data);
+    }
+
+  /* per-extension info */
+  for (hi = apr_hash_first(scratch_pool, source->by_extension);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      svn_fs_fs__extension_info_t *source_info = apr_hash_this_val(hi);
+
+      /* get / auto-insert entry for this extension */
+      svn_fs_fs__extension_info_t *info
+        = apr_hash_get(target->by_extension, source_info->extension,
+                       APR_HASH_KEY_STRING);
+      if (info == NULL)
+        {
+          info = apr_pcalloc(hash_pool, sizeof(*info));
+          info->extension = apr_pstrdup(hash_pool, source_info->extension);
+
+          apr_hash_set(target->by_extension, info->extension,
+                       APR_HASH_KEY_STRING, info);
+        }
+
+      add_histogram(&info->node_histogram, &source_info->node_histogram);
+      add_histogram(&info->rep_histogram, &source_info->rep_histogram);
+    }
+}
+
+/* Fold the results collected in SUBQUERY into QUERY: move the revision
+ * info into QUERY's revision array, apply the recorded cross-range
+ * representation references and delta chain links and merge the collected
+ * distribution data.  SUBQUERY must cover the range that directly follows
+ * the revisions already present in QUERY.
+ *
+ * Allocate the copied info in RESULT_POOL, which must live at least as
+ * long as QUERY's own containers.  Use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+merge_sub_query(query_t *query,
+                const query_t *subquery,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  int i, k;
+
+  SVN_ERR_ASSERT(query->revisions->nelts == subquery->first_revision);
+
+  /* Copy the revision info out of the sub-query's private pool. */
+  for (i = 0; i < subquery->revisions->nelts; ++i)
+    {
+      revision_info_t *info = APR_ARRAY_IDX(subquery->revisions, i,
+                                            revision_info_t *);
+      revision_info_t *copy = apr_pmemdup(result_pool, info, sizeof(*info));
+
+      copy->representations
+        = apr_array_make(result_pool, info->representations->nelts,
+                         sizeof(rep_stats_t *));
+      for (k = 0; k < info->representations->nelts; ++k)
+        APR_ARRAY_PUSH(copy->representations, rep_stats_t *)
+          = apr_pmemdup(result_pool,
+                        APR_ARRAY_IDX(info->representations, k,
+                                      rep_stats_t *),
+                        sizeof(rep_stats_t));
+
+      APR_ARRAY_PUSH(query->revisions, revision_info_t *) = copy;
+    }
+
+  /* Apply the references into revision ranges merged before this one. */
+  for (i = 0; i < subquery->pending_uses->nelts; ++i)
+    {
+      int idx;
+      rep_ref_t *use = APR_ARRAY_IDX(subquery->pending_uses, i, rep_ref_t *);
+      rep_stats_t *rep = find_representation(&idx, query, NULL,
+                                             use->revision, use->item_index);
+
+      /* The rep has been created when its own revision got merged. */
+      SVN_ERR_ASSERT(rep);
+      rep->ref_count++;
+    }
+
+  /* Same for delta chains rooted in previously merged ranges. */
+  SVN_ERR(resolve_representation_refs(query, subquery->pending_refs));
+
+  /* Fold the distribution data into the main collector. */
+  merge_stats(query->stats, subquery->stats, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for the task dispatcher callbacks: the main query, the shard
+ * cursor and the pool receiving the merged results. */
+typedef struct stats_batch_baton_t
+{
+  /* The main query to merge all task results into. */
+  query_t *query;
+
+  /* First revision of the next pack file to dispatch a task for. */
+  svn_revnum_t next_base;
+
+  /* Pool receiving the merged per-revision info. */
+  apr_pool_t *result_pool;
+} stats_batch_baton_t;
+
+/* Implements svn_thread_batch__init_func_t with CONTEXT being a
+ * stats_batch_baton_t.  Describe the scan of the next pack file in
+ * *BATON. */
+static svn_error_t *
+init_stats_task(void **baton,
+                void *context,
+                apr_pool_t *task_pool,
+                apr_pool_t *scratch_pool)
+{
+  stats_batch_baton_t *bb = context;
+  stats_task_baton_t *task;
+
+  if (bb->next_base >= bb->query->min_unpacked_rev)
+    return SVN_NO_ERROR;
+
+  task = apr_pcalloc(task_pool, sizeof(*task));
+  task->pool = task_pool;
+  task->fs = bb->query->fs;
+  task->base = bb->next_base;
+  task->count = bb->query->shard_size;
+  bb->next_base += bb->query->shard_size;
+
+  *baton = task;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_batch__process_func_t with CONTEXT being a
+ * stats_batch_baton_t.  Merge the results of TASKS into the main query,
+ * strictly in revision order, and replay the progress notifications. */
+static svn_error_t *
+process_stats_tasks(apr_array_header_t *tasks,
+                    void *context,
+                    apr_pool_t *scratch_pool)
+{
+  stats_batch_baton_t *bb = context;
+  query_t *query = bb->query;
+  int i;
+
+  SVN_ERR(svn_thread_batch__collect(tasks));
+
+  for (i = 0; i < tasks->nelts; ++i)
+    {
+      stats_task_baton_t *task
+        = APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *)->baton;
+
+      SVN_ERR(merge_sub_query(query, task->query, bb->result_pool,
+                              scratch_pool));
+
+      /* one more pack file processed */
+      if (query->progress_func)
+        query->progress_func(task->base, query->progress_baton,
+                             scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Scan the packed shards of QUERY's filesystem with up to NUM_THREADS
+ * worker threads, leaving QUERY in the same state as a serial scan of
+ * those shards would.  Pack files are processed in batches; this thread
+ * merges the results strictly in revision order and replays the progress
+ * notifications.
+ *
+ * Results are allocated in RESULT_POOL; use SCRATCH_POOL for temporary
+ * allocations.
+ */
+static svn_error_t *
+read_packed_revisions_concurrently(query_t *query,
+                                   apr_size_t num_threads,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool)
+{
+  stats_batch_baton_t baton;
+
+  baton.query = query;
+  baton.next_base = 0;
+  baton.result_pool = result_pool;
+
+  return svn_error_trace(svn_thread_batch__run(num_threads,
+                                               init_stats_task,
+                                               pack_stats_task,
+                                               process_stats_tasks,
+                                               &baton,
+                                               query->cancel_func,
+                                               query->cancel_baton,
+                                               scratch_pool));
+}
+#endif /* APR_HAS_THREADS */
+
 svn_error_t *
 svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
                      svn_fs_t *fs,
+                     apr_size_t num_threads,
                      svn_fs_progress_notify_func_t progress_func,
                      void *progress_baton,
                      svn_cancel_func_t cancel_func,
@@ -1392,6 +1835,15 @@ svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
   SVN_ERR(create_query(&query, fs, *stats, progress_func, progress_baton,
                        cancel_func, cancel_baton, scratch_pool,
                        scratch_pool));
+
+#if APR_HAS_THREADS
+  /* The already packed shards are immutable and make up the bulk of the
+   * repository; scan them concurrently. */
+  if (num_threads > 1 && query->shard_size > 0)
+    SVN_ERR(read_packed_revisions_concurrently(query, num_threads,
+                                               scratch_pool, scratch_pool));
+#endif
+
   SVN_ERR(read_revisions(query, scratch_pool, scratch_pool));
   aggregate_stats(query->revisions, *stats);
 
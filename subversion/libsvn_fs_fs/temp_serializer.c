@@ -25,6 +25,7 @@
 #include "svn_pools.h"
 #include "svn_hash.h"
 #include "svn_sorts.h"
+#include "svn_props.h"
 #include "svn_fs.h"
 
 #include "private/svn_fs_util.h"
@@ -144,6 +145,17 @@ serialize_representation(svn_temp_serializer__context_t *context,
                                 sizeof(**representation));
 }
 
+/* Entry names of committed directories are stored front-coded, i.e. as
+ * the length of the prefix shared with the previous entry name plus the
+ * remaining suffix.  Because the entries are sorted, neighboring names
+ * tend to share long prefixes and large directories shrink considerably.
+ * Every NAME_BLOCK_SIZE-th entry stores its full name such that lookups
+ * can binary-search these "anchors" and only need to decode the names
+ * of a single block.  The prefix length is stored as a single character
+ * with a bias of 1 to keep the encoded name a plain C string. */
+#define NAME_BLOCK_SIZE 16
+#define MAX_SHARED_PREFIX_LEN 254
+
 /* auxiliary structure representing the content of a directory array */
 typedef struct dir_data_t
 {
@@ -151,6 +163,10 @@ typedef struct dir_data_t
    * (it's int because the directory is an APR array) */
   int count;
 
+  /* if set, entry names are stored front-coded (see above).
+   * Implies that in-place modification is not supported. */
+  svn_boolean_t folded_names;
+
   /** Current length of the in-txn in-disk representation of the directory.
    * SVN_INVALID_FILESIZE if unknown (i.e. committed data). */
   svn_filesize_t txn_filesize;
@@ -200,11 +216,39 @@ serialize_dir_entry(svn_temp_serializer__context_t *context,
   svn_temp_serializer__pop(context);
 }
 
+/* Return the front-coded form of NAME, sharing up to
+ * MAX_SHARED_PREFIX_LEN leading chars with PREVIOUS.  Allocate the
+ * result in POOL.
+ */
+static const char *
+fold_name(const char *name, const char *previous, apr_pool_t *pool)
+{
+  apr_size_t prefix_len = 0;
+  apr_size_t suffix_len;
+  char *encoded;
+
+  if (previous)
+    while (prefix_len < MAX_SHARED_PREFIX_LEN
+           && name[prefix_len]
+           && name[prefix_len] == previous[prefix_len])
+      ++prefix_len;
+
+  suffix_len = strlen(name + prefix_len);
+  encoded = apr_palloc(pool, suffix_len + 2);
+  encoded[0] = (char)(prefix_len + 1);
+  memcpy(encoded + 1, name + prefix_len, suffix_len + 1);
+
+  return encoded;
+}
+
 /* Utility function to serialize the DIR into a new serialization
  * context to be returned. Allocation will be made form POOL.
+ * If FOLD_NAMES is set, store the entry names front-coded; the result
+ * will be more compact but does not support in-place modification.
  */
 static svn_temp_serializer__context_t *
-serialize_dir(svn_fs_fs__dir_data_t *dir, apr_pool_t *pool)
+serialize_dir(svn_fs_fs__dir_data_t *dir, svn_boolean_t fold_names,
+              apr_pool_t *pool)
 {
   dir_data_t dir_data;
   int i = 0;
@@ -220,14 +264,37 @@ serialize_dir(svn_fs_fs__dir_data_t *dir, apr_pool_t *pool)
 
   /* copy the hash entries to an auxiliary struct of known layout */
   dir_data.count = count;
+  dir_data.folded_names = fold_names;
   dir_data.txn_filesize = dir->txn_filesize;
   dir_data.over_provision = over_provision;
   dir_data.operations = 0;
   dir_data.entries = apr_palloc(pool, entries_len);
   dir_data.lengths = apr_palloc(pool, lengths_len);
 
-  for (i = 0; i < count; ++i)
-    dir_data.entries[i] = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
+  if (fold_names)
+    {
+      /* Serialize pool copies of the dirents whose names have been
+       * replaced by their front-coded form.  Every NAME_BLOCK_SIZE-th
+       * entry keeps its full name as a search anchor. */
+      const char *previous = NULL;
+      for (i = 0; i < count; ++i)
+        {
+          const svn_fs_dirent_t *entry
+            = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
+          svn_fs_dirent_t *folded = apr_pmemdup(pool, entry, sizeof(*entry));
+
+          folded->name = fold_name(entry->name,
+                                   i % NAME_BLOCK_SIZE ? previous : NULL,
+                                   pool);
+          previous = entry->name;
+          dir_data.entries[i] = folded;
+        }
+    }
+  else
+    {
+      for (i = 0; i < count; ++i)
+        dir_data.entries[i] = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
+    }
 
   /* Serialize that aux. structure into a new one. Also, provide a good
    * estimate for the size of the buffer that we will need. */
@@ -268,6 +335,7 @@ deserialize_dir(void *buffer, dir_data_t *dir_data, apr_pool_t *pool)
   apr_size_t count;
   svn_fs_dirent_t *entry;
   svn_fs_dirent_t **entries;
+  const char *previous = NULL;
 
   /* Construct empty directory object. */
   result = apr_pcalloc(pool, sizeof(*result));
@@ -289,6 +357,21 @@ deserialize_dir(void *buffer, dir_data_t *dir_data, apr_pool_t *pool)
       svn_temp_deserializer__resolve(entry, (void **)&entry->name);
       svn_fs_fs__id_deserialize(entry, (svn_fs_id_t **)&entry->id);
 
+      /* expand front-coded names */
+      if (dir_data->folded_names)
+        {
+          apr_size_t prefix_len = (unsigned char)entry->name[0] - 1;
+          const char *suffix = entry->name + 1;
+          apr_size_t suffix_len = strlen(suffix);
+          char *name = apr_palloc(pool, prefix_len + suffix_len + 1);
+
+          if (prefix_len)
+            memcpy(name, previous, prefix_len);
+          memcpy(name + prefix_len, suffix, suffix_len + 1);
+          entry->name = name;
+          previous = name;
+        }
+
       /* add the entry to the hash */
       APR_ARRAY_PUSH(result->entries, svn_fs_dirent_t *) = entry;
     }
@@ -662,6 +745,133 @@ svn_fs_fs__deserialize_properties(void **out,
   return SVN_NO_ERROR;
 }
 
+/* Auxiliary structure representing an inherited properties rollup as a
+   flat list of (parent path, property name, property value) triples.
+   Triples belonging to the same parent are consecutive, parents appear
+   in depth-first order.
+ */
+typedef struct iprops_data_t
+{
+  /* number of triples */
+  apr_size_t count;
+
+  /* reference to the parent paths, one entry per triple */
+  const char **paths;
+
+  /* reference to the property names */
+  const char **names;
+
+  /* reference to the property values */
+  const svn_string_t **values;
+} iprops_data_t;
+
+svn_error_t *
+svn_fs_fs__serialize_iprops(void **data,
+                            apr_size_t *data_len,
+                            void *in,
+                            apr_pool_t *pool)
+{
+  apr_array_header_t *iprops = in;
+  iprops_data_t flat;
+  svn_temp_serializer__context_t *context;
+  svn_stringbuf_t *serialized;
+  apr_size_t count = 0;
+  apr_size_t i;
+  int k;
+
+  /* create our auxiliary data structure */
+  for (k = 0; k < iprops->nelts; ++k)
+    count += apr_hash_count(APR_ARRAY_IDX(iprops, k,
+                                          svn_prop_inherited_item_t *)
+                              ->prop_hash);
+
+  flat.count = count;
+  flat.paths = apr_palloc(pool, sizeof(const char *) * count);
+  flat.names = apr_palloc(pool, sizeof(const char *) * count);
+  flat.values = apr_palloc(pool, sizeof(const svn_string_t *) * count);
+
+  /* populate it with the triples, one per property */
+  i = 0;
+  for (k = 0; k < iprops->nelts; ++k)
+    {
+      const svn_prop_inherited_item_t *item
+        = APR_ARRAY_IDX(iprops, k, svn_prop_inherited_item_t *);
+      apr_hash_index_t *hi;
+
+      for (hi = apr_hash_first(pool, item->prop_hash);
+           hi;
+           hi = apr_hash_next(hi), ++i)
+        {
+          flat.paths[i] = item->path_or_url;
+          flat.names[i] = apr_hash_this_key(hi);
+          flat.values[i] = apr_hash_this_val(hi);
+        }
+    }
+
+  /* serialize it */
+  context = svn_temp_serializer__init(&flat,
+                                      sizeof(flat),
+                                      count * 150,
+                                      pool);
+
+  serialize_cstring_array(context, &flat.paths, count);
+  serialize_cstring_array(context, &flat.names, count);
+  serialize_svn_string_array(context, &flat.values, count);
+
+  /* return the serialized result */
+  serialized = svn_temp_serializer__get(context);
+
+  *data = serialized->data;
+  *data_len = serialized->len;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__deserialize_iprops(void **out,
+                              void *data,
+                              apr_size_t data_len,
+                              apr_pool_t *pool)
+{
+  iprops_data_t *flat = (iprops_data_t *)data;
+  apr_array_header_t *iprops
+    = apr_array_make(pool, 1, sizeof(svn_prop_inherited_item_t *));
+  svn_prop_inherited_item_t *item = NULL;
+  apr_size_t i;
+
+  /* de-serialize our auxiliary data structure */
+  svn_temp_deserializer__resolve(flat, (void**)&flat->paths);
+  svn_temp_deserializer__resolve(flat, (void**)&flat->names);
+  svn_temp_deserializer__resolve(flat, (void**)&flat->values);
+
+  /* re-group consecutive triples of the same parent into one item */
+  for (i = 0; i < flat->count; ++i)
+    {
+      svn_temp_deserializer__resolve(flat->paths,
+                                     (void**)&flat->paths[i]);
+      svn_temp_deserializer__resolve(flat->names,
+                                     (void**)&flat->names[i]);
+      deserialize_svn_string(flat->values,
+                             (svn_string_t **)&flat->values[i]);
+
+      if (item == NULL || strcmp(item->path_or_url, flat->paths[i]) != 0)
+        {
+          item = apr_pcalloc(pool, sizeof(*item));
+          item->path_or_url = flat->paths[i];
+          item->prop_hash = apr_hash_make(pool);
+          APR_ARRAY_PUSH(iprops, svn_prop_inherited_item_t *) = item;
+        }
+
+      apr_hash_set(item->prop_hash, flat->names[i], APR_HASH_KEY_STRING,
+                   flat->values[i]);
+    }
+
+  /* done */
+  *out = iprops;
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__serialize_revprops(void **data,
                               apr_size_t *data_len,
@@ -814,8 +1024,9 @@ svn_fs_fs__serialize_dir_entries(void **data,
   svn_fs_fs__dir_data_t *dir = in;
 
   /* serialize the dir content into a new serialization context
-   * and return the serialized data */
-  return return_serialized_dir_context(serialize_dir(dir, pool),
+   * and return the serialized data.  Committed directories are
+   * immutable, so their entry names can be stored front-coded. */
+  return return_serialized_dir_context(serialize_dir(dir, TRUE, pool),
                                        data,
                                        data_len,
                                        FALSE);
@@ -830,8 +1041,9 @@ svn_fs_fs__serialize_txndir_entries(void **data,
   svn_fs_fs__dir_data_t *dir = in;
 
   /* serialize the dir content into a new serialization context
-   * and return the serialized data */
-  return return_serialized_dir_context(serialize_dir(dir, pool),
+   * and return the serialized data.  Keep the entry names verbatim;
+   * in-txn directories get modified in place. */
+  return return_serialized_dir_context(serialize_dir(dir, FALSE, pool),
                                        data,
                                        data_len,
                                        TRUE);
@@ -852,6 +1064,103 @@ svn_fs_fs__deserialize_dir_entries(void **out,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__serialize_dir_index(void **data,
+                               apr_size_t *data_len,
+                               void *in,
+                               apr_pool_t *pool)
+{
+  svn_fs_fs__dir_index_t *dir_index = in;
+  svn_temp_serializer__context_t *context;
+  svn_stringbuf_t *serialized;
+  apr_int64_t i;
+
+  /* serialize the index and all block names.  Very rough estimate:
+   * 32 chars per name. */
+  context = svn_temp_serializer__init(dir_index,
+                                      sizeof(*dir_index),
+                                      dir_index->block_count * 40,
+                                      pool);
+
+  /* block names array */
+  svn_temp_serializer__push(context,
+                            (const void * const *)&dir_index->names,
+                            dir_index->block_count
+                              * sizeof(*dir_index->names));
+
+  for (i = 0; i < dir_index->block_count; ++i)
+    svn_temp_serializer__add_string(context, &dir_index->names[i]);
+
+  svn_temp_serializer__pop(context);
+
+  /* return the serialized result */
+  serialized = svn_temp_serializer__get(context);
+
+  *data = serialized->data;
+  *data_len = serialized->len;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__deserialize_dir_index(void **out,
+                                 void *data,
+                                 apr_size_t data_len,
+                                 apr_pool_t *pool)
+{
+  svn_fs_fs__dir_index_t *dir_index = (svn_fs_fs__dir_index_t *)data;
+  apr_int64_t i;
+
+  /* de-serialize the block names array */
+  svn_temp_deserializer__resolve(dir_index, (void**)&dir_index->names);
+  for (i = 0; i < dir_index->block_count; ++i)
+    svn_temp_deserializer__resolve(dir_index->names,
+                                   (void**)&dir_index->names[i]);
+
+  *out = dir_index;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__find_dir_block(void **out,
+                          const void *data,
+                          apr_size_t data_len,
+                          void *baton,
+                          apr_pool_t *pool)
+{
+  const svn_fs_fs__dir_index_t *dir_index = data;
+  const char *name = baton;
+
+  /* resolve the reference to the block names array */
+  const char * const *names =
+    svn_temp_deserializer__ptr(data, (const void *const *)&dir_index->names);
+
+  /* binary search for the last block whose first entry name is not
+   * larger than NAME */
+  apr_int64_t lower = 0;
+  apr_int64_t upper = dir_index->block_count;
+
+  while (lower < upper)
+    {
+      apr_int64_t middle = (lower + upper) / 2;
+      const char *block_name =
+        svn_temp_deserializer__ptr(names,
+                                   (const void *const *)&names[middle]);
+
+      if (strcmp(block_name, name) <= 0)
+        lower = middle + 1;
+      else
+        upper = middle;
+    }
+
+  /* LOWER - 1 is the only block that may contain NAME.  It is -1 iff
+   * NAME sorts before all entries in the directory. */
+  *(apr_int64_t *)out = lower - 1;
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__get_sharded_offset(void **out,
                               const void *data,
@@ -927,6 +1236,80 @@ find_entry(svn_fs_dirent_t **entries,
   return lower;
 }
 
+/* Variant of find_entry for front-coded entry names: binary search the
+ * full-name anchors for the block that may contain NAME, then decode
+ * the names of that single block into *NAME_BUF until NAME has been
+ * found or passed.  Allocate *NAME_BUF in POOL; on success, it holds
+ * the (expanded) name of the entry returned.
+ */
+static apr_size_t
+find_folded_entry(svn_fs_dirent_t **entries,
+                  const char *name,
+                  apr_size_t count,
+                  svn_boolean_t *found,
+                  svn_stringbuf_t **name_buf,
+                  apr_pool_t *pool)
+{
+  apr_size_t lower = 0;
+  apr_size_t upper = (count + NAME_BLOCK_SIZE - 1) / NAME_BLOCK_SIZE;
+  apr_size_t middle;
+  apr_size_t pos, block_end;
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(pool);
+
+  *name_buf = buf;
+  *found = FALSE;
+
+  /* binary search for the last block whose anchor name is not larger
+   * than NAME.  Anchor names are stored in full, after the code byte. */
+  while (lower < upper)
+    {
+      const svn_fs_dirent_t *entry;
+      const char *entry_name;
+
+      middle = (lower + upper) / 2;
+      entry = svn_temp_deserializer__ptr(entries,
+                 (const void *const *)&entries[middle * NAME_BLOCK_SIZE]);
+      entry_name = svn_temp_deserializer__ptr(entry,
+                 (const void *const *)&entry->name);
+
+      if (strcmp(entry_name + 1, name) <= 0)
+        lower = middle + 1;
+      else
+        upper = middle;
+    }
+
+  /* NAME sorts before the first entry. */
+  if (lower == 0)
+    return 0;
+
+  /* decode the names of the only candidate block */
+  pos = (lower - 1) * NAME_BLOCK_SIZE;
+  block_end = MIN(pos + NAME_BLOCK_SIZE, count);
+  for (; pos < block_end; ++pos)
+    {
+      const svn_fs_dirent_t *entry =
+          svn_temp_deserializer__ptr(entries,
+                                     (const void *const *)&entries[pos]);
+      const char *entry_name =
+          svn_temp_deserializer__ptr(entry,
+                                     (const void *const *)&entry->name);
+      apr_size_t prefix_len = (unsigned char)entry_name[0] - 1;
+      int diff;
+
+      /* the shared prefix is still in BUF from the previous iteration */
+      svn_stringbuf_chop(buf, buf->len - prefix_len);
+      svn_stringbuf_appendcstr(buf, entry_name + 1);
+
+      diff = strcmp(buf->data, name);
+      if (diff == 0)
+        *found = TRUE;
+      if (diff >= 0)
+        break;
+    }
+
+  return pos;
+}
+
 svn_error_t *
 svn_fs_fs__extract_dir_entry(void **out,
                              const void *data,
@@ -937,6 +1320,8 @@ svn_fs_fs__extract_dir_entry(void **out,
   const dir_data_t *dir_data = data;
   extract_dir_entry_baton_t *entry_baton = baton;
   svn_boolean_t found;
+  svn_stringbuf_t *name_buf = NULL;
+  apr_size_t pos;
 
   /* resolve the reference to the entries array */
   const svn_fs_dirent_t * const *entries =
@@ -947,10 +1332,18 @@ svn_fs_fs__extract_dir_entry(void **out,
     svn_temp_deserializer__ptr(data, (const void *const *)&dir_data->lengths);
 
   /* binary search for the desired entry by name */
-  apr_size_t pos = find_entry((svn_fs_dirent_t **)entries,
-                              entry_baton->name,
-                              dir_data->count,
-                              &found);
+  if (dir_data->folded_names)
+    pos = find_folded_entry((svn_fs_dirent_t **)entries,
+                            entry_baton->name,
+                            dir_data->count,
+                            &found,
+                            &name_buf,
+                            pool);
+  else
+    pos = find_entry((svn_fs_dirent_t **)entries,
+                     entry_baton->name,
+                     dir_data->count,
+                     &found);
 
   /* de-serialize that entry or return NULL, if no match has been found.
    * Be sure to check that the directory contents is still up-to-date. */
@@ -975,6 +1368,11 @@ svn_fs_fs__extract_dir_entry(void **out,
 
       svn_temp_deserializer__resolve(new_entry, (void **)&new_entry->name);
       svn_fs_fs__id_deserialize(new_entry, (svn_fs_id_t **)&new_entry->id);
+
+      /* the serialized name is front-coded; return the expanded one */
+      if (dir_data->folded_names)
+        new_entry->name = name_buf->data;
+
       *(svn_fs_dirent_t **)out = new_entry;
     }
 
@@ -1022,7 +1420,9 @@ slowly_replace_dir_entry(void **data,
         SVN_ERR(svn_sort__array_delete2(entries, idx, 1));
     }
 
-  return svn_fs_fs__serialize_dir_entries(data, data_len, dir, pool);
+  /* Use the txn serialization; this function only ever runs on txn
+   * directories and the result must remain modifiable in place. */
+  return svn_fs_fs__serialize_txndir_entries(data, data_len, dir, pool);
 }
 
 svn_error_t *
@@ -1047,6 +1447,11 @@ svn_fs_fs__replace_dir_entry(void **data,
    * previous state of the directory file. */
   dir_data->txn_filesize = replace_baton->txn_filesize;
 
+  /* front-coded names cannot be modified in place; re-serialize.
+   * This will also return the directory to the verbatim txn format. */
+  if (dir_data->folded_names)
+    return slowly_replace_dir_entry(data, data_len, baton, pool);
+
   /* after quite a number of operations, let's re-pack everything.
    * This is to limit the number of wasted space as we cannot overwrite
    * existing data but must always append. */
@@ -1282,6 +1687,178 @@ svn_fs_fs__deserialize_changes(void **out,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__serialize_changes_bloom(void **data,
+                                   apr_size_t *data_len,
+                                   void *in,
+                                   apr_pool_t *pool)
+{
+  /* A flat, pointer-free struct: serialize by copy. */
+  svn_fs_fs__changes_bloom_t *copy = apr_palloc(pool, sizeof(*copy));
+  *copy = *(svn_fs_fs__changes_bloom_t *)in;
+
+  *data_len = sizeof(*copy);
+  *data = copy;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__deserialize_changes_bloom(void **out,
+                                     void *data,
+                                     apr_size_t data_len,
+                                     apr_pool_t *pool)
+{
+  SVN_ERR_ASSERT(data_len == sizeof(svn_fs_fs__changes_bloom_t));
+  *out = data;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__serialize_changes_index(void **data,
+                                   apr_size_t *data_len,
+                                   void *in,
+                                   apr_pool_t *pool)
+{
+  svn_fs_fs__changes_index_t *index = in;
+  svn_temp_serializer__context_t *context;
+  svn_stringbuf_t *serialized;
+  int i;
+
+  /* serialize it and all its elements */
+  context = svn_temp_serializer__init(index,
+                                      sizeof(*index),
+                                      index->count * 48 + 64,
+                                      pool);
+
+  svn_temp_serializer__push(context,
+                            (const void * const *)&index->offsets,
+                            index->count * sizeof(*index->offsets));
+  svn_temp_serializer__pop(context);
+
+  svn_temp_serializer__push(context,
+                            (const void * const *)&index->paths,
+                            index->count * sizeof(*index->paths));
+  for (i = 0; i < index->count; ++i)
+    svn_temp_serializer__add_string(context, &index->paths[i]);
+
+  svn_temp_serializer__pop(context);
+
+  /* return the serialized result */
+  serialized = svn_temp_serializer__get(context);
+
+  *data = serialized->data;
+  *data_len = serialized->len;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__deserialize_changes_index(void **out,
+                                     void *data,
+                                     apr_size_t data_len,
+                                     apr_pool_t *pool)
+{
+  int i;
+  svn_fs_fs__changes_index_t *index = (svn_fs_fs__changes_index_t *)data;
+
+  /* de-serialize the directory arrays */
+  svn_temp_deserializer__resolve(index, (void **)&index->offsets);
+  svn_temp_deserializer__resolve(index, (void **)&index->paths);
+
+  /* de-serialize each path */
+  for (i = 0; i < index->count; ++i)
+    svn_temp_deserializer__resolve((void *)index->paths,
+                                   (void **)&index->paths[i]);
+
+  /* done */
+  *out = index;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__serialize_lock_digest(void **data,
+                                 apr_size_t *data_len,
+                                 void *in,
+                                 apr_pool_t *pool)
+{
+  svn_fs_fs__lock_digest_t *digest = in;
+  svn_temp_serializer__context_t *context;
+  svn_stringbuf_t *serialized;
+  int i;
+
+  /* serialize it and all its elements */
+  context = svn_temp_serializer__init(digest,
+                                      sizeof(*digest),
+                                      digest->count * 48 + 160,
+                                      pool);
+
+  if (digest->lock)
+    {
+      svn_temp_serializer__push(context,
+                                (const void * const *)&digest->lock,
+                                sizeof(*digest->lock));
+      svn_temp_serializer__add_string(context, &digest->lock->path);
+      svn_temp_serializer__add_string(context, &digest->lock->token);
+      svn_temp_serializer__add_string(context, &digest->lock->owner);
+      svn_temp_serializer__add_string(context, &digest->lock->comment);
+      svn_temp_serializer__pop(context);
+    }
+
+  svn_temp_serializer__push(context,
+                            (const void * const *)&digest->children,
+                            digest->count * sizeof(*digest->children));
+  for (i = 0; i < digest->count; ++i)
+    svn_temp_serializer__add_string(context, &digest->children[i]);
+
+  svn_temp_serializer__pop(context);
+
+  /* return the serialized result */
+  serialized = svn_temp_serializer__get(context);
+
+  *data = serialized->data;
+  *data_len = serialized->len;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__deserialize_lock_digest(void **out,
+                                   void *data,
+                                   apr_size_t data_len,
+                                   apr_pool_t *pool)
+{
+  int i;
+  svn_fs_fs__lock_digest_t *digest = (svn_fs_fs__lock_digest_t *)data;
+
+  /* de-serialize the lock sub-structure, if the path is locked */
+  if (digest->lock)
+    {
+      svn_temp_deserializer__resolve(digest, (void **)&digest->lock);
+      svn_temp_deserializer__resolve(digest->lock,
+                                     (void **)&digest->lock->path);
+      svn_temp_deserializer__resolve(digest->lock,
+                                     (void **)&digest->lock->token);
+      svn_temp_deserializer__resolve(digest->lock,
+                                     (void **)&digest->lock->owner);
+      svn_temp_deserializer__resolve(digest->lock,
+                                     (void **)&digest->lock->comment);
+    }
+
+  /* de-serialize the child digest array */
+  svn_temp_deserializer__resolve(digest, (void **)&digest->children);
+  for (i = 0; i < digest->count; ++i)
+    svn_temp_deserializer__resolve((void *)digest->children,
+                                   (void **)&digest->children[i]);
+
+  /* done */
+  *out = digest;
+
+  return SVN_NO_ERROR;
+}
+
 /* Auxiliary structure representing the content of a svn_mergeinfo_t hash.
    This structure is much easier to (de-)serialize than an APR array.
  */
@@ -158,6 +158,28 @@ svn_fs_fs__deserialize_properties(void **out,
                                   apr_size_t data_len,
                                   apr_pool_t *pool);
 
+/**
+ * Implements #svn_cache__serialize_func_t for an inherited properties
+ * rollup (@a in is an #apr_array_header_t of
+ * #svn_prop_inherited_item_t * elements).
+ */
+svn_error_t *
+svn_fs_fs__serialize_iprops(void **data,
+                            apr_size_t *data_len,
+                            void *in,
+                            apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__deserialize_func_t for an inherited properties
+ * rollup (@a *out is an #apr_array_header_t of
+ * #svn_prop_inherited_item_t * elements).
+ */
+svn_error_t *
+svn_fs_fs__deserialize_iprops(void **out,
+                              void *data,
+                              apr_size_t data_len,
+                              apr_pool_t *pool);
+
 /**
  * Implements #svn_cache__serialize_func_t for a properties hash
  * (@a in is an #apr_hash_t of svn_string_t elements, keyed by const char*).
@@ -242,6 +264,53 @@ svn_fs_fs__deserialize_dir_entries(void **out,
                                    apr_size_t data_len,
                                    apr_pool_t *pool);
 
+/**
+ * Block index of an immutable directory that got sharded into blocks
+ * of sorted entries because it is too large to cache in one piece.
+ */
+typedef struct svn_fs_fs__dir_index_t
+{
+  /** number of entries in the whole directory */
+  apr_int64_t count;
+
+  /** number of entry blocks the directory has been sharded into */
+  apr_int64_t block_count;
+
+  /** name of the first entry in each block; BLOCK_COUNT elements */
+  const char **names;
+} svn_fs_fs__dir_index_t;
+
+/**
+ * Implements #svn_cache__serialize_func_t for a #svn_fs_fs__dir_index_t
+ */
+svn_error_t *
+svn_fs_fs__serialize_dir_index(void **data,
+                               apr_size_t *data_len,
+                               void *in,
+                               apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__deserialize_func_t for a #svn_fs_fs__dir_index_t
+ */
+svn_error_t *
+svn_fs_fs__deserialize_dir_index(void **out,
+                                 void *data,
+                                 apr_size_t data_len,
+                                 apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__partial_getter_func_t for a serialized
+ * #svn_fs_fs__dir_index_t.  Set (apr_int64_t) @a *out to the number of
+ * the block that may contain the entry named (const char *) @a baton,
+ * or to -1 if the index proves that no such entry exists.
+ */
+svn_error_t *
+svn_fs_fs__find_dir_block(void **out,
+                          const void *data,
+                          apr_size_t data_len,
+                          void *baton,
+                          apr_pool_t *pool);
+
 /**
  * Implements #svn_cache__partial_getter_func_t.  Set (apr_off_t) @a *out
  * to the element indexed by (apr_int64_t) @a *baton within the
@@ -406,6 +475,65 @@ svn_fs_fs__deserialize_changes(void **out,
                                apr_size_t data_len,
                                apr_pool_t *pool);
 
+/**
+ * Implements #svn_cache__serialize_func_t for a #svn_fs_fs__changes_bloom_t.
+ */
+svn_error_t *
+svn_fs_fs__serialize_changes_bloom(void **data,
+                                   apr_size_t *data_len,
+                                   void *in,
+                                   apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__deserialize_func_t for a
+ * #svn_fs_fs__changes_bloom_t.
+ */
+svn_error_t *
+svn_fs_fs__deserialize_changes_bloom(void **out,
+                                     void *data,
+                                     apr_size_t data_len,
+                                     apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__serialize_func_t for a
+ * #svn_fs_fs__changes_index_t.
+ */
+svn_error_t *
+svn_fs_fs__serialize_changes_index(void **data,
+                                   apr_size_t *data_len,
+                                   void *in,
+                                   apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__deserialize_func_t for a
+ * #svn_fs_fs__changes_index_t.
+ */
+svn_error_t *
+svn_fs_fs__deserialize_changes_index(void **out,
+                                     void *data,
+                                     apr_size_t data_len,
+                                     apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__serialize_func_t for a
+ * #svn_fs_fs__lock_digest_t.
+ */
+svn_error_t *
+svn_fs_fs__serialize_lock_digest(void **data,
+                                 apr_size_t *data_len,
+                                 void *in,
+                                 apr_pool_t *pool);
+
+/**
+ * Implements #svn_cache__deserialize_func_t for a
+ * #svn_fs_fs__lock_digest_t.
+ */
+svn_error_t *
+svn_fs_fs__deserialize_lock_digest(void **out,
+                                   void *data,
+                                   apr_size_t data_len,
+                                   apr_pool_t *pool);
+
 /**
  * Implements #svn_cache__serialize_func_t for #svn_mergeinfo_t objects.
  */
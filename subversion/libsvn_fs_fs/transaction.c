@@ -24,6 +24,9 @@
 
 #include <assert.h>
 #include <apr_sha1.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
 
 #include "svn_error_codes.h"
 #include "svn_hash.h"
@@ -42,6 +45,7 @@
 #include "cached_data.h"
 #include "lock.h"
 #include "rep-cache.h"
+#include "batch_fsync.h"
 
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
@@ -528,6 +532,13 @@ svn_fs_fs__put_node_revision(svn_fs_t *fs,
 
   SVN_ERR(svn_io_file_close(noderev_file, pool));
 
+  /* Update the txn-local cache with what we just wrote, so that reading
+     it back within the same transaction does not hit the disk. */
+  if (ffd->txn_node_cache)
+    SVN_ERR(svn_cache__set(ffd->txn_node_cache,
+                           svn_fs_fs__id_unparse(id, pool)->data,
+                           noderev, pool));
+
   return SVN_NO_ERROR;
 }
 
@@ -674,22 +685,23 @@ path_change_dup(const svn_fs_path_change2_t *source,
   return result;
 }
 
-/* Merge the internal-use-only CHANGE into a hash of public-FS
+/* Merge the internal-use-only CHANGE into a container of public-FS
    svn_fs_path_change2_t CHANGED_PATHS, collapsing multiple changes into a
    single summarical (is that real word?) change per path.  DELETIONS is
-   also a path->svn_fs_path_change2_t hash and contains all the deletions
-   that got turned into a replacement. */
+   also a path->svn_fs_path_change2_t container and contains all the
+   deletions that got turned into a replacement. */
 static svn_error_t *
-fold_change(apr_hash_t *changed_paths,
-            apr_hash_t *deletions,
+fold_change(svn_hash__fast_t *changed_paths,
+            svn_hash__fast_t *deletions,
             const change_t *change)
 {
-  apr_pool_t *pool = apr_hash_pool_get(changed_paths);
+  apr_pool_t *pool = svn_hash__fast_pool(changed_paths);
   svn_fs_path_change2_t *old_change, *new_change;
   const svn_string_t *path = &change->path;
   const svn_fs_path_change2_t *info = &change->info;
 
-  if ((old_change = apr_hash_get(changed_paths, path->data, path->len)))
+  if ((old_change = svn_hash__fast_get(changed_paths, path->data,
+                                       path->len)))
     {
       /* This path already exists in the hash, so we have to merge
          this change into the already existing one. */
@@ -738,7 +750,7 @@ fold_change(apr_hash_t *changed_paths,
         case svn_fs_path_change_reset:
           /* A reset here will simply remove the path change from the
              hash. */
-          apr_hash_set(changed_paths, path->data, path->len, NULL);
+          svn_hash__fast_set(changed_paths, path->data, path->len, NULL);
           break;
 
         case svn_fs_path_change_delete:
@@ -747,20 +759,23 @@ fold_change(apr_hash_t *changed_paths,
               /* If the path was introduced in this transaction via an
                  add, and we are deleting it, just remove the path
                  altogether.  (The caller will delete any child paths.) */
-              apr_hash_set(changed_paths, path->data, path->len, NULL);
+              svn_hash__fast_set(changed_paths, path->data, path->len, NULL);
             }
           else if (old_change->change_kind == svn_fs_path_change_replace)
             {
               /* A deleting a 'replace' restore the original deletion. */
-              new_change = apr_hash_get(deletions, path->data, path->len);
+              new_change = svn_hash__fast_get(deletions, path->data,
+                                              path->len);
               SVN_ERR_ASSERT(new_change);
-              apr_hash_set(changed_paths, path->data, path->len, new_change);
+              svn_hash__fast_set(changed_paths, path->data, path->len,
+                                 new_change);
             }
           else
             {
               /* A deletion overrules a previous change (modify). */
               new_change = path_change_dup(info, pool);
-              apr_hash_set(changed_paths, path->data, path->len, new_change);
+              svn_hash__fast_set(changed_paths, path->data, path->len,
+                                 new_change);
             }
           break;
 
@@ -773,14 +788,12 @@ fold_change(apr_hash_t *changed_paths,
           new_change = path_change_dup(info, pool);
           new_change->change_kind = svn_fs_path_change_replace;
 
-          apr_hash_set(changed_paths, path->data, path->len, new_change);
+          svn_hash__fast_set(changed_paths, path->data, path->len,
+                             new_change);
 
-          /* Remember the original change.
-           * Make sure to allocate the hash key in a durable pool. */
-          apr_hash_set(deletions,
-                       apr_pstrmemdup(apr_hash_pool_get(deletions),
-                                      path->data, path->len),
-                       path->len, old_change);
+          /* Remember the original change.  The container copies the key
+           * into its own (durable) pool. */
+          svn_hash__fast_set(deletions, path->data, path->len, old_change);
           break;
 
         case svn_fs_path_change_modify:
@@ -799,12 +812,10 @@ fold_change(apr_hash_t *changed_paths,
     }
   else
     {
-      /* Add this path.  The API makes no guarantees that this (new) key
-         will not be retained.  Thus, we copy the key into the target pool
-         to ensure a proper lifetime.  */
-      apr_hash_set(changed_paths,
-                   apr_pstrmemdup(pool, path->data, path->len), path->len,
-                   path_change_dup(info, pool));
+      /* Add this path.  The container copies the key into its own pool,
+         so a proper lifetime is guaranteed.  */
+      svn_hash__fast_set(changed_paths, path->data, path->len,
+                         path_change_dup(info, pool));
     }
 
   return SVN_NO_ERROR;
@@ -814,12 +825,12 @@ fold_change(apr_hash_t *changed_paths,
 typedef struct process_changes_baton_t
 {
   /* Folded list of path changes. */
-  apr_hash_t *changed_paths;
+  svn_hash__fast_t *changed_paths;
 
   /* Path changes that are deletions and have been turned into
      replacements.  If those replacements get deleted again, this
      container contains the record that we have to revert to. */
-  apr_hash_t *deletions;
+  svn_hash__fast_t *deletions;
 } process_changes_baton_t;
 
 /* An implementation of svn_fs_fs__change_receiver_t.
@@ -846,7 +857,8 @@ process_changes(void *baton_p,
   if ((change->info.change_kind == svn_fs_path_change_delete)
        || (change->info.change_kind == svn_fs_path_change_replace))
     {
-      apr_hash_index_t *hi;
+      apr_size_t i;
+      apr_size_t size = svn_hash__fast_size(baton->changed_paths);
 
       /* a potential child path must contain at least 2 more chars
          (the path separator plus at least one char for the name).
@@ -864,15 +876,16 @@ process_changes(void *baton_p,
          The number of changes to process may be >> 1000.
          Therefore, keep the inner loop as tight as possible.
       */
-      for (hi = apr_hash_first(scratch_pool, baton->changed_paths);
-           hi;
-           hi = apr_hash_next(hi))
+      for (i = 0; i < size; ++i)
         {
           /* KEY is the path. */
-          const void *path;
+          const char *path;
           apr_ssize_t klen;
-          svn_fs_path_change2_t *old_change;
-          apr_hash_this(hi, &path, &klen, (void**)&old_change);
+          svn_fs_path_change2_t *old_change
+            = svn_hash__fast_entry(baton->changed_paths, i, &path, &klen);
+
+          if (old_change == NULL)
+            continue;
 
           /* If we come across a child of our path, remove it.
              Call svn_fspath__skip_ancestor only if there is a chance that
@@ -885,7 +898,7 @@ process_changes(void *baton_p,
               child = svn_fspath__skip_ancestor(change->path.data, path);
               if (child && child[0] != '\0')
                 {
-                  apr_hash_set(baton->changed_paths, path, klen, NULL);
+                  svn_hash__fast_set(baton->changed_paths, path, klen, NULL);
                 }
             }
         }
@@ -901,12 +914,16 @@ svn_fs_fs__txn_changes_fetch(apr_hash_t **changed_paths_p,
                              apr_pool_t *pool)
 {
   apr_file_t *file;
-  apr_hash_t *changed_paths = apr_hash_make(pool);
+  apr_hash_t *changed_paths;
   apr_pool_t *scratch_pool = svn_pool_create(pool);
   process_changes_baton_t baton;
+  apr_size_t i, size;
 
-  baton.changed_paths = changed_paths;
-  baton.deletions = apr_hash_make(scratch_pool);
+  /* Fold the changes in an open-addressing container; its iteration in
+     process_changes() is much cheaper than apr_hash_t's.  Values are
+     allocated in POOL, so they can be handed to the caller below. */
+  baton.changed_paths = svn_hash__fast_make(64, pool);
+  baton.deletions = svn_hash__fast_make(16, scratch_pool);
 
   SVN_ERR(svn_io_file_open(&file,
                            path_txn_changes(fs, txn_id, scratch_pool),
@@ -920,6 +937,21 @@ svn_fs_fs__txn_changes_fetch(apr_hash_t **changed_paths_p,
                                   scratch_pool));
   svn_pool_destroy(scratch_pool);
 
+  /* Convert to the apr_hash_t that our callers expect.  Keys and values
+     already live in POOL. */
+  changed_paths = svn_hash__make(pool);
+  size = svn_hash__fast_size(baton.changed_paths);
+  for (i = 0; i < size; ++i)
+    {
+      const char *path;
+      apr_ssize_t klen;
+      void *change = svn_hash__fast_entry(baton.changed_paths, i,
+                                          &path, &klen);
+
+      if (change)
+        apr_hash_set(changed_paths, path, klen, change);
+    }
+
   *changed_paths_p = changed_paths;
 
   return SVN_NO_ERROR;
@@ -1050,8 +1082,15 @@ create_txn_dir(const char **id_p,
                apr_pool_t *pool)
 {
   struct get_and_increment_txn_key_baton cb;
+  fs_fs_data_t *ffd = fs->fsap_data;
   const char *txn_dir;
 
+  /* A configured scratch directory lives outside the repository and
+     may not exist yet (e.g. after a reboot cleared the tmpfs). */
+  if (ffd->txn_scratch_dir)
+    SVN_ERR(svn_io_make_dir_recursively(svn_fs_fs__path_txns_dir(fs, pool),
+                                        pool));
+
   /* Get the current transaction sequence value, which is a base-36
      number, from the txn-current file, and write an
      incremented value back out to the file.  Place the revision
@@ -1086,8 +1125,14 @@ create_txn_dir_pre_1_5(const char **id_p,
 {
   unsigned int i;
   apr_pool_t *subpool;
+  fs_fs_data_t *ffd = fs->fsap_data;
   const char *unique_path, *prefix;
 
+  /* See create_txn_dir(). */
+  if (ffd->txn_scratch_dir)
+    SVN_ERR(svn_io_make_dir_recursively(svn_fs_fs__path_txns_dir(fs, pool),
+                                        pool));
+
   /* Try to create directories named "<txndir>/<rev>-<uniqueifier>.txn". */
   prefix = svn_dirent_join(svn_fs_fs__path_txns_dir(fs, pool),
                            apr_psprintf(pool, "%ld", rev), pool);
@@ -1902,9 +1947,347 @@ fnv1a_checksum_finalize(apr_uint32_t *digest,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* Size of each of the two write-behind buffers.  The value is a trade-off:
+ * larger buffers amortize the hand-over to the background thread better
+ * while smaller ones overlap deltification and disk I/O at a finer grain.
+ * 128kB keeps the hand-over frequency low even for zstd-compressed svndiff
+ * output while still being small relative to the proto-rev file sizes for
+ * which the overlap actually matters.
+ */
+#define WRITE_BEHIND_BUFFER_SIZE (128 * 1024)
+
+/* Double-buffered write-behind stage between the svndiff producer and the
+ * proto-revision file.  While the background thread writes one buffer to
+ * disk, the commit thread may deltify and compress data into the other
+ * one, overlapping CPU and I/O during large commits.
+ *
+ * The commit thread and the background thread never access the file at
+ * the same time:  the background thread only writes while a buffer is
+ * pending and the commit thread hands over buffers one at a time, waiting
+ * for the previous one to complete.  Hence, the existing fsync discipline
+ * at commit time remains unaffected - we merely delay the moment at which
+ * the data enters the OS buffers.
+ */
+struct write_behind_baton
+{
+  /* The proto-revision file.  The background thread writes to this using
+   * plain APR calls only, i.e. without touching any pools. */
+  apr_file_t *file;
+
+  /* The two data buffers, allocated in THREAD_POOL upon first use.
+   * NULL until then. */
+  char *buffer[2];
+
+  /* Index into BUFFER of the buffer currently being filled. */
+  int active;
+
+  /* Number of bytes used in BUFFER[ACTIVE]. */
+  apr_size_t used;
+
+  /* Buffer handed over to the background thread, plus its length.
+   * NULL if the background thread has nothing to do.  Protected by
+   * MUTEX. */
+  const char *pending_data;
+  apr_size_t pending_len;
+
+  /* Set to TRUE to make the background thread terminate.  Protected by
+   * MUTEX. */
+  svn_boolean_t terminate;
+
+  /* First error encountered by the background thread, APR_SUCCESS so far.
+   * Protected by MUTEX. */
+  apr_status_t write_status;
+
+  /* If TRUE, bypass the buffers and write directly to FILE.  This is the
+   * initial state; buffering gets enabled only while svndiff data is
+   * being produced. */
+  svn_boolean_t direct;
+
+  /* The background thread, started lazily upon the first buffer
+   * hand-over.  NULL if it has not been started or already joined. */
+  apr_thread_t *thread;
+
+  /* Synchronization objects, allocated in THREAD_POOL. */
+  apr_thread_mutex_t *mutex;
+  apr_thread_cond_t *has_work;  /* signaled when PENDING_DATA or
+                                   TERMINATE gets set */
+  apr_thread_cond_t *done;      /* signaled when PENDING_DATA gets
+                                   cleared */
+
+  /* Everything the background thread may touch must live in a pool whose
+   * allocator is safe to use from multiple threads, i.e. a root pool.
+   * Destroyed once the thread has been joined. */
+  apr_pool_t *thread_pool;
+
+  /* Commit-thread-only pool for temporary allocations, e.g. error
+   * construction during direct writes. */
+  apr_pool_t *pool;
+};
+
+/* Background thread function:  Write buffers handed over through the
+ * write_behind_baton given in DATA until asked to terminate. */
+static void * APR_THREAD_FUNC
+write_behind_thread(apr_thread_t *thread,
+                    void *data)
+{
+  struct write_behind_baton *wb = data;
+
+  apr_thread_mutex_lock(wb->mutex);
+  while (TRUE)
+    {
+      const char *buffer;
+      apr_size_t len;
+      apr_status_t status;
+
+      while (wb->pending_data == NULL && !wb->terminate)
+        apr_thread_cond_wait(wb->has_work, wb->mutex);
+
+      if (wb->pending_data == NULL)
+        break;
+
+      /* Write outside the critical section such that the commit thread
+       * may fill the other buffer in the meantime. */
+      buffer = wb->pending_data;
+      len = wb->pending_len;
+      apr_thread_mutex_unlock(wb->mutex);
+
+      status = apr_file_write_full(wb->file, buffer, len, NULL);
+
+      apr_thread_mutex_lock(wb->mutex);
+      if (status && !wb->write_status)
+        wb->write_status = status;
+
+      wb->pending_data = NULL;
+      apr_thread_cond_signal(wb->done);
+    }
+  apr_thread_mutex_unlock(wb->mutex);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Hand the currently active buffer in WB over to the background thread,
+ * starting that thread if necessary.  Block while the previous buffer is
+ * still being written.  Falls back to a synchronous write if no thread
+ * can be created. */
+static svn_error_t *
+write_behind_push(struct write_behind_baton *wb)
+{
+  if (!wb->thread)
+    {
+      apr_status_t status = apr_thread_create(&wb->thread, NULL,
+                                              write_behind_thread, wb,
+                                              wb->thread_pool);
+      if (status)
+        {
+          /* No background thread for us, then.  Keep all writes on the
+           * commit thread. */
+          wb->thread = NULL;
+          SVN_ERR(svn_io_file_write_full(wb->file, wb->buffer[wb->active],
+                                         wb->used, NULL, wb->pool));
+          wb->used = 0;
+
+          return SVN_NO_ERROR;
+        }
+    }
+
+  apr_thread_mutex_lock(wb->mutex);
+  while (wb->pending_data)
+    apr_thread_cond_wait(wb->done, wb->mutex);
+
+  /* Surface write errors with at most one buffer of delay. */
+  if (wb->write_status)
+    {
+      apr_status_t status = wb->write_status;
+      apr_thread_mutex_unlock(wb->mutex);
+      return svn_error_wrap_apr(status,
+                                _("Can't write to prototype revision file"));
+    }
+
+  wb->pending_data = wb->buffer[wb->active];
+  wb->pending_len = wb->used;
+  apr_thread_cond_signal(wb->has_work);
+  apr_thread_mutex_unlock(wb->mutex);
+
+  /* Continue filling the other buffer. */
+  wb->active = 1 - wb->active;
+  wb->used = 0;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_write_fn_t.  Buffer DATA in the write_behind_baton given
+ * in BATON, handing full buffers over to the background thread - or write
+ * it directly to the file while buffering is disabled. */
+static svn_error_t *
+write_behind_write(void *baton,
+                   const char *data,
+                   apr_size_t *len)
+{
+  struct write_behind_baton *wb = baton;
+  apr_size_t remaining = *len;
+
+  if (wb->direct)
+    return svn_error_trace(svn_io_file_write_full(wb->file, data, *len,
+                                                  NULL, wb->pool));
+
+  /* Allocate the buffers upon the first actual use such that small reps
+   * don't pay for them. */
+  if (wb->buffer[0] == NULL)
+    {
+      wb->buffer[0] = apr_palloc(wb->thread_pool, WRITE_BEHIND_BUFFER_SIZE);
+      wb->buffer[1] = apr_palloc(wb->thread_pool, WRITE_BEHIND_BUFFER_SIZE);
+    }
+
+  while (remaining > 0)
+    {
+      apr_size_t chunk = MIN(WRITE_BEHIND_BUFFER_SIZE - wb->used, remaining);
+
+      memcpy(wb->buffer[wb->active] + wb->used, data, chunk);
+      wb->used += chunk;
+      data += chunk;
+      remaining -= chunk;
+
+      if (wb->used == WRITE_BEHIND_BUFFER_SIZE)
+        SVN_ERR(write_behind_push(wb));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Wait for all buffers in WB to reach the disk, terminate and join the
+ * background thread and return to direct, synchronous writing.  Afterwards,
+ * file offsets read from WB->FILE are valid again.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+write_behind_drain(struct write_behind_baton *wb,
+                   apr_pool_t *scratch_pool)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  if (wb->direct)
+    return SVN_NO_ERROR;
+
+  if (wb->thread)
+    {
+      apr_status_t status, thread_status;
+
+      apr_thread_mutex_lock(wb->mutex);
+      while (wb->pending_data)
+        apr_thread_cond_wait(wb->done, wb->mutex);
+      wb->terminate = TRUE;
+      apr_thread_cond_signal(wb->has_work);
+      apr_thread_mutex_unlock(wb->mutex);
+
+      status = apr_thread_join(&thread_status, wb->thread);
+      wb->thread = NULL;
+
+      if (status)
+        err = svn_error_wrap_apr(status, _("Can't join write-behind thread"));
+      else if (wb->write_status)
+        err = svn_error_wrap_apr(wb->write_status,
+                                _("Can't write to prototype revision file"));
+    }
+
+  /* Write the data still sitting in the active buffer ourselves. */
+  if (!err && wb->used > 0)
+    err = svn_error_trace(svn_io_file_write_full(wb->file,
+                                                 wb->buffer[wb->active],
+                                                 wb->used, NULL,
+                                                 scratch_pool));
+  wb->used = 0;
+  wb->direct = TRUE;
+
+  return err;
+}
+
+/* Pool cleanup function:  Make sure the background thread of the
+ * write_behind_baton given in DATA is gone before the proto-revision
+ * file gets truncated and closed.  Any unwritten buffer contents are
+ * discarded - we are aborting the rep write anyway. */
+static apr_status_t
+write_behind_abort(void *data)
+{
+  struct write_behind_baton *wb = data;
+
+  if (wb->thread)
+    {
+      apr_status_t thread_status;
+
+      apr_thread_mutex_lock(wb->mutex);
+      while (wb->pending_data)
+        apr_thread_cond_wait(wb->done, wb->mutex);
+      wb->terminate = TRUE;
+      apr_thread_cond_signal(wb->has_work);
+      apr_thread_mutex_unlock(wb->mutex);
+
+      apr_thread_join(&thread_status, wb->thread);
+      wb->thread = NULL;
+    }
+
+  if (wb->thread_pool)
+    {
+      svn_pool_destroy(wb->thread_pool);
+      wb->thread_pool = NULL;
+    }
+
+  return APR_SUCCESS;
+}
+
+/* Set *WB_P to a new write-behind baton for FILE, allocated in POOL.
+ * The baton starts out in direct mode; the caller enables buffering once
+ * all file offsets it needs have been determined. */
+static svn_error_t *
+write_behind_create(struct write_behind_baton **wb_p,
+                    apr_file_t *file,
+                    apr_pool_t *pool)
+{
+  struct write_behind_baton *wb = apr_pcalloc(pool, sizeof(*wb));
+  apr_status_t status;
+
+  wb->file = file;
+  wb->pool = pool;
+  wb->direct = TRUE;
+  wb->write_status = APR_SUCCESS;
+
+  /* The background thread and everything it touches must be allocated
+   * with a thread-safe allocator.  A root pool provides exactly that. */
+  wb->thread_pool = svn_pool_create(NULL);
+
+  status = apr_thread_mutex_create(&wb->mutex, APR_THREAD_MUTEX_DEFAULT,
+                                   wb->thread_pool);
+  if (!status)
+    status = apr_thread_cond_create(&wb->has_work, wb->thread_pool);
+  if (!status)
+    status = apr_thread_cond_create(&wb->done, wb->thread_pool);
+  if (status)
+    {
+      svn_pool_destroy(wb->thread_pool);
+      return svn_error_wrap_apr(status, _("Can't create write-behind mutex"));
+    }
+
+  *wb_p = wb;
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* This baton is used by the representation writing streams.  It keeps
    track of the checksum information as well as the total size of the
    representation so far. */
+/* Content similarity probe parameters.  We fingerprint the first
+   PROBE_SAMPLE_SIZE bytes of the incoming content and of each candidate
+   base with a min-hash sketch of PROBE_SKETCH_SIZE rolling hashes over
+   PROBE_WINDOW_SIZE byte windows.  The sketch overlap approximates the
+   similarity of the sampled contents and is robust against insertions
+   and deletions. */
+#define PROBE_SAMPLE_SIZE  (128 * 1024)
+#define PROBE_SKETCH_SIZE  64
+#define PROBE_WINDOW_SIZE  64
+
 struct rep_write_baton
 {
   /* The FS we are writing to. */
@@ -1917,6 +2300,11 @@ struct rep_write_baton
      deltified, then eventually written to rep_stream. */
   svn_stream_t *delta_stream;
 
+  /* If not NULL, the delta base has not been chosen yet:  incoming
+     content is collected here until there is enough of it to run the
+     content similarity probe over the base candidates. */
+  svn_stringbuf_t *probe_buf;
+
   /* Where is this representation header stored. */
   apr_off_t rep_offset;
 
@@ -1941,6 +2329,11 @@ struct rep_write_baton
   /* calculate a modified FNV-1a checksum of the on-disk representation */
   svn_checksum_ctx_t *fnv1a_checksum_ctx;
 
+#if APR_HAS_THREADS
+  /* Double-buffered write-behind stage between REP_STREAM and FILE. */
+  struct write_behind_baton *write_behind;
+#endif
+
   /* Local / scratch pool, available for temporary allocations. */
   apr_pool_t *scratch_pool;
 
@@ -1948,6 +2341,11 @@ struct rep_write_baton
   apr_pool_t *result_pool;
 };
 
+static svn_error_t *
+rep_write_open_delta_stream(struct rep_write_baton *b,
+                            const char *probe_data,
+                            apr_size_t probe_len);
+
 /* Handler for the write method of the representation writable stream.
    BATON is a rep_write_baton, DATA is the data to write, and *LEN is
    the length of this data. */
@@ -1962,6 +2360,17 @@ rep_write_contents(void *baton,
   SVN_ERR(svn_checksum_update(b->sha1_checksum_ctx, data, *len));
   b->rep_size += *len;
 
+  /* While the delta base is still undecided, only collect probe data. */
+  if (b->probe_buf)
+    {
+      svn_stringbuf_appendbytes(b->probe_buf, data, *len);
+      if (b->probe_buf->len >= PROBE_SAMPLE_SIZE)
+        SVN_ERR(rep_write_open_delta_stream(b, b->probe_buf->data,
+                                            b->probe_buf->len));
+
+      return SVN_NO_ERROR;
+    }
+
   /* If we are writing a delta, use that stream. */
   if (b->delta_stream)
     return svn_stream_write(b->delta_stream, data, len);
@@ -2005,6 +2414,59 @@ shards_spanned(int *spanned,
   return SVN_NO_ERROR;
 }
 
+/* Set *REP to NULL if the representation in *REP is not worth using as
+   a delta base in FS: because it is too small to recoup the delta
+   overhead, because its own delta chain is already too long, or because
+   it would drag too many extra shards into the read path.  Perform
+   temporary allocations in POOL. */
+static svn_error_t *
+reject_unsuitable_base(representation_t **rep,
+                       svn_fs_t *fs,
+                       apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  int chain_length = 0;
+  int shard_count = 0;
+
+  /* Maximum acceptable chain length: reading the node back requires
+   * combining one txdelta window chain per element, so this is also
+   * our bound on the predicted read cost.  Unless configured
+   * explicitly, allow some minimal chain scaled by how acceptable
+   * longer linear chains are in this repo. */
+  int max_chain_length = ffd->max_delta_chain_length > 0
+                         ? (int)ffd->max_delta_chain_length
+                         : 2 * (int)ffd->max_linear_deltification + 2;
+
+  /* Very short rep bases are simply not worth it as we are unlikely
+   * to re-coup the deltification space overhead of 20+ bytes. */
+  svn_filesize_t rep_size = (*rep)->expanded_size;
+  if (rep_size < 64)
+    {
+      *rep = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  /* Check whether the length of the deltification chain is acceptable.
+   * Otherwise, shared reps may form a non-skipping delta chain in
+   * extreme cases. */
+  SVN_ERR(svn_fs_fs__rep_chain_length(&chain_length, &shard_count,
+                                      *rep, fs, pool));
+
+  if (chain_length >= max_chain_length)
+    *rep = NULL;
+  else
+    /* To make it worth opening additional shards / pack files, we
+     * require that the reps have a certain minimal size.  To deltify
+     * against a rep in different shard, the lower limit is 512 bytes
+     * and doubles with every extra shard to visit along the delta
+     * chain. */
+    if (   shard_count > 1
+        && ((svn_filesize_t)128 << shard_count) >= rep_size)
+      *rep = NULL;
+
+  return SVN_NO_ERROR;
+}
+
 /* Given a node-revision NODEREV in filesystem FS, return the
    representation in *REP to use as the base for a text representation
    delta if PROPS is FALSE.  If PROPS has been set, a suitable props
@@ -2089,40 +2551,219 @@ choose_delta_base(representation_t **rep,
   /* if we encountered a shared rep, its parent chain may be different
    * from the node-rev parent chain. */
   if (*rep)
+    SVN_ERR(reject_unsuitable_base(rep, fs, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Similarity sketch: the PROBE_SKETCH_SIZE smallest distinct rolling
+   hash values seen in a data sample, in no particular order. */
+typedef struct similarity_sketch_t
+{
+  apr_uint32_t hashes[PROBE_SKETCH_SIZE];
+
+  /* Number of used entries in HASHES. */
+  int count;
+} similarity_sketch_t;
+
+/* Fill SKETCH with the min-hash sketch of the LEN bytes at DATA. */
+static void
+similarity_sketch(similarity_sketch_t *sketch,
+                  const char *data,
+                  apr_size_t len)
+{
+  const unsigned char *p = (const unsigned char *)data;
+  apr_uint32_t hash = 0;
+  apr_uint32_t out_factor = 1;
+  apr_uint32_t largest = 0;
+  int largest_idx = 0;
+  apr_size_t i;
+
+  /* Factor by which the window's oldest byte got multiplied, i.e.
+     31^PROBE_WINDOW_SIZE mod 2^32. */
+  for (i = 0; i < PROBE_WINDOW_SIZE; ++i)
+    out_factor *= 31;
+
+  sketch->count = 0;
+  for (i = 0; i < len; ++i)
     {
-      int chain_length = 0;
-      int shard_count = 0;
+      apr_uint32_t sample;
+      int k;
+
+      /* Roll the polynomial hash forward by one byte. */
+      hash = hash * 31 + p[i];
+      if (i >= PROBE_WINDOW_SIZE)
+        hash -= out_factor * p[i - PROBE_WINDOW_SIZE];
+      if (i + 1 < PROBE_WINDOW_SIZE)
+        continue;
 
-      /* Very short rep bases are simply not worth it as we are unlikely
-       * to re-coup the deltification space overhead of 20+ bytes. */
-      svn_filesize_t rep_size = (*rep)->expanded_size;
-      if (rep_size < 64)
+      /* Scramble the raw hash such that "smallest N" becomes a pseudo-
+         random sample of all window hashes. */
+      sample = hash * 2654435761u;
+      sample ^= sample >> 16;
+
+      if (sketch->count < PROBE_SKETCH_SIZE)
         {
-          *rep = NULL;
-          return SVN_NO_ERROR;
+          for (k = 0; k < sketch->count; ++k)
+            if (sketch->hashes[k] == sample)
+              break;
+          if (k < sketch->count)
+            continue;
+
+          sketch->hashes[sketch->count++] = sample;
+          if (sample >= largest || sketch->count == 1)
+            {
+              largest = sample;
+              largest_idx = sketch->count - 1;
+            }
+        }
+      else if (sample < largest)
+        {
+          for (k = 0; k < PROBE_SKETCH_SIZE; ++k)
+            if (sketch->hashes[k] == sample)
+              break;
+          if (k < PROBE_SKETCH_SIZE)
+            continue;
+
+          /* Replace the largest entry and find the new largest. */
+          sketch->hashes[largest_idx] = sample;
+          largest = sketch->hashes[0];
+          largest_idx = 0;
+          for (k = 1; k < PROBE_SKETCH_SIZE; ++k)
+            if (sketch->hashes[k] > largest)
+              {
+                largest = sketch->hashes[k];
+                largest_idx = k;
+              }
         }
+    }
+}
 
-      /* Check whether the length of the deltification chain is acceptable.
-       * Otherwise, shared reps may form a non-skipping delta chain in
-       * extreme cases. */
-      SVN_ERR(svn_fs_fs__rep_chain_length(&chain_length, &shard_count,
-                                          *rep, fs, pool));
+/* Return the number of hash values that SKETCH1 and SKETCH2 have in
+   common. */
+static int
+similarity_score(const similarity_sketch_t *sketch1,
+                 const similarity_sketch_t *sketch2)
+{
+  int i, k;
+  int score = 0;
 
-      /* Some reasonable limit, depending on how acceptable longer linear
-       * chains are in this repo.  Also, allow for some minimal chain. */
-      if (chain_length >= 2 * (int)ffd->max_linear_deltification + 2)
-        *rep = NULL;
-      else
-        /* To make it worth opening additional shards / pack files, we
-         * require that the reps have a certain minimal size.  To deltify
-         * against a rep in different shard, the lower limit is 512 bytes
-         * and doubles with every extra shard to visit along the delta
-         * chain. */
-        if (   shard_count > 1
-            && ((svn_filesize_t)128 << shard_count) >= rep_size)
-          *rep = NULL;
+  for (i = 0; i < sketch1->count; ++i)
+    for (k = 0; k < sketch2->count; ++k)
+      if (sketch1->hashes[i] == sketch2->hashes[k])
+        {
+          ++score;
+          break;
+        }
+
+  return score;
+}
+
+/* Like choose_delta_base() for file contents, but additionally compare
+   the revision-distance choice against NODEREV's most recent ancestors
+   by content similarity with the incoming data, of which the first LEN
+   bytes are given in DATA.  Deltifying "oscillating" contents against
+   the nearest ancestor can produce deltas an order of magnitude larger
+   than an older but near-identical base would.
+
+   Use POOL for allocations and temporaries. */
+static svn_error_t *
+choose_delta_base_probed(representation_t **rep,
+                         svn_fs_t *fs,
+                         node_revision_t *noderev,
+                         const char *data,
+                         apr_size_t len,
+                         apr_pool_t *pool)
+{
+  /* Number of most recent ancestors to consider besides the default
+     choice.  Two suffice to catch contents flipping between states. */
+  enum { probe_ancestors = 2 };
+
+  representation_t *candidates[1 + probe_ancestors];
+  int candidate_count = 0;
+  node_revision_t *walk;
+  similarity_sketch_t data_sketch;
+  similarity_sketch_t base_sketch;
+  char *sample;
+  int best_score = -1;
+  int i;
+  apr_pool_t *iterpool;
+
+  SVN_ERR(choose_delta_base(rep, fs, noderev, FALSE, pool));
+
+  /* Tiny contents delta well against almost anything; don't spend any
+     probe I/O on them. */
+  if (len < 1024 || ! noderev->predecessor_count)
+    return SVN_NO_ERROR;
+
+  if (*rep)
+    candidates[candidate_count++] = *rep;
+
+  /* Collect the most recent ancestors as alternative candidates. */
+  walk = noderev;
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < probe_ancestors && walk->predecessor_count; ++i)
+    {
+      representation_t *candidate;
+      int k;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__get_node_revision(&walk, fs, walk->predecessor_id,
+                                           pool, iterpool));
+      candidate = walk->data_rep;
+      if (candidate == NULL)
+        continue;
+
+      /* Drop duplicates of the default choice or of each other. */
+      for (k = 0; k < candidate_count; ++k)
+        if (   candidates[k]->revision == candidate->revision
+            && candidates[k]->item_index == candidate->item_index)
+          break;
+      if (k < candidate_count)
+        continue;
+
+      SVN_ERR(reject_unsuitable_base(&candidate, fs, iterpool));
+      if (candidate)
+        candidates[candidate_count++] = candidate;
     }
 
+  if (candidate_count < 2)
+    {
+      svn_pool_destroy(iterpool);
+      return SVN_NO_ERROR;
+    }
+
+  /* Fingerprint the incoming content, then pick the most similar
+     candidate.  On a tie, the earlier (default first, then nearer)
+     candidate wins. */
+  similarity_sketch(&data_sketch, data, len);
+  sample = apr_palloc(pool, PROBE_SAMPLE_SIZE);
+
+  for (i = 0; i < candidate_count; ++i)
+    {
+      svn_stream_t *contents;
+      apr_size_t sample_len = PROBE_SAMPLE_SIZE;
+      int score;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__get_contents(&contents, fs, candidates[i], FALSE,
+                                      iterpool));
+      SVN_ERR(svn_stream_read_full(contents, sample, &sample_len));
+      SVN_ERR(svn_stream_close(contents));
+
+      similarity_sketch(&base_sketch, sample, sample_len);
+      score = similarity_score(&data_sketch, &base_sketch);
+
+      /* A score of 0 signals no similarity at all; never let it
+         override the revision-distance choice. */
+      if (score > best_score && score > 0)
+        {
+          best_score = score;
+          *rep = candidates[i];
+        }
+    }
+
+  svn_pool_destroy(iterpool);
   return SVN_NO_ERROR;
 }
 
@@ -2169,7 +2810,12 @@ txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
   fs_fs_data_t *ffd = fs->fsap_data;
   int svndiff_version;
 
-  if (ffd->delta_compression_type == compression_type_lz4)
+  if (ffd->delta_compression_type == compression_type_zstd)
+    {
+      SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF3_FORMAT);
+      svndiff_version = 3;
+    }
+  else if (ffd->delta_compression_type == compression_type_lz4)
     {
       SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF2_FORMAT);
       svndiff_version = 2;
@@ -2188,6 +2834,79 @@ txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
                           ffd->delta_compression_level, pool);
 }
 
+/* Choose the delta base for the representation B is writing, write the
+   rep header to B's proto-rev file, and create B->DELTA_STREAM.  If
+   PROBE_DATA is not NULL, it holds the first PROBE_LEN bytes of the
+   incoming content and a similarity probe is run over the base
+   candidates.  Drops B->PROBE_BUF. */
+static svn_error_t *
+rep_write_open_delta_stream(struct rep_write_baton *b,
+                            const char *probe_data,
+                            apr_size_t probe_len)
+{
+  representation_t *base_rep;
+  svn_stream_t *source;
+  svn_txdelta_window_handler_t wh;
+  void *whb;
+  svn_fs_fs__rep_header_t header = { 0 };
+
+  /* Get the base for this delta. */
+  if (probe_data)
+    SVN_ERR(choose_delta_base_probed(&base_rep, b->fs, b->noderev,
+                                     probe_data, probe_len,
+                                     b->scratch_pool));
+  else
+    SVN_ERR(choose_delta_base(&base_rep, b->fs, b->noderev, FALSE,
+                              b->scratch_pool));
+  SVN_ERR(svn_fs_fs__get_contents(&source, b->fs, base_rep, TRUE,
+                                  b->scratch_pool));
+
+  /* Write out the rep header. */
+  if (base_rep)
+    {
+      header.base_revision = base_rep->revision;
+      header.base_item_index = base_rep->item_index;
+      header.base_length = base_rep->size;
+      header.type = svn_fs_fs__rep_delta;
+    }
+  else
+    {
+      header.type = svn_fs_fs__rep_self_delta;
+    }
+  SVN_ERR(svn_fs_fs__write_rep_header(&header, b->rep_stream,
+                                      b->scratch_pool));
+
+  /* Now determine the offset of the actual svndiff data. */
+  SVN_ERR(svn_io_file_get_offset(&b->delta_start, b->file,
+                                 b->scratch_pool));
+
+#if APR_HAS_THREADS
+  /* All offsets we need have been determined above.  Buffer the svndiff
+     data written below, so that deltifying and compressing one chunk
+     overlaps the disk write of the previous one. */
+  b->write_behind->direct = FALSE;
+#endif
+
+  /* Prepare to write the svndiff data. */
+  txdelta_to_svndiff(&wh, &whb, b->rep_stream, b->fs, b->result_pool);
+
+  b->delta_stream = svn_txdelta_target_push(wh, whb, source,
+                                            b->scratch_pool);
+
+  /* Flush the probe buffer, if any, into the delta stream. */
+  if (b->probe_buf)
+    {
+      svn_stringbuf_t *buf = b->probe_buf;
+      apr_size_t len = buf->len;
+
+      b->probe_buf = NULL;
+      if (len)
+        SVN_ERR(svn_stream_write(b->delta_stream, buf->data, &len));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Get a rep_write_baton and store it in *WB_P for the representation
    indicated by NODEREV in filesystem FS.  Perform allocations in
    POOL.  Only appropriate for file contents, not for props or
@@ -2200,11 +2919,7 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
 {
   struct rep_write_baton *b;
   apr_file_t *file;
-  representation_t *base_rep;
-  svn_stream_t *source;
-  svn_txdelta_window_handler_t wh;
-  void *whb;
-  svn_fs_fs__rep_header_t header = { 0 };
+  fs_fs_data_t *ffd = fs->fsap_data;
 
   b = apr_pcalloc(pool, sizeof(*b));
 
@@ -2223,46 +2938,39 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
                                  b->scratch_pool));
 
   b->file = file;
+#if APR_HAS_THREADS
+  /* Channel all writes through the write-behind stage.  It starts out in
+     direct mode, so the offsets determined below remain valid. */
+  SVN_ERR(write_behind_create(&b->write_behind, file, b->scratch_pool));
+  b->rep_stream = svn_stream_create(b->write_behind, b->scratch_pool);
+  svn_stream_set_write(b->rep_stream, write_behind_write);
+#else
   b->rep_stream = svn_stream_from_aprfile2(file, TRUE, b->scratch_pool);
+#endif
   if (svn_fs_fs__use_log_addressing(fs))
     b->rep_stream = fnv1a_wrap_stream(&b->fnv1a_checksum_ctx, b->rep_stream,
                                       b->scratch_pool);
 
   SVN_ERR(svn_io_file_get_offset(&b->rep_offset, file, b->scratch_pool));
 
-  /* Get the base for this delta. */
-  SVN_ERR(choose_delta_base(&base_rep, fs, noderev, FALSE, b->scratch_pool));
-  SVN_ERR(svn_fs_fs__get_contents(&source, fs, base_rep, TRUE,
-                                  b->scratch_pool));
-
-  /* Write out the rep header. */
-  if (base_rep)
-    {
-      header.base_revision = base_rep->revision;
-      header.base_item_index = base_rep->item_index;
-      header.base_length = base_rep->size;
-      header.type = svn_fs_fs__rep_delta;
-    }
-  else
-    {
-      header.type = svn_fs_fs__rep_self_delta;
-    }
-  SVN_ERR(svn_fs_fs__write_rep_header(&header, b->rep_stream,
-                                      b->scratch_pool));
-
-  /* Now determine the offset of the actual svndiff data. */
-  SVN_ERR(svn_io_file_get_offset(&b->delta_start, file,
-                                 b->scratch_pool));
-
   /* Cleanup in case something goes wrong. */
   apr_pool_cleanup_register(b->scratch_pool, b, rep_write_cleanup,
                             apr_pool_cleanup_null);
 
-  /* Prepare to write the svndiff data. */
-  txdelta_to_svndiff(&wh, &whb, b->rep_stream, fs, pool);
-
-  b->delta_stream = svn_txdelta_target_push(wh, whb, source,
-                                            b->scratch_pool);
+#if APR_HAS_THREADS
+  /* Registered after REP_WRITE_CLEANUP, hence run before it:  the
+     background thread must be gone before the file gets truncated. */
+  apr_pool_cleanup_register(b->scratch_pool, b->write_behind,
+                            write_behind_abort, apr_pool_cleanup_null);
+#endif
+
+  if (ffd->probe_delta_bases && noderev->predecessor_count)
+    /* Defer the delta base decision until we have seen enough of the
+       incoming content to run the similarity probe. */
+    b->probe_buf = svn_stringbuf_create_ensure(PROBE_SAMPLE_SIZE,
+                                               b->scratch_pool);
+  else
+    SVN_ERR(rep_write_open_delta_stream(b, NULL, 0));
 
   *wb_p = b;
 
@@ -2520,11 +3228,24 @@ rep_write_contents_close(void *baton)
 
   rep = apr_pcalloc(b->result_pool, sizeof(*rep));
 
+  /* Small contents may still sit in the probe buffer in their
+     entirety; pick the delta base now and flush them. */
+  if (b->probe_buf)
+    SVN_ERR(rep_write_open_delta_stream(b, b->probe_buf->data,
+                                        b->probe_buf->len));
+
   /* Close our delta stream so the last bits of svndiff are written
      out. */
   if (b->delta_stream)
     SVN_ERR(svn_stream_close(b->delta_stream));
 
+#if APR_HAS_THREADS
+  /* Flush all svndiff data still sitting in the write-behind buffers and
+     return to synchronous writes, so the offsets read from FILE below are
+     valid and GET_SHARED_REP can read the rep contents back. */
+  SVN_ERR(write_behind_drain(b->write_behind, b->scratch_pool));
+#endif
+
   /* Determine the length of the svndiff data. */
   SVN_ERR(svn_io_file_get_offset(&offset, b->file, b->scratch_pool));
   rep->size = offset - b->delta_start;
@@ -3732,6 +4453,15 @@ struct commit_baton {
   apr_array_header_t *reps_to_cache;
   apr_hash_t *reps_hash;
   apr_pool_t *reps_pool;
+
+  /* Pool that outlives the write lock; output data for the deferred
+     post-commit stage below is allocated here. */
+  apr_pool_t *result_pool;
+
+  /* Set by commit_body for the post-commit stage: the directories
+     written by this commit and its changed-paths list. */
+  apr_array_header_t *directory_ids;
+  apr_hash_t *changed_paths;
 };
 
 /* The work-horse for svn_fs_fs__commit, called with the FS write lock.
@@ -3753,8 +4483,15 @@ commit_body(void *baton, apr_pool_t *pool)
   apr_off_t initial_offset, changed_path_offset;
   const svn_fs_fs__id_part_t *txn_id = svn_fs_fs__txn_get_id(cb->txn);
   apr_hash_t *changed_paths;
-  apr_array_header_t *directory_ids = apr_array_make(pool, 4,
-                                                     sizeof(pair_cache_key_t));
+  apr_array_header_t *directory_ids
+    = apr_array_make(cb->result_pool, 4, sizeof(pair_cache_key_t));
+  svn_fs_fs__batch_fsync_t *batch = NULL;
+
+  /* If enabled, collect the fsyncs for the new revision's files in a
+     batch and run them concurrently just before updating 'current',
+     instead of issuing them serially as the files get written. */
+  if (ffd->flush_to_disk && ffd->batch_fsync)
+    SVN_ERR(svn_fs_fs__batch_fsync_create(&batch, TRUE, pool));
 
   /* Re-Read the current repository format.  All our repo upgrade and
      config evaluation strategies are such that existing information in
@@ -3786,9 +4523,11 @@ commit_body(void *baton, apr_pool_t *pool)
                             _("Transaction out of date"));
 
   /* We need the changes list for verification as well as for writing it
-     to the final rev file. */
+     to the final rev file.  Allocate it in the longer-lived pool: the
+     deferred post-commit stage still needs it after the write lock and
+     with it this pool have been released. */
   SVN_ERR(svn_fs_fs__txn_changes_fetch(&changed_paths, cb->fs, txn_id,
-                                       pool));
+                                       cb->result_pool));
 
   /* Locks may have been added (or stolen) between the calling of
      previous svn_fs.h functions and svn_fs_commit_txn(), so we need
@@ -3837,7 +4576,9 @@ commit_body(void *baton, apr_pool_t *pool)
                                      NULL, pool));
     }
 
-  if (ffd->flush_to_disk)
+  /* When batching, the same data will be flushed under its final name
+     once the file has been moved into place below. */
+  if (ffd->flush_to_disk && !batch)
     SVN_ERR(svn_io_file_flush_to_disk(proto_file, pool));
   SVN_ERR(svn_io_file_close(proto_file, pool));
 
@@ -3863,6 +4604,8 @@ commit_body(void *baton, apr_pool_t *pool)
                                                     PATH_REVS_DIR,
                                                     pool),
                                     new_dir, pool));
+          if (batch)
+            SVN_ERR(svn_fs_fs__batch_fsync_new_path(batch, new_dir, pool));
         }
 
       /* Create the revprops shard. */
@@ -3879,6 +4622,8 @@ commit_body(void *baton, apr_pool_t *pool)
                                                     PATH_REVPROPS_DIR,
                                                     pool),
                                     new_dir, pool));
+          if (batch)
+            SVN_ERR(svn_fs_fs__batch_fsync_new_path(batch, new_dir, pool));
         }
     }
 
@@ -3891,8 +4636,18 @@ commit_body(void *baton, apr_pool_t *pool)
   rev_filename = svn_fs_fs__path_rev(cb->fs, new_rev, pool);
   proto_filename = svn_fs_fs__path_txn_proto_rev(cb->fs, txn_id, pool);
   SVN_ERR(svn_fs_fs__move_into_place(proto_filename, rev_filename,
-                                     old_rev_filename, ffd->flush_to_disk,
-                                     pool));
+                                     old_rev_filename,
+                                     ffd->flush_to_disk && !batch, pool));
+  if (batch)
+    {
+      apr_file_t *file;
+
+      /* Schedule the rev file data as well as its directory entry for
+         the concurrent flush. */
+      SVN_ERR(svn_fs_fs__batch_fsync_open_file(&file, batch, rev_filename,
+                                               pool));
+      SVN_ERR(svn_fs_fs__batch_fsync_new_path(batch, rev_filename, pool));
+    }
 
   /* Now that we've moved the prototype revision file out of the way,
      we can unlock it (since further attempts to write to the file
@@ -3904,7 +4659,20 @@ commit_body(void *baton, apr_pool_t *pool)
   SVN_ERR_ASSERT(! svn_fs_fs__is_packed_revprop(cb->fs, new_rev));
   revprop_filename = svn_fs_fs__path_revprops(cb->fs, new_rev, pool);
   SVN_ERR(write_final_revprop(revprop_filename, old_rev_filename,
-                              cb->txn, ffd->flush_to_disk, pool));
+                              cb->txn, ffd->flush_to_disk && !batch, pool));
+  if (batch)
+    {
+      apr_file_t *file;
+
+      SVN_ERR(svn_fs_fs__batch_fsync_open_file(&file, batch,
+                                               revprop_filename, pool));
+      SVN_ERR(svn_fs_fs__batch_fsync_new_path(batch, revprop_filename,
+                                              pool));
+
+      /* Flush everything scheduled so far to disk, concurrently.  Only
+         then may the new revision become visible in 'current'. */
+      SVN_ERR(svn_fs_fs__batch_fsync_run(batch, pool));
+    }
 
   /* Run paranoia checks. */
   if (ffd->verify_before_commit)
@@ -3925,26 +4693,35 @@ commit_body(void *baton, apr_pool_t *pool)
 
   ffd->youngest_rev_cache = new_rev;
 
-  /* Make the directory contents alreday cached for the new revision
-   * visible. */
-  SVN_ERR(promote_cached_directories(cb->fs, directory_ids, pool));
-
-  /* Remove this transaction directory. */
-  SVN_ERR(svn_fs_fs__purge_txn(cb->fs, cb->txn->id, pool));
+  /* Everything else - cache priming, removing the txn directory and
+     the rep-cache updates - is advisory and does not need the write
+     lock.  Hand the necessary data to svn_fs_fs__commit() and let it
+     run that deferred stage after the lock has been released, so other
+     committers can proceed in the meantime. */
+  cb->directory_ids = directory_ids;
+  cb->changed_paths = changed_paths;
 
   return SVN_NO_ERROR;
 }
 
+/* Number of entries to write to the rep-cache database per SQLite
+ * transaction.  Each transaction takes the database's single writer
+ * lock, so the batch size bounds how long one committer can starve
+ * the rep-cache writes of all others. */
+#define REP_WRITE_BATCH_SIZE 128
+
 /* Add the representations in REPS_TO_CACHE (an array of representation_t *)
- * to the rep-cache database of FS. */
+ * with indexes FIRST to LAST-1 to the rep-cache database of FS. */
 static svn_error_t *
 write_reps_to_cache(svn_fs_t *fs,
                     const apr_array_header_t *reps_to_cache,
+                    int first,
+                    int last,
                     apr_pool_t *scratch_pool)
 {
   int i;
 
-  for (i = 0; i < reps_to_cache->nelts; i++)
+  for (i = first; i < last; i++)
     {
       representation_t *rep = APR_ARRAY_IDX(reps_to_cache, i, representation_t *);
 
@@ -3966,6 +4743,9 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
   cb.new_rev_p = new_rev_p;
   cb.fs = fs;
   cb.txn = txn;
+  cb.result_pool = pool;
+  cb.directory_ids = NULL;
+  cb.changed_paths = NULL;
 
   if (ffd->rep_sharing_allowed)
     {
@@ -3980,40 +4760,108 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
       cb.reps_pool = NULL;
     }
 
+  /* Flush the proto-rev file to disk before taking the write lock.
+     The bulk of the new revision's data - everything written while the
+     transaction was built up - is already in that file, so the
+     expensive flush happens here, where concurrent committers can
+     perform it in parallel.  The serialized section in commit_body then
+     only needs to sync the comparatively small finalization data it
+     appends, which is what keeps a burst of simultaneous commits from
+     paying the full durability cost one after another. */
+  if (ffd->flush_to_disk)
+    {
+      apr_file_t *proto_file;
+      void *proto_file_lockcookie;
+      const svn_fs_fs__id_part_t *txn_id = svn_fs_fs__txn_get_id(txn);
+
+      SVN_ERR(get_writable_proto_rev(&proto_file, &proto_file_lockcookie,
+                                     fs, txn_id, pool));
+      SVN_ERR(svn_io_file_flush_to_disk(proto_file, pool));
+      SVN_ERR(svn_io_file_close(proto_file, pool));
+      SVN_ERR(unlock_proto_rev(fs, txn_id, proto_file_lockcookie, pool));
+    }
+
   SVN_ERR(svn_fs_fs__with_write_lock(fs, commit_body, &cb, pool));
 
   /* At this point, *NEW_REV_P has been set, so errors below won't affect
-     the success of the commit.  (See svn_fs_commit_txn().)  */
+     the success of the commit.  (See svn_fs_commit_txn().)
+
+     This is the deferred post-commit stage: everything from here on is
+     advisory - cache priming, txn directory removal and the rep-cache
+     updates - and deliberately runs after the write lock has been
+     released so it does not serialize other committers. */
+
+  /* Make the directory contents already cached for the new revision
+   * visible. */
+  SVN_ERR(promote_cached_directories(fs, cb.directory_ids, pool));
+
+  /* Seed the changed-paths bloom filter for the new revision from the
+   * change list we just wrote, so that the first history scan does not
+   * need to parse it again.  This must only happen after the revision
+   * has become visible: up to that point another process could still
+   * have claimed the same revision number for different content. */
+  if (ffd->changes_bloom_cache)
+    {
+      svn_fs_fs__changes_bloom_t *bloom = apr_pcalloc(pool, sizeof(*bloom));
+      apr_hash_index_t *hi;
+
+      pair_cache_key_t key;
+      key.revision = *new_rev_p;
+      key.second = 0;
+
+      for (hi = apr_hash_first(pool, cb.changed_paths);
+           hi;
+           hi = apr_hash_next(hi))
+        svn_fs_fs__changes_bloom_add_path(bloom, apr_hash_this_key(hi));
+
+      SVN_ERR(svn_cache__set(ffd->changes_bloom_cache, &key, bloom, pool));
+    }
+
+  /* Remove this transaction directory. */
+  SVN_ERR(svn_fs_fs__purge_txn(fs, txn->id, pool));
 
   if (ffd->rep_sharing_allowed)
     {
-      svn_error_t *err;
+      int first;
 
       SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
       /* Write new entries to the rep-sharing database.
        *
-       * We use an sqlite transaction to speed things up;
+       * We use sqlite transactions to speed things up;
        * see <http://www.sqlite.org/faq.html#q19>.
-       */
-      /* ### A commit that touches thousands of files will starve other
-             (reader/writer) commits for the duration of the below call.
-             Maybe write in batches? */
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = write_reps_to_cache(fs, cb.reps_to_cache, pool);
-      err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
-
-      if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
+       *
+       * Write them in batches of REP_WRITE_BATCH_SIZE so that a commit
+       * touching thousands of files does not starve other commits for
+       * the duration of a single huge transaction: between batches the
+       * database's writer lock gets released and other committers can
+       * interleave their own rep-cache writes. */
+      for (first = 0;
+           first < cb.reps_to_cache->nelts;
+           first += REP_WRITE_BATCH_SIZE)
         {
-          /* Failed rollback means that our db connection is unusable, and
-             the only thing we can do is close it.  The connection will be
-             reopened during the next operation with rep-cache.db. */
-          return svn_error_trace(
-              svn_error_compose_create(err,
-                                       svn_fs_fs__close_rep_cache(fs)));
+          svn_error_t *err;
+          int last = first + REP_WRITE_BATCH_SIZE;
+          if (last > cb.reps_to_cache->nelts)
+            last = cb.reps_to_cache->nelts;
+
+          SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
+          err = write_reps_to_cache(fs, cb.reps_to_cache, first, last, pool);
+          err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
+
+          if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
+            {
+              /* Failed rollback means that our db connection is unusable,
+                 and the only thing we can do is close it.  The connection
+                 will be reopened during the next operation with
+                 rep-cache.db. */
+              return svn_error_trace(
+                  svn_error_compose_create(err,
+                                           svn_fs_fs__close_rep_cache(fs)));
+            }
+          else if (err)
+            return svn_error_trace(err);
         }
-      else if (err)
-        return svn_error_trace(err);
     }
 
   return SVN_NO_ERROR;
@@ -4036,6 +4884,20 @@ svn_fs_fs__list_transactions(apr_array_header_t **names_p,
   /* Get the transactions directory. */
   txn_dir = svn_fs_fs__path_txns_dir(fs, pool);
 
+  /* A configured scratch directory is created lazily by the first
+     transaction; treat its absence as "no transactions". */
+  if (((fs_fs_data_t *)fs->fsap_data)->txn_scratch_dir)
+    {
+      svn_node_kind_t kind;
+
+      SVN_ERR(svn_io_check_path(txn_dir, &kind, pool));
+      if (kind == svn_node_none)
+        {
+          *names_p = names;
+          return SVN_NO_ERROR;
+        }
+    }
+
   /* Now find a listing of this directory. */
   SVN_ERR(svn_io_get_dirents3(&dirents, txn_dir, TRUE, pool, pool));
 
@@ -4149,6 +5011,16 @@ svn_fs_fs__delete_node_revision(svn_fs_t *fs,
         }
     }
 
+  /* remove the corresponding entry from the cache, if such exists */
+  {
+    fs_fs_data_t *ffd = fs->fsap_data;
+    if (ffd->txn_node_cache)
+      {
+        const char *key = svn_fs_fs__id_unparse(id, pool)->data;
+        SVN_ERR(svn_cache__set(ffd->txn_node_cache, key, NULL, pool));
+      }
+  }
+
   return svn_io_remove_file2(svn_fs_fs__path_txn_node_rev(fs, id, pool),
                              FALSE, pool);
 }
@@ -64,6 +64,7 @@
 #include "util.h"
 
 #include "private/svn_mergeinfo_private.h"
+#include "private/svn_perf.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
@@ -195,29 +196,36 @@ svn_fs_fs__create_dag_cache(apr_pool_t *pool)
   return result;
 }
 
-/* Clears the CACHE at regular intervals (destroying all cached nodes)
+/* Clears the CACHE at regular intervals (destroying all cached nodes).
+ * Return TRUE if the cache got cleared and previously obtained references
+ * to cache contents have become invalid.
  */
-static void
+static svn_boolean_t
 auto_clear_dag_cache(fs_fs_dag_cache_t* cache)
 {
-  if (cache->insertions > BUCKET_COUNT)
-    {
-      svn_pool_clear(cache->pool);
+  if (cache->insertions <= BUCKET_COUNT)
+    return FALSE;
 
-      memset(cache->buckets, 0, sizeof(cache->buckets));
-      cache->insertions = 0;
-    }
+  svn_pool_clear(cache->pool);
+
+  memset(cache->buckets, 0, sizeof(cache->buckets));
+  cache->insertions = 0;
+
+  return TRUE;
 }
 
-/* Returns a 32 bit hash value for the given REVISION and PATH of exactly
- * PATH_LEN chars.
+/* For the given REVISION and PATH of exactly PATH_LEN chars, return the
+ * respective entry in CACHE.  If the entry is empty, its NODE member will
+ * be NULL and the caller may then set it to the corresponding DAG node
+ * allocated in CACHE->POOL.
  */
-static apr_uint32_t
-hash_func(svn_revnum_t revision,
-          const char *path,
-          apr_size_t path_len)
+static cache_entry_t *
+cache_lookup(fs_fs_dag_cache_t *cache,
+             svn_revnum_t revision,
+             const char *path,
+             apr_size_t path_len)
 {
-  apr_size_t i;
+  apr_size_t i, bucket_index;
   apr_uint32_t hash_value = (apr_uint32_t)revision;
 
 #if SVN_UNALIGNED_ACCESS_IS_OK
@@ -225,7 +233,20 @@ hash_func(svn_revnum_t revision,
   const apr_uint32_t factor = 0xd1f3da69;
 #endif
 
-  /* Calculate the hash value
+  /* optimistic lookup: hit the same bucket again? */
+  cache_entry_t *result = &cache->buckets[cache->last_hit];
+  if (   (result->revision == revision)
+      && (result->path_len == path_len)
+      && !memcmp(result->path, path, path_len))
+    {
+      /* Remember the position of the last node we found in this cache. */
+      if (result->node)
+        cache->last_non_empty = cache->last_hit;
+
+      return result;
+    }
+
+  /* need to do a full lookup.  Calculate the hash value
      (HASH_VALUE has been initialized to REVISION).
 
      Note that the actual hash function is arbitrary as long as its result
@@ -268,37 +289,6 @@ hash_func(svn_revnum_t revision,
      */
     hash_value = hash_value * 32 + (hash_value + (unsigned char)path[i]);
 
-  return hash_value;
-}
-
-/* For the given REVISION and PATH, return the respective node found in
- * CACHE.  If there is none, return NULL.
- */
-static dag_node_t *
-cache_lookup( fs_fs_dag_cache_t *cache
-            , svn_revnum_t revision
-            , const char *path)
-{
-  apr_size_t bucket_index;
-  apr_size_t path_len = strlen(path);
-  apr_uint32_t hash_value;
-
-  /* optimistic lookup: hit the same bucket again? */
-  cache_entry_t *result = &cache->buckets[cache->last_hit];
-  if (   (result->revision == revision)
-      && (result->path_len == path_len)
-      && !memcmp(result->path, path, path_len))
-    {
-      /* Remember the position of the last node we found in this cache. */
-      if (result->node)
-        cache->last_non_empty = cache->last_hit;
-
-      return result->node;
-    }
-
-  /* need to do a full lookup. */
-  hash_value = hash_func(revision, path, path_len);
-
   bucket_index = hash_value + (hash_value >> 16);
   bucket_index = (bucket_index + (bucket_index >> 8)) % BUCKET_COUNT;
 
@@ -313,7 +303,17 @@ cache_lookup( fs_fs_dag_cache_t *cache
       || (result->path_len != path_len)
       || memcmp(result->path, path, path_len))
     {
-      return NULL;
+      result->hash_value = hash_value;
+      result->revision = revision;
+      if (result->path_len < path_len || result->path_len == 0)
+        result->path = apr_palloc(cache->pool, path_len + 1);
+      result->path_len = path_len;
+      memcpy(result->path, path, path_len);
+      result->path[path_len] = 0;
+
+      result->node = NULL;
+
+      cache->insertions++;
     }
   else if (result->node)
     {
@@ -322,46 +322,7 @@ cache_lookup( fs_fs_dag_cache_t *cache
       cache->last_non_empty = bucket_index;
     }
 
-  return result->node;
-}
-
-/* Store a copy of NODE in CACHE, taking  REVISION and PATH as key.
- * This function will clean the cache at regular intervals.
- */
-static void
-cache_insert(fs_fs_dag_cache_t *cache,
-             svn_revnum_t revision,
-             const char *path,
-             dag_node_t *node)
-{
-  apr_size_t bucket_index;
-  apr_size_t path_len = strlen(path);
-  apr_uint32_t hash_value;
-  cache_entry_t *entry;
-
-  auto_clear_dag_cache(cache);
-
-  /* calculate the bucket index to use */
-  hash_value = hash_func(revision, path, path_len);
-
-  bucket_index = hash_value + (hash_value >> 16);
-  bucket_index = (bucket_index + (bucket_index >> 8)) % BUCKET_COUNT;
-
-  /* access the corresponding bucket and remember its location */
-  entry = &cache->buckets[bucket_index];
-  cache->last_hit = bucket_index;
-
-  /* if it is *NOT* a match,  clear the bucket, expect the caller to fill
-     in the node and count it as an insertion */
-  entry->hash_value = hash_value;
-  entry->revision = revision;
-  if (entry->path_len < path_len)
-    entry->path = apr_palloc(cache->pool, path_len + 1);
-  entry->path_len = path_len;
-  memcpy(entry->path, path, path_len + 1);
-
-  entry->node = svn_fs_fs__dag_dup(node, cache->pool);
-  cache->insertions++;
+  return result;
 }
 
 /* Optimistic lookup using the last seen non-empty location in CACHE.
@@ -439,9 +400,12 @@ dag_node_cache_get(dag_node_t **node_p,
       /* immutable DAG node. use the global caches for it */
 
       fs_fs_data_t *ffd = root->fs->fsap_data;
+      cache_entry_t *bucket;
 
-      node = cache_lookup(ffd->dag_node_cache, root->rev, path);
-      if (node == NULL)
+      auto_clear_dag_cache(ffd->dag_node_cache);
+      bucket = cache_lookup(ffd->dag_node_cache, root->rev, path,
+                            strlen(path));
+      if (bucket->node == NULL)
         {
           locate_cache(&cache, &key, root, path, pool);
           SVN_ERR(svn_cache__get((void **)&node, &found, cache, key, pool));
@@ -452,13 +416,14 @@ dag_node_cache_get(dag_node_t **node_p,
               svn_fs_fs__dag_set_fs(node, root->fs);
 
               /* Retain the DAG node in L1 cache. */
-              cache_insert(ffd->dag_node_cache, root->rev, path, node);
+              bucket->node = svn_fs_fs__dag_dup(node,
+                                                ffd->dag_node_cache->pool);
             }
         }
       else
         {
           /* Copy the node from L1 cache into the passed-in POOL. */
-          node = svn_fs_fs__dag_dup(node, pool);
+          node = svn_fs_fs__dag_dup(bucket->node, pool);
         }
     }
   else
@@ -495,7 +460,28 @@ dag_node_cache_set(svn_fs_root_t *root,
   SVN_ERR_ASSERT(*path == '/');
 
   locate_cache(&cache, &key, root, path, pool);
-  return svn_cache__set(cache, key, node, pool);
+  SVN_ERR(svn_cache__set(cache, key, node, pool));
+
+  if (!root->is_txn_root)
+    {
+      /* Immutable DAG node.  Keep it in the L1 cache as well such that
+         the next lookup for it will not even touch the serialized L2.
+
+         NODE may itself live in the L1 cache's pool (see
+         try_match_last_node), so we must not dereference it anymore once
+         auto_clear_dag_cache cleared that pool. */
+      fs_fs_data_t *ffd = root->fs->fsap_data;
+      fs_fs_dag_cache_t *dag_cache = ffd->dag_node_cache;
+
+      if (!auto_clear_dag_cache(dag_cache))
+        {
+          cache_entry_t *bucket = cache_lookup(dag_cache, root->rev, path,
+                                               strlen(path));
+          bucket->node = svn_fs_fs__dag_dup(node, dag_cache->pool);
+        }
+    }
+
+  return SVN_NO_ERROR;
 }
 
 
@@ -968,12 +954,12 @@ err_not_directory(svn_fs_root_t *root,
    get_dag().
 */
 static svn_error_t *
-open_path(parent_path_t **parent_path_p,
-          svn_fs_root_t *root,
-          const char *path,
-          int flags,
-          svn_boolean_t is_txn_path,
-          apr_pool_t *pool)
+open_path_internal(parent_path_t **parent_path_p,
+                   svn_fs_root_t *root,
+                   const char *path,
+                   int flags,
+                   svn_boolean_t is_txn_path,
+                   apr_pool_t *pool)
 {
   svn_fs_t *fs = root->fs;
   dag_node_t *here = NULL; /* The directory we're currently looking at.  */
@@ -1200,6 +1186,28 @@ open_path(parent_path_t **parent_path_p,
   return SVN_NO_ERROR;
 }
 
+/* Thin instrumented frontend to open_path_internal(); see there for the
+   actual documentation.  DAG traversal is one of the main CPU sinks on
+   the server side, hence the dedicated probe. */
+static svn_error_t *
+open_path(parent_path_t **parent_path_p,
+          svn_fs_root_t *root,
+          const char *path,
+          int flags,
+          svn_boolean_t is_txn_path,
+          apr_pool_t *pool)
+{
+  svn_error_t *err;
+  SVN_PERF_TIMER(timer);
+
+  SVN_PERF_TIMER_START(timer);
+  err = open_path_internal(parent_path_p, root, path, flags, is_txn_path,
+                           pool);
+  SVN_PERF_TIMER_STOP(svn_perf__probe_fs_open_path, timer);
+
+  return svn_error_trace(err);
+}
+
 
 /* Make the node referred to by PARENT_PATH mutable, if it isn't
    already, allocating from POOL.  ROOT must be the root from which
@@ -1604,6 +1612,97 @@ fs_node_has_props(svn_boolean_t *has_props,
                                                   scratch_pool));
 }
 
+/* The real work of fs_node_inherited_proplist(): set *IPROPS_P to the
+   properties that canonical PATH inherits from its parents in ROOT, as
+   an array of svn_prop_inherited_item_t * in depth-first order, i.e.
+   the repository root first.  Parents without properties are omitted
+   and the paths carry no leading '/'.  Allocate the result in
+   RESULT_POOL and temporaries in SCRATCH_POOL. */
+static svn_error_t *
+node_inherited_proplist(apr_array_header_t **iprops_p,
+                        svn_fs_root_t *root,
+                        const char *path,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *iprops;
+  apr_array_header_t *parents;
+  parent_path_t *parent_path;
+  int i;
+
+  /* A single walk from the root gives us the dag nodes of all parents. */
+  SVN_ERR(open_path(&parent_path, root, path, 0, FALSE, scratch_pool));
+
+  parents = apr_array_make(scratch_pool, 16, sizeof(parent_path_t *));
+  for (parent_path = parent_path->parent;
+       parent_path;
+       parent_path = parent_path->parent)
+    APR_ARRAY_PUSH(parents, parent_path_t *) = parent_path;
+
+  iprops = apr_array_make(result_pool, parents->nelts,
+                          sizeof(svn_prop_inherited_item_t *));
+
+  /* PARENTS holds the chain deepest-first; emit it root-first. */
+  for (i = parents->nelts - 1; i >= 0; --i)
+    {
+      apr_hash_t *proplist;
+
+      parent_path = APR_ARRAY_IDX(parents, i, parent_path_t *);
+      SVN_ERR(svn_fs_fs__dag_get_proplist(&proplist, parent_path->node,
+                                          result_pool));
+      if (proplist && apr_hash_count(proplist))
+        {
+          svn_prop_inherited_item_t *i_props =
+            apr_pcalloc(result_pool, sizeof(*i_props));
+          i_props->path_or_url =
+            apr_pstrdup(result_pool,
+                        parent_path_path(parent_path, scratch_pool) + 1);
+          i_props->prop_hash = proplist;
+          APR_ARRAY_PUSH(iprops, svn_prop_inherited_item_t *) = i_props;
+        }
+    }
+
+  *iprops_p = iprops;
+  return SVN_NO_ERROR;
+}
+
+/* Caching wrapper around node_inherited_proplist(), implementing the
+   corresponding root vtable entry.  The rollup is keyed by revision and
+   path, so new revisions invalidate it naturally. */
+static svn_error_t *
+fs_node_inherited_proplist(apr_array_header_t **iprops_p,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = root->fs->fsap_data;
+
+  path = svn_fs__canonicalize_abspath(path, scratch_pool);
+
+  if (ffd->iprops_cache && !root->is_txn_root)
+    {
+      const char *cache_key
+        = svn_fs_fs__combine_number_and_string(root->rev, path, scratch_pool);
+      svn_boolean_t found;
+
+      SVN_ERR(svn_cache__get((void **)iprops_p, &found, ffd->iprops_cache,
+                             cache_key, result_pool));
+      if (found)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(node_inherited_proplist(iprops_p, root, path,
+                                      result_pool, scratch_pool));
+      SVN_ERR(svn_cache__set(ffd->iprops_cache, cache_key, *iprops_p,
+                             scratch_pool));
+
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(node_inherited_proplist(iprops_p, root, path,
+                                                 result_pool, scratch_pool));
+}
+
 static svn_error_t *
 increment_mergeinfo_up_tree(parent_path_t *pp,
                             apr_int64_t increment,
@@ -2476,6 +2575,135 @@ fs_dir_entries(apr_hash_t **table_p,
   return SVN_NO_ERROR;
 }
 
+/* Set *HAS_PROPS to TRUE if the node revision NODEREV in FS has any
+   properties.  Same logic as svn_fs_fs__dag_has_props() but operating
+   on the noderev directly.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+noderev_has_props(svn_boolean_t *has_props,
+                  svn_fs_t *fs,
+                  node_revision_t *noderev,
+                  apr_pool_t *scratch_pool)
+{
+  if (! noderev->prop_rep)
+    {
+      *has_props = FALSE;
+    }
+  else if (svn_fs_fs__id_txn_used(&noderev->prop_rep->txn_id))
+    {
+      /* We are in a commit or something. Check actual properties */
+      apr_hash_t *proplist;
+
+      SVN_ERR(svn_fs_fs__get_proplist(&proplist, fs, noderev,
+                                      scratch_pool));
+      *has_props = proplist ? (0 < apr_hash_count(proplist)) : FALSE;
+    }
+  else
+    {
+      /* Properties are stored as a standard hash stream,
+         always ending with "END\n" (4 bytes) */
+      *has_props = noderev->prop_rep->expanded_size > 4;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *TABLE_P to a newly allocated APR hash table mapping the entry
+   names of the directory at PATH in ROOT to svn_fs_dirent_full_t
+   structures, allocated in POOL.
+
+   Instead of opening one DAG node per entry, fetch the respective
+   noderevs directly: one batched lookup in the noderev cache plus
+   individual reads for whatever the cache does not hold.  That halves
+   the per-entry cache traffic of tree walkers that stat every entry. */
+static svn_error_t *
+fs_dir_entries_full(apr_hash_t **table_p,
+                    svn_fs_root_t *root,
+                    const char *path,
+                    apr_pool_t *pool)
+{
+  svn_fs_t *fs = root->fs;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_hash_t *entries;
+  apr_hash_t *result = svn_hash__make(pool);
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *dirents;
+  const void **keys;
+  void **values = NULL;
+  svn_boolean_t *found = NULL;
+  apr_hash_index_t *hi;
+  int count;
+  int i;
+
+  /* Read the directory itself, then collect the entries in a stable
+     order together with their noderev cache keys. */
+  SVN_ERR(fs_dir_entries(&entries, root, path, pool));
+
+  count = (int)apr_hash_count(entries);
+  dirents = apr_array_make(scratch_pool, count, sizeof(svn_fs_dirent_t *));
+  keys = apr_palloc(scratch_pool, count * sizeof(*keys));
+
+  for (hi = apr_hash_first(scratch_pool, entries); hi;
+       hi = apr_hash_next(hi))
+    {
+      svn_fs_dirent_t *dirent = apr_hash_this_val(hi);
+      i = dirents->nelts;
+      APR_ARRAY_PUSH(dirents, svn_fs_dirent_t *) = dirent;
+
+      /* Only noderevs in rev / pack files live in the cache; a NULL
+         key is a guaranteed miss. */
+      if (!svn_fs_fs__id_is_txn(dirent->id))
+        {
+          const svn_fs_fs__id_part_t *rev_item
+            = svn_fs_fs__id_rev_item(dirent->id);
+          pair_cache_key_t *key = apr_pcalloc(scratch_pool, sizeof(*key));
+
+          key->revision = rev_item->revision;
+          key->second = rev_item->number;
+          keys[i] = key;
+        }
+      else
+        keys[i] = NULL;
+    }
+
+  /* The batched cache pass. */
+  if (ffd->node_revision_cache && count)
+    {
+      values = apr_palloc(scratch_pool, count * sizeof(*values));
+      found = apr_pcalloc(scratch_pool, count * sizeof(*found));
+      SVN_ERR(svn_cache__get_many(values, found, ffd->node_revision_cache,
+                                  keys, count, scratch_pool));
+    }
+
+  /* Convert the noderevs, fetching those that were not cached. */
+  for (i = 0; i < count; ++i)
+    {
+      svn_fs_dirent_t *dirent = APR_ARRAY_IDX(dirents, i, svn_fs_dirent_t *);
+      svn_fs_dirent_full_t *full = apr_pcalloc(pool, sizeof(*full));
+      node_revision_t *noderev = found && found[i] ? values[i] : NULL;
+
+      svn_pool_clear(iterpool);
+      if (noderev == NULL)
+        SVN_ERR(svn_fs_fs__get_node_revision(&noderev, fs, dirent->id,
+                                             scratch_pool, iterpool));
+
+      full->name = dirent->name;
+      full->id = dirent->id;
+      full->kind = dirent->kind;
+      if (dirent->kind == svn_node_file)
+        SVN_ERR(svn_fs_fs__file_length(&full->size, noderev, iterpool));
+      SVN_ERR(noderev_has_props(&full->has_props, fs, noderev, iterpool));
+      full->created_rev = svn_fs_fs__id_rev(noderev->id);
+
+      svn_hash_sets(result, full->name, full);
+    }
+
+  svn_pool_destroy(scratch_pool);
+
+  *table_p = result;
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 fs_dir_optimal_order(apr_array_header_t **ordered_p,
                      svn_fs_root_t *root,
@@ -3507,6 +3735,52 @@ fs_report_changes(svn_fs_path_change_iterator_t **iterator,
   return SVN_NO_ERROR;
 }
 
+/* Implements root_vtable_t.changes_may_touch_paths using the per-revision
+   changed-paths bloom filter. */
+static svn_error_t *
+fs_changes_may_touch_paths(svn_boolean_t *may_touch,
+                           svn_fs_root_t *root,
+                           const apr_array_header_t *paths,
+                           apr_pool_t *scratch_pool)
+{
+  svn_fs_fs__changes_bloom_t *bloom;
+  int i;
+
+  /* Transactions are still in flux; give the conservative answer. */
+  if (root->is_txn_root)
+    {
+      *may_touch = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_fs_fs__get_changes_bloom(&bloom, root->fs, root->rev,
+                                       scratch_pool, scratch_pool));
+
+  *may_touch = FALSE;
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_boolean_t touched, known;
+
+      if (!svn_fs_fs__changes_bloom_may_touch(bloom, path))
+        continue;
+
+      /* The filter gave a "maybe".  Try to weed out false positives
+         with an exact check that reads only the relevant blocks of the
+         changed-paths list. */
+      SVN_ERR(svn_fs_fs__changes_path_touched(&touched, &known, root->fs,
+                                              root->rev, path,
+                                              scratch_pool));
+      if (!known || touched)
+        {
+          *may_touch = TRUE;
+          break;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Our coolio opaque history object. */
 typedef struct fs_history_data_t
@@ -4548,6 +4822,7 @@ fs_get_mergeinfo(svn_fs_root_t *root,
 static root_vtable_t root_vtable = {
   fs_paths_changed,
   fs_report_changes,
+  fs_changes_may_touch_paths,
   svn_fs_fs__check_path,
   fs_node_history,
   svn_fs_fs__node_id,
@@ -4563,6 +4838,7 @@ static root_vtable_t root_vtable = {
   fs_node_prop,
   fs_node_proplist,
   fs_node_has_props,
+  fs_node_inherited_proplist,
   fs_change_node_prop,
   fs_props_changed,
   fs_dir_entries,
@@ -4579,6 +4855,7 @@ static root_vtable_t root_vtable = {
   fs_get_file_delta_stream,
   fs_merge,
   fs_get_mergeinfo,
+  fs_dir_entries_full,
 };
 
 /* Construct a new root object in FS, allocated from POOL.  */
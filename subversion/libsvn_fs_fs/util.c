@@ -237,6 +237,15 @@ const char *
 svn_fs_fs__path_txns_dir(svn_fs_t *fs,
                          apr_pool_t *pool)
 {
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  /* If configured, transaction scratch data lives outside the
+     repository, e.g. on a tmpfs.  Proto revision files are not kept
+     here (see svn_fs_fs__path_txn_proto_revs), so the final revision
+     data still gets moved into place with a same-device rename. */
+  if (ffd->txn_scratch_dir)
+    return apr_pstrdup(pool, ffd->txn_scratch_dir);
+
   return svn_dirent_join(fs->path, PATH_TXNS_DIR, pool);
 }
 
@@ -20,10 +20,15 @@
  * ====================================================================
  */
 
+#include <apr_thread_proc.h>
+
+#include "svn_hash.h"
+#include "svn_pools.h"
 #include "svn_sorts.h"
 #include "svn_checksum.h"
 #include "svn_time.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_batch.h"
 
 #include "verify.h"
 #include "fs_fs.h"
@@ -792,6 +797,229 @@ pack_size(svn_fs_t *fs, svn_revnum_t rev)
   return rev < ffd->min_unpacked_rev ? ffd->max_files_per_dir : 1;
 }
 
+#if APR_HAS_THREADS
+/* Baton for verify_pack_metadata(), describing a single rev / pack file
+ * whose metadata consistency shall be verified by a worker thread. */
+struct verify_task_baton
+{
+  /* Private filesystem handle for this task.  svn_fs_t objects must not
+     be shared between threads, so each task opens its own. */
+  svn_fs_t *fs;
+
+  /* First revision in the rev / pack file to verify. */
+  svn_revnum_t pack_start;
+
+  /* First revision after the rev / pack file to verify. */
+  svn_revnum_t pack_end;
+
+  /* Number of revisions in the rev / pack file at dispatch time.
+     Used to detect concurrent packing. */
+  svn_revnum_t count;
+};
+
+/* Baton for the task dispatcher callbacks, tracking the progress of the
+ * verification run as a whole. */
+struct verify_batch_baton
+{
+  /* The filesystem being verified. */
+  svn_fs_t *fs;
+
+  /* Next revision to dispatch a task for.  May get rewound when a
+     shard gets packed concurrently, see process_verified_tasks(). */
+  svn_revnum_t revision;
+
+  /* Last revision to verify. */
+  svn_revnum_t end;
+
+  /* Progress notification callback, may be NULL. */
+  svn_fs_progress_notify_func_t notify_func;
+  void *notify_baton;
+};
+
+/* Implements svn_thread_batch__work_func_t.  Run the metadata
+ * consistency checks for the single rev / pack file described by BATON,
+ * a struct verify_task_baton, using TASK_POOL for allocations.  This is
+ * the loop body of verify_f7_metadata_consistency() sans the
+ * cancellation support - cancellation gets polled between batches. */
+static svn_error_t *
+verify_pack_metadata(void *baton,
+                     apr_pool_t *task_pool)
+{
+  struct verify_task_baton *task = baton;
+  svn_revnum_t count = task->pack_end - task->pack_start;
+
+  /* Check for external corruption to the indexes. */
+  SVN_ERR(verify_index_checksums(task->fs, task->pack_start,
+                                 NULL, NULL, task_pool));
+
+  /* two-way index check */
+  SVN_ERR(compare_l2p_to_p2l_index(task->fs, task->pack_start, count,
+                                   NULL, NULL, task_pool));
+  SVN_ERR(compare_p2l_to_l2p_index(task->fs, task->pack_start, count,
+                                   NULL, NULL, task_pool));
+
+  /* verify in-index checksums and types vs. actual rev / pack files */
+  SVN_ERR(compare_p2l_to_rev(task->fs, task->pack_start, count,
+                             NULL, NULL, task_pool));
+
+  /* ensure that revprops are available and accessible */
+  SVN_ERR(verify_revprops(task->fs, task->pack_start, task->pack_end,
+                          NULL, NULL, task_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Open the private filesystem handle of TASK, pointing to the same
+ * repository as FS.  Allocate the handle in TASK_POOL. */
+static svn_error_t *
+open_task_fs(struct verify_task_baton *task,
+             svn_fs_t *fs,
+             apr_pool_t *task_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_hash_t *fs_config;
+
+  /* Give the handle its own cache namespace.  Serving the checks from
+   * data cached by other instances would defeat the point of verifying
+   * the on-disk representation.
+   */
+  fs_config = apr_hash_make(task_pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(task_pool));
+
+  SVN_ERR(ffd->svn_fs_open_(&task->fs, fs->path, fs_config,
+                            task_pool, task_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_batch__init_func_t with CONTEXT being a struct
+ * verify_batch_baton.  Describe the next rev / pack file to verify in
+ * *BATON, giving the task a private filesystem handle such that the
+ * worker never touches state shared with another thread.  Notifications
+ * happen here, i.e. progress is reported in ascending revision order
+ * just like in the serial case. */
+static svn_error_t *
+init_verify_task(void **baton,
+                 void *context,
+                 apr_pool_t *task_pool,
+                 apr_pool_t *scratch_pool)
+{
+  struct verify_batch_baton *bb = context;
+  fs_fs_data_t *ffd = bb->fs->fsap_data;
+  struct verify_task_baton *task;
+
+  if (bb->revision > bb->end)
+    return SVN_NO_ERROR;
+
+  task = apr_pcalloc(task_pool, sizeof(*task));
+  task->count = pack_size(bb->fs, bb->revision);
+  task->pack_start = svn_fs_fs__packed_base_rev(bb->fs, bb->revision);
+  task->pack_end = task->pack_start + task->count;
+  bb->revision = task->pack_end;
+
+  if (bb->notify_func && (task->pack_start % ffd->max_files_per_dir == 0))
+    bb->notify_func(task->pack_start, bb->notify_baton, scratch_pool);
+
+  SVN_ERR(open_task_fs(task, bb->fs, task_pool));
+
+  *baton = task;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_batch__process_func_t with CONTEXT being a
+ * struct verify_batch_baton.  Report the verification failures in TASKS
+ * in revision order. */
+static svn_error_t *
+process_verified_tasks(apr_array_header_t *tasks,
+                       void *context,
+                       apr_pool_t *scratch_pool)
+{
+  struct verify_batch_baton *bb = context;
+  fs_fs_data_t *ffd = bb->fs->fsap_data;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  /* Find the first rev / pack file that failed to verify, if any. */
+  for (i = 0; i < tasks->nelts; ++i)
+    if (APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *)->result)
+      break;
+
+  if (i < tasks->nelts)
+    {
+      svn_thread_batch__task_t *task
+        = APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *);
+      struct verify_task_baton *failed = task->baton;
+      svn_error_t *err2;
+
+      /* Concurrent packing is one of the reasons why verification may
+         fail.  Make sure, we operate on up-to-date information. */
+      err2 = svn_fs_fs__read_min_unpacked_rev(&ffd->min_unpacked_rev,
+                                              bb->fs, scratch_pool);
+
+      if (!err2 && failed->count != pack_size(bb->fs, failed->pack_start))
+        {
+          /* The shard got packed in the meantime.  Re-dispatch it -
+             and everything after it - against the new layout. */
+          bb->revision = svn_fs_fs__packed_base_rev(bb->fs,
+                                                    failed->pack_start);
+
+          for (; i < tasks->nelts; ++i)
+            {
+              task = APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *);
+              svn_error_clear(task->result);
+              task->result = NULL;
+            }
+        }
+      else
+        {
+          /* Report the failures in revision order.  Be careful to
+             not leak ERR2. */
+          for (; i < tasks->nelts; ++i)
+            err = svn_error_compose_create(
+                    err,
+                    APR_ARRAY_IDX(tasks, i,
+                                  svn_thread_batch__task_t *)->result);
+          err = svn_error_compose_create(err, err2);
+        }
+    }
+
+  return err;
+}
+
+/* Parallel implementation of verify_f7_metadata_consistency(), checking
+ * up to FS's verify-threads rev / pack files concurrently.  The function
+ * signature matches verify_f7_metadata_consistency.
+ */
+static svn_error_t *
+verify_f7_metadata_concurrently(svn_fs_t *fs,
+                                svn_revnum_t start,
+                                svn_revnum_t end,
+                                svn_fs_progress_notify_func_t notify_func,
+                                void *notify_baton,
+                                svn_cancel_func_t cancel_func,
+                                void *cancel_baton,
+                                apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  struct verify_batch_baton baton;
+
+  baton.fs = fs;
+  baton.revision = start;
+  baton.end = end;
+  baton.notify_func = notify_func;
+  baton.notify_baton = notify_baton;
+
+  return svn_error_trace(svn_thread_batch__run((apr_size_t)ffd->verify_threads,
+                                               init_verify_task,
+                                               verify_pack_metadata,
+                                               process_verified_tasks,
+                                               &baton,
+                                               cancel_func, cancel_baton,
+                                               pool));
+}
+#endif
+
 /* Verify that on-disk representation has not been tempered with (in a way
  * that leaves the repository in a corrupted state).  This compares log-to-
  * phys with phys-to-log indexes, verifies the low-level checksums and
@@ -813,7 +1041,19 @@ verify_f7_metadata_consistency(svn_fs_t *fs,
 {
   fs_fs_data_t *ffd = fs->fsap_data;
   svn_revnum_t revision, next_revision;
-  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_pool_t *iterpool;
+
+#if APR_HAS_THREADS
+  /* If so configured, verify independent rev / pack files concurrently.
+     This requires a way to open private filesystem handles, which only
+     exists if we got opened through the FS loader. */
+  if (ffd->verify_threads > 1 && ffd->svn_fs_open_ && end > start)
+    return svn_error_trace(verify_f7_metadata_concurrently(
+                             fs, start, end, notify_func, notify_baton,
+                             cancel_func, cancel_baton, pool));
+#endif
+
+  iterpool = svn_pool_create(pool);
 
   for (revision = start; revision <= end; revision = next_revision)
     {
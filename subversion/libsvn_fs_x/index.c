@@ -2855,19 +2855,18 @@ get_p2l_keys(p2l_page_info_baton_t *page_info_p,
   return SVN_NO_ERROR;
 }
 
-/* qsort-compatible compare function that compares the OFFSET of the
- * svn_fs_x__p2l_entry_t in *LHS with the apr_off_t in *RHS. */
-static int
-compare_start_p2l_entry(const void *lhs,
-                        const void *rhs)
-{
-  const svn_fs_x__p2l_entry_t *entry = lhs;
-  apr_off_t start = *(const apr_off_t*)rhs;
-  apr_off_t diff = entry->offset - start;
-
-  /* restrict result to int */
-  return diff < 0 ? -1 : (diff == 0 ? 0 : 1);
-}
+/* Map a svn_fs_x__p2l_entry_t * to its start OFFSET, for use with
+ * SVN_SORT__MAKE_BSEARCH_LOWER_BOUND. */
+#define P2L_ENTRY_OFFSET(entry) ((entry)->offset)
+
+/* Binary search over arrays of svn_fs_x__p2l_entry_t, ordered by their
+ * OFFSET member.  This runs in the innermost loop of every P2L lookup,
+ * so expand the comparison inline instead of paying for the comparator
+ * callback of the generic svn_sort__bsearch_lower_bound(). */
+SVN_SORT__MAKE_BSEARCH_LOWER_BOUND(p2l_entry_lower_bound,
+                                   svn_fs_x__p2l_entry_t,
+                                   apr_off_t,
+                                   P2L_ENTRY_OFFSET)
 
 /* From the PAGE_ENTRIES array of svn_fs_x__p2l_entry_t, ordered
  * by their OFFSET member, copy all elements overlapping the range
@@ -2881,8 +2880,7 @@ append_p2l_entries(apr_array_header_t *entries,
                    svn_boolean_t resolve_ptr)
 {
   const svn_fs_x__p2l_entry_t *entry;
-  int idx = svn_sort__bsearch_lower_bound(page_entries, &block_start,
-                                          compare_start_p2l_entry);
+  int idx = p2l_entry_lower_bound(page_entries, block_start);
 
   /* start at the first entry that overlaps with BLOCK_START */
   if (idx > 0)
@@ -3152,19 +3150,6 @@ svn_fs_x__p2l_index_lookup(apr_array_header_t **entries,
   return SVN_NO_ERROR;
 }
 
-/* compare_fn_t comparing a svn_fs_x__p2l_entry_t at LHS with an offset
- * RHS.
- */
-static int
-compare_p2l_entry_offsets(const void *lhs,
-                          const void *rhs)
-{
-  const svn_fs_x__p2l_entry_t *entry = (const svn_fs_x__p2l_entry_t *)lhs;
-  apr_off_t offset = *(const apr_off_t *)rhs;
-
-  return entry->offset < offset ? -1 : (entry->offset == offset ? 0 : 1);
-}
-
 /* Cached data extraction utility.  DATA is a P2L index page, e.g. an APR
  * array of svn_fs_x__p2l_entry_t elements.  Return the entry for the item,
  * allocated in RESULT_POOL, starting at OFFSET or NULL if that's not an
@@ -3180,14 +3165,20 @@ get_p2l_entry_from_cached_page(const void *data,
   const apr_array_header_t *page = data;
   apr_array_header_t *entries = apr_pmemdup(scratch_pool, page,
                                             sizeof(*page));
-  svn_fs_x__p2l_entry_t *entry;
+  svn_fs_x__p2l_entry_t *entry = NULL;
+  int idx;
 
   entries->elts = (char *)svn_temp_deserializer__ptr(page,
                                      (const void *const *)&page->elts);
 
   /* search of the offset we want */
-  entry = svn_sort__array_lookup(entries, &offset, NULL,
-      (int (*)(const void *, const void *))compare_p2l_entry_offsets);
+  idx = p2l_entry_lower_bound(entries, offset);
+  if (idx < entries->nelts)
+    {
+      entry = &APR_ARRAY_IDX(entries, idx, svn_fs_x__p2l_entry_t);
+      if (entry->offset != offset)
+        entry = NULL;
+    }
 
   /* return it, if it is a perfect match */
   if (entry)
@@ -3252,12 +3243,20 @@ p2l_entry_lookup(svn_fs_x__p2l_entry_t **entry_p,
        * data to speed up future lookups. */
       apr_array_header_t *entries = apr_array_make(result_pool, 1,
                                                    sizeof(**entry_p));
+      int idx;
       SVN_ERR(p2l_index_lookup(entries, rev_file, fs, revision, offset,
                                offset + 1, scratch_pool));
 
       /* Find the entry that we want. */
-      *entry_p = svn_sort__array_lookup(entries, &offset, NULL,
-          (int (*)(const void *, const void *))compare_p2l_entry_offsets);
+      *entry_p = NULL;
+      idx = p2l_entry_lower_bound(entries, offset);
+      if (idx < entries->nelts)
+        {
+          svn_fs_x__p2l_entry_t *entry
+            = &APR_ARRAY_IDX(entries, idx, svn_fs_x__p2l_entry_t);
+          if (entry->offset == offset)
+            *entry_p = entry;
+        }
     }
 
   return SVN_NO_ERROR;
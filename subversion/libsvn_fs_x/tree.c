@@ -3198,6 +3198,7 @@ x_get_mergeinfo(svn_fs_root_t *root,
 static root_vtable_t root_vtable = {
   NULL,
   x_report_changes,
+  NULL,
   svn_fs_x__check_path,
   x_node_history,
   x_node_id,
@@ -3213,6 +3214,7 @@ static root_vtable_t root_vtable = {
   x_node_prop,
   x_node_proplist,
   x_node_has_props,
+  NULL,
   x_change_node_prop,
   x_props_changed,
   x_dir_entries,
@@ -3229,6 +3231,7 @@ static root_vtable_t root_vtable = {
   x_get_file_delta_stream,
   x_merge,
   x_get_mergeinfo,
+  NULL                                    /* dir_entries_full */
 };
 
 /* Construct a new root object in FS, allocated from RESULT_POOL.  */
@@ -838,6 +838,46 @@ svn_error_t *svn_ra_check_path(svn_ra_session_t *session,
   return session->vtable->check_path(session, path, revision, kind, pool);
 }
 
+svn_error_t *svn_ra__check_paths(apr_array_header_t **kinds,
+                                 svn_ra_session_t *session,
+                                 const apr_array_header_t *path_revs,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < path_revs->nelts; i++)
+    {
+      const svn_ra__path_rev_t *pair
+        = APR_ARRAY_IDX(path_revs, i, const svn_ra__path_rev_t *);
+
+      SVN_ERR_ASSERT(svn_relpath_is_canonical(pair->path));
+    }
+
+  if (session->vtable->check_paths)
+    return svn_error_trace(session->vtable->check_paths(kinds, session,
+                                                        path_revs,
+                                                        result_pool,
+                                                        scratch_pool));
+
+  /* Fall back to one probe per element. */
+  *kinds = apr_array_make(result_pool, path_revs->nelts,
+                          sizeof(svn_node_kind_t));
+  for (i = 0; i < path_revs->nelts; i++)
+    {
+      const svn_ra__path_rev_t *pair
+        = APR_ARRAY_IDX(path_revs, i, const svn_ra__path_rev_t *);
+      svn_node_kind_t kind;
+
+      SVN_ERR(session->vtable->check_path(session, pair->path,
+                                          pair->revision, &kind,
+                                          scratch_pool));
+      APR_ARRAY_PUSH(*kinds, svn_node_kind_t) = kind;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *svn_ra_stat(svn_ra_session_t *session,
                          const char *path,
                          svn_revnum_t revision,
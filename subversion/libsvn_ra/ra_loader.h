@@ -380,6 +380,14 @@ typedef struct svn_ra__vtable_t {
     void *replay_baton,
     apr_pool_t *scratch_pool);
 
+  /* See svn_ra__check_paths().  May be NULL, in which case the loader
+     falls back to calling check_path once per element. */
+  svn_error_t *(*check_paths)(apr_array_header_t **kinds,
+                              svn_ra_session_t *session,
+                              const apr_array_header_t *path_revs,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
 } svn_ra__vtable_t;
 
 /* The RA session object. */
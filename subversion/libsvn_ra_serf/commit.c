@@ -38,6 +38,7 @@
 
 #include "svn_private_config.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_subr_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_skel.h"
 
@@ -1880,9 +1881,18 @@ negotiate_put_encoding(int *svndiff_version_p,
        * bandwidth), as it is faster and in this case, we don't care about
        * worse compression ratio.
        *
+       * Svndiff3 is preferred over both whenever the server accepts it:
+       * it compresses significantly better than svndiff2 at almost the
+       * same speed.
+       *
        * Note: For future compatibility, we also handle a theoretically
        * possible case where the server has advertised only svndiff2 support.
        */
+#ifdef SVN_HAVE_ZSTD
+      if (session->supports_svndiff3)
+        svndiff_version = 3;
+      else
+#endif
       if (session->supports_svndiff2 &&
           svn_ra_serf__is_low_latency_connection(session))
         svndiff_version = 2;
@@ -1900,9 +1910,18 @@ negotiate_put_encoding(int *svndiff_version_p,
        * better speed and compression ratio comparable to svndiff1 with
        * compression level 1, but not 5).
        *
+       * Svndiff3, however, is a reasonable substitute: its compression
+       * ratio is comparable to svndiff1's at a fraction of the CPU cost,
+       * so prefer it whenever the server accepts it.
+       *
        * Note: For future compatibility, we also handle a theoretically
        * possible case where the server has advertised only svndiff2 support.
        */
+#ifdef SVN_HAVE_ZSTD
+      if (session->supports_svndiff3)
+        svndiff_version = 3;
+      else
+#endif
       if (session->supports_svndiff1)
         svndiff_version = 1;
       else if (session->supports_svndiff2)
@@ -1927,6 +1946,8 @@ negotiate_put_encoding(int *svndiff_version_p,
 
   if (svndiff_version == 0)
     compression_level = SVN_DELTA_COMPRESSION_LEVEL_NONE;
+  else if (svndiff_version == 3)
+    compression_level = SVN__COMPRESSION_ZSTD_DEFAULT;
   else
     compression_level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
 
@@ -71,6 +71,19 @@ typedef struct stream_ctx_t {
   /* This is the amount of data that we have read so far. */
   apr_off_t read_size;
 
+  /* TRUE if the current response is not content-encoded.  Only then do
+     byte ranges address the same stream that we count, so only then can
+     we resume with a Range request. */
+  svn_boolean_t identity_encoded;
+
+  /* Offset of the first byte of the current response within the file;
+     non-zero only for a 206 response to a resumed request. */
+  apr_off_t response_offset;
+
+  /* While ABORTED_READ is set: the offset we asked the server to resume
+     at with a Range header, or 0 if we fell back to a full re-fetch. */
+  apr_off_t resume_offset;
+
   /* If we're writing this file to a stream, this will be non-NULL. */
   svn_stream_t *result_stream;
 
@@ -88,7 +101,19 @@ headers_fetch(serf_bucket_t *headers,
 {
   stream_ctx_t *fetch_ctx = baton;
 
-  if (fetch_ctx->session->using_compression != svn_tristate_false)
+  if (fetch_ctx->aborted_read && fetch_ctx->resume_offset > 0)
+    {
+      /* We got cut off in the middle of a previous response and the data
+         was not content-encoded, so we can ask the server to resume at
+         the point of the interruption instead of re-sending everything.
+         A Range addresses the raw entity, so don't offer gzip here; the
+         offsets must match the bytes we already delivered. */
+      serf_bucket_headers_setn(headers, "Range",
+                               apr_psprintf(pool,
+                                            "bytes=%" APR_OFF_T_FMT "-",
+                                            fetch_ctx->resume_offset));
+    }
+  else if (fetch_ctx->session->using_compression != svn_tristate_false)
     {
       serf_bucket_headers_setn(headers, "Accept-Encoding", "gzip");
     }
@@ -120,9 +145,23 @@ cancel_fetch(serf_request_t *request,
           if (!fetch_ctx->aborted_read && fetch_ctx->read_size)
             {
               fetch_ctx->aborted_read = TRUE;
-              fetch_ctx->aborted_read_size = fetch_ctx->read_size;
+              fetch_ctx->aborted_read_size
+                = fetch_ctx->response_offset + fetch_ctx->read_size;
             }
+
+          /* If the interrupted response was served without content
+             encoding, the next attempt can resume with a Range request;
+             otherwise we must re-fetch from the start and skip.  The
+             bytes delivered so far stay in the caller's stream either
+             way, so resuming continues exactly at that boundary. */
+          if (fetch_ctx->aborted_read && fetch_ctx->identity_encoded)
+            fetch_ctx->resume_offset = fetch_ctx->aborted_read_size;
+          else
+            fetch_ctx->resume_offset = 0;
+
           fetch_ctx->read_size = 0;
+          fetch_ctx->response_offset = 0;
+          fetch_ctx->read_headers = FALSE;
         }
 
       return SVN_NO_ERROR;
@@ -200,9 +239,52 @@ handle_stream(serf_request_t *request,
   stream_ctx_t *fetch_ctx = handler_baton;
   apr_status_t status;
 
-  if (fetch_ctx->handler->sline.code != 200)
+  if (fetch_ctx->handler->sline.code != 200
+      && !(fetch_ctx->handler->sline.code == 206 && fetch_ctx->aborted_read))
     return svn_error_trace(svn_ra_serf__unexpected_status(fetch_ctx->handler));
 
+  if (!fetch_ctx->read_headers)
+    {
+      serf_bucket_t *hdrs = serf_bucket_response_get_headers(response);
+      const char *val;
+
+      if (fetch_ctx->handler->sline.code == 206)
+        {
+          /* We asked the server to resume where we got cut off.  Make
+             sure it did exactly that; anything else and we can't trust
+             our offsets. */
+          apr_int64_t start = -1;
+
+          val = serf_bucket_headers_get(hdrs, "Content-Range");
+          if (val && strncmp(val, "bytes ", 6) == 0)
+            {
+              char *end;
+              start = apr_strtoi64(val + 6, &end, 10);
+              if (*end != '-')
+                start = -1;
+            }
+
+          if (start != fetch_ctx->aborted_read_size)
+            return svn_error_createf(SVN_ERR_RA_DAV_MALFORMED_DATA, NULL,
+                                     _("GET request returned unexpected "
+                                       "Content-Range '%s'"),
+                                     val ? val : "");
+
+          /* The response continues exactly at the point of the
+             interruption; deliver its data without any skipping. */
+          fetch_ctx->response_offset = fetch_ctx->aborted_read_size;
+          fetch_ctx->aborted_read = FALSE;
+        }
+
+      /* Ranges address the raw entity, so we can only resume responses
+         that are not content-encoded. */
+      val = serf_bucket_headers_get(hdrs, "Content-Encoding");
+      fetch_ctx->identity_encoded = (val == NULL
+                                     || strcmp(val, "identity") == 0);
+
+      fetch_ctx->read_headers = TRUE;
+    }
+
   while (1)
     {
       const char *data;
@@ -419,7 +501,7 @@ svn_ra_serf__get_file(svn_ra_session_t *ra_session,
 
           SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
 
-          if (handler->sline.code != 200)
+          if (handler->sline.code != 200 && handler->sline.code != 206)
             return svn_error_trace(svn_ra_serf__unexpected_status(handler));
         }
     }
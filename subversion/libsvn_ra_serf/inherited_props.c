@@ -244,12 +244,13 @@ get_iprops_via_more_requests(svn_ra_session_t *ra_session,
   const char *url;
   const char *relpath;
   apr_array_header_t *rq_info;
-  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-  apr_interval_time_t waittime_left = session->timeout;
+  apr_array_header_t *handlers;
   const svn_revnum_t rev_marker = SVN_INVALID_REVNUM;
   int i;
 
   rq_info = apr_array_make(scratch_pool, 16, sizeof(iprop_rq_info_t *));
+  handlers = apr_array_make(scratch_pool, 16,
+                            sizeof(svn_ra_serf__handler_t *));
 
   if (!svn_path_is_empty(path))
     url = svn_path_url_add_component2(session_url, path, scratch_pool);
@@ -286,28 +287,12 @@ get_iprops_via_more_requests(svn_ra_session_t *ra_session,
       /* Allow ignoring authz problems */
       rq->handler->no_fail_on_http_failure_status = TRUE;
 
-      svn_ra_serf__request_create(rq->handler);
-
       APR_ARRAY_PUSH(rq_info, iprop_rq_info_t *) = rq;
+      APR_ARRAY_PUSH(handlers, svn_ra_serf__handler_t *) = rq->handler;
     }
 
-  while (TRUE)
-    {
-      svn_pool_clear(iterpool);
-
-      SVN_ERR(svn_ra_serf__context_run(session, &waittime_left, iterpool));
-
-      for (i = 0; i < rq_info->nelts; i++)
-        {
-          iprop_rq_info_t *rq = APR_ARRAY_IDX(rq_info, i, iprop_rq_info_t *);
-
-          if (!rq->handler->done)
-            break;
-        }
-
-      if (i >= rq_info->nelts)
-        break; /* All requests done */
-    }
+  /* Run the whole batch pipelined on the connection.  */
+  SVN_ERR(svn_ra_serf__context_run_many(handlers, session, scratch_pool));
 
   *iprops = apr_array_make(result_pool, rq_info->nelts,
                            sizeof(svn_prop_inherited_item_t *));
@@ -269,6 +269,9 @@ struct svn_ra_serf__session_t {
   /* Indicates whether the server can understand svndiff version 2. */
   svn_boolean_t supports_svndiff2;
 
+  /* Indicates whether the server can understand svndiff version 3. */
+  svn_boolean_t supports_svndiff3;
+
   /* Indicates whether the server sends the result checksum in the response
    * to a successful PUT request. */
   svn_boolean_t supports_put_result_checksum;
@@ -547,6 +550,22 @@ svn_error_t *
 svn_ra_serf__context_run_one(svn_ra_serf__handler_t *handler,
                              apr_pool_t *scratch_pool);
 
+/* Run a whole batch of requests and process the responses.
+
+   Like svn_ra_serf__context_run_one(), but creates the requests for all
+   the svn_ra_serf__handler_t * elements of HANDLERS up front and waits
+   until every one of them has completed.  Scheduling the batch before
+   waiting lets serf pipeline the requests on the connection, so N small
+   requests cost roughly one network round trip instead of N.
+
+   Status codes and server errors are left in the handlers for the
+   caller to examine; like context_run_one(), this only returns an
+   error for connection-level failures.  */
+svn_error_t *
+svn_ra_serf__context_run_many(apr_array_header_t *handlers,
+                              svn_ra_serf__session_t *sess,
+                              apr_pool_t *scratch_pool);
+
 
 /*
  * Helper function to queue a request in the @a handler's connection.
@@ -50,7 +50,13 @@ svn_ra_serf__copy_into_spillbuf(svn_spillbuf_t **spillbuf,
                                 apr_pool_t *result_pool,
                                 apr_pool_t *scratch_pool)
 {
-  *spillbuf = svn_spillbuf__create(SB_BLOCKSIZE, SB_MAXSIZE, result_pool);
+  /* Use mmap readback (where available) so that spilled response data
+     is not copied into private blocks again when it gets consumed.  */
+  *spillbuf = svn_spillbuf__create_extended(SB_BLOCKSIZE, SB_MAXSIZE,
+                                            TRUE /* delete_on_close */,
+                                            FALSE /* spill_all_contents */,
+                                            TRUE /* mmap_readback */,
+                                            NULL, result_pool);
 
   /* Copy all data from the bucket into the spillbuf.  */
   while (TRUE)
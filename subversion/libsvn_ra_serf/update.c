@@ -255,6 +255,13 @@ static const svn_ra_serf__xml_transition_t update_ttable[] = {
 #define REQUEST_COUNT_TO_PAUSE 50
 #define REQUEST_COUNT_TO_RESUME 40
 
+/* The equivalent low-water mark for a session that negotiated HTTP/2.
+   A multiplexed connection keeps hundreds of concurrent streams in
+   flight without per-request connection setup or per-connection
+   response ordering constraints, so it pays to queue considerably more
+   requests before throttling the REPORT parser.  */
+#define REQUEST_COUNT_TO_RESUME_HTTP2 160
+
 #define SPILLBUF_BLOCKSIZE 4096
 #define SPILLBUF_MAXBUFFSIZE 131072
 
@@ -555,6 +562,14 @@ create_file_baton(file_baton_t **new_file,
 static svn_error_t *
 open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs)
 {
+  /* An HTTP/2 connection multiplexes all auxiliary requests as separate
+   * streams, so once the first extra connection exists there is nothing
+   * to gain from opening further ones - they would only add TCP and TLS
+   * handshakes.  Scaling out over multiple connections is an HTTP/1.1
+   * workaround. */
+  if (sess->http20 && sess->num_conns > 1)
+    return SVN_NO_ERROR;
+
   /* For each REQS_PER_CONN outstanding requests open a new connection, with
    * a minimum of 1 extra connection. */
   if (sess->num_conns == 1 ||
@@ -2223,6 +2238,15 @@ process_buffer(update_delay_baton_t *udb,
 }
 
 
+/* Return the number of queued auxiliary requests below which we resume
+   parsing the REPORT response and creating more requests. */
+static int
+request_count_to_resume(report_context_t *ctx)
+{
+  return ctx->sess->http20 ? REQUEST_COUNT_TO_RESUME_HTTP2
+                           : REQUEST_COUNT_TO_RESUME;
+}
+
 /* Delaying wrapping response handler, to avoid creating too many
    requests to deliver efficiently */
 static svn_error_t *
@@ -2251,7 +2275,7 @@ update_delay_handler(serf_request_t *request,
         }
 
       while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-                 < REQUEST_COUNT_TO_RESUME)
+                 < request_count_to_resume(udb->report))
         {
           const char *data;
           apr_size_t len;
@@ -2294,10 +2318,16 @@ update_delay_handler(serf_request_t *request,
             }
         }
 
-      /* Let's start using the spill infrastructure */
-      udb->spillbuf = svn_spillbuf__create(SPILLBUF_BLOCKSIZE,
-                                           SPILLBUF_MAXBUFFSIZE,
-                                           udb->report->pool);
+      /* Let's start using the spill infrastructure.  Read the spilled
+         data back through an mmap window (where available) instead of
+         copying it into memory blocks again.  */
+      udb->spillbuf = svn_spillbuf__create_extended(SPILLBUF_BLOCKSIZE,
+                                                    SPILLBUF_MAXBUFFSIZE,
+                                                    TRUE /* delete_on_close */,
+                                                    FALSE /* spill_all */,
+                                                    TRUE /* mmap_readback */,
+                                                    NULL,
+                                                    udb->report->pool);
     }
 
   /* Read everything we can to a spillbuffer */
@@ -2335,7 +2365,7 @@ process_pending(update_delay_baton_t *udb,
   serf_bucket_alloc_t *alloc = NULL;
 
   while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-            < REQUEST_COUNT_TO_RESUME)
+            < request_count_to_resume(udb->report))
     {
       const char *data;
       apr_size_t len;
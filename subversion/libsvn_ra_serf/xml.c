@@ -65,9 +65,16 @@ struct svn_ra_serf__xml_context_t {
   svn_ra_serf__xml_cdata_t cdata_cb;
   void *baton;
 
-  /* Linked list of free states.  */
+  /* Linked list of closed states available for reuse.  Only states
+     allocated from POOL (see ESTATE->RECYCLABLE) end up here.  */
   svn_ra_serf__xml_estate_t *free_states;
 
+  /* Has the document element been opened (and a transition matched)?  */
+  svn_boolean_t seen_doc_element;
+
+  /* The pool the context and all recyclable states are allocated in.  */
+  apr_pool_t *pool;
+
 #ifdef SVN_DEBUG
   /* Used to verify we are not re-entering a callback, specifically to
      ensure SCRATCH_POOL is not cleared while an outer callback is
@@ -125,6 +132,17 @@ struct svn_ra_serf__xml_estate_t {
   /* Any collected cdata. May be NULL if no cdata is being collected.  */
   svn_stringbuf_t *cdata;
 
+  /* TRUE iff this structure was allocated from the context's pool and
+     goes back onto the context's FREE_STATES list once closed.  States
+     that collect data are instead allocated within their STATE_POOL and
+     die with it.  */
+  svn_boolean_t recyclable;
+
+  /* For recyclable states: reusable storage for tag names that matched
+     a wildcard transition and thus cannot point into the transition
+     table.  Survives recycling.  */
+  svn_stringbuf_t *name_buf;
+
   /* Previous/outer state.  */
   svn_ra_serf__xml_estate_t *prev;
 
@@ -483,10 +501,10 @@ svn_ra_serf__xml_context_done(svn_ra_serf__xml_context_t *xmlctx)
                                _("XML stream truncated: closing '%s' missing"),
                                xmlctx->current->tag.name);
     }
-  else if (! xmlctx->free_states)
+  else if (! xmlctx->seen_doc_element)
     {
-      /* If we have no items on the free_states list, we didn't push anything,
-         which tells us that we found an empty xml body */
+      /* No transition ever matched, which tells us that we found an
+         empty xml body */
       const svn_ra_serf__xml_transition_t *scan;
       const svn_ra_serf__xml_transition_t *document = NULL;
       const char *msg;
@@ -538,6 +556,7 @@ svn_ra_serf__xml_context_create(
   xmlctx->cdata_cb = cdata_cb;
   xmlctx->baton = baton;
   xmlctx->scratch_pool = svn_pool_create(result_pool);
+  xmlctx->pool = result_pool;
 
   xes = apr_pcalloc(result_pool, sizeof(*xes));
   /* XES->STATE == 0  */
@@ -689,15 +708,13 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
   SVN_ERR_ASSERT(!scan->collect_cdata || scan->custom_close);
 
   /* Found a transition. Make it happen.  */
+  xmlctx->seen_doc_element = TRUE;
 
-  /* ### todo. push state  */
-
-  /* ### how to use free states?  */
-  /* This state should be allocated in the extent pool. If we will be
-     collecting information for this state, then construct a subpool.
-
-     ### potentially optimize away the subpool if none of the
-     ### attributes are present. subpools are cheap, tho...  */
+  /* If we will be collecting information for this state, then construct
+     a subpool and allocate the state within it.  Otherwise, recycle a
+     previously closed state (or create one in the context pool for
+     later recycling), so that deep or repetitive documents do not
+     allocate per element.  */
   new_pool = xes_pool(current);
   if (scan->collect_cdata || scan->collect_attrs[0])
     {
@@ -746,17 +763,52 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
             }
         }
     }
+  else if (xmlctx->free_states)
+    {
+      /* Reuse a previously closed state.  */
+      new_xes = xmlctx->free_states;
+      xmlctx->free_states = new_xes->prev;
+
+      new_xes->state_pool = NULL;
+      new_xes->attrs = NULL;
+      new_xes->cdata = NULL;
+      /* NAME_BUF survives recycling.  */
+    }
   else
     {
       /* Prep the new state.  */
-      new_xes = apr_pcalloc(new_pool, sizeof(*new_xes));
+      new_xes = apr_pcalloc(xmlctx->pool, sizeof(*new_xes));
+      new_xes->recyclable = TRUE;
       /* STATE_POOL remains NULL.  */
     }
 
   /* Some basic copies to set up the new estate.  */
   new_xes->state = scan->to_state;
-  new_xes->tag.name = apr_pstrdup(new_pool, elemname.name);
-  new_xes->tag.xmlns = apr_pstrdup(new_pool, elemname.xmlns);
+  if (*scan->name != '*')
+    {
+      /* We just matched the transition table's strings, so the tag can
+         simply point at those.  */
+      new_xes->tag.name = scan->name;
+      new_xes->tag.xmlns = scan->ns;
+    }
+  else if (new_xes->recyclable)
+    {
+      /* ELEMNAME.NAME may point into expat's transient buffer, so copy
+         it into this state's reusable buffer.  The namespace URL lives
+         in an ancestor's state pool and thus outlives this state.  */
+      if (new_xes->name_buf == NULL)
+        new_xes->name_buf = svn_stringbuf_create(elemname.name,
+                                                 xmlctx->pool);
+      else
+        svn_stringbuf_set(new_xes->name_buf, elemname.name);
+      new_xes->tag.name = new_xes->name_buf->data;
+      new_xes->tag.xmlns = elemname.xmlns;
+    }
+  else
+    {
+      new_xes->tag.name = apr_pstrdup(new_pool, elemname.name);
+      new_xes->tag.xmlns = apr_pstrdup(new_pool, elemname.xmlns);
+    }
   new_xes->custom_close = scan->custom_close;
 
   /* Start with the parent's namespace set.  */
@@ -820,15 +872,19 @@ xml_cb_end(svn_ra_serf__xml_context_t *xmlctx,
   /* Pop the state.  */
   xmlctx->current = xes->prev;
 
-  /* ### not everything should go on the free state list. XES may go
-     ### away with the state pool.  */
-  xes->prev = xmlctx->free_states;
-  xmlctx->free_states = xes;
-
   /* If there is a STATE_POOL, then toss it. This will get rid of as much
-     memory as possible. Potentially the XES (if we didn't create a pool
-     right away, then XES may be in a parent pool).  */
-  if (xes->state_pool)
+     memory as possible, including XES itself for states that collect
+     data.  Recyclable states live in the context pool instead and go
+     back onto the free list for the next element.  */
+  if (xes->recyclable)
+    {
+      if (xes->state_pool)
+        svn_pool_destroy(xes->state_pool);
+
+      xes->prev = xmlctx->free_states;
+      xmlctx->free_states = xes;
+    }
+  else if (xes->state_pool)
     svn_pool_destroy(xes->state_pool);
 
   return SVN_NO_ERROR;
@@ -50,7 +50,9 @@
 
 #include "svn_private_config.h"
 
+#include "private/svn_atomic.h"
 #include "private/svn_fspath.h"
+#include "private/svn_mutex.h"
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 
@@ -113,12 +115,70 @@ static void parse_tunnel(const char *url, const char **tunnel,
     }
 }
 
+/* The time the first pass over the address list may spend per address
+   before racing on to the next candidate.  A second pass retries with
+   the default blocking timeout, so this only bounds how long a dead
+   address family may delay the remaining ones. */
+#define CONNECT_RACE_TIMEOUT apr_time_from_msec(300)
+
+/* Cache of DNS lookup results, shared by all ra_svn sessions of this
+   process.  Maps "HOSTNAME:PORT:FAMILY" to the apr_sockaddr_t * chain
+   returned by apr_sockaddr_info_get().  An update touching dozens of
+   externals on the same host would otherwise resolve that host over
+   and over again.  Entries live as long as the process; that matches
+   the duration of the command line operations we optimize for. */
+static svn_mutex__t *dns_cache_mutex = NULL;
+static apr_pool_t *dns_cache_pool = NULL;
+static apr_hash_t *dns_cache = NULL;
+
+static volatile svn_atomic_t dns_cache_init_state = 0;
+
+/* Implements svn_atomic__err_init_func_t, setting up the DNS cache
+   globals above. */
+static svn_error_t *
+initialize_dns_cache(void *baton, apr_pool_t *scratch_pool)
+{
+  dns_cache_pool = svn_pool_create(NULL);
+  SVN_ERR(svn_mutex__init(&dns_cache_mutex, TRUE, dns_cache_pool));
+  dns_cache = apr_hash_make(dns_cache_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *SA to the resolution result for HOSTNAME, FAMILY and PORT, either
+   taken from the DNS cache under KEY or - on the first query - resolved
+   and added to the cache.  Call this with DNS_CACHE_MUTEX held; lookups
+   of previously unseen hosts will block other sessions for the duration
+   of the resolution. */
+static svn_error_t *
+dns_cache_get(apr_sockaddr_t **sa, const char *key, const char *hostname,
+              int family, unsigned short port)
+{
+  *sa = svn_hash_gets(dns_cache, key);
+  if (*sa == NULL)
+    {
+      apr_status_t status = apr_sockaddr_info_get(sa, hostname, family,
+                                                  port, 0, dns_cache_pool);
+      if (status)
+        return svn_error_createf(status, NULL, _("Unknown hostname '%s'"),
+                                 hostname);
+
+      svn_hash_sets(dns_cache, apr_pstrdup(dns_cache_pool, key), *sa);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *make_connection(const char *hostname, unsigned short port,
                                     apr_socket_t **sock, apr_pool_t *pool)
 {
+  apr_sockaddr_t *sa_list;
   apr_sockaddr_t *sa;
   apr_status_t status;
   int family = APR_INET;
+  svn_boolean_t connected = FALSE;
+  const char *key;
+  int pass;
 
   /* Make sure we have IPV6 support first before giving apr_sockaddr_info_get
      APR_UNSPEC, because it may give us back an IPV6 address even if we can't
@@ -138,34 +198,51 @@ static svn_error_t *make_connection(const char *hostname, unsigned short port,
     }
 #endif
 
-  /* Resolve the hostname. */
-  status = apr_sockaddr_info_get(&sa, hostname, family, port, 0, pool);
-  if (status)
-    return svn_error_createf(status, NULL, _("Unknown hostname '%s'"),
-                             hostname);
+  /* Resolve the hostname, consulting the process-wide cache first. */
+  SVN_ERR(svn_atomic__init_once(&dns_cache_init_state, initialize_dns_cache,
+                                NULL, pool));
+  key = apr_psprintf(pool, "%s:%u:%d", hostname, (unsigned int)port, family);
+  SVN_MUTEX__WITH_LOCK(dns_cache_mutex,
+                       dns_cache_get(&sa_list, key, hostname, family, port));
+
   /* Iterate through the returned list of addresses attempting to
-   * connect to each in turn. */
-  do
-    {
-      /* Create the socket. */
+   * connect to each in turn.  The first pass gives every address - and
+   * thereby every address family - only a short time to answer before
+   * racing on to the next candidate; if none answered that quickly, a
+   * second pass retries them with the default blocking timeout.  This
+   * keeps a broken IPv6 (or IPv4) path from stalling the connection
+   * attempt for a full TCP timeout per address. */
+  status = APR_SUCCESS;
+  for (pass = 0; pass < 2 && !connected; ++pass)
+    for (sa = sa_list; sa && !connected; sa = sa->next)
+      {
+        /* Create the socket. */
 #ifdef MAX_SECS_TO_LINGER
-      /* ### old APR interface */
-      status = apr_socket_create(sock, sa->family, SOCK_STREAM, pool);
+        /* ### old APR interface */
+        status = apr_socket_create(sock, sa->family, SOCK_STREAM, pool);
 #else
-      status = apr_socket_create(sock, sa->family, SOCK_STREAM, APR_PROTO_TCP,
-                                 pool);
+        status = apr_socket_create(sock, sa->family, SOCK_STREAM,
+                                   APR_PROTO_TCP, pool);
 #endif
-      if (status == APR_SUCCESS)
-        {
-          status = apr_socket_connect(*sock, sa);
-          if (status != APR_SUCCESS)
-            apr_socket_close(*sock);
-        }
-      sa = sa->next;
-    }
-  while (status != APR_SUCCESS && sa);
+        if (status != APR_SUCCESS)
+          continue;
+
+        if (pass == 0)
+          apr_socket_timeout_set(*sock, CONNECT_RACE_TIMEOUT);
+
+        status = apr_socket_connect(*sock, sa);
+        if (status == APR_SUCCESS)
+          {
+            /* Restore the default blocking behavior. */
+            if (pass == 0)
+              apr_socket_timeout_set(*sock, -1);
+            connected = TRUE;
+          }
+        else
+          apr_socket_close(*sock);
+      }
 
-  if (status)
+  if (!connected)
     return svn_error_wrap_apr(status, _("Can't connect to host '%s'"),
                               hostname);
 
@@ -549,7 +626,8 @@ static svn_error_t *make_tunnel(const char **args, svn_ra_svn_conn_t **conn,
                                   svn_stream_from_aprfile2(proc->in, FALSE,
                                                            pool),
                                   SVN_DELTA_COMPRESSION_LEVEL_DEFAULT,
-                                  0, 0, 0, 0, pool);
+                                  0, SVN_RA_SVN__ERROR_CHECK_INTERVAL,
+                                  0, 0, pool);
   err = svn_ra_svn__skip_leading_garbage(*conn, pool);
   if (err)
     return svn_error_quick_wrap(
@@ -629,6 +707,7 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
   apr_uint64_t minver, maxver;
   svn_ra_svn__list_t *mechlist, *server_caplist, *repos_caplist;
   const char *client_string = NULL;
+  svn_boolean_t want_frame_compression;
   apr_pool_t *pool = result_pool;
   svn_ra_svn__parent_t *parent;
 
@@ -683,7 +762,8 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
 
           conn = svn_ra_svn_create_conn5(NULL, td->response, td->request,
                                          SVN_DELTA_COMPRESSION_LEVEL_DEFAULT,
-                                         0, 0, 0, 0, pool);
+                                         0, SVN_RA_SVN__ERROR_CHECK_INTERVAL,
+                                         0, 0, pool);
           SVN_ERR(svn_ra_svn__skip_leading_garbage(conn, pool));
         }
     }
@@ -697,7 +777,8 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
                               &sock, pool));
       conn = svn_ra_svn_create_conn5(sock, NULL, NULL,
                                      SVN_DELTA_COMPRESSION_LEVEL_DEFAULT,
-                                     0, 0, 0, 0, pool);
+                                     0, SVN_RA_SVN__ERROR_CHECK_INTERVAL,
+                                     0, 0, pool);
     }
 
   /* Build the useragent string, querying the client for any
@@ -743,11 +824,34 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
     return svn_error_create(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
                             _("Server does not support edit pipelining"));
 
+  /* Offer transport frame compression only where it is likely to help:
+   * tunneled connections usually get compression from the tunnel agent
+   * (e.g. ssh) and double compression just burns CPU. */
+  want_frame_compression = !sess->is_tunneled && conn->compression_level > 0;
+
   /* In protocol version 2, we send back our protocol version, our
    * capability list, and the URL, and subsequently there is an auth
    * request. */
-  /* Client-side capabilities list: */
-  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww)cc(?c)",
+  /* Client-side capabilities list.  Only advertise acceptance of the
+   * zstd-based svndiff3 format if we can actually decode it. */
+#ifdef SVN_HAVE_ZSTD
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwwwww!",
+                                  (apr_uint64_t) 2,
+                                  SVN_RA_SVN_CAP_EDIT_PIPELINE,
+                                  SVN_RA_SVN_CAP_SVNDIFF1,
+                                  SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+                                  SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED,
+                                  SVN_RA_SVN_CAP_ABSENT_ENTRIES,
+                                  SVN_RA_SVN_CAP_DEPTH,
+                                  SVN_RA_SVN_CAP_MERGEINFO,
+                                  SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                  SVN_RA_SVN_CAP_PUT_FILE));
+  if (want_frame_compression)
+    SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!ww!",
+                                    SVN_RA_SVN_CAP_FRAME_COMPRESSION_LZ4,
+                                    SVN_RA_SVN_CAP_FRAME_COMPRESSION_ZSTD));
+#else
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwwww!",
                                   (apr_uint64_t) 2,
                                   SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                   SVN_RA_SVN_CAP_SVNDIFF1,
@@ -756,9 +860,31 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
                                   SVN_RA_SVN_CAP_DEPTH,
                                   SVN_RA_SVN_CAP_MERGEINFO,
                                   SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                  SVN_RA_SVN_CAP_PUT_FILE));
+  if (want_frame_compression)
+    SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!w!",
+                                    SVN_RA_SVN_CAP_FRAME_COMPRESSION_LZ4));
+#endif
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)cc(?c)",
                                   url,
                                   SVN_RA_SVN__DEFAULT_USERAGENT,
                                   client_string));
+
+  /* If we offered frame compression and the server advertised it too,
+   * switch the transport to compressed frames.  The server switches
+   * right after reading our response, so the response itself must leave
+   * the connection uncompressed. */
+  if (want_frame_compression)
+    {
+      int method = svn_ra_svn__preferred_frame_compression(conn);
+
+      if (method != SVN_RA_SVN__FRAME_COMPRESSION_NONE)
+        {
+          SVN_ERR(svn_ra_svn__flush(conn, pool));
+          SVN_ERR(svn_ra_svn__enable_frame_compression(conn, method, pool));
+        }
+    }
+
   SVN_ERR(handle_auth_request(sess, pool));
 
   /* This is where the security layer would go into effect if we
@@ -2463,10 +2589,62 @@ static svn_error_t *ra_svn_get_file_revs(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+/* Maximum number of 'lock' / 'unlock' commands that we keep in flight
+   before reading their responses.  The commands accumulate in the
+   connection's write buffer and get flushed as soon as we block on the
+   first response, so a whole window travels in one round trip.  Keeping
+   the window bounded ensures that neither side's send buffer can fill
+   up with the other side not reading, which would deadlock the
+   connection. */
+#define MAX_PIPELINED_LOCK_CMDS 32
+
+/* Read the authentication request and the response for one pipelined
+   'lock' command on SESS, targeting PATH, and report the result to
+   LOCK_FUNC / LOCK_BATON (if non-NULL).  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+read_lock_compat_response(svn_ra_svn__session_baton_t *sess,
+                          const char *path,
+                          svn_ra_lock_callback_t lock_func,
+                          void *lock_baton,
+                          apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__list_t *list;
+  svn_lock_t *lock = NULL;
+  svn_error_t *err, *callback_err = NULL;
+
+  /* Servers before 1.2 doesn't support locking.  Check this here. */
+  SVN_ERR(handle_unsupported_cmd(handle_auth_request(sess, scratch_pool),
+                                 N_("Server doesn't support "
+                                    "the lock command")));
+
+  err = svn_ra_svn__read_cmd_response(sess->conn, scratch_pool, "l", &list);
+
+  if (!err)
+    SVN_ERR(parse_lock(list, scratch_pool, &lock));
+
+  if (err && !SVN_ERR_IS_LOCK_ERROR(err))
+    return err;
+
+  if (lock_func)
+    callback_err = lock_func(lock_baton, path, TRUE, err ? NULL : lock,
+                             err, scratch_pool);
+
+  svn_error_clear(err);
+
+  return callback_err;
+}
+
 /* For each path in PATH_REVS, send a 'lock' command to the server.
    Used with 1.2.x series servers which support locking, but of only
    one path at a time.  ra_svn_lock(), which supports 'lock-many'
-   is now the default.  See svn_ra_lock() docstring for interface details. */
+   is now the default.  See svn_ra_lock() docstring for interface details.
+
+   To avoid one full round trip per path, the commands are pipelined:
+   the first one is completed in lockstep because the server may answer
+   it with an authentication challenge to raise the access level, but
+   after that up to MAX_PIPELINED_LOCK_CMDS commands are queued before
+   their responses are read. */
 static svn_error_t *ra_svn_lock_compat(svn_ra_session_t *session,
                                        apr_hash_t *path_revs,
                                        const char *comment,
@@ -2477,18 +2655,23 @@ static svn_error_t *ra_svn_lock_compat(svn_ra_session_t *session,
 {
   svn_ra_svn__session_baton_t *sess = session->priv;
   svn_ra_svn_conn_t* conn = sess->conn;
-  svn_ra_svn__list_t *list;
   apr_hash_index_t *hi;
+  apr_array_header_t *paths;
+  int sent = 0;
+  int answered = 0;
   apr_pool_t *iterpool = svn_pool_create(pool);
 
+  /* Remember the paths in the order their commands were sent so that
+     the lagging responses can be matched up again. */
+  paths = apr_array_make(pool, apr_hash_count(path_revs),
+                         sizeof(const char *));
+
   for (hi = apr_hash_first(pool, path_revs); hi; hi = apr_hash_next(hi))
     {
-      svn_lock_t *lock;
       const void *key;
       const char *path;
       void *val;
       svn_revnum_t *revnum;
-      svn_error_t *err, *callback_err = NULL;
 
       svn_pool_clear(iterpool);
 
@@ -2498,39 +2681,73 @@ static svn_error_t *ra_svn_lock_compat(svn_ra_session_t *session,
 
       SVN_ERR(svn_ra_svn__write_cmd_lock(conn, iterpool, path, comment,
                                          steal_lock, *revnum));
+      APR_ARRAY_PUSH(paths, const char *) = path;
+      sent++;
+
+      while (answered < sent
+             && (answered == 0
+                 || sent - answered >= MAX_PIPELINED_LOCK_CMDS))
+        {
+          SVN_ERR(read_lock_compat_response(
+                    sess, APR_ARRAY_IDX(paths, answered, const char *),
+                    lock_func, lock_baton, iterpool));
+          answered++;
+        }
+    }
+
+  /* Drain the responses still in flight. */
+  while (answered < sent)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(read_lock_compat_response(
+                sess, APR_ARRAY_IDX(paths, answered, const char *),
+                lock_func, lock_baton, iterpool));
+      answered++;
+    }
 
-      /* Servers before 1.2 doesn't support locking.  Check this here. */
-      SVN_ERR(handle_unsupported_cmd(handle_auth_request(sess, pool),
-                                     N_("Server doesn't support "
-                                        "the lock command")));
+  svn_pool_destroy(iterpool);
 
-      err = svn_ra_svn__read_cmd_response(conn, iterpool, "l", &list);
+  return SVN_NO_ERROR;
+}
 
-      if (!err)
-        SVN_ERR(parse_lock(list, iterpool, &lock));
+/* Read the authentication request and the response for one pipelined
+   'unlock' command on SESS, targeting PATH, and report the result to
+   LOCK_FUNC / LOCK_BATON (if non-NULL).  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+read_unlock_compat_response(svn_ra_svn__session_baton_t *sess,
+                            const char *path,
+                            svn_ra_lock_callback_t lock_func,
+                            void *lock_baton,
+                            apr_pool_t *scratch_pool)
+{
+  svn_error_t *err, *callback_err = NULL;
 
-      if (err && !SVN_ERR_IS_LOCK_ERROR(err))
-        return err;
+  /* Servers before 1.2 don't support locking.  Check this here. */
+  SVN_ERR(handle_unsupported_cmd(handle_auth_request(sess, scratch_pool),
+                                 N_("Server doesn't support the unlock "
+                                    "command")));
 
-      if (lock_func)
-        callback_err = lock_func(lock_baton, path, TRUE, err ? NULL : lock,
-                                 err, iterpool);
+  err = svn_ra_svn__read_cmd_response(sess->conn, scratch_pool, "");
 
-      svn_error_clear(err);
+  if (err && !SVN_ERR_IS_UNLOCK_ERROR(err))
+    return err;
 
-      if (callback_err)
-        return callback_err;
-    }
+  if (lock_func)
+    callback_err = lock_func(lock_baton, path, FALSE, NULL, err,
+                             scratch_pool);
 
-  svn_pool_destroy(iterpool);
+  svn_error_clear(err);
 
-  return SVN_NO_ERROR;
+  return callback_err;
 }
 
 /* For each path in PATH_TOKENS, send an 'unlock' command to the server.
    Used with 1.2.x series servers which support unlocking, but of only
    one path at a time.  ra_svn_unlock(), which supports 'unlock-many' is
-   now the default.  See svn_ra_unlock() docstring for interface details. */
+   now the default.  See svn_ra_unlock() docstring for interface details.
+
+   The commands are pipelined the same way as in ra_svn_lock_compat(). */
 static svn_error_t *ra_svn_unlock_compat(svn_ra_session_t *session,
                                          apr_hash_t *path_tokens,
                                          svn_boolean_t break_lock,
@@ -2541,15 +2758,20 @@ static svn_error_t *ra_svn_unlock_compat(svn_ra_session_t *session,
   svn_ra_svn__session_baton_t *sess = session->priv;
   svn_ra_svn_conn_t* conn = sess->conn;
   apr_hash_index_t *hi;
+  apr_array_header_t *paths;
+  int sent = 0;
+  int answered = 0;
   apr_pool_t *iterpool = svn_pool_create(pool);
 
+  paths = apr_array_make(pool, apr_hash_count(path_tokens),
+                         sizeof(const char *));
+
   for (hi = apr_hash_first(pool, path_tokens); hi; hi = apr_hash_next(hi))
     {
       const void *key;
       const char *path;
       void *val;
       const svn_string_t *token;
-      svn_error_t *err, *callback_err = NULL;
 
       svn_pool_clear(iterpool);
 
@@ -2562,24 +2784,28 @@ static svn_error_t *ra_svn_unlock_compat(svn_ra_session_t *session,
 
       SVN_ERR(svn_ra_svn__write_cmd_unlock(conn, iterpool, path, token,
                                            break_lock));
+      APR_ARRAY_PUSH(paths, const char *) = path;
+      sent++;
 
-      /* Servers before 1.2 don't support locking.  Check this here. */
-      SVN_ERR(handle_unsupported_cmd(handle_auth_request(sess, iterpool),
-                                     N_("Server doesn't support the unlock "
-                                        "command")));
-
-      err = svn_ra_svn__read_cmd_response(conn, iterpool, "");
-
-      if (err && !SVN_ERR_IS_UNLOCK_ERROR(err))
-        return err;
-
-      if (lock_func)
-        callback_err = lock_func(lock_baton, path, FALSE, NULL, err, pool);
-
-      svn_error_clear(err);
+      while (answered < sent
+             && (answered == 0
+                 || sent - answered >= MAX_PIPELINED_LOCK_CMDS))
+        {
+          SVN_ERR(read_unlock_compat_response(
+                    sess, APR_ARRAY_IDX(paths, answered, const char *),
+                    lock_func, lock_baton, iterpool));
+          answered++;
+        }
+    }
 
-      if (callback_err)
-        return callback_err;
+  /* Drain the responses still in flight. */
+  while (answered < sent)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(read_unlock_compat_response(
+                sess, APR_ARRAY_IDX(paths, answered, const char *),
+                lock_func, lock_baton, iterpool));
+      answered++;
     }
 
   svn_pool_destroy(iterpool);
@@ -3258,6 +3484,101 @@ ra_svn_list(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+/* This implements svn_ra__vtable_t.check_paths. */
+static svn_error_t *ra_svn_check_paths(apr_array_header_t **kinds,
+                                       svn_ra_session_t *session,
+                                       const apr_array_header_t *path_revs,
+                                       apr_pool_t *result_pool,
+                                       apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  *kinds = apr_array_make(result_pool, path_revs->nelts,
+                          sizeof(svn_node_kind_t));
+  if (path_revs->nelts == 0)
+    {
+      svn_pool_destroy(iterpool);
+      return SVN_NO_ERROR;
+    }
+
+  /* Run the first probe the ordinary way.  This settles any pending
+     (re-)authentication exchange while the connection is still in
+     lock-step, so the pipelined commands below only ever see the empty
+     auth response of an authenticated connection. */
+  {
+    const svn_ra__path_rev_t *pair
+      = APR_ARRAY_IDX(path_revs, 0, const svn_ra__path_rev_t *);
+    svn_node_kind_t kind;
+
+    SVN_ERR(ra_svn_check_path(session, pair->path, pair->revision, &kind,
+                              iterpool));
+    APR_ARRAY_PUSH(*kinds, svn_node_kind_t) = kind;
+  }
+
+  /* Pipeline the remaining probes:  write all commands, then read all
+     responses.  The server processes the command stream strictly in
+     order, so the responses arrive in order as well and the whole
+     batch costs one network round trip. */
+  for (i = 1; i < path_revs->nelts; i++)
+    {
+      const svn_ra__path_rev_t *pair
+        = APR_ARRAY_IDX(path_revs, i, const svn_ra__path_rev_t *);
+      const char *path = reparent_path(session, pair->path, scratch_pool);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_svn__write_cmd_check_path(conn, iterpool, path,
+                                               pair->revision));
+    }
+
+  for (i = 1; i < path_revs->nelts; i++)
+    {
+      svn_ra_svn__list_t *mechlist;
+      const char *realm, *kind_word;
+
+      svn_pool_clear(iterpool);
+
+      /* Read the per-command auth response inline.  A request for
+         re-authentication cannot be honored here - the server would
+         interpret the already pipelined commands as the credential
+         exchange - but it also cannot occur on a connection that just
+         answered the same command. */
+      err = svn_ra_svn__read_cmd_response(conn, iterpool, "lc",
+                                          &mechlist, &realm);
+      if (!err && mechlist->nelts > 0)
+        err = svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                               _("Unexpected server re-authentication "
+                                 "request during pipelined commands"));
+      if (!err)
+        err = svn_ra_svn__read_cmd_response(conn, iterpool, "w", &kind_word);
+      if (err)
+        break;
+
+      APR_ARRAY_PUSH(*kinds, svn_node_kind_t)
+        = svn_node_kind_from_word(kind_word);
+    }
+
+  /* If one probe failed, e.g. due to authz, drain the responses to the
+     remaining pipelined commands so the connection stays usable. */
+  for (i++; i < path_revs->nelts; i++)
+    {
+      svn_ra_svn__list_t *mechlist;
+      const char *realm, *kind_word;
+
+      svn_pool_clear(iterpool);
+      svn_error_clear(svn_ra_svn__read_cmd_response(conn, iterpool, "lc",
+                                                    &mechlist, &realm));
+      svn_error_clear(svn_ra_svn__read_cmd_response(conn, iterpool, "w",
+                                                    &kind_word));
+    }
+
+  svn_pool_destroy(iterpool);
+  return svn_error_trace(err);
+}
+
 static const svn_ra__vtable_t ra_svn_vtable = {
   svn_ra_svn_version,
   ra_svn_get_description,
@@ -3300,7 +3621,8 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   ra_svn_list,
   ra_svn_register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
-  NULL /* replay_range_ev2 */
+  NULL /* replay_range_ev2 */,
+  ra_svn_check_paths
 };
 
 svn_error_t *
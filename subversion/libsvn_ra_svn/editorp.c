@@ -40,6 +40,7 @@
 #include "svn_private_config.h"
 
 #include "private/svn_atomic.h"
+#include "private/svn_delta_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_editor.h"
 #include "private/svn_string_private.h"
@@ -64,12 +65,34 @@ typedef struct ra_svn_edit_baton_t {
   svn_boolean_t got_status;
 } ra_svn_edit_baton_t;
 
+/* Maximum number of file content and property bytes that we buffer for
+   an added file before giving up on sending it as a single put-file
+   command.  Larger files fall back to the classic command sequence. */
+#define RA_SVN_PUT_FILE_LIMIT 4096
+
+/* Buffered state for a newly added file that we hope to send as a
+   single put-file command.  Kept until the file either grows beyond
+   RA_SVN_PUT_FILE_LIMIT (see flush_pending_file) or gets closed. */
+typedef struct ra_svn_pending_file_t {
+  const char *path;            /* path of the added file */
+  svn_string_t *parent_token;  /* token of the parent directory */
+  apr_array_header_t *props;   /* svn_prop_t changes, in order */
+  svn_stringbuf_t *diff;       /* buffered svndiff data; NULL until
+                                  apply_textdelta has been called */
+  svn_boolean_t delta_done;    /* the svndiff stream has been closed */
+  apr_size_t size;             /* total bytes buffered so far */
+} ra_svn_pending_file_t;
+
 /* Works for both directories and files. */
 typedef struct ra_svn_baton_t {
   svn_ra_svn_conn_t *conn;
   apr_pool_t *pool;
   ra_svn_edit_baton_t *eb;
   svn_string_t *token;
+
+  /* A file added on a connection with the put-file capability whose
+     commands we have buffered so far.  NULL in all other cases. */
+  ra_svn_pending_file_t *pending;
 } ra_svn_baton_t;
 
 /* Forward declaration. */
@@ -134,6 +157,7 @@ static ra_svn_baton_t *ra_svn_make_baton(svn_ra_svn_conn_t *conn,
   b->pool = pool;
   b->eb = eb;
   b->token = token;
+  b->pending = NULL;
   return b;
 }
 
@@ -273,6 +297,46 @@ static svn_error_t *ra_svn_absent_dir(const char *path,
   return SVN_NO_ERROR;
 }
 
+/* Leave pending mode for the file B and replay the buffered operations
+   as classic editor commands.  Called when the file turns out not to fit
+   into a single put-file command after all.  Commands arriving after the
+   flush simply take the classic code paths. */
+static svn_error_t *flush_pending_file(ra_svn_baton_t *b)
+{
+  ra_svn_pending_file_t *pending = b->pending;
+  int i;
+
+  b->pending = NULL;
+  SVN_ERR(check_for_error(b->eb, b->pool));
+  SVN_ERR(svn_ra_svn__write_cmd_add_file(b->conn, b->pool, pending->path,
+                                         pending->parent_token, b->token,
+                                         NULL, SVN_INVALID_REVNUM));
+  for (i = 0; i < pending->props->nelts; i++)
+    {
+      const svn_prop_t *prop = &APR_ARRAY_IDX(pending->props, i, svn_prop_t);
+      SVN_ERR(svn_ra_svn__write_cmd_change_file_prop(b->conn, b->pool,
+                                                     b->token, prop->name,
+                                                     prop->value));
+    }
+  if (pending->diff)
+    {
+      SVN_ERR(svn_ra_svn__write_cmd_apply_textdelta(b->conn, b->pool,
+                                                    b->token, NULL));
+      if (pending->diff->len > 0)
+        {
+          svn_string_t str;
+          str.data = pending->diff->data;
+          str.len = pending->diff->len;
+          SVN_ERR(svn_ra_svn__write_cmd_textdelta_chunk(b->conn, b->pool,
+                                                        b->token, &str));
+        }
+      if (pending->delta_done)
+        SVN_ERR(svn_ra_svn__write_cmd_textdelta_end(b->conn, b->pool,
+                                                    b->token));
+    }
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *ra_svn_add_file(const char *path,
                                     void *parent_baton,
                                     const char *copy_path,
@@ -285,6 +349,25 @@ static svn_error_t *ra_svn_add_file(const char *path,
 
   SVN_ERR_ASSERT((copy_path && SVN_IS_VALID_REVNUM(copy_rev))
                  || (!copy_path && !SVN_IS_VALID_REVNUM(copy_rev)));
+
+  /* If the other side understands put-file, don't send anything yet but
+     buffer the file's commands in the hope that it remains small enough
+     for a single put-file command.  Files with a copy source always use
+     the classic commands because put-file cannot express the source. */
+  if (!copy_path
+      && svn_ra_svn_has_capability(b->conn, SVN_RA_SVN_CAP_PUT_FILE))
+    {
+      ra_svn_baton_t *fb = ra_svn_make_baton(b->conn, pool, b->eb, token);
+      ra_svn_pending_file_t *pending = apr_pcalloc(pool, sizeof(*pending));
+
+      pending->path = apr_pstrdup(pool, path);
+      pending->parent_token = svn_string_dup(b->token, pool);
+      pending->props = apr_array_make(pool, 0, sizeof(svn_prop_t));
+      fb->pending = pending;
+      *file_baton = fb;
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(check_for_error(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_add_file(b->conn, pool,  path, b->token,
                                          token, copy_path, copy_rev));
@@ -314,6 +397,21 @@ static svn_error_t *ra_svn_svndiff_handler(void *baton, const char *data,
   ra_svn_baton_t *b = baton;
   svn_string_t str;
 
+  if (b->pending)
+    {
+      /* Keep buffering, or replay as classic commands if the file just
+         got too large.  In the latter case the current chunk has not
+         been buffered yet, so send it the classic way below. */
+      if (b->pending->size + *len <= RA_SVN_PUT_FILE_LIMIT)
+        {
+          svn_stringbuf_appendbytes(b->pending->diff, data, *len);
+          b->pending->size += *len;
+          return SVN_NO_ERROR;
+        }
+
+      SVN_ERR(flush_pending_file(b));
+    }
+
   SVN_ERR(check_for_error(b->eb, b->pool));
   str.data = data;
   str.len = *len;
@@ -325,6 +423,12 @@ static svn_error_t *ra_svn_svndiff_close_handler(void *baton)
 {
   ra_svn_baton_t *b = baton;
 
+  if (b->pending)
+    {
+      b->pending->delta_done = TRUE;
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(check_for_error(b->eb, b->pool));
   SVN_ERR(svn_ra_svn__write_cmd_textdelta_end(b->conn, b->pool, b->token));
   return SVN_NO_ERROR;
@@ -339,10 +443,23 @@ static svn_error_t *ra_svn_apply_textdelta(void *file_baton,
   ra_svn_baton_t *b = file_baton;
   svn_stream_t *diff_stream;
 
-  /* Tell the other side we're starting a text delta. */
-  SVN_ERR(check_for_error(b->eb, pool));
-  SVN_ERR(svn_ra_svn__write_cmd_apply_textdelta(b->conn, pool, b->token,
-                                                base_checksum));
+  /* A delta against a base cannot be expressed as a put-file command.
+     Otherwise, start buffering the svndiff data for a pending file. */
+  if (b->pending)
+    {
+      if (base_checksum)
+        SVN_ERR(flush_pending_file(b));
+      else
+        b->pending->diff = svn_stringbuf_create_empty(b->pool);
+    }
+
+  if (!b->pending)
+    {
+      /* Tell the other side we're starting a text delta. */
+      SVN_ERR(check_for_error(b->eb, pool));
+      SVN_ERR(svn_ra_svn__write_cmd_apply_textdelta(b->conn, pool, b->token,
+                                                    base_checksum));
+    }
 
   /* Transform the window stream to an svndiff stream.  Reuse the
    * file baton for the stream handler, since it has all the
@@ -351,9 +468,11 @@ static svn_error_t *ra_svn_apply_textdelta(void *file_baton,
   svn_stream_set_write(diff_stream, ra_svn_svndiff_handler);
   svn_stream_set_close(diff_stream, ra_svn_svndiff_close_handler);
 
-  svn_txdelta_to_svndiff3(wh, wh_baton, diff_stream,
-                          svn_ra_svn__svndiff_version(b->conn),
-                          b->conn->compression_level, pool);
+  /* Compress the windows on a background thread; the writes to
+   * DIFF_STREAM stay on this thread. */
+  svn_txdelta__to_svndiff_pipelined(wh, wh_baton, diff_stream,
+                                    svn_ra_svn__svndiff_version(b->conn),
+                                    b->conn->compression_level, pool);
   return SVN_NO_ERROR;
 }
 
@@ -364,6 +483,24 @@ static svn_error_t *ra_svn_change_file_prop(void *file_baton,
 {
   ra_svn_baton_t *b = file_baton;
 
+  if (b->pending)
+    {
+      apr_size_t prop_size = strlen(name) + (value ? value->len : 0);
+
+      if (b->pending->size + prop_size <= RA_SVN_PUT_FILE_LIMIT)
+        {
+          svn_prop_t *prop = apr_array_push(b->pending->props);
+
+          prop->name = apr_pstrdup(b->pool, name);
+          prop->value = value ? svn_string_dup(value, b->pool) : NULL;
+          b->pending->size += prop_size;
+          return SVN_NO_ERROR;
+        }
+
+      /* Oversized property; send this file the classic way. */
+      SVN_ERR(flush_pending_file(b));
+    }
+
   SVN_ERR(check_for_error(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_change_file_prop(b->conn, pool,
                                                  b->token, name, value));
@@ -376,6 +513,24 @@ static svn_error_t *ra_svn_close_file(void *file_baton,
 {
   ra_svn_baton_t *b = file_baton;
 
+  if (b->pending)
+    {
+      /* The whole file fits into the buffers: send it as one command. */
+      ra_svn_pending_file_t *pending = b->pending;
+      const svn_string_t *text
+        = pending->diff
+        ? svn_stringbuf__morph_into_string(pending->diff)
+        : NULL;
+
+      b->pending = NULL;
+      SVN_ERR(check_for_error(b->eb, pool));
+      SVN_ERR(svn_ra_svn__write_cmd_put_file(b->conn, pool, pending->path,
+                                             pending->parent_token,
+                                             pending->props,
+                                             text_checksum, text));
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(check_for_error(b->eb, pool));
   SVN_ERR(svn_ra_svn__write_cmd_close_file(b->conn, pool,
                                            b->token, text_checksum));
@@ -732,6 +887,66 @@ ra_svn_handle_add_file(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+ra_svn_handle_put_file(svn_ra_svn_conn_t *conn,
+                       apr_pool_t *pool,
+                       const svn_ra_svn__list_t *params,
+                       ra_svn_driver_state_t *ds)
+{
+  const char *path;
+  svn_string_t *token;
+  svn_ra_svn__list_t *proplist;
+  const char *text_checksum;
+  svn_string_t *text;
+  ra_svn_token_entry_t *entry;
+  void *file_baton;
+  int i;
+
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "csl(?c)(?s)", &path, &token,
+                                  &proplist, &text_checksum, &text));
+  SVN_ERR(lookup_token(ds, token, FALSE, &entry));
+
+  /* The PATH should be canonical .. but never trust incoming data. */
+  if (!svn_relpath_is_canonical(path))
+    path = svn_relpath_canonicalize(path, pool);
+
+  /* Unlike add-file, the file is added, modified and closed right here,
+     so there is no token to remember and the command subpool suffices. */
+  SVN_CMD_ERR(ds->editor->add_file(path, entry->baton, NULL,
+                                   SVN_INVALID_REVNUM, pool, &file_baton));
+
+  for (i = 0; i < proplist->nelts; i++)
+    {
+      svn_ra_svn__item_t *elt = &SVN_RA_SVN__LIST_ITEM(proplist, i);
+      const char *name;
+      svn_string_t *value;
+
+      if (elt->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Put-file property entry not a list"));
+      SVN_ERR(svn_ra_svn__parse_tuple(&elt->u.list, "c(?s)", &name, &value));
+      SVN_CMD_ERR(ds->editor->change_file_prop(file_baton, name, value,
+                                               pool));
+    }
+
+  if (text)
+    {
+      svn_txdelta_window_handler_t wh;
+      void *wh_baton;
+      svn_stream_t *dstream;
+      apr_size_t len = text->len;
+
+      SVN_CMD_ERR(ds->editor->apply_textdelta(file_baton, NULL, pool,
+                                              &wh, &wh_baton));
+      dstream = svn_txdelta_parse_svndiff(wh, wh_baton, TRUE, pool);
+      SVN_CMD_ERR(svn_stream_write(dstream, text->data, &len));
+      SVN_CMD_ERR(svn_stream_close(dstream));
+    }
+
+  SVN_CMD_ERR(ds->editor->close_file(file_baton, text_checksum, pool));
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 ra_svn_handle_open_file(svn_ra_svn_conn_t *conn,
                         apr_pool_t *pool,
@@ -956,6 +1171,7 @@ static const struct {
   { "close-dir",        ra_svn_handle_close_dir },
   { "absent-dir",       ra_svn_handle_absent_dir },
   { "add-file",         ra_svn_handle_add_file },
+  { "put-file",         ra_svn_handle_put_file },
   { "textdelta-end",    ra_svn_handle_textdelta_end },
   { "absent-file",      ra_svn_handle_absent_file },
   { "abort-edit",       ra_svn_handle_abort_edit },
@@ -1078,7 +1294,7 @@ svn_error_t *svn_ra_svn_drive_editor2(svn_ra_svn_conn_t *conn,
                                       svn_boolean_t for_replay)
 {
   ra_svn_driver_state_t state;
-  apr_pool_t *subpool = svn_pool_create(pool);
+  apr_pool_t *subpool = svn_pool__create_iterpool(pool);
   const char *cmd;
   svn_error_t *err, *write_err;
   svn_ra_svn__list_t *params;
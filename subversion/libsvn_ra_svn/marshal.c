@@ -48,6 +48,7 @@
 #include "private/svn_string_private.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_error_private.h"
+#include "private/svn_perf.h"
 #include "private/svn_subr_private.h"
 
 #define svn_iswhitespace(c) ((c) == ' ' || (c) == '\n')
@@ -179,6 +180,15 @@ svn_ra_svn__to_private_array(const apr_array_header_t *source,
 
 /* --- CONNECTION INITIALIZATION --- */
 
+/* Return a read buffer of SIZE bytes, allocated in POOL and aligned to
+   SVN_RA_SVN__PAGE_SIZE just like the connection object itself. */
+static char *
+alloc_read_buf(apr_pool_t *pool, apr_size_t size)
+{
+  void *mem = apr_palloc(pool, size + SVN_RA_SVN__PAGE_SIZE);
+  return (char *)APR_ALIGN((apr_uintptr_t)mem, SVN_RA_SVN__PAGE_SIZE);
+}
+
 svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
                                            svn_stream_t *in_stream,
                                            svn_stream_t *out_stream,
@@ -200,6 +210,13 @@ svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
   conn->encrypted = FALSE;
 #endif
   conn->session = NULL;
+  conn->frame_compression = SVN_RA_SVN__FRAME_COMPRESSION_NONE;
+  conn->frame_out = NULL;
+  conn->frame_raw = NULL;
+  conn->frame_in = NULL;
+  conn->frame_in_pos = 0;
+  conn->read_buf = alloc_read_buf(result_pool, SVN_RA_SVN__READBUF_SIZE);
+  conn->read_buf_size = SVN_RA_SVN__READBUF_SIZE;
   conn->read_ptr = conn->read_buf;
   conn->read_end = conn->read_buf;
   conn->write_pos = 0;
@@ -265,6 +282,46 @@ svn_ra_svn__set_capabilities(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Defined in the write buffer management section below. */
+static svn_error_t *writebuf_flush(svn_ra_svn_conn_t *conn,
+                                   apr_pool_t *pool);
+
+int
+svn_ra_svn__preferred_frame_compression(svn_ra_svn_conn_t *conn)
+{
+  /* Prefer the stronger zstd compression, if both sides can use it. */
+#ifdef SVN_HAVE_ZSTD
+  if (svn_ra_svn_has_capability(conn,
+                                SVN_RA_SVN_CAP_FRAME_COMPRESSION_ZSTD))
+    return SVN_RA_SVN__FRAME_COMPRESSION_ZSTD;
+#endif
+
+  if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_FRAME_COMPRESSION_LZ4))
+    return SVN_RA_SVN__FRAME_COMPRESSION_LZ4;
+
+  return SVN_RA_SVN__FRAME_COMPRESSION_NONE;
+}
+
+svn_error_t *
+svn_ra_svn__enable_frame_compression(svn_ra_svn_conn_t *conn,
+                                     int method,
+                                     apr_pool_t *scratch_pool)
+{
+  /* Frames must not interleave with plain protocol data:  everything
+     written so far goes out uncompressed and nothing may be left in the
+     read buffer from before the switch. */
+  SVN_ERR(writebuf_flush(conn, scratch_pool));
+  SVN_ERR_ASSERT(conn->read_ptr == conn->read_end);
+
+  conn->frame_compression = method;
+  conn->frame_out = svn_stringbuf_create_empty(conn->pool);
+  conn->frame_raw = svn_stringbuf_create_empty(conn->pool);
+  conn->frame_in = svn_stringbuf_create_empty(conn->pool);
+  conn->frame_in_pos = 0;
+
+  return SVN_NO_ERROR;
+}
+
 int
 svn_ra_svn__svndiff_version(svn_ra_svn_conn_t *conn)
 {
@@ -273,6 +330,12 @@ svn_ra_svn__svndiff_version(svn_ra_svn_conn_t *conn)
   if (svn_ra_svn_compression_level(conn) <= 0)
     return 0;
 
+  /* Prefer SVNDIFF3 over everything else, if we can encode zstd. */
+#ifdef SVN_HAVE_ZSTD
+  if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED))
+    return 3;
+#endif
+
   /* Prefer SVNDIFF2 over SVNDIFF1. */
   if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED))
     return 2;
@@ -333,6 +396,14 @@ svn_ra_svn__set_block_handler(svn_ra_svn_conn_t *conn,
 svn_error_t *svn_ra_svn__data_available(svn_ra_svn_conn_t *conn,
                                        svn_boolean_t *data_available)
 {
+  /* Data decompressed from an earlier frame but not yet consumed counts
+     as available, even if the transport itself is idle. */
+  if (conn->frame_in && conn->frame_in_pos < conn->frame_in->len)
+    {
+      *data_available = TRUE;
+      return SVN_NO_ERROR;
+    }
+
   return svn_ra_svn__stream_data_available(conn->stream, data_available);
 }
 
@@ -363,14 +434,25 @@ check_io_limits(svn_ra_svn_conn_t *conn)
   return SVN_NO_ERROR;
 }
 
-/* Write data to socket or output file as appropriate. */
-static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
-                                    const char *data, apr_size_t len)
+/* Write the NVEC buffers in VEC to socket or output file as appropriate,
+   using vectored writes where the connection supports them.  VEC will be
+   modified to track the write progress.  This is the raw transport exit;
+   with frame compression enabled, only writebuf_output_frame() may call
+   it directly. */
+static svn_error_t *writebuf_output_vec_raw(svn_ra_svn_conn_t *conn,
+                                            apr_pool_t *pool,
+                                            struct iovec *vec, int nvec)
 {
-  const char *end = data + len;
+  int i;
   apr_size_t count;
+  apr_size_t len = 0;
   apr_pool_t *subpool = NULL;
   svn_ra_svn__session_baton_t *session = conn->session;
+  svn_error_t *err;
+  SVN_PERF_TIMER(timer);
+
+  for (i = 0; i < nvec; i++)
+    len += vec[i].iov_len;
 
   /* Limit the size of the response, if a limit has been configured.
    * This is to limit the server load in case users e.g. accidentally ran
@@ -378,14 +460,16 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   conn->current_out += len;
   SVN_ERR(check_io_limits(conn));
 
-  while (data < end)
+  for (i = 0; i < nvec; )
     {
-      count = end - data;
-
       if (session && session->callbacks && session->callbacks->cancel_func)
         SVN_ERR((session->callbacks->cancel_func)(session->callbacks_baton));
 
-      SVN_ERR(svn_ra_svn__stream_write(conn->stream, data, &count));
+      SVN_PERF_TIMER_START(timer);
+      err = svn_ra_svn__stream_writev(conn->stream, vec + i, nvec - i,
+                                      &count);
+      SVN_PERF_TIMER_STOP(svn_perf__probe_ra_svn_write, timer);
+      SVN_ERR(err);
       if (count == 0)
         {
           if (!subpool)
@@ -394,7 +478,6 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
             svn_pool_clear(subpool);
           SVN_ERR(conn->block_handler(conn, subpool, conn->block_baton));
         }
-      data += count;
 
       if (session)
         {
@@ -405,6 +488,16 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
             (cb->progress_func)(session->bytes_written + session->bytes_read,
                                 -1, cb->progress_baton, subpool);
         }
+
+      /* Skip the buffers that have been written in full and adjust the
+         first partially written one, if any. */
+      while (i < nvec && count >= vec[i].iov_len)
+        count -= vec[i++].iov_len;
+      if (count)
+        {
+          vec[i].iov_base = (char *)vec[i].iov_base + count;
+          vec[i].iov_len -= count;
+        }
     }
 
   conn->written_since_error_check += len;
@@ -416,6 +509,77 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   return SVN_NO_ERROR;
 }
 
+/* Compress LEN bytes from DATA into a single frame and send it over
+   CONN's raw transport.  The frame consists of a fixed-size header
+   (method byte plus big-endian payload length) followed by the
+   compressed payload. */
+static svn_error_t *writebuf_output_frame(svn_ra_svn_conn_t *conn,
+                                          apr_pool_t *pool,
+                                          const char *data, apr_size_t len)
+{
+  svn_stringbuf_t *payload = conn->frame_out;
+  unsigned char header[SVN_RA_SVN__FRAME_HEADER_SIZE];
+  struct iovec vec[2];
+
+  if (conn->frame_compression == SVN_RA_SVN__FRAME_COMPRESSION_ZSTD)
+    SVN_ERR(svn__compress_zstd(data, len, payload, conn->compression_level));
+  else
+    SVN_ERR(svn__compress_lz4(data, len, payload));
+
+  header[0] = (unsigned char)conn->frame_compression;
+  header[1] = (unsigned char)((payload->len >> 24) & 0xff);
+  header[2] = (unsigned char)((payload->len >> 16) & 0xff);
+  header[3] = (unsigned char)((payload->len >> 8) & 0xff);
+  header[4] = (unsigned char)(payload->len & 0xff);
+
+  vec[0].iov_base = header;
+  vec[0].iov_len = sizeof(header);
+  vec[1].iov_base = payload->data;
+  vec[1].iov_len = payload->len;
+  return svn_error_trace(writebuf_output_vec_raw(conn, pool, vec, 2));
+}
+
+/* Write the NVEC buffers in VEC to CONN, compressing them into frames
+   if the connection negotiated frame compression. */
+static svn_error_t *writebuf_output_vec(svn_ra_svn_conn_t *conn,
+                                        apr_pool_t *pool,
+                                        struct iovec *vec, int nvec)
+{
+  int i;
+
+  if (conn->frame_compression == SVN_RA_SVN__FRAME_COMPRESSION_NONE)
+    return svn_error_trace(writebuf_output_vec_raw(conn, pool, vec, nvec));
+
+  /* Compress each buffer separately, splitting very large ones such
+     that the receiver can size its decompression buffer upfront. */
+  for (i = 0; i < nvec; i++)
+    {
+      const char *data = vec[i].iov_base;
+      apr_size_t remaining = vec[i].iov_len;
+
+      while (remaining > 0)
+        {
+          apr_size_t chunk = MIN(remaining, SVN_RA_SVN__FRAME_PAYLOAD_SIZE);
+          SVN_ERR(writebuf_output_frame(conn, pool, data, chunk));
+          data += chunk;
+          remaining -= chunk;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Write data to socket or output file as appropriate. */
+static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
+                                    const char *data, apr_size_t len)
+{
+  struct iovec vec;
+
+  vec.iov_base = (void *)data;
+  vec.iov_len = len;
+  return writebuf_output_vec(conn, pool, &vec, 1);
+}
+
 /* Write data from the write buffer out to the socket. */
 static svn_error_t *writebuf_flush(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
 {
@@ -433,10 +597,28 @@ static svn_error_t *writebuf_write(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   /* data >= 8k is sent immediately */
   if (len >= sizeof(conn->write_buf) / 2)
     {
+      /* Combine any buffered data (e.g. the string length header) with
+         the large payload in a single vectored write instead of flushing
+         them with a separate system call. */
+      struct iovec vec[2];
+      int nvec = 0;
+
       if (conn->write_pos > 0)
-        SVN_ERR(writebuf_flush(conn, pool));
+        {
+          vec[nvec].iov_base = conn->write_buf;
+          vec[nvec].iov_len = conn->write_pos;
+          nvec++;
+
+          /* Clear conn->write_pos first in case the block handler does
+             a read. */
+          conn->write_pos = 0;
+        }
 
-      return writebuf_output(conn, pool, data, len);
+      vec[nvec].iov_base = (void *)data;
+      vec[nvec].iov_len = len;
+      nvec++;
+
+      return writebuf_output_vec(conn, pool, vec, nvec);
     }
 
   /* ensure room for the data to add */
@@ -490,11 +672,83 @@ static char *readbuf_drain(svn_ra_svn_conn_t *conn, char *data, char *end)
   return data + copylen;
 }
 
+/* Read exactly LEN bytes from CONN's raw transport into DATA. */
+static svn_error_t *readbuf_input_raw_full(svn_ra_svn_conn_t *conn,
+                                           char *data, apr_size_t len)
+{
+  while (len > 0)
+    {
+      apr_size_t chunk = len;
+      SVN_ERR(svn_ra_svn__stream_read(conn->stream, data, &chunk));
+      if (chunk == 0)
+        return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL,
+                                NULL);
+      data += chunk;
+      len -= chunk;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Fill DATA with up to *LEN decompressed bytes, reading and expanding
+   the next compressed frame from CONN's raw transport if no earlier
+   frame data is left over.  Set *LEN to the number of bytes copied. */
+static svn_error_t *readbuf_input_frame(svn_ra_svn_conn_t *conn, char *data,
+                                        apr_size_t *len)
+{
+  svn_stringbuf_t *frame = conn->frame_in;
+  apr_size_t available = frame->len - conn->frame_in_pos;
+
+  if (available == 0)
+    {
+      char header[SVN_RA_SVN__FRAME_HEADER_SIZE];
+      apr_size_t payload_len;
+
+      SVN_ERR(readbuf_input_raw_full(conn, header, sizeof(header)));
+      payload_len = ((apr_size_t)(unsigned char)header[1] << 24)
+                  | ((apr_size_t)(unsigned char)header[2] << 16)
+                  | ((apr_size_t)(unsigned char)header[3] << 8)
+                  | (apr_size_t)(unsigned char)header[4];
+
+      if ((unsigned char)header[0] != (unsigned char)conn->frame_compression
+          || payload_len == 0
+          || payload_len > SVN_RA_SVN__FRAME_PAYLOAD_MAX)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Malformed compressed frame header"));
+
+      svn_stringbuf_ensure(conn->frame_raw, payload_len);
+      SVN_ERR(readbuf_input_raw_full(conn, conn->frame_raw->data,
+                                     payload_len));
+
+      if (conn->frame_compression == SVN_RA_SVN__FRAME_COMPRESSION_ZSTD)
+        SVN_ERR(svn__decompress_zstd(conn->frame_raw->data, payload_len,
+                                     frame, SVN_RA_SVN__FRAME_PAYLOAD_SIZE));
+      else
+        SVN_ERR(svn__decompress_lz4(conn->frame_raw->data, payload_len,
+                                    frame, SVN_RA_SVN__FRAME_PAYLOAD_SIZE));
+
+      conn->frame_in_pos = 0;
+      available = frame->len;
+      if (available == 0)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Empty compressed frame"));
+    }
+
+  if (*len > available)
+    *len = available;
+  memcpy(data, frame->data + conn->frame_in_pos, *len);
+  conn->frame_in_pos += *len;
+
+  return SVN_NO_ERROR;
+}
+
 /* Read data from socket or input file as appropriate. */
 static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
                                   apr_size_t *len, apr_pool_t *pool)
 {
   svn_ra_svn__session_baton_t *session = conn->session;
+  svn_error_t *err;
+  SVN_PERF_TIMER(timer);
 
   /* First, give the user a chance to cancel the request before we do. */
   if (session && session->callbacks && session->callbacks->cancel_func)
@@ -504,8 +758,15 @@ static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
    * we first read the whole request into memory before process it. */
   SVN_ERR(check_io_limits(conn));
 
-  /* Actually fill the buffer. */
-  SVN_ERR(svn_ra_svn__stream_read(conn->stream, data, len));
+  /* Actually fill the buffer.  The probe measures how long we block on
+   * the network (or the peer), including any frame decompression. */
+  SVN_PERF_TIMER_START(timer);
+  if (conn->frame_compression != SVN_RA_SVN__FRAME_COMPRESSION_NONE)
+    err = readbuf_input_frame(conn, data, len);
+  else
+    err = svn_ra_svn__stream_read(conn->stream, data, len);
+  SVN_PERF_TIMER_STOP(svn_perf__probe_ra_svn_read, timer);
+  SVN_ERR(err);
   if (*len == 0)
     return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
   conn->current_in += *len;
@@ -535,8 +796,12 @@ static svn_error_t *readbuf_skip(svn_ra_svn_conn_t *conn, apr_uint64_t len)
     if (len == 0)
       break;
 
-    buflen = sizeof(conn->read_buf);
-    SVN_ERR(svn_ra_svn__stream_read(conn->stream, conn->read_buf, &buflen));
+    buflen = conn->read_buf_size;
+    if (conn->frame_compression != SVN_RA_SVN__FRAME_COMPRESSION_NONE)
+      SVN_ERR(readbuf_input_frame(conn, conn->read_buf, &buflen));
+    else
+      SVN_ERR(svn_ra_svn__stream_read(conn->stream, conn->read_buf,
+                                      &buflen));
     if (buflen == 0)
       return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
 
@@ -560,8 +825,24 @@ static svn_error_t *readbuf_fill(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
   if (conn->write_pos)
     SVN_ERR(writebuf_flush(conn, pool));
 
+  /* If the previous fill returned a completely full buffer, the other
+   * side had even more data pending, i.e. this is some streamy response
+   * and we are issuing more reads than necessary.  Grow the buffer
+   * geometrically, up to the limit.  The previous buffer cannot be
+   * returned to the connection pool but, because we at least double the
+   * size each time, the total memory left behind stays below one
+   * maximum-sized buffer. */
+  if (conn->read_buf_size < SVN_RA_SVN__READBUF_MAX_SIZE
+      && (apr_size_t)(conn->read_end - conn->read_buf)
+         == conn->read_buf_size)
+    {
+      conn->read_buf_size = MIN(2 * conn->read_buf_size,
+                                SVN_RA_SVN__READBUF_MAX_SIZE);
+      conn->read_buf = alloc_read_buf(conn->pool, conn->read_buf_size);
+    }
+
   /* Fill (some of the) buffer. */
-  len = sizeof(conn->read_buf);
+  len = conn->read_buf_size;
   SVN_ERR(readbuf_input(conn, conn->read_buf, &len, pool));
   conn->read_ptr = conn->read_buf;
   conn->read_end = conn->read_buf + len;
@@ -602,7 +883,7 @@ static svn_error_t *readbuf_read(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   data = readbuf_drain(conn, data, end);
 
   /* Read large chunks directly into buffer. */
-  while (end - data > (apr_ssize_t)sizeof(conn->read_buf))
+  while (end - data > (apr_ssize_t)conn->read_buf_size)
     {
       SVN_ERR(writebuf_flush(conn, pool));
       count = end - data;
@@ -624,7 +905,7 @@ static svn_error_t *readbuf_read(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
 static svn_error_t *readbuf_skip_leading_garbage(svn_ra_svn_conn_t *conn,
                                                  apr_pool_t *pool)
 {
-  char buf[256];  /* Must be smaller than sizeof(conn->read_buf) - 1. */
+  char buf[256];  /* Must be smaller than SVN_RA_SVN__READBUF_SIZE - 1. */
   const char *p, *end;
   apr_size_t len;
   svn_boolean_t lparen = FALSE;
@@ -771,6 +1052,48 @@ svn_ra_svn__write_cstring(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+svn_boolean_t
+svn_ra_svn__can_sendfile(svn_ra_svn_conn_t *conn)
+{
+  /* With frame compression enabled, all bytes must pass through the
+     compressor; raw file data cannot go to the transport directly. */
+  if (conn->frame_compression != SVN_RA_SVN__FRAME_COMPRESSION_NONE)
+    return FALSE;
+
+  return svn_ra_svn__stream_can_sendfile(conn->stream);
+}
+
+svn_error_t *
+svn_ra_svn__write_from_file(svn_ra_svn_conn_t *conn,
+                            apr_pool_t *pool,
+                            apr_file_t *file,
+                            apr_off_t offset,
+                            svn_filesize_t len)
+{
+  apr_off_t end = offset + (apr_off_t)len;
+
+  /* Frame the contents like an ordinary string item.  The framing must
+     hit the wire before the zero-copy transfer can bypass WRITE_BUF. */
+  SVN_ERR(write_number(conn, pool, (apr_uint64_t)len, ':'));
+  SVN_ERR(writebuf_flush(conn, pool));
+
+  while (offset < end)
+    {
+      apr_size_t chunk = (apr_size_t)MIN(end - offset,
+                                         (apr_off_t)(APR_SIZE_MAX / 2));
+
+      SVN_ERR(svn_ra_svn__stream_sendfile(conn->stream, file, &offset,
+                                          &chunk));
+
+      /* No progress means the other side hung up on us. */
+      if (chunk == 0)
+        return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL,
+                                NULL);
+    }
+
+  return svn_error_trace(writebuf_writechar(conn, pool, ' '));
+}
+
 svn_error_t *
 svn_ra_svn__write_word(svn_ra_svn_conn_t *conn,
                        apr_pool_t *pool,
@@ -1904,12 +2227,13 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
 }
 
 svn_error_t *
-svn_ra_svn__handle_command(svn_boolean_t *terminate,
-                           apr_hash_t *cmd_hash,
-                           void *baton,
-                           svn_ra_svn_conn_t *conn,
-                           svn_boolean_t error_on_disconnect,
-                           apr_pool_t *pool)
+svn_ra_svn__handle_command2(svn_boolean_t *terminate,
+                            const char **cmd_name,
+                            apr_hash_t *cmd_hash,
+                            void *baton,
+                            svn_ra_svn_conn_t *conn,
+                            svn_boolean_t error_on_disconnect,
+                            apr_pool_t *pool)
 {
   const char *cmdname;
   svn_error_t *err, *write_err;
@@ -1917,6 +2241,8 @@ svn_ra_svn__handle_command(svn_boolean_t *terminate,
   const svn_ra_svn__cmd_entry_t *command;
 
   *terminate = FALSE;
+  if (cmd_name)
+    *cmd_name = NULL;
 
   /* Limit I/O for every command separately. */
   svn_ra_svn__reset_command_io_counters(conn);
@@ -1934,6 +2260,9 @@ svn_ra_svn__handle_command(svn_boolean_t *terminate,
       return err;
     }
 
+  if (cmd_name)
+    *cmd_name = cmdname;
+
   command = svn_hash_gets(cmd_hash, cmdname);
   if (command)
     {
@@ -1980,6 +2309,29 @@ svn_ra_svn__handle_command(svn_boolean_t *terminate,
   return err;
 }
 
+svn_error_t *
+svn_ra_svn__handle_command(svn_boolean_t *terminate,
+                           apr_hash_t *cmd_hash,
+                           void *baton,
+                           svn_ra_svn_conn_t *conn,
+                           svn_boolean_t error_on_disconnect,
+                           apr_pool_t *pool)
+{
+  return svn_error_trace(svn_ra_svn__handle_command2(terminate, NULL,
+                                                     cmd_hash, baton, conn,
+                                                     error_on_disconnect,
+                                                     pool));
+}
+
+void
+svn_ra_svn__get_command_io_counters(apr_uint64_t *bytes_in,
+                                    apr_uint64_t *bytes_out,
+                                    svn_ra_svn_conn_t *conn)
+{
+  *bytes_in = conn->current_in;
+  *bytes_out = conn->current_out;
+}
+
 svn_error_t *
 svn_ra_svn__handle_commands2(svn_ra_svn_conn_t *conn,
                              apr_pool_t *pool,
@@ -1988,7 +2340,7 @@ svn_ra_svn__handle_commands2(svn_ra_svn_conn_t *conn,
                              svn_boolean_t error_on_disconnect)
 {
   apr_pool_t *subpool = svn_pool_create(pool);
-  apr_pool_t *iterpool = svn_pool_create(subpool);
+  apr_pool_t *iterpool = svn_pool__create_iterpool(subpool);
   const svn_ra_svn__cmd_entry_t *command;
   apr_hash_t *cmd_hash = apr_hash_make(subpool);
 
@@ -2150,6 +2502,42 @@ svn_ra_svn__write_cmd_add_file(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra_svn__write_cmd_put_file(svn_ra_svn_conn_t *conn,
+                               apr_pool_t *pool,
+                               const char *path,
+                               const svn_string_t *parent_token,
+                               const apr_array_header_t *props,
+                               const char *text_checksum,
+                               const svn_string_t *text)
+{
+  int i;
+
+  SVN_ERR(writebuf_write_literal(conn, pool, "( put-file ( "));
+  SVN_ERR(write_tuple_cstring(conn, pool, path));
+  SVN_ERR(write_tuple_string(conn, pool, parent_token));
+  SVN_ERR(write_tuple_start_list(conn, pool));
+  for (i = 0; i < props->nelts; i++)
+    {
+      const svn_prop_t *prop = &APR_ARRAY_IDX(props, i, svn_prop_t);
+
+      SVN_ERR(write_tuple_start_list(conn, pool));
+      SVN_ERR(write_tuple_cstring(conn, pool, prop->name));
+      SVN_ERR(write_tuple_start_list(conn, pool));
+      SVN_ERR(write_tuple_string_opt(conn, pool, prop->value));
+      SVN_ERR(write_tuple_end_list(conn, pool));
+      SVN_ERR(write_tuple_end_list(conn, pool));
+    }
+  SVN_ERR(write_tuple_end_list(conn, pool));
+  SVN_ERR(write_tuple_start_list(conn, pool));
+  SVN_ERR(write_tuple_cstring_opt(conn, pool, text_checksum));
+  SVN_ERR(write_tuple_end_list(conn, pool));
+  SVN_ERR(write_tuple_string_opt_list(conn, pool, text));
+  SVN_ERR(writebuf_write_literal(conn, pool, ") ) "));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__write_cmd_open_file(svn_ra_svn_conn_t *conn,
                                 apr_pool_t *pool,
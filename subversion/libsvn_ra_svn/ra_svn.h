@@ -46,6 +46,27 @@ typedef svn_boolean_t (*ra_svn_pending_fn_t)(void *baton);
 /* Callback function that sets the timeout value for a svn_ra_svn__stream_t. */
 typedef void (*ra_svn_timeout_fn_t)(void *baton, apr_interval_time_t timeout);
 
+/* Callback function that writes the NVEC buffers in VEC to a
+ * svn_ra_svn__stream_t with a single vectored write operation, following
+ * apr_socket_sendv() semantics:  as much data as the connection accepts
+ * is written and the number of bytes actually sent is returned in *LEN.
+ */
+typedef svn_error_t *(*ra_svn_writev_fn_t)(void *baton,
+                                           const struct iovec *vec,
+                                           int nvec,
+                                           apr_size_t *len);
+
+/* Callback function that sends *LEN bytes from FILE, starting at *OFFSET,
+ * to a svn_ra_svn__stream_t without copying them through user space,
+ * following apr_socket_sendfile() semantics:  as much data as the
+ * connection accepts is sent, *LEN is updated to the number of bytes
+ * actually sent and *OFFSET is advanced by that amount.
+ */
+typedef svn_error_t *(*ra_svn_sendfile_fn_t)(void *baton,
+                                             apr_file_t *file,
+                                             apr_off_t *offset,
+                                             apr_size_t *len);
+
 /* A stream abstraction for ra_svn.
  *
  * This is different from svn_stream_t in that it provides timeouts and
@@ -67,6 +88,28 @@ typedef svn_error_t *(*ra_svn_block_handler_t)(svn_ra_svn_conn_t *conn,
 #define SVN_RA_SVN__READBUF_SIZE (4 * SVN_RA_SVN__PAGE_SIZE)
 #define SVN_RA_SVN__WRITEBUF_SIZE (4 * SVN_RA_SVN__PAGE_SIZE)
 
+/* Maximum size that the read buffer may adaptively grow to while the
+   other side streams large amounts of data at us. */
+#define SVN_RA_SVN__READBUF_MAX_SIZE (256 * SVN_RA_SVN__PAGE_SIZE)
+
+/* Default number of bytes to write to a connection driving an editor
+   before polling it again for an early error report from the consumer.
+   0 would poll before every single editor command. */
+#define SVN_RA_SVN__ERROR_CHECK_INTERVAL SVN_RA_SVN__PAGE_SIZE
+
+/* Size of a compressed frame header on the wire:  one method byte
+   followed by the payload length as a 32 bit big-endian number. */
+#define SVN_RA_SVN__FRAME_HEADER_SIZE 5
+
+/* Maximum number of protocol bytes carried by a single compressed frame.
+   Larger writes are split into multiple frames. */
+#define SVN_RA_SVN__FRAME_PAYLOAD_SIZE (256 * 1024)
+
+/* Maximum on-the-wire payload size we accept for a single frame.  Even
+   incompressible data only grows by a small integer header when "stored";
+   allow for some slack on top of that. */
+#define SVN_RA_SVN__FRAME_PAYLOAD_MAX (SVN_RA_SVN__FRAME_PAYLOAD_SIZE + 64)
+
 /* Create forward reference */
 typedef struct svn_ra_svn__session_baton_t svn_ra_svn__session_baton_t;
 
@@ -74,13 +117,25 @@ typedef struct svn_ra_svn__session_baton_t svn_ra_svn__session_baton_t;
  * first few fields during setup and cleanup. */
 struct svn_ra_svn_conn_st {
 
-  /* I/O buffers */
+  /* I/O buffers.  The read buffer starts out SVN_RA_SVN__READBUF_SIZE
+     bytes large and grows adaptively up to SVN_RA_SVN__READBUF_MAX_SIZE
+     while the other side keeps saturating it. */
   char write_buf[SVN_RA_SVN__WRITEBUF_SIZE];
-  char read_buf[SVN_RA_SVN__READBUF_SIZE];
+  char *read_buf;
   char *read_ptr;
   char *read_end;
+  apr_size_t read_buf_size;
   apr_size_t write_pos;
 
+  /* Transport frame compression.  If not *_NONE, all bytes passing
+     through the connection are wrapped into compressed frames below
+     the I/O buffers above. */
+  int frame_compression;
+  svn_stringbuf_t *frame_out;     /* compressed outgoing frame payload */
+  svn_stringbuf_t *frame_raw;     /* raw incoming frame payload */
+  svn_stringbuf_t *frame_in;      /* decompressed incoming frame data */
+  apr_size_t frame_in_pos;        /* consumed part of FRAME_IN */
+
   svn_ra_svn__stream_t *stream;
   svn_ra_svn__session_baton_t *session;
 #ifdef SVN_HAVE_SASL
@@ -216,12 +271,51 @@ svn_ra_svn__stream_t *svn_ra_svn__stream_create(svn_stream_t *in_stream,
                                                 ra_svn_timeout_fn_t timeout_cb,
                                                 apr_pool_t *result_pool);
 
+/* Make STREAM use WRITEV_CB with WRITEV_BATON for vectored writes.
+ * Streams without such a callback fall back to plain sequential writes
+ * in svn_ra_svn__stream_writev().
+ */
+void svn_ra_svn__stream_set_writev(svn_ra_svn__stream_t *stream,
+                                   void *writev_baton,
+                                   ra_svn_writev_fn_t writev_cb);
+
+/* Make STREAM use SENDFILE_CB with SENDFILE_BATON for zero-copy file
+ * transmission.  Streams without such a callback report FALSE from
+ * svn_ra_svn__stream_can_sendfile() and the caller must write the file
+ * contents through the ordinary write functions instead.
+ */
+void svn_ra_svn__stream_set_sendfile(svn_ra_svn__stream_t *stream,
+                                     void *sendfile_baton,
+                                     ra_svn_sendfile_fn_t sendfile_cb);
+
+/* Return TRUE if STREAM supports svn_ra_svn__stream_sendfile(). */
+svn_boolean_t svn_ra_svn__stream_can_sendfile(svn_ra_svn__stream_t *stream);
+
 /* Write *LEN bytes from DATA to STREAM, returning the number of bytes
  * written in *LEN.
  */
 svn_error_t *svn_ra_svn__stream_write(svn_ra_svn__stream_t *stream,
                                       const char *data, apr_size_t *len);
 
+/* Write the NVEC buffers in VEC to STREAM, returning the number of bytes
+ * written in *LEN.  Uses a single vectored write where the underlying
+ * connection supports it; otherwise, only the first buffer is written
+ * and the caller is expected to retry with the remainder.
+ */
+svn_error_t *svn_ra_svn__stream_writev(svn_ra_svn__stream_t *stream,
+                                       const struct iovec *vec,
+                                       int nvec, apr_size_t *len);
+
+/* Send *LEN bytes from FILE, starting at *OFFSET, to STREAM, updating
+ * *LEN to the number of bytes actually sent and advancing *OFFSET
+ * accordingly.  The caller must have verified the capability with
+ * svn_ra_svn__stream_can_sendfile() first.
+ */
+svn_error_t *svn_ra_svn__stream_sendfile(svn_ra_svn__stream_t *stream,
+                                         apr_file_t *file,
+                                         apr_off_t *offset,
+                                         apr_size_t *len);
+
 /* Read *LEN bytes from STREAM into DATA, returning the number of bytes
  * read in *LEN.
  */
@@ -42,6 +42,16 @@ struct svn_ra_svn__stream_st {
   svn_stream_t *out_stream;
   void *timeout_baton;
   ra_svn_timeout_fn_t timeout_fn;
+
+  /* Optional vectored write support; NULL for connections that can only
+     write one buffer at a time. */
+  void *writev_baton;
+  ra_svn_writev_fn_t writev_fn;
+
+  /* Optional zero-copy file transmission support; NULL for connections
+     that require file contents to pass through user space. */
+  void *sendfile_baton;
+  ra_svn_sendfile_fn_t sendfile_fn;
 };
 
 typedef struct sock_baton_t {
@@ -135,6 +145,39 @@ sock_write_cb(void *baton, const char *buffer, apr_size_t *len)
   return SVN_NO_ERROR;
 }
 
+/* Implements ra_svn_writev_fn_t */
+static svn_error_t *
+sock_writev_cb(void *baton, const struct iovec *vec, int nvec,
+               apr_size_t *len)
+{
+  sock_baton_t *b = baton;
+  apr_status_t status = apr_socket_sendv(b->sock, vec, nvec, len);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't write to connection"));
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_SENDFILE && !defined(WIN32)
+/* Implements ra_svn_sendfile_fn_t.
+ *
+ * Not used on Windows:  TransmitFile() requires the file to have been
+ * opened with APR_SENDFILE_ENABLED, which the FS layer does not do. */
+static svn_error_t *
+sock_sendfile_cb(void *baton, apr_file_t *file, apr_off_t *offset,
+                 apr_size_t *len)
+{
+  sock_baton_t *b = baton;
+  apr_status_t status = apr_socket_sendfile(b->sock, file, NULL, offset,
+                                            len, 0);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't write to connection"));
+
+  /* apr_socket_sendfile() does not advance *OFFSET itself. */
+  *offset += *len;
+  return SVN_NO_ERROR;
+}
+#endif
+
 /* Implements ra_svn_timeout_fn_t */
 static void
 sock_timeout_cb(void *baton, apr_interval_time_t interval)
@@ -167,6 +210,7 @@ svn_ra_svn__stream_from_sock(apr_socket_t *sock,
 {
   sock_baton_t *b = apr_palloc(result_pool, sizeof(*b));
   svn_stream_t *sock_stream;
+  svn_ra_svn__stream_t *stream;
 
   b->sock = sock;
   b->pool = svn_pool_create(result_pool);
@@ -177,8 +221,14 @@ svn_ra_svn__stream_from_sock(apr_socket_t *sock,
   svn_stream_set_write(sock_stream, sock_write_cb);
   svn_stream_set_data_available(sock_stream, sock_pending_cb);
 
-  return svn_ra_svn__stream_create(sock_stream, sock_stream,
-                                   b, sock_timeout_cb, result_pool);
+  stream = svn_ra_svn__stream_create(sock_stream, sock_stream,
+                                     b, sock_timeout_cb, result_pool);
+  svn_ra_svn__stream_set_writev(stream, b, sock_writev_cb);
+#if APR_HAS_SENDFILE && !defined(WIN32)
+  svn_ra_svn__stream_set_sendfile(stream, b, sock_sendfile_cb);
+#endif
+
+  return stream;
 }
 
 svn_ra_svn__stream_t *
@@ -193,9 +243,47 @@ svn_ra_svn__stream_create(svn_stream_t *in_stream,
   s->out_stream = out_stream;
   s->timeout_baton = timeout_baton;
   s->timeout_fn = timeout_cb;
+  s->writev_baton = NULL;
+  s->writev_fn = NULL;
+  s->sendfile_baton = NULL;
+  s->sendfile_fn = NULL;
   return s;
 }
 
+void
+svn_ra_svn__stream_set_writev(svn_ra_svn__stream_t *stream,
+                              void *writev_baton,
+                              ra_svn_writev_fn_t writev_cb)
+{
+  stream->writev_baton = writev_baton;
+  stream->writev_fn = writev_cb;
+}
+
+void
+svn_ra_svn__stream_set_sendfile(svn_ra_svn__stream_t *stream,
+                                void *sendfile_baton,
+                                ra_svn_sendfile_fn_t sendfile_cb)
+{
+  stream->sendfile_baton = sendfile_baton;
+  stream->sendfile_fn = sendfile_cb;
+}
+
+svn_boolean_t
+svn_ra_svn__stream_can_sendfile(svn_ra_svn__stream_t *stream)
+{
+  return stream->sendfile_fn != NULL;
+}
+
+svn_error_t *
+svn_ra_svn__stream_sendfile(svn_ra_svn__stream_t *stream,
+                            apr_file_t *file, apr_off_t *offset,
+                            apr_size_t *len)
+{
+  SVN_ERR_ASSERT(stream->sendfile_fn != NULL);
+  return svn_error_trace(stream->sendfile_fn(stream->sendfile_baton,
+                                             file, offset, len));
+}
+
 svn_error_t *
 svn_ra_svn__stream_write(svn_ra_svn__stream_t *stream,
                          const char *data, apr_size_t *len)
@@ -203,6 +291,24 @@ svn_ra_svn__stream_write(svn_ra_svn__stream_t *stream,
   return svn_error_trace(svn_stream_write(stream->out_stream, data, len));
 }
 
+svn_error_t *
+svn_ra_svn__stream_writev(svn_ra_svn__stream_t *stream,
+                          const struct iovec *vec, int nvec, apr_size_t *len)
+{
+  if (stream->writev_fn)
+    return svn_error_trace(stream->writev_fn(stream->writev_baton,
+                                             vec, nvec, len));
+
+  /* No vectored write support; write the first non-empty buffer and let
+     the caller retry with whatever remains. */
+  for (; nvec > 1 && vec->iov_len == 0; --nvec)
+    ++vec;
+
+  *len = vec->iov_len;
+  return svn_error_trace(svn_stream_write(stream->out_stream,
+                                          vec->iov_base, len));
+}
+
 svn_error_t *
 svn_ra_svn__stream_read(svn_ra_svn__stream_t *stream, char *data,
                         apr_size_t *len)
@@ -215,6 +215,266 @@ construct_filtered_key(const char *repos_name,
 }
 
 
+/*** Compiled wildcard segment patterns. ***/
+
+/* Kinds of elements in a compiled pattern. */
+typedef enum glob_op_kind_t
+{
+  /* Match the next LEN bytes of the text against LITERAL. */
+  glob_op_literal,
+
+  /* Match exactly one arbitrary byte ('?'). */
+  glob_op_any_char,
+
+  /* Match one byte against the set in BITMAP ("[...]"). */
+  glob_op_class,
+
+  /* Match any number of bytes, including none ('*'). */
+  glob_op_star
+} glob_op_kind_t;
+
+/* A single element of a compiled pattern. */
+typedef struct glob_op_t
+{
+  glob_op_kind_t kind;
+
+  /* glob_op_literal only: the bytes to match.  Points into the interned
+   * pattern, i.e. shares its lifetime. */
+  const char *literal;
+  apr_size_t len;
+
+  /* glob_op_class only: bit N is set iff byte N matches. */
+  apr_uint32_t *bitmap;
+} glob_op_t;
+
+/* A wildcard pattern compiled into a sequence of glob_op_t such that it
+ * can be matched against many strings without re-parsing the pattern
+ * through apr_fnmatch() every time.
+ */
+typedef struct compiled_glob_t
+{
+  /* Array of glob_op_t, in pattern order. */
+  apr_array_header_t *ops;
+} compiled_glob_t;
+
+/* Compile the "[...]" character class starting at P (pointing at '[')
+ * into OP.  END points behind the pattern.  Return the position right
+ * behind the closing ']', or NULL if the class uses constructs that the
+ * compiler does not support.  Allocate the bitmap in RESULT_POOL. */
+static const char *
+compile_glob_class(glob_op_t *op,
+                   const char *p,
+                   const char *end,
+                   apr_pool_t *result_pool)
+{
+  apr_uint32_t *bitmap = apr_pcalloc(result_pool, 8 * sizeof(*bitmap));
+  svn_boolean_t negate = FALSE;
+  svn_boolean_t first = TRUE;
+  const char *q = p + 1;
+
+  if (q < end && *q == '!')
+    {
+      negate = TRUE;
+      ++q;
+    }
+  else if (q < end && *q == '^')
+    {
+      /* Whether '^' negates is unspecified for fnmatch(); defer to the
+       * generic implementation instead of picking an interpretation. */
+      return NULL;
+    }
+
+  while (q < end)
+    {
+      unsigned char c = (unsigned char)*q;
+
+      /* A ']' in the first position is a literal member of the class. */
+      if (c == ']' && !first)
+        break;
+
+      /* Leave "[:alpha:]" etc. to the generic implementation. */
+      if (c == '[' && q + 1 < end && q[1] == ':')
+        return NULL;
+
+      if (q + 2 < end && q[1] == '-' && q[2] != ']')
+        {
+          /* A character range. */
+          unsigned int lo = c;
+          unsigned int hi = (unsigned char)q[2];
+          for (; lo <= hi; ++lo)
+            bitmap[lo / 32] |= ((apr_uint32_t)1 << (lo % 32));
+          q += 3;
+        }
+      else
+        {
+          bitmap[c / 32] |= ((apr_uint32_t)1 << (c % 32));
+          ++q;
+        }
+
+      first = FALSE;
+    }
+
+  /* Unterminated class?  Let apr_fnmatch() decide what that means. */
+  if (q >= end)
+    return NULL;
+
+  if (negate)
+    {
+      int i;
+      for (i = 0; i < 8; ++i)
+        bitmap[i] = ~bitmap[i];
+    }
+
+  op->kind = glob_op_class;
+  op->bitmap = bitmap;
+
+  return q + 1;
+}
+
+/* Compile PATTERN into the representation used by match_compiled_glob().
+ * Return NULL for patterns using constructs that the compiler does not
+ * support; callers shall fall back to apr_fnmatch() for those.
+ * Allocate the result in RESULT_POOL. */
+static compiled_glob_t *
+compile_glob(const svn_string_t *pattern,
+             apr_pool_t *result_pool)
+{
+  compiled_glob_t *result = apr_palloc(result_pool, sizeof(*result));
+  const char *p = pattern->data;
+  const char *end = p + pattern->len;
+
+  result->ops = apr_array_make(result_pool, 4, sizeof(glob_op_t));
+  while (p < end)
+    {
+      glob_op_t *op;
+      char c = *p;
+
+      /* Escapes are rare; leave them to the generic implementation. */
+      if (c == '\\')
+        return NULL;
+
+      op = apr_array_push(result->ops);
+      if (c == '*')
+        {
+          op->kind = glob_op_star;
+
+          /* Consecutive stars are equivalent to a single one. */
+          while (p < end && *p == '*')
+            ++p;
+        }
+      else if (c == '?')
+        {
+          op->kind = glob_op_any_char;
+          ++p;
+        }
+      else if (c == '[')
+        {
+          p = compile_glob_class(op, p, end, result_pool);
+          if (p == NULL)
+            return NULL;
+        }
+      else
+        {
+          /* A run of literal bytes. */
+          const char *start = p;
+          while (p < end && *p != '*' && *p != '?' && *p != '['
+                 && *p != '\\')
+            ++p;
+
+          op->kind = glob_op_literal;
+          op->literal = start;
+          op->len = p - start;
+        }
+    }
+
+  return result;
+}
+
+/* Return TRUE iff the TEXT_LEN bytes at TEXT match the compiled pattern
+ * GLOB.  Equivalent to apr_fnmatch(pattern, text, 0) == 0 for the
+ * pattern that GLOB was compiled from. */
+static svn_boolean_t
+match_compiled_glob(const compiled_glob_t *glob,
+                    const char *text,
+                    apr_size_t text_len)
+{
+  const glob_op_t *ops = (const glob_op_t *)glob->ops->elts;
+  int op_count = glob->ops->nelts;
+  int op = 0;
+  int star_op = -1;
+  const char *s = text;
+  const char *end = text + text_len;
+  const char *star_text = NULL;
+
+  while (TRUE)
+    {
+      if (op < op_count)
+        {
+          const glob_op_t *o = &ops[op];
+
+          switch (o->kind)
+            {
+            case glob_op_star:
+              /* Remember this position to expand the star byte by byte
+               * if the remainder of the pattern doesn't match. */
+              star_op = op;
+              star_text = s;
+              ++op;
+              continue;
+
+            case glob_op_literal:
+              if (   (apr_size_t)(end - s) >= o->len
+                  && memcmp(s, o->literal, o->len) == 0)
+                {
+                  s += o->len;
+                  ++op;
+                  continue;
+                }
+              break;
+
+            case glob_op_any_char:
+              if (s < end)
+                {
+                  ++s;
+                  ++op;
+                  continue;
+                }
+              break;
+
+            case glob_op_class:
+              if (s < end)
+                {
+                  unsigned char c = (unsigned char)*s;
+                  if (o->bitmap[c / 32] & ((apr_uint32_t)1 << (c % 32)))
+                    {
+                      ++s;
+                      ++op;
+                      continue;
+                    }
+                }
+              break;
+            }
+        }
+      else if (s == end)
+        {
+          return TRUE;
+        }
+
+      /* Mismatch.  If there was a star, let it swallow one more byte
+       * and retry; otherwise the pattern cannot match. */
+      if (star_op >= 0 && star_text < end)
+        {
+          ++star_text;
+          s = star_text;
+          op = star_op + 1;
+          continue;
+        }
+
+      return FALSE;
+    }
+}
+
+
 /*** Constructing the prefix tree. ***/
 
 /* Since prefix arrays may have more than one hit, we need to link them
@@ -280,6 +540,11 @@ typedef struct node_t
 
   /* If not NULL, this contains the pattern-based segment sub-nodes. */
   node_pattern_t *pattern_sub_nodes;
+
+  /* For "complex" wildcard segments, SEGMENT compiled into the form used
+   * by match_compiled_glob().  NULL for all other nodes and for the rare
+   * patterns that the compiler does not support. */
+  const compiled_glob_t *compiled_segment;
 } node_t;
 
 /* Create a new tree node for SEGMENT.
@@ -291,7 +556,15 @@ create_node(authz_rule_segment_t *segment,
 {
   node_t *result = apr_pcalloc(result_pool, sizeof(*result));
   if (segment)
-    result->segment = segment->pattern;
+    {
+      result->segment = segment->pattern;
+
+      /* Compile general wildcard patterns once per tree, so the lookup
+       * does not have to run apr_fnmatch() for every path segment. */
+      if (segment->kind == authz_rule_fnmatch)
+        result->compiled_segment = compile_glob(&segment->pattern,
+                                                result_pool);
+    }
   else
     {
       result->segment.data = "";
@@ -1185,7 +1458,15 @@ add_complex_matches(lookup_state_t *state,
   for (i = 0; i < patterns->nelts; ++i)
     {
       node_t *node = APR_ARRAY_IDX(patterns, i, sorted_pattern_t).node;
-      if (0 == apr_fnmatch(node->segment.data, segment->data, 0))
+      svn_boolean_t matches;
+
+      if (node->compiled_segment)
+        matches = match_compiled_glob(node->compiled_segment,
+                                      segment->data, segment->len);
+      else
+        matches = (0 == apr_fnmatch(node->segment.data, segment->data, 0));
+
+      if (matches)
         add_next_node(state, node);
     }
 }
@@ -1456,34 +1737,45 @@ get_user_rules(svn_authz_t *authz,
                const char *user)
 {
   apr_pool_t *pool;
+  authz_user_rules_t *rules;
+  int i;
 
   /* Search our cache for a suitable previously filtered tree. */
-  if (authz->filtered)
-    {
-      /* Is this a suitable filtered tree? */
-      if (matches_filtered_tree(authz->filtered, repos_name, user))
-        return authz->filtered;
+  for (i = 0; i < AUTHZ_FILTERED_CACHE_SIZE && authz->filtered[i]; i++)
+    if (matches_filtered_tree(authz->filtered[i], repos_name, user))
+      {
+        /* Move the entry to the front of the MRU list. */
+        rules = authz->filtered[i];
+        for (; i > 0; i--)
+          authz->filtered[i] = authz->filtered[i - 1];
+        authz->filtered[0] = rules;
 
-      /* Drop the old filtered tree before creating a new one. */
-      svn_pool_destroy(authz->filtered->pool);
-      authz->filtered = NULL;
-    }
+        return rules;
+      }
+
+  /* Evict the least recently used entry, if all slots are taken. */
+  if (authz->filtered[AUTHZ_FILTERED_CACHE_SIZE - 1])
+    svn_pool_destroy(authz->filtered[AUTHZ_FILTERED_CACHE_SIZE - 1]->pool);
+
+  for (i = AUTHZ_FILTERED_CACHE_SIZE - 1; i > 0; i--)
+    authz->filtered[i] = authz->filtered[i - 1];
 
   /* Global cache lookup.  Filter the full model only if necessary. */
   pool = svn_pool_create(authz->pool);
 
   /* Write a new entry. */
-  authz->filtered = apr_palloc(pool, sizeof(*authz->filtered));
-  authz->filtered->pool = pool;
-  authz->filtered->repository = apr_pstrdup(pool, repos_name);
-  authz->filtered->user = user ? apr_pstrdup(pool, user) : NULL;
-  authz->filtered->lookup_state = create_lookup_state(pool);
-  authz->filtered->root = NULL;
-
-  svn_authz__get_global_rights(&authz->filtered->global_rights,
+  rules = apr_palloc(pool, sizeof(*rules));
+  rules->pool = pool;
+  rules->repository = apr_pstrdup(pool, repos_name);
+  rules->user = user ? apr_pstrdup(pool, user) : NULL;
+  rules->lookup_state = create_lookup_state(pool);
+  rules->root = NULL;
+
+  svn_authz__get_global_rights(&rules->global_rights,
                                authz->full, user, repos_name);
 
-  return authz->filtered;
+  authz->filtered[0] = rules;
+  return rules;
 }
 
 /* In AUTHZ's user rules, construct the actual filtered tree.
@@ -1493,9 +1785,10 @@ static svn_error_t *
 filter_tree(svn_authz_t *authz,
             apr_pool_t *scratch_pool)
 {
-  apr_pool_t *pool = authz->filtered->pool;
-  const char *repos_name = authz->filtered->repository;
-  const char *user = authz->filtered->user;
+  authz_user_rules_t *filtered = authz->filtered[0];
+  apr_pool_t *pool = filtered->pool;
+  const char *repos_name = filtered->repository;
+  const char *user = filtered->user;
   node_t *root;
 
   if (filtered_pool)
@@ -1541,7 +1834,7 @@ filter_tree(svn_authz_t *authz,
     }
 
   /* Write a new entry. */
-  authz->filtered->root = root;
+  filtered->root = root;
 
   return SVN_NO_ERROR;
 }
@@ -1742,8 +2035,7 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
     SVN_ERR(filter_tree(authz, pool));
 
   /* Re-use previous lookup results, if possible. */
-  path = init_lockup_state(authz->filtered->lookup_state,
-                           authz->filtered->root, path);
+  path = init_lockup_state(rules->lookup_state, rules->root, path);
 
   /* Sanity check. */
   SVN_ERR_ASSERT(path[0] == '/');
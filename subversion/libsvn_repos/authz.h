@@ -158,6 +158,10 @@ typedef struct authz_full_t
 } authz_full_t;
 
 
+/* Number of (user, repository) combinations for which an svn_authz_t
+   keeps the filtered path rule trees around. */
+#define AUTHZ_FILTERED_CACHE_SIZE 4
+
 /* Dynamic authorization info */
 struct svn_authz_t
 {
@@ -168,9 +172,13 @@ struct svn_authz_t
    * (a hash value that can be used for e.g. cache lookups). */
   svn_membuf_t *authz_id;
 
-  /* Rules filtered for a particular user-repository combination.
-   * May be NULL. */
-  authz_user_rules_t *filtered;
+  /* Small MRU cache of rules filtered for particular user-repository
+   * combinations.  Slot 0 holds the most recently used entry; unused
+   * slots are NULL.  Keeping a few entries here prevents the filtered
+   * trees from being rebuilt over and over when access checks alternate
+   * between a handful of identities, e.g. anonymous and authenticated
+   * checks on the same connection. */
+  authz_user_rules_t *filtered[AUTHZ_FILTERED_CACHE_SIZE];
 
   /* The pool from which all the parsed authz data is allocated.
      This is the RESULT_POOL passed to svn_authz__tng_parse.
@@ -25,9 +25,12 @@
 
 
 #include "svn_checksum.h"
+#include "svn_hash.h"
+#include "svn_io.h"
 #include "svn_path.h"
 #include "svn_pools.h"
 
+#include "private/svn_mutex.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_repos_private.h"
 
@@ -36,6 +39,92 @@
 #include "config_file.h"
 
 
+/* The last known content checksum of a config file, valid only while
+ * the file still has the recorded mtime and size.
+ */
+typedef struct config_checksum_t
+{
+  /* Modification time of the file when its content was read. */
+  apr_time_t mtime;
+
+  /* Size of the file when its content was read. */
+  svn_filesize_t size;
+
+  /* Content checksum read at that point. */
+  svn_checksum_t *checksum;
+} config_checksum_t;
+
+/* The configuration pool, containing the parsed configurations keyed by
+ * content checksum plus a file attribute-validated memo of the checksums
+ * of file-backed configurations.
+ */
+struct svn_repos__config_pool_t
+{
+  /* Holds the read-only parsed configurations. */
+  svn_object_pool__t *object_pool;
+
+  /* Protects CHECKSUMS below. */
+  svn_mutex__t *mutex;
+
+  /* Maps file path (const char *) to config_checksum_t *.
+   * Allocated in POOL. */
+  apr_hash_t *checksums;
+
+  /* The pool that this structure got allocated in. */
+  apr_pool_t *pool;
+};
+
+/* Set *CHECKSUM to a copy of the cached content checksum of PATH in
+ * CONFIG_POOL, if the cache holds one matching the attributes of DIRENT,
+ * or to NULL otherwise.  Allocate the copy in RESULT_POOL.
+ *
+ * To be called with CONFIG_POOL->MUTEX held.
+ */
+static svn_error_t *
+checksum_lookup(svn_checksum_t **checksum,
+                svn_repos__config_pool_t *config_pool,
+                const char *path,
+                const svn_io_dirent2_t *dirent,
+                apr_pool_t *result_pool)
+{
+  config_checksum_t *entry = svn_hash_gets(config_pool->checksums, path);
+
+  if (entry && entry->mtime == dirent->mtime
+            && entry->size == dirent->filesize)
+    *checksum = svn_checksum_dup(entry->checksum, result_pool);
+  else
+    *checksum = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Remember CHECKSUM as the content checksum of PATH in CONFIG_POOL,
+ * valid for the file attributes given in DIRENT.
+ *
+ * To be called with CONFIG_POOL->MUTEX held.
+ */
+static svn_error_t *
+checksum_store(svn_repos__config_pool_t *config_pool,
+               const char *path,
+               const svn_io_dirent2_t *dirent,
+               const svn_checksum_t *checksum)
+{
+  config_checksum_t *entry = svn_hash_gets(config_pool->checksums, path);
+
+  if (entry == NULL)
+    {
+      entry = apr_pcalloc(config_pool->pool, sizeof(*entry));
+      svn_hash_sets(config_pool->checksums,
+                    apr_pstrdup(config_pool->pool, path), entry);
+    }
+
+  entry->mtime = dirent->mtime;
+  entry->size = dirent->filesize;
+  entry->checksum = svn_checksum_dup(checksum, config_pool->pool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Return a memory buffer structure allocated in POOL and containing the
  * data from CHECKSUM.
  */
@@ -70,8 +159,8 @@ find_config(svn_config_t **cfg,
 {
   /* First, attempt the cache lookup. */
   svn_membuf_t *key = checksum_as_key(checksum, scratch_pool);
-  SVN_ERR(svn_object_pool__lookup((void **)cfg, config_pool, key,
-                                  result_pool));
+  SVN_ERR(svn_object_pool__lookup((void **)cfg, config_pool->object_pool,
+                                  key, result_pool));
 
   /* Not found? => parse and cache */
   if (!*cfg)
@@ -79,15 +168,16 @@ find_config(svn_config_t **cfg,
       svn_config_t *config;
 
       /* create a pool for the new config object and parse the data into it */
-      apr_pool_t *cfg_pool = svn_object_pool__new_item_pool(config_pool);
+      apr_pool_t *cfg_pool
+        = svn_object_pool__new_item_pool(config_pool->object_pool);
       SVN_ERR(svn_config_parse(&config, stream, FALSE, FALSE, cfg_pool));
 
       /* switch config data to r/o mode to guarantee thread-safe access */
       svn_config__set_read_only(config, cfg_pool);
 
       /* add config in pool, handle loads races and return the right config */
-      SVN_ERR(svn_object_pool__insert((void **)cfg, config_pool, key,
-                                      config, cfg_pool, result_pool));
+      SVN_ERR(svn_object_pool__insert((void **)cfg, config_pool->object_pool,
+                                      key, config, cfg_pool, result_pool));
     }
 
   return SVN_NO_ERROR;
@@ -100,8 +190,15 @@ svn_repos__config_pool_create(svn_repos__config_pool_t **config_pool,
                               svn_boolean_t thread_safe,
                               apr_pool_t *pool)
 {
-  return svn_error_trace(svn_object_pool__create(config_pool,
-                                                 thread_safe, pool));
+  svn_repos__config_pool_t *result = apr_pcalloc(pool, sizeof(*result));
+
+  SVN_ERR(svn_object_pool__create(&result->object_pool, thread_safe, pool));
+  SVN_ERR(svn_mutex__init(&result->mutex, thread_safe, pool));
+  result->checksums = apr_hash_make(pool);
+  result->pool = pool;
+
+  *config_pool = result;
+  return SVN_NO_ERROR;
 }
 
 svn_error_t *
@@ -114,30 +211,70 @@ svn_repos__config_pool_get(svn_config_t **cfg,
 {
   svn_error_t *err = SVN_NO_ERROR;
   apr_pool_t *scratch_pool = svn_pool_create(pool);
-  config_access_t *access = svn_repos__create_config_access(preferred_repos,
-                                                            scratch_pool);
-  svn_stream_t *stream;
-  svn_checksum_t *checksum;
+  const svn_io_dirent2_t *dirent = NULL;
 
   *cfg = NULL;
-  err = svn_repos__get_config(&stream, &checksum, access, path, must_exist,
-                              scratch_pool);
-  if (!err)
-    err = svn_error_quick_wrapf(find_config(cfg, config_pool, stream,
-                                            checksum, pool, scratch_pool),
-                                "Error while parsing config file: '%s':",
-                                path);
-
-  /* Let the standard implementation handle all the difficult cases.
-   * Note that for in-repo configs, there are no further special cases to
-   * check for and deal with. */
-  if (!*cfg && !svn_path_is_url(path))
+
+  /* For file-backed configs, we may already know the content checksum
+   * from an earlier read.  If the file attributes still match, serve the
+   * parsed config without re-reading the file. */
+  if (!svn_path_is_url(path))
     {
-      svn_error_clear(err);
-      err = svn_config_read3(cfg, path, must_exist, FALSE, FALSE, pool);
+      SVN_ERR(svn_io_stat_dirent2(&dirent, path, FALSE, TRUE,
+                                  scratch_pool, scratch_pool));
+      if (dirent->kind == svn_node_file)
+        {
+          svn_checksum_t *checksum;
+
+          SVN_MUTEX__WITH_LOCK(config_pool->mutex,
+                               checksum_lookup(&checksum, config_pool, path,
+                                               dirent, scratch_pool));
+          if (checksum)
+            SVN_ERR(svn_object_pool__lookup((void **)cfg,
+                                            config_pool->object_pool,
+                                            checksum_as_key(checksum,
+                                                            scratch_pool),
+                                            pool));
+        }
+      else
+        dirent = NULL;
+    }
+
+  if (!*cfg)
+    {
+      config_access_t *access
+        = svn_repos__create_config_access(preferred_repos, scratch_pool);
+      svn_stream_t *stream;
+      svn_checksum_t *checksum;
+
+      err = svn_repos__get_config(&stream, &checksum, access, path,
+                                  must_exist, scratch_pool);
+      if (!err)
+        err = svn_error_quick_wrapf(find_config(cfg, config_pool, stream,
+                                                checksum, pool, scratch_pool),
+                                    "Error while parsing config file: '%s':",
+                                    path);
+
+      /* Remember the content checksum for the attributes found above so
+       * future calls can skip reading the file.  If the file changed
+       * between the stat and the read, the memo is merely conservative. */
+      if (!err && *cfg && dirent)
+        SVN_MUTEX__WITH_LOCK(config_pool->mutex,
+                             checksum_store(config_pool, path, dirent,
+                                            checksum));
+
+      /* Let the standard implementation handle all the difficult cases.
+       * Note that for in-repo configs, there are no further special cases
+       * to check for and deal with. */
+      if (!*cfg && !svn_path_is_url(path))
+        {
+          svn_error_clear(err);
+          err = svn_config_read3(cfg, path, must_exist, FALSE, FALSE, pool);
+        }
+
+      svn_repos__destroy_config_access(access);
     }
 
-  svn_repos__destroy_config_access(access);
   svn_pool_destroy(scratch_pool);
 
   /* we need to duplicate the root structure as it contains temp. buffers */
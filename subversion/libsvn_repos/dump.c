@@ -23,6 +23,8 @@
 
 #include <stdarg.h>
 
+#include <apr_thread_proc.h>
+
 #include "svn_private_config.h"
 #include "svn_pools.h"
 #include "svn_error.h"
@@ -39,9 +41,11 @@
 #include "svn_sorts.h"
 
 #include "private/svn_repos_private.h"
+#include "private/svn_subr_private.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_thread_batch.h"
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
 #include "private/svn_fspath.h"
@@ -1993,6 +1997,104 @@ write_revision_record(svn_stream_t *stream,
   return SVN_NO_ERROR;
 }
 
+/* Dump the tree changes of revision REV in FS, i.e. everything following
+   REV's revision record, to STREAM.  OLDEST_DUMPED_REV is the first
+   revision of the dumpstream; references to older revisions get reported
+   through FOUND_OLD_REFERENCE / FOUND_OLD_MERGEINFO and NOTIFY_FUNC /
+   NOTIFY_BATON as described for svn_repos_dump_fs5.
+
+   If USE_DELTAS is set, dump property and text deltas.  If FULL_TREE is
+   set, dump the complete tree as of REV rather than just the paths
+   changed in REV (used for the first revision of a non-incremental
+   dump).  AUTHZ_FUNC / AUTHZ_BATON implement dump filtering and may be
+   NULL.  Use POOL for temporary allocations. */
+static svn_error_t *
+dump_revision_changes(svn_fs_t *fs,
+                      svn_revnum_t rev,
+                      svn_revnum_t oldest_dumped_rev,
+                      svn_stream_t *stream,
+                      svn_boolean_t use_deltas,
+                      svn_boolean_t full_tree,
+                      svn_boolean_t *found_old_reference,
+                      svn_boolean_t *found_old_mergeinfo,
+                      svn_repos_authz_func_t authz_func,
+                      void *authz_baton,
+                      svn_repos_notify_func_t notify_func,
+                      void *notify_baton,
+                      apr_pool_t *pool)
+{
+  const svn_delta_editor_t *dump_editor;
+  void *dump_edit_baton;
+  svn_fs_root_t *to_root;
+
+  SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, pool));
+
+  /* When filtering, a revision that changed only excluded paths will
+     produce no output besides the revision record.  Detect that from
+     the cheap changed-paths list and skip the editor drive entirely. */
+  if (authz_func && !full_tree)
+    {
+      svn_fs_path_change_iterator_t *iterator;
+      svn_fs_path_change3_t *change;
+      svn_boolean_t included = FALSE;
+      apr_pool_t *iterpool = svn_pool_create(pool);
+
+      SVN_ERR(svn_fs_paths_changed3(&iterator, to_root, pool, pool));
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+      while (change && !included)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(authz_func(&included, to_root,
+                             svn_fspath__canonicalize(change->path.data,
+                                                      iterpool),
+                             authz_baton, iterpool));
+          SVN_ERR(svn_fs_path_change_get(&change, iterator));
+        }
+      svn_pool_destroy(iterpool);
+
+      if (!included)
+        return SVN_NO_ERROR;
+    }
+
+  /* Fetch the editor which dumps nodes to a file. */
+  SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
+                          "", stream, found_old_reference,
+                          found_old_mergeinfo, NULL,
+                          notify_func, notify_baton,
+                          oldest_dumped_rev, use_deltas, FALSE, FALSE,
+                          pool));
+
+  /* Drive the editor in one way or another. */
+  if (full_tree)
+    {
+      /* Compare against revision 0, so everything appears to be added. */
+      svn_fs_root_t *from_root;
+      SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, pool));
+      SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
+                                   to_root, "",
+                                   dump_editor, dump_edit_baton,
+                                   authz_func, authz_baton,
+                                   FALSE, /* don't send text-deltas */
+                                   svn_depth_infinity,
+                                   FALSE, /* don't send entry props */
+                                   FALSE, /* don't ignore ancestry */
+                                   pool));
+    }
+  else
+    {
+      /* The normal case: compare consecutive revs. */
+      SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
+                                dump_editor, dump_edit_baton,
+                                authz_func, authz_baton, pool));
+
+      /* While our editor close_edit implementation is a no-op, we still
+         do this for completeness. */
+      SVN_ERR(dump_editor->close_edit(dump_edit_baton, pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Baton for dump_filter_authz_func(). */
 typedef struct dump_filter_baton_t
 {
@@ -2019,11 +2121,509 @@ dump_filter_authz_func(svn_boolean_t *allowed,
                                         pool));
 }
 
+/*----------------------------------------------------------------------*/
+
+/* Framed-zstd dump container writer, cf. SVN_REPOS__DUMP_ZSTD_MAGIC in
+   svn_repos_private.h for the file layout. */
+
+/* Baton for the framed container writer stream. */
+typedef struct framed_dump_baton_t
+{
+  /* The stream receiving the container bytes. */
+  svn_stream_t *target;
+
+  /* Number of bytes written to TARGET so far, i.e. the absolute offset
+     of the next byte to write. */
+  apr_off_t offset;
+
+  /* Uncompressed data pending for the current block.  Never grows
+     beyond SVN_REPOS__DUMP_ZSTD_BLOCK_SIZE. */
+  svn_stringbuf_t *buffer;
+
+  /* Reusable result buffer for svn__compress_zstd(). */
+  svn_stringbuf_t *compressed;
+
+  /* The revision index being accumulated, one line per revision. */
+  svn_stringbuf_t *index;
+
+  /* Pool that the above buffers got allocated in. */
+  apr_pool_t *pool;
+} framed_dump_baton_t;
+
+/* Write VALUE into the SIZE bytes at BUF in big-endian order. */
+static void
+framed_dump_encode_uint(unsigned char *buf,
+                        apr_size_t size,
+                        apr_uint64_t value)
+{
+  apr_size_t i;
+
+  for (i = size; i > 0; --i)
+    {
+      buf[i - 1] = (unsigned char)(value & 0xff);
+      value >>= 8;
+    }
+}
+
+/* Compress the data pending in BATON's block buffer and write it as the
+   next block of the container.  No-op if the buffer is empty. */
+static svn_error_t *
+framed_dump_flush_block(framed_dump_baton_t *baton)
+{
+  unsigned char header[4];
+  apr_size_t len;
+
+  if (baton->buffer->len == 0)
+    return SVN_NO_ERROR;
+
+  svn_stringbuf_setempty(baton->compressed);
+  SVN_ERR(svn__compress_zstd(baton->buffer->data, baton->buffer->len,
+                             baton->compressed,
+                             SVN__COMPRESSION_ZSTD_DEFAULT));
+
+  framed_dump_encode_uint(header, sizeof(header), baton->compressed->len);
+  len = sizeof(header);
+  SVN_ERR(svn_stream_write(baton->target, (const char *)header, &len));
+
+  len = baton->compressed->len;
+  SVN_ERR(svn_stream_write(baton->target, baton->compressed->data, &len));
+
+  baton->offset += sizeof(header) + (apr_off_t)baton->compressed->len;
+  svn_stringbuf_setempty(baton->buffer);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_write_fn_t, writing DATA into BATON's block buffer and
+   flushing completed blocks. */
+static svn_error_t *
+framed_dump_write(void *baton,
+                  const char *data,
+                  apr_size_t *len)
+{
+  framed_dump_baton_t *b = baton;
+  apr_size_t remaining = *len;
+
+  while (remaining)
+    {
+      apr_size_t chunk = SVN_REPOS__DUMP_ZSTD_BLOCK_SIZE - b->buffer->len;
+      if (chunk > remaining)
+        chunk = remaining;
+
+      svn_stringbuf_appendbytes(b->buffer, data, chunk);
+      data += chunk;
+      remaining -= chunk;
+
+      if (b->buffer->len == SVN_REPOS__DUMP_ZSTD_BLOCK_SIZE)
+        SVN_ERR(framed_dump_flush_block(b));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Note in BATON that the records for revision REVISION follow.  This
+   terminates the current block, so that decompression of REVISION may
+   later start right at the indexed offset, and appends the index line.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+framed_dump_start_revision(framed_dump_baton_t *baton,
+                           svn_revnum_t revision,
+                           apr_pool_t *scratch_pool)
+{
+  SVN_ERR(framed_dump_flush_block(baton));
+  svn_stringbuf_appendcstr(baton->index,
+                           apr_psprintf(scratch_pool,
+                                        "%ld %" APR_OFF_T_FMT "\n",
+                                        revision, baton->offset));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t.  Flush pending data and write the
+   terminating zero-sized block, the revision index and the trailer. */
+static svn_error_t *
+framed_dump_close(void *baton)
+{
+  framed_dump_baton_t *b = baton;
+  unsigned char header[8];
+  apr_off_t index_offset;
+  apr_size_t len;
+
+  SVN_ERR(framed_dump_flush_block(b));
+
+  /* A zero-sized block marks the end of the compressed data. */
+  framed_dump_encode_uint(header, 4, 0);
+  len = 4;
+  SVN_ERR(svn_stream_write(b->target, (const char *)header, &len));
+  b->offset += 4;
+
+  index_offset = b->offset;
+  len = b->index->len;
+  SVN_ERR(svn_stream_write(b->target, b->index->data, &len));
+
+  framed_dump_encode_uint(header, sizeof(header),
+                          (apr_uint64_t)index_offset);
+  len = sizeof(header);
+  SVN_ERR(svn_stream_write(b->target, (const char *)header, &len));
+
+  len = strlen(SVN_REPOS__DUMP_ZSTD_TRAILER_MAGIC);
+  SVN_ERR(svn_stream_write(b->target, SVN_REPOS__DUMP_ZSTD_TRAILER_MAGIC,
+                           &len));
+
+  return svn_error_trace(svn_stream_close(b->target));
+}
+
+/* Set *DUMP_STREAM to a writable stream that wraps everything written
+   to it into a framed-zstd dump container on TARGET, writing the
+   leading magic right away.  Return the writer baton in *BATON so that
+   the dump loop can mark revision boundaries via
+   framed_dump_start_revision().  Allocate both in POOL. */
+static svn_error_t *
+framed_dump_stream_create(svn_stream_t **dump_stream,
+                          framed_dump_baton_t **baton,
+                          svn_stream_t *target,
+                          apr_pool_t *pool)
+{
+  framed_dump_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  svn_stream_t *stream;
+  apr_size_t len = strlen(SVN_REPOS__DUMP_ZSTD_MAGIC);
+
+  b->target = target;
+  b->buffer = svn_stringbuf_create_ensure(SVN_REPOS__DUMP_ZSTD_BLOCK_SIZE,
+                                          pool);
+  b->compressed = svn_stringbuf_create_empty(pool);
+  b->index = svn_stringbuf_create_empty(pool);
+  b->pool = pool;
+
+  SVN_ERR(svn_stream_write(target, SVN_REPOS__DUMP_ZSTD_MAGIC, &len));
+  b->offset = (apr_off_t)len;
+
+  stream = svn_stream_create(b, pool);
+  svn_stream_set_write(stream, framed_dump_write);
+  svn_stream_set_close(stream, framed_dump_close);
+
+  *dump_stream = stream;
+  *baton = b;
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+/* In-memory size of a revision's record buffer; beyond that, the buffer
+ * spills to a temporary file. */
+#define DUMP_BUFFER_BLOCKSIZE 0x10000
+#define DUMP_BUFFER_MAXSIZE   0x400000
+
+/* Baton for dump_revision_task(), holding everything the worker thread
+ * needs to produce the dumpstream records of a single revision. */
+typedef struct dump_task_baton_t
+{
+  /* Path and FS configuration of the dumped repository.  Each task
+     opens a private svn_repos_t because FS objects must not be shared
+     between threads. */
+  const char *repos_path;
+  apr_hash_t *fs_config;
+
+  /* Dump filtering callbacks; may be NULL.  They are invoked
+     concurrently from multiple worker threads and must be reentrant. */
+  svn_repos_authz_func_t authz_func;
+  void *authz_baton;
+
+  /* The revision to dump and the first revision of the dumpstream. */
+  svn_revnum_t rev;
+  svn_revnum_t oldest_dumped_rev;
+
+  /* How to dump REV; see svn_repos_dump_fs5. */
+  svn_boolean_t use_deltas;
+  svn_boolean_t full_tree;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+
+  /* Spill buffer receiving REV's dumpstream records, wrapped in a
+     stream for the dump editor to write to. */
+  svn_spillbuf_t *buffer;
+  svn_stream_t *stream;
+
+  /* Notifications that dumping REV would have sent; replayed by the
+     main thread, in revision order.  Elements are svn_repos_notify_t *,
+     allocated in POOL. */
+  apr_array_header_t *notifications;
+
+  /* Results of the old-reference checks for REV. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+
+  /* Private root pool of this task, with a thread-safe allocator. */
+  apr_pool_t *pool;
+} dump_task_baton_t;
+
+/* Implements svn_repos_notify_func_t, recording a copy of NOTIFY in
+ * BATON, a dump_task_baton_t, for later replay by the main thread. */
+static void
+dump_task_notify_func(void *baton,
+                      const svn_repos_notify_t *notify,
+                      apr_pool_t *scratch_pool)
+{
+  dump_task_baton_t *task = baton;
+  svn_repos_notify_t *copy = apr_pmemdup(task->pool, notify,
+                                         sizeof(*notify));
+
+  if (copy->warning_str)
+    copy->warning_str = apr_pstrdup(task->pool, copy->warning_str);
+  if (copy->path)
+    copy->path = apr_pstrdup(task->pool, copy->path);
+
+  APR_ARRAY_PUSH(task->notifications, svn_repos_notify_t *) = copy;
+}
+
+/* The work-horse of a dump task: write TASK->REV's revision record and
+ * tree changes into TASK->BUFFER. */
+static svn_error_t *
+dump_task_body(dump_task_baton_t *task)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+
+  SVN_ERR(svn_repos_open3(&repos, task->repos_path, task->fs_config,
+                          task->pool, task->pool));
+  fs = svn_repos_fs(repos);
+
+  /* Write the revision record. */
+  SVN_ERR(write_revision_record(task->stream, repos, task->rev,
+                                task->include_revprops,
+                                task->authz_func, task->authz_baton,
+                                task->pool));
+
+  /* When dumping revision 0, we just write out the revision record. */
+  if (task->rev == 0 || !task->include_changes)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(dump_revision_changes(fs, task->rev,
+                                               task->oldest_dumped_rev,
+                                               task->stream,
+                                               task->use_deltas,
+                                               task->full_tree,
+                                               &task->found_old_reference,
+                                               &task->found_old_mergeinfo,
+                                               task->authz_func,
+                                               task->authz_baton,
+                                               dump_task_notify_func, task,
+                                               task->pool));
+}
+
+/* Implements svn_thread_batch__work_func_t.  Dump the revision
+ * described by BATON, a dump_task_baton_t. */
+static svn_error_t *
+dump_revision_task(void *baton,
+                   apr_pool_t *task_pool)
+{
+  return svn_error_trace(dump_task_body(baton));
+}
+
+/* Baton for the task dispatcher callbacks, carrying the parameters of
+ * dump_revisions_concurrently() plus the revision cursor. */
+typedef struct dump_batch_baton_t
+{
+  const char *repos_path;
+  apr_hash_t *fs_config;
+  svn_stream_t *stream;
+  framed_dump_baton_t *framed_writer;
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+  svn_boolean_t incremental;
+  svn_boolean_t use_deltas;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+  svn_boolean_t *found_old_reference;
+  svn_boolean_t *found_old_mergeinfo;
+  svn_repos_authz_func_t authz_func;
+  void *authz_baton;
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+
+  /* Next revision to dispatch a task for. */
+  svn_revnum_t next_rev;
+
+  /* Reusable "revision completed" notification; NULL iff NOTIFY_FUNC
+     is NULL. */
+  svn_repos_notify_t *notify;
+} dump_batch_baton_t;
+
+/* Implements svn_thread_batch__init_func_t with CONTEXT being a
+ * dump_batch_baton_t.  Describe the dumping of the next revision in
+ * *BATON. */
+static svn_error_t *
+init_dump_task(void **baton,
+               void *context,
+               apr_pool_t *task_pool,
+               apr_pool_t *scratch_pool)
+{
+  dump_batch_baton_t *bb = context;
+  dump_task_baton_t *task;
+
+  if (bb->next_rev > bb->end_rev)
+    return SVN_NO_ERROR;
+
+  task = apr_pcalloc(task_pool, sizeof(*task));
+  task->pool = task_pool;
+  task->repos_path = apr_pstrdup(task_pool, bb->repos_path);
+  task->fs_config = bb->fs_config;
+  task->authz_func = bb->authz_func;
+  task->authz_baton = bb->authz_baton;
+  task->rev = bb->next_rev;
+  task->oldest_dumped_rev = bb->start_rev;
+
+  /* Regardless of what we've been told, don't use deltas for the
+     first rev of a non-incremental dump. */
+  task->use_deltas = bb->use_deltas
+                     && (bb->incremental || task->rev != bb->start_rev);
+  task->full_tree = (task->rev == bb->start_rev) && !bb->incremental;
+  task->include_revprops = bb->include_revprops;
+  task->include_changes = bb->include_changes;
+  task->buffer = svn_spillbuf__create(DUMP_BUFFER_BLOCKSIZE,
+                                      DUMP_BUFFER_MAXSIZE,
+                                      task_pool);
+  task->stream = svn_stream__from_spillbuf(task->buffer, task_pool);
+  task->notifications
+    = apr_array_make(task_pool, 0, sizeof(svn_repos_notify_t *));
+  ++bb->next_rev;
+
+  *baton = task;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_batch__process_func_t with CONTEXT being a
+ * dump_batch_baton_t.  Emit the records buffered by TASKS strictly in
+ * revision order, replaying the notifications each revision would have
+ * sent. */
+static svn_error_t *
+process_dumped_tasks(apr_array_header_t *tasks,
+                     void *context,
+                     apr_pool_t *scratch_pool)
+{
+  dump_batch_baton_t *bb = context;
+  int i;
+
+  SVN_ERR(svn_thread_batch__collect(tasks));
+
+  for (i = 0; i < tasks->nelts; ++i)
+    {
+      dump_task_baton_t *task
+        = APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *)->baton;
+      const char *data;
+      apr_size_t len;
+      int k;
+
+      /* Each revision starts its own container segment, so that a
+         seeking reader can start decompression right here. */
+      if (bb->framed_writer)
+        SVN_ERR(framed_dump_start_revision(bb->framed_writer, task->rev,
+                                           scratch_pool));
+
+      do
+        {
+          SVN_ERR(svn_spillbuf__read(&data, &len, task->buffer,
+                                     scratch_pool));
+          if (data)
+            SVN_ERR(svn_stream_write(bb->stream, data, &len));
+        }
+      while (data);
+
+      *bb->found_old_reference |= task->found_old_reference;
+      *bb->found_old_mergeinfo |= task->found_old_mergeinfo;
+
+      if (bb->notify_func)
+        {
+          for (k = 0; k < task->notifications->nelts; ++k)
+            bb->notify_func(bb->notify_baton,
+                            APR_ARRAY_IDX(task->notifications, k,
+                                          svn_repos_notify_t *),
+                            scratch_pool);
+
+          /* Tell the caller that we're done with this revision. */
+          bb->notify->revision = task->rev;
+          bb->notify_func(bb->notify_baton, bb->notify, scratch_pool);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Dump revisions START_REV to END_REV of REPOS's filesystem to STREAM,
+ * producing the records of up to NUM_THREADS revisions concurrently
+ * while this thread emits them strictly in revision order.  The
+ * parameters match svn_repos_dump_fs5; AUTHZ_FUNC / AUTHZ_BATON
+ * implement dump filtering, may be NULL and will be invoked from
+ * multiple threads concurrently.  Notifications are replayed from this
+ * thread, in revision order.  Use POOL for temporary allocations.
+ *
+ * If FRAMED_WRITER is non-NULL, STREAM is a framed container stream and
+ * revision boundaries are marked on it before each revision's records
+ * get emitted.
+ */
+static svn_error_t *
+dump_revisions_concurrently(svn_repos_t *repos,
+                            svn_stream_t *stream,
+                            framed_dump_baton_t *framed_writer,
+                            svn_revnum_t start_rev,
+                            svn_revnum_t end_rev,
+                            svn_boolean_t incremental,
+                            svn_boolean_t use_deltas,
+                            svn_boolean_t include_revprops,
+                            svn_boolean_t include_changes,
+                            apr_size_t num_threads,
+                            svn_boolean_t *found_old_reference,
+                            svn_boolean_t *found_old_mergeinfo,
+                            svn_repos_authz_func_t authz_func,
+                            void *authz_baton,
+                            svn_repos_notify_func_t notify_func,
+                            void *notify_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  dump_batch_baton_t baton;
+
+  baton.repos_path = svn_repos_path(repos, pool);
+  baton.fs_config = svn_fs_config(fs, pool);
+  baton.stream = stream;
+  baton.framed_writer = framed_writer;
+  baton.start_rev = start_rev;
+  baton.end_rev = end_rev;
+  baton.incremental = incremental;
+  baton.use_deltas = use_deltas;
+  baton.include_revprops = include_revprops;
+  baton.include_changes = include_changes;
+  baton.found_old_reference = found_old_reference;
+  baton.found_old_mergeinfo = found_old_mergeinfo;
+  baton.authz_func = authz_func;
+  baton.authz_baton = authz_baton;
+  baton.notify_func = notify_func;
+  baton.notify_baton = notify_baton;
+  baton.next_rev = start_rev;
+
+  /* Create a notify object that we can reuse for every revision. */
+  baton.notify = notify_func
+                 ? svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                           pool)
+                 : NULL;
+
+  return svn_error_trace(svn_thread_batch__run(num_threads,
+                                               init_dump_task,
+                                               dump_revision_task,
+                                               process_dumped_tasks,
+                                               &baton,
+                                               cancel_func, cancel_baton,
+                                               pool));
+}
+#endif /* APR_HAS_THREADS */
+
 
 
 /* The main dumper. */
 svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
+svn_repos_dump_fs5(svn_repos_t *repos,
                    svn_stream_t *stream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
@@ -2031,6 +2631,8 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_boolean_t use_deltas,
                    svn_boolean_t include_revprops,
                    svn_boolean_t include_changes,
+                   apr_size_t num_threads,
+                   svn_boolean_t compress,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_repos_dump_filter_func_t filter_func,
@@ -2039,8 +2641,6 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    void *cancel_baton,
                    apr_pool_t *pool)
 {
-  const svn_delta_editor_t *dump_editor;
-  void *dump_edit_baton = NULL;
   svn_revnum_t rev;
   svn_fs_t *fs = svn_repos_fs(repos);
   apr_pool_t *iterpool = svn_pool_create(pool);
@@ -2052,6 +2652,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   svn_repos_notify_t *notify;
   svn_repos_authz_func_t authz_func;
   dump_filter_baton_t authz_baton = {0};
+  framed_dump_baton_t *framed_writer = NULL;
 
   /* Make sure we catch up on the latest revprop changes.  This is the only
    * time we will refresh the revprop data in this query. */
@@ -2094,6 +2695,14 @@ svn_repos_dump_fs4(svn_repos_t *repos,
       authz_func = NULL;
     }
 
+  /* If requested, compress the emitted records into a framed zstd
+     container.  The caller's stream is disowned so that finalizing the
+     container at the end does not close it. */
+  if (compress)
+    SVN_ERR(framed_dump_stream_create(&stream, &framed_writer,
+                                      svn_stream_disown(stream, pool),
+                                      pool));
+
   /* Write out the UUID. */
   SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
 
@@ -2113,10 +2722,30 @@ svn_repos_dump_fs4(svn_repos_t *repos,
     notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
                                      pool);
 
+#if APR_HAS_THREADS
+  /* If so configured, produce the per-revision records concurrently. */
+  if (num_threads > 1)
+    {
+      /* Sanitize */
+      if (num_threads > 64)
+        num_threads = 64;
+
+      SVN_ERR(dump_revisions_concurrently(repos, stream, framed_writer,
+                                          start_rev, end_rev,
+                                          incremental, use_deltas,
+                                          include_revprops, include_changes,
+                                          num_threads,
+                                          &found_old_reference,
+                                          &found_old_mergeinfo,
+                                          authz_func, &authz_baton,
+                                          notify_func, notify_baton,
+                                          cancel_func, cancel_baton, pool));
+    }
+  else
+#endif
   /* Main loop:  we're going to dump revision REV.  */
   for (rev = start_rev; rev <= end_rev; rev++)
     {
-      svn_fs_root_t *to_root;
       svn_boolean_t use_deltas_for_rev;
 
       svn_pool_clear(iterpool);
@@ -2125,6 +2754,11 @@ svn_repos_dump_fs4(svn_repos_t *repos,
       if (cancel_func)
         SVN_ERR(cancel_func(cancel_baton));
 
+      /* Each revision starts its own container segment, so that a
+         seeking reader can start decompression right here. */
+      if (framed_writer)
+        SVN_ERR(framed_dump_start_revision(framed_writer, rev, iterpool));
+
       /* Write the revision record. */
       SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
                                     authz_func, &authz_baton, iterpool));
@@ -2135,49 +2769,17 @@ svn_repos_dump_fs4(svn_repos_t *repos,
       if (rev == 0 || !include_changes)
         goto loop_end;
 
-      /* Fetch the editor which dumps nodes to a file.  Regardless of
-         what we've been told, don't use deltas for the first rev of a
-         non-incremental dump. */
+      /* Dump the revision contents.  Regardless of what we've been told,
+         don't use deltas for the first rev of a non-incremental dump. */
       use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
-      SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
-                              notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
-
-      /* Drive the editor in one way or another. */
-      SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
-
-      /* If this is the first revision of a non-incremental dump,
-         we're in for a full tree dump.  Otherwise, we want to simply
-         replay the revision.  */
-      if ((rev == start_rev) && (! incremental))
-        {
-          /* Compare against revision 0, so everything appears to be added. */
-          svn_fs_root_t *from_root;
-          SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, iterpool));
-          SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
-                                       to_root, "",
-                                       dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
-                                       FALSE, /* don't send text-deltas */
-                                       svn_depth_infinity,
-                                       FALSE, /* don't send entry props */
-                                       FALSE, /* don't ignore ancestry */
-                                       iterpool));
-        }
-      else
-        {
-          /* The normal case: compare consecutive revs. */
-          SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
-                                    dump_editor, dump_edit_baton,
-                                    authz_func, &authz_baton, iterpool));
-
-          /* While our editor close_edit implementation is a no-op, we still
-             do this for completeness. */
-          SVN_ERR(dump_editor->close_edit(dump_edit_baton, iterpool));
-        }
+      SVN_ERR(dump_revision_changes(fs, rev, start_rev, stream,
+                                    use_deltas_for_rev,
+                                    (rev == start_rev) && (! incremental),
+                                    &found_old_reference,
+                                    &found_old_mergeinfo,
+                                    authz_func, &authz_baton,
+                                    notify_func, notify_baton,
+                                    iterpool));
 
     loop_end:
       if (notify_func)
@@ -2220,6 +2822,11 @@ svn_repos_dump_fs4(svn_repos_t *repos,
         }
     }
 
+  /* Finalize the container: flush pending data and append the revision
+     index and trailer. */
+  if (compress)
+    SVN_ERR(svn_stream_close(stream));
+
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
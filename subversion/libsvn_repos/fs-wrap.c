@@ -36,6 +36,7 @@
 #include "svn_subst.h"
 #include "repos.h"
 #include "svn_private_config.h"
+#include "private/svn_fs_private.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_utf_private.h"
@@ -1063,52 +1064,48 @@ svn_repos_fs_get_inherited_props(apr_array_header_t **inherited_props_p,
 {
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_array_header_t *inherited_props;
-  const char *parent_path = path;
+  apr_array_header_t *all_iprops;
+  int i;
+
+  /* Fetch the (possibly cached) pre-authz rollup from the FS layer. */
+  SVN_ERR(svn_fs__get_inherited_props(&all_iprops, root, path,
+                                      result_pool, scratch_pool));
 
-  inherited_props = apr_array_make(result_pool, 1,
+  /* Apply authz and the optional PROPNAME filter.  The returned items
+     are freshly allocated per call, so adjusting them in place is OK. */
+  inherited_props = apr_array_make(result_pool, all_iprops->nelts,
                                    sizeof(svn_prop_inherited_item_t *));
-  while (!(parent_path[0] == '/' && parent_path[1] == '\0'))
+  for (i = 0; i < all_iprops->nelts; i++)
     {
+      svn_prop_inherited_item_t *i_props
+        = APR_ARRAY_IDX(all_iprops, i, svn_prop_inherited_item_t *);
       svn_boolean_t allowed = TRUE;
-      apr_hash_t *parent_properties = NULL;
 
       svn_pool_clear(iterpool);
-      parent_path = svn_fspath__dirname(parent_path, scratch_pool);
 
       if (authz_read_func)
-        SVN_ERR(authz_read_func(&allowed, root, parent_path,
+        SVN_ERR(authz_read_func(&allowed, root,
+                                apr_pstrcat(iterpool, "/",
+                                            i_props->path_or_url,
+                                            SVN_VA_NULL),
                                 authz_read_baton, iterpool));
-      if (allowed)
+      if (!allowed)
+        continue;
+
+      if (propname)
         {
-          if (propname)
-            {
-              svn_string_t *propval;
+          svn_string_t *propval = svn_hash_gets(i_props->prop_hash, propname);
+          apr_hash_t *parent_properties;
 
-              SVN_ERR(svn_fs_node_prop(&propval, root, parent_path, propname,
-                                       result_pool));
-              if (propval)
-                {
-                  parent_properties = apr_hash_make(result_pool);
-                  svn_hash_sets(parent_properties, propname, propval);
-                }
-            }
-          else
-            {
-              SVN_ERR(svn_fs_node_proplist(&parent_properties, root,
-                                           parent_path, result_pool));
-            }
+          if (!propval)
+            continue;
 
-          if (parent_properties && apr_hash_count(parent_properties))
-            {
-              svn_prop_inherited_item_t *i_props =
-                apr_pcalloc(result_pool, sizeof(*i_props));
-              i_props->path_or_url =
-                apr_pstrdup(result_pool, parent_path + 1);
-              i_props->prop_hash = parent_properties;
-              /* Build the output array in depth-first order. */
-              SVN_ERR(svn_sort__array_insert2(inherited_props, &i_props, 0));
-            }
+          parent_properties = apr_hash_make(result_pool);
+          svn_hash_sets(parent_properties, propname, propval);
+          i_props->prop_hash = parent_properties;
         }
+
+      APR_ARRAY_PUSH(inherited_props, svn_prop_inherited_item_t *) = i_props;
     }
 
   svn_pool_destroy(iterpool);
@@ -26,6 +26,7 @@
 
 #include <apr_pools.h>
 #include <apr_file_io.h>
+#include <apr_thread_proc.h>
 
 #include "svn_config.h"
 #include "svn_hash.h"
@@ -302,6 +303,186 @@ create_temp_file(apr_file_t **f, const svn_string_t *value, apr_pool_t *pool)
 }
 
 
+/* Return TRUE if the hooks-env configuration HOOKS_ENV requests
+   asynchronous dispatch for the hook NAME, i.e. if the environment that
+   applies to NAME sets SVN_REPOS__HOOKS_ENV_ASYNC to a true boolean
+   value.  Builds without thread support always run hooks synchronously. */
+static svn_boolean_t
+hook_is_async(apr_hash_t *hooks_env, const char *name)
+{
+#if APR_HAS_THREADS
+  apr_hash_t *hook_env = NULL;
+  const char *value = NULL;
+
+  if (hooks_env)
+    {
+      hook_env = svn_hash_gets(hooks_env, name);
+      if (hook_env == NULL)
+        hook_env = svn_hash_gets(hooks_env,
+                                 SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION);
+    }
+  if (hook_env)
+    value = svn_hash_gets(hook_env, SVN_REPOS__HOOKS_ENV_ASYNC);
+
+  return value
+         && (svn_cstring_casecmp(value, "yes") == 0
+             || svn_cstring_casecmp(value, "true") == 0
+             || svn_cstring_casecmp(value, "on") == 0
+             || strcmp(value, "1") == 0);
+#else
+  return FALSE;
+#endif
+}
+
+#if APR_HAS_THREADS
+/* Everything run_hook_thread() needs to know, allocated in the thread's
+   private root pool. */
+struct run_hook_thread_baton
+{
+  /* The thread's root pool, destroyed by the thread when it is done. */
+  apr_pool_t *pool;
+
+  /* Name of and path to the hook program plus its argument vector and
+     environment, see run_hook_cmd(). */
+  const char *name;
+  const char *cmd;
+  const char **args;
+  const char **env;
+
+  /* Content to pass to the hook's stdin, or NULL for no stdin. */
+  svn_string_t *stdin_value;
+};
+
+/* Thread function running a post-* hook to completion.  There is nobody
+   left to report hook failures to at this point, so errors are simply
+   discarded. */
+static void * APR_THREAD_FUNC
+run_hook_thread(apr_thread_t *thread, void *data)
+{
+  struct run_hook_thread_baton *baton = data;
+  apr_file_t *stdin_handle;
+  apr_file_t *null_handle = NULL;
+  apr_proc_t cmd_proc = {0};
+  apr_status_t apr_err;
+  svn_error_t *err;
+
+  if (baton->stdin_value)
+    err = create_temp_file(&stdin_handle, baton->stdin_value, baton->pool);
+  else
+    err = svn_io_file_open(&stdin_handle, SVN_NULL_DEVICE_NAME,
+                           APR_READ, APR_OS_DEFAULT, baton->pool);
+
+  /* Redirect stdout to the null device, just like run_hook_cmd(). */
+  if (!err)
+    {
+      apr_err = apr_file_open(&null_handle, SVN_NULL_DEVICE_NAME, APR_WRITE,
+                              APR_OS_DEFAULT, baton->pool);
+      if (apr_err)
+        err = svn_error_wrap_apr
+          (apr_err, _("Can't create null stdout for hook '%s'"), baton->cmd);
+    }
+
+  if (!err)
+    err = svn_io_start_cmd3(&cmd_proc, ".", baton->cmd, baton->args,
+                            baton->env, FALSE, FALSE, stdin_handle, FALSE,
+                            null_handle, TRUE, NULL, baton->pool);
+
+  /* Wait for the hook even though we ignore its outcome; this reaps the
+     child process. */
+  if (!err)
+    err = check_hook_result(baton->name, baton->cmd, &cmd_proc,
+                            cmd_proc.err, baton->pool);
+
+  svn_error_clear(err);
+
+  /* This destroys BATON->POOL and, with it, the baton itself. */
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+#endif /* APR_HAS_THREADS */
+
+/* Like run_hook_cmd() with a NULL RESULT, but merely start the hook and
+   return without waiting for it.  The hook's exit status and stderr
+   output go unchecked, so this is only suitable for post-* hooks whose
+   outcome cannot affect the operation that triggered them.
+
+   NAME, CMD, ARGS and HOOKS_ENV are as for run_hook_cmd().  If
+   STDIN_VALUE is non-null, pass its content as the hook's stdin, else
+   pass no stdin to the hook. */
+static svn_error_t *
+run_hook_cmd_async(const char *name,
+                   const char *cmd,
+                   const char **args,
+                   apr_hash_t *hooks_env,
+                   const svn_string_t *stdin_value,
+                   apr_pool_t *scratch_pool)
+{
+#if APR_HAS_THREADS
+  /* The hook outlives the request that triggered it, so give the thread
+     a root pool of its own and copy everything it needs into it. */
+  apr_pool_t *thread_pool
+    = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  struct run_hook_thread_baton *baton;
+  apr_hash_t *hook_env = NULL;
+  apr_threadattr_t *tattr;
+  apr_thread_t *thread;
+  apr_status_t status;
+  int i, argc;
+
+  for (argc = 0; args[argc]; ++argc)
+    ;
+
+  baton = apr_pcalloc(thread_pool, sizeof(*baton));
+  baton->pool = thread_pool;
+  baton->name = apr_pstrdup(thread_pool, name);
+  baton->cmd = apr_pstrdup(thread_pool, cmd);
+  baton->args = apr_palloc(thread_pool, (argc + 1) * sizeof(*baton->args));
+  for (i = 0; i < argc; ++i)
+    baton->args[i] = apr_pstrdup(thread_pool, args[i]);
+  baton->args[argc] = NULL;
+  if (stdin_value)
+    baton->stdin_value = svn_string_dup(stdin_value, thread_pool);
+
+  /* Check if a custom environment is defined for this hook, or else
+   * whether a default environment is defined. */
+  if (hooks_env)
+    {
+      hook_env = svn_hash_gets(hooks_env, name);
+      if (hook_env == NULL)
+        hook_env = svn_hash_gets(hooks_env,
+                                 SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION);
+    }
+  baton->env = env_from_env_hash(hook_env, thread_pool, scratch_pool);
+
+  status = apr_threadattr_create(&tattr, thread_pool);
+  if (!status)
+    status = apr_threadattr_detach_set(tattr, TRUE);
+  if (!status)
+    status = apr_thread_create(&thread, tattr, run_hook_thread, baton,
+                               thread_pool);
+  if (status)
+    {
+      svn_pool_destroy(thread_pool);
+      return svn_error_wrap_apr(status, _("Failed to start '%s' hook"), cmd);
+    }
+
+  return SVN_NO_ERROR;
+#else
+  /* Without thread support, simply run the hook synchronously. */
+  apr_file_t *stdin_handle;
+
+  if (stdin_value)
+    SVN_ERR(create_temp_file(&stdin_handle, stdin_value, scratch_pool));
+  else
+    SVN_ERR(svn_io_file_open(&stdin_handle, SVN_NULL_DEVICE_NAME,
+                             APR_READ, APR_OS_DEFAULT, scratch_pool));
+
+  return svn_error_trace(run_hook_cmd(NULL, name, cmd, args, hooks_env,
+                                      stdin_handle, scratch_pool));
+#endif
+}
+
+
 /* Check if the HOOK program exists and is a file or a symbolic link, using
    POOL for temporary allocations.
 
@@ -610,8 +791,12 @@ svn_repos__hooks_post_commit(svn_repos_t *repos,
       args[3] = txn_name;
       args[4] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_COMMIT, hook, args,
-                           hooks_env, NULL, pool));
+      if (hook_is_async(hooks_env, SVN_REPOS__HOOK_POST_COMMIT))
+        SVN_ERR(run_hook_cmd_async(SVN_REPOS__HOOK_POST_COMMIT, hook, args,
+                                   hooks_env, NULL, pool));
+      else
+        SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_COMMIT, hook, args,
+                             hooks_env, NULL, pool));
     }
 
   return SVN_NO_ERROR;
@@ -701,16 +886,8 @@ svn_repos__hooks_post_revprop_change(svn_repos_t *repos,
   else if (hook)
     {
       const char *args[7];
-      apr_file_t *stdin_handle = NULL;
       char action_string[2];
 
-      /* Pass the old value as stdin to hook */
-      if (old_value)
-        SVN_ERR(create_temp_file(&stdin_handle, old_value, pool));
-      else
-        SVN_ERR(svn_io_file_open(&stdin_handle, SVN_NULL_DEVICE_NAME,
-                                 APR_READ, APR_OS_DEFAULT, pool));
-
       action_string[0] = action;
       action_string[1] = '\0';
 
@@ -722,10 +899,28 @@ svn_repos__hooks_post_revprop_change(svn_repos_t *repos,
       args[5] = action_string;
       args[6] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_REVPROP_CHANGE, hook,
-                           args, hooks_env, stdin_handle, pool));
+      if (hook_is_async(hooks_env, SVN_REPOS__HOOK_POST_REVPROP_CHANGE))
+        {
+          /* The old value becomes the hook's stdin, see below. */
+          SVN_ERR(run_hook_cmd_async(SVN_REPOS__HOOK_POST_REVPROP_CHANGE,
+                                     hook, args, hooks_env, old_value, pool));
+        }
+      else
+        {
+          apr_file_t *stdin_handle = NULL;
 
-      SVN_ERR(svn_io_file_close(stdin_handle, pool));
+          /* Pass the old value as stdin to hook */
+          if (old_value)
+            SVN_ERR(create_temp_file(&stdin_handle, old_value, pool));
+          else
+            SVN_ERR(svn_io_file_open(&stdin_handle, SVN_NULL_DEVICE_NAME,
+                                     APR_READ, APR_OS_DEFAULT, pool));
+
+          SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_REVPROP_CHANGE,
+                               hook, args, hooks_env, stdin_handle, pool));
+
+          SVN_ERR(svn_io_file_close(stdin_handle, pool));
+        }
     }
 
   return SVN_NO_ERROR;
@@ -39,22 +39,35 @@
 
 /* Utility function.  Given DIRENT->KIND, set all other elements of *DIRENT
  * with the values retrieved for PATH under ROOT.  Allocate them in POOL.
+ * If FULL is not NULL, take the node stat info from it instead of issuing
+ * individual FS queries for it.
  */
 static svn_error_t *
 fill_dirent(svn_dirent_t *dirent,
+            const svn_fs_dirent_full_t *full,
             svn_fs_root_t *root,
             const char *path,
             apr_pool_t *scratch_pool)
 {
   const char *datestring;
 
-  if (dirent->kind == svn_node_file)
-    SVN_ERR(svn_fs_file_length(&(dirent->size), root, path, scratch_pool));
+  if (full)
+    {
+      dirent->size = dirent->kind == svn_node_file ? full->size
+                                                   : SVN_INVALID_FILESIZE;
+      dirent->has_props = full->has_props;
+    }
   else
-    dirent->size = SVN_INVALID_FILESIZE;
-
-  SVN_ERR(svn_fs_node_has_props(&dirent->has_props, root, path,
-                                scratch_pool));
+    {
+      if (dirent->kind == svn_node_file)
+        SVN_ERR(svn_fs_file_length(&(dirent->size), root, path,
+                                   scratch_pool));
+      else
+        dirent->size = SVN_INVALID_FILESIZE;
+
+      SVN_ERR(svn_fs_node_has_props(&dirent->has_props, root, path,
+                                    scratch_pool));
+    }
 
   SVN_ERR(svn_repos_get_committed_info(&(dirent->created_rev),
                                        &datestring,
@@ -87,7 +100,7 @@ svn_repos_stat(svn_dirent_t **dirent,
   ent = svn_dirent_create(pool);
   ent->kind = kind;
 
-  SVN_ERR(fill_dirent(ent, root, path, pool));
+  SVN_ERR(fill_dirent(ent, NULL, root, path, pool));
 
   *dirent = ent;
   return SVN_NO_ERROR;
@@ -117,6 +130,7 @@ matches_any(const char *dirname,
 static svn_error_t *
 report_dirent(svn_fs_root_t *root,
               const char *path,
+              const svn_fs_dirent_full_t *full,
               svn_node_kind_t kind,
               svn_boolean_t path_info_only,
               svn_repos_dirent_receiver_t receiver,
@@ -128,7 +142,7 @@ report_dirent(svn_fs_root_t *root,
   /* Fetch the details to report - if required. */
   dirent.kind = kind;
   if (!path_info_only)
-    SVN_ERR(fill_dirent(&dirent, root, path, scratch_pool));
+    SVN_ERR(fill_dirent(&dirent, full, root, path, scratch_pool));
 
   /* Report the entry. */
   SVN_ERR(receiver(path, &dirent, receiver_baton, scratch_pool));
@@ -194,7 +208,14 @@ do_list(svn_fs_root_t *root,
    * the full path required for authz is somewhat expensive and we don't
    * want to do this twice while authz will rarely filter paths out.
    */
-  SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
+  if (path_info_only)
+    SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
+  else
+    /* We will stat every entry that makes it past the filters anyway,
+     * so fetch the node info for all of them in one batched FS pass.
+     * svn_fs_dirent_full_t is prefix-compatible with svn_fs_dirent_t. */
+    SVN_ERR(svn_fs_dir_entries_full(&entries, root, path, scratch_pool));
+
   sorted = apr_array_make(scratch_pool, apr_hash_count(entries),
                           sizeof(filtered_dirent_t));
   for (hi = apr_hash_first(scratch_pool, entries); hi; hi = apr_hash_next(hi))
@@ -245,7 +266,11 @@ do_list(svn_fs_root_t *root,
 
       /* Report entry, if it passed the filter. */
       if (filtered->is_match)
-        SVN_ERR(report_dirent(root, sub_path, dirent->kind, path_info_only,
+        SVN_ERR(report_dirent(root, sub_path,
+                              path_info_only
+                                ? NULL
+                                : (const svn_fs_dirent_full_t *)dirent,
+                              dirent->kind, path_info_only,
                               receiver, receiver_baton, iterpool));
 
       /* Check for cancellation before recursing down.  This should be
@@ -326,7 +351,7 @@ svn_repos_list(svn_fs_root_t *root,
   /* Actually report PATH, if it passes the filters. */
   if (matches_any(svn_dirent_basename(path, scratch_pool), patterns,
                   &scratch_buffer))
-    SVN_ERR(report_dirent(root, path, kind, path_info_only,
+    SVN_ERR(report_dirent(root, path, NULL, kind, path_info_only,
                           receiver, receiver_baton, scratch_pool));
 
   /* Report directory contents if requested. */
@@ -338,3 +363,166 @@ svn_repos_list(svn_fs_root_t *root,
 
   return SVN_NO_ERROR;
 }
+
+/* Report the versioned properties of PATH of type KIND under ROOT to
+ * RECEIVER / RECEIVER_BATON, if there are any.  Nodes without properties
+ * are filtered out here because svn_fs_node_has_props() is considerably
+ * cheaper than fetching an empty property list.
+ *
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+report_props(svn_fs_root_t *root,
+             const char *path,
+             svn_node_kind_t kind,
+             svn_repos__proplist_receiver_t receiver,
+             void *receiver_baton,
+             apr_pool_t *scratch_pool)
+{
+  svn_boolean_t has_props;
+  apr_hash_t *props;
+
+  SVN_ERR(svn_fs_node_has_props(&has_props, root, path, scratch_pool));
+  if (!has_props)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_node_proplist(&props, root, path, scratch_pool));
+  if (apr_hash_count(props) == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(receiver(path, kind, props, receiver_baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Core of svn_repos__proplist with the same parameter list.
+ *
+ * However, DEPTH is not svn_depth_empty and PATH has already been
+ * reported.  Therefore, we can call this recursively.
+ */
+static svn_error_t *
+do_proplist(svn_fs_root_t *root,
+            const char *path,
+            svn_depth_t depth,
+            svn_repos_authz_func_t authz_read_func,
+            void *authz_read_baton,
+            svn_repos__proplist_receiver_t receiver,
+            void *receiver_baton,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *scratch_pool)
+{
+  apr_hash_t *entries;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_hash_index_t *hi;
+  apr_array_header_t *sorted;
+  int i;
+
+  /* Fetch and sort the directory entries, so that the report comes out
+   * in a stable, path-sorted order just like svn_repos_list's. */
+  SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
+  sorted = svn_sort__hash(entries, svn_sort_compare_items_lexically,
+                          scratch_pool);
+
+  for (i = 0; i < sorted->nelts; ++i)
+    {
+      const svn_sort__item_t *item
+        = &APR_ARRAY_IDX(sorted, i, svn_sort__item_t);
+      const svn_fs_dirent_t *dirent = item->value;
+      const char *sub_path;
+
+      svn_pool_clear(iterpool);
+
+      /* Skip directories if we want to report files only. */
+      if (dirent->kind == svn_node_dir && depth == svn_depth_files)
+        continue;
+
+      /* Skip paths that we don't have access to. */
+      sub_path = svn_dirent_join(path, dirent->name, iterpool);
+      if (authz_read_func)
+        {
+          svn_boolean_t has_access;
+          SVN_ERR(authz_read_func(&has_access, root, sub_path,
+                                  authz_read_baton, iterpool));
+          if (!has_access)
+            continue;
+        }
+
+      SVN_ERR(report_props(root, sub_path, dirent->kind, receiver,
+                           receiver_baton, iterpool));
+
+      /* Check for cancellation before recursing down.  This should be
+       * slightly more responsive for deep trees. */
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      /* Recurse on directories. */
+      if (depth == svn_depth_infinity && dirent->kind == svn_node_dir)
+        SVN_ERR(do_proplist(root, sub_path, svn_depth_infinity,
+                            authz_read_func, authz_read_baton,
+                            receiver, receiver_baton, cancel_func,
+                            cancel_baton, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__proplist(svn_fs_root_t *root,
+                    const char *path,
+                    svn_depth_t depth,
+                    svn_repos_authz_func_t authz_read_func,
+                    void *authz_read_baton,
+                    svn_repos__proplist_receiver_t receiver,
+                    void *receiver_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  /* Parameter check. */
+  svn_node_kind_t kind;
+  if (depth < svn_depth_empty)
+    return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
+                             "Invalid depth '%d' in svn_repos__proplist",
+                             depth);
+
+  /* Do we have access to this sub-tree? */
+  if (authz_read_func)
+    {
+      svn_boolean_t has_access;
+      SVN_ERR(authz_read_func(&has_access, root, path, authz_read_baton,
+                              scratch_pool));
+      if (!has_access)
+        return SVN_NO_ERROR;
+    }
+
+  /* Does the sub-tree even exist?
+   *
+   * Note that we must do this after the authz check to not indirectly
+   * confirm the existence of PATH. */
+  SVN_ERR(svn_fs_check_path(&kind, root, path, scratch_pool));
+  if (kind == svn_node_file)
+    {
+      /* There is no recursion on files. */
+      depth = svn_depth_empty;
+    }
+  else if (kind != svn_node_dir)
+    {
+      return svn_error_createf(SVN_ERR_FS_NOT_FOUND, NULL,
+                               _("Path '%s' not found"), path);
+    }
+
+  /* Actually report PATH itself. */
+  SVN_ERR(report_props(root, path, kind, receiver, receiver_baton,
+                       scratch_pool));
+
+  /* Report directory contents if requested. */
+  if (depth > svn_depth_empty)
+    SVN_ERR(do_proplist(root, path, depth, authz_read_func,
+                        authz_read_baton, receiver, receiver_baton,
+                        cancel_func, cancel_baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
@@ -40,6 +40,7 @@
 
 #include "private/svn_fspath.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_io_private.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_repos_private.h"
 
@@ -1291,6 +1292,7 @@ svn_repos_load_fs6(svn_repos_t *repos,
 {
   const svn_repos_parse_fns3_t *parser;
   void *parse_baton;
+  svn_error_t *err;
 
   /* This is really simple. */
 
@@ -1309,8 +1311,24 @@ svn_repos_load_fs6(svn_repos_t *repos,
                                          notify_baton,
                                          pool));
 
-  return svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
-                                     cancel_func, cancel_baton, pool);
+  /* Reading - and, where the caller stacked decompression or translation
+     onto DUMPSTREAM, decoding - the dump data is a significant part of the
+     total load time, yet completely independent of the FS work.  Pipeline
+     it: a worker thread reads ahead while this thread builds and commits
+     the transactions.  (The transactions themselves must be built and
+     committed strictly one at a time: each revision's txn is based on its
+     predecessor's commit and may copy from it, and FS txns are not
+     thread-safe.)  Disown the caller's stream so that stopping the
+     worker does not close it. */
+  dumpstream = svn_stream__pipelined_read(svn_stream_disown(dumpstream,
+                                                            pool),
+                                          pool);
+
+  err = svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
+                                    cancel_func, cancel_baton, pool);
+
+  /* Stop the read-ahead worker, success or error alike. */
+  return svn_error_compose_create(err, svn_stream_close(dumpstream));
 }
 
 /*----------------------------------------------------------------------*/
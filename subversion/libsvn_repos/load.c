@@ -26,6 +26,7 @@
 #include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_error.h"
+#include "svn_io.h"
 #include "svn_repos.h"
 #include "svn_string.h"
 #include "repos.h"
@@ -33,6 +34,9 @@
 #include "svn_ctype.h"
 
 #include "private/svn_dep_compat.h"
+#include "private/svn_io_private.h"
+#include "private/svn_repos_private.h"
+#include "private/svn_subr_private.h"
 
 /*----------------------------------------------------------------------*/
 
@@ -317,6 +321,32 @@ parse_text_block(svn_stream_t *stream,
       SVN_ERR(parse_fns->set_fulltext(&text_stream, record_baton));
     }
 
+  /* If we have no sink for the data, skip over it as cheaply as
+     possible:  on seekable streams, e.g. a dump file, this merely
+     repositions the file pointer instead of reading the payload.  Keep
+     the final byte, though - only an actual read will detect a
+     truncated dump stream. */
+  if (!text_stream && content_length > 1)
+    {
+      svn_error_t *err = SVN_NO_ERROR;
+
+      while (content_length > 1 && !err)
+        {
+          apr_size_t to_skip
+            = content_length - 1 < (svn_filesize_t)APR_SIZE_MAX
+            ? (apr_size_t)content_length - 1
+            : APR_SIZE_MAX;
+
+          err = svn_stream_skip(stream, to_skip);
+          if (!err)
+            content_length -= to_skip;
+        }
+
+      /* Streams that cannot seek, e.g. pipes, shall consume the data
+         in the generic loop below instead. */
+      svn_error_clear(err);
+    }
+
   /* Regardless of whether or not we have a sink for our data, we
      need to read it. */
   while (content_length)
@@ -832,3 +862,421 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
   svn_pool_destroy(nodepool);
   return SVN_NO_ERROR;
 }
+
+/*----------------------------------------------------------------------*/
+
+/** Reading compressed dump files **/
+
+/* A half-open offset range [START, END) of a compressed dump container
+   that the reader shall deliver. */
+typedef struct framed_load_range_t
+{
+  apr_off_t start;
+  apr_off_t end;   /* -1 means "up to the terminating zero-sized block" */
+} framed_load_range_t;
+
+/* Baton for the container reader stream, cf.
+   SVN_REPOS__DUMP_ZSTD_MAGIC in svn_repos_private.h. */
+typedef struct framed_load_baton_t
+{
+  /* The raw container stream. */
+  svn_stream_t *source;
+
+  /* The file backing SOURCE, or NULL if SOURCE is not seekable. */
+  apr_file_t *file;
+
+  /* If TRUE, SOURCE is not a compressed container and gets passed
+     through unmodified once BLOCK has been replayed. */
+  svn_boolean_t passthrough;
+
+  /* Set once the terminating zero-sized block, the end of the last
+     range or the end of SOURCE has been reached. */
+  svn_boolean_t eof;
+
+  /* Absolute offset of the next byte to read from the container. */
+  apr_off_t offset;
+
+  /* The current decompressed block (or, in passthrough mode, the bytes
+     consumed during container detection), delivered up to BLOCK_POS. */
+  svn_stringbuf_t *block;
+  apr_size_t block_pos;
+
+  /* Reusable buffer for the compressed on-disk form of a block. */
+  svn_stringbuf_t *compressed;
+
+  /* Ranges to deliver, in ascending order, or NULL to deliver the whole
+     container.  CUR_RANGE is the index of the range currently read. */
+  apr_array_header_t *ranges;
+  int cur_range;
+
+  /* Pool that the above buffers got allocated in. */
+  apr_pool_t *pool;
+} framed_load_baton_t;
+
+/* Decode the SIZE bytes at BUF as a big-endian unsigned integer. */
+static apr_uint64_t
+framed_load_decode_uint(const unsigned char *buf,
+                        apr_size_t size)
+{
+  apr_uint64_t value = 0;
+  apr_size_t i;
+
+  for (i = 0; i < size; ++i)
+    value = (value << 8) | buf[i];
+
+  return value;
+}
+
+/* Read and decompress the next block of the container into BATON's
+   block buffer, seeking over unrequested sections as indicated by
+   BATON->RANGES.  Set BATON->EOF instead if the compressed data ends
+   here. */
+static svn_error_t *
+framed_load_next_block(framed_load_baton_t *baton)
+{
+  unsigned char header[4];
+  apr_size_t len;
+  apr_uint64_t compressed_len;
+
+  /* If we reached the end of the current range, continue with the next
+     one - the blocks in between were not requested. */
+  if (baton->ranges)
+    {
+      framed_load_range_t *range
+        = &APR_ARRAY_IDX(baton->ranges, baton->cur_range,
+                         framed_load_range_t);
+
+      if (range->end != -1 && baton->offset > range->end)
+        return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                                _("Block boundary in compressed dump "
+                                  "file does not match its revision "
+                                  "index"));
+
+      if (baton->offset == range->end)
+        {
+          apr_off_t pos;
+
+          if (++baton->cur_range >= baton->ranges->nelts)
+            {
+              baton->eof = TRUE;
+              return SVN_NO_ERROR;
+            }
+
+          range = &APR_ARRAY_IDX(baton->ranges, baton->cur_range,
+                                 framed_load_range_t);
+          pos = range->start;
+          SVN_ERR(svn_io_file_seek(baton->file, APR_SET, &pos,
+                                   baton->pool));
+          baton->offset = range->start;
+        }
+    }
+
+  len = sizeof(header);
+  SVN_ERR(svn_stream_read_full(baton->source, (char *)header, &len));
+  if (len < sizeof(header))
+    return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                            _("Compressed dump file is truncated"));
+
+  compressed_len = framed_load_decode_uint(header, sizeof(header));
+  if (compressed_len == 0)
+    {
+      /* The terminating zero-sized block: only the index follows. */
+      baton->eof = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  /* Even an incompressible block only grows by a small header. */
+  if (compressed_len > SVN_REPOS__DUMP_ZSTD_BLOCK_SIZE + 0x10000)
+    return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                            _("Oversized block in compressed dump file"));
+
+  svn_stringbuf_setempty(baton->compressed);
+  svn_stringbuf_ensure(baton->compressed, (apr_size_t)compressed_len);
+  len = (apr_size_t)compressed_len;
+  SVN_ERR(svn_stream_read_full(baton->source, baton->compressed->data,
+                               &len));
+  if (len < compressed_len)
+    return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                            _("Compressed dump file is truncated"));
+
+  SVN_ERR(svn__decompress_zstd(baton->compressed->data, len, baton->block,
+                               SVN_REPOS__DUMP_ZSTD_BLOCK_SIZE));
+  baton->block_pos = 0;
+  baton->offset += sizeof(header) + (apr_off_t)compressed_len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_read_fn_t, delivering the decompressed dump data. */
+static svn_error_t *
+framed_load_read(void *baton,
+                 char *buffer,
+                 apr_size_t *len)
+{
+  framed_load_baton_t *b = baton;
+  apr_size_t left = *len;
+
+  while (left)
+    {
+      apr_size_t chunk;
+
+      if (b->block_pos == b->block->len)
+        {
+          if (b->eof)
+            break;
+
+          if (b->passthrough)
+            {
+              /* The detection bytes have been replayed; the rest comes
+                 straight from the source. */
+              chunk = left;
+              SVN_ERR(svn_stream_read_full(b->source, buffer, &chunk));
+              if (chunk < left)
+                b->eof = TRUE;
+              left -= chunk;
+              break;
+            }
+
+          SVN_ERR(framed_load_next_block(b));
+          continue;
+        }
+
+      chunk = b->block->len - b->block_pos;
+      if (chunk > left)
+        chunk = left;
+
+      memcpy(buffer, b->block->data + b->block_pos, chunk);
+      b->block_pos += chunk;
+      buffer += chunk;
+      left -= chunk;
+    }
+
+  *len -= left;
+  return SVN_NO_ERROR;
+}
+
+/* One entry of a container's revision index. */
+typedef struct framed_load_index_entry_t
+{
+  svn_revnum_t rev;
+  apr_off_t offset;
+} framed_load_index_entry_t;
+
+/* Read the revision index at the end of the container in FILE and
+   return it in *INDEX as an array of framed_load_index_entry_t in
+   ascending revision order, allocated in RESULT_POOL.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_container_index(apr_array_header_t **index,
+                     apr_file_t *file,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  const apr_size_t magic_len = strlen(SVN_REPOS__DUMP_ZSTD_MAGIC);
+  const apr_size_t trailer_magic_len
+    = strlen(SVN_REPOS__DUMP_ZSTD_TRAILER_MAGIC);
+  const apr_size_t trailer_len = 8 + trailer_magic_len;
+  unsigned char *trailer = apr_palloc(scratch_pool, trailer_len);
+  apr_off_t file_size = 0;
+  apr_off_t pos;
+  apr_off_t index_offset;
+  apr_size_t index_size;
+  char *data;
+  char *p;
+  apr_array_header_t *result;
+
+  SVN_ERR(svn_io_file_seek(file, APR_END, &file_size, scratch_pool));
+
+  /* The smallest valid container: magic, zero-sized block, empty index,
+     trailer. */
+  if (file_size < (apr_off_t)(magic_len + 4 + trailer_len))
+    return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                            _("Compressed dump file is too short to "
+                              "contain a revision index"));
+
+  pos = file_size - (apr_off_t)trailer_len;
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &pos, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, trailer, trailer_len, NULL, NULL,
+                                 scratch_pool));
+  if (memcmp(trailer + 8, SVN_REPOS__DUMP_ZSTD_TRAILER_MAGIC,
+             trailer_magic_len))
+    return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                            _("Compressed dump file is missing its "
+                              "trailer; it may be truncated"));
+
+  index_offset = (apr_off_t)framed_load_decode_uint(trailer, 8);
+  if (index_offset < (apr_off_t)(magic_len + 4) || index_offset > pos)
+    return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                            _("Compressed dump file contains an invalid "
+                              "index offset"));
+
+  index_size = (apr_size_t)(pos - index_offset);
+  data = apr_palloc(scratch_pool, index_size + 1);
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &index_offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, data, index_size, NULL, NULL,
+                                 scratch_pool));
+  data[index_size] = '\0';
+
+  result = apr_array_make(result_pool, 16,
+                          sizeof(framed_load_index_entry_t));
+  p = data;
+  while (*p)
+    {
+      char *eol = strchr(p, '\n');
+      char *sep;
+      apr_int64_t rev;
+      apr_int64_t offset;
+      framed_load_index_entry_t entry;
+
+      sep = eol ? memchr(p, ' ', eol - p) : NULL;
+      if (!eol || !sep)
+        return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                                _("Compressed dump file contains a "
+                                  "malformed index line"));
+
+      *eol = '\0';
+      *sep = '\0';
+      SVN_ERR(svn_cstring_atoi64(&rev, p));
+      SVN_ERR(svn_cstring_atoi64(&offset, sep + 1));
+
+      entry.rev = (svn_revnum_t)rev;
+      entry.offset = (apr_off_t)offset;
+      APR_ARRAY_PUSH(result, framed_load_index_entry_t) = entry;
+
+      p = eol + 1;
+    }
+
+  *index = result;
+  return SVN_NO_ERROR;
+}
+
+/* Set BATON->RANGES such that reading delivers the dump file preamble
+   followed by the records of revisions START_REV to END_REV, using the
+   revision index of the container in BATON->FILE.  Leave BATON->RANGES
+   at NULL if the whole container is needed anyway.  Use SCRATCH_POOL
+   for temporary allocations. */
+static svn_error_t *
+build_load_ranges(framed_load_baton_t *baton,
+                  svn_revnum_t start_rev,
+                  svn_revnum_t end_rev,
+                  apr_pool_t *scratch_pool)
+{
+  const apr_off_t preamble_start = (apr_off_t)
+    strlen(SVN_REPOS__DUMP_ZSTD_MAGIC);
+  apr_array_header_t *index;
+  framed_load_index_entry_t *first;
+  framed_load_index_entry_t *last;
+  framed_load_range_t range;
+  svn_revnum_t lo;
+  apr_off_t pos = preamble_start;
+
+  SVN_ERR(read_container_index(&index, baton->file, scratch_pool,
+                               scratch_pool));
+
+  /* Restore the read position for the data blocks; every range below
+     starts with the preamble segment at PREAMBLE_START. */
+  SVN_ERR(svn_io_file_seek(baton->file, APR_SET, &pos, scratch_pool));
+
+  if (index->nelts == 0)
+    return SVN_NO_ERROR;
+
+  first = &APR_ARRAY_IDX(index, 0, framed_load_index_entry_t);
+  last = &APR_ARRAY_IDX(index, index->nelts - 1,
+                        framed_load_index_entry_t);
+
+  lo = (start_rev > first->rev) ? start_rev : first->rev;
+  if (lo == first->rev
+      && !(SVN_IS_VALID_REVNUM(end_rev) && end_rev < last->rev))
+    return SVN_NO_ERROR;
+
+  baton->ranges = apr_array_make(baton->pool, 2,
+                                 sizeof(framed_load_range_t));
+
+  if (lo > last->rev
+      || (SVN_IS_VALID_REVNUM(end_rev) && end_rev < first->rev))
+    {
+      /* Nothing of the requested range is in this dump; deliver just
+         the preamble and let the loader report the empty result. */
+      range.start = preamble_start;
+      range.end = first->offset;
+      APR_ARRAY_PUSH(baton->ranges, framed_load_range_t) = range;
+      return SVN_NO_ERROR;
+    }
+
+  /* The index covers every dumped revision contiguously. */
+  if (last->rev - first->rev + 1 != index->nelts)
+    return svn_error_create(SVN_ERR_STREAM_MALFORMED_DATA, NULL,
+                            _("Compressed dump file contains a "
+                              "non-contiguous revision index"));
+
+  range.start = preamble_start;
+  range.end = (lo == first->rev)
+              ? -1
+              : first->offset;
+  if (lo > first->rev)
+    {
+      /* Preamble only; the revision data follows in a second range. */
+      APR_ARRAY_PUSH(baton->ranges, framed_load_range_t) = range;
+      range.start = APR_ARRAY_IDX(index, lo - first->rev,
+                                  framed_load_index_entry_t).offset;
+      range.end = -1;
+    }
+
+  if (SVN_IS_VALID_REVNUM(end_rev) && end_rev < last->rev)
+    range.end = APR_ARRAY_IDX(index, end_rev + 1 - first->rev,
+                              framed_load_index_entry_t).offset;
+
+  APR_ARRAY_PUSH(baton->ranges, framed_load_range_t) = range;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__compressed_dump_stream(svn_stream_t **dump_stream,
+                                  svn_stream_t *source,
+                                  svn_revnum_t start_rev,
+                                  svn_revnum_t end_rev,
+                                  apr_pool_t *result_pool,
+                                  apr_pool_t *scratch_pool)
+{
+  framed_load_baton_t *b = apr_pcalloc(result_pool, sizeof(*b));
+  svn_stream_t *stream;
+  const apr_size_t magic_len = strlen(SVN_REPOS__DUMP_ZSTD_MAGIC);
+  char magic[sizeof(SVN_REPOS__DUMP_ZSTD_MAGIC)];
+  apr_size_t len = magic_len;
+
+  SVN_ERR(svn_stream_read_full(source, magic, &len));
+
+  b->source = source;
+  b->compressed = svn_stringbuf_create_empty(result_pool);
+  b->pool = result_pool;
+
+  if (len < magic_len
+      || memcmp(magic, SVN_REPOS__DUMP_ZSTD_MAGIC, magic_len) != 0)
+    {
+      /* Not a compressed container.  Replay the bytes consumed during
+         detection, then pass the rest of SOURCE through unmodified. */
+      b->passthrough = TRUE;
+      b->block = svn_stringbuf_ncreate(magic, len, result_pool);
+      if (len < magic_len)
+        b->eof = TRUE;
+    }
+  else
+    {
+      b->block = svn_stringbuf_create_empty(result_pool);
+      b->offset = (apr_off_t)magic_len;
+
+      /* With a seekable source and a start revision, use the embedded
+         index to skip anything before (and, if limited, after) the
+         requested revision range. */
+      b->file = svn_stream__aprfile(source);
+      if (b->file && SVN_IS_VALID_REVNUM(start_rev))
+        SVN_ERR(build_load_ranges(b, start_rev, end_rev, scratch_pool));
+    }
+
+  stream = svn_stream_create(b, result_pool);
+  svn_stream_set_read2(stream, NULL /* only full read support */,
+                       framed_load_read);
+
+  *dump_stream = stream;
+  return SVN_NO_ERROR;
+}
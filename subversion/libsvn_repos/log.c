@@ -41,6 +41,7 @@
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_mergeinfo_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
@@ -906,6 +907,22 @@ get_combined_mergeinfo_changes(svn_mergeinfo_t *added_mergeinfo,
   if (! paths->nelts)
     return SVN_NO_ERROR;
 
+  /* Get a root for REV. */
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, scratch_pool));
+
+  /* Ask the FS whether REV touched any of PATHS, their ancestors (from
+     which their mergeinfo may be inherited) or their descendants at all.
+     For most revisions of a history scan it did not, which lets us skip
+     the changed-paths and mergeinfo analysis below entirely. */
+  {
+    svn_boolean_t may_touch;
+
+    SVN_ERR(svn_fs__changes_may_touch_paths(&may_touch, root, paths,
+                                            scratch_pool));
+    if (! may_touch)
+      return SVN_NO_ERROR;
+  }
+
   /* Fetch the mergeinfo changes for REV. */
   err = fs_mergeinfo_changed(&deleted_mergeinfo_catalog,
                              &added_mergeinfo_catalog,
@@ -932,9 +949,6 @@ get_combined_mergeinfo_changes(svn_mergeinfo_t *added_mergeinfo,
       && apr_hash_count(added_mergeinfo_catalog) == 0)
     return SVN_NO_ERROR;
 
-  /* Create a work subpool and get a root for REV. */
-  SVN_ERR(svn_fs_revision_root(&root, fs, rev, scratch_pool));
-
   /* Check our PATHS for any changes to their inherited mergeinfo.
      (We deal with changes to mergeinfo directly *on* the paths in the
      following loop.)  */
@@ -1319,6 +1333,15 @@ send_log(svn_revnum_t rev,
 
   interesting_merge_baton_t baton;
 
+  /* Is REV a merged revision we've already sent?  Checking this before
+     filling in the log entry saves re-harvesting the changed-path list
+     of REV - easily thousands of redundant change lists on heavily
+     merged histories - and prevents the path change receiver from
+     seeing changes for an entry that would never be delivered. */
+  if (nested_merges && handling_merged_revision
+      && svn_bit_array__get(nested_merges, rev))
+    return SVN_NO_ERROR;
+
   /* Is REV a merged revision that is already part of
      LOG_TARGET_HISTORY_AS_MERGEINFO?  If so then there is no
      need to send it, since it already was (or will be) sent.
@@ -1353,22 +1376,11 @@ send_log(svn_revnum_t rev,
     {
       apr_pool_t *scratch_pool;
 
-      /* Is REV a merged revision we've already sent? */
+      /* Remember that we sent REV.  NESTED_REVS needs to last across all
+         the send_log, do_logs, handle_merged_revisions() recursions, so
+         use the pool it was created in at the top of the recursion. */
       if (nested_merges && handling_merged_revision)
-        {
-          if (svn_bit_array__get(nested_merges, rev))
-            {
-              /* We already sent REV. */
-              return SVN_NO_ERROR;
-            }
-          else
-            {
-              /* NESTED_REVS needs to last across all the send_log, do_logs,
-                 handle_merged_revisions() recursions, so use the pool it
-                 was created in at the top of the recursion. */
-              svn_bit_array__set(nested_merges, rev, TRUE);
-            }
-        }
+        svn_bit_array__set(nested_merges, rev, TRUE);
 
       /* Pass a scratch pool to ensure no temporary state stored
          by the receiver callback persists. */
@@ -2465,3 +2477,166 @@ svn_repos_get_logs5(svn_repos_t *repos,
                  include_merged_revisions, FALSE, FALSE, FALSE,
                  revprops, descending_order, &callbacks, scratch_pool);
 }
+
+
+/* Prefix identifying a log resume token.  The token is deliberately
+   tiny: the history walk itself cannot be serialized, but restarting the
+   walk at the page boundary skips re-scanning and re-sending everything
+   that earlier pages already delivered. */
+#define LOG_RESUME_TOKEN_PREFIX "log-resume:"
+
+svn_error_t *
+svn_repos__log_resume_token_parse(svn_revnum_t *next_rev,
+                                  const char *token,
+                                  apr_pool_t *scratch_pool)
+{
+  const char *digits;
+  svn_error_t *err;
+
+  if (strncmp(token, LOG_RESUME_TOKEN_PREFIX,
+              strlen(LOG_RESUME_TOKEN_PREFIX)) != 0)
+    return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
+                             _("Invalid log resume token '%s'"), token);
+
+  digits = token + strlen(LOG_RESUME_TOKEN_PREFIX);
+  err = svn_revnum_parse(next_rev, digits, &digits);
+  if (err || *digits != '\0')
+    return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, err,
+                             _("Invalid log resume token '%s'"), token);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for resume_revision_receiver(). */
+typedef struct resume_receiver_baton_t
+{
+  svn_repos_log_entry_receiver_t revision_receiver;
+  void *revision_receiver_baton;
+
+  /* How deep we are in a merged-revision sub-tree.  Only revisions at
+     depth zero count towards the page. */
+  int stack_depth;
+
+  /* Number of top-level revisions delivered so far and the last one
+     we saw.  LAST_REV determines where the next page starts. */
+  int sent;
+  svn_revnum_t last_rev;
+} resume_receiver_baton_t;
+
+/* Implements svn_repos_log_entry_receiver_t, counting the top-level
+   revisions that pass through on their way to the real receiver.
+   BATON is a resume_receiver_baton_t. */
+static svn_error_t *
+resume_revision_receiver(void *baton,
+                         svn_repos_log_entry_t *log_entry,
+                         apr_pool_t *scratch_pool)
+{
+  resume_receiver_baton_t *rb = baton;
+
+  if (log_entry->revision == SVN_INVALID_REVNUM)
+    {
+      /* End of a list of merged children. */
+      if (rb->stack_depth > 0)
+        rb->stack_depth--;
+    }
+  else
+    {
+      if (rb->stack_depth == 0)
+        {
+          rb->sent++;
+          rb->last_rev = log_entry->revision;
+        }
+
+      if (log_entry->has_children)
+        rb->stack_depth++;
+    }
+
+  return svn_error_trace(rb->revision_receiver(rb->revision_receiver_baton,
+                                               log_entry, scratch_pool));
+}
+
+svn_error_t *
+svn_repos__get_logs_resumable(svn_repos_t *repos,
+                              const apr_array_header_t *paths,
+                              svn_revnum_t start,
+                              svn_revnum_t end,
+                              int limit,
+                              svn_boolean_t strict_node_history,
+                              svn_boolean_t include_merged_revisions,
+                              const apr_array_header_t *revprops,
+                              const char *resume_token,
+                              const char **resume_token_out,
+                              svn_repos_authz_func_t authz_read_func,
+                              void *authz_read_baton,
+                              svn_repos_path_change_receiver_t
+                                path_change_receiver,
+                              void *path_change_receiver_baton,
+                              svn_repos_log_entry_receiver_t
+                                revision_receiver,
+                              void *revision_receiver_baton,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  svn_revnum_t head;
+  svn_boolean_t descending_order;
+  resume_receiver_baton_t rb;
+
+  *resume_token_out = NULL;
+
+  /* Resolve the defaults here so that we can reason about the range;
+     svn_repos_get_logs5() will re-validate the values we pass down. */
+  SVN_ERR(svn_fs_youngest_rev(&head, repos->fs, scratch_pool));
+
+  if (! SVN_IS_VALID_REVNUM(start))
+    start = head;
+  if (! SVN_IS_VALID_REVNUM(end))
+    end = head;
+
+  descending_order = start >= end;
+
+  if (resume_token)
+    {
+      svn_revnum_t next_rev;
+
+      SVN_ERR(svn_repos__log_resume_token_parse(&next_rev, resume_token,
+                                                scratch_pool));
+
+      /* The previous page stopped just before NEXT_REV; continue there.
+         A token pointing past the end of the range means the walk is
+         already complete. */
+      if (descending_order ? next_rev < end : next_rev > end)
+        return SVN_NO_ERROR;
+
+      start = next_rev;
+    }
+
+  rb.revision_receiver = revision_receiver;
+  rb.revision_receiver_baton = revision_receiver_baton;
+  rb.stack_depth = 0;
+  rb.sent = 0;
+  rb.last_rev = SVN_INVALID_REVNUM;
+
+  SVN_ERR(svn_repos_get_logs5(repos, paths, start, end, limit,
+                              strict_node_history,
+                              include_merged_revisions, revprops,
+                              authz_read_func, authz_read_baton,
+                              path_change_receiver,
+                              path_change_receiver_baton,
+                              resume_revision_receiver, &rb,
+                              scratch_pool));
+
+  /* A short page means the range is exhausted; only a full page can have
+     revisions left over. */
+  if (limit > 0 && rb.sent == limit && SVN_IS_VALID_REVNUM(rb.last_rev))
+    {
+      svn_revnum_t next_rev = descending_order ? rb.last_rev - 1
+                                               : rb.last_rev + 1;
+
+      if (descending_order ? next_rev >= end : next_rev <= end)
+        *resume_token_out = apr_psprintf(result_pool,
+                                         LOG_RESUME_TOKEN_PREFIX "%ld",
+                                         next_rev);
+    }
+
+  return SVN_NO_ERROR;
+}
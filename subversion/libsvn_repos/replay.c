@@ -38,6 +38,7 @@
 #include "svn_private_config.h"
 #include "private/svn_fspath.h"
 #include "private/svn_repos_private.h"
+#include "private/svn_subr_private.h"
 #include "private/svn_delta_private.h"
 #include "private/svn_sorts_private.h"
 
@@ -292,13 +293,20 @@ add_subdir(svn_fs_root_t *source_root,
           svn_txdelta_stream_t *delta_stream;
           svn_checksum_t *checksum;
 
+          /* All allocations for this file live in SUBPOOL, which is
+             cleared at the top of the next iteration; the file baton is
+             closed below, before that happens.  Replaying a huge added
+             tree thus runs in constant memory rather than accumulating
+             one delta stream per file in POOL. */
           SVN_ERR(editor->add_file(new_edit_path, *dir_baton, NULL,
-                                   SVN_INVALID_REVNUM, pool, &file_baton));
+                                   SVN_INVALID_REVNUM, subpool, &file_baton));
 
           SVN_ERR(svn_fs_node_proplist(&props, target_root,
                                        new_edit_path, subpool));
 
-          for (phi = apr_hash_first(pool, props); phi; phi = apr_hash_next(phi))
+          for (phi = apr_hash_first(subpool, props);
+               phi;
+               phi = apr_hash_next(phi))
             {
               const char *key = apr_hash_this_key(phi);
               svn_string_t *val = apr_hash_this_val(phi);
@@ -306,24 +314,24 @@ add_subdir(svn_fs_root_t *source_root,
               SVN_ERR(editor->change_file_prop(file_baton, key, val, subpool));
             }
 
-          SVN_ERR(editor->apply_textdelta(file_baton, NULL, pool,
+          SVN_ERR(editor->apply_textdelta(file_baton, NULL, subpool,
                                           &delta_handler,
                                           &delta_handler_baton));
 
           SVN_ERR(svn_fs_get_file_delta_stream(&delta_stream, NULL, NULL,
                                                target_root, new_edit_path,
-                                               pool));
+                                               subpool));
 
           SVN_ERR(svn_txdelta_send_txstream(delta_stream,
                                             delta_handler,
                                             delta_handler_baton,
-                                            pool));
+                                            subpool));
 
           SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, target_root,
-                                       new_edit_path, TRUE, pool));
+                                       new_edit_path, TRUE, subpool));
           SVN_ERR(editor->close_file(file_baton,
-                                     svn_checksum_to_cstring(checksum, pool),
-                                     pool));
+                                     svn_checksum_to_cstring(checksum, subpool),
+                                     subpool));
         }
       else
         SVN_ERR_MALFUNCTION();
@@ -929,6 +937,8 @@ svn_repos_replay2(svn_fs_root_t *root,
   apr_hash_t *changed_paths;
   apr_array_header_t *paths;
   struct path_driver_cb_baton cb_baton;
+  apr_pool_t *subpool;
+  svn_error_t *err;
 
   /* Special-case r0, which we know is an empty revision; if we don't
      special-case it we might end up trying to compare it to "r-1". */
@@ -943,10 +953,16 @@ svn_repos_replay2(svn_fs_root_t *root,
   else if (base_path[0] == '/')
     ++base_path;
 
+  /* Keep the replay state (the changed-path metadata, the copy stack and
+     everything the editor drive allocates) in a subpool of our own so that
+     it is released as soon as this revision has been replayed, even if the
+     caller replays many revisions from the same pool. */
+  subpool = svn_pool_create(pool);
+
   /* Fetch the paths changed under ROOT. */
   SVN_ERR(get_relevant_changes(&changed_paths, &paths, root, base_path,
                                authz_read_func, authz_read_baton,
-                               pool, pool));
+                               subpool, subpool));
 
   /* If we were not given a low water mark, assume that everything is there,
      all the way back to revision 0. */
@@ -969,24 +985,27 @@ svn_repos_replay2(svn_fs_root_t *root,
                                    svn_fs_is_revision_root(root)
                                      ? svn_fs_revision_root_revision(root) - 1
                                      : svn_fs_txn_root_base_revision(root),
-                                   pool));
+                                   subpool));
     }
 
-  cb_baton.copies = apr_array_make(pool, 4, sizeof(struct copy_info *));
-  cb_baton.pool = pool;
+  cb_baton.copies = apr_array_make(subpool, 4, sizeof(struct copy_info *));
+  cb_baton.pool = subpool;
 
   /* Determine the revision to use throughout the edit, and call
      EDITOR's set_target_revision() function.  */
   if (svn_fs_is_revision_root(root))
     {
       svn_revnum_t revision = svn_fs_revision_root_revision(root);
-      SVN_ERR(editor->set_target_revision(edit_baton, revision, pool));
+      SVN_ERR(editor->set_target_revision(edit_baton, revision, subpool));
     }
 
   /* Call the path-based editor driver. */
-  return svn_delta_path_driver3(editor, edit_baton,
-                                paths, TRUE,
-                                path_driver_cb_func, &cb_baton, pool);
+  err = svn_delta_path_driver3(editor, edit_baton,
+                               paths, TRUE,
+                               path_driver_cb_func, &cb_baton, subpool);
+
+  svn_pool_destroy(subpool);
+  return svn_error_trace(err);
 #else
   svn_editor_t *editorv2;
   struct svn_delta__extra_baton *exb;
@@ -1549,7 +1568,7 @@ svn_repos__replay_ev2(svn_fs_root_t *root,
   svn_sort__array(paths, svn_sort_compare_paths);
 
   /* Now actually handle the various paths. */
-  iterpool = svn_pool_create(scratch_pool);
+  iterpool = svn_pool__create_iterpool(scratch_pool);
   for (i = 0; i < paths->nelts; i++)
     {
       const char *repos_relpath = APR_ARRAY_IDX(paths, i, const char *);
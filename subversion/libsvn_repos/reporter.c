@@ -41,33 +41,45 @@
 
 #define NUM_CACHED_SOURCE_ROOTS 4
 
+/* Tag bytes introducing a report operation in the spill buffer. */
+#define REPORT_REC_END         0x00 /* end of the report */
+#define REPORT_REC_ENTRY       0x01 /* a path entry follows */
+
+/* Flag bits used in a path entry's <flags> byte. */
+#define REPORT_FLAG_LINK_PATH  0x01 /* entry carries a link_path */
+#define REPORT_FLAG_REV        0x02 /* entry carries a revnum */
+#define REPORT_FLAG_DEPTH      0x04 /* depth other than svn_depth_infinity */
+#define REPORT_FLAG_START_EMPTY 0x08 /* start_empty field set */
+#define REPORT_FLAG_LOCK_TOKEN 0x10 /* entry carries a lock_token */
+
 /* Theory of operation: we write report operations out to a spill-buffer
    as we receive them.  When the report is finished, we read the
    operations back out again, using them to guide the progression of
    the delta between the source and target revs.
 
-   Spill-buffer content format: we use a simple ad-hoc format to store the
-   report operations.  Each report operation is the concatention of
-   the following ("+/-" indicates the single character '+' or '-';
-   <length> and <revnum> are written out as decimal strings):
-
-     +/-                      '-' marks the end of the report
-     If previous is +:
-       <length>:<bytes>       Length-counted path string
-       +/-                    '+' indicates the presence of link_path
-       If previous is +:
-         <length>:<bytes>     Length-counted link_path string
-       +/-                    '+' indicates presence of revnum
-       If previous is +:
-         <revnum>:            Revnum of set_path or link_path
-       +/-                    '+' indicates depth other than svn_depth_infinity
-       If previous is +:
-         <depth>:             "X","E","F","M" =>
+   Spill-buffer content format: we use a compact binary format to store
+   the report operations.  <uint> stands for the variable-length 7b/8b
+   integer encoding of svn__encode_uint(); each operation starts with a
+   single tag byte:
+
+     0x00                     marks the end of the report
+     0x01                     starts a path entry, followed by:
+       <flags>                One byte; see the REPORT_FLAG_* bits below
+       <uint><bytes>          Length-counted path string
+       If REPORT_FLAG_LINK_PATH is set:
+         <uint><bytes>        Length-counted link_path string
+       If REPORT_FLAG_REV is set:
+         <uint>               Revnum of set_path or link_path
+       If REPORT_FLAG_DEPTH is set:
+         <depth>              "X","E","F","M" =>
                                  svn_depth_{exclude,empty,files,immediates}
-       +/-                    '+' indicates start_empty field set
-       +/-                    '+' indicates presence of lock_token field.
-       If previous is +:
-         <length>:<bytes>     Length-counted lock_token string
+                              (svn_depth_infinity is implied if unset)
+       If REPORT_FLAG_LOCK_TOKEN is set:
+         <uint><bytes>        Length-counted lock_token string
+
+   Each entry is assembled in memory first and handed to the spill-
+   buffer as a single write, so ingesting a set_path call costs one
+   buffer operation regardless of how many fields are present.
 
    Terminology: for brevity, this file frequently uses the prefixes
    "s_" for source, "t_" for target, and "e_" for editor.  Also, to
@@ -170,14 +182,16 @@ read_number(apr_uint64_t *num, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
 {
   char c;
 
+  /* 7b/8b encoding; the high bit marks a continuation byte.  See
+     svn__encode_uint(). */
   *num = 0;
-  while (1)
+  do
     {
       SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-      if (c == ':')
-        break;
-      *num = *num * 10 + (c - '0');
+      *num = (*num << 7) | (c & 0x7f);
     }
+  while (c & 0x80);
+
   return SVN_NO_ERROR;
 }
 
@@ -220,26 +234,8 @@ read_string(const char **str, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
-static svn_error_t *
-read_rev(svn_revnum_t *rev, svn_spillbuf_reader_t *reader, apr_pool_t *pool)
-{
-  char c;
-  apr_uint64_t num;
-
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '+')
-    {
-      SVN_ERR(read_number(&num, reader, pool));
-      *rev = (svn_revnum_t) num;
-    }
-  else
-    *rev = SVN_INVALID_REVNUM;
-  return SVN_NO_ERROR;
-}
-
-/* Read a single character to set *DEPTH (having already read '+')
-   from READER.  PATH is the path to which the depth applies, and is
-   used for error reporting only. */
+/* Read a single character to set *DEPTH from READER.  PATH is the path
+   to which the depth applies, and is used for error reporting only. */
 static svn_error_t *
 read_depth(svn_depth_t *depth, svn_spillbuf_reader_t *reader, const char *path,
            apr_pool_t *pool)
@@ -281,34 +277,47 @@ read_path_info(path_info_t **pi,
                apr_pool_t *pool)
 {
   char c;
+  unsigned char flags;
 
   SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '-')
+  if (c == REPORT_REC_END)
     {
       *pi = NULL;
       return SVN_NO_ERROR;
     }
 
+  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
+  flags = (unsigned char)c;
+
   *pi = apr_palloc(pool, sizeof(**pi));
   SVN_ERR(read_string(&(*pi)->path, reader, pool));
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '+')
+
+  if (flags & REPORT_FLAG_LINK_PATH)
     SVN_ERR(read_string(&(*pi)->link_path, reader, pool));
   else
     (*pi)->link_path = NULL;
-  SVN_ERR(read_rev(&(*pi)->rev, reader, pool));
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '+')
+
+  if (flags & REPORT_FLAG_REV)
+    {
+      apr_uint64_t num;
+      SVN_ERR(read_number(&num, reader, pool));
+      (*pi)->rev = (svn_revnum_t)num;
+    }
+  else
+    (*pi)->rev = SVN_INVALID_REVNUM;
+
+  if (flags & REPORT_FLAG_DEPTH)
     SVN_ERR(read_depth(&((*pi)->depth), reader, (*pi)->path, pool));
   else
     (*pi)->depth = svn_depth_infinity;
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  (*pi)->start_empty = (c == '+');
-  SVN_ERR(svn_spillbuf__reader_getc(&c, reader, pool));
-  if (c == '+')
+
+  (*pi)->start_empty = (flags & REPORT_FLAG_START_EMPTY) != 0;
+
+  if (flags & REPORT_FLAG_LOCK_TOKEN)
     SVN_ERR(read_string(&(*pi)->lock_token, reader, pool));
   else
     (*pi)->lock_token = NULL;
+
   (*pi)->pool = pool;
   return SVN_NO_ERROR;
 }
@@ -1160,10 +1169,11 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
            svn_boolean_t start_empty, svn_depth_t wc_depth,
            svn_depth_t requested_depth, apr_pool_t *pool)
 {
-  apr_hash_t *s_entries = NULL, *t_entries;
+  apr_hash_t *s_entries = NULL, *t_entries = NULL;
   apr_hash_index_t *hi;
   apr_pool_t *subpool = svn_pool_create(pool);
   apr_array_header_t *t_ordered_entries = NULL;
+  svn_boolean_t prune_dirents;
   int i;
 
   /* Compare the property lists.  If we're starting empty, pass a NULL
@@ -1179,15 +1189,32 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
     {
       apr_pool_t *iterpool;
 
+      /* Pre-prune the dirent sweeps for sparse subtrees.  If the
+         client has this directory at depth 'empty' and did not request
+         a deeper depth, the tables above ignore every entry the report
+         does not mention ('X' in the 'unknown' column) and the
+         deletion sweep sends nothing either.  Only explicitly reported
+         children matter, so skip listing the source and target
+         directories entirely and look those few names up one by one
+         in the loop below.  For large mostly-excluded trees this is
+         where almost all of the server's comparison work would go. */
+      prune_dirents = (requested_depth == svn_depth_unknown
+                       && wc_depth == svn_depth_empty);
+
       /* Get the list of entries in each of source and target. */
-      if (s_path && !start_empty)
+      if (!prune_dirents)
         {
-          svn_fs_root_t *s_root;
+          if (s_path && !start_empty)
+            {
+              svn_fs_root_t *s_root;
 
-          SVN_ERR(get_source_root(b, &s_root, s_rev));
-          SVN_ERR(svn_fs_dir_entries(&s_entries, s_root, s_path, subpool));
+              SVN_ERR(get_source_root(b, &s_root, s_rev));
+              SVN_ERR(svn_fs_dir_entries(&s_entries, s_root, s_path,
+                                         subpool));
+            }
+          SVN_ERR(svn_fs_dir_entries(&t_entries, b->t_root, t_path,
+                                     subpool));
         }
-      SVN_ERR(svn_fs_dir_entries(&t_entries, b->t_root, t_path, subpool));
 
       /* Iterate over the report information for this directory. */
       iterpool = svn_pool_create(subpool);
@@ -1223,9 +1250,26 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
 
           e_fullpath = svn_relpath_join(e_path, name, iterpool);
           t_fullpath = svn_fspath__join(t_path, name, iterpool);
-          t_entry = svn_hash_gets(t_entries, name);
           s_fullpath = s_path ? svn_fspath__join(s_path, name, iterpool) : NULL;
-          s_entry = s_entries ? svn_hash_gets(s_entries, name) : NULL;
+
+          /* With pruned dirent sweeps we have no entry hashes; look the
+             few reported names up individually instead. */
+          if (t_entries)
+            t_entry = svn_hash_gets(t_entries, name);
+          else
+            SVN_ERR(fake_dirent(&t_entry, b->t_root, t_fullpath, iterpool));
+
+          if (s_entries)
+            s_entry = svn_hash_gets(s_entries, name);
+          else if (prune_dirents && s_fullpath && !start_empty)
+            {
+              svn_fs_root_t *s_root;
+
+              SVN_ERR(get_source_root(b, &s_root, s_rev));
+              SVN_ERR(fake_dirent(&s_entry, s_root, s_fullpath, iterpool));
+            }
+          else
+            s_entry = NULL;
 
           /* The only special cases where we don't process the entry are
 
@@ -1246,7 +1290,8 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
                                  DEPTH_BELOW_HERE(requested_depth), iterpool));
 
           /* Don't revisit this name in the target or source entries. */
-          svn_hash_sets(t_entries, name, NULL);
+          if (t_entries)
+            svn_hash_sets(t_entries, name, NULL);
           if (s_entries
               /* Keep the entry for later process if it is reported as
                  excluded and got deleted in repos. */
@@ -1301,53 +1346,60 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
             }
         }
 
-      /* Loop over the dirents in the target. */
-      SVN_ERR(svn_fs_dir_optimal_order(&t_ordered_entries, b->t_root,
-                                       t_entries, subpool, iterpool));
-      for (i = 0; i < t_ordered_entries->nelts; ++i)
+      /* Loop over the dirents in the target.  With pruned dirent
+         sweeps there is nothing left to do: every unreported entry is
+         ignored at this depth combination. */
+      if (t_entries)
         {
-          const svn_fs_dirent_t *t_entry
-             = APR_ARRAY_IDX(t_ordered_entries, i, svn_fs_dirent_t *);
-          const svn_fs_dirent_t *s_entry;
-          const char *s_fullpath, *t_fullpath, *e_fullpath;
+          SVN_ERR(svn_fs_dir_optimal_order(&t_ordered_entries, b->t_root,
+                                           t_entries, subpool, iterpool));
+          for (i = 0; i < t_ordered_entries->nelts; ++i)
+            {
+              const svn_fs_dirent_t *t_entry
+                 = APR_ARRAY_IDX(t_ordered_entries, i, svn_fs_dirent_t *);
+              const svn_fs_dirent_t *s_entry;
+              const char *s_fullpath, *t_fullpath, *e_fullpath;
 
-          svn_pool_clear(iterpool);
+              svn_pool_clear(iterpool);
 
-          if (is_depth_upgrade(wc_depth, requested_depth, t_entry->kind))
-            {
-              /* We're making the working copy deeper, pretend the source
-                 doesn't exist. */
-              s_entry = NULL;
-              s_fullpath = NULL;
-            }
-          else
-            {
-              if (t_entry->kind == svn_node_file
-                  && requested_depth == svn_depth_unknown
-                  && wc_depth < svn_depth_files)
-                continue;
-
-              if (t_entry->kind == svn_node_dir
-                  && (wc_depth < svn_depth_immediates
-                      || requested_depth == svn_depth_files))
-                continue;
-
-              /* Look for an entry with the same name in the source dirents. */
-              s_entry = s_entries ?
-                  svn_hash_gets(s_entries, t_entry->name) : NULL;
-              s_fullpath = s_entry ?
-                  svn_fspath__join(s_path, t_entry->name, iterpool) : NULL;
-            }
+              if (is_depth_upgrade(wc_depth, requested_depth, t_entry->kind))
+                {
+                  /* We're making the working copy deeper, pretend the source
+                     doesn't exist. */
+                  s_entry = NULL;
+                  s_fullpath = NULL;
+                }
+              else
+                {
+                  if (t_entry->kind == svn_node_file
+                      && requested_depth == svn_depth_unknown
+                      && wc_depth < svn_depth_files)
+                    continue;
+
+                  if (t_entry->kind == svn_node_dir
+                      && (wc_depth < svn_depth_immediates
+                          || requested_depth == svn_depth_files))
+                    continue;
+
+                  /* Look for an entry with the same name in the source
+                     dirents. */
+                  s_entry = s_entries ?
+                      svn_hash_gets(s_entries, t_entry->name) : NULL;
+                  s_fullpath = s_entry ?
+                      svn_fspath__join(s_path, t_entry->name, iterpool) : NULL;
+                }
 
-          /* Compose the report, editor, and target paths for this entry. */
-          e_fullpath = svn_relpath_join(e_path, t_entry->name, iterpool);
-          t_fullpath = svn_fspath__join(t_path, t_entry->name, iterpool);
+              /* Compose the report, editor, and target paths for this
+                 entry. */
+              e_fullpath = svn_relpath_join(e_path, t_entry->name, iterpool);
+              t_fullpath = svn_fspath__join(t_path, t_entry->name, iterpool);
 
-          SVN_ERR(update_entry(b, s_rev, s_fullpath, s_entry, t_fullpath,
-                               t_entry, dir_baton, e_fullpath, NULL,
-                               DEPTH_BELOW_HERE(wc_depth),
-                               DEPTH_BELOW_HERE(requested_depth),
-                               iterpool));
+              SVN_ERR(update_entry(b, s_rev, s_fullpath, s_entry, t_fullpath,
+                                   t_entry, dir_baton, e_fullpath, NULL,
+                                   DEPTH_BELOW_HERE(wc_depth),
+                                   DEPTH_BELOW_HERE(requested_depth),
+                                   iterpool));
+            }
         }
 
       /* iterpool is destroyed by destroying its parent (subpool) below */
@@ -1408,9 +1460,25 @@ drive(report_baton_t *b, svn_revnum_t s_rev, path_info_t *info,
   /* If the anchor is the operand, diff the two directories; otherwise
      update the operand within the anchor directory. */
   if (!*b->s_operand)
-    SVN_ERR(delta_dirs(b, s_rev, s_fullpath, b->t_path, root_baton,
-                       "", info->start_empty, info->depth, b->requested_depth,
-                       pool));
+    {
+      /* If source and target are the very same node, the report carries
+         no further instructions and no depth upgrade was requested, the
+         drive is a no-op below the root.  Skip the entry-by-entry
+         comparison; update_entry() performs the same shortcut for every
+         directory below this one. */
+      if (s_fullpath && s_entry
+          && !info->start_empty && !info->lock_token
+          && b->requested_depth <= info->depth
+          && !any_path_info(b, "")
+          && svn_fs_compare_ids(s_entry->id, t_entry->id) == 0)
+        {
+          /* no-op */
+        }
+      else
+        SVN_ERR(delta_dirs(b, s_rev, s_fullpath, b->t_path, root_baton,
+                           "", info->start_empty, info->depth,
+                           b->requested_depth, pool));
+    }
   else
     SVN_ERR(update_entry(b, s_rev, s_fullpath, s_entry, b->t_path,
                          t_entry, root_baton, b->s_operand, info,
@@ -1432,7 +1500,7 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
   b->pool = pool;
 
   /* Add the end marker. */
-  SVN_ERR(svn_spillbuf__reader_write(b->reader, "-", 1, pool));
+  SVN_ERR(svn_spillbuf__reader_write(b->reader, "\x00", 1, pool));
 
   /* Read the first pathinfo from the report and verify that it is a top-level
      set_path entry. */
@@ -1486,6 +1554,27 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
 
 /* --- COLLECTING THE REPORT INFORMATION --- */
 
+/* Append NUMBER in 7b/8b encoding to REC. */
+static void
+write_number(svn_stringbuf_t *rec, apr_uint64_t number)
+{
+  unsigned char buffer[SVN__MAX_ENCODED_UINT_LEN];
+  unsigned char *end = svn__encode_uint(buffer, number);
+
+  svn_stringbuf_appendbytes(rec, (const char *)buffer,
+                            end - buffer);
+}
+
+/* Append the length-counted string STR to REC. */
+static void
+write_string(svn_stringbuf_t *rec, const char *str)
+{
+  apr_size_t len = strlen(str);
+
+  write_number(rec, len);
+  svn_stringbuf_appendbytes(rec, str, len);
+}
+
 /* Record a report operation into the spill buffer.  Return an error
    if DEPTH is svn_depth_unknown. */
 static svn_error_t *
@@ -1494,39 +1583,55 @@ write_path_info(report_baton_t *b, const char *path, const char *lpath,
                 svn_boolean_t start_empty,
                 const char *lock_token, apr_pool_t *pool)
 {
-  const char *lrep, *rrep, *drep, *ltrep, *rep;
+  char depth_code = 0;
+  unsigned char flags = 0;
+  svn_stringbuf_t *rec;
 
   /* Munge the path to be anchor-relative, so that we can use edit paths
      as report paths. */
   path = svn_relpath_join(b->s_operand, path, pool);
 
-  lrep = lpath ? apr_psprintf(pool, "+%" APR_SIZE_T_FMT ":%s",
-                              strlen(lpath), lpath) : "-";
-  rrep = (SVN_IS_VALID_REVNUM(rev)) ?
-    apr_psprintf(pool, "+%ld:", rev) : "-";
-
   if (depth == svn_depth_exclude)
-    drep = "+X";
+    depth_code = 'X';
   else if (depth == svn_depth_empty)
-    drep = "+E";
+    depth_code = 'E';
   else if (depth == svn_depth_files)
-    drep = "+F";
+    depth_code = 'F';
   else if (depth == svn_depth_immediates)
-    drep = "+M";
-  else if (depth == svn_depth_infinity)
-    drep = "-";
-  else
+    depth_code = 'M';
+  else if (depth != svn_depth_infinity)
     return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
                              _("Unsupported report depth '%s'"),
                              svn_depth_to_word(depth));
 
-  ltrep = lock_token ? apr_psprintf(pool, "+%" APR_SIZE_T_FMT ":%s",
-                                    strlen(lock_token), lock_token) : "-";
-  rep = apr_psprintf(pool, "+%" APR_SIZE_T_FMT ":%s%s%s%s%c%s",
-                     strlen(path), path, lrep, rrep, drep,
-                     start_empty ? '+' : '-', ltrep);
+  if (lpath)
+    flags |= REPORT_FLAG_LINK_PATH;
+  if (SVN_IS_VALID_REVNUM(rev))
+    flags |= REPORT_FLAG_REV;
+  if (depth_code)
+    flags |= REPORT_FLAG_DEPTH;
+  if (start_empty)
+    flags |= REPORT_FLAG_START_EMPTY;
+  if (lock_token)
+    flags |= REPORT_FLAG_LOCK_TOKEN;
+
+  /* Assemble the whole record in memory so the spill-buffer sees just
+     one write per reported path. */
+  rec = svn_stringbuf_create_ensure(strlen(path) + 16, pool);
+  svn_stringbuf_appendbyte(rec, REPORT_REC_ENTRY);
+  svn_stringbuf_appendbyte(rec, (char)flags);
+  write_string(rec, path);
+  if (lpath)
+    write_string(rec, lpath);
+  if (SVN_IS_VALID_REVNUM(rev))
+    write_number(rec, (apr_uint64_t)rev);
+  if (depth_code)
+    svn_stringbuf_appendbyte(rec, depth_code);
+  if (lock_token)
+    write_string(rec, lock_token);
+
   return svn_error_trace(
-            svn_spillbuf__reader_write(b->reader, rep, strlen(rep), pool));
+            svn_spillbuf__reader_write(b->reader, rec->data, rec->len, pool));
 }
 
 svn_error_t *
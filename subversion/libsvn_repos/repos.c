@@ -979,7 +979,14 @@ create_conf(svn_repos_t *repos, apr_pool_t *pool)
 ""                                                                           NL
 "### This sets the PATH environment variable for the pre-commit hook."       NL
 "[pre-commit]"                                                               NL
-"PATH = /usr/local/bin:/usr/bin:/usr/sbin"                                   NL;
+"PATH = /usr/local/bin:/usr/bin:/usr/sbin"                                   NL
+""                                                                           NL
+"### Setting the special variable SVN_HOOK_ASYNC to 'yes' in the"            NL
+"### [post-commit] or [post-revprop-change] section makes that hook run"     NL
+"### asynchronously: the triggering operation completes without waiting"     NL
+"### for the hook, and the hook's exit code and stderr output are ignored."  NL
+"# [post-commit]"                                                            NL
+"# SVN_HOOK_ASYNC = yes"                                                     NL;
 
     SVN_ERR_W(svn_io_file_create(svn_dirent_join(repos->conf_path,
                                                  SVN_REPOS__CONF_HOOKS_ENV \
@@ -92,6 +92,12 @@ extern "C" {
 #define SVN_REPOS__CONF_HOOKS_ENV "hooks-env"
 /* The name of the default section in the hooks-env config file. */
 #define SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION "default"
+/* A pseudo environment variable in the hooks-env config file.  If it is
+ * set to a true boolean value in the section of a post-commit or
+ * post-revprop-change hook, that hook is dispatched asynchronously: the
+ * triggering operation does not wait for the hook and the hook's exit
+ * code and stderr output are ignored. */
+#define SVN_REPOS__HOOKS_ENV_ASYNC "SVN_HOOK_ASYNC"
 
 /* The configuration file for svnserve, in the repository conf directory. */
 #define SVN_REPOS__CONF_SVNSERVE_CONF "svnserve.conf"
@@ -33,9 +33,33 @@
 #include "svn_io.h"
 #include "svn_error.h"
 #include "svn_base64.h"
+#include "private/svn_atomic.h"
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 
+/* Decide at compile time whether we can provide the SSSE3 encode and
+ * decode kernels.  Like the UTF-8 validator in utf_validate.c, they
+ * rely on per-function target attributes (or MSVC, which allows all
+ * intrinsics unconditionally), so that the rest of the library can
+ * still be built for a generic CPU; the kernels are only entered after
+ * a run-time CPUID check.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+# if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8)
+#  define SVN_INTERNAL_BASE64_SSSE3 1
+#  define SVN_INTERNAL_BASE64_TARGET __attribute__((target("ssse3")))
+#  include <immintrin.h>
+#  include <cpuid.h>
+# endif
+#elif defined(_M_X64) || defined(_M_IX86)
+# if defined(_MSC_VER) && _MSC_VER >= 1910
+#  define SVN_INTERNAL_BASE64_SSSE3 1
+#  define SVN_INTERNAL_BASE64_TARGET
+#  include <immintrin.h>
+#  include <intrin.h>
+# endif
+#endif
+
 /* When asked to format the base64-encoded output as multiple lines,
    we put this many chars in each line (plus one new line char) unless
    we run out of data.
@@ -50,6 +74,247 @@
 static const char base64tab[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ" \
                                 "abcdefghijklmnopqrstuvwxyz0123456789+/";
 
+
+#ifdef SVN_INTERNAL_BASE64_SSSE3
+
+/* SSSE3 kernels translating between 12 raw bytes and 16 base64 chars
+ * per step, replacing the byte-wise table lookups of the generic code.
+ * Both the 6-bit extraction and the alphabet mapping follow Mula &
+ * Lemire, "Base64 encoding and decoding at almost the speed of a
+ * memory copy" (Software: Practice & Experience 50(2), 2020).
+ */
+
+/* Encode the first 12 bytes of INPUT into 16 base64 chars. */
+SVN_INTERNAL_BASE64_TARGET
+static __m128i
+encode_block_ssse3(__m128i input)
+{
+  /* Gather the four 3-byte groups such that each 32-bit lane holds one
+     group in the byte order the multiplications below expect. */
+  const __m128i shuffled
+    = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                            7, 6, 8, 7, 10, 9, 11, 10));
+
+  /* Spread the four 6-bit units of every group over the four bytes of
+     its lane.  The multiplications are cheap per-16-bit-word shifts. */
+  const __m128i t0 = _mm_and_si128(shuffled, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(shuffled, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  /* Translate the values 0..63 into ASCII without a 64-byte lookup:
+     classify each value by the contiguous alphabet range it falls into
+     and add the offset of that range. */
+  const __m128i offset_lut
+    = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                    '/' - 63, 'A', 0, 0);
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  __m128i selector = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+
+  selector = _mm_or_si128(selector, _mm_and_si128(less,
+                                                  _mm_set1_epi8(13)));
+  return _mm_add_epi8(indices, _mm_shuffle_epi8(offset_lut, selector));
+}
+
+/* Encode 12-byte groups from *DATA, appending the base64 chars to STR
+ * and updating *DATA and *LEN, until fewer than 16 bytes are left.
+ * The 16-byte loads must stay inside the input buffer, hence the
+ * 4-byte over-read margin.  STR must have enough room pre-allocated
+ * for the complete output (see encode_bytes).
+ */
+SVN_INTERNAL_BASE64_TARGET
+static void
+encode_bulk_ssse3(svn_stringbuf_t *str, const char **data, apr_size_t *len)
+{
+  const char *p = *data;
+  char *out = str->data + str->len;
+
+  while (*len >= sizeof(__m128i))
+    {
+      const __m128i input = _mm_loadu_si128((const __m128i *)p);
+      _mm_storeu_si128((__m128i *)out, encode_block_ssse3(input));
+      p += 12;
+      out += 16;
+      *len -= 12;
+    }
+
+  str->len = out - str->data;
+  str->data[str->len] = '\0';
+  *data = p;
+}
+
+/* Decode the 16 base64 chars in INPUT into 12 bytes in *DECODED.
+ * Return FALSE without touching *DECODED if INPUT contains any char
+ * outside the base64 alphabet (including '=' and newlines); the
+ * caller then falls back to the generic code.
+ */
+SVN_INTERNAL_BASE64_TARGET
+static svn_boolean_t
+decode_block_ssse3(__m128i input, __m128i *decoded)
+{
+  /* Nibble-indexed class bitmasks: a bit set in both the low-nibble
+     and the high-nibble class of a byte marks it as outside the
+     base64 alphabet. */
+  const __m128i lut_lo
+    = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i lut_hi
+    = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  /* Offset mapping ASCII back onto 0..63, indexed by high nibble;
+     index 1 serves '/', which shares high nibble 2 with '+' and is
+     singled out by the comparison below. */
+  const __m128i lut_roll
+    = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                    0, 0, 0, 0, 0, 0, 0, 0);
+
+  const __m128i lo_nibbles = _mm_and_si128(input, _mm_set1_epi8(0x0f));
+  const __m128i hi_nibbles
+    = _mm_and_si128(_mm_srli_epi32(input, 4), _mm_set1_epi8(0x0f));
+  const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+  const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+  const __m128i eq_2f = _mm_cmpeq_epi8(input, _mm_set1_epi8(0x2f));
+  const __m128i roll
+    = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+
+  __m128i merged;
+
+  if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+                                       _mm_setzero_si128())) != 0)
+    return FALSE;
+
+  /* Paste the 16 6-bit values together into 12 bytes: first within
+     each 16-bit word, then within each 32-bit lane, then compact the
+     three significant bytes of every lane. */
+  merged = _mm_maddubs_epi16(_mm_add_epi8(input, roll),
+                             _mm_set1_epi32(0x01400140));
+  merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+  *decoded = _mm_shuffle_epi8(merged,
+                              _mm_setr_epi8(2, 1, 0, 6, 5, 4,
+                                            10, 9, 8, 14, 13, 12,
+                                            -1, -1, -1, -1));
+  return TRUE;
+}
+
+/* Decode whole 16-char blocks from *DATA (of length LEN) into STR
+ * until a special char or the end of the data is reached.  Update
+ * *DATA and return TRUE if at least one block was decoded.  STR must
+ * have enough room pre-allocated (see decode_bytes).
+ */
+SVN_INTERNAL_BASE64_TARGET
+static svn_boolean_t
+decode_bulk_ssse3(svn_stringbuf_t *str, const char **data, apr_size_t len)
+{
+  const char *p = *data;
+  const char *end = *data + len;
+  char buffer[sizeof(__m128i)];
+  __m128i decoded;
+
+  while ((apr_size_t)(end - p) >= sizeof(__m128i))
+    {
+      if (!decode_block_ssse3(_mm_loadu_si128((const __m128i *)p),
+                              &decoded))
+        break;
+
+      /* Only 12 of the 16 stored bytes are output, so bounce them
+         through a buffer instead of over-writing STR. */
+      _mm_storeu_si128((__m128i *)buffer, decoded);
+      memcpy(str->data + str->len, buffer, 12);
+      str->len += 12;
+      p += sizeof(__m128i);
+    }
+
+  if (p == *data)
+    return FALSE;
+
+  str->data[str->len] = '\0';
+  *data = p;
+  return TRUE;
+}
+
+/* Return whether the CPU we are running on implements SSSE3. */
+static svn_boolean_t
+base64_ssse3_cpu_support(void)
+{
+#ifdef _MSC_VER
+  int info[4];
+
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) != 0;   /* ECX: SSSE3 */
+#else
+  unsigned int eax, ebx, ecx, edx;
+
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return FALSE;
+
+  return (ecx & (1u << 9)) != 0;      /* ECX: SSSE3 */
+#endif
+}
+
+/* Run both kernels against a known answer.  Only called after the
+ * CPUID check succeeded. */
+SVN_INTERNAL_BASE64_TARGET
+static svn_boolean_t
+base64_ssse3_self_test(void)
+{
+  const char plain[] = "ABCDEFGHIJKLMNOP";
+  const char expected[] = "QUJDREVGR0hJSktM";
+  char buffer[sizeof(__m128i)];
+  __m128i decoded;
+
+  _mm_storeu_si128((__m128i *)buffer,
+                   encode_block_ssse3(
+                     _mm_loadu_si128((const __m128i *)plain)));
+  if (memcmp(buffer, expected, sizeof(buffer)) != 0)
+    return FALSE;
+
+  if (!decode_block_ssse3(_mm_loadu_si128((const __m128i *)expected),
+                          &decoded))
+    return FALSE;
+  _mm_storeu_si128((__m128i *)buffer, decoded);
+  if (memcmp(buffer, plain, 12) != 0)
+    return FALSE;
+
+  /* The decoder must leave padding to the generic code. */
+  if (decode_block_ssse3(
+        _mm_loadu_si128((const __m128i *)"QUJDREVGR0hJSk=="), &decoded))
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Set by base64_ssse3_detect(), protected by BASE64_SSSE3_DETECTED. */
+static svn_boolean_t base64_ssse3_usable = FALSE;
+static volatile svn_atomic_t base64_ssse3_detected = 0;
+
+/* svn_atomic__str_init_func_t checking for SSSE3 support.  Beyond the
+ * CPU feature bit, require both kernels to pass a known-answer test,
+ * so that a miscompiled kernel degrades to the generic code instead
+ * of corrupting user data.
+ */
+static const char *
+base64_ssse3_detect(void *baton)
+{
+  if (base64_ssse3_cpu_support())
+    base64_ssse3_usable = base64_ssse3_self_test();
+
+  return NULL;
+}
+
+/* Return whether the SSSE3 code paths may be used on this machine. */
+static svn_boolean_t
+base64_ssse3_enabled(void)
+{
+  svn_atomic__init_once_no_error(&base64_ssse3_detected,
+                                 base64_ssse3_detect, NULL);
+  return base64_ssse3_usable;
+}
+
+#endif /* SVN_INTERNAL_BASE64_SSSE3 */
+
 
 /* Binary input --> base64-encoded output */
 
@@ -140,6 +405,21 @@ encode_bytes(svn_stringbuf_t *str, const void *data, apr_size_t len,
     }
   svn_stringbuf_ensure(str, str->len + buflen);
 
+#ifdef SVN_INTERNAL_BASE64_SSSE3
+  /* For unbroken output -- the large svndiff-over-DAV case -- hand the
+     bulk of the data to the SSSE3 kernel and let the generic loop below
+     pick up the remaining partial group.  *LINELEN is not maintained
+     here since it only matters when BREAK_LINES is set. */
+  if (!break_lines && *inbuflen == 0
+      && (apr_size_t)(end - p) >= sizeof(__m128i)
+      && base64_ssse3_enabled())
+    {
+      apr_size_t remaining = end - p;
+
+      encode_bulk_ssse3(str, &p, &remaining);
+    }
+#endif
+
   /* Keep encoding three-byte groups until we run out.  */
   while ((end - p) >= (3 - *inbuflen))
     {
@@ -427,6 +707,16 @@ decode_bytes(svn_stringbuf_t *str, const char *data, apr_size_t len,
 
   while ( !*done && p < end )
     {
+#ifdef SVN_INTERNAL_BASE64_SSSE3
+      /* Decode whole blocks with the SSSE3 kernel until it runs into
+         a special char ('=', newlines) or the end of the data. */
+      if (*inbuflen == 0
+          && (apr_size_t)(end - p) >= sizeof(__m128i)
+          && base64_ssse3_enabled()
+          && decode_bulk_ssse3(str, &p, end - p))
+        continue;
+#endif
+
       /* If no data is left in temporary INBUF and there is at least
          one line-sized chunk left to decode, we may use the optimized
          code path. */
@@ -634,6 +634,7 @@ inprocess_cache_get_info(void *cache_void,
 
 static svn_cache__vtable_t inprocess_cache_vtable = {
   inprocess_cache_get,
+  NULL,                         /* get_many */
   inprocess_cache_has_key,
   inprocess_cache_set,
   inprocess_cache_iter,
@@ -687,6 +688,8 @@ svn_cache__create_inprocess(svn_cache__t **cache_p,
   wrapper->cache_internal = cache;
   wrapper->pretend_empty = !!getenv("SVN_X_DOES_NOT_MARK_THE_SPOT");
 
+  SVN_ERR(svn_cache__register(wrapper, pool));
+
   *cache_p = wrapper;
   return SVN_NO_ERROR;
 }
@@ -23,10 +23,13 @@
 
 #include <assert.h>
 #include <apr_md5.h>
+#include <apr_global_mutex.h>
+#include <apr_shm.h>
 #include <apr_thread_rwlock.h>
 
 #include "svn_pools.h"
 #include "svn_checksum.h"
+#include "svn_io.h"
 #include "svn_private_config.h"
 #include "svn_hash.h"
 #include "svn_string.h"
@@ -160,6 +163,14 @@
  */
 #define DEFAULT_MIN_SEGMENT_SIZE APR_UINT64_C(0x2000000)
 
+/* By default, don't let cache segments grow beyond this value.  Each
+ * segment is guarded by a single lock, so past this size, additional
+ * memory is better spent on more segments to reduce lock contention on
+ * many-core servers.  At this segment size, the maximum cachable item
+ * size is already in the tens of MB, i.e. plenty for all FS caches.
+ */
+#define DEFAULT_MAX_SEGMENT_SIZE APR_UINT64_C(0x8000000)
+
 /* The minimum segment size we will allow for multi-segmented caches
  */
 #define MIN_SEGMENT_SIZE APR_UINT64_C(0x10000)
@@ -240,13 +251,210 @@ typedef struct full_key_t
   svn_membuf_t full_key;
 } full_key_t;
 
+/* Trivial bump allocator dispensing chunks from a fixed-size shared
+ * memory segment.  We use this instead of pool allocation when building
+ * a cache that shall be shared between processes.  The segment is
+ * zero-filled by the OS, and chunks are never returned, so everything
+ * handed out by shm_allocate() starts out zeroed.
+ */
+typedef struct shm_alloc_t
+{
+  /* Start of the yet unused part of the segment. */
+  char *position;
+
+  /* Number of bytes still available. */
+  apr_size_t remaining;
+} shm_alloc_t;
+
+/* Return SIZE bytes from SHM_ALLOC, or NULL if the segment has been
+ * exhausted.
+ */
+static void *
+shm_allocate(shm_alloc_t *shm_alloc, apr_size_t size)
+{
+  void *result = shm_alloc->position;
+
+  size = APR_ALIGN_DEFAULT(size);
+  if (size > shm_alloc->remaining)
+    return NULL;
+
+  shm_alloc->position += size;
+  shm_alloc->remaining -= size;
+
+  return result;
+}
+
+/* Return SIZE bytes from SHM_ALLOC or, if that is NULL, from POOL.
+ * Returns NULL if a shared segment has been exhausted.
+ */
+static void *
+membuffer_allocate(shm_alloc_t *shm_alloc,
+                   apr_pool_t *pool,
+                   apr_size_t size)
+{
+  return shm_alloc ? shm_allocate(shm_alloc, size) : apr_palloc(pool, size);
+}
+
+/* Return SIZE bytes aligned to ALIGNMENT (a power of two) from SHM_ALLOC
+ * or, if that is NULL, from POOL.  Returns NULL if a shared segment has
+ * been exhausted.  Pools and shared segments only guarantee the small
+ * default alignment, so this over-allocates by up to ALIGNMENT - 1.
+ */
+static void *
+membuffer_allocate_aligned(shm_alloc_t *shm_alloc,
+                           apr_pool_t *pool,
+                           apr_size_t size,
+                           apr_size_t alignment)
+{
+  void *unaligned = membuffer_allocate(shm_alloc, pool,
+                                       size + alignment - 1);
+  if (unaligned == NULL)
+    return NULL;
+
+  return (void *)APR_ALIGN((apr_uintptr_t)unaligned, alignment);
+}
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+/* Ask the OS to back the buffer at ADDR, SIZE bytes long, with
+ * transparent huge pages where available.  For multi-GB caches, this
+ * takes most of the TLB pressure out of the random directory and data
+ * accesses.  Best-effort:  only whole pages within the buffer are
+ * advised and failure simply keeps the normal page size.
+ */
+static void
+advise_huge_pages(void *addr, apr_size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const apr_size_t page_size = (apr_size_t)sysconf(_SC_PAGESIZE);
+  char *start = (char *)APR_ALIGN((apr_uintptr_t)addr, page_size);
+  char *end = (char *)(((apr_uintptr_t)addr + size)
+                       & ~(apr_uintptr_t)(page_size - 1));
+
+  if (end > start)
+    madvise(start, end - start, MADV_HUGEPAGE);
+#else
+  (void)addr;
+  (void)size;
+#endif
+}
+
+#ifdef SVN_ENABLE_NUMA_INTERLEAVE
+
+/* Opt-in NUMA support (Linux-only):  On multi-socket machines, the
+ * first-touch default policy tends to concentrate a cache segment's
+ * pages on the node of whichever thread populated it first, while the
+ * key-to-segment hash spreads lookups from all threads evenly over all
+ * segments.  Remote-node lookups then dominate.  Interleaving the page
+ * placement of each segment's buffers over all nodes evens that out.
+ *
+ * This uses the raw mbind() syscall, so no libnuma dependency is
+ * needed.  Everything in here is best-effort:  if anything fails, the
+ * cache simply keeps the default placement.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#if defined(__linux__) && defined(SYS_mbind)
+
+/* From linux/mempolicy.h, which may not be installed. */
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+/* Mask of online NUMA nodes (we support the first 64), or 0 if there
+ * is nothing to interleave over.  Filled by numa_initialize(). */
+static unsigned long numa_node_mask = 0;
+static volatile svn_atomic_t numa_init_state = 0;
+
+/* Implements svn_atomic__str_init_func_t:  Read the online node list
+ * (e.g. "0-3" or "0,2") from sysfs into NUMA_NODE_MASK. */
+static const char *
+numa_initialize(void *baton)
+{
+  FILE *file = fopen("/sys/devices/system/node/online", "r");
+  char buffer[256];
+  unsigned long mask = 0;
+
+  if (file == NULL)
+    return NULL;
+
+  if (fgets(buffer, sizeof(buffer), file) != NULL)
+    {
+      const char *p = buffer;
+      while (*p >= '0' && *p <= '9')
+        {
+          unsigned long first = strtoul(p, (char **)&p, 10);
+          unsigned long last = first;
+
+          if (*p == '-')
+            last = strtoul(p + 1, (char **)&p, 10);
+          for (; first <= last && first < 8 * sizeof(mask); ++first)
+            mask |= 1ul << first;
+
+          if (*p != ',')
+            break;
+          ++p;
+        }
+    }
+
+  fclose(file);
+
+  /* A single node means there is nothing to distribute. */
+  if ((mask & (mask - 1)) != 0)
+    numa_node_mask = mask;
+
+  return NULL;
+}
+
+/* Ask the OS to interleave the page placement of the buffer at ADDR,
+ * SIZE bytes long, over all online NUMA nodes.  Only whole pages within
+ * the buffer are affected; pages already faulted in keep their node. */
+static void
+numa_interleave(void *addr, apr_size_t size)
+{
+  const apr_size_t page_size = (apr_size_t)sysconf(_SC_PAGESIZE);
+  char *start, *end;
+
+  svn_atomic__init_once_no_error(&numa_init_state, numa_initialize, NULL);
+  if (numa_node_mask == 0)
+    return;
+
+  /* mbind() requires page alignment; shrink to the contained pages. */
+  start = (char *)APR_ALIGN((apr_uintptr_t)addr, page_size);
+  end = (char *)(((apr_uintptr_t)addr + size) & ~(apr_uintptr_t)(page_size - 1));
+  if (end <= start)
+    return;
+
+  /* Best effort; ignore the result. */
+  syscall(SYS_mbind, start, (unsigned long)(end - start), MPOL_INTERLEAVE,
+          &numa_node_mask, (unsigned long)(8 * sizeof(numa_node_mask)),
+          0ul);
+}
+
+#else  /* !__linux__ || !SYS_mbind */
+#define numa_interleave(addr, size) ((void)0)
+#endif
+
+#else  /* !SVN_ENABLE_NUMA_INTERLEAVE */
+#define numa_interleave(addr, size) ((void)0)
+#endif
+
 /* A limited capacity, thread-safe pool of unique C strings.  Operations on
  * this data structure are defined by prefix_pool_* functions.  The only
  * "public" member is VALUES (r/o access only).
  */
 typedef struct prefix_pool_t
 {
-  /* Map C string to a pointer into VALUES with the same contents. */
+  /* Map C string to a pointer into VALUES with the same contents.
+   * NULL for pools in shared memory; those use a linear search over
+   * VALUES instead because APR hashes cannot live in shared memory. */
   apr_hash_t *map;
 
   /* Pointer to an array of strings. These are the contents of this pool
@@ -267,18 +475,34 @@ typedef struct prefix_pool_t
    * the implementation may . */
   apr_size_t bytes_used;
 
-  /* The serialization object. */
+  /* For pools in shared memory: string arena that the VALUES entries
+   * point into, ARENA_USED out of ARENA_SIZE bytes being in use.
+   * NULL otherwise, i.e. the strings then live in the MAP's pool. */
+  char *arena;
+  apr_size_t arena_size;
+  apr_size_t arena_used;
+
+  /* The serialization object.  NULL (i.e. no-op) for pools in shared
+   * memory; those are serialized via GLOBAL_MUTEX instead. */
   svn_mutex__t *mutex;
+
+  /* Cross-process serialization for pools in shared memory, created by
+   * the process that created the cache and valid in all processes
+   * fork()ed off it.  NULL for ordinary per-process pools. */
+  apr_global_mutex_t *global_mutex;
 } prefix_pool_t;
 
 /* Set *PREFIX_POOL to a new instance that tries to limit allocation to
  * BYTES_MAX bytes.  If MUTEX_REQUIRED is set and multi-threading is
- * supported, serialize all access to the new instance.  Allocate the
- * object from *RESULT_POOL. */
+ * supported, serialize all access to the new instance.  If SHM_ALLOC is
+ * not NULL, place the instance in that shared memory segment and use a
+ * cross-process mutex for serialization.  Allocate per-process parts of
+ * the object from *RESULT_POOL. */
 static svn_error_t *
 prefix_pool_create(prefix_pool_t **prefix_pool,
                    apr_size_t bytes_max,
                    svn_boolean_t mutex_required,
+                   shm_alloc_t *shm_alloc,
                    apr_pool_t *result_pool)
 {
   enum
@@ -295,20 +519,56 @@ prefix_pool_create(prefix_pool_t **prefix_pool,
                             bytes_max / ESTIMATED_BYTES_PER_ENTRY);
 
   /* Construct the result struct. */
-  prefix_pool_t *result = apr_pcalloc(result_pool, sizeof(*result));
-  result->map = svn_hash__make(result_pool);
+  prefix_pool_t *result;
+
+  if (shm_alloc)
+    {
+      /* Shared instance: everything that other processes need to see
+       * must live in the shared segment; the strings go into a simple
+       * arena there because APR hashes and pools are per-process. */
+      apr_status_t status;
+
+      result = shm_allocate(shm_alloc, sizeof(*result));
+      if (result == NULL)
+        return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+
+      result->map = NULL;
+      result->values = capacity
+                     ? shm_allocate(shm_alloc,
+                                    capacity * sizeof(const char *))
+                     : NULL;
+      result->arena_size = bytes_max;
+      result->arena = shm_allocate(shm_alloc, result->arena_size);
+      if (   (capacity && result->values == NULL)
+          || result->arena == NULL)
+        return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+
+      SVN_ERR(svn_mutex__init(&result->mutex, FALSE, result_pool));
+      status = apr_global_mutex_create(&result->global_mutex, NULL,
+                                       APR_LOCK_DEFAULT, result_pool);
+      if (status)
+        return svn_error_wrap_apr(status,
+                                  _("Can't create cache mutex"));
+    }
+  else
+    {
+      result = apr_pcalloc(result_pool, sizeof(*result));
+      result->map = svn_hash__make(result_pool);
+
+      result->values = capacity
+                     ? apr_pcalloc(result_pool,
+                                   capacity * sizeof(const char *))
+                     : NULL;
+
+      SVN_ERR(svn_mutex__init(&result->mutex, mutex_required, result_pool));
+    }
 
-  result->values = capacity
-                 ? apr_pcalloc(result_pool, capacity * sizeof(const char *))
-                 : NULL;
   result->values_max = (apr_uint32_t)capacity;
   result->values_used = 0;
 
   result->bytes_max = bytes_max;
   result->bytes_used = capacity * sizeof(svn_membuf_t);
 
-  SVN_ERR(svn_mutex__init(&result->mutex, mutex_required, result_pool));
-
   /* Done. */
   *prefix_pool = result;
   return SVN_NO_ERROR;
@@ -340,13 +600,28 @@ prefix_pool_get_internal(apr_uint32_t *prefix_idx,
   apr_pool_t *pool;
 
   /* Lookup.  If we already know that prefix, return its index. */
-  value = apr_hash_get(prefix_pool->map, prefix, prefix_len);
-  if (value != NULL)
+  if (prefix_pool->map)
     {
-      const apr_size_t idx = value - prefix_pool->values;
-      SVN_ERR_ASSERT(idx < prefix_pool->values_used);
-      *prefix_idx = (apr_uint32_t) idx;
-      return SVN_NO_ERROR;
+      value = apr_hash_get(prefix_pool->map, prefix, prefix_len);
+      if (value != NULL)
+        {
+          const apr_size_t idx = value - prefix_pool->values;
+          SVN_ERR_ASSERT(idx < prefix_pool->values_used);
+          *prefix_idx = (apr_uint32_t) idx;
+          return SVN_NO_ERROR;
+        }
+    }
+  else
+    {
+      /* Shared instance.  There are only a few prefixes (one per cache
+       * front-end) and lookups are rare, so a linear scan will do. */
+      apr_uint32_t idx;
+      for (idx = 0; idx < prefix_pool->values_used; ++idx)
+        if (strcmp(prefix_pool->values[idx], prefix) == 0)
+          {
+            *prefix_idx = idx;
+            return SVN_NO_ERROR;
+          }
     }
 
   /* Capacity checks. */
@@ -365,11 +640,26 @@ prefix_pool_get_internal(apr_uint32_t *prefix_idx,
     }
 
   /* Add new entry. */
-  pool = apr_hash_pool_get(prefix_pool->map);
-
   value = &prefix_pool->values[prefix_pool->values_used];
-  *value = apr_pstrndup(pool, prefix, prefix_len + 1);
-  apr_hash_set(prefix_pool->map, *value, prefix_len, value);
+  if (prefix_pool->map)
+    {
+      pool = apr_hash_pool_get(prefix_pool->map);
+      *value = apr_pstrndup(pool, prefix, prefix_len + 1);
+      apr_hash_set(prefix_pool->map, *value, prefix_len, value);
+    }
+  else
+    {
+      /* Shared instance: copy the string into the shared arena. */
+      if (prefix_pool->arena_size - prefix_pool->arena_used < prefix_len + 1)
+        {
+          *prefix_idx = NO_INDEX;
+          return SVN_NO_ERROR;
+        }
+
+      *value = memcpy(prefix_pool->arena + prefix_pool->arena_used,
+                      prefix, prefix_len + 1);
+      prefix_pool->arena_used += prefix_len + 1;
+    }
 
   *prefix_idx = prefix_pool->values_used;
   ++prefix_pool->values_used;
@@ -384,6 +674,23 @@ prefix_pool_get(apr_uint32_t *prefix_idx,
                 prefix_pool_t *prefix_pool,
                 const char *prefix)
 {
+  if (prefix_pool->global_mutex)
+    {
+      /* Shared instance: serialize with the other processes. */
+      svn_error_t *err;
+      apr_status_t status = apr_global_mutex_lock(prefix_pool->global_mutex);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't lock cache mutex"));
+
+      err = prefix_pool_get_internal(prefix_idx, prefix_pool, prefix);
+
+      status = apr_global_mutex_unlock(prefix_pool->global_mutex);
+      if (status && !err)
+        err = svn_error_wrap_apr(status, _("Can't unlock cache mutex"));
+
+      return err;
+    }
+
   SVN_MUTEX__WITH_LOCK(prefix_pool->mutex,
                        prefix_pool_get_internal(prefix_idx, prefix_pool,
                                                 prefix));
@@ -620,6 +927,8 @@ typedef struct group_header_t
 /* The size of the group struct should be a power of two make sure it does
  * not cross memory page boundaries.  Since we already access the cache
  * randomly, having two page table lookups instead of one is bad.
+ * The directory base gets aligned to this value as well, so a group is
+ * guaranteed to span neither a page nor a cache line boundary.
  */
 #define GROUP_BLOCK_SIZE 512
 
@@ -813,6 +1122,13 @@ struct svn_membuffer_t
   svn_boolean_t allow_blocking_writes;
 #endif
 
+  /* Cross-process lock for cache segments that live in shared memory,
+   * or NULL for ordinary per-process caches.  Created by the process
+   * that created the cache and valid in all processes fork()ed off it.
+   * When set, it also serializes the threads within each process, i.e.
+   * the intra-process LOCK above remains unused. */
+  apr_global_mutex_t *global_lock;
+
   /* A write lock counter, must be either 0 or 1.
    * This one is only used in debug assertions to verify that you used
    * the correct multi-threading settings. */
@@ -828,6 +1144,15 @@ struct svn_membuffer_t
 static svn_error_t *
 read_lock_cache(svn_membuffer_t *cache)
 {
+  if (cache->global_lock)
+    {
+      apr_status_t status = apr_global_mutex_lock(cache->global_lock);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't lock cache mutex"));
+
+      return SVN_NO_ERROR;
+    }
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -851,6 +1176,15 @@ read_lock_cache(svn_membuffer_t *cache)
 static svn_error_t *
 write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 {
+  if (cache->global_lock)
+    {
+      apr_status_t status = apr_global_mutex_lock(cache->global_lock);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't write-lock cache mutex"));
+
+      return SVN_NO_ERROR;
+    }
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -888,6 +1222,15 @@ write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 static svn_error_t *
 force_write_lock_cache(svn_membuffer_t *cache)
 {
+  if (cache->global_lock)
+    {
+      apr_status_t status = apr_global_mutex_lock(cache->global_lock);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't write-lock cache mutex"));
+
+      return SVN_NO_ERROR;
+    }
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -908,6 +1251,18 @@ force_write_lock_cache(svn_membuffer_t *cache)
 static svn_error_t *
 unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 {
+  if (cache->global_lock)
+    {
+      apr_status_t status = apr_global_mutex_unlock(cache->global_lock);
+      if (err)
+        return err;
+
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't unlock cache mutex"));
+
+      return SVN_NO_ERROR;
+    }
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__unlock(cache->lock, err);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -1832,14 +2187,20 @@ ensure_data_insertable_l1(svn_membuffer_t *cache, apr_size_t size)
    * right answer. */
 }
 
-svn_error_t *
-svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
-                                  apr_size_t total_size,
-                                  apr_size_t directory_size,
-                                  apr_size_t segment_count,
-                                  svn_boolean_t thread_safe,
-                                  svn_boolean_t allow_blocking_writes,
-                                  apr_pool_t *pool)
+/* Common implementation of svn_cache__membuffer_cache_create() and
+ * svn_cache__membuffer_cache_create_shared().  If SHM_ALLOC is not NULL,
+ * place everything that must be visible to other processes in that
+ * shared memory segment and use cross-process locks.
+ */
+static svn_error_t *
+membuffer_cache_create_internal(svn_membuffer_t **cache,
+                                apr_size_t total_size,
+                                apr_size_t directory_size,
+                                apr_size_t segment_count,
+                                svn_boolean_t thread_safe,
+                                svn_boolean_t allow_blocking_writes,
+                                shm_alloc_t *shm_alloc,
+                                apr_pool_t *pool)
 {
   svn_membuffer_t *c;
   prefix_pool_t *prefix_pool;
@@ -1852,10 +2213,16 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   apr_uint64_t data_size;
   apr_uint64_t max_entry_size;
 
+  /* A shared cache is always synchronized via its cross-process locks,
+   * which also serialize the threads within each process.  Hence, no
+   * intra-process locks will be needed. */
+  if (shm_alloc)
+    thread_safe = FALSE;
+
   /* Allocate 1% of the cache capacity to the prefix string pool.
    */
   SVN_ERR(prefix_pool_create(&prefix_pool, total_size / 100, thread_safe,
-                             pool));
+                             shm_alloc, pool));
   total_size -= total_size / 100;
 
   /* Limit the total size (only relevant if we can address > 4GB)
@@ -1900,6 +2267,17 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
         ++segment_count_shift;
 
       segment_count = (apr_size_t)1 << segment_count_shift;
+
+      /* Once segments are large enough that the max. cachable item size
+       * is no longer the limiting factor, lock contention is.  Shard
+       * further until segments are back below DEFAULT_MAX_SEGMENT_SIZE,
+       * i.e. scale the lock count linearly with the cache size.  On
+       * many-core servers with large caches, the previous heuristic
+       * alone would serialize most readers on a handful of locks.
+       */
+      while (   total_size / segment_count > DEFAULT_MAX_SEGMENT_SIZE
+             && segment_count < MAX_SEGMENT_COUNT)
+        segment_count *= 2;
     }
 
   /* If we have an extremely large cache (>512 GB), the default segment
@@ -1911,7 +2289,9 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
     segment_count *= 2;
 
   /* allocate cache as an array of segments / cache objects */
-  c = apr_palloc(pool, segment_count * sizeof(*c));
+  c = membuffer_allocate(shm_alloc, pool, segment_count * sizeof(*c));
+  if (c == NULL)
+    return svn_error_wrap_apr(APR_ENOMEM, "OOM");
 
   /* Split total cache size into segments of equal size
    */
@@ -1977,13 +2357,19 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
 
       /* Allocate but don't clear / zero the directory because it would add
          significantly to the server start-up time if the caches are large.
-         Group initialization will take care of that in stead. */
-      c[seg].directory = apr_palloc(pool,
-                                    group_count * sizeof(entry_group_t));
+         Group initialization will take care of that in stead.
+         Align it to the group size, i.e. each group covers whole cache
+         lines and sits within a single memory page. */
+      c[seg].directory = membuffer_allocate_aligned(shm_alloc, pool,
+                                                    group_count
+                                                      * sizeof(entry_group_t),
+                                                    sizeof(entry_group_t));
 
       /* Allocate and initialize directory entries as "not initialized",
-         hence "unused" */
-      c[seg].group_initialized = apr_pcalloc(pool, group_init_size);
+         hence "unused".  Shared memory segments start out zero-filled. */
+      c[seg].group_initialized = shm_alloc
+                               ? shm_allocate(shm_alloc, group_init_size)
+                               : apr_pcalloc(pool, group_init_size);
 
       /* Allocate 1/4th of the data buffer to L1
        */
@@ -2004,7 +2390,8 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       c[seg].l2.current_data = c[seg].l2.start_offset;
 
       /* This cast is safe because DATA_SIZE <= MAX_SEGMENT_SIZE. */
-      c[seg].data = apr_palloc(pool, (apr_size_t)ALIGN_VALUE(data_size));
+      c[seg].data = membuffer_allocate(shm_alloc, pool,
+                                       (apr_size_t)ALIGN_VALUE(data_size));
       c[seg].data_used = 0;
       c[seg].max_entry_size = max_entry_size;
 
@@ -2016,13 +2403,43 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       /* were allocations successful?
        * If not, initialize a minimal cache structure.
        */
-      if (c[seg].data == NULL || c[seg].directory == NULL)
+      if (   c[seg].data == NULL
+          || c[seg].directory == NULL
+          || c[seg].group_initialized == NULL)
         {
           /* We are OOM. There is no need to proceed with "half a cache".
            */
           return svn_error_wrap_apr(APR_ENOMEM, "OOM");
         }
 
+      /* Both the directory and the data buffer are accessed randomly,
+       * so huge page backing takes a lot of pressure off the TLB for
+       * multi-GB caches.
+       */
+      advise_huge_pages(c[seg].directory, group_count * sizeof(entry_group_t));
+      advise_huge_pages(c[seg].data, (apr_size_t)ALIGN_VALUE(data_size));
+
+      /* Since all threads hash into all segments uniformly, spread each
+       * segment's pages over all NUMA nodes instead of leaving them on
+       * the node that happens to fault them in first.  No-op unless
+       * compiled in and running on a multi-node Linux machine.
+       */
+      numa_interleave(c[seg].directory, group_count * sizeof(entry_group_t));
+      numa_interleave(c[seg].data, (apr_size_t)ALIGN_VALUE(data_size));
+
+      /* Segments in shared memory are serialized across (and within)
+       * processes by one cross-process mutex each.
+       */
+      c[seg].global_lock = NULL;
+      if (shm_alloc)
+        {
+          apr_status_t status
+            = apr_global_mutex_create(&c[seg].global_lock, NULL,
+                                      APR_LOCK_DEFAULT, pool);
+          if (status)
+            return svn_error_wrap_apr(status, _("Can't create cache mutex"));
+        }
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
       /* A lock for intra-process synchronization to the cache, or NULL if
        * the cache's creator doesn't feel the cache needs to be
@@ -2054,6 +2471,61 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
+                                  apr_size_t total_size,
+                                  apr_size_t directory_size,
+                                  apr_size_t segment_count,
+                                  svn_boolean_t thread_safe,
+                                  svn_boolean_t allow_blocking_writes,
+                                  apr_pool_t *pool)
+{
+  return svn_error_trace(membuffer_cache_create_internal(
+                             cache, total_size, directory_size,
+                             segment_count, thread_safe,
+                             allow_blocking_writes, NULL, pool));
+}
+
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         apr_pool_t *pool)
+{
+  apr_shm_t *shm;
+  shm_alloc_t shm_alloc;
+  apr_status_t status;
+
+  /* The shared segment has to hold the data buffers, the directories
+   * and the management structures plus a little headroom for alignment
+   * losses in our simplistic allocator. */
+  apr_size_t shm_size = total_size + total_size / 16 + 0x10000;
+
+  /* Every segment will be protected by its own system-level mutex and
+   * those may be a scarce resource.  Unlike thread locks, they are also
+   * only contended between whole processes, so don't go overboard with
+   * segmentation. */
+  if (segment_count == 0 || segment_count > 16)
+    segment_count = 16;
+
+  /* Anonymous shared memory is inherited across fork() at the same
+   * address, so all pointers into the segment remain valid in every
+   * child process.  Attaching unrelated processes is not supported.
+   */
+  status = apr_shm_create(&shm, shm_size, NULL, pool);
+  if (status)
+    return svn_error_wrap_apr(status,
+                              _("Can't create shared cache memory"));
+
+  shm_alloc.position = apr_shm_baseaddr_get(shm);
+  shm_alloc.remaining = apr_shm_size_get(shm);
+
+  return svn_error_trace(membuffer_cache_create_internal(
+                             cache, total_size, directory_size,
+                             segment_count, TRUE, TRUE, &shm_alloc, pool));
+}
+
 svn_error_t *
 svn_cache__membuffer_clear(svn_membuffer_t *cache)
 {
@@ -2473,6 +2945,66 @@ membuffer_cache_get(svn_membuffer_t *cache,
   return deserializer(item, buffer, size, result_pool);
 }
 
+/* A single lookup within a batch get operation.
+ */
+typedef struct batch_lookup_t
+{
+  /* combined key for this lookup */
+  full_key_t key;
+
+  /* segment and group that may contain the respective entry */
+  svn_membuffer_t *segment;
+  apr_uint32_t group_index;
+
+  /* copy of the serialized item data, NULL if not found (yet) */
+  char *buffer;
+  apr_size_t size;
+
+  /* has this lookup been processed? */
+  svn_boolean_t done;
+
+#ifdef SVN_DEBUG_CACHE_MEMBUFFER
+  /* consistency check tag for this lookup */
+  entry_tag_t tag;
+#endif
+} batch_lookup_t;
+
+/* Perform all lookups in BATCH[FIRST .. COUNT-1] that refer to segment
+ * CACHE and have not been processed, yet.  For each entry found, store
+ * a copy of the serialized data in the lookup's BUFFER and SIZE members,
+ * allocated in RESULT_POOL.  Mark all lookups processed here as done.
+ *
+ * Note: This function requires the caller to serialization access.
+ * Don't call it directly, call svn_membuffer_cache_get_many instead.
+ */
+static svn_error_t *
+membuffer_cache_get_many_internal(svn_membuffer_t *cache,
+                                  batch_lookup_t *batch,
+                                  apr_size_t first,
+                                  apr_size_t count,
+                                  apr_pool_t *result_pool)
+{
+  apr_size_t i;
+
+  for (i = first; i < count; ++i)
+    if (batch[i].segment == cache && !batch[i].done)
+      {
+#ifdef SVN_DEBUG_CACHE_MEMBUFFER
+        entry_tag_t *tag = &batch[i].tag;
+#endif
+        SVN_ERR(membuffer_cache_get_internal(cache,
+                                             batch[i].group_index,
+                                             &batch[i].key,
+                                             &batch[i].buffer,
+                                             &batch[i].size,
+                                             DEBUG_CACHE_MEMBUFFER_TAG
+                                             result_pool));
+        batch[i].done = TRUE;
+      }
+
+  return SVN_NO_ERROR;
+}
+
 /* Look for the cache entry in group GROUP_INDEX of CACHE, identified
  * by the hash value TO_FIND.  If no item has been stored for KEY, *FOUND
  * will be FALSE and TRUE otherwise.
@@ -2958,6 +3490,92 @@ svn_membuffer_cache_get(void **value_p,
   return SVN_NO_ERROR;
 }
 
+/* Implement svn_cache__vtable_t.get_many (not thread-safe)
+ */
+static svn_error_t *
+svn_membuffer_cache_get_many(void **values,
+                             svn_boolean_t *found,
+                             void *cache_void,
+                             const void *const *keys,
+                             apr_size_t count,
+                             apr_pool_t *result_pool)
+{
+  svn_membuffer_cache_t *cache = cache_void;
+  batch_lookup_t *batch;
+  apr_size_t i;
+
+  /* Combine all keys with the cache prefix and find the segment and
+   * group that may hold the respective entry.
+   */
+  batch = apr_pcalloc(result_pool, count * sizeof(*batch));
+  for (i = 0; i < count; ++i)
+    {
+      batch_lookup_t *lookup = &batch[i];
+
+      /* special case */
+      if (keys[i] == NULL)
+        {
+          lookup->done = TRUE;
+          continue;
+        }
+
+#ifdef SVN_DEBUG_CACHE_MEMBUFFER
+      SVN_ERR(store_key_part(&lookup->tag,
+                             get_prefix_key(cache),
+                             keys[i],
+                             cache->key_len == APR_HASH_KEY_STRING
+                                 ? strlen((const char *) keys[i])
+                                 : cache->key_len,
+                             result_pool));
+#endif
+
+      combine_key(cache, keys[i], cache->key_len);
+      lookup->key.entry_key = cache->combined_key.entry_key;
+      if (cache->prefix.prefix_idx == NO_INDEX)
+        {
+          /* Long keys get compared in full.  Keep a private copy because
+           * CACHE->COMBINED_KEY will be reused by the next iteration. */
+          svn_membuf__create(&lookup->key.full_key,
+                             lookup->key.entry_key.key_len, result_pool);
+          memcpy(lookup->key.full_key.data,
+                 cache->combined_key.full_key.data,
+                 lookup->key.entry_key.key_len);
+        }
+
+      lookup->segment = cache->membuffer;
+      lookup->group_index = get_group_index(&lookup->segment,
+                                            &lookup->key.entry_key);
+    }
+
+  /* Process all lookups that hit the same segment in one go, i.e. take
+   * each segment's lock only once per batch.
+   */
+  for (i = 0; i < count; ++i)
+    if (!batch[i].done)
+      {
+        svn_membuffer_t *segment = batch[i].segment;
+        WITH_READ_LOCK(segment,
+                       membuffer_cache_get_many_internal(segment,
+                                                         batch,
+                                                         i,
+                                                         count,
+                                                         result_pool));
+      }
+
+  /* Re-construct the original data objects from their serialized form.
+   * This may be expensive, so do it outside any locks.
+   */
+  for (i = 0; i < count; ++i)
+    if (batch[i].buffer)
+      {
+        SVN_ERR(cache->deserializer(&values[i], batch[i].buffer,
+                                    batch[i].size, result_pool));
+        found[i] = values[i] != NULL;
+      }
+
+  return SVN_NO_ERROR;
+}
+
 /* Implement svn_cache__vtable_t.has_key (not thread-safe)
  */
 static svn_error_t *
@@ -2990,13 +3608,14 @@ svn_membuffer_cache_has_key(svn_boolean_t *found,
   return SVN_NO_ERROR;
 }
 
-/* Implement svn_cache__vtable_t.set (not thread-safe)
+/* Implement svn_cache__vtable_t.set_with_priority (not thread-safe)
  */
 static svn_error_t *
-svn_membuffer_cache_set(void *cache_void,
-                        const void *key,
-                        void *value,
-                        apr_pool_t *scratch_pool)
+svn_membuffer_cache_set_with_priority(void *cache_void,
+                                      const void *key,
+                                      void *value,
+                                      apr_uint32_t priority,
+                                      apr_pool_t *scratch_pool)
 {
   svn_membuffer_cache_t *cache = cache_void;
 
@@ -3018,11 +3637,26 @@ svn_membuffer_cache_set(void *cache_void,
                              &cache->combined_key,
                              value,
                              cache->serializer,
-                             cache->priority,
+                             priority,
                              DEBUG_CACHE_MEMBUFFER_TAG
                              scratch_pool);
 }
 
+/* Implement svn_cache__vtable_t.set (not thread-safe)
+ */
+static svn_error_t *
+svn_membuffer_cache_set(void *cache_void,
+                        const void *key,
+                        void *value,
+                        apr_pool_t *scratch_pool)
+{
+  svn_membuffer_cache_t *cache = cache_void;
+
+  return svn_membuffer_cache_set_with_priority(cache_void, key, value,
+                                               cache->priority,
+                                               scratch_pool);
+}
+
 /* Implement svn_cache__vtable_t.iter as "not implemented"
  */
 static svn_error_t *
@@ -3180,13 +3814,15 @@ svn_membuffer_cache_get_info(void *cache_void,
  */
 static svn_cache__vtable_t membuffer_cache_vtable = {
   svn_membuffer_cache_get,
+  svn_membuffer_cache_get_many,
   svn_membuffer_cache_has_key,
   svn_membuffer_cache_set,
   svn_membuffer_cache_iter,
   svn_membuffer_cache_is_cachable,
   svn_membuffer_cache_get_partial,
   svn_membuffer_cache_set_partial,
-  svn_membuffer_cache_get_info
+  svn_membuffer_cache_get_info,
+  svn_membuffer_cache_set_with_priority
 };
 
 /* Implement svn_cache__vtable_t.get and serialize all cache access.
@@ -3209,6 +3845,28 @@ svn_membuffer_cache_get_synced(void **value_p,
   return SVN_NO_ERROR;
 }
 
+/* Implement svn_cache__vtable_t.get_many and serialize all cache access.
+ */
+static svn_error_t *
+svn_membuffer_cache_get_many_synced(void **values,
+                                    svn_boolean_t *found,
+                                    void *cache_void,
+                                    const void *const *keys,
+                                    apr_size_t count,
+                                    apr_pool_t *result_pool)
+{
+  svn_membuffer_cache_t *cache = cache_void;
+  SVN_MUTEX__WITH_LOCK(cache->mutex,
+                       svn_membuffer_cache_get_many(values,
+                                                    found,
+                                                    cache_void,
+                                                    keys,
+                                                    count,
+                                                    result_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Implement svn_cache__vtable_t.has_key and serialize all cache access.
  */
 static svn_error_t *
@@ -3245,6 +3903,27 @@ svn_membuffer_cache_set_synced(void *cache_void,
   return SVN_NO_ERROR;
 }
 
+/* Implement svn_cache__vtable_t.set_with_priority and serialize all cache
+ * access.
+ */
+static svn_error_t *
+svn_membuffer_cache_set_with_priority_synced(void *cache_void,
+                                             const void *key,
+                                             void *value,
+                                             apr_uint32_t priority,
+                                             apr_pool_t *scratch_pool)
+{
+  svn_membuffer_cache_t *cache = cache_void;
+  SVN_MUTEX__WITH_LOCK(cache->mutex,
+                       svn_membuffer_cache_set_with_priority(cache_void,
+                                                             key,
+                                                             value,
+                                                             priority,
+                                                             scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Implement svn_cache__vtable_t.get_partial and serialize all cache access.
  */
 static svn_error_t *
@@ -3293,13 +3972,15 @@ svn_membuffer_cache_set_partial_synced(void *cache_void,
  */
 static svn_cache__vtable_t membuffer_cache_synced_vtable = {
   svn_membuffer_cache_get_synced,
+  svn_membuffer_cache_get_many_synced,
   svn_membuffer_cache_has_key_synced,
   svn_membuffer_cache_set_synced,
   svn_membuffer_cache_iter,               /* no sync required */
   svn_membuffer_cache_is_cachable,        /* no sync required */
   svn_membuffer_cache_get_partial_synced,
   svn_membuffer_cache_set_partial_synced,
-  svn_membuffer_cache_get_info            /* no sync required */
+  svn_membuffer_cache_get_info,           /* no sync required */
+  svn_membuffer_cache_set_with_priority_synced
 };
 
 /* standard serialization function for svn_stringbuf_t items.
@@ -3440,6 +4121,8 @@ svn_cache__create_membuffer_cache(svn_cache__t **cache_p,
   wrapper->error_baton = 0;
   wrapper->pretend_empty = !!getenv("SVN_X_DOES_NOT_MARK_THE_SPOT");
 
+  SVN_ERR(svn_cache__register(wrapper, result_pool));
+
   *cache_p = wrapper;
   return SVN_NO_ERROR;
 }
@@ -3478,3 +4161,265 @@ svn_cache__membuffer_get_global_info(apr_pool_t *pool)
 
   return info;
 }
+
+
+/* Warm-start image support.
+ *
+ * An image file contains a snapshot of all used cache entries in a
+ * simple sequential format:  a header line identifying format version
+ * and word size, followed by one record per entry.  Since the entry
+ * fingerprints are pure functions of prefix and key (see combine_key()),
+ * they remain valid across processes and we can re-insert the entries
+ * through the standard insertion path upon load - directory geometry,
+ * segment count etc. of the loading cache may differ freely from the
+ * cache that wrote the image.
+ */
+
+/* Binary format identifier of membuffer warm-start image files.
+ * Includes a version number and the word size, so images are never
+ * exchanged between incompatible builds. */
+#define IMAGE_HEADER \
+  "SVN-membuffer-image-1-" APR_STRINGIFY(APR_SIZEOF_VOIDP) "\n"
+
+/* Maximum plausible length of a cache key prefix.  Only used to sanity-
+ * check image files. */
+#define IMAGE_MAX_PREFIX_LEN 0x1000
+
+/* Fixed-size part of an entry record in a warm-start image file.  It is
+ * followed by PREFIX_LEN prefix chars, KEY_LEN key bytes and ITEM_SIZE
+ * bytes of serialized item data. */
+typedef struct image_record_t
+{
+  /* Entry key finger print; stable across processes. */
+  apr_uint64_t fingerprint[2];
+
+  /* Length of the trailing full key.  0 for shared-prefix entries. */
+  apr_uint64_t key_len;
+
+  /* Length of the trailing prefix string.  0 iff the prefix is not
+   * shared, i.e. already part of the full key. */
+  apr_uint64_t prefix_len;
+
+  /* Length of the trailing serialized item data. */
+  apr_uint64_t item_size;
+
+  /* Entry priority. */
+  apr_uint32_t priority;
+} image_record_t;
+
+#ifndef SVN_DEBUG_CACHE_MEMBUFFER
+
+/* Append the records for all used entries in the single segment CACHE
+ * to the image FILE.  Use SCRATCH_POOL for temporary allocations.
+ *
+ * Note: this function requires the caller to serialize access.
+ */
+static svn_error_t *
+dump_segment_image(svn_membuffer_t *cache,
+                   apr_file_t *file,
+                   apr_pool_t *scratch_pool)
+{
+  int k;
+
+  /* Walk the used-entry chains of both cache levels.  Together, they
+   * enumerate every used entry exactly once. */
+  for (k = 0; k < 2; ++k)
+    {
+      cache_level_t *level = k == 0 ? &cache->l1 : &cache->l2;
+      apr_uint32_t idx;
+
+      for (idx = level->first; idx != NO_INDEX; )
+        {
+          entry_t *entry = get_entry(cache, idx);
+          image_record_t record = { { 0 } };
+          const char *prefix = "";
+
+          if (entry->key.prefix_idx != NO_INDEX)
+            prefix = cache->prefix_pool->values[entry->key.prefix_idx];
+
+          record.fingerprint[0] = entry->key.fingerprint[0];
+          record.fingerprint[1] = entry->key.fingerprint[1];
+          record.key_len = entry->key.key_len;
+          record.prefix_len = strlen(prefix);
+          record.item_size = entry->size - entry->key.key_len;
+          record.priority = entry->priority;
+
+          SVN_ERR(svn_io_file_write_full(file, &record, sizeof(record),
+                                         NULL, scratch_pool));
+          if (record.prefix_len)
+            SVN_ERR(svn_io_file_write_full(file, prefix,
+                                           (apr_size_t)record.prefix_len,
+                                           NULL, scratch_pool));
+          if (record.key_len)
+            SVN_ERR(svn_io_file_write_full(file, cache->data + entry->offset,
+                                           (apr_size_t)record.key_len,
+                                           NULL, scratch_pool));
+          if (record.item_size)
+            SVN_ERR(svn_io_file_write_full(file,
+                                           cache->data + entry->offset
+                                             + entry->key.key_len,
+                                           (apr_size_t)record.item_size,
+                                           NULL, scratch_pool));
+
+          idx = entry->next;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* !SVN_DEBUG_CACHE_MEMBUFFER */
+
+svn_error_t *
+svn_cache__membuffer_dump_image(svn_membuffer_t *cache,
+                                const char *path,
+                                apr_pool_t *scratch_pool)
+{
+#ifdef SVN_DEBUG_CACHE_MEMBUFFER
+
+  /* The debug tags attached to each entry cannot be reconstructed by
+   * the loader, so images are not supported in this mode. */
+  return SVN_NO_ERROR;
+
+#else
+
+  apr_size_t seg;
+  apr_file_t *file;
+  const char *tmp_path = apr_pstrcat(scratch_pool, path, ".tmp",
+                                     SVN_VA_NULL);
+
+  /* Write to a temp file first such that we never leave a partial image
+   * behind - not even when being interrupted mid-way. */
+  SVN_ERR(svn_io_file_open(&file, tmp_path,
+                           APR_WRITE | APR_CREATE | APR_TRUNCATE
+                             | APR_BUFFERED,
+                           APR_OS_DEFAULT, scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, IMAGE_HEADER,
+                                 sizeof(IMAGE_HEADER) - 1, NULL,
+                                 scratch_pool));
+
+  /* Dump segment by segment, each one briefly read-locked.  The result
+   * is not an atomic snapshot of the whole cache but every single entry
+   * in it is consistent. */
+  for (seg = 0; seg < cache->segment_count; ++seg)
+    {
+      WITH_READ_LOCK(&cache[seg],
+                     dump_segment_image(&cache[seg], file, scratch_pool));
+    }
+
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+  SVN_ERR(svn_io_file_rename2(tmp_path, path, FALSE, scratch_pool));
+
+  return SVN_NO_ERROR;
+
+#endif /* SVN_DEBUG_CACHE_MEMBUFFER */
+}
+
+svn_error_t *
+svn_cache__membuffer_load_image(svn_membuffer_t *cache,
+                                const char *path,
+                                apr_pool_t *scratch_pool)
+{
+#ifdef SVN_DEBUG_CACHE_MEMBUFFER
+
+  /* See svn_cache__membuffer_dump_image(). */
+  return SVN_NO_ERROR;
+
+#else
+
+  apr_file_t *file;
+  char header[sizeof(IMAGE_HEADER)] = { 0 };
+  apr_pool_t *iterpool;
+
+  SVN_ERR(svn_io_file_open(&file, path, APR_READ | APR_BUFFERED,
+                           APR_OS_DEFAULT, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, header, sizeof(IMAGE_HEADER) - 1,
+                                 NULL, NULL, scratch_pool));
+  if (strncmp(header, IMAGE_HEADER, sizeof(IMAGE_HEADER) - 1) != 0)
+    return svn_error_createf(SVN_ERR_MALFORMED_FILE, NULL,
+                             _("'%s' is not a membuffer cache image"),
+                             path);
+
+  iterpool = svn_pool_create(scratch_pool);
+  while (TRUE)
+    {
+      image_record_t record;
+      apr_size_t len;
+      svn_boolean_t eof;
+      char *prefix, *item_data;
+      full_key_t key = { { { 0 } } };
+      svn_membuffer_t *segment;
+      apr_uint32_t group_index;
+
+      svn_pool_clear(iterpool);
+
+      /* Get the next record.  A clean EOF terminates the image. */
+      SVN_ERR(svn_io_file_read_full2(file, &record, sizeof(record),
+                                     &len, &eof, iterpool));
+      if (eof && len == 0)
+        break;
+
+      /* Sanity-check all lengths before allocating anything.  Truncated
+       * or garbled images shall fail gracefully. */
+      if (   eof
+          || record.prefix_len > IMAGE_MAX_PREFIX_LEN
+          || record.key_len > MAX_ITEM_SIZE
+          || record.item_size > MAX_ITEM_SIZE)
+        {
+          svn_pool_destroy(iterpool);
+          return svn_error_createf(SVN_ERR_MALFORMED_FILE, NULL,
+                                   _("Corrupt membuffer cache image '%s'"),
+                                   path);
+        }
+
+      prefix = apr_pcalloc(iterpool, (apr_size_t)record.prefix_len + 1);
+      SVN_ERR(svn_io_file_read_full2(file, prefix,
+                                     (apr_size_t)record.prefix_len,
+                                     NULL, NULL, iterpool));
+
+      key.entry_key.fingerprint[0] = record.fingerprint[0];
+      key.entry_key.fingerprint[1] = record.fingerprint[1];
+      key.entry_key.key_len = (apr_size_t)record.key_len;
+      if (record.prefix_len)
+        SVN_ERR(prefix_pool_get(&key.entry_key.prefix_idx,
+                                cache->prefix_pool, prefix));
+      else
+        key.entry_key.prefix_idx = NO_INDEX;
+
+      if (record.key_len)
+        {
+          svn_membuf__create(&key.full_key, key.entry_key.key_len,
+                             iterpool);
+          SVN_ERR(svn_io_file_read_full2(file, key.full_key.data,
+                                         key.entry_key.key_len,
+                                         NULL, NULL, iterpool));
+        }
+
+      item_data = apr_palloc(iterpool, (apr_size_t)record.item_size);
+      SVN_ERR(svn_io_file_read_full2(file, item_data,
+                                     (apr_size_t)record.item_size,
+                                     NULL, NULL, iterpool));
+
+      /* If the prefix pool of this cache is full, shared-prefix entries
+       * can no longer be represented.  Simply skip them. */
+      if (!record.key_len && key.entry_key.prefix_idx == NO_INDEX)
+        continue;
+
+      /* Insert through the standard insertion path. */
+      segment = cache;
+      group_index = get_group_index(&segment, &key.entry_key);
+      WITH_WRITE_LOCK(segment,
+                      membuffer_cache_set_internal(segment, &key,
+                                                   group_index,
+                                                   item_data,
+                                                   (apr_size_t)
+                                                     record.item_size,
+                                                   record.priority,
+                                                   iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return svn_error_trace(svn_io_file_close(file, scratch_pool));
+
+#endif /* SVN_DEBUG_CACHE_MEMBUFFER */
+}
@@ -392,6 +392,7 @@ memcache_get_info(void *cache_void,
 
 static svn_cache__vtable_t memcache_vtable = {
   memcache_get,
+  NULL,                         /* get_many */
   memcache_has_key,
   memcache_set,
   memcache_iter,
@@ -425,6 +426,8 @@ svn_cache__create_memcache(svn_cache__t **cache_p,
   wrapper->error_baton = 0;
   wrapper->pretend_empty = !!getenv("SVN_X_DOES_NOT_MARK_THE_SPOT");
 
+  SVN_ERR(svn_cache__register(wrapper, pool));
+
   *cache_p = wrapper;
   return SVN_NO_ERROR;
 }
@@ -0,0 +1,244 @@
+/*
+ * cache-twolevel.c: two-level composition of caching objects
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_strings.h>
+
+#include "svn_pools.h"
+
+#include "svn_private_config.h"
+#include "cache.h"
+
+/* A two-level cache is a mere pair of fully constructed caches.  The
+ * FRONT tier is assumed to be small and fast (e.g. a membuffer cache),
+ * the BACK tier large and slower (e.g. memcached).  All composition
+ * logic goes through the public frontend functions of the two tiers,
+ * so their respective serialization and error accounting still apply.
+ */
+typedef struct two_level_cache_t
+{
+  /* First tier.  Queried first, updated on every write and on every
+     hit in the second tier. */
+  svn_cache__t *front;
+
+  /* Second tier.  Only consulted when the first tier has no data for
+     the respective key. */
+  svn_cache__t *back;
+} two_level_cache_t;
+
+static svn_error_t *
+two_level_cache_get(void **value_p,
+                    svn_boolean_t *found,
+                    void *cache_void,
+                    const void *key,
+                    apr_pool_t *result_pool)
+{
+  two_level_cache_t *cache = cache_void;
+
+  SVN_ERR(svn_cache__get(value_p, found, cache->front, key, result_pool));
+  if (!*found)
+    {
+      SVN_ERR(svn_cache__get(value_p, found, cache->back, key, result_pool));
+
+      /* Promote second-tier hits, so repeated access to the same data
+         gets served from the fast tier.  The extra serialization run
+         is charged to a temporary pool. */
+      if (*found)
+        {
+          apr_pool_t *scratch_pool = svn_pool_create(result_pool);
+          SVN_ERR(svn_cache__set(cache->front, key, *value_p, scratch_pool));
+          svn_pool_destroy(scratch_pool);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+two_level_cache_has_key(svn_boolean_t *found,
+                        void *cache_void,
+                        const void *key,
+                        apr_pool_t *scratch_pool)
+{
+  two_level_cache_t *cache = cache_void;
+
+  SVN_ERR(svn_cache__has_key(found, cache->front, key, scratch_pool));
+  if (!*found)
+    SVN_ERR(svn_cache__has_key(found, cache->back, key, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+two_level_cache_set(void *cache_void,
+                    const void *key,
+                    void *value,
+                    apr_pool_t *scratch_pool)
+{
+  two_level_cache_t *cache = cache_void;
+
+  /* Write through to both tiers.  Data evicted from the small first
+     tier can then still be served from the second one. */
+  SVN_ERR(svn_cache__set(cache->front, key, value, scratch_pool));
+  SVN_ERR(svn_cache__set(cache->back, key, value, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+two_level_cache_set_with_priority(void *cache_void,
+                                  const void *key,
+                                  void *value,
+                                  apr_uint32_t priority,
+                                  apr_pool_t *scratch_pool)
+{
+  two_level_cache_t *cache = cache_void;
+
+  /* Eviction priorities are a property of the first tier; the second
+     tier usually has no notion of them and falls back to plain set. */
+  SVN_ERR(svn_cache__set_with_priority(cache->front, key, value, priority,
+                                       scratch_pool));
+  SVN_ERR(svn_cache__set(cache->back, key, value, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+two_level_cache_iter(svn_boolean_t *completed,
+                     void *cache_void,
+                     svn_iter_apr_hash_cb_t user_cb,
+                     void *user_baton,
+                     apr_pool_t *scratch_pool)
+{
+  /* The tiers overlap, so a combined iteration would yield duplicates.
+     None of the intended tier combinations supports iteration anyway. */
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Can't iterate a two-level cache"));
+}
+
+static svn_boolean_t
+two_level_cache_is_cachable(void *cache_void,
+                            apr_size_t size)
+{
+  two_level_cache_t *cache = cache_void;
+
+  /* An item only one tier can hold is still worth caching there. */
+  return svn_cache__is_cachable(cache->front, size)
+         || svn_cache__is_cachable(cache->back, size);
+}
+
+static svn_error_t *
+two_level_cache_get_partial(void **value_p,
+                            svn_boolean_t *found,
+                            void *cache_void,
+                            const void *key,
+                            svn_cache__partial_getter_func_t func,
+                            void *baton,
+                            apr_pool_t *result_pool)
+{
+  two_level_cache_t *cache = cache_void;
+
+  /* No promotion here:  we would have to fetch the full item for that,
+     defeating the point of a partial getter. */
+  SVN_ERR(svn_cache__get_partial(value_p, found, cache->front, key,
+                                 func, baton, result_pool));
+  if (!*found)
+    SVN_ERR(svn_cache__get_partial(value_p, found, cache->back, key,
+                                   func, baton, result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+two_level_cache_set_partial(void *cache_void,
+                            const void *key,
+                            svn_cache__partial_setter_func_t func,
+                            void *baton,
+                            apr_pool_t *scratch_pool)
+{
+  two_level_cache_t *cache = cache_void;
+
+  /* Apply the modification to whichever tiers have the item; a tier
+     without it treats this as a no-op. */
+  SVN_ERR(svn_cache__set_partial(cache->front, key, func, baton,
+                                 scratch_pool));
+  SVN_ERR(svn_cache__set_partial(cache->back, key, func, baton,
+                                 scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+two_level_cache_get_info(void *cache_void,
+                         svn_cache__info_t *info,
+                         svn_boolean_t reset,
+                         apr_pool_t *result_pool)
+{
+  two_level_cache_t *cache = cache_void;
+  const char *id;
+
+  /* Report the first tier's ID and sizes - that is the instance the
+     admin dimensioned - but forward RESET to both tiers. */
+  SVN_ERR(cache->back->vtable->get_info(cache->back->cache_internal,
+                                        info, reset, result_pool));
+  SVN_ERR(cache->front->vtable->get_info(cache->front->cache_internal,
+                                         info, reset, result_pool));
+  id = info->id ? info->id : "";
+  info->id = apr_pstrcat(result_pool, "two-level:", id, SVN_VA_NULL);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_cache__vtable_t two_level_cache_vtable = {
+  two_level_cache_get,
+  NULL,                         /* get_many */
+  two_level_cache_has_key,
+  two_level_cache_set,
+  two_level_cache_iter,
+  two_level_cache_is_cachable,
+  two_level_cache_get_partial,
+  two_level_cache_set_partial,
+  two_level_cache_get_info,
+  two_level_cache_set_with_priority
+};
+
+svn_error_t *
+svn_cache__create_two_level(svn_cache__t **cache_p,
+                            svn_cache__t *front,
+                            svn_cache__t *back,
+                            apr_pool_t *result_pool)
+{
+  svn_cache__t *wrapper = apr_pcalloc(result_pool, sizeof(*wrapper));
+  two_level_cache_t *cache = apr_pcalloc(result_pool, sizeof(*cache));
+
+  cache->front = front;
+  cache->back = back;
+
+  wrapper->vtable = &two_level_cache_vtable;
+  wrapper->cache_internal = cache;
+  wrapper->pretend_empty = !!getenv("SVN_X_DOES_NOT_MARK_THE_SPOT");
+
+  SVN_ERR(svn_cache__register(wrapper, result_pool));
+
+  *cache_p = wrapper;
+  return SVN_NO_ERROR;
+}
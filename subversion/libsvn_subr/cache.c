@@ -21,8 +21,107 @@
  * ====================================================================
  */
 
+#include <stdlib.h>
+
+#include "svn_io.h"
+#include "svn_pools.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+
 #include "cache.h"
 
+/* The process-global registry of live cache instances: a doubly-linked
+ * list threaded through the instances themselves, protected by
+ * REGISTRY_MUTEX.  The mutex is created on first registration and
+ * lives until process end.
+ */
+static svn_cache__t *registry_head = NULL;
+static svn_mutex__t *registry_mutex = NULL;
+static volatile svn_atomic_t registry_init_state = 0;
+
+/* Implements svn_atomic__err_init_func_t: create REGISTRY_MUTEX.
+ * BATON and POOL are unused; the mutex must outlive every cache
+ * instance, so allocate it in a global pool of its own. */
+static svn_error_t *
+initialize_registry(void *baton,
+                    apr_pool_t *pool)
+{
+  return svn_error_trace(svn_mutex__init(&registry_mutex, TRUE,
+                                         svn_pool_create(NULL)));
+}
+
+/* Link CACHE into the registry.  Requires REGISTRY_MUTEX to be held. */
+static svn_error_t *
+link_cache(svn_cache__t *cache)
+{
+  cache->registry_prev = NULL;
+  cache->registry_next = registry_head;
+  if (registry_head)
+    registry_head->registry_prev = cache;
+  registry_head = cache;
+
+  return SVN_NO_ERROR;
+}
+
+/* Unlink CACHE from the registry.  Requires REGISTRY_MUTEX to be held. */
+static svn_error_t *
+unlink_cache(svn_cache__t *cache)
+{
+  if (cache->registry_prev)
+    cache->registry_prev->registry_next = cache->registry_next;
+  else if (registry_head == cache)
+    registry_head = cache->registry_next;
+
+  if (cache->registry_next)
+    cache->registry_next->registry_prev = cache->registry_prev;
+
+  cache->registry_prev = NULL;
+  cache->registry_next = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* APR pool cleanup handler removing the cache in BATON_VOID from the
+ * registry when the pool it lives in goes away. */
+static apr_status_t
+deregister_cache(void *baton_void)
+{
+  svn_cache__t *cache = baton_void;
+  svn_error_t *err = svn_mutex__lock(registry_mutex);
+
+  if (err)
+    {
+      apr_status_t result = err->apr_err;
+      svn_error_clear(err);
+      return result;
+    }
+
+  err = svn_mutex__unlock(registry_mutex, unlink_cache(cache));
+  if (err)
+    {
+      apr_status_t result = err->apr_err;
+      svn_error_clear(err);
+      return result;
+    }
+
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+svn_cache__register(svn_cache__t *cache,
+                    apr_pool_t *pool)
+{
+  SVN_ERR(svn_atomic__init_once(&registry_init_state, initialize_registry,
+                                NULL, pool));
+
+  SVN_MUTEX__WITH_LOCK(registry_mutex, link_cache(cache));
+  apr_pool_cleanup_register(pool, cache, deregister_cache,
+                            apr_pool_cleanup_null);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_cache__set_error_handler(svn_cache__t *cache,
                              svn_cache__error_handler_t handler,
@@ -95,6 +194,62 @@ svn_cache__get(void **value_p,
   return err;
 }
 
+svn_error_t *
+svn_cache__get_many(void **values,
+                    svn_boolean_t *found,
+                    svn_cache__t *cache,
+                    const void *const *keys,
+                    apr_size_t count,
+                    apr_pool_t *result_pool)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_size_t i;
+
+  /* In case any errors happen and are quelched, make sure we start
+     out with all FOUND elements set to false. */
+  for (i = 0; i < count; ++i)
+    {
+      values[i] = NULL;
+      found[i] = FALSE;
+    }
+#ifdef SVN_DEBUG
+  if (cache->pretend_empty)
+    return SVN_NO_ERROR;
+#endif
+
+  cache->reads += count;
+  if (cache->vtable->get_many)
+    {
+      err = handle_error(cache,
+                         (cache->vtable->get_many)(values,
+                                                   found,
+                                                   cache->cache_internal,
+                                                   keys,
+                                                   count,
+                                                   result_pool),
+                         result_pool);
+    }
+  else
+    {
+      /* Backend without a batch getter: degrade to individual lookups. */
+      for (i = 0; i < count && !err; ++i)
+        if (keys[i])
+          err = handle_error(cache,
+                             (cache->vtable->get)(&values[i],
+                                                  &found[i],
+                                                  cache->cache_internal,
+                                                  keys[i],
+                                                  result_pool),
+                             result_pool);
+    }
+
+  for (i = 0; i < count; ++i)
+    if (found[i])
+      cache->hits++;
+
+  return err;
+}
+
 svn_error_t *
 svn_cache__has_key(svn_boolean_t *found,
                    svn_cache__t *cache,
@@ -130,6 +285,27 @@ svn_cache__set(svn_cache__t *cache,
                       scratch_pool);
 }
 
+svn_error_t *
+svn_cache__set_with_priority(svn_cache__t *cache,
+                             const void *key,
+                             void *value,
+                             apr_uint32_t priority,
+                             apr_pool_t *scratch_pool)
+{
+  /* Not all cache implementations support per-entry priorities. */
+  if (cache->vtable->set_with_priority == NULL)
+    return svn_error_trace(svn_cache__set(cache, key, value, scratch_pool));
+
+  cache->writes++;
+  return handle_error(cache,
+                      (cache->vtable->set_with_priority)(cache->cache_internal,
+                                                         key,
+                                                         value,
+                                                         priority,
+                                                         scratch_pool),
+                      scratch_pool);
+}
+
 
 svn_error_t *
 svn_cache__iter(svn_boolean_t *completed,
@@ -317,3 +493,91 @@ svn_cache__format_info(const svn_cache__info_t *info,
                             info->total_entries,
                             histogram);
 }
+
+/* Write the statistics of all registered cache instances to STREAM,
+ * skipping instances that never saw any access.  Requires
+ * REGISTRY_MUTEX to be held.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+write_instance_stats(svn_stream_t *stream,
+                     apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_cache__t *cache;
+
+  for (cache = registry_head; cache; cache = cache->registry_next)
+    {
+      svn_cache__info_t info;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      /* A single broken cache shall not spoil the whole report. */
+      err = svn_cache__get_info(cache, &info, FALSE, iterpool);
+      if (err)
+        {
+          svn_error_clear(err);
+          continue;
+        }
+
+      /* skip unused caches */
+      if (info.gets == 0 && info.sets == 0)
+        continue;
+
+      /* Sizes and fill levels are only meaningful for the shared data
+       * buffer, reported below; restrict instances to access stats. */
+      SVN_ERR(svn_stream_printf(stream, iterpool, "%s\n",
+                                svn_cache__format_info(&info, TRUE,
+                                                       iterpool)->data));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_cache__write_stats_report(svn_stream_t *stream,
+                              apr_pool_t *scratch_pool)
+{
+  struct svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+  /* Per-instance (i.e. per-namespace) access statistics. */
+  if (registry_init_state)
+    SVN_MUTEX__WITH_LOCK(registry_mutex,
+                         write_instance_stats(stream, scratch_pool));
+
+  /* Aggregated stats of the shared data buffer, including sizes, fill
+   * level and the bucket occupancy histogram. */
+  if (membuffer)
+    {
+      svn_cache__info_t *info
+        = svn_cache__membuffer_get_global_info(scratch_pool);
+
+      SVN_ERR(svn_stream_printf(stream, scratch_pool, "%s\n",
+                                svn_cache__format_info(info, FALSE,
+                                                       scratch_pool)->data));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_cache__maybe_write_stats_report(apr_pool_t *scratch_pool)
+{
+  const char *file_name = getenv("SVN_CACHE_STATS");
+  svn_error_t *err;
+  svn_stream_t *stream;
+
+  if (file_name == NULL || file_name[0] == '\0')
+    return;
+
+  err = svn_stream_open_writable(&stream, file_name, scratch_pool,
+                                 scratch_pool);
+  if (!err)
+    err = svn_error_compose_create(svn_cache__write_stats_report(
+                                     stream, scratch_pool),
+                                   svn_stream_close(stream));
+
+  /* Statistics reporting must never change the host process' outcome. */
+  svn_error_clear(err);
+}
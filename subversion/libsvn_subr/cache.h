@@ -38,6 +38,16 @@ typedef struct svn_cache__vtable_t {
                       const void *key,
                       apr_pool_t *result_pool);
 
+  /* See svn_cache__get_many().  The frontend pre-initializes all output
+     elements to NULL / FALSE.  May be NULL, in which case the frontend
+     falls back to multiple get() calls. */
+  svn_error_t *(*get_many)(void **values,
+                           svn_boolean_t *found,
+                           void *cache_implementation,
+                           const void *const *keys,
+                           apr_size_t count,
+                           apr_pool_t *result_pool);
+
   /* See svn_cache__has_key(). */
   svn_error_t *(*has_key)(svn_boolean_t *found,
                           void *cache_implementation,
@@ -82,6 +92,14 @@ typedef struct svn_cache__vtable_t {
                            svn_cache__info_t *info,
                            svn_boolean_t reset,
                            apr_pool_t *result_pool);
+
+  /* See svn_cache__set_with_priority().  May be NULL, in which case the
+     frontend falls back to set(), i.e. the cache's default priority. */
+  svn_error_t *(*set_with_priority)(void *cache_implementation,
+                                    const void *key,
+                                    void *value,
+                                    apr_uint32_t priority,
+                                    apr_pool_t *scratch_pool);
 } svn_cache__vtable_t;
 
 struct svn_cache__t {
@@ -109,8 +127,21 @@ struct svn_cache__t {
   /* Cause all getters to act as though the cache contains no data.
      (Currently this never becomes set except in maintainer builds.) */
   svn_boolean_t pretend_empty;
+
+  /* Links in the process-global registry of live cache instances; both
+     NULL while not registered.  See svn_cache__register(). */
+  struct svn_cache__t *registry_prev;
+  struct svn_cache__t *registry_next;
 };
 
+/* Add CACHE to the process-global registry of cache instances reported
+ * on by svn_cache__write_stats_report().  POOL must be the pool that
+ * CACHE has been allocated in; the registration is undone automatically
+ * when that pool gets cleaned up.  Called by the cache constructors. */
+svn_error_t *
+svn_cache__register(svn_cache__t *cache,
+                    apr_pool_t *pool);
+
 
 #ifdef __cplusplus
 }
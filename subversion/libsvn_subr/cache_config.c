@@ -64,6 +64,11 @@ static svn_cache_config_t cache_settings =
 #endif
 };
 
+/* Whether the global membuffer cache shall be placed in shared memory.
+ * Only relevant until the cache singleton has been created.
+ */
+static svn_boolean_t share_cache = FALSE;
+
 /* Get the current FSFS cache configuration. */
 const svn_cache_config_t *
 svn_cache_config_get(void)
@@ -71,6 +76,12 @@ svn_cache_config_get(void)
   return &cache_settings;
 }
 
+void
+svn_cache__set_global_membuffer_cache_shared(void)
+{
+  share_cache = TRUE;
+}
+
 /* Initializer function as required by svn_atomic__init_once.  Allocate
  * the process-global (singleton) membuffer cache and return it in the
  * svn_membuffer_t * in *BATON.  UNUSED_POOL is unused and should be NULL.
@@ -120,14 +131,39 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
         return SVN_NO_ERROR;
       apr_allocator_owner_set(allocator, pool);
 
-      err = svn_cache__membuffer_cache_create(
-          &cache,
-          (apr_size_t)cache_size,
-          (apr_size_t)(cache_size / 5),
-          0,
-          ! svn_cache_config_get()->single_threaded,
-          FALSE,
-          pool);
+      err = SVN_NO_ERROR;
+      if (share_cache)
+        {
+          /* The caller asked for a cache in shared memory, e.g. to share
+           * it with processes fork()ed off later.  If that fails - e.g.
+           * because the platform has no anonymous shared memory - fall
+           * back to an ordinary per-process cache. */
+          err = svn_cache__membuffer_cache_create_shared(
+              &cache,
+              (apr_size_t)cache_size,
+              (apr_size_t)(cache_size / 5),
+              0,
+              pool);
+          if (err)
+            {
+              svn_error_clear(err);
+              err = SVN_NO_ERROR;
+              cache = NULL;
+
+              /* Return the partially allocated shared memory, if any. */
+              svn_pool_clear(pool);
+            }
+        }
+
+      if (cache == NULL)
+        err = svn_cache__membuffer_cache_create(
+            &cache,
+            (apr_size_t)cache_size,
+            (apr_size_t)(cache_size / 5),
+            0,
+            ! svn_cache_config_get()->single_threaded,
+            FALSE,
+            pool);
 
       /* Some error occurred. Most likely it's an OOM error but we don't
        * really care. Simply release all cache memory and disable caching
@@ -0,0 +1,106 @@
+/*
+ * cancel.c :  throttled cancellation callbacks
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_time.h>
+
+#include "svn_types.h"
+
+#include "private/svn_subr_private.h"
+
+/* Aim to forward roughly this often.  Short enough that a cancellation
+ * request never feels ignored, long enough that an expensive callback
+ * stops mattering in a per-node or per-window loop. */
+#define THROTTLE_INTERVAL (APR_USEC_PER_SEC / 5)
+
+/* The throttling state in front of the real callback. */
+struct throttled_cancel_baton_t
+{
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Number of calls to swallow before forwarding again. */
+  apr_uint32_t countdown;
+
+  /* Calls swallowed between two forwarded calls. */
+  apr_uint32_t stride;
+
+  /* When we last forwarded a call. */
+  apr_time_t last_forwarded;
+};
+
+/* Implements svn_cancel_func_t on top of a
+ * struct throttled_cancel_baton_t.  Answer most calls with a counter
+ * decrement; forward about every THROTTLE_INTERVAL and re-tune the
+ * counter from the observed call rate.
+ */
+static svn_error_t *
+throttled_cancel_func(void *baton)
+{
+  struct throttled_cancel_baton_t *b = baton;
+  apr_time_t now, elapsed;
+
+  if (--b->countdown > 0)
+    return SVN_NO_ERROR;
+
+  /* Time is only sampled here, i.e. once per forwarded call, so the
+   * common path above stays free of system calls. */
+  now = apr_time_now();
+  elapsed = now - b->last_forwarded;
+
+  if (elapsed < THROTTLE_INTERVAL / 4 && b->stride < 0x1000)
+    b->stride *= 2;         /* calls come thick and fast; check less */
+  else if (elapsed > THROTTLE_INTERVAL)
+    b->stride = 1;          /* calls are rare; every one may forward */
+
+  b->countdown = b->stride;
+  b->last_forwarded = now;
+
+  return b->cancel_func(b->cancel_baton);
+}
+
+void
+svn_cancel__create_throttled(svn_cancel_func_t *throttled_func,
+                             void **throttled_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *result_pool)
+{
+  struct throttled_cancel_baton_t *b;
+
+  if (cancel_func == NULL)
+    {
+      *throttled_func = NULL;
+      *throttled_baton = NULL;
+      return;
+    }
+
+  b = apr_palloc(result_pool, sizeof(*b));
+  b->cancel_func = cancel_func;
+  b->cancel_baton = cancel_baton;
+  b->stride = 1;
+  b->countdown = 1;           /* forward the very first call */
+  b->last_forwarded = apr_time_now();
+
+  *throttled_func = throttled_cancel_func;
+  *throttled_baton = b;
+}
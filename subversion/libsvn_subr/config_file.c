@@ -1191,6 +1191,10 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "###                              (passwords, server certs, etc.)"   NL
         "###                              may be cached to disk."            NL
         "###   username                   Specifies the default username."   NL
+        "###   verify-base-checksums      Specifies whether the contents of" NL
+        "###                              locally stored pristine texts are" NL
+        "###                              re-verified before applying deltas"NL
+        "###                              received from this server."        NL
         "###"                                                                NL
         "### Set store-passwords to 'no' to avoid storing new passwords on"  NL
         "### disk in any way, including in password stores.  It defaults to" NL
@@ -1242,6 +1246,14 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### HTTP timeouts, if given, are specified in seconds.  A timeout"  NL
         "### of 0, i.e. zero, causes a builtin default to be used."          NL
         "###"                                                                NL
+        "### Set verify-base-checksums to 'no' to skip re-reading and"       NL
+        "### re-checksumming locally stored pristine texts before deltas"    NL
+        "### from this server are applied to them.  The pristine contents"   NL
+        "### were already verified when they were stored, so this check"     NL
+        "### only guards against later local corruption; skipping it can"    NL
+        "### speed up updates considerably on trusted fast networks."        NL
+        "### It defaults to 'yes'."                                          NL
+        "###"                                                                NL
         "### Most users will not need to explicitly set the http-library"    NL
         "### option, but valid values for the option include:"               NL
         "###    'serf': Serf-based module (Subversion 1.5 - present)"        NL
@@ -1511,6 +1523,28 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### to show meaningful differences for binary file formats.  [New"  NL
         "### in 1.9]"                                                        NL
         "# diff-ignore-content-type = no"                                    NL
+        "### Set blame-cache-dir to a directory in which 'svn blame' may"    NL
+        "### cache its results.  A repeated blame of the same file then"     NL
+        "### only fetches and diffs the revisions committed since the"       NL
+        "### previous run instead of the full history.  The cache stores"    NL
+        "### file contents and revision properties unencrypted; choose a"    NL
+        "### private directory.  Caching is disabled by default.  [New in"   NL
+        "### 1.15]"                                                          NL
+        "# blame-cache-dir = /path/to/cache"                                 NL
+        "### Set checkout-workers to check out fresh, full-depth working"    NL
+        "### copies over that many parallel repository connections.  The"    NL
+        "### top-level subdirectories are distributed across the workers,"   NL
+        "### so repositories with several sizable trees at the root"         NL
+        "### benefit the most.  Valid values are 2 to 16; the default of"    NL
+        "### 0 checks out over a single connection.  [New in 1.15]"          NL
+        "# checkout-workers = 4"                                             NL
+        "### Set export-workers to run full-depth exports of a URL over"     NL
+        "### that many parallel repository connections.  As with"            NL
+        "### checkout-workers, the top-level subdirectories are"             NL
+        "### distributed across the workers.  Valid values are 2 to 16;"     NL
+        "### the default of 0 exports over a single connection.  [New in"    NL
+        "### 1.15]"                                                          NL
+        "# export-workers = 4"                                               NL
         ""                                                                   NL
         "### Section for configuring automatic properties."                  NL
         "[auto-props]"                                                       NL
@@ -1552,6 +1586,27 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### returning an error.  The default is 10000, i.e. 10 seconds."    NL
         "### Longer values may be useful when exclusive locking is enabled." NL
         "# busy-timeout = 10000"                                             NL
+        "### Set to true to access working copy SQLite databases in WAL"     NL
+        "### (write-ahead logging) mode with a larger page cache and"        NL
+        "### relaxed synchronization (synchronous=NORMAL).  This allows"     NL
+        "### readers and a writer to work concurrently (e.g. an IDE and"     NL
+        "### the command line client) and avoids most disk flush stalls"     NL
+        "### on big working copies.  All clients accessing a working copy"   NL
+        "### should agree on this option; a client with it disabled will"    NL
+        "### convert the database back to the default journal mode on the"   NL
+        "### next non-concurrent access.  Has no effect when"                NL
+        "### exclusive-locking is enabled."                                  NL
+        "# wal-mode = false"                                                 NL
+        "### Set to the path of a directory to share pristine text files"    NL
+        "### between all working copies on this machine.  Pristines are"     NL
+        "### stored there keyed by their SHA-1 checksum and hard-linked"     NL
+        "### into each working copy, so identical texts occupy disk space"   NL
+        "### only once across working copies.  The directory must be on"     NL
+        "### the same filesystem as the working copies and writable by"      NL
+        "### all users sharing it.  Unused texts are never deleted"          NL
+        "### automatically; the store may simply be removed to reclaim"      NL
+        "### space."                                                         NL
+        "# shared-pristine-store ="                                          NL
         ;
 
       err = svn_io_file_open(&f, path,
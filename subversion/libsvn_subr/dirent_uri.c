@@ -317,6 +317,39 @@ canonicalize(const char **canonical_path,
         return SVN_NO_ERROR;
     }
 
+  /* The vast majority of paths sent through here is already canonical,
+     often because it got canonicalized one frame up the call stack.
+     Detect that case with the much cheaper single-pass validation and
+     return a mere copy of PATH.  "//" dirents are left to the generic
+     code below because the UNC check would call back into us. */
+  switch (type)
+    {
+    case type_relpath:
+      if (relpath_is_canonical(path))
+        {
+          *canonical_path = apr_pstrdup(pool, path);
+          return SVN_NO_ERROR;
+        }
+      break;
+
+    case type_dirent:
+      if (! (path[0] == '/' && path[1] == '/')
+          && svn_dirent_is_canonical(path, pool))
+        {
+          *canonical_path = apr_pstrdup(pool, path);
+          return SVN_NO_ERROR;
+        }
+      break;
+
+    case type_uri:
+      if (svn_uri_is_canonical(path, pool))
+        {
+          *canonical_path = apr_pstrdup(pool, path);
+          return SVN_NO_ERROR;
+        }
+      break;
+    }
+
   dst = canon = apr_pcalloc(pool, strlen(path) + 1);
 
   /* If this is supposed to be an URI, it should start with
@@ -30,9 +30,44 @@
 #include "private/svn_eol_private.h"
 #include "private/svn_dep_compat.h"
 
+/* Use SSE2 compares in the EOL scanner where the target architecture is
+ * known to provide them; see the equivalent block in string.c.  The
+ * vector path performs unaligned reads, hence the additional dependency
+ * on SVN_UNALIGNED_ACCESS_IS_OK. */
+#if SVN_UNALIGNED_ACCESS_IS_OK \
+    && (defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SVN_INTERNAL_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define SVN_INTERNAL_HAVE_SSE2 0
+#endif
+
 char *
 svn_eol__find_eol_start(char *buf, apr_size_t len)
 {
+#if SVN_INTERNAL_HAVE_SSE2
+
+  /* Skip whole SSE registers without line endings at a time.  The
+   * narrower scans below will then locate the exact EOL position. */
+  {
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    for (; len >= sizeof(__m128i); buf += sizeof(__m128i),
+                                   len -= sizeof(__m128i))
+      {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)buf);
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, cr),
+                                    _mm_cmpeq_epi8(chunk, lf));
+
+        if (_mm_movemask_epi8(hits))
+          break;
+      }
+  }
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Scan the input one machine word at a time. */
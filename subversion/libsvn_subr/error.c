@@ -169,8 +169,10 @@ make_error_internal(apr_status_t apr_err,
   apr_status_t status = APR_ENOTIMPL;
 #endif
 
-  /* Reuse the child's pool, or create our own. */
-  if (child)
+  /* Reuse the child's pool, or create our own.  Statically allocated
+     errors, e.g. those returned by svn_error__sentinel(), don't have a
+     pool that we could reuse. */
+  if (child && child->pool)
     pool = child->pool;
   else
     {
@@ -209,7 +211,7 @@ make_error_internal(apr_status_t apr_err,
       new_error->line = error_line;
     }
 
-  if (! child)
+  if (! child || ! child->pool)
       apr_pool_cleanup_register(pool, new_error,
                                 err_abort,
                                 apr_pool_cleanup_null);
@@ -328,6 +330,52 @@ svn_error_quick_wrapf(svn_error_t *child,
   return err;
 }
 
+#ifndef SVN_DEBUG
+/* Shared singleton objects for pure control flow error codes, returned
+   by svn_error__sentinel().  They have no pool; the functions in this
+   file treat such statically allocated errors specially. */
+static svn_error_t sentinel_cease_invocation =
+  {
+    SVN_ERR_CEASE_INVOCATION, /* APR status */
+    NULL, /* message */
+    NULL, /* child error */
+    NULL, /* pool */
+    NULL, /* file name */
+    0 /* line number */
+  };
+
+static svn_error_t sentinel_iter_break =
+  {
+    SVN_ERR_ITER_BREAK, /* APR status */
+    NULL, /* message */
+    NULL, /* child error */
+    NULL, /* pool */
+    NULL, /* file name */
+    0 /* line number */
+  };
+#endif /* !SVN_DEBUG */
+
+svn_error_t *
+svn_error__sentinel(apr_status_t apr_err)
+{
+#ifndef SVN_DEBUG
+  switch (apr_err)
+    {
+    case SVN_ERR_CEASE_INVOCATION:
+      return &sentinel_cease_invocation;
+    case SVN_ERR_ITER_BREAK:
+      return &sentinel_iter_break;
+    default:
+      break;
+    }
+#endif
+
+  /* Either there is no singleton for this code, or this is a maintainer
+     mode build where we want source locations and error leak detection
+     to keep working. */
+  return svn_error_create(apr_err, NULL, NULL);
+}
+
 /* Messages in tracing errors all point to this static string. */
 static const char error_tracing_link[] = "traced call";
 
@@ -362,6 +410,11 @@ svn_error_compose_create(svn_error_t *err1,
 {
   if (err1 && err2)
     {
+      if (! err1->pool)
+        /* ERR1 is statically allocated and thus immutable; promote it
+           to an ordinary error before extending its chain. */
+        err1 = make_error_internal(err1->apr_err, NULL);
+
       svn_error_compose(err1,
                         svn_error_create(SVN_ERR_COMPOSED_ERROR, err2, NULL));
       return err1;
@@ -376,7 +429,11 @@ svn_error_compose(svn_error_t *chain, svn_error_t *new_err)
   apr_pool_t *pool = chain->pool;
   apr_pool_t *oldpool = new_err->pool;
 
-  while (chain->child)
+  /* Statically allocated errors must be promoted, as done by
+     svn_error_compose_create(), before their chain can be extended. */
+  SVN_ERR_ASSERT_NO_RETURN(pool != NULL);
+
+  while (chain->child && chain->child->pool)
     chain = chain->child;
 
 #if defined(SVN_DEBUG)
@@ -384,6 +441,17 @@ svn_error_compose(svn_error_t *chain, svn_error_t *new_err)
   apr_pool_cleanup_kill(pool, chain, err_abort);
 #endif
 
+  /* If the chain ends in a statically allocated error, re-home that
+     into POOL such that we may append to it. */
+  if (chain->child)
+    {
+      svn_error_t *copy = apr_palloc(pool, sizeof(*copy));
+      *copy = *chain->child;
+      copy->pool = pool;
+      chain->child = copy;
+      chain = copy;
+    }
+
   /* Copy the new error chain into the old chain's pool. */
   while (new_err)
     {
@@ -396,7 +464,7 @@ svn_error_compose(svn_error_t *chain, svn_error_t *new_err)
         chain->file = apr_pstrdup(pool, new_err->file);
       chain->pool = pool;
 #if defined(SVN_DEBUG)
-      if (! new_err->child)
+      if (oldpool && ! new_err->child)
         apr_pool_cleanup_kill(oldpool, new_err, err_abort);
 #endif
       new_err = new_err->child;
@@ -408,8 +476,10 @@ svn_error_compose(svn_error_t *chain, svn_error_t *new_err)
                             apr_pool_cleanup_null);
 #endif
 
-  /* Destroy the new error chain. */
-  svn_pool_destroy(oldpool);
+  /* Destroy the new error chain.  A statically allocated NEW_ERR owns
+     no pool. */
+  if (oldpool)
+    svn_pool_destroy(oldpool);
 }
 
 svn_error_t *
@@ -488,8 +558,12 @@ svn_error_clear(svn_error_t *err)
 {
   if (err)
     {
+      /* Statically allocated errors own no resources. */
+      if (err->pool == NULL)
+        return;
+
 #if defined(SVN_DEBUG)
-      while (err->child)
+      while (err->child && err->child->pool)
         err = err->child;
       apr_pool_cleanup_kill(err->pool, err, err_abort);
 #endif
@@ -537,6 +611,19 @@ svn_error_purge_tracing(svn_error_t *err)
                                         NULL /* ### say something? */),
                  NULL);
 
+      /* Statically allocated errors are never tracing links and always
+         end the chain, so we may link them into the purged chain as-is
+         instead of copying them into their (non-existent) pool. */
+      if (err->pool == NULL)
+        {
+          if (new_err)
+            new_err_leaf->child = err;
+          else
+            new_err = err;
+
+          return new_err;
+        }
+
       /* Copy the current error except for its child error pointer
          into the new error.  Share any message and source filename
          strings from the error. */
@@ -569,7 +656,8 @@ svn_error_purge_tracing(svn_error_t *err)
 /* ### The logic around omitting (sic) apr_err= in maintainer mode is tightly
    ### coupled to the current sole caller.*/
 static void
-print_error(svn_error_t *err, FILE *stream, const char *prefix)
+print_error(svn_error_t *err, FILE *stream, const char *prefix,
+            apr_pool_t *scratch_pool)
 {
   char errbuf[256];
   const char *err_string;
@@ -585,13 +673,13 @@ print_error(svn_error_t *err, FILE *stream, const char *prefix)
 
   if (err->file
       && !(temp_err = svn_utf_cstring_to_utf8(&file_utf8, err->file,
-                                              err->pool)))
-    svn_error_clear(svn_cmdline_fprintf(stream, err->pool,
+                                              scratch_pool)))
+    svn_error_clear(svn_cmdline_fprintf(stream, scratch_pool,
                                         "%s:%ld", err->file, err->line));
   else
     {
       svn_error_clear(svn_cmdline_fputs(SVN_FILE_LINE_UNDEFINED,
-                                        stream, err->pool));
+                                        stream, scratch_pool));
       svn_error_clear(temp_err);
     }
 
@@ -599,12 +687,12 @@ print_error(svn_error_t *err, FILE *stream, const char *prefix)
     const char *symbolic_name;
     if (svn_error__is_tracing_link(err))
       /* Skip it; the error code will be printed by the real link. */
-      svn_error_clear(svn_cmdline_fprintf(stream, err->pool, ",\n"));
+      svn_error_clear(svn_cmdline_fprintf(stream, scratch_pool, ",\n"));
     else if ((symbolic_name = svn_error_symbolic_name(err->apr_err)))
-      svn_error_clear(svn_cmdline_fprintf(stream, err->pool,
+      svn_error_clear(svn_cmdline_fprintf(stream, scratch_pool,
                                           ": (apr_err=%s)\n", symbolic_name));
     else
-      svn_error_clear(svn_cmdline_fprintf(stream, err->pool,
+      svn_error_clear(svn_cmdline_fprintf(stream, scratch_pool,
                                           ": (apr_err=%d)\n", err->apr_err));
   }
 #endif /* SVN_DEBUG */
@@ -617,7 +705,7 @@ print_error(svn_error_t *err, FILE *stream, const char *prefix)
   /* Only print the same APR error string once. */
   else if (err->message)
     {
-      svn_error_clear(svn_cmdline_fprintf(stream, err->pool,
+      svn_error_clear(svn_cmdline_fprintf(stream, scratch_pool,
                                           "%sE%06d: %s\n",
                                           prefix, err->apr_err, err->message));
     }
@@ -630,13 +718,13 @@ print_error(svn_error_t *err, FILE *stream, const char *prefix)
       /* Otherwise, this must be an APR error code. */
       else if ((temp_err = svn_utf_cstring_to_utf8
                 (&err_string, apr_strerror(err->apr_err, errbuf,
-                                           sizeof(errbuf)), err->pool)))
+                                           sizeof(errbuf)), scratch_pool)))
         {
           svn_error_clear(temp_err);
           err_string = _("Can't recode error string from APR");
         }
 
-      svn_error_clear(svn_cmdline_fprintf(stream, err->pool,
+      svn_error_clear(svn_cmdline_fprintf(stream, scratch_pool,
                                           "%sE%06d: %s\n",
                                           prefix, err->apr_err, err_string));
     }
@@ -685,7 +773,7 @@ svn_handle_error2(svn_error_t *err,
 
       if (! printed_already)
         {
-          print_error(tmp_err, stream, prefix);
+          print_error(tmp_err, stream, prefix, subpool);
           if (! tmp_err->message)
             {
               APR_ARRAY_PUSH(empties, apr_status_t) = tmp_err->apr_err;
@@ -713,6 +801,8 @@ void
 svn_handle_warning2(FILE *stream, const svn_error_t *err, const char *prefix)
 {
   char buf[256];
+  /* ERR may be statically allocated and thus have no pool of its own. */
+  apr_pool_t *scratch_pool = svn_pool_create(err->pool);
 #ifdef SVN_DEBUG
   const char *symbolic_name = svn_error_symbolic_name(err->apr_err);
 #endif
@@ -720,16 +810,17 @@ svn_handle_warning2(FILE *stream, const svn_error_t *err, const char *prefix)
 #ifdef SVN_DEBUG
   if (symbolic_name)
     svn_error_clear(
-      svn_cmdline_fprintf(stream, err->pool, "%swarning: apr_err=%s\n",
+      svn_cmdline_fprintf(stream, scratch_pool, "%swarning: apr_err=%s\n",
                           prefix, symbolic_name));
 #endif
 
   svn_error_clear(svn_cmdline_fprintf
-                  (stream, err->pool,
+                  (stream, scratch_pool,
                    _("%swarning: W%06d: %s\n"),
                    prefix, err->apr_err,
                    svn_err_best_message(err, buf, sizeof(buf))));
   fflush(stream);
+  svn_pool_destroy(scratch_pool);
 }
 
 const char *
@@ -666,3 +666,234 @@ svn_hash__make(apr_pool_t *pool)
 {
   return apr_hash_make_custom(pool, hashfunc_compatible);
 }
+
+
+
+/*** Open-addressing hash container ***/
+
+/* An entry in the insertion-ordered entry arena of an svn_hash__fast_t.
+ * Deleted entries keep their key and stay in the arena (with a NULL
+ * VALUE), so probe sequences in the index remain valid and iteration
+ * order is stable. */
+typedef struct fast_hash_entry_t
+{
+  /* The key, copied into the container's pool, and its length. */
+  const char *key;
+  apr_ssize_t klen;
+
+  /* Hash value of KEY, as per hashfunc_compatible().  Cached here so
+   * that rebuilding the index does not re-hash the keys. */
+  unsigned int hash;
+
+  /* The value; NULL for deleted entries. */
+  void *value;
+} fast_hash_entry_t;
+
+struct svn_hash__fast_t
+{
+  /* Pool that all parts of this container are allocated in. */
+  apr_pool_t *pool;
+
+  /* Entry arena in insertion order.  The first SIZE of CAPACITY
+   * elements are in use, including deleted entries. */
+  fast_hash_entry_t *entries;
+  apr_size_t size;
+  apr_size_t capacity;
+
+  /* Open-addressing index with INDEX_SIZE slots, INDEX_SIZE being a
+   * power of two.  0 means "empty slot"; any other value N refers to
+   * arena entry N-1. */
+  apr_uint32_t *index;
+  apr_size_t index_size;
+
+  /* Number of entries with a non-NULL value. */
+  apr_size_t count;
+};
+
+/* Return the smallest power of two not smaller than MIN_SIZE. */
+static apr_size_t
+round_up_power_of_two(apr_size_t min_size)
+{
+  apr_size_t result = 16;
+  while (result < min_size)
+    result *= 2;
+
+  return result;
+}
+
+/* Return the index slot for KEY of KLEN chars with hash value HVAL in
+ * HASH, i.e. either the slot that refers to KEY's arena entry or the
+ * empty slot where KEY would have to be indexed. */
+static apr_size_t
+fast_hash_find_slot(const svn_hash__fast_t *hash,
+                    const char *key,
+                    apr_ssize_t klen,
+                    unsigned int hval)
+{
+  const apr_size_t mask = hash->index_size - 1;
+  apr_size_t slot = hval & mask;
+
+  /* Linear probing.  The load factor is kept below 3/4, so there is
+   * always an empty slot and this loop terminates. */
+  while (TRUE)
+    {
+      const fast_hash_entry_t *entry;
+      apr_uint32_t reference = hash->index[slot];
+
+      if (reference == 0)
+        return slot;
+
+      entry = &hash->entries[reference - 1];
+      if (   entry->hash == hval
+          && entry->klen == klen
+          && memcmp(entry->key, key, (apr_size_t)klen) == 0)
+        return slot;
+
+      slot = (slot + 1) & mask;
+    }
+}
+
+/* Double the arena and index of HASH and re-index all arena entries. */
+static void
+fast_hash_grow(svn_hash__fast_t *hash)
+{
+  apr_size_t i;
+  fast_hash_entry_t *new_entries
+    = apr_palloc(hash->pool, 2 * hash->capacity * sizeof(*new_entries));
+
+  memcpy(new_entries, hash->entries, hash->size * sizeof(*new_entries));
+  hash->entries = new_entries;
+  hash->capacity *= 2;
+
+  hash->index_size *= 2;
+  hash->index = apr_pcalloc(hash->pool,
+                            hash->index_size * sizeof(*hash->index));
+  for (i = 0; i < hash->size; ++i)
+    {
+      const fast_hash_entry_t *entry = &hash->entries[i];
+      apr_size_t slot = fast_hash_find_slot(hash, entry->key, entry->klen,
+                                            entry->hash);
+      hash->index[slot] = (apr_uint32_t)(i + 1);
+    }
+}
+
+svn_hash__fast_t *
+svn_hash__fast_make(apr_size_t expected_entries,
+                    apr_pool_t *pool)
+{
+  svn_hash__fast_t *hash = apr_pcalloc(pool, sizeof(*hash));
+
+  /* Size the index such that EXPECTED_ENTRIES keep the load factor
+   * below 3/4. */
+  hash->pool = pool;
+  hash->index_size = round_up_power_of_two(expected_entries
+                                           + expected_entries / 2);
+  hash->index = apr_pcalloc(pool, hash->index_size * sizeof(*hash->index));
+  hash->capacity = hash->index_size / 2;
+  hash->entries = apr_palloc(pool,
+                             hash->capacity * sizeof(*hash->entries));
+
+  return hash;
+}
+
+void *
+svn_hash__fast_get(const svn_hash__fast_t *hash,
+                   const char *key,
+                   apr_ssize_t klen)
+{
+  unsigned int hval;
+  apr_size_t slot;
+
+  if (klen == APR_HASH_KEY_STRING)
+    klen = (apr_ssize_t)strlen(key);
+
+  hval = hashfunc_compatible(key, &klen);
+  slot = fast_hash_find_slot(hash, key, klen, hval);
+
+  return hash->index[slot] ? hash->entries[hash->index[slot] - 1].value
+                           : NULL;
+}
+
+void
+svn_hash__fast_set(svn_hash__fast_t *hash,
+                   const char *key,
+                   apr_ssize_t klen,
+                   void *value)
+{
+  unsigned int hval;
+  apr_size_t slot;
+  fast_hash_entry_t *entry;
+
+  if (klen == APR_HASH_KEY_STRING)
+    klen = (apr_ssize_t)strlen(key);
+
+  hval = hashfunc_compatible(key, &klen);
+  slot = fast_hash_find_slot(hash, key, klen, hval);
+
+  if (hash->index[slot])
+    {
+      /* Update (or delete, if VALUE is NULL) the existing entry. */
+      entry = &hash->entries[hash->index[slot] - 1];
+      if ((entry->value == NULL) != (value == NULL))
+        hash->count += value ? 1 : -1;
+      entry->value = value;
+
+      return;
+    }
+
+  /* Deleting a key that is not in the container is a no-op. */
+  if (value == NULL)
+    return;
+
+  /* Append a new arena entry and index it.  Grow first if either the
+   * arena is full or the index would exceed a load factor of 3/4. */
+  if (   hash->size == hash->capacity
+      || (hash->size + 1) * 4 > hash->index_size * 3)
+    {
+      fast_hash_grow(hash);
+      slot = fast_hash_find_slot(hash, key, klen, hval);
+    }
+
+  entry = &hash->entries[hash->size];
+  entry->key = apr_pstrmemdup(hash->pool, key, (apr_size_t)klen);
+  entry->klen = klen;
+  entry->hash = hval;
+  entry->value = value;
+
+  hash->index[slot] = (apr_uint32_t)(++hash->size);
+  ++hash->count;
+}
+
+apr_size_t
+svn_hash__fast_count(const svn_hash__fast_t *hash)
+{
+  return hash->count;
+}
+
+apr_size_t
+svn_hash__fast_size(const svn_hash__fast_t *hash)
+{
+  return hash->size;
+}
+
+void *
+svn_hash__fast_entry(const svn_hash__fast_t *hash,
+                     apr_size_t idx,
+                     const char **key,
+                     apr_ssize_t *klen)
+{
+  const fast_hash_entry_t *entry = &hash->entries[idx];
+
+  if (key)
+    *key = entry->key;
+  if (klen)
+    *klen = entry->klen;
+
+  return entry->value;
+}
+
+apr_pool_t *
+svn_hash__fast_pool(const svn_hash__fast_t *hash)
+{
+  return hash->pool;
+}
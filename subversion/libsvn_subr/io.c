@@ -23,12 +23,30 @@
 
 
 
+/* copy_file_range() is visible only under _GNU_SOURCE, which must be
+   defined before the first C library header gets pulled in. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 
 #ifndef WIN32
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <sys/ioctl.h>
+/* The clone (reflink) ioctl; only <linux/fs.h> defines it, but pulling
+   that header in here is known to clash with the C library headers on
+   some systems.  The value is part of the kernel ABI. */
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#elif defined(DARWIN)
+#include <sys/clonefile.h>
+#endif
+
 #ifndef APR_STATUS_IS_EPERM
 #include <errno.h>
 #ifdef EPERM
@@ -40,6 +58,7 @@
 
 #include <apr_lib.h>
 #include <apr_pools.h>
+#include <apr_version.h>
 #include <apr_file_io.h>
 #include <apr_file_info.h>
 #include <apr_general.h>
@@ -885,6 +904,48 @@ copy_contents(apr_file_t *from_file,
               apr_file_t *to_file,
               apr_pool_t *pool)
 {
+#ifdef HAVE_COPY_FILE_RANGE
+  {
+    apr_os_file_t from_fd, to_fd;
+    svn_boolean_t copied_some = FALSE;
+
+    apr_os_file_get(&from_fd, from_file);
+    apr_os_file_get(&to_fd, to_file);
+
+    /* Copy the data inside the kernel, avoiding the bounce through a
+       user-space buffer entirely.  Both handles are freshly opened,
+       unbuffered files, so the kernel-side offsets are authoritative. */
+    while (1)
+      {
+        ssize_t copied = copy_file_range(from_fd, NULL, to_fd, NULL,
+                                         16 * 1024 * 1024, 0);
+
+        if (copied == 0)
+          return APR_SUCCESS;   /* EOF */
+
+        if (copied > 0)
+          {
+            copied_some = TRUE;
+            continue;
+          }
+
+        if (errno == EINTR)
+          continue;
+
+        /* Fall back to the generic loop on filesystems or kernels that
+           do not support kernel-side copying - but only as long as no
+           data has been copied yet, so the fallback starts clean. */
+        if (!copied_some
+            && (errno == EINVAL || errno == EXDEV || errno == ENOSYS
+                || errno == EBADF || errno == EOPNOTSUPP || errno == EPERM
+                || errno == ETXTBSY))
+          break;
+
+        return errno;
+      }
+  }
+#endif /* HAVE_COPY_FILE_RANGE */
+
   /* Copy bytes till the cows come home. */
   while (1)
     {
@@ -990,6 +1051,219 @@ svn_io_copy_file(const char *src,
   return svn_error_trace(svn_io_file_rename2(dst_tmp, dst, FALSE, pool));
 }
 
+svn_error_t *
+svn_io__clone_file(svn_boolean_t *cloned,
+                   const char *dst,
+                   const char *src,
+                   const char *tmp_dir,
+                   apr_pool_t *pool)
+{
+#if defined(__linux__) || defined(DARWIN)
+  const char *dst_tmp;
+  svn_error_t *err;
+
+#if defined(__linux__)
+  {
+    apr_file_t *from_file, *to_file;
+    apr_os_file_t from_fd, to_fd;
+    int rv;
+
+    SVN_ERR(svn_io_file_open(&from_file, src, APR_READ,
+                             APR_OS_DEFAULT, pool));
+
+    err = svn_io_open_unique_file3(&to_file, &dst_tmp, tmp_dir,
+                                   svn_io_file_del_none, pool, pool);
+    if (err)
+      return svn_error_compose_create(err,
+                                      svn_io_file_close(from_file, pool));
+
+    apr_os_file_get(&from_fd, from_file);
+    apr_os_file_get(&to_fd, to_file);
+
+    /* Ask the kernel to share SRC's data blocks with the temporary
+       file.  Filesystems without reflink support fail the ioctl without
+       touching any data; the caller then falls back to a plain copy. */
+    rv = ioctl(to_fd, FICLONE, from_fd);
+
+    SVN_ERR(svn_io_file_close(from_file, pool));
+    SVN_ERR(svn_io_file_close(to_file, pool));
+
+    if (rv == -1)
+      {
+        *cloned = FALSE;
+        return svn_error_trace(svn_io_remove_file2(dst_tmp, TRUE, pool));
+      }
+  }
+#else /* DARWIN */
+  {
+    const char *src_apr;
+    const char *dst_tmp_apr;
+
+    /* Reserve a unique name in TMP_DIR, then release it again:
+       clonefile() insists on creating its target itself.  The name
+       stays unique enough inside our own temporary directory. */
+    SVN_ERR(svn_io_open_unique_file3(NULL, &dst_tmp, tmp_dir,
+                                     svn_io_file_del_none, pool, pool));
+    SVN_ERR(svn_io_remove_file2(dst_tmp, FALSE, pool));
+
+    SVN_ERR(cstring_from_utf8(&src_apr, src, pool));
+    SVN_ERR(cstring_from_utf8(&dst_tmp_apr, dst_tmp, pool));
+
+    if (clonefile(src_apr, dst_tmp_apr, 0) == -1)
+      {
+        *cloned = FALSE;
+        return SVN_NO_ERROR;
+      }
+
+    /* clonefile() duplicates the mode of the source.  Pristine files
+       are stored read-only, but the clone must start out writable just
+       like a freshly copied file. */
+    SVN_ERR(svn_io_set_file_read_write(dst_tmp, FALSE, pool));
+  }
+#endif
+
+  err = svn_io_file_rename2(dst_tmp, dst, FALSE, pool);
+
+  /* A missing directory is too common to not cover here. */
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_t *err2;
+
+      err2 = svn_io_make_dir_recursively(svn_dirent_dirname(dst, pool),
+                                         pool);
+
+      if (err2)
+        return svn_error_trace(svn_error_compose_create(err, err2));
+      else
+        svn_error_clear(err);
+
+      err = svn_io_file_rename2(dst_tmp, dst, FALSE, pool);
+    }
+  SVN_ERR(err);
+
+  *cloned = TRUE;
+  return SVN_NO_ERROR;
+#else
+  *cloned = FALSE;
+  return SVN_NO_ERROR;
+#endif
+}
+
+/* Block size for svn_io__copy_file_differential().  64 KB amortizes the
+   syscalls while keeping the re-written spans close to the actual
+   changes. */
+#define DIFFERENTIAL_COPY_BLOCKSIZE 65536
+
+svn_error_t *
+svn_io__copy_file_differential(svn_boolean_t *patched,
+                               const char *dst,
+                               const char *src,
+                               apr_pool_t *pool)
+{
+  apr_file_t *src_file, *dst_file;
+  char *src_buf = apr_palloc(pool, DIFFERENTIAL_COPY_BLOCKSIZE);
+  char *dst_buf = apr_palloc(pool, DIFFERENTIAL_COPY_BLOCKSIZE);
+  apr_off_t offset = 0;
+  svn_error_t *err;
+
+  *patched = FALSE;
+
+  /* If DST cannot be opened for updating - not there, read-only,
+     whatever - simply report that we did nothing and let the caller
+     take its generic route. */
+  err = svn_io_file_open(&dst_file, dst, APR_READ | APR_WRITE,
+                         APR_OS_DEFAULT, pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  err = svn_io_file_open(&src_file, src, APR_READ, APR_OS_DEFAULT, pool);
+  if (err)
+    return svn_error_compose_create(err, svn_io_file_close(dst_file, pool));
+
+  while (TRUE)
+    {
+      apr_size_t src_len, dst_len;
+      svn_boolean_t eof;
+
+      err = svn_io_file_read_full2(src_file, src_buf,
+                                   DIFFERENTIAL_COPY_BLOCKSIZE, &src_len,
+                                   &eof, pool);
+      if (err)
+        break;
+
+      if (src_len == 0)
+        break;
+
+      err = svn_io_file_read_full2(dst_file, dst_buf, src_len, &dst_len,
+                                   &eof, pool);
+      if (err)
+        break;
+
+      /* Rewrite this block only if its content actually changed. */
+      if (dst_len != src_len || memcmp(src_buf, dst_buf, src_len) != 0)
+        {
+          err = svn_io_file_seek(dst_file, APR_SET, &offset, pool);
+          if (err)
+            break;
+
+          err = svn_io_file_write_full(dst_file, src_buf, src_len, NULL,
+                                       pool);
+          if (err)
+            break;
+        }
+
+      offset += src_len;
+    }
+
+  /* Chop off whatever the old content had beyond the new length. */
+  if (!err)
+    err = svn_io_file_trunc(dst_file, offset, pool);
+
+  err = svn_error_compose_create(err, svn_io_file_close(src_file, pool));
+  err = svn_error_compose_create(err, svn_io_file_close(dst_file, pool));
+  SVN_ERR(err);
+
+  *patched = TRUE;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_io__link_file(svn_boolean_t *linked,
+                  const char *dst,
+                  const char *src,
+                  apr_pool_t *pool)
+{
+#if APR_VERSION_AT_LEAST(1,4,0)
+  const char *src_apr, *dst_apr;
+  apr_status_t status;
+
+  SVN_ERR(cstring_from_utf8(&src_apr, src, pool));
+  SVN_ERR(cstring_from_utf8(&dst_apr, dst, pool));
+
+  status = apr_file_link(src_apr, dst_apr);
+
+  /* A missing directory is too common to not cover here. */
+  if (APR_STATUS_IS_ENOENT(status))
+    {
+      SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(dst, pool),
+                                          pool));
+      status = apr_file_link(src_apr, dst_apr);
+    }
+
+  /* Whatever went wrong - a foreign filesystem, exhausted link counts,
+     a concurrent creation of DST - the caller is expected to fall back
+     to an ordinary copy, so don't raise an error. */
+  *linked = (status == APR_SUCCESS);
+#else
+  *linked = FALSE;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 #if !defined(WIN32) && !defined(__OS2__)
 /* Wrapper for apr_file_perms_set(), taking a UTF8-encoded filename. */
 static svn_error_t *
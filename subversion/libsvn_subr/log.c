@@ -427,3 +427,18 @@ svn_log__list(const char *path, svn_revnum_t revision,
   return apr_psprintf(pool, "list %s r%ld%s%s", log_path, revision,
                       log_depth(depth, pool), pattern_text->data);
 }
+
+const char *
+svn_log__proplist(const char *path, svn_revnum_t revision,
+                  svn_depth_t depth, apr_pool_t *pool)
+{
+  const char *log_path;
+
+  if (path && path[0] != '\0')
+    log_path = svn_path_uri_encode(path, pool);
+  else
+    log_path = "/";
+
+  return apr_psprintf(pool, "proplist %s r%ld%s", log_path, revision,
+                      log_depth(depth, pool));
+}
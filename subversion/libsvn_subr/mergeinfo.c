@@ -23,6 +23,9 @@
 #include <assert.h>
 #include <ctype.h>
 
+#include <apr_md5.h>
+
+#include "svn_checksum.h"
 #include "svn_path.h"
 #include "svn_types.h"
 #include "svn_ctype.h"
@@ -32,6 +35,8 @@
 #include "svn_error_codes.h"
 #include "svn_string.h"
 #include "svn_mergeinfo.h"
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
 #include "private/svn_fspath.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_sorts_private.h"
@@ -816,6 +821,199 @@ svn_mergeinfo_parse(svn_mergeinfo_t *mergeinfo,
   return err;
 }
 
+/* State for the lazy creation of MERGEINFO_PARSE_CACHE below. */
+static volatile svn_atomic_t mergeinfo_parse_cache_state = 0;
+
+/* Process-global cache of parsed mergeinfo, keyed by the MD5 checksum of
+   the mergeinfo text.  NULL if the global membuffer cache is disabled. */
+static svn_cache__t *mergeinfo_parse_cache = NULL;
+
+/* Append VALUE to BUFFER in the variable-length 7b/8b encoding. */
+static void
+mergeinfo_encode_uint(svn_stringbuf_t *buffer,
+                      apr_uint64_t value)
+{
+  unsigned char encoded[SVN__MAX_ENCODED_UINT_LEN];
+  apr_size_t len = svn__encode_uint(encoded, value) - encoded;
+
+  svn_stringbuf_appendbytes(buffer, (const char *)encoded, len);
+}
+
+/* Implements svn_cache__serialize_func_t for parsed mergeinfo.  The
+   format is a sequence of 7b/8b-encoded integers: the source path count,
+   then for every source its path (length-prefixed, stored only once) and
+   its ranges as sorted (start, end, inheritable) triples. */
+static svn_error_t *
+serialize_mergeinfo(void **data,
+                    apr_size_t *data_len,
+                    void *in,
+                    apr_pool_t *pool)
+{
+  svn_mergeinfo_t mergeinfo = in;
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(pool);
+  apr_hash_index_t *hi;
+
+  mergeinfo_encode_uint(buffer, apr_hash_count(mergeinfo));
+  for (hi = apr_hash_first(pool, mergeinfo); hi; hi = apr_hash_next(hi))
+    {
+      const char *path = apr_hash_this_key(hi);
+      apr_ssize_t path_len = apr_hash_this_key_len(hi);
+      svn_rangelist_t *rangelist = apr_hash_this_val(hi);
+      int i;
+
+      mergeinfo_encode_uint(buffer, path_len);
+      svn_stringbuf_appendbytes(buffer, path, path_len);
+
+      mergeinfo_encode_uint(buffer, rangelist->nelts);
+      for (i = 0; i < rangelist->nelts; i++)
+        {
+          const svn_merge_range_t *range
+            = APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+
+          mergeinfo_encode_uint(buffer, range->start);
+          mergeinfo_encode_uint(buffer, range->end);
+          mergeinfo_encode_uint(buffer, range->inheritable ? 1 : 0);
+        }
+    }
+
+  *data = buffer->data;
+  *data_len = buffer->len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__deserialize_func_t, reversing
+   serialize_mergeinfo(). */
+static svn_error_t *
+deserialize_mergeinfo(void **out,
+                      void *data,
+                      apr_size_t data_len,
+                      apr_pool_t *result_pool)
+{
+  const unsigned char *p = data;
+  const unsigned char *end = p + data_len;
+  apr_uint64_t count, i;
+  svn_mergeinfo_t mergeinfo = svn_hash__make(result_pool);
+
+  p = svn__decode_uint(&count, p, end);
+  for (i = 0; p && i < count; i++)
+    {
+      apr_uint64_t path_len, range_count, k;
+      const char *path;
+      svn_rangelist_t *rangelist;
+
+      p = svn__decode_uint(&path_len, p, end);
+      if (!p || path_len > (apr_size_t)(end - p))
+        {
+          p = NULL;
+          break;
+        }
+
+      path = apr_pstrmemdup(result_pool, (const char *)p, path_len);
+      p += path_len;
+
+      p = svn__decode_uint(&range_count, p, end);
+      if (!p)
+        break;
+
+      rangelist = apr_array_make(result_pool, (int)range_count,
+                                 sizeof(svn_merge_range_t *));
+      for (k = 0; p && k < range_count; k++)
+        {
+          apr_uint64_t start, rev_end, inheritable;
+          svn_merge_range_t *range;
+
+          p = svn__decode_uint(&start, p, end);
+          if (p)
+            p = svn__decode_uint(&rev_end, p, end);
+          if (p)
+            p = svn__decode_uint(&inheritable, p, end);
+          if (!p)
+            break;
+
+          range = apr_palloc(result_pool, sizeof(*range));
+          range->start = (svn_revnum_t)start;
+          range->end = (svn_revnum_t)rev_end;
+          range->inheritable = inheritable != 0;
+          APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = range;
+        }
+
+      apr_hash_set(mergeinfo, path, path_len, rangelist);
+    }
+
+  if (!p)
+    return svn_error_create(SVN_ERR_MERGEINFO_PARSE_ERROR, NULL,
+                            _("Malformed cached mergeinfo"));
+
+  *out = mergeinfo;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_atomic__err_init_func_t, creating the process-global
+   MERGEINFO_PARSE_CACHE on top of the global membuffer cache.  Leaves the
+   cache at NULL when no membuffer has been configured. */
+static svn_error_t *
+initialize_mergeinfo_parse_cache(void *baton,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+  if (membuffer)
+    {
+      /* The cache must survive the pool that happened to trigger the
+         initialization. */
+      apr_pool_t *cache_pool = svn_pool_create(NULL);
+
+      SVN_ERR(svn_cache__create_membuffer_cache(
+                &mergeinfo_parse_cache, membuffer,
+                serialize_mergeinfo, deserialize_mergeinfo,
+                APR_MD5_DIGESTSIZE, "MERGEINFO-PARSE",
+                SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                TRUE /* thread_safe */, FALSE /* short_lived */,
+                cache_pool, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_mergeinfo__parse_cached(svn_mergeinfo_t *mergeinfo,
+                            const char *input,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+  svn_boolean_t found;
+  void *value;
+
+  SVN_ERR(svn_atomic__init_once(&mergeinfo_parse_cache_state,
+                                initialize_mergeinfo_parse_cache, NULL,
+                                scratch_pool));
+
+  if (!mergeinfo_parse_cache)
+    return svn_error_trace(svn_mergeinfo_parse(mergeinfo, input,
+                                               result_pool));
+
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_md5, input, strlen(input),
+                       scratch_pool));
+  SVN_ERR(svn_cache__get(&value, &found, mergeinfo_parse_cache,
+                         checksum->digest, result_pool));
+  if (found)
+    {
+      *mergeinfo = value;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_mergeinfo_parse(mergeinfo, input, result_pool));
+
+  /* Failed parses are not cached; the error path is not hot. */
+  SVN_ERR(svn_cache__set(mergeinfo_parse_cache, checksum->digest,
+                         *mergeinfo, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 static const char *
 rangelist_to_string_debug(const svn_rangelist_t *rl,
                           apr_pool_t *pool)
@@ -973,11 +1171,20 @@ typedef struct rangelist_builder_t {
   svn_rangelist_t *rl;  /* rangelist to build */
   rangelist_interval_t accu_interval;  /* current interval accumulator */
   apr_pool_t *pool;  /* from which to allocate ranges */
+
+  /* Contiguous block of pre-allocated ranges.  Flushed ranges are taken
+   * from here while SPARE_COUNT lasts, so the output ranges of one merge
+   * end up adjacent in memory instead of one pool allocation apart. */
+  svn_merge_range_t *spare_ranges;
+  int spare_count;
 } rangelist_builder_t;
 
-/* Return an initialized rangelist builder. */
+/* Return an initialized rangelist builder.  EXPECTED_RANGES is an upper
+ * bound on the number of ranges that will be flushed; the builder
+ * allocates them as one contiguous block up front. */
 static rangelist_builder_t *
 rl_builder_new(svn_rangelist_t *rl,
+               int expected_ranges,
                apr_pool_t *pool)
 {
   rangelist_builder_t *b = apr_pcalloc(pool, sizeof(*b));
@@ -985,6 +1192,12 @@ rl_builder_new(svn_rangelist_t *rl,
   b->rl = rl;
   /* b->accu_interval = {0, 0, RL_NONE} */
   b->pool = pool;
+  if (expected_ranges > 0)
+    {
+      b->spare_ranges = apr_palloc(pool, expected_ranges
+                                           * sizeof(*b->spare_ranges));
+      b->spare_count = expected_ranges;
+    }
   return b;
 }
 
@@ -994,7 +1207,16 @@ rl_builder_flush(rangelist_builder_t *b)
 {
   if (b->accu_interval.kind > MI_NONE)
     {
-      svn_merge_range_t *mrange = apr_pcalloc(b->pool, sizeof(*mrange));
+      svn_merge_range_t *mrange;
+
+      if (b->spare_count > 0)
+        {
+          mrange = b->spare_ranges++;
+          b->spare_count--;
+        }
+      else
+        mrange = apr_palloc(b->pool, sizeof(*mrange));
+
       mrange->start = b->accu_interval.start;
       mrange->end = b->accu_interval.end;
       mrange->inheritable = (b->accu_interval.kind == MI_INHERITABLE);
@@ -1038,9 +1260,15 @@ rangelist_merge(svn_rangelist_t *rl_out,
                 apr_pool_t *scratch_pool)
 {
   rangelist_interval_iterator_t *it[2];
-  rangelist_builder_t *rl_builder = rl_builder_new(rl_out, result_pool);
+  rangelist_builder_t *rl_builder;
   svn_revnum_t r_last = 0;
 
+  /* Every output range boundary coincides with an input range boundary,
+   * so the sweep below cannot flush more ranges than both inputs have
+   * interval transitions. */
+  rl_builder = rl_builder_new(rl_out, 2 * (rl1->nelts + rl2->nelts) + 1,
+                              result_pool);
+
   /*SVN_ERR_ASSERT(svn_rangelist__is_canonical(rl1));*/
   /*SVN_ERR_ASSERT(svn_rangelist__is_canonical(rl2));*/
   SVN_ERR_ASSERT(rangelist_is_sorted(rl1));
@@ -1268,7 +1496,10 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
   int i1, i2, lasti2;
   svn_merge_range_t working_elt2;
 
-  *output = apr_array_make(pool, 1, sizeof(svn_merge_range_t *));
+  /* Size the output for the common case up front; growing a one-element
+     array doubling step by doubling step shows up in merge profiles. */
+  *output = apr_array_make(pool, rangelist2->nelts + 1,
+                           sizeof(svn_merge_range_t *));
 
   i1 = 0;
   i2 = 0;
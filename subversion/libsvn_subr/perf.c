@@ -0,0 +1,190 @@
+/*
+ * perf.c :  lightweight, compile-time optional performance probes
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <stdlib.h>
+
+#include <apr_time.h>
+
+#include "svn_io.h"
+#include "svn_pools.h"
+
+#include "private/svn_perf.h"
+
+#include "svn_private_config.h"
+
+/* Display names, indexed by svn_perf__probe_t.  Keep in sync with the
+ * enum in svn_perf.h. */
+static const char * const probe_names[] =
+{
+  "fs-get-contents",
+  "fs-open-path",
+  "ra-svn-read",
+  "ra-svn-write",
+  "sqlite-step"
+};
+
+#ifdef SVN_ENABLE_PERF_COUNTERS
+
+/* Number of log2 duration buckets per probe.  Bucket I counts samples
+ * of less than 2^I microseconds; 28 buckets span more than 2 minutes,
+ * beyond which the exact magnitude no longer matters. */
+#define SVN_PERF__BUCKETS 28
+
+/* Accumulated data of a single probe. */
+typedef struct probe_data_t
+{
+  /* number of hits, i.e. svn_perf__count() + svn_perf__sample() calls */
+  apr_uint64_t count;
+
+  /* sum of all duration samples, in microseconds */
+  apr_uint64_t total;
+
+  /* largest duration sample seen so far, in microseconds */
+  apr_uint64_t max;
+
+  /* log2 histogram of the duration samples */
+  apr_uint64_t histogram[SVN_PERF__BUCKETS];
+} probe_data_t;
+
+/* The process-global probe state.  Static zero-initialization is all
+ * the setup it needs; see svn_perf.h for the (lack of) thread-safety
+ * guarantees. */
+static probe_data_t probe_data[svn_perf__probe__last];
+
+void
+svn_perf__count(svn_perf__probe_t probe)
+{
+  ++probe_data[probe].count;
+}
+
+apr_time_t
+svn_perf__now(void)
+{
+  return apr_time_now();
+}
+
+void
+svn_perf__sample(svn_perf__probe_t probe,
+                 apr_time_t start)
+{
+  probe_data_t *data = &probe_data[probe];
+  apr_time_t duration = apr_time_now() - start;
+  int bucket = 0;
+
+  /* the clock may jump backwards; don't let that wreck the stats */
+  if (duration < 0)
+    duration = 0;
+
+  while (   bucket + 1 < SVN_PERF__BUCKETS
+         && duration >= (apr_time_t)1 << bucket)
+    ++bucket;
+
+  ++data->count;
+  data->total += duration;
+  if ((apr_uint64_t)duration > data->max)
+    data->max = duration;
+  ++data->histogram[bucket];
+}
+
+svn_error_t *
+svn_perf__write_report(svn_stream_t *stream,
+                       apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < svn_perf__probe__last; ++i)
+    {
+      const probe_data_t *data = &probe_data[i];
+      int bucket;
+
+      if (data->count == 0)
+        continue;
+
+      SVN_ERR(svn_stream_printf(stream, scratch_pool,
+                                "%s:\n"
+                                "  count: %" APR_UINT64_T_FMT "\n"
+                                "  total: %" APR_UINT64_T_FMT " usecs\n"
+                                "  avg: %" APR_UINT64_T_FMT " usecs\n"
+                                "  max: %" APR_UINT64_T_FMT " usecs\n",
+                                probe_names[i],
+                                data->count,
+                                data->total,
+                                data->total / data->count,
+                                data->max));
+
+      for (bucket = 0; bucket < SVN_PERF__BUCKETS; ++bucket)
+        if (data->histogram[bucket] > 0)
+          SVN_ERR(svn_stream_printf(stream, scratch_pool,
+                                    "  < %d usecs: %" APR_UINT64_T_FMT "\n",
+                                    1 << bucket,
+                                    data->histogram[bucket]));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_perf__maybe_write_report(apr_pool_t *scratch_pool)
+{
+  const char *file_name = getenv("SVN_PERF_REPORT");
+  svn_error_t *err;
+  svn_stream_t *stream;
+
+  if (file_name == NULL || file_name[0] == '\0')
+    return;
+
+  err = svn_stream_open_writable(&stream, file_name, scratch_pool,
+                                 scratch_pool);
+  if (!err)
+    err = svn_error_compose_create(svn_perf__write_report(stream,
+                                                          scratch_pool),
+                                   svn_stream_close(stream));
+
+  /* Diagnostics must never change the host process' outcome. */
+  svn_error_clear(err);
+}
+
+#else /* !SVN_ENABLE_PERF_COUNTERS */
+
+svn_error_t *
+svn_perf__write_report(svn_stream_t *stream,
+                       apr_pool_t *scratch_pool)
+{
+  /* Mention the probes we would have reported on, so a misconfigured
+   * build is easy to tell from a probe that never fired. */
+  SVN_ERR(svn_stream_printf(stream, scratch_pool,
+                            "performance probes not compiled in "
+                            "(%d probes defined; rebuild with "
+                            "-DSVN_ENABLE_PERF_COUNTERS)\n",
+                            (int)(sizeof(probe_names)
+                                  / sizeof(probe_names[0]))));
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_perf__maybe_write_report(apr_pool_t *scratch_pool)
+{
+}
+
+#endif /* SVN_ENABLE_PERF_COUNTERS */
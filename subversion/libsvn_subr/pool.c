@@ -33,6 +33,8 @@
 
 #include "svn_pools.h"
 
+#include "private/svn_subr_private.h"
+
 #include "pools.h"
 
 #if APR_POOL_DEBUG
@@ -151,6 +153,51 @@ svn_pool_create_allocator(svn_boolean_t thread_safe)
 }
 
 
+apr_pool_t *
+svn_pool__create_iterpool(apr_pool_t *parent_pool)
+{
+  apr_allocator_t *allocator;
+  apr_pool_t *pool;
+
+  /* Give the iteration pool a private, unsynchronized allocator and
+   * keep all blocks ever freed into it on its free list.  That way,
+   * clearing the pool between iterations recycles the blocks without
+   * taking the global allocator mutex or handing memory back to the
+   * OS, only to re-request it a few microseconds later. */
+
+  if (apr_allocator_create(&allocator))
+    abort_on_pool_failure(EXIT_FAILURE);
+
+  apr_allocator_max_free_set(allocator, APR_ALLOCATOR_MAX_FREE_UNLIMITED);
+
+  /* The allocator dies with the pool. */
+
+  pool = svn_pool_create_ex(parent_pool, allocator);
+  apr_allocator_owner_set(allocator, pool);
+
+#if APR_POOL_DEBUG
+  apr_pool_tag (pool, "svn iteration pool");
+#endif
+
+  return pool;
+}
+
+
+apr_size_t
+svn_pool__bytes_used(apr_pool_t *pool)
+{
+#if APR_POOL_DEBUG
+  /* Exact accounting is a pool-debug feature; these builds track
+   * every allocation individually. */
+  return apr_pool_num_bytes(pool, TRUE);
+#else
+  /* Plain APR keeps no per-pool counters and provides no way to hook
+   * into the allocation path.  Signal "not available" to the caller. */
+  return 0;
+#endif
+}
+
+
 /* Private function that creates an unmanaged pool. */
 apr_pool_t *
 svn_pool__create_unmanaged(svn_boolean_t thread_safe)
@@ -0,0 +1,735 @@
+/*
+ * sha1.c :  SHA-1 checksumming with hardware acceleration
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <apr_sha1.h>
+
+#include "private/svn_atomic.h"
+
+#include "sha1.h"
+
+/* Decide at compile time which hardware SHA-1 kernels we can provide.
+ *
+ * On x86 we need a compiler that supports per-function target
+ * attributes (or MSVC, which allows all intrinsics unconditionally),
+ * so that the rest of the library can still be built for a generic
+ * CPU; the SHA-NI kernel is only entered after a run-time CPUID check.
+ *
+ * On ARM the crypto intrinsics are only usable when the whole file is
+ * compiled for a +crypto baseline, so we merely check for that; the
+ * kernel itself is trivially "available" at run time then, but we
+ * still consult the kernel's HWCAP bits on Linux where we can.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+# if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8)
+#  define SVN_INTERNAL_SHA1_X86 1
+#  define SVN_INTERNAL_SHA1_TARGET \
+          __attribute__((target("sha,ssse3,sse4.1")))
+#  include <immintrin.h>
+#  include <cpuid.h>
+# endif
+#elif defined(_M_X64) || defined(_M_IX86)
+# if defined(_MSC_VER) && _MSC_VER >= 1910
+#  define SVN_INTERNAL_SHA1_X86 1
+#  define SVN_INTERNAL_SHA1_TARGET
+#  include <immintrin.h>
+#  include <intrin.h>
+# endif
+#elif defined(__aarch64__) && !defined(__ARM_BIG_ENDIAN) \
+      && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+# define SVN_INTERNAL_SHA1_ARM 1
+# include <arm_neon.h>
+# ifdef __linux__
+#  include <sys/auxv.h>
+#  include <asm/hwcap.h>
+# endif
+#endif
+
+#if defined(SVN_INTERNAL_SHA1_X86) || defined(SVN_INTERNAL_SHA1_ARM)
+#define SVN_INTERNAL_SHA1_HW 1
+#endif
+
+#ifdef SVN_INTERNAL_SHA1_HW
+
+/* Streaming state for the hardware code path: the 5 chaining words,
+ * the total input length in bytes and the tail of the input that did
+ * not fill a complete 64 byte block, yet. */
+typedef struct hw_sha1_ctx_t
+{
+  apr_uint32_t state[5];
+  apr_uint64_t count;
+  unsigned char buffer[64];
+} hw_sha1_ctx_t;
+
+/* Put CTX into the SHA-1 initial state. */
+static void
+hw_sha1_init(hw_sha1_ctx_t *ctx)
+{
+  ctx->state[0] = 0x67452301;
+  ctx->state[1] = 0xEFCDAB89;
+  ctx->state[2] = 0x98BADCFE;
+  ctx->state[3] = 0x10325476;
+  ctx->state[4] = 0xC3D2E1F0;
+  ctx->count = 0;
+}
+
+#ifdef SVN_INTERNAL_SHA1_X86
+
+/* Fold BLOCKS 64 byte blocks from DATA into the chaining words at
+ * STATE, using the SHA-NI instructions.  This follows the round
+ * structure given in Intel's SHA extensions paper; the message
+ * schedule for 4 rounds is pre-computed 8 rounds ahead.
+ */
+SVN_INTERNAL_SHA1_TARGET
+static void
+hw_sha1_blocks(apr_uint32_t state[5],
+               const unsigned char *data,
+               apr_size_t blocks)
+{
+  __m128i abcd, abcd_save, e0, e0_save, e1;
+  __m128i msg0, msg1, msg2, msg3;
+  const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+                                      0x08090a0b0c0d0e0fULL);
+
+  abcd = _mm_loadu_si128((const __m128i *)state);
+  e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+  abcd = _mm_shuffle_epi32(abcd, 0x1B);
+
+  while (blocks--)
+    {
+      abcd_save = abcd;
+      e0_save = e0;
+
+      msg0 = _mm_loadu_si128((const __m128i *)(data + 0));
+      msg1 = _mm_loadu_si128((const __m128i *)(data + 16));
+      msg2 = _mm_loadu_si128((const __m128i *)(data + 32));
+      msg3 = _mm_loadu_si128((const __m128i *)(data + 48));
+
+      msg0 = _mm_shuffle_epi8(msg0, mask);
+      msg1 = _mm_shuffle_epi8(msg1, mask);
+      msg2 = _mm_shuffle_epi8(msg2, mask);
+      msg3 = _mm_shuffle_epi8(msg3, mask);
+
+      /* Rounds 0-3 */
+      e0 = _mm_add_epi32(e0, msg0);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+      /* Rounds 4-7 */
+      e1 = _mm_sha1nexte_epu32(e1, msg1);
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+      /* Rounds 8-11 */
+      e0 = _mm_sha1nexte_epu32(e0, msg2);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      /* Rounds 12-15 */
+      e1 = _mm_sha1nexte_epu32(e1, msg3);
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 16-19 */
+      e0 = _mm_sha1nexte_epu32(e0, msg0);
+      e1 = abcd;
+      msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+      msg2 = _mm_xor_si128(msg2, msg0);
+
+      /* Rounds 20-23 */
+      e1 = _mm_sha1nexte_epu32(e1, msg1);
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+      msg3 = _mm_xor_si128(msg3, msg1);
+
+      /* Rounds 24-27 */
+      e0 = _mm_sha1nexte_epu32(e0, msg2);
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      /* Rounds 28-31 */
+      e1 = _mm_sha1nexte_epu32(e1, msg3);
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 32-35 */
+      e0 = _mm_sha1nexte_epu32(e0, msg0);
+      e1 = abcd;
+      msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+      msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+      msg2 = _mm_xor_si128(msg2, msg0);
+
+      /* Rounds 36-39 */
+      e1 = _mm_sha1nexte_epu32(e1, msg1);
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+      msg3 = _mm_xor_si128(msg3, msg1);
+
+      /* Rounds 40-43 */
+      e0 = _mm_sha1nexte_epu32(e0, msg2);
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      /* Rounds 44-47 */
+      e1 = _mm_sha1nexte_epu32(e1, msg3);
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 48-51 */
+      e0 = _mm_sha1nexte_epu32(e0, msg0);
+      e1 = abcd;
+      msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+      msg2 = _mm_xor_si128(msg2, msg0);
+
+      /* Rounds 52-55 */
+      e1 = _mm_sha1nexte_epu32(e1, msg1);
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+      msg3 = _mm_xor_si128(msg3, msg1);
+
+      /* Rounds 56-59 */
+      e0 = _mm_sha1nexte_epu32(e0, msg2);
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      /* Rounds 60-63 */
+      e1 = _mm_sha1nexte_epu32(e1, msg3);
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 64-67 */
+      e0 = _mm_sha1nexte_epu32(e0, msg0);
+      e1 = abcd;
+      msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+      msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+      msg2 = _mm_xor_si128(msg2, msg0);
+
+      /* Rounds 68-71 */
+      e1 = _mm_sha1nexte_epu32(e1, msg1);
+      e0 = abcd;
+      msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+      msg3 = _mm_xor_si128(msg3, msg1);
+
+      /* Rounds 72-75 */
+      e0 = _mm_sha1nexte_epu32(e0, msg2);
+      e1 = abcd;
+      msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+      /* Rounds 76-79 */
+      e1 = _mm_sha1nexte_epu32(e1, msg3);
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+      /* Combine with the saved state */
+      e0 = _mm_sha1nexte_epu32(e0, e0_save);
+      abcd = _mm_add_epi32(abcd, abcd_save);
+
+      data += 64;
+    }
+
+  abcd = _mm_shuffle_epi32(abcd, 0x1B);
+  _mm_storeu_si128((__m128i *)state, abcd);
+  state[4] = (apr_uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+/* Return whether the CPU we are running on implements the SHA
+ * extension (and the older SSE levels the kernel above relies upon).
+ */
+static svn_boolean_t
+hw_sha1_cpu_support(void)
+{
+#ifdef _MSC_VER
+  int info[4];
+
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return FALSE;
+
+  __cpuidex(info, 7, 0);
+  if (!(info[1] & (1 << 29)))     /* EBX: SHA */
+    return FALSE;
+
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9))     /* ECX: SSSE3 */
+      && (info[2] & (1 << 19));   /* ECX: SSE4.1 */
+#else
+  unsigned int eax, ebx, ecx, edx;
+
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)
+      || !(ebx & (1u << 29)))     /* EBX: SHA */
+    return FALSE;
+
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return FALSE;
+
+  return (ecx & (1u << 9))        /* ECX: SSSE3 */
+      && (ecx & (1u << 19));      /* ECX: SSE4.1 */
+#endif
+}
+
+#endif /* SVN_INTERNAL_SHA1_X86 */
+
+#ifdef SVN_INTERNAL_SHA1_ARM
+
+/* Fold BLOCKS 64 byte blocks from DATA into the chaining words at
+ * STATE, using the ARMv8 crypto extension.  Same round structure as
+ * the SHA-NI variant above, expressed with the ACLE intrinsics: the
+ * round constant additions are pre-computed 8 rounds ahead into
+ * TMP0 / TMP1.
+ */
+static void
+hw_sha1_blocks(apr_uint32_t state[5],
+               const unsigned char *data,
+               apr_size_t blocks)
+{
+  uint32x4_t abcd = vld1q_u32(&state[0]);
+  uint32_t e0 = state[4];
+  uint32_t e1;
+  uint32x4_t abcd_save, tmp0, tmp1;
+  uint32x4_t msg0, msg1, msg2, msg3;
+  uint32_t e0_save;
+
+  const uint32x4_t k0 = vdupq_n_u32(0x5A827999);
+  const uint32x4_t k1 = vdupq_n_u32(0x6ED9EBA1);
+  const uint32x4_t k2 = vdupq_n_u32(0x8F1BBCDC);
+  const uint32x4_t k3 = vdupq_n_u32(0xCA62C1D6);
+
+  while (blocks--)
+    {
+      abcd_save = abcd;
+      e0_save = e0;
+
+      msg0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 0)));
+      msg1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16)));
+      msg2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 32)));
+      msg3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 48)));
+
+      tmp0 = vaddq_u32(msg0, k0);
+      tmp1 = vaddq_u32(msg1, k0);
+
+      /* Rounds 0-3 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, k0);
+      msg0 = vsha1su0q_u32(msg0, msg1, msg2);
+
+      /* Rounds 4-7 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, k0);
+      msg0 = vsha1su1q_u32(msg0, msg3);
+      msg1 = vsha1su0q_u32(msg1, msg2, msg3);
+
+      /* Rounds 8-11 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg0, k0);
+      msg1 = vsha1su1q_u32(msg1, msg0);
+      msg2 = vsha1su0q_u32(msg2, msg3, msg0);
+
+      /* Rounds 12-15 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg1, k1);
+      msg2 = vsha1su1q_u32(msg2, msg1);
+      msg3 = vsha1su0q_u32(msg3, msg0, msg1);
+
+      /* Rounds 16-19 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1cq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, k1);
+      msg3 = vsha1su1q_u32(msg3, msg2);
+      msg0 = vsha1su0q_u32(msg0, msg1, msg2);
+
+      /* Rounds 20-23 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, k1);
+      msg0 = vsha1su1q_u32(msg0, msg3);
+      msg1 = vsha1su0q_u32(msg1, msg2, msg3);
+
+      /* Rounds 24-27 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg0, k1);
+      msg1 = vsha1su1q_u32(msg1, msg0);
+      msg2 = vsha1su0q_u32(msg2, msg3, msg0);
+
+      /* Rounds 28-31 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg1, k1);
+      msg2 = vsha1su1q_u32(msg2, msg1);
+      msg3 = vsha1su0q_u32(msg3, msg0, msg1);
+
+      /* Rounds 32-35 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, k2);
+      msg3 = vsha1su1q_u32(msg3, msg2);
+      msg0 = vsha1su0q_u32(msg0, msg1, msg2);
+
+      /* Rounds 36-39 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, k2);
+      msg0 = vsha1su1q_u32(msg0, msg3);
+      msg1 = vsha1su0q_u32(msg1, msg2, msg3);
+
+      /* Rounds 40-43 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg0, k2);
+      msg1 = vsha1su1q_u32(msg1, msg0);
+      msg2 = vsha1su0q_u32(msg2, msg3, msg0);
+
+      /* Rounds 44-47 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg1, k2);
+      msg2 = vsha1su1q_u32(msg2, msg1);
+      msg3 = vsha1su0q_u32(msg3, msg0, msg1);
+
+      /* Rounds 48-51 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, k2);
+      msg3 = vsha1su1q_u32(msg3, msg2);
+      msg0 = vsha1su0q_u32(msg0, msg1, msg2);
+
+      /* Rounds 52-55 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, k3);
+      msg0 = vsha1su1q_u32(msg0, msg3);
+      msg1 = vsha1su0q_u32(msg1, msg2, msg3);
+
+      /* Rounds 56-59 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1mq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg0, k3);
+      msg1 = vsha1su1q_u32(msg1, msg0);
+      msg2 = vsha1su0q_u32(msg2, msg3, msg0);
+
+      /* Rounds 60-63 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg1, k3);
+      msg2 = vsha1su1q_u32(msg2, msg1);
+      msg3 = vsha1su0q_u32(msg3, msg0, msg1);
+
+      /* Rounds 64-67 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e0, tmp0);
+      tmp0 = vaddq_u32(msg2, k3);
+      msg3 = vsha1su1q_u32(msg3, msg2);
+
+      /* Rounds 68-71 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+      tmp1 = vaddq_u32(msg3, k3);
+
+      /* Rounds 72-75 */
+      e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e0, tmp0);
+
+      /* Rounds 76-79 */
+      e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      abcd = vsha1pq_u32(abcd, e1, tmp1);
+
+      /* Combine with the saved state */
+      e0 += e0_save;
+      abcd = vaddq_u32(abcd, abcd_save);
+
+      data += 64;
+    }
+
+  vst1q_u32(&state[0], abcd);
+  state[4] = e0;
+}
+
+/* Return whether the CPU we are running on implements the SHA-1
+ * instructions of the crypto extension.
+ */
+static svn_boolean_t
+hw_sha1_cpu_support(void)
+{
+#if defined(__linux__) && defined(HWCAP_SHA1)
+  return (getauxval(AT_HWCAP) & HWCAP_SHA1) != 0;
+#else
+  /* This file got compiled for a +crypto baseline, so the extension
+   * may be assumed. */
+  return TRUE;
+#endif
+}
+
+#endif /* SVN_INTERNAL_SHA1_ARM */
+
+/* Feed LEN bytes from DATA into CTX, buffering partial blocks. */
+static void
+hw_sha1_update(hw_sha1_ctx_t *ctx,
+               const unsigned char *data,
+               apr_size_t len)
+{
+  apr_size_t buffered = (apr_size_t)(ctx->count & 0x3f);
+
+  ctx->count += len;
+
+  /* Top up and flush a partially filled block buffer first. */
+  if (buffered)
+    {
+      apr_size_t chunk = 64 - buffered;
+      if (chunk > len)
+        chunk = len;
+
+      memcpy(ctx->buffer + buffered, data, chunk);
+      data += chunk;
+      len -= chunk;
+
+      if (buffered + chunk < 64)
+        return;
+
+      hw_sha1_blocks(ctx->state, ctx->buffer, 1);
+    }
+
+  /* Hash complete blocks directly from the input. */
+  if (len >= 64)
+    {
+      hw_sha1_blocks(ctx->state, data, len / 64);
+      data += len & ~(apr_size_t)0x3f;
+      len &= 0x3f;
+    }
+
+  /* Buffer the remainder. */
+  memcpy(ctx->buffer, data, len);
+}
+
+/* Apply the SHA-1 padding to CTX and write the digest to DIGEST. */
+static void
+hw_sha1_final(unsigned char *digest,
+              hw_sha1_ctx_t *ctx)
+{
+  static const unsigned char padding[64] = { 0x80 };
+  unsigned char lenbuf[8];
+  apr_uint64_t bitcount = ctx->count << 3;
+  apr_size_t buffered = (apr_size_t)(ctx->count & 0x3f);
+  apr_size_t pad_len = (buffered < 56 ? 56 : 120) - buffered;
+  int i;
+
+  for (i = 0; i < 8; i++)
+    lenbuf[i] = (unsigned char)(bitcount >> (56 - 8 * i));
+
+  hw_sha1_update(ctx, padding, pad_len);
+  hw_sha1_update(ctx, lenbuf, 8);
+
+  for (i = 0; i < 5; i++)
+    {
+      digest[i * 4 + 0] = (unsigned char)(ctx->state[i] >> 24);
+      digest[i * 4 + 1] = (unsigned char)(ctx->state[i] >> 16);
+      digest[i * 4 + 2] = (unsigned char)(ctx->state[i] >> 8);
+      digest[i * 4 + 3] = (unsigned char)(ctx->state[i]);
+    }
+}
+
+/* Set by hw_sha1_detect(), protected by HW_SHA1_DETECTED. */
+static svn_boolean_t hw_sha1_usable = FALSE;
+static volatile svn_atomic_t hw_sha1_detected = 0;
+
+/* svn_atomic__str_init_func_t checking for hardware SHA-1 support.
+ * Beyond the CPU feature bits, require the kernel to reproduce a known
+ * digest, so that a miscompiled kernel degrades to the generic code
+ * path instead of producing wrong checksums.
+ */
+static const char *
+hw_sha1_detect(void *baton)
+{
+  static const unsigned char abc_digest[APR_SHA1_DIGESTSIZE] = {
+    0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+    0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d
+  };
+  hw_sha1_ctx_t ctx;
+  unsigned char digest[APR_SHA1_DIGESTSIZE];
+
+  if (!hw_sha1_cpu_support())
+    return NULL;
+
+  hw_sha1_init(&ctx);
+  hw_sha1_update(&ctx, (const unsigned char *)"abc", 3);
+  hw_sha1_final(digest, &ctx);
+
+  hw_sha1_usable = memcmp(digest, abc_digest, sizeof(digest)) == 0;
+
+  return NULL;
+}
+
+/* Return whether the hardware code path may be used on this machine. */
+static svn_boolean_t
+hw_sha1_enabled(void)
+{
+  svn_atomic__init_once_no_error(&hw_sha1_detected, hw_sha1_detect, NULL);
+  return hw_sha1_usable;
+}
+
+#endif /* SVN_INTERNAL_SHA1_HW */
+
+/* The aggregated context: USE_HW selects the union member and remains
+ * fixed over the lifetime of the context, including resets. */
+struct svn_sha1__context_t
+{
+  svn_boolean_t use_hw;
+  union
+    {
+      apr_sha1_ctx_t generic;
+#ifdef SVN_INTERNAL_SHA1_HW
+      hw_sha1_ctx_t hw;
+#endif
+    } u;
+};
+
+svn_sha1__context_t *
+svn_sha1__context_create(apr_pool_t *pool)
+{
+  svn_sha1__context_t *context = apr_palloc(pool, sizeof(*context));
+
+#ifdef SVN_INTERNAL_SHA1_HW
+  context->use_hw = hw_sha1_enabled();
+  if (context->use_hw)
+    {
+      hw_sha1_init(&context->u.hw);
+      return context;
+    }
+#else
+  context->use_hw = FALSE;
+#endif
+
+  apr_sha1_init(&context->u.generic);
+  return context;
+}
+
+void
+svn_sha1__context_reset(svn_sha1__context_t *context)
+{
+#ifdef SVN_INTERNAL_SHA1_HW
+  if (context->use_hw)
+    {
+      hw_sha1_init(&context->u.hw);
+      return;
+    }
+#endif
+
+  memset(&context->u.generic, 0, sizeof(context->u.generic));
+  apr_sha1_init(&context->u.generic);
+}
+
+void
+svn_sha1__update(svn_sha1__context_t *context,
+                 const void *data,
+                 apr_size_t len)
+{
+#ifdef SVN_INTERNAL_SHA1_HW
+  if (context->use_hw)
+    {
+      hw_sha1_update(&context->u.hw, data, len);
+      return;
+    }
+#endif
+
+  apr_sha1_update_binary(&context->u.generic, data, (unsigned int)len);
+}
+
+void
+svn_sha1__finalize(unsigned char *digest,
+                   svn_sha1__context_t *context)
+{
+#ifdef SVN_INTERNAL_SHA1_HW
+  if (context->use_hw)
+    {
+      hw_sha1_final(digest, &context->u.hw);
+      return;
+    }
+#endif
+
+  apr_sha1_final(digest, &context->u.generic);
+}
+
+void
+svn_sha1__digest(unsigned char *digest,
+                 const void *data,
+                 apr_size_t len)
+{
+  svn_sha1__context_t context;
+
+#ifdef SVN_INTERNAL_SHA1_HW
+  context.use_hw = hw_sha1_enabled();
+  if (context.use_hw)
+    {
+      hw_sha1_init(&context.u.hw);
+      hw_sha1_update(&context.u.hw, data, len);
+      hw_sha1_final(digest, &context.u.hw);
+      return;
+    }
+#endif
+
+  apr_sha1_init(&context.u.generic);
+  apr_sha1_update_binary(&context.u.generic, data, (unsigned int)len);
+  apr_sha1_final(digest, &context.u.generic);
+}
@@ -70,6 +70,73 @@ static const enum char_type skel_char_type[256] = {
 };
 
 
+#if SVN_UNALIGNED_ACCESS_IS_OK
+
+/* Constants for the word-at-a-time scan in scan_atom_end(); see the
+ * equivalent constants in svn_eol_private.h. */
+#if APR_SIZEOF_VOIDP == 8
+#  define SKEL__ONES  APR_UINT64_C(0x0101010101010101)
+#else
+#  define SKEL__ONES  0x01010101u
+#endif
+#define SKEL__HIGHS (SKEL__ONES * 0x80)
+
+/* In the result, the high bit of every byte that was zero in WORD is a
+ * candidate hit.  This is the well-known strlen() zero-byte test; mask
+ * the result with SKEL__HIGHS before drawing conclusions. */
+#define SKEL__ZERO_TEST(word) (((word) - SKEL__ONES) & ~(word))
+
+#endif
+
+/* Return the position in [DATA, END) of the first byte that terminates
+   an implicit-length atom, i.e. the first byte whose skel_char_type is
+   type_space or type_paren.  Return END if there is no such byte.  */
+static const char *
+scan_atom_end(const char *data, const char *end)
+{
+#if SVN_UNALIGNED_ACCESS_IS_OK
+
+  /* Skip whole machine words at a time: classify all bytes of a word
+   * in parallel instead of looking each one up in skel_char_type.
+   * The terminators -- \t \n \f \r space ( ) [ ] -- are covered by the
+   * "any byte < 14" test plus one equality test per remaining value.
+   * The word-level test may report false positives (e.g. for control
+   * characters that are type_nothing), so the byte-by-byte loop below
+   * remains authoritative. */
+  for (; (apr_size_t)(end - data) >= sizeof(apr_uintptr_t);
+       data += sizeof(apr_uintptr_t))
+    {
+      apr_uintptr_t word = *(const apr_uintptr_t *)data;
+      apr_uintptr_t hits;
+
+      /* Any byte < 14, covering \t \n \f \r.  */
+      hits = (word - SKEL__ONES * 14) & ~word;
+
+      /* Space.  */
+      hits |= SKEL__ZERO_TEST(word ^ (SKEL__ONES * ' '));
+
+      /* '(' and ')' differ only in the lowest bit.  */
+      hits |= SKEL__ZERO_TEST((word | SKEL__ONES) ^ (SKEL__ONES * ')'));
+
+      /* '[' and ']'.  */
+      hits |= SKEL__ZERO_TEST(word ^ (SKEL__ONES * '['));
+      hits |= SKEL__ZERO_TEST(word ^ (SKEL__ONES * ']'));
+
+      if (hits & SKEL__HIGHS)
+        break;
+    }
+
+#endif
+
+  while (data < end
+         && skel_char_type[(unsigned char) *data] != type_space
+         && skel_char_type[(unsigned char) *data] != type_paren)
+    data++;
+
+  return data;
+}
+
+
 
 /* ### WTF? since when is number conversion LOCALE DEPENDENT? */
 /* stsp: In C99, various numerical string properties such as decimal point,
@@ -339,10 +406,7 @@ implicit_atom(const char *data,
     return NULL;
 
   /* Find the end of the string.  */
-  while (++data < end
-         && skel_char_type[(unsigned char) *data] != type_space
-         && skel_char_type[(unsigned char) *data] != type_paren)
-    ;
+  data = scan_atom_end(data + 1, end);
 
   /* Allocate the skel representing this string.  */
   s = apr_pcalloc(pool, sizeof(*s));
@@ -461,14 +525,9 @@ use_implicit(const svn_skel_t *skel)
 
   /* If it contains any whitespace or parens, then we must use
      explicit-length form.  */
-  {
-    apr_size_t i;
-
-    for (i = 1; i < skel->len; i++)
-      if (skel_char_type[(unsigned char) skel->data[i]] == type_space
-          || skel_char_type[(unsigned char) skel->data[i]] == type_paren)
-        return FALSE;
-  }
+  if (scan_atom_end(skel->data + 1, skel->data + skel->len)
+      != skel->data + skel->len)
+    return FALSE;
 
   /* If we can't reject it for any of the above reasons, then we can
      use implicit-length form.  */
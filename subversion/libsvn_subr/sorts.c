@@ -26,6 +26,9 @@
 #include <apr_pools.h>
 #include <apr_hash.h>
 #include <apr_tables.h>
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+#endif
 #include <stdlib.h>       /* for qsort()   */
 #include <assert.h>
 #include "svn_hash.h"
@@ -144,6 +147,227 @@ svn_sort__array(apr_array_header_t *array,
   qsort(array->elts, array->nelts, array->elt_size, comparison_func);
 }
 
+/* Ranges of up to this many elements get insertion-sorted directly
+ * instead of being split any further. */
+#define SMALL_SORT_THRESHOLD 16
+
+/* Only arrays with at least this many elements are worth distributing
+ * over multiple worker threads. */
+#define PARALLEL_SORT_THRESHOLD 65536
+
+/* Number of sub-ranges to sort concurrently.  Must be a power of two. */
+#define PARALLEL_SORT_WAYS 4
+
+/* Sort the NELTS elements of ELT_SIZE bytes each at BASE according to
+ * COMPARISON_FUNC using insertion sort.  TEMP must provide room for one
+ * element. */
+static void
+insertion_sort(char *base,
+               int nelts,
+               apr_size_t elt_size,
+               int (*comparison_func)(const void *, const void *),
+               char *temp)
+{
+  int i;
+
+  for (i = 1; i < nelts; ++i)
+    {
+      int j;
+
+      memcpy(temp, base + i * elt_size, elt_size);
+      for (j = i; j > 0 && comparison_func(base + (j - 1) * elt_size, temp) > 0;
+           --j)
+        memcpy(base + j * elt_size, base + (j - 1) * elt_size, elt_size);
+
+      memcpy(base + j * elt_size, temp, elt_size);
+    }
+}
+
+/* Merge the sorted ranges LHS (LHS_NELTS elements) and RHS (RHS_NELTS
+ * elements) of ELT_SIZE bytes each into TARGET, stable w.r.t.
+ * COMPARISON_FUNC.  TARGET may overlap RHS as long as it starts at least
+ * LHS_NELTS elements before it - the usual in-place merge layout. */
+static void
+merge_ranges(char *target,
+             const char *lhs,
+             int lhs_nelts,
+             const char *rhs,
+             int rhs_nelts,
+             apr_size_t elt_size,
+             int (*comparison_func)(const void *, const void *))
+{
+  while (lhs_nelts > 0 && rhs_nelts > 0)
+    {
+      /* Take from RHS only if strictly smaller to keep the sort stable. */
+      if (comparison_func(rhs, lhs) < 0)
+        {
+          memcpy(target, rhs, elt_size);
+          rhs += elt_size;
+          --rhs_nelts;
+        }
+      else
+        {
+          memcpy(target, lhs, elt_size);
+          lhs += elt_size;
+          --lhs_nelts;
+        }
+
+      target += elt_size;
+    }
+
+  if (lhs_nelts > 0)
+    memcpy(target, lhs, lhs_nelts * elt_size);
+  else if (rhs_nelts > 0 && target != rhs)
+    memcpy(target, rhs, rhs_nelts * elt_size);
+}
+
+/* Merge the two consecutive sorted ranges [BASE, BASE + MID) and
+ * [BASE + MID, BASE + NELTS) of ELT_SIZE byte elements in place.
+ * SCRATCH must provide room for MID elements. */
+static void
+merge_halves(char *base,
+             char *scratch,
+             int mid,
+             int nelts,
+             apr_size_t elt_size,
+             int (*comparison_func)(const void *, const void *))
+{
+  /* Skip the merge if the ranges happen to be in order already. */
+  if (comparison_func(base + (mid - 1) * elt_size, base + mid * elt_size) <= 0)
+    return;
+
+  memcpy(scratch, base, mid * elt_size);
+  merge_ranges(base, scratch, mid, base + mid * elt_size, nelts - mid,
+               elt_size, comparison_func);
+}
+
+/* Sort the NELTS elements of ELT_SIZE bytes each at BASE according to
+ * COMPARISON_FUNC using a stable merge sort.  SCRATCH must provide room
+ * for NELTS / 2 + 1 elements. */
+static void
+merge_sort(char *base,
+           char *scratch,
+           int nelts,
+           apr_size_t elt_size,
+           int (*comparison_func)(const void *, const void *))
+{
+  int mid;
+
+  if (nelts <= SMALL_SORT_THRESHOLD)
+    {
+      insertion_sort(base, nelts, elt_size, comparison_func, scratch);
+      return;
+    }
+
+  mid = nelts / 2;
+  merge_sort(base, scratch, mid, elt_size, comparison_func);
+  merge_sort(base + mid * elt_size, scratch, nelts - mid, elt_size,
+             comparison_func);
+  merge_halves(base, scratch, mid, nelts, elt_size, comparison_func);
+}
+
+#if APR_HAS_THREADS
+/* A sub-range sorting task of svn_sort__array_parallel(). */
+typedef struct parallel_sort_baton_t
+{
+  /* First element of the sub-range to sort. */
+  char *base;
+
+  /* Private merge buffer for NELTS / 2 + 1 elements. */
+  char *scratch;
+
+  /* Number of elements in the sub-range. */
+  int nelts;
+
+  /* Size of each element in bytes. */
+  apr_size_t elt_size;
+
+  /* Ordering to sort by. */
+  int (*comparison_func)(const void *, const void *);
+} parallel_sort_baton_t;
+
+/* Implements apr_thread_start_t, sorting the sub-range in BATON. */
+static void * APR_THREAD_FUNC
+parallel_sort_thread(apr_thread_t *thread,
+                     void *baton)
+{
+  parallel_sort_baton_t *b = baton;
+
+  merge_sort(b->base, b->scratch, b->nelts, b->elt_size, b->comparison_func);
+  return NULL;
+}
+#endif /* APR_HAS_THREADS */
+
+void
+svn_sort__array_parallel(apr_array_header_t *array,
+                         int (*comparison_func)(const void *,
+                                                const void *),
+                         apr_pool_t *scratch_pool)
+{
+  const apr_size_t elt_size = array->elt_size;
+  int nelts = array->nelts;
+  char *scratch = apr_palloc(scratch_pool,
+                             (nelts / 2 + PARALLEL_SORT_WAYS) * elt_size);
+
+#if APR_HAS_THREADS
+  if (nelts >= PARALLEL_SORT_THRESHOLD)
+    {
+      parallel_sort_baton_t batons[PARALLEL_SORT_WAYS];
+      apr_thread_t *threads[PARALLEL_SORT_WAYS];
+      int sub_nelts = nelts / PARALLEL_SORT_WAYS;
+      char *scratch_end = scratch;
+      int i;
+
+      /* Sort equally sized sub-ranges, each in its own worker thread. */
+      for (i = 0; i < PARALLEL_SORT_WAYS; ++i)
+        {
+          parallel_sort_baton_t *b = &batons[i];
+          apr_status_t status;
+
+          b->base = (char *)array->elts + (apr_size_t)i * sub_nelts * elt_size;
+          b->nelts = i + 1 == PARALLEL_SORT_WAYS
+                   ? nelts - i * sub_nelts
+                   : sub_nelts;
+          b->elt_size = elt_size;
+          b->comparison_func = comparison_func;
+          b->scratch = scratch_end;
+          scratch_end += (b->nelts / 2 + 1) * elt_size;
+
+          status = apr_thread_create(&threads[i], NULL, parallel_sort_thread,
+                                     b, scratch_pool);
+          if (status)
+            {
+              /* No more threads?  Sort this range inline. */
+              threads[i] = NULL;
+              parallel_sort_thread(NULL, b);
+            }
+        }
+
+      for (i = 0; i < PARALLEL_SORT_WAYS; ++i)
+        if (threads[i])
+          {
+            apr_status_t status;
+            apr_thread_join(&status, threads[i]);
+          }
+
+      /* Merge the sorted sub-ranges, adjacent pairs first, then the two
+       * halves.  The scratch buffer covers the NELTS / 2 elements needed
+       * for the final merge. */
+      merge_halves((char *)array->elts, scratch,
+                   sub_nelts, 2 * sub_nelts, elt_size, comparison_func);
+      merge_halves((char *)array->elts + (apr_size_t)2 * sub_nelts * elt_size,
+                   scratch, sub_nelts, nelts - 2 * sub_nelts, elt_size,
+                   comparison_func);
+      merge_halves((char *)array->elts, scratch,
+                   2 * sub_nelts, nelts, elt_size, comparison_func);
+
+      return;
+    }
+#endif /* APR_HAS_THREADS */
+
+  merge_sort(array->elts, scratch, nelts, elt_size, comparison_func);
+}
+
 apr_array_header_t *
 svn_sort__hash(apr_hash_t *ht,
                int (*comparison_func)(const svn_sort__item_t *,
@@ -188,6 +412,44 @@ svn_sort__hash(apr_hash_t *ht,
   return ary;
 }
 
+svn_sort__sorted_hash_t *
+svn_sort__sorted_hash(apr_hash_t *ht,
+                      int (*comparison_func)(const svn_sort__item_t *,
+                                             const svn_sort__item_t *),
+                      apr_pool_t *pool)
+{
+  svn_sort__sorted_hash_t *result = apr_pcalloc(pool, sizeof(*result));
+
+  result->items = svn_sort__hash(ht, comparison_func, pool);
+  result->comparison_func = comparison_func;
+  result->hint = -1;
+
+  return result;
+}
+
+void *
+svn_sort__sorted_hash_find(svn_sort__sorted_hash_t *sorted_hash,
+                           const void *key,
+                           apr_ssize_t klen)
+{
+  svn_sort__item_t search_item;
+  svn_sort__item_t *item;
+
+  if (klen == APR_HASH_KEY_STRING)
+    klen = strlen(key);
+
+  search_item.key = key;
+  search_item.klen = klen;
+  search_item.value = NULL;
+
+  item = svn_sort__array_lookup(sorted_hash->items, &search_item,
+                                &sorted_hash->hint,
+                                (int (*)(const void *, const void *))
+                                  sorted_hash->comparison_func);
+
+  return item ? item->value : NULL;
+}
+
 /* Return the lowest index at which the element *KEY should be inserted into
    the array at BASE which has NELTS elements of size ELT_SIZE bytes each,
    according to the ordering defined by COMPARE_FUNC.
@@ -22,6 +22,7 @@
  */
 
 #include <apr_file_io.h>
+#include <apr_mmap.h>
 
 #include "svn_io.h"
 #include "svn_pools.h"
@@ -29,6 +30,12 @@
 #include "private/svn_subr_private.h"
 
 
+/* Size of the sliding readback window when memory-mapping the spill
+   file.  Window boundaries are aligned to this value, which keeps the
+   mapping offsets page-aligned.  */
+#define SPILL_WINDOW_SIZE (1024 * 1024)
+
+
 struct memblock_t {
   apr_size_t size;
   char *data;
@@ -87,6 +94,25 @@ struct svn_spillbuf_t {
 
   /* The name of the temporary spill file. */
   const char *filename;
+
+#if APR_HAS_MMAP
+  /* When true, read spilled content back through a memory-mapped window
+     rather than buffered file I/O.  */
+  svn_boolean_t mmap_readback;
+
+  /* The readback window onto SPILL, mapping up to SPILL_WINDOW_SIZE
+     bytes starting at file offset MMAP_START.  MMAP_POOL is cleared
+     whenever the window moves, so the mapping's lifetime is decoupled
+     from POOL.  */
+  apr_mmap_t *mmap;
+  apr_pool_t *mmap_pool;
+  apr_off_t mmap_start;
+
+  /* A pseudo memblock whose DATA member points into the mapping.  It is
+     handed out by read_data() like an ordinary block, but must never be
+     placed onto the AVAIL list.  */
+  struct memblock_t mmap_block;
+#endif
 };
 
 
@@ -120,6 +146,7 @@ init_spillbuf_extended(svn_spillbuf_t *buf,
                        apr_size_t maxsize,
                        svn_boolean_t delete_on_close,
                        svn_boolean_t spill_all_contents,
+                       svn_boolean_t mmap_readback,
                        const char *dirpath,
                        apr_pool_t *result_pool)
 {
@@ -129,6 +156,9 @@ init_spillbuf_extended(svn_spillbuf_t *buf,
   buf->delete_on_close = delete_on_close;
   buf->spill_all_contents = spill_all_contents;
   buf->dirpath = dirpath;
+#if APR_HAS_MMAP
+  buf->mmap_readback = mmap_readback;
+#endif
 }
 
 /* Common constructor for initializing spillbufs.
@@ -140,7 +170,7 @@ init_spillbuf(svn_spillbuf_t *buf,
               apr_pool_t *result_pool)
 {
   init_spillbuf_extended(buf, blocksize, maxsize,
-                         TRUE, FALSE, NULL,
+                         TRUE, FALSE, FALSE, NULL,
                          result_pool);
 }
 
@@ -160,12 +190,14 @@ svn_spillbuf__create_extended(apr_size_t blocksize,
                               apr_size_t maxsize,
                               svn_boolean_t delete_on_close,
                               svn_boolean_t spill_all_contents,
+                              svn_boolean_t mmap_readback,
                               const char *dirpath,
                               apr_pool_t *result_pool)
 {
   svn_spillbuf_t *buf = apr_pcalloc(result_pool, sizeof(*buf));
   init_spillbuf_extended(buf, blocksize, maxsize,
-                         delete_on_close, spill_all_contents, dirpath,
+                         delete_on_close, spill_all_contents, mmap_readback,
+                         dirpath,
                          result_pool);
   return buf;
 }
@@ -194,7 +226,20 @@ svn_spillbuf__get_file(const svn_spillbuf_t *buf)
   return buf->spill;
 }
 
-/* Get a memblock from the spill-buffer. It will be the block that we
+/* Return TRUE if MEM is the pseudo block fronting the mmap window.  */
+static svn_boolean_t
+is_window_block(const svn_spillbuf_t *buf,
+                const struct memblock_t *mem)
+{
+#if APR_HAS_MMAP
+  return mem == &buf->mmap_block;
+#else
+  return FALSE;
+#endif
+}
+
+
+/* Get a memblock from the spill-buffer. It will be a block that we
    passed out for reading, come from the free list, or allocated.  */
 static struct memblock_t *
 get_buffer(svn_spillbuf_t *buf)
@@ -203,7 +248,7 @@ get_buffer(svn_spillbuf_t *buf)
 
   if (mem != NULL)
     {
-      buf->out_for_reading = NULL;
+      buf->out_for_reading = mem->next;
       return mem;
     }
 
@@ -225,11 +270,134 @@ static void
 return_buffer(svn_spillbuf_t *buf,
               struct memblock_t *mem)
 {
+  /* The window pseudo block is not an allocated buffer; it must never
+     enter the AVAIL list.  */
+  if (is_window_block(buf, mem))
+    return;
+
   mem->next = buf->avail;
   buf->avail = mem;
 }
 
 
+/* Return all blocks that BUF has passed out for reading to the list of
+   available buffers.  */
+static void
+release_out_blocks(svn_spillbuf_t *buf)
+{
+  while (buf->out_for_reading != NULL)
+    {
+      struct memblock_t *mem = buf->out_for_reading;
+
+      buf->out_for_reading = mem->next;
+      return_buffer(buf, mem);
+    }
+}
+
+
+#if APR_HAS_MMAP
+/* If the spill file has been consumed and closed, drop a readback window
+   that still maps the dead file.  The mapping is kept alive until this
+   point so that the most recently handed-out chunk remains readable.  */
+static void
+release_stale_window(svn_spillbuf_t *buf)
+{
+  if (buf->mmap != NULL && buf->spill == NULL)
+    {
+      svn_pool_clear(buf->mmap_pool);
+      buf->mmap = NULL;
+    }
+}
+
+
+/* Serve the next chunk of spilled content in BUF through the readback
+   window, setting *MEM to the window pseudo block.  If the mapping cannot
+   be established, set *MEM to NULL and permanently revert BUF to plain
+   file reads; the caller then falls through to the regular read path.  */
+static svn_error_t *
+read_from_window(struct memblock_t **mem,
+                 svn_spillbuf_t *buf,
+                 apr_pool_t *scratch_pool)
+{
+  apr_off_t offset_in_window;
+  apr_size_t chunk;
+
+  /* (Re-)position the window over SPILL_START, if it isn't already.  */
+  if (buf->mmap == NULL
+      || buf->spill_start < buf->mmap_start
+      || buf->spill_start >= buf->mmap_start + (apr_off_t)buf->mmap->size)
+    {
+      apr_off_t window_start;
+      apr_size_t window_size;
+      apr_status_t status;
+
+      if (buf->mmap_pool == NULL)
+        buf->mmap_pool = svn_pool_create(buf->pool);
+      else
+        svn_pool_clear(buf->mmap_pool);
+      buf->mmap = NULL;
+
+      /* Align the window to SPILL_WINDOW_SIZE; that keeps the mapping
+         offset page-aligned.  Cap the window at the end of the file.  */
+      window_start = buf->spill_start - (buf->spill_start % SPILL_WINDOW_SIZE);
+      window_size = SPILL_WINDOW_SIZE;
+      if ((svn_filesize_t)window_size
+          > buf->spill_size + (buf->spill_start - window_start))
+        window_size = (apr_size_t)(buf->spill_size
+                                   + (buf->spill_start - window_start));
+
+      status = apr_mmap_create(&buf->mmap, buf->spill, window_start,
+                               window_size, APR_MMAP_READ, buf->mmap_pool);
+      if (status)
+        {
+          /* Fall back to buffered file reads.  Re-establish the file
+             position, which mmap readback does not maintain.  */
+          apr_off_t output_unused = buf->spill_start;  /* ### stupid API  */
+
+          buf->mmap = NULL;
+          buf->mmap_readback = FALSE;
+          SVN_ERR(svn_io_file_seek(buf->spill,
+                                   APR_SET, &output_unused,
+                                   scratch_pool));
+
+          *mem = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      buf->mmap_start = window_start;
+    }
+
+  /* Hand out everything up to the end of the window, capped by the
+     amount of content remaining.  */
+  offset_in_window = buf->spill_start - buf->mmap_start;
+  chunk = buf->mmap->size - (apr_size_t)offset_in_window;
+  if ((svn_filesize_t)chunk > buf->spill_size)
+    chunk = (apr_size_t)buf->spill_size;
+
+  buf->mmap_block.data = (char *)buf->mmap->mm + offset_in_window;
+  buf->mmap_block.size = chunk;
+  buf->mmap_block.next = NULL;
+
+  /* Mark the data that we consumed from the spill file.  */
+  buf->spill_start += chunk;
+
+  /* Did we consume all the data from the spill file?  */
+  if ((buf->spill_size -= chunk) == 0)
+    {
+      /* Close and reset our spill file information.  The mapping
+         outlives the file and stays in place until the next call, so
+         the chunk handed out here remains valid.  */
+      SVN_ERR(svn_io_file_close(buf->spill, scratch_pool));
+      buf->spill = NULL;
+      buf->spill_start = 0;
+    }
+
+  *mem = &buf->mmap_block;
+  return SVN_NO_ERROR;
+}
+#endif /* APR_HAS_MMAP */
+
+
 svn_error_t *
 svn_spillbuf__write(svn_spillbuf_t *buf,
                     const char *data,
@@ -238,6 +406,10 @@ svn_spillbuf__write(svn_spillbuf_t *buf,
 {
   struct memblock_t *mem;
 
+#if APR_HAS_MMAP
+  release_stale_window(buf);
+#endif
+
   /* We do not (yet) have a spill file, but the amount stored in memory
      will grow too large. Create the file and place the pending data into
      the temporary file.  */
@@ -355,6 +527,10 @@ read_data(struct memblock_t **mem,
 {
   svn_error_t *err;
 
+#if APR_HAS_MMAP
+  release_stale_window(buf);
+#endif
+
   /* If we have some in-memory blocks, then return one.  */
   if (buf->head != NULL)
     {
@@ -378,6 +554,17 @@ read_data(struct memblock_t **mem,
       return SVN_NO_ERROR;
     }
 
+#if APR_HAS_MMAP
+  /* Read through the mmap window, unless establishing a mapping failed
+     and we reverted to buffered file reads.  */
+  if (buf->mmap_readback)
+    {
+      SVN_ERR(read_from_window(mem, buf, scratch_pool));
+      if (*mem != NULL)
+        return SVN_NO_ERROR;
+    }
+#endif
+
   /* Assume that the caller has seeked the spill file to the correct pos.  */
 
   /* Get a buffer that we can read content into.  */
@@ -466,18 +653,78 @@ svn_spillbuf__read(const char **data,
       *data = mem->data;
       *len = mem->size;
 
-      /* If a block was out for reading, then return it.  */
-      if (buf->out_for_reading != NULL)
-        return_buffer(buf, buf->out_for_reading);
+      /* If any blocks were out for reading, then return them.  */
+      release_out_blocks(buf);
 
-      /* Remember that we've passed this block out for reading.  */
-      buf->out_for_reading = mem;
+      /* Remember that we've passed this block out for reading.  The
+         window pseudo block never enters the lists; its validity is
+         managed by the window logic itself.  */
+      if (!is_window_block(buf, mem))
+        {
+          mem->next = NULL;
+          buf->out_for_reading = mem;
+        }
     }
 
   return SVN_NO_ERROR;
 }
 
 
+svn_error_t *
+svn_spillbuf__read_iovec(struct iovec *vecs,
+                         int *nvecs,
+                         svn_spillbuf_t *buf,
+                         apr_pool_t *scratch_pool)
+{
+  struct memblock_t *borrowed = NULL;
+  struct memblock_t *borrowed_tail = NULL;
+  int count = 0;
+
+  if (*nvecs <= 0)
+    return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL, NULL);
+
+  while (count < *nvecs)
+    {
+      struct memblock_t *mem;
+
+      /* Possibly seek... */
+      SVN_ERR(maybe_seek(NULL, buf, scratch_pool));
+
+      SVN_ERR(read_data(&mem, buf, scratch_pool));
+      if (mem == NULL)
+        break;
+
+      vecs[count].iov_base = mem->data;
+      vecs[count].iov_len = mem->size;
+      ++count;
+
+      /* Fetching another chunk would move the readback window and
+         thereby invalidate this one, so stop gathering here.  */
+      if (is_window_block(buf, mem))
+        break;
+
+      /* Keep the block on a local list so that get_buffer() cannot
+         recycle it while we gather further blocks.  */
+      mem->next = NULL;
+      if (borrowed_tail == NULL)
+        borrowed = borrowed_tail = mem;
+      else
+        {
+          borrowed_tail->next = mem;
+          borrowed_tail = mem;
+        }
+    }
+
+  /* Return the blocks from the previous read and pass the new batch
+     out for reading.  */
+  release_out_blocks(buf);
+  buf->out_for_reading = borrowed;
+
+  *nvecs = count;
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_spillbuf__process(svn_boolean_t *exhausted,
                       svn_spillbuf_t *buf,
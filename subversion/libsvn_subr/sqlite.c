@@ -39,6 +39,7 @@
 #include "private/svn_token.h"
 #ifdef WIN32
 #include "private/svn_io_private.h"
+#include "private/svn_perf.h"
 #include "private/svn_utf_private.h"
 #endif
 
@@ -344,7 +345,12 @@ svn_sqlite__step_row(svn_sqlite__stmt_t *stmt)
 svn_error_t *
 svn_sqlite__step(svn_boolean_t *got_row, svn_sqlite__stmt_t *stmt)
 {
-  int sqlite_result = sqlite3_step(stmt->s3stmt);
+  int sqlite_result;
+  SVN_PERF_TIMER(timer);
+
+  SVN_PERF_TIMER_START(timer);
+  sqlite_result = sqlite3_step(stmt->s3stmt);
+  SVN_PERF_TIMER_STOP(svn_perf__probe_sqlite_step, timer);
 
   if (sqlite_result != SQLITE_DONE && sqlite_result != SQLITE_ROW)
     {
@@ -386,6 +392,75 @@ svn_sqlite__update(int *affected_rows, svn_sqlite__stmt_t *stmt)
   return svn_error_trace(svn_sqlite__reset(stmt));
 }
 
+/* The stepping loop of svn_sqlite__stmt_run_batch(), operating on the
+   already prepared STMT.  On return STMT still holds the bindings of the
+   last row; the caller resets it. */
+static svn_error_t *
+run_batch(svn_sqlite__stmt_t *stmt,
+          int row_count,
+          svn_sqlite__bind_row_func_t bind_row_func,
+          void *baton,
+          apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < row_count; i++)
+    {
+      int sqlite_result;
+
+      svn_pool_clear(iterpool);
+
+      if (i > 0)
+        SQLITE_ERR(sqlite3_clear_bindings(stmt->s3stmt), stmt->db);
+
+      SVN_ERR(bind_row_func(stmt, i, baton, iterpool));
+
+      /* Step and reset without the needs_reset bookkeeping and error
+         wrapping of svn_sqlite__step(); we only construct an error when
+         sqlite actually reports one. */
+      sqlite_result = sqlite3_step(stmt->s3stmt);
+
+      if (sqlite_result == SQLITE_ROW)
+        return svn_error_create(SVN_ERR_SQLITE_ERROR, NULL,
+                                _("sqlite: Extra database row found"));
+      else if (sqlite_result != SQLITE_DONE)
+        return svn_error_createf(SQLITE_ERROR_CODE(sqlite_result), NULL,
+                                 "sqlite[S%d]: %s",
+                                 sqlite_result,
+                                 sqlite3_errmsg(stmt->db->db3));
+
+      SQLITE_ERR(sqlite3_reset(stmt->s3stmt), stmt->db);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_sqlite__stmt_run_batch(svn_sqlite__db_t *db,
+                           int stmt_idx,
+                           int row_count,
+                           svn_sqlite__bind_row_func_t bind_row_func,
+                           void *baton,
+                           apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_error_t *err;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, db, stmt_idx));
+  SVN_ERR(svn_sqlite__begin_savepoint(db));
+
+  err = run_batch(stmt, row_count, bind_row_func, baton, scratch_pool);
+
+  /* Whether the loop succeeded or bailed out mid-row, clear the bindings
+     of the last row and make sure the statement is reset. */
+  err = svn_error_compose_create(err, svn_sqlite__reset(stmt));
+
+  return svn_error_trace(svn_sqlite__finish_savepoint(db, err));
+}
+
 
 static svn_error_t *
 vbindf(svn_sqlite__stmt_t *stmt, const char *fmt, va_list ap)
@@ -21,6 +21,12 @@
  * ====================================================================
  */
 
+/* copy_file_range() is a GNU extension; ask for it before the first
+   system header is pulled in.  Harmless where glibc is not in use. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <assert.h>
 #include <stdio.h>
 
@@ -31,6 +37,9 @@
 #include <apr_errno.h>
 #include <apr_poll.h>
 #include <apr_portable.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
 
 #include <zlib.h>
 
@@ -50,6 +59,11 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_utf_private.h"
 
+#ifdef HAVE_COPY_FILE_RANGE
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 
 struct svn_stream_t {
   void *baton;
@@ -397,6 +411,99 @@ svn_stream_readline(svn_stream_t *stream,
   return SVN_NO_ERROR;
 }
 
+#ifdef HAVE_COPY_FILE_RANGE
+
+/* Maximum number of bytes to hand to a single copy_file_range() call.
+   Large enough to amortize the syscall, small enough to keep the
+   cancellation check responsive. */
+#define STREAM_COPY_RANGE_SIZE (16 * 1024 * 1024)
+
+/* Copy all remaining data from FROM_FILE to TO_FILE in the kernel,
+ * without routing it through userspace buffers.  Set *DONE to TRUE if
+ * the data has been copied.  If the kernel does not support copying
+ * between these two files, set *DONE to FALSE and return successfully;
+ * the caller shall fall back to a read/write loop.
+ * Invoke CANCEL_FUNC with CANCEL_BATON between copy chunks. */
+static svn_error_t *
+stream_copy_file_range(svn_boolean_t *done,
+                       apr_file_t *from_file,
+                       apr_file_t *to_file,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *scratch_pool)
+{
+  int from_fd, to_fd;
+  apr_off_t from_off, to_off;
+  off_t off_in, off_out;
+  svn_boolean_t copied_some = FALSE;
+
+  *done = FALSE;
+
+  if (apr_os_file_get(&from_fd, from_file) != APR_SUCCESS
+      || apr_os_file_get(&to_fd, to_file) != APR_SUCCESS)
+    return SVN_NO_ERROR;
+
+  /* APR may have buffered data on either handle, in which case the
+     kernel-level file offsets don't match the logical positions.
+     Flush pending writes and copy at explicit offsets derived from the
+     logical positions, leaving the kernel offsets alone. */
+  SVN_ERR(svn_io_file_flush(to_file, scratch_pool));
+
+  from_off = 0;
+  SVN_ERR(svn_io_file_seek(from_file, APR_CUR, &from_off, scratch_pool));
+  to_off = 0;
+  SVN_ERR(svn_io_file_seek(to_file, APR_CUR, &to_off, scratch_pool));
+
+  off_in = (off_t)from_off;
+  off_out = (off_t)to_off;
+
+  while (TRUE)
+    {
+      ssize_t copied;
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      do
+        copied = copy_file_range(from_fd, &off_in, to_fd, &off_out,
+                                 STREAM_COPY_RANGE_SIZE, 0);
+      while (copied == -1 && errno == EINTR);
+
+      if (copied == -1)
+        {
+          /* Not supported for this pair of files (different file
+             systems on older kernels, non-regular files, etc.)?
+             Use the generic loop, as long as we haven't copied
+             anything yet. */
+          if (! copied_some
+              && (errno == EINVAL || errno == EXDEV || errno == ENOSYS
+                  || errno == EBADF || errno == EOPNOTSUPP
+                  || errno == EPERM || errno == ETXTBSY))
+            return SVN_NO_ERROR;
+
+          return svn_error_wrap_apr(APR_FROM_OS_ERROR(errno),
+                                    _("Can't copy file data"));
+        }
+
+      if (copied == 0) /* EOF */
+        break;
+
+      copied_some = TRUE;
+    }
+
+  /* Let the APR handles catch up with what the kernel copied, so the
+     streams remain consistent for their close handlers. */
+  from_off = (apr_off_t)off_in;
+  SVN_ERR(svn_io_file_seek(from_file, APR_SET, &from_off, scratch_pool));
+  to_off = (apr_off_t)off_out;
+  SVN_ERR(svn_io_file_seek(to_file, APR_SET, &to_off, scratch_pool));
+
+  *done = TRUE;
+  return SVN_NO_ERROR;
+}
+
+#endif /* HAVE_COPY_FILE_RANGE */
+
 svn_error_t *svn_stream_copy3(svn_stream_t *from, svn_stream_t *to,
                               svn_cancel_func_t cancel_func,
                               void *cancel_baton,
@@ -406,6 +513,25 @@ svn_error_t *svn_stream_copy3(svn_stream_t *from, svn_stream_t *to,
   svn_error_t *err;
   svn_error_t *err2;
 
+#ifdef HAVE_COPY_FILE_RANGE
+  /* If both ends are kernel-backed files, copy in the kernel. */
+  if (svn_stream__aprfile(from) && svn_stream__aprfile(to))
+    {
+      svn_boolean_t done;
+
+      err = stream_copy_file_range(&done,
+                                   svn_stream__aprfile(from),
+                                   svn_stream__aprfile(to),
+                                   cancel_func, cancel_baton, scratch_pool);
+      if (err || done)
+        {
+          err2 = svn_error_compose_create(svn_stream_close(from),
+                                          svn_stream_close(to));
+          return svn_error_compose_create(err, err2);
+        }
+    }
+#endif
+
   /* Read and write chunks until we get a short read, indicating the
      end of the stream.  (We can't get a short write without an
      associated error.) */
@@ -1521,6 +1647,527 @@ svn_stream_checksummed2(svn_stream_t *stream,
   return s;
 }
 
+
+/* Pipelined write streams. */
+
+#if APR_HAS_THREADS
+
+/* Number of blocks in the hand-over ring of a pipelined write stream.
+   Also the maximum number of writes the producer may run ahead of the
+   worker thread before being throttled. */
+#define PIPELINED_WRITE_BLOCKS 8
+
+/* A block of data handed over to the worker of a pipelined write
+   stream. */
+struct pipelined_write_block
+{
+  /* The data to write.  Allocated in the stream's private pool, always
+     from the producer thread; the worker only ever reads it. */
+  char *data;
+
+  /* Number of data bytes in / allocated for DATA, respectively. */
+  apr_size_t len;
+  apr_size_t capacity;
+};
+
+/* Baton for pipelined write streams. */
+struct pipelined_write_baton
+{
+  /* The stream that the worker thread forwards all data to. */
+  svn_stream_t *wrapped;
+
+  /* Private root pool of this stream, with a thread-safe allocator.
+     Destroyed by the cleanup handler registered on the stream's
+     result pool. */
+  apr_pool_t *pool;
+
+  /* The worker thread and the primitives protecting the ring below. */
+  apr_thread_t *thread;
+  apr_thread_mutex_t *mutex;
+  apr_thread_cond_t *cond;
+
+  /* Ring of blocks to write.  TAKE is the next block that the worker
+     will pick up, COUNT the number of filled blocks. */
+  struct pipelined_write_block blocks[PIPELINED_WRITE_BLOCKS];
+  int take;
+  int count;
+
+  /* The producer closed the stream; the worker terminates once the
+     ring has drained. */
+  svn_boolean_t eof;
+
+  /* First error encountered by the worker, if any.  Once this is set,
+     the worker discards all further blocks.  The error gets delivered
+     by the close handler. */
+  svn_error_t *err;
+
+  /* The worker has been joined / the stream has been closed. */
+  svn_boolean_t joined;
+  svn_boolean_t closed;
+};
+
+/* Worker thread routine of a pipelined write stream: take blocks out
+   of DATA's ring in order and write them to the wrapped stream. */
+static void * APR_THREAD_FUNC
+pipelined_write_worker(apr_thread_t *tid, void *data)
+{
+  struct pipelined_write_baton *b = data;
+
+  apr_thread_mutex_lock(b->mutex);
+  while (TRUE)
+    {
+      struct pipelined_write_block *block;
+
+      while (b->count == 0 && !b->eof)
+        apr_thread_cond_wait(b->cond, b->mutex);
+
+      /* Terminate once the ring drained after close. */
+      if (b->count == 0)
+        break;
+
+      block = &b->blocks[b->take];
+      apr_thread_mutex_unlock(b->mutex);
+
+      /* We are the only writer of B->ERR until we get joined. */
+      if (!b->err)
+        {
+          apr_size_t len = block->len;
+          b->err = svn_error_trace(svn_stream_write(b->wrapped, block->data,
+                                                    &len));
+        }
+
+      apr_thread_mutex_lock(b->mutex);
+      b->take = (b->take + 1) % PIPELINED_WRITE_BLOCKS;
+      b->count--;
+      apr_thread_cond_broadcast(b->cond);
+    }
+  apr_thread_mutex_unlock(b->mutex);
+
+  return NULL;
+}
+
+/* Shut down B's worker: wake it up, wait for it to terminate and return
+   any error it encountered.  Further calls are no-ops returning
+   SVN_NO_ERROR. */
+static svn_error_t *
+pipelined_write_join(struct pipelined_write_baton *b)
+{
+  svn_error_t *err;
+  apr_status_t retval;
+
+  if (b->joined)
+    return SVN_NO_ERROR;
+
+  apr_thread_mutex_lock(b->mutex);
+  b->eof = TRUE;
+  apr_thread_cond_broadcast(b->cond);
+  apr_thread_mutex_unlock(b->mutex);
+
+  apr_thread_join(&retval, b->thread);
+  b->joined = TRUE;
+
+  err = b->err;
+  b->err = NULL;
+
+  return svn_error_trace(err);
+}
+
+/* Implements svn_write_fn_t: copy the data into a free ring block and
+   hand it to the worker, waiting for a free block if necessary. */
+static svn_error_t *
+write_handler_pipelined(void *baton, const char *data, apr_size_t *len)
+{
+  struct pipelined_write_baton *b = baton;
+  struct pipelined_write_block *block;
+
+  if (*len == 0)
+    return SVN_NO_ERROR;
+
+  apr_thread_mutex_lock(b->mutex);
+  while (b->count == PIPELINED_WRITE_BLOCKS)
+    apr_thread_cond_wait(b->cond, b->mutex);
+  block = &b->blocks[(b->take + b->count) % PIPELINED_WRITE_BLOCKS];
+  apr_thread_mutex_unlock(b->mutex);
+
+  /* BLOCK is free, i.e. the worker is provably not touching it.
+     If the worker already failed, we keep accepting (and discarding)
+     data; the error gets reported by the close handler, which is also
+     the only place where our callers look at checksum results etc. */
+  if (block->capacity < *len)
+    {
+      /* The previous, smaller buffer simply remains unused in B->POOL
+         until the whole stream gets cleaned up. */
+      block->data = apr_palloc(b->pool, *len);
+      block->capacity = *len;
+    }
+  memcpy(block->data, data, *len);
+  block->len = *len;
+
+  apr_thread_mutex_lock(b->mutex);
+  b->count++;
+  apr_thread_cond_broadcast(b->cond);
+  apr_thread_mutex_unlock(b->mutex);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t: drain the ring, terminate the worker and
+   close the wrapped stream - on this thread, so that checksum results
+   etc. get allocated in their expected pools.  Idempotent, because the
+   error paths of some callers cannot easily tell whether the stream has
+   already been closed. */
+static svn_error_t *
+close_handler_pipelined(void *baton)
+{
+  struct pipelined_write_baton *b = baton;
+  svn_error_t *err;
+
+  if (b->closed)
+    return SVN_NO_ERROR;
+
+  err = pipelined_write_join(b);
+  err = svn_error_compose_create(err, svn_stream_close(b->wrapped));
+  b->closed = TRUE;
+
+  return svn_error_trace(err);
+}
+
+/* Pool cleanup handler: make sure the worker is gone and release the
+   private pool, whether or not the stream was properly closed. */
+static apr_status_t
+pipelined_write_cleanup(void *baton)
+{
+  struct pipelined_write_baton *b = baton;
+
+  svn_error_clear(pipelined_write_join(b));
+  svn_pool_destroy(b->pool);
+
+  return APR_SUCCESS;
+}
+
+#endif /* APR_HAS_THREADS */
+
+svn_stream_t *
+svn_stream__pipelined_write(svn_stream_t *wrapped,
+                            apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  apr_pool_t *pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  struct pipelined_write_baton *b = apr_pcalloc(pool, sizeof(*b));
+  svn_stream_t *stream;
+
+  b->wrapped = wrapped;
+  b->pool = pool;
+
+  /* If we can't get the thread machinery, simply stay synchronous. */
+  if (apr_thread_mutex_create(&b->mutex, APR_THREAD_MUTEX_DEFAULT, pool)
+      || apr_thread_cond_create(&b->cond, pool)
+      || apr_thread_create(&b->thread, NULL, pipelined_write_worker, b,
+                           pool))
+    {
+      svn_pool_destroy(pool);
+      return wrapped;
+    }
+
+  stream = svn_stream_create(b, result_pool);
+  svn_stream_set_write(stream, write_handler_pipelined);
+  svn_stream_set_close(stream, close_handler_pipelined);
+
+  apr_pool_cleanup_register(result_pool, b, pipelined_write_cleanup,
+                            apr_pool_cleanup_null);
+
+  return stream;
+#else
+  return wrapped;
+#endif
+}
+
+/* Pipelined read streams. */
+
+#if APR_HAS_THREADS
+
+/* Number of blocks in the hand-over ring of a pipelined read stream,
+   i.e. the bounded distance the worker thread may read ahead of the
+   consumer. */
+#define PIPELINED_READ_BLOCKS 8
+
+/* Size of each block in the ring. */
+#define PIPELINED_READ_BLOCK_SIZE SVN__STREAM_CHUNK_SIZE
+
+/* A block of data read ahead by the worker of a pipelined read
+   stream. */
+struct pipelined_read_block
+{
+  /* PIPELINED_READ_BLOCK_SIZE bytes, allocated in the stream's private
+     pool.  Only the worker writes to it, and only while the block is
+     not part of the filled section of the ring. */
+  char *data;
+
+  /* Number of valid data bytes in DATA. */
+  apr_size_t len;
+};
+
+/* Baton for pipelined read streams. */
+struct pipelined_read_baton
+{
+  /* The stream that the worker thread reads ahead from. */
+  svn_stream_t *wrapped;
+
+  /* Private root pool of this stream, with a thread-safe allocator.
+     Destroyed by the cleanup handler registered on the stream's
+     result pool. */
+  apr_pool_t *pool;
+
+  /* The worker thread and the primitives protecting the ring below. */
+  apr_thread_t *thread;
+  apr_thread_mutex_t *mutex;
+  apr_thread_cond_t *cond;
+
+  /* Ring of blocks read ahead.  TAKE is the next block that the
+     consumer will drain, COUNT the number of filled blocks and OFFSET
+     how far into the TAKE block the consumer has gotten. */
+  struct pipelined_read_block blocks[PIPELINED_READ_BLOCKS];
+  int take;
+  int count;
+  apr_size_t offset;
+
+  /* The worker terminated: it hit the end of the wrapped stream, an
+     error, or STOP.  Set only by the worker. */
+  svn_boolean_t done;
+
+  /* The consumer is closing the stream; the worker terminates at the
+     next opportunity.  Set only by the consumer. */
+  svn_boolean_t stop;
+
+  /* Error encountered by the worker, if any.  Delivered to the consumer
+     once the ring has drained, or by the close handler. */
+  svn_error_t *err;
+
+  /* The worker has been joined / the stream has been closed. */
+  svn_boolean_t joined;
+  svn_boolean_t closed;
+};
+
+/* Worker thread routine of a pipelined read stream: fill free blocks
+   of DATA's ring, in order, from the wrapped stream. */
+static void * APR_THREAD_FUNC
+pipelined_read_worker(apr_thread_t *tid, void *data)
+{
+  struct pipelined_read_baton *b = data;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  apr_thread_mutex_lock(b->mutex);
+  while (!b->stop)
+    {
+      struct pipelined_read_block *block;
+      apr_size_t len;
+
+      if (b->count == PIPELINED_READ_BLOCKS)
+        {
+          apr_thread_cond_wait(b->cond, b->mutex);
+          continue;
+        }
+
+      block = &b->blocks[(b->take + b->count) % PIPELINED_READ_BLOCKS];
+      apr_thread_mutex_unlock(b->mutex);
+
+      /* BLOCK is free, i.e. the consumer is provably not touching it. */
+      len = PIPELINED_READ_BLOCK_SIZE;
+      err = svn_error_trace(svn_stream_read_full(b->wrapped, block->data,
+                                                 &len));
+      block->len = err ? 0 : len;
+
+      apr_thread_mutex_lock(b->mutex);
+      if (block->len > 0)
+        {
+          b->count++;
+          apr_thread_cond_broadcast(b->cond);
+        }
+
+      /* A short block marks the end of the wrapped stream. */
+      if (err || block->len < PIPELINED_READ_BLOCK_SIZE)
+        break;
+    }
+
+  /* We are the only writer of B->ERR until we get joined. */
+  b->err = err;
+  b->done = TRUE;
+  apr_thread_cond_broadcast(b->cond);
+  apr_thread_mutex_unlock(b->mutex);
+
+  return NULL;
+}
+
+/* Shut down B's worker: wake it up, wait for it to terminate and return
+   any error it encountered.  Further calls are no-ops returning
+   SVN_NO_ERROR. */
+static svn_error_t *
+pipelined_read_join(struct pipelined_read_baton *b)
+{
+  svn_error_t *err;
+  apr_status_t retval;
+
+  if (b->joined)
+    return SVN_NO_ERROR;
+
+  apr_thread_mutex_lock(b->mutex);
+  b->stop = TRUE;
+  apr_thread_cond_broadcast(b->cond);
+  apr_thread_mutex_unlock(b->mutex);
+
+  apr_thread_join(&retval, b->thread);
+  b->joined = TRUE;
+
+  err = b->err;
+  b->err = NULL;
+
+  return svn_error_trace(err);
+}
+
+/* Common implementation of the partial and the full read handler,
+   distinguished by REQUIRE_FULL: satisfy *LEN bytes of BUFFER from B's
+   ring, waiting for the worker where necessary. */
+static svn_error_t *
+read_handler_pipelined_common(struct pipelined_read_baton *b,
+                              char *buffer,
+                              apr_size_t *len,
+                              svn_boolean_t require_full)
+{
+  apr_size_t remaining = *len;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  apr_thread_mutex_lock(b->mutex);
+  while (remaining > 0)
+    {
+      struct pipelined_read_block *block;
+      apr_size_t chunk;
+
+      while (b->count == 0 && !b->done)
+        apr_thread_cond_wait(b->cond, b->mutex);
+
+      /* End of the wrapped stream - or the worker failed. */
+      if (b->count == 0)
+        {
+          err = b->err;
+          b->err = NULL;
+          break;
+        }
+
+      block = &b->blocks[b->take];
+      chunk = block->len - b->offset;
+      if (chunk > remaining)
+        chunk = remaining;
+      memcpy(buffer, block->data + b->offset, chunk);
+      buffer += chunk;
+      remaining -= chunk;
+      b->offset += chunk;
+
+      if (b->offset == block->len)
+        {
+          b->offset = 0;
+          b->take = (b->take + 1) % PIPELINED_READ_BLOCKS;
+          b->count--;
+          apr_thread_cond_broadcast(b->cond);
+        }
+
+      /* A partial read must not block once it got hold of some data. */
+      if (!require_full)
+        break;
+    }
+  apr_thread_mutex_unlock(b->mutex);
+
+  *len -= remaining;
+  return svn_error_trace(err);
+}
+
+/* Implements svn_read_fn_t. */
+static svn_error_t *
+read_handler_pipelined(void *baton, char *buffer, apr_size_t *len)
+{
+  return svn_error_trace(read_handler_pipelined_common(baton, buffer, len,
+                                                       FALSE));
+}
+
+/* Implements svn_read_fn_t, the "full" variant. */
+static svn_error_t *
+read_full_handler_pipelined(void *baton, char *buffer, apr_size_t *len)
+{
+  return svn_error_trace(read_handler_pipelined_common(baton, buffer, len,
+                                                       TRUE));
+}
+
+/* Implements svn_close_fn_t: terminate the worker and close the wrapped
+   stream.  Idempotent. */
+static svn_error_t *
+close_handler_pipelined_read(void *baton)
+{
+  struct pipelined_read_baton *b = baton;
+  svn_error_t *err;
+
+  if (b->closed)
+    return SVN_NO_ERROR;
+
+  err = pipelined_read_join(b);
+  err = svn_error_compose_create(err, svn_stream_close(b->wrapped));
+  b->closed = TRUE;
+
+  return svn_error_trace(err);
+}
+
+/* Pool cleanup handler: make sure the worker is gone and release the
+   private pool, whether or not the stream was properly closed. */
+static apr_status_t
+pipelined_read_cleanup(void *baton)
+{
+  struct pipelined_read_baton *b = baton;
+
+  svn_error_clear(pipelined_read_join(b));
+  svn_pool_destroy(b->pool);
+
+  return APR_SUCCESS;
+}
+
+#endif /* APR_HAS_THREADS */
+
+svn_stream_t *
+svn_stream__pipelined_read(svn_stream_t *wrapped,
+                           apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  apr_pool_t *pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  struct pipelined_read_baton *b = apr_pcalloc(pool, sizeof(*b));
+  svn_stream_t *stream;
+  int i;
+
+  b->wrapped = wrapped;
+  b->pool = pool;
+  for (i = 0; i < PIPELINED_READ_BLOCKS; i++)
+    b->blocks[i].data = apr_palloc(pool, PIPELINED_READ_BLOCK_SIZE);
+
+  /* If we can't get the thread machinery, simply stay synchronous. */
+  if (apr_thread_mutex_create(&b->mutex, APR_THREAD_MUTEX_DEFAULT, pool)
+      || apr_thread_cond_create(&b->cond, pool)
+      || apr_thread_create(&b->thread, NULL, pipelined_read_worker, b,
+                           pool))
+    {
+      svn_pool_destroy(pool);
+      return wrapped;
+    }
+
+  stream = svn_stream_create(b, result_pool);
+  svn_stream_set_read2(stream, read_handler_pipelined,
+                       read_full_handler_pipelined);
+  svn_stream_set_close(stream, close_handler_pipelined_read);
+
+  apr_pool_cleanup_register(result_pool, b, pipelined_read_cleanup,
+                            apr_pool_cleanup_null);
+
+  return stream;
+#else
+  return wrapped;
+#endif
+}
+
 /* Helper for svn_stream_contents_checksum() to compute checksum of
  * KIND of STREAM. This function doesn't close source stream. */
 static svn_error_t *
@@ -37,6 +37,19 @@
 
 #include "svn_private_config.h"
 
+/* Use SSE2 instructions in the hot string comparison primitives where
+ * the target architecture is known to provide them.  These paths also
+ * perform unaligned reads, so they depend on SVN_UNALIGNED_ACCESS_IS_OK
+ * (always true on x86 / x64). */
+#if SVN_UNALIGNED_ACCESS_IS_OK \
+    && (defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SVN_INTERNAL_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define SVN_INTERNAL_HAVE_SSE2 0
+#endif
+
 
 
 /* Allocate the space for a memory buffer from POOL.
@@ -392,6 +405,85 @@ svn_stringbuf_create_ensure(apr_size_t blocksize, apr_pool_t *pool)
   return new_string;
 }
 
+/* Inline buffer capacity that svn_stringbuf__arena_buf hands out when
+ * the caller asks for less.  Sized for the short strings protocol
+ * parsers build: most tokens, paths and words fit, and buffers that
+ * start this large rarely need to grow at all. */
+#define ARENA_DEFAULT_CAPACITY 64
+
+struct svn_stringbuf__arena_t
+{
+  apr_pool_t *pool;     /* for blocks and for overflowing buffers */
+  char *block;          /* current carving block */
+  apr_size_t size;      /* allocated size of BLOCK */
+  apr_size_t used;      /* bytes of BLOCK handed out so far */
+};
+
+svn_stringbuf__arena_t *
+svn_stringbuf__arena_create(apr_size_t block_size, apr_pool_t *pool)
+{
+  svn_stringbuf__arena_t *arena = apr_palloc(pool, sizeof(*arena));
+
+  /* Make sure at least a couple of default-sized buffers fit, so the
+   * carving fast path actually gets used. */
+  if (block_size < 4 * (sizeof(svn_stringbuf_t) + ARENA_DEFAULT_CAPACITY))
+    block_size = 4 * (sizeof(svn_stringbuf_t) + ARENA_DEFAULT_CAPACITY);
+
+  arena->pool = pool;
+  arena->size = APR_ALIGN_DEFAULT(block_size);
+  arena->block = apr_palloc(pool, arena->size);
+  arena->used = 0;
+
+  return arena;
+}
+
+svn_stringbuf_t *
+svn_stringbuf__arena_buf(svn_stringbuf__arena_t *arena, apr_size_t capacity)
+{
+  svn_stringbuf_t *buf;
+  apr_size_t chunk;
+
+  if (capacity < ARENA_DEFAULT_CAPACITY)
+    capacity = ARENA_DEFAULT_CAPACITY;
+
+  /* Header plus inline buffer in a single aligned carve, mirroring the
+   * one-chunk layout of svn_stringbuf_create_ensure().  Keeping every
+   * carve aligned keeps the headers of subsequent carves aligned. */
+  chunk = APR_ALIGN_DEFAULT(sizeof(*buf) + capacity + 1);
+
+  if (chunk > arena->size - arena->used)
+    {
+      /* Buffers too large for a whole block are not worth carving;
+       * give them their own allocation. */
+      if (chunk > arena->size)
+        return svn_stringbuf_create_ensure(capacity, arena->pool);
+
+      /* Start a new block.  The remainder of the old block is wasted,
+       * but bounded by one buffer's worth of bytes; the block itself
+       * is abandoned to the pool, costing no more memory than
+       * allocating all its strings individually would have. */
+      arena->block = apr_palloc(arena->pool, arena->size);
+      arena->used = 0;
+    }
+
+  buf = (svn_stringbuf_t *)(arena->block + arena->used);
+  arena->used += chunk;
+
+  buf->data = (char *)buf + sizeof(*buf);
+  buf->data[0] = '\0';
+  buf->len = 0;
+  buf->blocksize = chunk - sizeof(*buf);
+  buf->pool = arena->pool;
+
+  return buf;
+}
+
+void
+svn_stringbuf__arena_reset(svn_stringbuf__arena_t *arena)
+{
+  arena->used = 0;
+}
+
 svn_stringbuf_t *
 svn_stringbuf_ncreate(const char *bytes, apr_size_t size, apr_pool_t *pool)
 {
@@ -1508,6 +1600,23 @@ svn_cstring__match_length(const char *a,
 {
   apr_size_t pos = 0;
 
+#if SVN_INTERNAL_HAVE_SSE2
+
+  /* Compare whole SSE registers at a time.  Just like the chunky
+   * processing below, we only need to detect *whether* a chunk differs;
+   * the following loops will then locate the exact mismatch position.
+   */
+  for (; max_len - pos >= sizeof(__m128i); pos += sizeof(__m128i))
+    {
+      __m128i chunk_a = _mm_loadu_si128((const __m128i *)(a + pos));
+      __m128i chunk_b = _mm_loadu_si128((const __m128i *)(b + pos));
+
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk_a, chunk_b)) != 0xffff)
+        break;
+    }
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Chunky processing is so much faster ...
@@ -1536,6 +1645,23 @@ svn_cstring__reverse_match_length(const char *a,
 {
   apr_size_t pos = 0;
 
+#if SVN_INTERNAL_HAVE_SSE2
+
+  /* Compare whole SSE registers at a time; see
+   * svn_cstring__match_length. */
+  for (pos = sizeof(__m128i); pos <= max_len; pos += sizeof(__m128i))
+    {
+      __m128i chunk_a = _mm_loadu_si128((const __m128i *)(a - pos));
+      __m128i chunk_b = _mm_loadu_si128((const __m128i *)(b - pos));
+
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk_a, chunk_b)) != 0xffff)
+        break;
+    }
+
+  pos -= sizeof(__m128i);
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Chunky processing is so much faster ...
@@ -1544,7 +1670,7 @@ svn_cstring__reverse_match_length(const char *a,
    * because A and B will probably have different alignment. So, skipping
    * the first few chars until alignment is reached is not an option.
    */
-  for (pos = sizeof(apr_size_t); pos <= max_len; pos += sizeof(apr_size_t))
+  for (pos += sizeof(apr_size_t); pos <= max_len; pos += sizeof(apr_size_t))
     if (*(const apr_size_t*)(a - pos) != *(const apr_size_t*)(b - pos))
       break;
 
@@ -52,6 +52,19 @@
 #include "private/svn_string_private.h"
 #include "private/svn_eol_private.h"
 
+/* Use SSE2 compares in the hot translation scanner where the target
+ * architecture is known to provide them; see the equivalent block in
+ * string.c.  The vector path performs unaligned reads, hence the
+ * additional dependency on SVN_UNALIGNED_ACCESS_IS_OK. */
+#if SVN_UNALIGNED_ACCESS_IS_OK \
+    && (defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SVN_INTERNAL_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define SVN_INTERNAL_HAVE_SSE2 0
+#endif
+
 /**
  * The textual elements of a detranslated special file.  One of these
  * strings must appear as the first element of any special file as it
@@ -980,6 +993,46 @@ eol_unchanged(struct translation_baton *b,
   return !b->interesting[(unsigned char)buf[1]] || buf[0] == buf[1];
 }
 
+#if SVN_INTERNAL_HAVE_SSE2
+/* Return the number of leading bytes in BUF (LEN bytes long) that are
+ * not marked 'interesting' in B, skipping a whole SSE register's worth
+ * of boring data per iteration.  The result may stop short of the first
+ * interesting byte by up to 15 bytes; the caller's scalar loop will
+ * locate its exact position.
+ *
+ * This relies on the only characters ever flagged in B->INTERESTING
+ * being '$', '\r' and '\n' - see create_translation_baton().
+ */
+static apr_size_t
+scan_boring(const struct translation_baton *b,
+            const char *buf,
+            apr_size_t len)
+{
+  apr_size_t pos = 0;
+  const __m128i dollar = _mm_set1_epi8('$');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  const svn_boolean_t eols_interesting
+    = b->interesting[(unsigned char)'\n'];
+
+  for (; len - pos >= sizeof(__m128i); pos += sizeof(__m128i))
+    {
+      __m128i chunk = _mm_loadu_si128((const __m128i *)(buf + pos));
+      __m128i hits = _mm_cmpeq_epi8(chunk, dollar);
+
+      if (eols_interesting)
+        hits = _mm_or_si128(hits,
+                            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr),
+                                         _mm_cmpeq_epi8(chunk, lf)));
+
+      if (_mm_movemask_epi8(hits))
+        break;
+    }
+
+  return pos;
+}
+#endif
+
 
 /* Translate eols and keywords of a 'chunk' of characters BUF of size BUFLEN
  * according to the settings and state stored in baton B.
@@ -1125,6 +1178,11 @@ translate_chunk(svn_stream_t *dst,
 
               if (b->keywords)
                 {
+#if SVN_INTERNAL_HAVE_SSE2
+                  /* Skip boring spans with wide compares; see
+                     scan_boring(). */
+                  len += scan_boring(b, p + len, end - (p + len));
+#else
                   /* Check 4 bytes at once to allow for efficient pipelining
                     and to reduce loop condition overhead. */
                   while ((end - p) >= (len + 4))
@@ -1137,9 +1195,10 @@ translate_chunk(svn_stream_t *dst,
 
                       len += 4;
                     }
+#endif
 
-                  /* Found an interesting char or EOF in the next 4 bytes.
-                     Find its exact position. */
+                  /* Found an interesting char or EOF in the next few
+                     bytes.  Find its exact position. */
                   while ((p + len) < end
                          && !interesting[(unsigned char)p[len]])
                     ++len;
@@ -0,0 +1,175 @@
+/*
+ * thread_batch.c: running independent tasks on worker thread batches
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_error.h"
+#include "svn_pools.h"
+#include "svn_private_config.h"
+
+#include "private/svn_thread_batch.h"
+
+#if APR_HAS_THREADS
+
+/* APR thread function running a single task.  DATA is the
+ * svn_thread_batch__task_t to execute. */
+static void * APR_THREAD_FUNC
+execute_task(apr_thread_t *thread, void *data)
+{
+  svn_thread_batch__task_t *task = data;
+
+  task->result = task->work_func(task->baton, task->pool);
+  apr_thread_exit(thread, APR_SUCCESS);
+
+  return NULL;
+}
+
+#endif
+
+svn_error_t *
+svn_thread_batch__collect(apr_array_header_t *tasks)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  for (i = 0; i < tasks->nelts; ++i)
+    {
+      svn_thread_batch__task_t *task
+        = APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *);
+
+      err = svn_error_compose_create(err, task->result);
+      task->result = SVN_NO_ERROR;
+    }
+
+  return err;
+}
+
+svn_error_t *
+svn_thread_batch__run(apr_size_t num_threads,
+                      svn_thread_batch__init_func_t init_func,
+                      svn_thread_batch__work_func_t work_func,
+                      svn_thread_batch__process_func_t process_func,
+                      void *context,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool)
+{
+  svn_boolean_t done = FALSE;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *tasks
+    = apr_array_make(scratch_pool, (int)num_threads,
+                     sizeof(svn_thread_batch__task_t *));
+
+  while (!done)
+    {
+      int i;
+      apr_size_t k;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      svn_pool_clear(iterpool);
+      apr_array_clear(tasks);
+
+      /* Cancellation funcs tend to not be thread-safe.
+       * Poll them here, between batches, from this thread only. */
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      /* Set up and spawn the next batch of tasks.  Each task gets a
+       * private root pool such that allocation on worker threads does
+       * not synchronize with the others. */
+      for (k = 0; k < num_threads; ++k)
+        {
+          apr_pool_t *task_pool
+            = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+          svn_thread_batch__task_t *task = apr_pcalloc(task_pool,
+                                                       sizeof(*task));
+#if APR_HAS_THREADS
+          apr_status_t status;
+#endif
+
+          task->pool = task_pool;
+          err = init_func(&task->baton, context, task_pool, iterpool);
+          if (err || task->baton == NULL)
+            {
+              done = task->baton == NULL;
+              svn_pool_destroy(task_pool);
+              break;
+            }
+
+          task->work_func = work_func;
+#if APR_HAS_THREADS
+          status = apr_thread_create(&task->thread, NULL, execute_task,
+                                     task, task_pool);
+          if (status)
+            {
+              svn_pool_destroy(task_pool);
+              err = svn_error_wrap_apr(status, _("Can't create thread"));
+              break;
+            }
+#else
+          /* If there is no thread support, simply run the task here. */
+          task->result = work_func(task->baton, task_pool);
+#endif
+
+          APR_ARRAY_PUSH(tasks, svn_thread_batch__task_t *) = task;
+        }
+
+#if APR_HAS_THREADS
+      /* Wait for all tasks that we actually started - whether the
+       * batch completed or not. */
+      for (i = 0; i < tasks->nelts; ++i)
+        {
+          apr_status_t status;
+          svn_thread_batch__task_t *task
+            = APR_ARRAY_IDX(tasks, i, svn_thread_batch__task_t *);
+
+          apr_thread_join(&status, task->thread);
+        }
+#endif
+
+      /* Process the batch serially, in task order.  If the setup failed,
+       * the process func does not get to see the incomplete batch; we
+       * merely add the workers' errors to the setup error. */
+      if (err)
+        err = svn_error_compose_create(err,
+                                       svn_thread_batch__collect(tasks));
+      else if (tasks->nelts)
+        {
+          err = process_func(tasks, context, iterpool);
+
+          /* The process func may have made more work available to the
+           * init func, e.g. to retry tasks.  Keep going until a batch
+           * comes up empty. */
+          done = FALSE;
+        }
+
+      /* Release the task pools - in success and error cases alike. */
+      for (i = 0; i < tasks->nelts; ++i)
+        svn_pool_destroy(APR_ARRAY_IDX(tasks, i,
+                                       svn_thread_batch__task_t *)->pool);
+
+      SVN_ERR(err);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
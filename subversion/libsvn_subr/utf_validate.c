@@ -59,6 +59,43 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_eol_private.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_atomic.h"
+
+/* Use SSE2 instructions for the ASCII fast path where the target
+ * architecture is known to provide them; see the equivalent block in
+ * string.c.  The vector path performs unaligned reads, hence the
+ * additional dependency on SVN_UNALIGNED_ACCESS_IS_OK. */
+#if SVN_UNALIGNED_ACCESS_IS_OK \
+    && (defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SVN_INTERNAL_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define SVN_INTERNAL_HAVE_SSE2 0
+#endif
+
+/* Decide at compile time whether we can provide the SSSE3 block
+ * validator for non-ASCII data.  Like the SHA-1 kernel in sha1.c, it
+ * relies on per-function target attributes (or MSVC, which allows all
+ * intrinsics unconditionally), so that the rest of the library can
+ * still be built for a generic CPU; the kernel is only entered after a
+ * run-time CPUID check.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+# if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8)
+#  define SVN_INTERNAL_UTF8_SSSE3 1
+#  define SVN_INTERNAL_UTF8_TARGET __attribute__((target("ssse3")))
+#  include <immintrin.h>
+#  include <cpuid.h>
+# endif
+#elif defined(_M_X64) || defined(_M_IX86)
+# if defined(_MSC_VER) && _MSC_VER >= 1910
+#  define SVN_INTERNAL_UTF8_SSSE3 1
+#  define SVN_INTERNAL_UTF8_TARGET
+#  include <immintrin.h>
+#  include <intrin.h>
+# endif
+#endif
 
 /* Lookup table to categorise each octet in the string. */
 static const char octet_category[256] = {
@@ -258,6 +295,17 @@ static const char machine [9][14] = {
 static const char *
 first_non_fsm_start_char(const char *data, apr_size_t max_len)
 {
+#if SVN_INTERNAL_HAVE_SSE2
+
+  /* Skip whole SSE registers of ASCII-only data at a time.  The sign
+   * bit of each byte tells whether it is outside the cat 0 range. */
+  for (; max_len >= sizeof(__m128i); data += sizeof(__m128i),
+                                     max_len -= sizeof(__m128i))
+    if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)data)))
+      break;
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Scan the input one machine word at a time. */
@@ -276,6 +324,225 @@ first_non_fsm_start_char(const char *data, apr_size_t max_len)
   return data;
 }
 
+#ifdef SVN_INTERNAL_UTF8_SSSE3
+
+/* Bits for the error classes that can be detected from a byte pair,
+ * i.e. from the high nibble and the low nibble of a byte plus the high
+ * nibble of the byte following it.  Each of the three nibble-indexed
+ * lookup tables below maps its nibble to the set of classes it may be
+ * part of; a bit set in all three marks an impossible byte pair.
+ */
+#define UTF8_TOO_SHORT      (1 << 0) /* lead byte not followed by a cont. */
+#define UTF8_TOO_LONG       (1 << 1) /* cont. byte after a complete char */
+#define UTF8_OVERLONG_3     (1 << 2) /* e0 80-9f: overlong 3-byte form */
+#define UTF8_TOO_LARGE      (1 << 3) /* f4 90-bf etc.: above U+10FFFF */
+#define UTF8_SURROGATE      (1 << 4) /* ed a0-bf: UTF-16 surrogates */
+#define UTF8_OVERLONG_2     (1 << 5) /* c0-c1: overlong 2-byte form */
+#define UTF8_TOO_LARGE_1000 (1 << 6) /* f5-ff 80-bf: above U+10FFFF */
+#define UTF8_OVERLONG_4     (1 << 6) /* f0 80-8f: overlong 4-byte form */
+#define UTF8_TWO_CONTS      (1 << 7) /* second / third cont. byte */
+
+/* Carried by every low nibble so that the classes detectable from the
+ * other two nibbles alone remain detectable. */
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+/* Classify the 16 bytes in INPUT, given the preceding 16 bytes in
+ * PREV_INPUT, and return ERROR with a non-zero byte OR-ed in for every
+ * invalid byte pair found.  This is the shuffle-based classification
+ * from Keiser / Lemire, "Validating UTF-8 In Less Than One Instruction
+ * Per Byte" (Software: Practice & Experience 51(5), 2021): PSHUFB
+ * performs all 16 lookups of one nibble table at once, and ANDing the
+ * three per-nibble class sets leaves exactly the errors.
+ *
+ * Byte pairs cannot tell a second continuation byte (valid) from a
+ * third one following a 2-byte lead (invalid), so the TWO_CONTS bit is
+ * instead compared against the positions two / three bytes after a
+ * >= 0xe0 / >= 0xf0 lead, where such a continuation must occur; any
+ * mismatch in either direction is an error.
+ */
+SVN_INTERNAL_UTF8_TARGET
+static __m128i
+validate_block_ssse3(__m128i error, __m128i input, __m128i prev_input)
+{
+  const __m128i byte_1_high_table = _mm_setr_epi8(
+    /* 0x0_-0x7_: ASCII */
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    /* 0x8_-0xb_: continuation */
+    (char)UTF8_TWO_CONTS, (char)UTF8_TWO_CONTS,
+    (char)UTF8_TWO_CONTS, (char)UTF8_TWO_CONTS,
+    /* 0xc_, 0xd_: 2-byte lead */
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    UTF8_TOO_SHORT,
+    /* 0xe_: 3-byte lead */
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    /* 0xf_: 4-byte lead */
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+                   | UTF8_OVERLONG_4);
+  const __m128i byte_1_low_table = _mm_setr_epi8(
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    (char)UTF8_CARRY, (char)UTF8_CARRY,
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+                      | UTF8_SURROGATE),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000));
+  const __m128i byte_2_high_table = _mm_setr_epi8(
+    /* 0x0_-0x7_: ASCII */
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    /* 0x8_, 0x9_, 0xa_, 0xb_: continuation */
+    (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS
+                         | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000),
+    (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS
+                         | UTF8_OVERLONG_3 | UTF8_TOO_LARGE),
+    (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS
+                         | UTF8_SURROGATE | UTF8_TOO_LARGE),
+    (char)(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS
+                         | UTF8_SURROGATE | UTF8_TOO_LARGE),
+    /* 0xc_-0xf_: lead */
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+  const __m128i low_nibble_mask = _mm_set1_epi8(0x0f);
+
+  const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+  const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+  const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+  const __m128i byte_1_high
+    = _mm_shuffle_epi8(byte_1_high_table,
+                       _mm_and_si128(_mm_srli_epi16(prev1, 4),
+                                     low_nibble_mask));
+  const __m128i byte_1_low
+    = _mm_shuffle_epi8(byte_1_low_table,
+                       _mm_and_si128(prev1, low_nibble_mask));
+  const __m128i byte_2_high
+    = _mm_shuffle_epi8(byte_2_high_table,
+                       _mm_and_si128(_mm_srli_epi16(input, 4),
+                                     low_nibble_mask));
+  const __m128i special_cases
+    = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+  /* Saturated subtraction leaves a non-zero (but small, hence signed
+   * positive) value exactly for bytes >= 0xe0 / >= 0xf0. */
+  const __m128i is_third_byte
+    = _mm_subs_epu8(prev2, _mm_set1_epi8((char)0xdf));
+  const __m128i is_fourth_byte
+    = _mm_subs_epu8(prev3, _mm_set1_epi8((char)0xef));
+  const __m128i must_be_cont
+    = _mm_cmpgt_epi8(_mm_or_si128(is_third_byte, is_fourth_byte),
+                     _mm_setzero_si128());
+
+  return _mm_or_si128(error,
+                      _mm_xor_si128(_mm_and_si128(must_be_cont,
+                                                  _mm_set1_epi8((char)0x80)),
+                                    special_cases));
+}
+
+/* SSSE3 version of svn_utf__is_valid, processing 16 input bytes per
+ * iteration.  Only called for LEN >= 16.
+ */
+SVN_INTERNAL_UTF8_TARGET
+static svn_boolean_t
+is_valid_ssse3(const char *data, apr_size_t len)
+{
+  __m128i error = _mm_setzero_si128();
+  __m128i prev_input = _mm_setzero_si128();
+  svn_boolean_t prev_ascii = TRUE;
+  char buffer[sizeof(__m128i)];
+  __m128i input;
+  svn_boolean_t ascii;
+
+  for (; len >= sizeof(__m128i); data += sizeof(__m128i),
+                                 len -= sizeof(__m128i))
+    {
+      input = _mm_loadu_si128((const __m128i *)data);
+      ascii = _mm_movemask_epi8(input) == 0;
+
+      /* An ASCII-only block needs no checking unless the previous block
+       * ended in an unterminated multi-byte sequence, which the full
+       * check detects via PREV_INPUT. */
+      if (!ascii || !prev_ascii)
+        error = validate_block_ssse3(error, input, prev_input);
+
+      prev_input = input;
+      prev_ascii = ascii;
+    }
+
+  /* Process the remaining 0 to 15 bytes as one zero-padded block.  NUL
+   * is valid ASCII, so the padding cannot introduce errors, while a
+   * multi-byte sequence cut short by the end of the input runs into the
+   * padding and gets flagged as TOO_SHORT.  The block is processed even
+   * when empty so that a sequence ending exactly on the last complete
+   * block still has its trailing lead bytes checked. */
+  memset(buffer, 0, sizeof(buffer));
+  memcpy(buffer, data, len);
+  input = _mm_loadu_si128((const __m128i *)buffer);
+  if (_mm_movemask_epi8(input) != 0 || !prev_ascii)
+    error = validate_block_ssse3(error, input, prev_input);
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128()))
+         == 0xffff;
+}
+
+/* Return whether the CPU we are running on implements SSSE3. */
+static svn_boolean_t
+utf8_ssse3_cpu_support(void)
+{
+#ifdef _MSC_VER
+  int info[4];
+
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) != 0;   /* ECX: SSSE3 */
+#else
+  unsigned int eax, ebx, ecx, edx;
+
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return FALSE;
+
+  return (ecx & (1u << 9)) != 0;      /* ECX: SSSE3 */
+#endif
+}
+
+/* Set by utf8_ssse3_detect(), protected by UTF8_SSSE3_DETECTED. */
+static svn_boolean_t utf8_ssse3_usable = FALSE;
+static volatile svn_atomic_t utf8_ssse3_detected = 0;
+
+/* svn_atomic__str_init_func_t checking for SSSE3 support.  Beyond the
+ * CPU feature bit, require the kernel to classify a known sample
+ * correctly, so that a miscompiled kernel degrades to the state machine
+ * instead of misjudging user data.
+ */
+static const char *
+utf8_ssse3_detect(void *baton)
+{
+  if (utf8_ssse3_cpu_support())
+    utf8_ssse3_usable
+      = is_valid_ssse3("two-byte \xc3\xa4, three-byte \xe2\x82\xac", 27)
+        && !is_valid_ssse3("an overlong sequence: \xc0\xaf", 24);
+
+  return NULL;
+}
+
+/* Return whether the SSSE3 code path may be used on this machine. */
+static svn_boolean_t
+utf8_ssse3_enabled(void)
+{
+  svn_atomic__init_once_no_error(&utf8_ssse3_detected, utf8_ssse3_detect,
+                                 NULL);
+  return utf8_ssse3_usable;
+}
+
+#endif /* SVN_INTERNAL_UTF8_SSSE3 */
+
 const char *
 svn_utf__last_valid(const char *data, apr_size_t len)
 {
@@ -290,7 +557,9 @@ svn_utf__last_valid(const char *data, apr_size_t len)
       int category = octet_category[octet];
       state = machine[state][category];
       if (state == FSM_START)
-        start = data;
+        /* Completed a character; resume the fast scan for ASCII-only
+           data. */
+        start = data = first_non_fsm_start_char(data, end - data);
     }
   return start;
 }
@@ -313,6 +582,11 @@ svn_utf__is_valid(const char *data, apr_size_t len)
   if (!data)
     return FALSE;
 
+#ifdef SVN_INTERNAL_UTF8_SSSE3
+  if (len >= sizeof(__m128i) && utf8_ssse3_enabled())
+    return is_valid_ssse3(data, len);
+#endif
+
   data = first_non_fsm_start_char(data, len);
 
   while (data < end)
@@ -320,6 +594,10 @@ svn_utf__is_valid(const char *data, apr_size_t len)
       unsigned char octet = *data++;
       int category = octet_category[octet];
       state = machine[state][category];
+      if (state == FSM_START)
+        /* Completed a character; resume the fast scan for ASCII-only
+           data. */
+        data = first_non_fsm_start_char(data, end - data);
     }
   return state == FSM_START;
 }
@@ -408,7 +686,9 @@ svn_utf__last_valid2(const char *data, apr_size_t len)
           return start;
         }
       if (state == FSM_START)
-        start = data;
+        /* Completed a character; resume the fast scan for ASCII-only
+           data. */
+        start = data = first_non_fsm_start_char(data, end - data);
     }
   return start;
 }
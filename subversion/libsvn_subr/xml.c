@@ -35,6 +35,20 @@
 
 #include "private/svn_utf_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_dep_compat.h"
+
+/* Use SSE2 compares in the escape scanners where the target architecture
+ * is known to provide them; see the equivalent block in string.c.  The
+ * vector path performs unaligned reads, hence the additional dependency
+ * on SVN_UNALIGNED_ACCESS_IS_OK. */
+#if SVN_UNALIGNED_ACCESS_IS_OK \
+    && (defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SVN_INTERNAL_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define SVN_INTERNAL_HAVE_SSE2 0
+#endif
 
 #ifdef SVN_HAVE_OLD_EXPAT
 #include <xmlparse.h>
@@ -132,6 +146,85 @@ svn_xml_is_xml_safe(const char *data, apr_size_t len)
 
 /*** XML escaping. ***/
 
+/* Return a pointer to the first char in [DATA, END) that cdata escaping
+   must replace, i.e. '&', '<', '>' or '\r', or END if there is none. */
+static const char *
+find_cdata_special(const char *data, const char *end)
+{
+#if SVN_INTERNAL_HAVE_SSE2
+  /* Skip whole SSE registers without special chars at a time.  The
+   * byte loop below will then locate the exact position. */
+  const __m128i amp = _mm_set1_epi8('&');
+  const __m128i lt = _mm_set1_epi8('<');
+  const __m128i gt = _mm_set1_epi8('>');
+  const __m128i cr = _mm_set1_epi8('\r');
+
+  for (; (apr_size_t)(end - data) >= sizeof(__m128i);
+       data += sizeof(__m128i))
+    {
+      const __m128i chunk = _mm_loadu_si128((const __m128i *)data);
+      const __m128i hits
+        = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, amp),
+                                    _mm_cmpeq_epi8(chunk, lt)),
+                       _mm_or_si128(_mm_cmpeq_epi8(chunk, gt),
+                                    _mm_cmpeq_epi8(chunk, cr)));
+
+      if (_mm_movemask_epi8(hits))
+        break;
+    }
+#endif
+
+  while (data < end
+         && *data != '&' && *data != '<' && *data != '>' && *data != '\r')
+    data++;
+
+  return data;
+}
+
+/* Like find_cdata_special, but for the larger set of chars that
+   attribute escaping must replace. */
+static const char *
+find_attr_special(const char *data, const char *end)
+{
+#if SVN_INTERNAL_HAVE_SSE2
+  const __m128i amp = _mm_set1_epi8('&');
+  const __m128i lt = _mm_set1_epi8('<');
+  const __m128i gt = _mm_set1_epi8('>');
+  const __m128i quot = _mm_set1_epi8('"');
+  const __m128i apos = _mm_set1_epi8('\'');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i tab = _mm_set1_epi8('\t');
+
+  for (; (apr_size_t)(end - data) >= sizeof(__m128i);
+       data += sizeof(__m128i))
+    {
+      const __m128i chunk = _mm_loadu_si128((const __m128i *)data);
+      const __m128i hits
+        = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, amp),
+                                      _mm_cmpeq_epi8(chunk, lt)),
+                         _mm_or_si128(_mm_cmpeq_epi8(chunk, gt),
+                                      _mm_cmpeq_epi8(chunk, quot))),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, apos),
+                                      _mm_cmpeq_epi8(chunk, cr)),
+                         _mm_or_si128(_mm_cmpeq_epi8(chunk, lf),
+                                      _mm_cmpeq_epi8(chunk, tab))));
+
+      if (_mm_movemask_epi8(hits))
+        break;
+    }
+#endif
+
+  while (data < end
+         && *data != '&' && *data != '<' && *data != '>'
+         && *data != '"' && *data != '\'' && *data != '\r'
+         && *data != '\n' && *data != '\t')
+    data++;
+
+  return data;
+}
+
 /* ### ...?
  *
  * If *OUTSTR is @c NULL, set *OUTSTR to a new stringbuf allocated
@@ -161,9 +254,7 @@ xml_escape_cdata(svn_stringbuf_t **outstr,
          Also, any '\r' not followed by '\n' is converted to '\n'.  By
          golly, if we say we want to escape a '\r', we want to make
          sure it remains a '\r'!  */
-      q = p;
-      while (q < end && *q != '&' && *q != '<' && *q != '>' && *q != '\r')
-        q++;
+      q = find_cdata_special(p, end);
       svn_stringbuf_appendbytes(*outstr, p, q - p);
 
       /* We may already be a winner.  */
@@ -202,11 +293,7 @@ xml_escape_attr(svn_stringbuf_t **outstr,
     {
       /* Find a character which needs to be quoted and append bytes up
          to that point. */
-      q = p;
-      while (q < end && *q != '&' && *q != '<' && *q != '>'
-             && *q != '"' && *q != '\'' && *q != '\r'
-             && *q != '\n' && *q != '\t')
-        q++;
+      q = find_attr_special(p, end);
       svn_stringbuf_appendbytes(*outstr, p, q - p);
 
       /* We may already be a winner.  */
@@ -263,6 +350,23 @@ svn_xml_escape_cdata_cstring(svn_stringbuf_t **outstr,
 }
 
 
+void
+svn_xml__escape_cdata_verbatim(svn_stringbuf_t **outstr,
+                               const char *data,
+                               apr_size_t len,
+                               apr_pool_t *pool)
+{
+  if (*outstr == NULL)
+    *outstr = svn_stringbuf_create_ensure(len, pool);
+
+  /* The caller promised that DATA needs no escaping; make broken
+     promises visible in maintainer builds at least. */
+  assert(find_cdata_special(data, data + len) == data + len);
+
+  svn_stringbuf_appendbytes(*outstr, data, len);
+}
+
+
 void
 svn_xml_escape_attr_stringbuf(svn_stringbuf_t **outstr,
                               const svn_stringbuf_t *string,
@@ -39,6 +39,7 @@
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 
+#include "private/svn_delta_private.h"
 #include "private/svn_wc_private.h"
 
 #include "wc.h"
@@ -1026,6 +1027,7 @@ typedef struct open_txdelta_stream_baton_t
   svn_boolean_t need_reset;
   svn_stream_t *base_stream;
   svn_stream_t *local_stream;
+  svn_txdelta_stream_t *last_txdelta_stream;
 } open_txdelta_stream_baton_t;
 
 /* Implements svn_txdelta_stream_open_func_t */
@@ -1040,13 +1042,16 @@ open_txdelta_stream(svn_txdelta_stream_t **txdelta_stream_p,
   if (b->need_reset)
     {
       /* Under rare circumstances, we can be restarted and would need to
-       * supply the delta stream again.  In this case, reset both streams. */
+       * supply the delta stream again.  In this case, stop any background
+       * delta computation still going on and reset both streams. */
+      svn_txdelta__pipelined_close(b->last_txdelta_stream);
       SVN_ERR(svn_stream_reset(b->base_stream));
       SVN_ERR(svn_stream_reset(b->local_stream));
     }
 
-  svn_txdelta2(txdelta_stream_p, b->base_stream, b->local_stream,
-               FALSE, result_pool);
+  svn_txdelta__pipelined(txdelta_stream_p, b->base_stream, b->local_stream,
+                         FALSE, result_pool);
+  b->last_txdelta_stream = *txdelta_stream_p;
   b->need_reset = TRUE;
   return SVN_NO_ERROR;
 }
@@ -184,7 +184,7 @@ svn_wc_process_committed_queue2(svn_wc_committed_queue_t *queue,
 {
   apr_array_header_t *wcs;
   int i;
-  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_pool_t *iterpool = svn_pool__create_iterpool(scratch_pool);
   apr_time_t new_date;
 
   if (rev_date)
@@ -879,6 +879,133 @@ svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__pristines_missing(svn_boolean_t *missing,
+                          svn_wc_context_t *wc_ctx,
+                          const char *local_abspath,
+                          apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *missing_list;
+
+  SVN_ERR(svn_wc__db_pristine_get_missing(&missing_list, wc_ctx->db,
+                                          local_abspath,
+                                          scratch_pool, scratch_pool));
+  *missing = (missing_list->nelts > 0);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__pristines_hydrate(int *fetched_count,
+                          svn_wc_context_t *wc_ctx,
+                          const char *local_abspath,
+                          svn_wc__pristine_fetch_t fetch_func,
+                          void *fetch_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *missing;
+  apr_pool_t *iterpool;
+  int i;
+
+  if (fetched_count)
+    *fetched_count = 0;
+
+  SVN_ERR(svn_wc__db_pristine_get_missing(&missing, wc_ctx->db, local_abspath,
+                                          scratch_pool, scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < missing->nelts; i++)
+    {
+      const svn_wc__db_missing_pristine_t *item
+        = APR_ARRAY_IDX(missing, i, svn_wc__db_missing_pristine_t *);
+      svn_stream_t *stream;
+      svn_wc__db_install_data_t *install_data;
+      svn_checksum_t *sha1_checksum;
+      svn_checksum_t *md5_checksum;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(svn_wc__db_pristine_prepare_install(&stream, &install_data,
+                                                  &sha1_checksum,
+                                                  &md5_checksum,
+                                                  wc_ctx->db, local_abspath,
+                                                  iterpool, iterpool));
+
+      err = fetch_func(fetch_baton, stream, item->repos_relpath,
+                       item->revision, iterpool);
+      err = svn_error_compose_create(err, svn_stream_close(stream));
+
+      /* The text we fetched must be the text the BASE tree recorded;
+         anything else would corrupt the store. */
+      if (!err && !svn_checksum_match(sha1_checksum, item->sha1_checksum))
+        err = svn_error_createf(SVN_ERR_WC_CORRUPT_TEXT_BASE, NULL,
+                                _("Checksum mismatch while fetching pristine "
+                                  "text for '%s': expected '%s', got '%s'"),
+                                item->repos_relpath,
+                                svn_checksum_to_cstring_display(
+                                  item->sha1_checksum, iterpool),
+                                svn_checksum_to_cstring_display(
+                                  sha1_checksum, iterpool));
+
+      if (err)
+        return svn_error_trace(
+                 svn_error_compose_create(
+                   err,
+                   svn_wc__db_pristine_install_abort(install_data,
+                                                     iterpool)));
+
+      SVN_ERR(svn_wc__db_pristine_install(install_data, sha1_checksum,
+                                          md5_checksum, iterpool));
+      if (fetched_count)
+        (*fetched_count)++;
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__pristines_dehydrate(int *removed_count,
+                            svn_wc_context_t *wc_ctx,
+                            const char *local_abspath,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(
+           svn_wc__db_pristine_dehydrate(removed_count, wc_ctx->db,
+                                         local_abspath,
+                                         cancel_func, cancel_baton,
+                                         scratch_pool));
+}
+
+svn_error_t *
+svn_wc__pristines_stored(svn_boolean_t *stored,
+                         svn_wc_context_t *wc_ctx,
+                         const char *local_abspath,
+                         apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(
+           svn_wc__db_pristine_get_stored(stored, wc_ctx->db, local_abspath,
+                                          scratch_pool));
+}
+
+svn_error_t *
+svn_wc__pristines_mark_stored(svn_wc_context_t *wc_ctx,
+                              const char *local_abspath,
+                              apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(
+           svn_wc__db_pristine_mark_stored(wc_ctx->db, local_abspath,
+                                           scratch_pool));
+}
+
 
 
 svn_error_t *
@@ -40,6 +40,7 @@
 #include "conflicts.h"
 
 #include "svn_private_config.h"
+#include "private/svn_io_private.h"
 #include "private/svn_wc_private.h"
 
 /* #define RECORD_MIXED_MOVE */
@@ -177,9 +178,22 @@ copy_to_tmpdir(svn_skel_t **work_item,
         SVN_ERR(svn_io_dir_make(dst_tmp_abspath, APR_OS_DEFAULT, scratch_pool));
     }
   else if (!is_special)
-    SVN_ERR(svn_io_copy_file(src_abspath, dst_tmp_abspath,
-                             TRUE /* copy_perms */,
-                             scratch_pool));
+    {
+      svn_boolean_t cloned;
+
+      /* Sharing the source's data blocks is much cheaper than copying
+         them.  Filesystems without reflink support decline without
+         touching any data, and we copy the old way. */
+      SVN_ERR(svn_io__clone_file(&cloned, dst_tmp_abspath, src_abspath,
+                                 tmpdir_abspath, scratch_pool));
+      if (cloned)
+        SVN_ERR(svn_io_copy_perms(src_abspath, dst_tmp_abspath,
+                                  scratch_pool));
+      else
+        SVN_ERR(svn_io_copy_file(src_abspath, dst_tmp_abspath,
+                                 TRUE /* copy_perms */,
+                                 scratch_pool));
+    }
   else
     SVN_ERR(svn_io_copy_link(src_abspath, dst_tmp_abspath, scratch_pool));
 
@@ -3625,6 +3625,7 @@ svn_wc_get_update_editor4(const svn_delta_editor_t **editor,
                               adds_as_modification,
                               server_performs_filtering,
                               clean_checkout,
+                              TRUE /* verify_base_checksums */,
                               diff3_cmd,
                               preserved_exts,
                               fetch_dirents_func, fetch_dirents_baton,
@@ -3809,6 +3810,7 @@ svn_wc_get_switch_editor4(const svn_delta_editor_t **editor,
                               depth, depth_is_sticky,
                               allow_unver_obstructions,
                               server_performs_filtering,
+                              TRUE /* verify_base_checksums */,
                               diff3_cmd,
                               preserved_exts,
                               fetch_dirents_func, fetch_dirents_baton,
@@ -45,6 +45,8 @@
 #include "wc_db.h"
 
 #include "svn_private_config.h"
+#include "private/svn_error_private.h"
+#include "private/svn_io_private.h"
 #include "private/svn_wc_private.h"
 
 
@@ -151,6 +153,12 @@ compare_and_verify(svn_boolean_t *modified_p,
 
   /* ### Other checks possible? */
 
+  /* We are going to read both files in full.  Prefetch the pristine
+     contents on a worker thread so that its disk I/O overlaps with
+     reading and detranslating the working file on this thread. */
+  pristine_stream = svn_stream__pipelined_read(pristine_stream,
+                                               scratch_pool);
+
   /* Reading files is necessary. */
   if (special && need_translation)
     {
@@ -245,6 +253,28 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
       return SVN_NO_ERROR;
     }
 
+  if (! exact_comparison
+      && recorded_size != SVN_INVALID_FILESIZE
+      && recorded_mod_time != 0)
+    {
+      svn_boolean_t journal_active;
+      svn_boolean_t journal_dirty;
+
+      /* If an external file system watcher maintains a change journal
+         for this working copy, trust the recorded size and timestamp of
+         any file the kernel never reported as touched, without even
+         statting it. */
+      SVN_ERR(svn_wc__db_change_journal_query(&journal_active,
+                                              &journal_dirty,
+                                              db, local_abspath,
+                                              scratch_pool));
+      if (journal_active && !journal_dirty)
+        {
+          *modified_p = FALSE;
+          return SVN_NO_ERROR;
+        }
+    }
+
   SVN_ERR(svn_io_stat_dirent2(&dirent, local_abspath, FALSE, TRUE,
                               scratch_pool, scratch_pool));
 
@@ -332,10 +362,17 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
       SVN_ERR(svn_wc__db_wclock_owns_lock(&own_lock, db, local_abspath, FALSE,
                                           scratch_pool));
       if (own_lock)
-        SVN_ERR(svn_wc__db_global_record_fileinfo(db, local_abspath,
-                                                  dirent->filesize,
-                                                  dirent->mtime,
+        {
+          SVN_ERR(svn_wc__db_global_record_fileinfo(db, local_abspath,
+                                                    dirent->filesize,
+                                                    dirent->mtime,
+                                                    scratch_pool));
+
+          /* The contents were just verified against the pristine, so
+             any change journal entry for this file is now stale. */
+          SVN_ERR(svn_wc__db_change_journal_clear(db, local_abspath,
                                                   scratch_pool));
+        }
     }
 
   return SVN_NO_ERROR;
@@ -630,7 +667,7 @@ modcheck_callback(void *baton,
             mb->found_mod = TRUE;
             mb->found_not_delete = TRUE;
             /* Incomplete, but local modifications */
-            return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+            return svn_error__sentinel(SVN_ERR_CEASE_INVOCATION);
           }
         break;
 
@@ -642,7 +679,7 @@ modcheck_callback(void *baton,
           {
             /* The delete is obstructed by something unversioned */
             mb->found_not_delete = TRUE;
-            return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+            return svn_error__sentinel(SVN_ERR_CEASE_INVOCATION);
           }
         break;
 
@@ -655,7 +692,7 @@ modcheck_callback(void *baton,
         mb->found_mod = TRUE;
         mb->found_not_delete = TRUE;
         /* Exit from the status walker: We know what we want to know */
-        return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+        return svn_error__sentinel(SVN_ERR_CEASE_INVOCATION);
 
       default:
       case svn_wc_status_added:
@@ -664,7 +701,7 @@ modcheck_callback(void *baton,
         mb->found_mod = TRUE;
         mb->found_not_delete = TRUE;
         /* Exit from the status walker: We know what we want to know */
-        return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+        return svn_error__sentinel(SVN_ERR_CEASE_INVOCATION);
     }
 
   return SVN_NO_ERROR;
@@ -29,6 +29,11 @@
 #include <apr_pools.h>
 #include <apr_file_io.h>
 #include <apr_hash.h>
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
+#endif
 
 #include "svn_pools.h"
 #include "svn_types.h"
@@ -48,6 +53,7 @@
 #include "props.h"
 
 #include "private/svn_sorts_private.h"
+#include "private/svn_subr_private.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_editor.h"
@@ -100,8 +106,308 @@ struct walk_status_baton
 
   /* Repository locks, if set. */
   apr_hash_t *repos_locks;
+
+  /* Background readers for directory listings, or NULL if the walk
+     shall read them itself. */
+  struct dirent_prefetcher_t *prefetcher;
+};
+
+/*** Directory entry prefetching ***/
+
+/* An 'svn status' walk over a large working copy alternates wc_db reads
+ * with on-disk directory scans.  The prefetcher below moves the latter to
+ * a small pool of background threads:  while the walker processes one
+ * directory, the listings of the directories it will descend into are
+ * already being read.  The walker itself - and with it all wc_db access
+ * and the order in which statuses reach the callback - stays strictly
+ * single-threaded.
+ */
+#if APR_HAS_THREADS
+
+/* Number of background threads reading directory entries. */
+#define PREFETCH_THREAD_COUNT 4
+
+/* Maximum number of directory listings held in memory while waiting for
+   the walker to consume them. */
+#define PREFETCH_MAX_PENDING 256
+
+/* Life cycle of a prefetch_entry_t. */
+typedef enum prefetch_state_t
+{
+  prefetch_queued,   /* waiting for a worker */
+  prefetch_running,  /* a worker is reading the listing right now */
+  prefetch_stolen,   /* the walker got here first; nothing to do */
+  prefetch_done      /* DIRENTS and ERR are valid */
+} prefetch_state_t;
+
+/* A directory queued for background listing. */
+typedef struct prefetch_entry_t
+{
+  /* The directory to list. */
+  const char *abspath;
+
+  prefetch_state_t state;
+
+  /* Position of this entry in dirent_prefetcher_t->queue. */
+  int queue_index;
+
+  /* Private pool holding ABSPATH, DIRENTS and ERR.  While the entry is
+     being processed, the worker allocates from this pool only. */
+  apr_pool_t *pool;
+
+  /* Result of the background svn_io_get_dirents3() call; valid once
+     STATE is prefetch_done. */
+  apr_hash_t *dirents;
+  svn_error_t *err;
+} prefetch_entry_t;
+
+struct dirent_prefetcher_t
+{
+  /* Thread-safe root pool holding all shared state. */
+  apr_pool_t *pool;
+
+  /* Cf. walk_status_baton->ignore_text_mods. */
+  svn_boolean_t only_check_type;
+
+  /* MUTEX guards all queue state below; COND signals any change to it. */
+  apr_thread_mutex_t *mutex;
+  apr_thread_cond_t *cond;
+
+  /* Queue of prefetch_entry_t *.  NEXT indexes the first entry no worker
+     has picked up yet; consumed entries at lower indexes are NULLed out. */
+  apr_array_header_t *queue;
+  int next;
+
+  /* Number of entries scheduled but not yet consumed by the walker. */
+  int pending;
+
+  /* abspath -> prefetch_entry_t * of all unconsumed entries. */
+  apr_hash_t *entries;
+
+  /* Tell the workers to terminate. */
+  svn_boolean_t quit;
+
+  apr_thread_t *threads[PREFETCH_THREAD_COUNT];
+  int thread_count;
 };
 
+/* Thread function: take directories off the queue of the
+   dirent_prefetcher_t given as DATA and read their listings. */
+static void * APR_THREAD_FUNC
+prefetch_worker(apr_thread_t *thread, void *data)
+{
+  struct dirent_prefetcher_t *pf = data;
+
+  apr_thread_mutex_lock(pf->mutex);
+  while (!pf->quit)
+    {
+      prefetch_entry_t *entry = NULL;
+
+      /* Find the first entry that still needs processing. */
+      while (pf->next < pf->queue->nelts && !entry)
+        {
+          entry = APR_ARRAY_IDX(pf->queue, pf->next, prefetch_entry_t *);
+          pf->next++;
+          if (entry && entry->state != prefetch_queued)
+            entry = NULL;
+        }
+
+      if (!entry)
+        {
+          apr_thread_cond_wait(pf->cond, pf->mutex);
+          continue;
+        }
+
+      entry->state = prefetch_running;
+      apr_thread_mutex_unlock(pf->mutex);
+
+      entry->err = svn_io_get_dirents3(&entry->dirents, entry->abspath,
+                                       pf->only_check_type,
+                                       entry->pool, entry->pool);
+
+      apr_thread_mutex_lock(pf->mutex);
+      entry->state = prefetch_done;
+      apr_thread_cond_broadcast(pf->cond);
+    }
+  apr_thread_mutex_unlock(pf->mutex);
+
+  return NULL;
+}
+
+/* Schedule a background listing of LOCAL_ABSPATH with PF.  Silently do
+   nothing if the directory is already scheduled or too many listings are
+   waiting to be consumed.  To be called from the walker thread only. */
+static void
+prefetch_schedule(struct dirent_prefetcher_t *pf, const char *local_abspath)
+{
+  apr_thread_mutex_lock(pf->mutex);
+  if (pf->pending < PREFETCH_MAX_PENDING
+      && !svn_hash_gets(pf->entries, local_abspath))
+    {
+      apr_pool_t *entry_pool = svn_pool_create(pf->pool);
+      prefetch_entry_t *entry = apr_pcalloc(entry_pool, sizeof(*entry));
+
+      entry->abspath = apr_pstrdup(entry_pool, local_abspath);
+      entry->state = prefetch_queued;
+      entry->queue_index = pf->queue->nelts;
+      entry->pool = entry_pool;
+
+      APR_ARRAY_PUSH(pf->queue, prefetch_entry_t *) = entry;
+      svn_hash_sets(pf->entries, entry->abspath, entry);
+      pf->pending++;
+
+      apr_thread_cond_broadcast(pf->cond);
+    }
+  apr_thread_mutex_unlock(pf->mutex);
+}
+
+/* If a listing of LOCAL_ABSPATH has been scheduled with PF, wait for it,
+ * return a deep copy of it in *DIRENTS (resp. the listing error in *ERR),
+ * allocated in RESULT_POOL, and return TRUE.  Return FALSE if the walker
+ * shall read the listing itself.  To be called from the walker thread
+ * only.
+ */
+static svn_boolean_t
+prefetch_take(apr_hash_t **dirents,
+              svn_error_t **err,
+              struct dirent_prefetcher_t *pf,
+              const char *local_abspath,
+              apr_pool_t *result_pool)
+{
+  prefetch_entry_t *entry;
+  svn_boolean_t hit = FALSE;
+
+  apr_thread_mutex_lock(pf->mutex);
+  entry = svn_hash_gets(pf->entries, local_abspath);
+  if (entry && entry->state == prefetch_queued)
+    {
+      /* No worker got around to this one yet; reading the listing
+         ourselves beats waiting for one. */
+      entry->state = prefetch_stolen;
+      APR_ARRAY_IDX(pf->queue, entry->queue_index, prefetch_entry_t *)
+        = NULL;
+    }
+  else if (entry)
+    {
+      while (entry->state != prefetch_done)
+        apr_thread_cond_wait(pf->cond, pf->mutex);
+
+      *err = entry->err;
+      if (entry->err)
+        *dirents = NULL;
+      else
+        {
+          /* Deep-copy the listing; the entry pool is about to die. */
+          apr_hash_index_t *hi;
+
+          *dirents = apr_hash_make(result_pool);
+          for (hi = apr_hash_first(result_pool, entry->dirents);
+               hi;
+               hi = apr_hash_next(hi))
+            {
+              const char *name = apr_hash_this_key(hi);
+              svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+
+              svn_hash_sets(*dirents, apr_pstrdup(result_pool, name),
+                            svn_io_dirent2_dup(dirent, result_pool));
+            }
+        }
+
+      hit = TRUE;
+    }
+
+  if (entry)
+    {
+      /* Done with this entry; release it.  The workers are past it or
+         never saw it, so nobody else references it anymore. */
+      svn_hash_sets(pf->entries, entry->abspath, NULL);
+      pf->pending--;
+      svn_pool_destroy(entry->pool);
+
+      /* Reset the queue if it ran empty, so it won't grow forever. */
+      if (pf->pending == 0 && pf->next >= pf->queue->nelts)
+        {
+          pf->queue->nelts = 0;
+          pf->next = 0;
+        }
+    }
+  apr_thread_mutex_unlock(pf->mutex);
+
+  return hit;
+}
+
+/* Construct a prefetcher for listings read with ONLY_CHECK_TYPE.
+   Return NULL if background threads are not available. */
+static struct dirent_prefetcher_t *
+prefetcher_create(svn_boolean_t only_check_type)
+{
+  apr_pool_t *pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  struct dirent_prefetcher_t *pf = apr_pcalloc(pool, sizeof(*pf));
+  apr_threadattr_t *tattr;
+  apr_status_t status;
+  int i;
+
+  pf->pool = pool;
+  pf->only_check_type = only_check_type;
+  pf->queue = apr_array_make(pool, 256, sizeof(prefetch_entry_t *));
+  pf->entries = apr_hash_make(pool);
+
+  status = apr_thread_mutex_create(&pf->mutex, APR_THREAD_MUTEX_DEFAULT,
+                                   pool);
+  if (!status)
+    status = apr_thread_cond_create(&pf->cond, pool);
+  if (!status)
+    status = apr_threadattr_create(&tattr, pool);
+  if (status)
+    {
+      svn_pool_destroy(pool);
+      return NULL;
+    }
+
+  for (i = 0; i < PREFETCH_THREAD_COUNT; i++)
+    if (apr_thread_create(&pf->threads[i], tattr, prefetch_worker, pf, pool))
+      break;
+  pf->thread_count = i;
+
+  if (i == 0)
+    {
+      svn_pool_destroy(pool);
+      return NULL;
+    }
+
+  return pf;
+}
+
+/* Stop PF's worker threads and release everything it holds, including
+   the errors of any listings that were never consumed. */
+static void
+prefetcher_destroy(struct dirent_prefetcher_t *pf)
+{
+  apr_hash_index_t *hi;
+  apr_status_t ignored;
+  int i;
+
+  apr_thread_mutex_lock(pf->mutex);
+  pf->quit = TRUE;
+  apr_thread_cond_broadcast(pf->cond);
+  apr_thread_mutex_unlock(pf->mutex);
+
+  for (i = 0; i < pf->thread_count; i++)
+    apr_thread_join(&ignored, pf->threads[i]);
+
+  for (hi = apr_hash_first(pf->pool, pf->entries);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      prefetch_entry_t *entry = apr_hash_this_val(hi);
+      svn_error_clear(entry->err);
+    }
+
+  svn_pool_destroy(pf->pool);
+}
+
+#endif /* APR_HAS_THREADS */
+
 /*** Editor batons ***/
 
 struct edit_baton
@@ -1243,13 +1549,24 @@ get_dir_status(const struct walk_status_baton *wb,
   if (depth == svn_depth_unknown)
     depth = svn_depth_infinity;
 
-  iterpool = svn_pool_create(scratch_pool);
+  iterpool = svn_pool__create_iterpool(scratch_pool);
 
   if (wb->check_working_copy)
     {
-      err = svn_io_get_dirents3(&dirents, local_abspath,
-                                wb->ignore_text_mods /* only_check_type*/,
-                                scratch_pool, iterpool);
+      err = SVN_NO_ERROR;
+      dirents = NULL;
+
+#if APR_HAS_THREADS
+      /* A background thread may already have read this listing. */
+      if (wb->prefetcher)
+        prefetch_take(&dirents, &err, wb->prefetcher, local_abspath,
+                      scratch_pool);
+#endif
+
+      if (!dirents && !err)
+        err = svn_io_get_dirents3(&dirents, local_abspath,
+                                  wb->ignore_text_mods /* only_check_type*/,
+                                  scratch_pool, iterpool);
       if (err
           && (APR_STATUS_IS_ENOENT(err->apr_err)
               || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
@@ -1340,6 +1657,28 @@ get_dir_status(const struct walk_status_baton *wb,
   sorted_children = svn_sort__hash(all_children,
                                    svn_sort_compare_items_lexically,
                                    scratch_pool);
+
+#if APR_HAS_THREADS
+  /* Hand the directories we are about to descend into to the background
+     readers before processing any children ourselves. */
+  if (wb->prefetcher && depth == svn_depth_infinity)
+    for (i = 0; i < sorted_children->nelts; i++)
+      {
+        svn_sort__item_t item
+          = APR_ARRAY_IDX(sorted_children, i, svn_sort__item_t);
+        const struct svn_wc__db_info_t *child_info
+          = apr_hash_get(nodes, item.key, item.klen);
+
+        if (child_info && child_info->has_descendants)
+          {
+            svn_pool_clear(iterpool);
+            prefetch_schedule(wb->prefetcher,
+                              svn_dirent_join(local_abspath, item.key,
+                                              iterpool));
+          }
+      }
+#endif
+
   for (i = 0; i < sorted_children->nelts; i++)
     {
       const void *key;
@@ -2513,6 +2852,7 @@ svn_wc__get_status_editor(const svn_delta_editor_t **editor,
   eb->wb.check_working_copy = check_working_copy;
   eb->wb.repos_locks      = NULL;
   eb->wb.repos_root       = NULL;
+  eb->wb.prefetcher       = NULL;
 
   SVN_ERR(svn_wc__db_externals_defined_below(&eb->wb.externals,
                                              wc_ctx->db, eb->target_abspath,
@@ -2644,6 +2984,7 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
   wb.check_working_copy = TRUE;
   wb.repos_root = NULL;
   wb.repos_locks = NULL;
+  wb.prefetcher = NULL;
 
   /* Use the caller-provided ignore patterns if provided; the build-time
      configured defaults otherwise. */
@@ -2690,19 +3031,33 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
       && info->status != svn_wc__db_status_excluded
       && info->status != svn_wc__db_status_server_excluded)
     {
-      SVN_ERR(get_dir_status(&wb,
-                             local_abspath,
-                             FALSE /* skip_root */,
-                             NULL, NULL, NULL,
-                             info,
-                             dirent,
-                             ignore_patterns,
-                             depth,
-                             get_all,
-                             no_ignore,
-                             status_func, status_baton,
-                             cancel_func, cancel_baton,
-                             scratch_pool));
+#if APR_HAS_THREADS
+      /* For full-depth walks, read directory listings on background
+         threads while this thread crawls the tree and queries wc_db. */
+      if (depth == svn_depth_infinity || depth == svn_depth_unknown)
+        wb.prefetcher = prefetcher_create(ignore_text_mods);
+#endif
+
+      err = get_dir_status(&wb,
+                           local_abspath,
+                           FALSE /* skip_root */,
+                           NULL, NULL, NULL,
+                           info,
+                           dirent,
+                           ignore_patterns,
+                           depth,
+                           get_all,
+                           no_ignore,
+                           status_func, status_baton,
+                           cancel_func, cancel_baton,
+                           scratch_pool);
+
+#if APR_HAS_THREADS
+      if (wb.prefetcher)
+        prefetcher_destroy(wb.prefetcher);
+#endif
+
+      SVN_ERR(err);
     }
   else
     {
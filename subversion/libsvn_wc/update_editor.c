@@ -209,6 +209,12 @@ struct edit_baton
      of conflict checks to be omitted. */
   svn_boolean_t clean_checkout;
 
+  /* If not set, skip re-reading and re-checksumming the stored pristine
+     base before applying an incoming delta to it.  The base contents were
+     verified when they were stored; re-verification only guards against
+     later local corruption. */
+  svn_boolean_t verify_base_checksums;
+
   /* If this is a 'switch' operation, the new relpath of target_abspath,
      else NULL. */
   const char *switch_repos_relpath;
@@ -3699,8 +3705,11 @@ apply_textdelta(void *file_baton,
   if (!recorded_base_checksum)
     recorded_base_checksum = expected_base_checksum;
 
-  /* Checksum the text base while applying deltas */
-  if (recorded_base_checksum)
+  /* Checksum the text base while applying deltas, unless the caller
+     told us to trust the stored pristine contents.  The recorded and
+     expected checksums have already been compared above, so all that a
+     re-computation can add is a defense against local corruption. */
+  if (recorded_base_checksum && eb->verify_base_checksums)
     {
       hb->expected_source_checksum = svn_checksum_dup(recorded_base_checksum,
                                                       handler_pool);
@@ -4883,6 +4892,7 @@ make_editor(svn_revnum_t *target_revision,
             svn_boolean_t adds_as_modification,
             svn_boolean_t server_performs_filtering,
             svn_boolean_t clean_checkout,
+            svn_boolean_t verify_base_checksums,
             svn_wc_notify_func2_t notify_func,
             void *notify_baton,
             svn_cancel_func_t cancel_func,
@@ -4966,13 +4976,16 @@ make_editor(svn_revnum_t *target_revision,
   eb->external_func            = external_func;
   eb->external_baton           = external_baton;
   eb->diff3_cmd                = diff3_cmd;
-  eb->cancel_func              = cancel_func;
-  eb->cancel_baton             = cancel_baton;
+  /* This editor polls cancellation from several per-node code paths;
+     throttle the calls that actually reach the client's callback. */
+  svn_cancel__create_throttled(&eb->cancel_func, &eb->cancel_baton,
+                               cancel_func, cancel_baton, edit_pool);
   eb->conflict_func            = conflict_func;
   eb->conflict_baton           = conflict_baton;
   eb->allow_unver_obstructions = allow_unver_obstructions;
   eb->adds_as_modification     = adds_as_modification;
   eb->clean_checkout           = clean_checkout;
+  eb->verify_base_checksums    = verify_base_checksums;
   eb->skipped_trees            = apr_hash_make(edit_pool);
   eb->dir_dirents              = apr_hash_make(edit_pool);
   eb->ext_patterns             = preserved_exts;
@@ -5171,6 +5184,7 @@ svn_wc__get_update_editor(const svn_delta_editor_t **editor,
                           svn_boolean_t adds_as_modification,
                           svn_boolean_t server_performs_filtering,
                           svn_boolean_t clean_checkout,
+                          svn_boolean_t verify_base_checksums,
                           const char *diff3_cmd,
                           const apr_array_header_t *preserved_exts,
                           svn_wc_dirents_func_t fetch_dirents_func,
@@ -5190,7 +5204,7 @@ svn_wc__get_update_editor(const svn_delta_editor_t **editor,
                      target_basename, wcroot_iprops, use_commit_times,
                      NULL, depth, depth_is_sticky, allow_unver_obstructions,
                      adds_as_modification, server_performs_filtering,
-                     clean_checkout,
+                     clean_checkout, verify_base_checksums,
                      notify_func, notify_baton,
                      cancel_func, cancel_baton,
                      fetch_dirents_func, fetch_dirents_baton,
@@ -5214,6 +5228,7 @@ svn_wc__get_switch_editor(const svn_delta_editor_t **editor,
                           svn_boolean_t depth_is_sticky,
                           svn_boolean_t allow_unver_obstructions,
                           svn_boolean_t server_performs_filtering,
+                          svn_boolean_t verify_base_checksums,
                           const char *diff3_cmd,
                           const apr_array_header_t *preserved_exts,
                           svn_wc_dirents_func_t fetch_dirents_func,
@@ -5238,6 +5253,7 @@ svn_wc__get_switch_editor(const svn_delta_editor_t **editor,
                      FALSE /* adds_as_modification */,
                      server_performs_filtering,
                      FALSE /* clean_checkout */,
+                     verify_base_checksums,
                      notify_func, notify_baton,
                      cancel_func, cancel_baton,
                      fetch_dirents_func, fetch_dirents_baton,
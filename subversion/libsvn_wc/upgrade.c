@@ -1699,6 +1699,16 @@ svn_wc__upgrade_sdb(int *result_format,
         /* already upgraded */
         *result_format = SVN_WC__VERSION;
 
+        SVN_SQLITE__WITH_LOCK(
+            svn_wc__db_install_schema_statistics(sdb, scratch_pool),
+            sdb);
+        break;
+
+      case SVN_WC__HAS_SETTINGS:
+        /* Format 32 only marks a working copy whose pristine store has
+           been dehydrated; there is nothing to upgrade. */
+        *result_format = SVN_WC__HAS_SETTINGS;
+
         SVN_SQLITE__WITH_LOCK(
             svn_wc__db_install_schema_statistics(sdb, scratch_pool),
             sdb);
@@ -1933,7 +1943,8 @@ svn_wc_upgrade(svn_wc_context_t *wc_ctx,
       /* Auto-upgrade worked! */
       SVN_ERR(svn_wc__db_close(db));
 
-      SVN_ERR_ASSERT(result_format == SVN_WC__VERSION);
+      SVN_ERR_ASSERT(result_format == SVN_WC__VERSION
+                     || result_format == SVN_WC__HAS_SETTINGS);
 
       if (bumped_format && notify_func)
         {
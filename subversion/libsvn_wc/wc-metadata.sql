@@ -562,6 +562,21 @@ CREATE UNIQUE INDEX I_EXTERNALS_DEFINED ON EXTERNALS (wc_id,
                                                       def_local_relpath,
                                                       local_relpath);
 
+/* This table holds the per-working-copy settings that cannot be derived
+   from the nodes themselves.  Upgraded working copies only receive it when
+   they are bumped to format 32 (SVN_WC__HAS_SETTINGS); a missing table or
+   row means that every setting has its default value. */
+CREATE TABLE SETTINGS (
+  wc_id  INTEGER NOT NULL REFERENCES WCROOT (id),
+
+  /* Is every pristine text referenced by the NODES table expected to be
+     present on disk?  Set to 0 when the store is dehydrated
+     ('store-pristines = no') and back to 1 once it has been rehydrated. */
+  store_pristine  INTEGER NOT NULL,
+
+  PRIMARY KEY (wc_id)
+  );
+
 
 PRAGMA user_version =
 -- define: SVN_WC__VERSION
@@ -699,9 +714,21 @@ WHERE l.op_depth = 0
 
 
 /* ------------------------------------------------------------------------- */
-/* Format 32 ....  */
-/* -- STMT_UPGRADE_TO_32
-PRAGMA user_version = 32; */
+
+/* Format 32 adds the SETTINGS table.  A working copy is only bumped to this
+   format when pristine texts are first removed from its store
+   ('store-pristines = no'), so that older clients reject the working copy
+   instead of mistaking the missing files for corruption.  The C code
+   inserts the store_pristine row as part of the same transaction. */
+-- STMT_UPGRADE_TO_32
+CREATE TABLE IF NOT EXISTS SETTINGS (
+  wc_id  INTEGER NOT NULL REFERENCES WCROOT (id),
+  store_pristine  INTEGER NOT NULL,
+
+  PRIMARY KEY (wc_id)
+  );
+
+PRAGMA user_version = 32;
 
 
 /* ------------------------------------------------------------------------- */
@@ -780,5 +807,10 @@ DROP TABLE ACTUAL_NODE_BACKUP;
  * functionally equivalent) statement using a 'JOIN'.  WCs that were created
  * at or upgraded to format 26 before it was changed will still have the old
  * version.
+ *
+ * While format 31 was current, the SETTINGS table was added to the schema
+ * of freshly created working copies.  The format was not bumped because an
+ * empty table is equivalent to an absent one; working copies upgraded to
+ * format 31 only receive the table when they are bumped to format 32.
  */
 
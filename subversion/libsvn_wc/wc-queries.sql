@@ -196,6 +196,24 @@ INSERT OR REPLACE INTO nodes (
 VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14,
         ?15, ?16, ?17, ?18, ?19, ?20, ?21, ?22, ?23)
 
+/* Multi-row variant of STMT_INSERT_NODE for the incomplete child stubs
+   written while a directory is being checked out or updated.  All 8 rows
+   share wc_id ?1, op_depth ?2, parent_relpath ?3, repos_id ?4 and
+   revision ?5; each row binds its own local_relpath, repos_path and
+   moved_to. */
+-- STMT_INSERT_NODE_INCOMPLETE_8
+INSERT OR REPLACE INTO nodes (
+  wc_id, local_relpath, op_depth, parent_relpath, repos_id, repos_path,
+  revision, presence, kind, moved_to)
+VALUES (?1, ?6,  ?2, ?3, ?4, ?7,  ?5, MAP_INCOMPLETE, MAP_UNKNOWN, ?8),
+       (?1, ?9,  ?2, ?3, ?4, ?10, ?5, MAP_INCOMPLETE, MAP_UNKNOWN, ?11),
+       (?1, ?12, ?2, ?3, ?4, ?13, ?5, MAP_INCOMPLETE, MAP_UNKNOWN, ?14),
+       (?1, ?15, ?2, ?3, ?4, ?16, ?5, MAP_INCOMPLETE, MAP_UNKNOWN, ?17),
+       (?1, ?18, ?2, ?3, ?4, ?19, ?5, MAP_INCOMPLETE, MAP_UNKNOWN, ?20),
+       (?1, ?21, ?2, ?3, ?4, ?22, ?5, MAP_INCOMPLETE, MAP_UNKNOWN, ?23),
+       (?1, ?24, ?2, ?3, ?4, ?25, ?5, MAP_INCOMPLETE, MAP_UNKNOWN, ?26),
+       (?1, ?27, ?2, ?3, ?4, ?28, ?5, MAP_INCOMPLETE, MAP_UNKNOWN, ?29)
+
 -- STMT_SELECT_WORKING_PRESENT
 SELECT local_relpath, kind, checksum, translated_size, last_mod_time
 FROM nodes n
@@ -883,6 +901,12 @@ SELECT id, work FROM work_queue ORDER BY id LIMIT 1
 -- STMT_DELETE_WORK_ITEM
 DELETE FROM work_queue WHERE id = ?1
 
+-- STMT_SELECT_WORK_ITEMS
+SELECT id, work FROM work_queue ORDER BY id LIMIT 32
+
+-- STMT_DELETE_WORK_ITEMS_UP_TO
+DELETE FROM work_queue WHERE id <= ?1
+
 -- STMT_INSERT_OR_IGNORE_PRISTINE
 INSERT OR IGNORE INTO pristine (checksum, md5_checksum, size, refcount)
 VALUES (?1, ?2, ?3, 0)
@@ -934,6 +958,26 @@ WHERE wc_id = ?1
       (SELECT MAX(op_depth) FROM nodes WHERE wc_id = ?1 AND local_relpath = ?2)
   AND n.checksum IS NOT NULL
 
+-- STMT_SELECT_BASE_FILE_PRISTINES
+SELECT local_relpath, checksum, repos_path, revision,
+       translated_size, last_mod_time
+FROM nodes
+WHERE wc_id = ?1 AND op_depth = 0 AND checksum IS NOT NULL
+
+-- STMT_SELECT_WORKING_PRISTINE_REFS
+SELECT DISTINCT checksum
+FROM nodes
+WHERE wc_id = ?1 AND op_depth > 0 AND checksum IS NOT NULL
+
+-- STMT_SELECT_PRISTINE_STORED
+SELECT store_pristine
+FROM settings
+WHERE wc_id = ?1
+
+-- STMT_UPSERT_PRISTINE_STORED
+INSERT OR REPLACE INTO settings (wc_id, store_pristine)
+VALUES (?1, ?2)
+
 -- STMT_VACUUM
 VACUUM
 
@@ -1302,6 +1346,14 @@ PRAGMA locking_mode = exclusive;
    exclusive-locking is mostly used on remote file systems. */
 PRAGMA journal_mode = DELETE
 
+-- STMT_PRAGMA_WAL_MODE
+/* Write-ahead logging lets readers work while another client commits,
+   and with synchronous=NORMAL only WAL checkpoints flush to disk.
+   A negative cache_size is in kibibytes, i.e. a 16 MB page cache. */
+PRAGMA journal_mode = WAL;
+PRAGMA synchronous = NORMAL;
+PRAGMA cache_size = -16384
+
 -- STMT_FIND_REPOS_PATH_IN_WC
 SELECT local_relpath FROM nodes_current
   WHERE wc_id = ?1 AND repos_path = ?2
@@ -1794,6 +1846,35 @@ WHERE wc_id = ?1
 
 -- STMT_HAVE_STAT1_TABLE
 SELECT 1 FROM sqlite_master WHERE name='sqlite_stat1' AND type='table'
+
+/* An advisory dirty set maintained by an external file system watcher.
+   See the change journal section in wc_db.h.  Created on demand rather
+   than as part of the schema, so no format bump is needed and working
+   copies without a watcher don't carry an empty table. */
+-- STMT_HAVE_CHANGE_JOURNAL_TABLE
+SELECT 1 FROM sqlite_master WHERE name='CHANGE_JOURNAL' AND type='table'
+
+-- STMT_CREATE_CHANGE_JOURNAL
+CREATE TABLE IF NOT EXISTS CHANGE_JOURNAL (
+  wc_id  INTEGER NOT NULL,
+  local_relpath  TEXT NOT NULL,
+  PRIMARY KEY (wc_id, local_relpath)
+  )
+
+-- STMT_DROP_CHANGE_JOURNAL
+DROP TABLE IF EXISTS CHANGE_JOURNAL
+
+-- STMT_INSERT_CHANGE_JOURNAL
+INSERT OR IGNORE INTO change_journal (wc_id, local_relpath)
+VALUES (?1, ?2)
+
+-- STMT_SELECT_CHANGE_JOURNAL
+SELECT 1 FROM change_journal
+WHERE wc_id = ?1 AND local_relpath = ?2
+
+-- STMT_DELETE_CHANGE_JOURNAL
+DELETE FROM change_journal
+WHERE wc_id = ?1 AND local_relpath = ?2
 LIMIT 1
 
 -- STMT_SELECT_COPIES_OF_REPOS_RELPATH
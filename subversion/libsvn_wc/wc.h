@@ -161,11 +161,23 @@ extern "C" {
  * == 1.9.x shipped with format 31
  * == 1.10.x shipped with format 31
  *
+ * The bump to 32 added the SETTINGS table, which records per working copy
+ * whether the pristine store is hydrated.  A working copy is only moved to
+ * format 32 when pristine texts are first removed from it
+ * ('store-pristines = no'), so that clients unaware of dehydrated stores
+ * reject it instead of mistaking the missing files for corruption.
+ *
  * Please document any further format changes here.
  */
 
 #define SVN_WC__VERSION 31
 
+/* A version >= this has the SETTINGS table; see the format 32 notes above.
+   This is the highest format this client can read and write.  New working
+   copies are still created at SVN_WC__VERSION; the bump only happens on
+   demand, when the pristine store is first dehydrated.  */
+#define SVN_WC__HAS_SETTINGS 32
+
 
 /* Formats <= this have no concept of "revert text-base/props".  */
 #define SVN_WC__NO_REVERT_FILES 4
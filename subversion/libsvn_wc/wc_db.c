@@ -106,6 +106,10 @@
 #define UNKNOWN_WC_ID ((apr_int64_t) -1)
 #define FORMAT_FROM_SDB (-1)
 
+/* Number of rows inserted per execution of STMT_INSERT_NODE_INCOMPLETE_8.
+   Must match the number of VALUES tuples in that statement. */
+#define INSERT_NODE_INCOMPLETE_ROWS 8
+
 /* Check if column number I, a property-skel column, contains a non-empty
    set of properties. The empty set of properties is stored as "()", so we
    have properties if the size of the column is larger than 2. */
@@ -905,6 +909,55 @@ blank_iwb(insert_working_baton_t *piwb)
 }
 
 
+/* Baton for bind_incomplete_child(), containing the per-directory
+   constants of insert_incomplete_children() plus the index of the first
+   child still to be inserted. */
+struct insert_incomplete_baton_t {
+  apr_int64_t wc_id;
+  const char *local_relpath;
+  apr_int64_t repos_id;
+  const char *repos_path;
+  svn_revnum_t revision;
+  int op_depth;
+  const apr_array_header_t *children;
+  int first_child;
+  apr_hash_t *moved_to_relpaths;
+};
+
+/* Implements svn_sqlite__bind_row_func_t, binding STMT_INSERT_NODE for
+   child FIRST_CHILD+ROW_IDX of an insert_incomplete_children() call. */
+static svn_error_t *
+bind_incomplete_child(svn_sqlite__stmt_t *stmt,
+                      int row_idx,
+                      void *baton,
+                      apr_pool_t *scratch_pool)
+{
+  struct insert_incomplete_baton_t *iib = baton;
+  const char *name = APR_ARRAY_IDX(iib->children, iib->first_child + row_idx,
+                                   const char *);
+
+  SVN_ERR(svn_sqlite__bindf(stmt, "isdsnnrsnsnnnnnnnnnnsn",
+                            iib->wc_id,
+                            svn_relpath_join(iib->local_relpath, name,
+                                             scratch_pool),
+                            iib->op_depth,
+                            iib->local_relpath,
+                            iib->revision,
+                            "incomplete", /* 8, presence */
+                            "unknown",    /* 10, kind */
+                            /* 21, moved_to */
+                            svn_hash_gets(iib->moved_to_relpaths, name)));
+  if (iib->repos_id != INVALID_REPOS_ID)
+    {
+      SVN_ERR(svn_sqlite__bind_int64(stmt, 5, iib->repos_id));
+      SVN_ERR(svn_sqlite__bind_text(stmt, 6,
+                                    svn_relpath_join(iib->repos_path, name,
+                                                     scratch_pool)));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Insert a row in NODES for each (const char *) child name in CHILDREN,
    whose parent directory is LOCAL_RELPATH, at op_depth=OP_DEPTH.  Set each
    child's presence to 'incomplete', kind to 'unknown', repos_id to REPOS_ID,
@@ -958,34 +1011,69 @@ insert_incomplete_children(svn_sqlite__db_t *sdb,
         }
     }
 
-  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_INSERT_NODE));
-
-  for (i = children->nelts; i--; )
+  /* Insert the bulk of the children with multi-row statements; stepping
+     one statement per row dominates the checkout profile for large
+     directories. */
+  i = 0;
+  if (children->nelts - i >= INSERT_NODE_INCOMPLETE_ROWS)
     {
-      const char *name = APR_ARRAY_IDX(children, i, const char *);
-
-      svn_pool_clear(iterpool);
+      SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
+                                        STMT_INSERT_NODE_INCOMPLETE_8));
 
-      SVN_ERR(svn_sqlite__bindf(stmt, "isdsnnrsnsnnnnnnnnnnsn",
-                                wc_id,
-                                svn_relpath_join(local_relpath, name,
-                                                 iterpool),
-                                op_depth,
-                                local_relpath,
-                                revision,
-                                "incomplete", /* 8, presence */
-                                "unknown",    /* 10, kind */
-                                /* 21, moved_to */
-                                svn_hash_gets(moved_to_relpaths, name)));
-      if (repos_id != INVALID_REPOS_ID)
+      while (children->nelts - i >= INSERT_NODE_INCOMPLETE_ROWS)
         {
-          SVN_ERR(svn_sqlite__bind_int64(stmt, 5, repos_id));
-          SVN_ERR(svn_sqlite__bind_text(stmt, 6,
-                                        svn_relpath_join(repos_path, name,
-                                                         iterpool)));
+          int row;
+
+          svn_pool_clear(iterpool);
+
+          SVN_ERR(svn_sqlite__bindf(stmt, "idsnr",
+                                    wc_id,           /* 1 */
+                                    op_depth,        /* 2 */
+                                    local_relpath,   /* 3, parent_relpath */
+                                    revision));      /* 5 */
+          if (repos_id != INVALID_REPOS_ID)
+            SVN_ERR(svn_sqlite__bind_int64(stmt, 4, repos_id));
+
+          for (row = 0; row < INSERT_NODE_INCOMPLETE_ROWS; row++, i++)
+            {
+              const char *name = APR_ARRAY_IDX(children, i, const char *);
+
+              SVN_ERR(svn_sqlite__bind_text(stmt, 6 + 3 * row,
+                                            svn_relpath_join(local_relpath,
+                                                             name,
+                                                             iterpool)));
+              if (repos_id != INVALID_REPOS_ID)
+                SVN_ERR(svn_sqlite__bind_text(stmt, 7 + 3 * row,
+                                              svn_relpath_join(repos_path,
+                                                               name,
+                                                               iterpool)));
+              SVN_ERR(svn_sqlite__bind_text(stmt, 8 + 3 * row,
+                                            svn_hash_gets(moved_to_relpaths,
+                                                          name)));
+            }
+
+          SVN_ERR(svn_sqlite__insert(NULL, stmt));
         }
+    }
 
-      SVN_ERR(svn_sqlite__insert(NULL, stmt));
+  if (i < children->nelts)
+    {
+      struct insert_incomplete_baton_t iib;
+
+      iib.wc_id = wc_id;
+      iib.local_relpath = local_relpath;
+      iib.repos_id = repos_id;
+      iib.repos_path = repos_path;
+      iib.revision = revision;
+      iib.op_depth = op_depth;
+      iib.children = children;
+      iib.first_child = i;
+      iib.moved_to_relpaths = moved_to_relpaths;
+
+      SVN_ERR(svn_sqlite__stmt_run_batch(sdb, STMT_INSERT_NODE,
+                                         children->nelts - i,
+                                         bind_incomplete_child, &iib,
+                                         scratch_pool));
     }
 
   svn_pool_destroy(iterpool);
@@ -1431,13 +1519,14 @@ create_db(svn_sqlite__db_t **sdb,
           svn_revnum_t root_node_revision,
           svn_depth_t root_node_depth,
           svn_boolean_t exclusive,
+          svn_boolean_t wal_mode,
           apr_int32_t timeout,
           apr_pool_t *result_pool,
           apr_pool_t *scratch_pool)
 {
   SVN_ERR(svn_wc__db_util_open_db(sdb, dir_abspath, sdb_fname,
                                   svn_sqlite__mode_rwcreate, exclusive,
-                                  timeout,
+                                  wal_mode, timeout,
                                   NULL /* my_statements */,
                                   result_pool, scratch_pool));
 
@@ -1466,6 +1555,7 @@ svn_wc__db_init(svn_wc__db_t *db,
   apr_int64_t wc_id;
   svn_wc__db_wcroot_t *wcroot;
   svn_boolean_t sqlite_exclusive = FALSE;
+  svn_boolean_t sqlite_wal = FALSE;
   apr_int32_t sqlite_timeout = 0; /* default timeout */
   apr_hash_index_t *hi;
 
@@ -1483,11 +1573,16 @@ svn_wc__db_init(svn_wc__db_t *db,
                               SVN_CONFIG_OPTION_SQLITE_EXCLUSIVE,
                               FALSE));
 
+  SVN_ERR(svn_config_get_bool(db->config, &sqlite_wal,
+                              SVN_CONFIG_SECTION_WORKING_COPY,
+                              SVN_CONFIG_OPTION_SQLITE_WAL,
+                              FALSE));
+
   /* Create the SDB and insert the basic rows.  */
   SVN_ERR(create_db(&sdb, &repos_id, &wc_id, local_abspath, repos_root_url,
                     repos_uuid, SDB_FILE,
                     repos_relpath, initial_rev, depth, sqlite_exclusive,
-                    sqlite_timeout,
+                    sqlite_wal, sqlite_timeout,
                     db->state_pool, scratch_pool));
 
   /* Create the WCROOT for this directory.  */
@@ -6095,6 +6190,165 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
 }
 
 
+/* Set *ACTIVE to whether WCROOT's database carries a CHANGE_JOURNAL
+   table, caching the answer in WCROOT. */
+static svn_error_t *
+change_journal_active(svn_boolean_t *active,
+                      svn_wc__db_wcroot_t *wcroot,
+                      apr_pool_t *scratch_pool)
+{
+  if (wcroot->change_journal == svn_tristate_unknown)
+    {
+      svn_sqlite__stmt_t *stmt;
+      svn_boolean_t have_row;
+
+      SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                        STMT_HAVE_CHANGE_JOURNAL_TABLE));
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+      SVN_ERR(svn_sqlite__reset(stmt));
+
+      wcroot->change_journal = have_row ? svn_tristate_true
+                                        : svn_tristate_false;
+    }
+
+  *active = (wcroot->change_journal == svn_tristate_true);
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_change_journal_activate(svn_wc__db_t *db,
+                                   const char *wri_abspath,
+                                   apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(svn_sqlite__exec_statements(wcroot->sdb,
+                                      STMT_CREATE_CHANGE_JOURNAL));
+  wcroot->change_journal = svn_tristate_true;
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_change_journal_deactivate(svn_wc__db_t *db,
+                                     const char *wri_abspath,
+                                     apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(svn_sqlite__exec_statements(wcroot->sdb,
+                                      STMT_DROP_CHANGE_JOURNAL));
+  wcroot->change_journal = svn_tristate_false;
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_change_journal_record(svn_wc__db_t *db,
+                                 const char *local_abspath,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_boolean_t active;
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(change_journal_active(&active, wcroot, scratch_pool));
+  if (!active)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_INSERT_CHANGE_JOURNAL));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+  SVN_ERR(svn_sqlite__step_done(stmt));
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_change_journal_query(svn_boolean_t *active,
+                                svn_boolean_t *dirty,
+                                svn_wc__db_t *db,
+                                const char *local_abspath,
+                                apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(change_journal_active(active, wcroot, scratch_pool));
+  if (!*active)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_CHANGE_JOURNAL));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+  SVN_ERR(svn_sqlite__step(dirty, stmt));
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_change_journal_clear(svn_wc__db_t *db,
+                                const char *local_abspath,
+                                apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_boolean_t active;
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(change_journal_active(&active, wcroot, scratch_pool));
+  if (!active)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_DELETE_CHANGE_JOURNAL));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+  SVN_ERR(svn_sqlite__step_done(stmt));
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Set the ACTUAL_NODE properties column for (WC_ID, LOCAL_RELPATH) to
  * PROPS.
  *
@@ -13333,6 +13587,7 @@ svn_wc__db_upgrade_begin(svn_sqlite__db_t **sdb,
                     SDB_FILE,
                     NULL, SVN_INVALID_REVNUM, svn_depth_unknown,
                     TRUE /* exclusive */,
+                    FALSE /* wal */,
                     0 /* timeout */,
                     wc_db->state_pool, scratch_pool));
 
@@ -13596,6 +13851,85 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
   return SVN_NO_ERROR;
 }
 
+/* The body of svn_wc__db_wq_fetch_batch().
+ */
+static svn_error_t *
+wq_fetch_batch(apr_array_header_t **items,
+               svn_wc__db_wcroot_t *wcroot,
+               apr_uint64_t completed_id,
+               apr_hash_t *record_map,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  if (completed_id != 0)
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                        STMT_DELETE_WORK_ITEMS_UP_TO));
+      SVN_ERR(svn_sqlite__bind_int64(stmt, 1, completed_id));
+
+      SVN_ERR(svn_sqlite__step_done(stmt));
+    }
+
+  if (record_map != NULL)
+    SVN_ERR(wq_record(wcroot, record_map, scratch_pool));
+
+  *items = apr_array_make(result_pool, 32,
+                          sizeof(svn_wc__db_wq_item_t *));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_WORK_ITEMS));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      svn_wc__db_wq_item_t *item = apr_palloc(result_pool, sizeof(*item));
+      apr_size_t len;
+      const void *val;
+
+      item->id = svn_sqlite__column_int64(stmt, 0);
+
+      val = svn_sqlite__column_blob(stmt, 1, &len, result_pool);
+
+      item->work_item = svn_skel__parse(val, len, result_pool);
+
+      APR_ARRAY_PUSH(*items, svn_wc__db_wq_item_t *) = item;
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_wc__db_wq_fetch_batch(apr_array_header_t **items,
+                          svn_wc__db_t *db,
+                          const char *wri_abspath,
+                          apr_uint64_t completed_id,
+                          apr_hash_t *record_map,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(items != NULL);
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_WC__DB_WITH_TXN(
+    wq_fetch_batch(items, wcroot, completed_id, record_map,
+                   result_pool, scratch_pool),
+    wcroot);
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* ### temporary API. remove before release.  */
@@ -16015,6 +16349,7 @@ svn_wc__db_bump_format(int *result_format,
   err = svn_wc__db_util_open_db(&sdb, wcroot_abspath, SDB_FILE,
                                 svn_sqlite__mode_readwrite,
                                 TRUE, /* exclusive */
+                                FALSE, /* wal */
                                 0, /* default timeout */
                                 NULL, /* my statements */
                                 scratch_pool, scratch_pool);
@@ -1057,6 +1057,67 @@ svn_wc__db_pristine_check(svn_boolean_t *present,
                           const svn_checksum_t *sha1_checksum,
                           apr_pool_t *scratch_pool);
 
+/* A pristine text that is referenced by the BASE tree but whose file is
+   absent from the pristine store on disk, and where its text can be
+   fetched from again: REPOS_RELPATH at REVISION names a node whose text
+   it is. */
+typedef struct svn_wc__db_missing_pristine_t {
+  const svn_checksum_t *sha1_checksum;
+  const char *repos_relpath;
+  svn_revnum_t revision;
+} svn_wc__db_missing_pristine_t;
+
+/* Set *MISSING to an array of svn_wc__db_missing_pristine_t *, one for
+   each pristine text that is referenced by the BASE tree of the working
+   copy containing WRI_ABSPATH but whose file is not present in the
+   pristine store on disk.  The array may be empty.
+
+   Allocate *MISSING in RESULT_POOL. */
+svn_error_t *
+svn_wc__db_pristine_get_missing(apr_array_header_t **missing,
+                                svn_wc__db_t *db,
+                                const char *wri_abspath,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
+/* Remove from disk, but keep registered in the PRISTINE table, every
+   pristine text in the working copy containing WRI_ABSPATH that is
+   referenced only by BASE nodes whose working files look unmodified by
+   the recorded size and timestamp.  Pristines referenced by any higher
+   op-depth layer (local copies and moves) are never touched, so those
+   remain committable offline.  The removed texts can be fetched from the
+   repository again; see svn_wc__db_pristine_get_missing().
+
+   If REMOVED_COUNT is not null, set *REMOVED_COUNT to the number of
+   pristine files removed.  This is a no-op (with *REMOVED_COUNT 0) while
+   the work queue is non-empty. */
+svn_error_t *
+svn_wc__db_pristine_dehydrate(int *removed_count,
+                              svn_wc__db_t *db,
+                              const char *wri_abspath,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              apr_pool_t *scratch_pool);
+
+/* Set *STORE_PRISTINE to FALSE iff the working copy containing WRI_ABSPATH
+   records that its pristine store has been dehydrated.  Working copies
+   that predate the SETTINGS table always store their pristine texts, so
+   *STORE_PRISTINE is TRUE for them. */
+svn_error_t *
+svn_wc__db_pristine_get_stored(svn_boolean_t *store_pristine,
+                               svn_wc__db_t *db,
+                               const char *wri_abspath,
+                               apr_pool_t *scratch_pool);
+
+/* Record in the working copy containing WRI_ABSPATH that its pristine
+   store is hydrated again.  The caller must ensure that no referenced
+   pristine text is missing from disk; see svn_wc__db_pristine_get_missing().
+   This is a no-op on a working copy that was never dehydrated. */
+svn_error_t *
+svn_wc__db_pristine_mark_stored(svn_wc__db_t *db,
+                                const char *wri_abspath,
+                                apr_pool_t *scratch_pool);
+
 /* @defgroup svn_wc__db_external  External management
    @{ */
 
@@ -2663,6 +2724,56 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
                                   apr_pool_t *scratch_pool);
 
 
+/* The change journal is an advisory dirty set maintained in wc.db by an
+   external file system watcher (inotify, FSEvents, ...).  While a journal
+   is active, modification checks may trust the recorded size and timestamp
+   of any file the watcher never reported as touched, instead of statting
+   it.  The journal is purely an accelerator: dropping it, or rows in it,
+   only costs performance, never correctness, because a journalled file is
+   still verified the usual way.
+
+   Activate a change journal for the working copy containing WRI_ABSPATH.
+   Activation is idempotent; an already recorded dirty set survives. */
+svn_error_t *
+svn_wc__db_change_journal_activate(svn_wc__db_t *db,
+                                   const char *wri_abspath,
+                                   apr_pool_t *scratch_pool);
+
+/* Deactivate the change journal for the working copy containing
+   WRI_ABSPATH, discarding the recorded dirty set.  A no-op when no
+   journal is active. */
+svn_error_t *
+svn_wc__db_change_journal_deactivate(svn_wc__db_t *db,
+                                     const char *wri_abspath,
+                                     apr_pool_t *scratch_pool);
+
+/* Record LOCAL_ABSPATH as touched in the change journal of its working
+   copy.  A no-op when no journal is active.  Watchers should also record
+   paths whose events they may have dropped; when in doubt, record. */
+svn_error_t *
+svn_wc__db_change_journal_record(svn_wc__db_t *db,
+                                 const char *local_abspath,
+                                 apr_pool_t *scratch_pool);
+
+/* Set *ACTIVE to whether a change journal is active for the working copy
+   containing LOCAL_ABSPATH, and *DIRTY to whether LOCAL_ABSPATH is in its
+   dirty set.  *DIRTY is undefined when *ACTIVE is FALSE. */
+svn_error_t *
+svn_wc__db_change_journal_query(svn_boolean_t *active,
+                                svn_boolean_t *dirty,
+                                svn_wc__db_t *db,
+                                const char *local_abspath,
+                                apr_pool_t *scratch_pool);
+
+/* Remove LOCAL_ABSPATH from the dirty set of its working copy's change
+   journal, after its contents have been verified against the pristine.
+   A no-op when no journal is active. */
+svn_error_t *
+svn_wc__db_change_journal_clear(svn_wc__db_t *db,
+                                const char *local_abspath,
+                                apr_pool_t *scratch_pool);
+
+
 /* ### post-commit handling.
    ### maybe multiple phases?
    ### 1) mark a changelist as being-committed
@@ -3028,6 +3139,33 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* One work queue entry, as returned by svn_wc__db_wq_fetch_batch().  */
+typedef struct svn_wc__db_wq_item_t {
+  apr_uint64_t id;
+  svn_skel_t *work_item;
+} svn_wc__db_wq_item_t;
+
+/* Batched variant of svn_wc__db_wq_fetch_next(): in a single transaction,
+   mark every work item with an id up to and including COMPLETED_ID as
+   completed, record timestamps and sizes for the nodes in RECORD_MAP (if
+   RECORD_MAP is not NULL), and fetch the next chunk of queued work items,
+   in the order they were queued.
+
+   Ids are handed out by an AUTOINCREMENT column and work items are always
+   processed in id order, so the completed items form exactly the id range
+   up to the last item that ran.
+
+   Set *ITEMS to an array of svn_wc__db_wq_item_t *, allocated in
+   RESULT_POOL. The array is empty if there is no work left.  */
+svn_error_t *
+svn_wc__db_wq_fetch_batch(apr_array_header_t **items,
+                          svn_wc__db_t *db,
+                          const char *wri_abspath,
+                          apr_uint64_t completed_id,
+                          apr_hash_t *record_map,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool);
+
 
 /* @} */
 
@@ -26,7 +26,9 @@
 #define SVN_WC__I_AM_WC_DB
 
 #include "svn_pools.h"
+#include "svn_hash.h"
 #include "svn_io.h"
+#include "svn_config.h"
 #include "svn_dirent_uri.h"
 
 #include "private/svn_io_private.h"
@@ -42,6 +44,39 @@
 
 
 
+/* Set *PRISTINE_ABSPATH to the path dedicated to CHECKSUM's pristine
+   file below the store rooted at BASE_DIR_ABSPATH, using the layout
+   BASE/XX/XXYYZZ...svn-base.  Allocate the result in RESULT_POOL and
+   temporaries in SCRATCH_POOL. */
+static svn_error_t *
+pristine_fname_in_dir(const char **pristine_abspath,
+                      const char *base_dir_abspath,
+                      const svn_checksum_t *sha1_checksum,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  const char *hexdigest = svn_checksum_to_cstring(sha1_checksum, scratch_pool);
+  char subdir[3];
+
+  /* We should have a valid checksum and (thus) a valid digest. */
+  SVN_ERR_ASSERT(hexdigest != NULL);
+
+  /* Get the first two characters of the digest, for the subdir. */
+  subdir[0] = hexdigest[0];
+  subdir[1] = hexdigest[1];
+  subdir[2] = '\0';
+
+  hexdigest = apr_pstrcat(scratch_pool, hexdigest, PRISTINE_STORAGE_EXT,
+                          SVN_VA_NULL);
+
+  *pristine_abspath = svn_dirent_join_many(result_pool,
+                                           base_dir_abspath,
+                                           subdir,
+                                           hexdigest,
+                                           SVN_VA_NULL);
+  return SVN_NO_ERROR;
+}
+
 /* Returns in PRISTINE_ABSPATH a new string allocated from RESULT_POOL,
    holding the local absolute path to the file location that is dedicated
    to hold CHECKSUM's pristine file, relating to the pristine store
@@ -57,8 +92,6 @@ get_pristine_fname(const char **pristine_abspath,
                    apr_pool_t *scratch_pool)
 {
   const char *base_dir_abspath;
-  const char *hexdigest = svn_checksum_to_cstring(sha1_checksum, scratch_pool);
-  char subdir[3];
 
   /* ### code is in transition. make sure we have the proper data.  */
   SVN_ERR_ASSERT(pristine_abspath != NULL);
@@ -72,24 +105,38 @@ get_pristine_fname(const char **pristine_abspath,
                                           PRISTINE_STORAGE_RELPATH,
                                           SVN_VA_NULL);
 
-  /* We should have a valid checksum and (thus) a valid digest. */
-  SVN_ERR_ASSERT(hexdigest != NULL);
+  /* The file is located at DIR/.svn/pristine/XX/XXYYZZ...svn-base */
+  return svn_error_trace(pristine_fname_in_dir(pristine_abspath,
+                                               base_dir_abspath,
+                                               sha1_checksum,
+                                               result_pool, scratch_pool));
+}
 
-  /* Get the first two characters of the digest, for the subdir. */
-  subdir[0] = hexdigest[0];
-  subdir[1] = hexdigest[1];
-  subdir[2] = '\0';
+/* Set *STORE_ABSPATH to the machine-global shared pristine store
+   configured for DB, or to NULL if none is configured.  Allocate the
+   result in RESULT_POOL. */
+static svn_error_t *
+get_shared_store_abspath(const char **store_abspath,
+                         svn_wc__db_t *db,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  const char *path;
 
-  hexdigest = apr_pstrcat(scratch_pool, hexdigest, PRISTINE_STORAGE_EXT,
-                          SVN_VA_NULL);
+  *store_abspath = NULL;
+  if (db->config == NULL)
+    return SVN_NO_ERROR;
 
-  /* The file is located at DIR/.svn/pristine/XX/XXYYZZ...svn-base */
-  *pristine_abspath = svn_dirent_join_many(result_pool,
-                                           base_dir_abspath,
-                                           subdir,
-                                           hexdigest,
-                                           SVN_VA_NULL);
-  return SVN_NO_ERROR;
+  svn_config_get(db->config, &path, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_SHARED_PRISTINE_STORE, NULL);
+  if (path == NULL || *path == '\0')
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(
+           svn_dirent_get_absolute(store_abspath,
+                                   svn_dirent_internal_style(path,
+                                                             scratch_pool),
+                                   result_pool));
 }
 
 
@@ -283,6 +330,9 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
                      svn_stream_t *install_stream,
                      /* The target path for the file (within the pristine store). */
                      const char *pristine_abspath,
+                     /* Root of the machine-global shared pristine store,
+                        or NULL if none is configured. */
+                     const char *shared_store_abspath,
                      /* The pristine text's SHA-1 checksum. */
                      const svn_checksum_t *sha1_checksum,
                      /* The pristine text's MD-5 checksum. */
@@ -301,6 +351,24 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
 
   if (have_row)
     {
+      svn_node_kind_t kind_on_disk;
+
+      /* The text may be registered while its file is absent from disk:
+       * either the store was dehydrated (see
+       * svn_wc__db_pristine_dehydrate()) or someone deleted the file
+       * behind our back.  In that case install the file we were just
+       * handed; the row is already correct. */
+      SVN_ERR(svn_io_check_path(pristine_abspath, &kind_on_disk,
+                                scratch_pool));
+      if (kind_on_disk != svn_node_file)
+        {
+          SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
+                                             TRUE, scratch_pool));
+          SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE,
+                                            scratch_pool));
+          return SVN_NO_ERROR;
+        }
+
 #ifdef SVN_DEBUG
       /* Consistency checks.  Verify both files exist and match.
        * ### We could check much more. */
@@ -333,8 +401,56 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
    * an orphan file and it doesn't matter if we overwrite it.) */
   {
     apr_finfo_t finfo;
+    const char *shared_abspath = NULL;
+
     SVN_ERR(svn_stream__install_get_info(&finfo, install_stream,
                                          APR_FINFO_SIZE, scratch_pool));
+
+    if (shared_store_abspath)
+      SVN_ERR(pristine_fname_in_dir(&shared_abspath, shared_store_abspath,
+                                    sha1_checksum,
+                                    scratch_pool, scratch_pool));
+
+    /* If another working copy already published this text to the shared
+     * store, hard-link it instead of installing a second copy.  The link
+     * shares the inode, so identical texts occupy disk space only once
+     * per machine. */
+    if (shared_abspath)
+      {
+        svn_node_kind_t kind;
+
+        SVN_ERR(svn_io_check_path(shared_abspath, &kind, scratch_pool));
+        if (kind == svn_node_file)
+          {
+            apr_finfo_t shared_finfo;
+            svn_boolean_t linked = FALSE;
+
+            /* Guard against a corrupted store; on any mismatch simply
+             * install our own copy. */
+            SVN_ERR(svn_io_stat(&shared_finfo, shared_abspath,
+                                APR_FINFO_SIZE, scratch_pool));
+            if (shared_finfo.size == finfo.size)
+              SVN_ERR(svn_io__link_file(&linked, pristine_abspath,
+                                        shared_abspath, scratch_pool));
+
+            if (linked)
+              {
+                SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
+                                                  STMT_INSERT_PRISTINE));
+                SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum,
+                                                  scratch_pool));
+                SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum,
+                                                  scratch_pool));
+                SVN_ERR(svn_sqlite__bind_int64(stmt, 3, finfo.size));
+                SVN_ERR(svn_sqlite__insert(NULL, stmt));
+
+                SVN_ERR(svn_stream__install_delete(install_stream,
+                                                   scratch_pool));
+                return SVN_NO_ERROR;
+              }
+          }
+      }
+
     SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
                                        TRUE, scratch_pool));
 
@@ -345,6 +461,17 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
     SVN_ERR(svn_sqlite__insert(NULL, stmt));
 
     SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE, scratch_pool));
+
+    /* Publish the new text to the shared store, best-effort.  If someone
+     * else beat us to it or the store lives on another filesystem, we
+     * just keep our private copy. */
+    if (shared_abspath)
+      {
+        svn_boolean_t linked;
+
+        SVN_ERR(svn_io__link_file(&linked, shared_abspath, pristine_abspath,
+                                  scratch_pool));
+      }
   }
 
   return SVN_NO_ERROR;
@@ -354,6 +481,16 @@ struct svn_wc__db_install_data_t
 {
   svn_wc__db_wcroot_t *wcroot;
   svn_stream_t *inner_stream;
+
+  /* The pipelined wrapper handed to the caller, or NULL if writes go to
+     the checksummed INNER_STREAM chain directly.  Aborting the install
+     must shut this one down first, lest the worker thread keep writing
+     to the temporary file while we delete it. */
+  svn_stream_t *pipelined_stream;
+
+  /* Root of the machine-global shared pristine store, or NULL if none
+     is configured. */
+  const char *shared_store_abspath;
 };
 
 svn_error_t *
@@ -380,6 +517,8 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
 
   *install_data = apr_pcalloc(result_pool, sizeof(**install_data));
   (*install_data)->wcroot = wcroot;
+  SVN_ERR(get_shared_store_abspath(&(*install_data)->shared_store_abspath,
+                                   db, result_pool, scratch_pool));
 
   SVN_ERR_W(svn_stream__create_for_install(stream,
                                            temp_dir_abspath,
@@ -395,6 +534,22 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
     *stream = svn_stream_checksummed2(*stream, NULL, sha1_checksum,
                                       svn_checksum_sha1, FALSE, result_pool);
 
+  /* Run checksumming and disk I/O on a worker thread, overlapping them
+     with whatever produces the data - typically delta application in
+     the update editor.  Checksum results only materialize when the
+     caller closes the stream, just like before. */
+  if (md5_checksum || sha1_checksum)
+    {
+      svn_stream_t *pipelined = svn_stream__pipelined_write(*stream,
+                                                            result_pool);
+
+      if (pipelined != *stream)
+        {
+          *stream = pipelined;
+          (*install_data)->pipelined_stream = pipelined;
+        }
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -421,6 +576,7 @@ svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
   SVN_SQLITE__WITH_IMMEDIATE_TXN(
     pristine_install_txn(wcroot->sdb,
                          install_data->inner_stream, pristine_abspath,
+                         install_data->shared_store_abspath,
                          sha1_checksum, md5_checksum,
                          scratch_pool),
     wcroot->sdb);
@@ -432,6 +588,13 @@ svn_error_t *
 svn_wc__db_pristine_install_abort(svn_wc__db_install_data_t *install_data,
                                   apr_pool_t *scratch_pool)
 {
+  /* Stop the pipelined writer, if any, before yanking the temporary
+     file from under it.  We are discarding the data, so any pending
+     write or checksum error is of no interest.  This is a no-op if the
+     stream has already been closed. */
+  if (install_data->pipelined_stream)
+    svn_error_clear(svn_stream_close(install_data->pipelined_stream));
+
   return svn_error_trace(svn_stream__install_delete(install_data->inner_stream,
                                                     scratch_pool));
 }
@@ -951,3 +1114,314 @@ svn_wc__db_pristine_check(svn_boolean_t *present,
   *present = have_row;
   return SVN_NO_ERROR;
 }
+
+
+svn_error_t *
+svn_wc__db_pristine_get_missing(apr_array_header_t **missing,
+                                svn_wc__db_t *db,
+                                const char *wri_abspath,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_hash_t *seen = apr_hash_make(scratch_pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  *missing = apr_array_make(result_pool, 0,
+                            sizeof(svn_wc__db_missing_pristine_t *));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_BASE_FILE_PRISTINES));
+  SVN_ERR(svn_sqlite__bindf(stmt, "i", wcroot->wc_id));
+
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      const svn_checksum_t *sha1_checksum;
+      const char *hexdigest;
+      const char *pristine_abspath;
+      svn_node_kind_t kind_on_disk;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_sqlite__column_checksum(&sha1_checksum, stmt, 1, iterpool));
+      hexdigest = svn_checksum_to_cstring(sha1_checksum, iterpool);
+
+      /* Many nodes may reference the same text; check each only once. */
+      if (! svn_hash_gets(seen, hexdigest))
+        {
+          svn_hash_sets(seen, apr_pstrdup(scratch_pool, hexdigest), "");
+
+          SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
+                                     sha1_checksum, iterpool, iterpool));
+          SVN_ERR(svn_io_check_path(pristine_abspath, &kind_on_disk,
+                                    iterpool));
+          if (kind_on_disk != svn_node_file)
+            {
+              svn_wc__db_missing_pristine_t *item
+                = apr_pcalloc(result_pool, sizeof(*item));
+
+              item->sha1_checksum = svn_checksum_dup(sha1_checksum,
+                                                     result_pool);
+              item->repos_relpath
+                = apr_pstrdup(result_pool,
+                              svn_sqlite__column_text(stmt, 2, NULL));
+              item->revision = svn_sqlite__column_revnum(stmt, 3);
+
+              APR_ARRAY_PUSH(*missing, svn_wc__db_missing_pristine_t *)
+                = item;
+            }
+        }
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Record STORE_PRISTINE for WCROOT in the SETTINGS table, bumping the
+   working copy to format SVN_WC__HAS_SETTINGS first if necessary.  Run
+   this within a db transaction. */
+static svn_error_t *
+pristine_record_stored(svn_wc__db_wcroot_t *wcroot,
+                       svn_boolean_t store_pristine,
+                       apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  if (wcroot->format < SVN_WC__HAS_SETTINGS)
+    {
+      /* A working copy without a SETTINGS table implicitly stores all
+         its pristine texts; don't bump the format just to say so. */
+      if (store_pristine)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(svn_sqlite__exec_statements(wcroot->sdb, STMT_UPGRADE_TO_32));
+      wcroot->format = SVN_WC__HAS_SETTINGS;
+    }
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_UPSERT_PRISTINE_STORED));
+  SVN_ERR(svn_sqlite__bindf(stmt, "id", wcroot->wc_id,
+                            store_pristine ? 1 : 0));
+  SVN_ERR(svn_sqlite__step_done(stmt));
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_pristine_dehydrate(int *removed_count,
+                              svn_wc__db_t *db,
+                              const char *wri_abspath,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  svn_boolean_t marked = FALSE;
+  apr_hash_t *keep = apr_hash_make(scratch_pool);
+  apr_hash_t *candidates = apr_hash_make(scratch_pool);
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  if (removed_count)
+    *removed_count = 0;
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  /* If the work queue is not empty, don't remove any pristine text because
+   * the work queue may contain a reference to it. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb, STMT_LOOK_FOR_WORK));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  SVN_ERR(svn_sqlite__reset(stmt));
+  if (have_row)
+    return SVN_NO_ERROR;
+
+  /* Pristines referenced by locally added, copied or moved nodes may be
+   * needed to commit while offline; never touch those. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_WORKING_PRISTINE_REFS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "i", wcroot->wc_id));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      const svn_checksum_t *sha1_checksum;
+
+      SVN_ERR(svn_sqlite__column_checksum(&sha1_checksum, stmt, 0,
+                                          scratch_pool));
+      svn_hash_sets(keep, svn_checksum_to_cstring(sha1_checksum,
+                                                  scratch_pool), "");
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  /* Walk the BASE file nodes.  A pristine stays on disk as soon as one of
+   * the working files referencing it looks modified: the cheap recorded
+   * size/time comparison is all we can afford here, and a false
+   * "modified" merely keeps a text we could have dropped. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_BASE_FILE_PRISTINES));
+  SVN_ERR(svn_sqlite__bindf(stmt, "i", wcroot->wc_id));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      const svn_checksum_t *sha1_checksum;
+      const char *hexdigest;
+      svn_boolean_t unmodified = FALSE;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_sqlite__column_checksum(&sha1_checksum, stmt, 1, iterpool));
+      hexdigest = svn_checksum_to_cstring(sha1_checksum, scratch_pool);
+
+      if (! svn_sqlite__column_is_null(stmt, 4)
+          && ! svn_sqlite__column_is_null(stmt, 5))
+        {
+          const char *node_abspath;
+          const svn_io_dirent2_t *dirent;
+
+          node_abspath = svn_dirent_join(wcroot->abspath,
+                                         svn_sqlite__column_text(stmt, 0,
+                                                                 NULL),
+                                         iterpool);
+          SVN_ERR(svn_io_stat_dirent2(&dirent, node_abspath, FALSE, TRUE,
+                                      iterpool, iterpool));
+          if (dirent->kind == svn_node_file
+              && dirent->filesize == svn_sqlite__column_int64(stmt, 4)
+              && dirent->mtime == svn_sqlite__column_int64(stmt, 5))
+            unmodified = TRUE;
+        }
+
+      if (unmodified)
+        {
+          if (! svn_hash_gets(candidates, hexdigest))
+            svn_hash_sets(candidates, hexdigest,
+                          svn_checksum_dup(sha1_checksum, scratch_pool));
+        }
+      else
+        svn_hash_sets(keep, hexdigest, "");
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  for (hi = apr_hash_first(scratch_pool, candidates); hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *hexdigest = apr_hash_this_key(hi);
+      const svn_checksum_t *sha1_checksum = apr_hash_this_val(hi);
+      const char *pristine_abspath;
+      svn_node_kind_t kind_on_disk;
+
+      if (svn_hash_gets(keep, hexdigest))
+        continue;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
+                                 sha1_checksum, iterpool, iterpool));
+      SVN_ERR(svn_io_check_path(pristine_abspath, &kind_on_disk, iterpool));
+      if (kind_on_disk == svn_node_file)
+        {
+          /* Make the dehydration visible in the database before the first
+             text disappears from disk: the recorded mode (and the format
+             bump carrying it) is what keeps other clients from mistaking
+             the missing files for corruption. */
+          if (!marked)
+            {
+              SVN_WC__DB_WITH_TXN(pristine_record_stored(wcroot, FALSE,
+                                                         iterpool),
+                                  wcroot);
+              marked = TRUE;
+            }
+
+          SVN_ERR(svn_io_remove_file2(pristine_abspath, TRUE, iterpool));
+          if (removed_count)
+            (*removed_count)++;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_pristine_get_stored(svn_boolean_t *store_pristine,
+                               svn_wc__db_t *db,
+                               const char *wri_abspath,
+                               apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  /* Working copies that predate the SETTINGS table always store their
+     pristine texts. */
+  *store_pristine = TRUE;
+  if (wcroot->format < SVN_WC__HAS_SETTINGS)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_PRISTINE_STORED));
+  SVN_ERR(svn_sqlite__bindf(stmt, "i", wcroot->wc_id));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    *store_pristine = svn_sqlite__column_boolean(stmt, 0);
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc__db_pristine_mark_stored(svn_wc__db_t *db,
+                                const char *wri_abspath,
+                                apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_WC__DB_WITH_TXN(pristine_record_stored(wcroot, TRUE, scratch_pool),
+                      wcroot);
+
+  return SVN_NO_ERROR;
+}
@@ -49,6 +49,11 @@ struct svn_wc__db_t {
   /* Should we open Sqlite databases EXCLUSIVE */
   svn_boolean_t exclusive;
 
+  /* Should we open Sqlite databases in WAL mode with relaxed
+     synchronization (the "wal-mode" config option)?  Ignored when
+     EXCLUSIVE is set. */
+  svn_boolean_t wal_mode;
+
   /* Busy timeout in ms., 0 for the libsvn_subr default. */
   apr_int32_t timeout;
 
@@ -56,6 +61,13 @@ struct svn_wc__db_t {
      const char *local_abspath -> svn_wc__db_wcroot_t *wcroot  */
   apr_hash_t *dir_data;
 
+  /* Hash-consed local_relpath strings as handed out by
+     svn_wc__db_wcroot_parse_local_abspath().  Equal relpaths map to the
+     same STATE_POOL copy, i.e. they are also equal as pointers and can
+     be hashed and compared as such by anyone holding on to them.
+     const char *local_relpath -> const char *local_relpath  */
+  apr_hash_t *relpath_atoms;
+
   /* A few members to assist with caching of kind values for paths.  See
      get_path_kind() for use. */
   struct
@@ -107,6 +119,11 @@ typedef struct svn_wc__db_wcroot_t {
      const char *local_abspath -> svn_wc_adm_access_t *adm_access */
   apr_hash_t *access_cache;
 
+  /* Whether the database carries a CHANGE_JOURNAL table maintained by an
+     external file system watcher.  Detected lazily; svn_tristate_unknown
+     until somebody asks. */
+  svn_tristate_t change_journal;
+
 } svn_wc__db_wcroot_t;
 
 
@@ -130,10 +147,19 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
                              apr_pool_t *scratch_pool);
 
 
+/* Return the interned copy of RELPATH from DB->RELPATH_ATOMS, adding it
+   first if necessary.  The result is allocated in DB->STATE_POOL and is
+   the same pointer for all equal relpaths passed in for this DB. */
+const char *
+svn_wc__db_intern_relpath(svn_wc__db_t *db,
+                          const char *relpath);
+
 /* For a given LOCAL_ABSPATH, figure out what sqlite database (WCROOT) to
    use and the RELPATH within that wcroot.
 
-   *LOCAL_RELPATH will be allocated within RESULT_POOL. Temporary allocations
+   *LOCAL_RELPATH will be an interned string allocated in DB->STATE_POOL,
+   see svn_wc__db_intern_relpath().  It remains valid for as long as DB
+   is open, regardless of RESULT_POOL.  Temporary allocations
    will be made in SCRATCH_POOL.
 
    *WCROOT will be allocated within DB->STATE_POOL.
@@ -155,7 +181,8 @@ svn_wc__db_verify_no_work(svn_sqlite__db_t *sdb);
 /* Assert that the given WCROOT is usable.
    NOTE: the expression is multiply-evaluated!!  */
 #define VERIFY_USABLE_WCROOT(wcroot)  SVN_ERR_ASSERT(               \
-    (wcroot) != NULL && (wcroot)->format == SVN_WC__VERSION)
+    (wcroot) != NULL && ((wcroot)->format == SVN_WC__VERSION        \
+                         || (wcroot)->format == SVN_WC__HAS_SETTINGS))
 
 /* Check if the WCROOT is usable for light db operations such as path
    calculations */
@@ -198,7 +225,9 @@ svn_wc__db_util_fetch_wc_id(apr_int64_t *wc_id,
 /* Open a connection in *SDB to the WC database found in the WC metadata
  * directory inside DIR_ABSPATH, having the filename SDB_FNAME.
  *
- * SMODE, EXCLUSIVE and TIMEOUT are passed to svn_sqlite__open().
+ * SMODE, EXCLUSIVE and TIMEOUT are passed to svn_sqlite__open().  If
+ * WAL_MODE is set (and EXCLUSIVE is not), the database is switched to
+ * write-ahead logging with relaxed synchronization after opening.
  *
  * Register MY_STATEMENTS, or if that is null, the default set of WC DB
  * statements, as the set of statements to be prepared now and executed
@@ -211,6 +240,7 @@ svn_wc__db_util_open_db(svn_sqlite__db_t **sdb,
                         const char *sdb_fname,
                         svn_sqlite__mode_t smode,
                         svn_boolean_t exclusive,
+                        svn_boolean_t wal_mode,
                         apr_int32_t timeout,
                         const char *const *my_statements,
                         apr_pool_t *result_pool,
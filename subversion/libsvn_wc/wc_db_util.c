@@ -115,6 +115,7 @@ svn_wc__db_util_open_db(svn_sqlite__db_t **sdb,
                         const char *sdb_fname,
                         svn_sqlite__mode_t smode,
                         svn_boolean_t exclusive,
+                        svn_boolean_t wal_mode,
                         apr_int32_t timeout,
                         const char *const *my_statements,
                         apr_pool_t *result_pool,
@@ -144,6 +145,8 @@ svn_wc__db_util_open_db(svn_sqlite__db_t **sdb,
 
   if (exclusive)
     SVN_ERR(svn_sqlite__exec_statements(*sdb, STMT_PRAGMA_LOCKING_MODE));
+  else if (wal_mode)
+    SVN_ERR(svn_sqlite__exec_statements(*sdb, STMT_PRAGMA_WAL_MODE));
 
   SVN_ERR(svn_sqlite__create_scalar_function(*sdb, "relpath_depth", 1,
                                              TRUE /* deterministic */,
@@ -232,6 +232,7 @@ svn_wc__db_open(svn_wc__db_t **db,
   (*db)->verify_format = !open_without_upgrade;
   (*db)->enforce_empty_wq = enforce_empty_wq;
   (*db)->dir_data = apr_hash_make(result_pool);
+  (*db)->relpath_atoms = apr_hash_make(result_pool);
 
   (*db)->state_pool = result_pool;
 
@@ -240,6 +241,7 @@ svn_wc__db_open(svn_wc__db_t **db,
     {
       svn_error_t *err;
       svn_boolean_t sqlite_exclusive = FALSE;
+      svn_boolean_t sqlite_wal = FALSE;
       apr_int64_t timeout;
 
       err = svn_config_get_bool(config, &sqlite_exclusive,
@@ -253,6 +255,17 @@ svn_wc__db_open(svn_wc__db_t **db,
       else
         (*db)->exclusive = sqlite_exclusive;
 
+      err = svn_config_get_bool(config, &sqlite_wal,
+                                SVN_CONFIG_SECTION_WORKING_COPY,
+                                SVN_CONFIG_OPTION_SQLITE_WAL,
+                                FALSE);
+      if (err)
+        {
+          svn_error_clear(err);
+        }
+      else
+        (*db)->wal_mode = sqlite_wal;
+
       err = svn_config_get_int64(config, &timeout,
                                  SVN_CONFIG_SECTION_WORKING_COPY,
                                  SVN_CONFIG_OPTION_SQLITE_BUSY_TIMEOUT,
@@ -320,8 +333,10 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
         svn_dirent_local_style(wcroot_abspath, scratch_pool), format);
     }
 
-  /* If this working copy is from a future version, then bail out.  */
-  if (format > SVN_WC__VERSION)
+  /* If this working copy is from a future version, then bail out.
+     Format SVN_WC__HAS_SETTINGS marks a working copy whose pristine
+     store has been dehydrated; we can handle those. */
+  if (format > SVN_WC__HAS_SETTINGS)
     {
       return svn_error_createf(
         SVN_ERR_WC_UNSUPPORTED_FORMAT, NULL,
@@ -377,6 +392,7 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
   (*wcroot)->owned_locks = apr_array_make(result_pool, 8,
                                           sizeof(svn_wc__db_wclock_t));
   (*wcroot)->access_cache = apr_hash_make(result_pool);
+  (*wcroot)->change_journal = svn_tristate_unknown;
 
   /* SDB will be NULL for pre-NG working copies. We only need to run a
      cleanup when the SDB is present.  */
@@ -422,6 +438,22 @@ compute_relpath(const svn_wc__db_wcroot_t *wcroot,
 }
 
 
+const char *
+svn_wc__db_intern_relpath(svn_wc__db_t *db,
+                          const char *relpath)
+{
+  const char *atom = svn_hash_gets(db->relpath_atoms, relpath);
+
+  if (atom == NULL)
+    {
+      atom = apr_pstrdup(db->state_pool, relpath);
+      svn_hash_sets(db->relpath_atoms, atom, atom);
+    }
+
+  return atom;
+}
+
+
 /* Return in *LINK_TARGET_ABSPATH the absolute path the symlink at
  * LOCAL_ABSPATH is pointing to. Perform all allocations in POOL. */
 static svn_error_t *
@@ -543,9 +575,9 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
       /* ### validate SMODE against how we opened wcroot->sdb? and against
          ### DB->mode? (will we record per-dir mode?)  */
 
-      /* ### for most callers, we could pass NULL for result_pool.  */
-      *local_relpath = compute_relpath(probe_wcroot, local_abspath,
-                                       result_pool);
+      *local_relpath = svn_wc__db_intern_relpath(
+                         db, compute_relpath(probe_wcroot, local_abspath,
+                                             NULL));
 
       return SVN_NO_ERROR;
     }
@@ -579,9 +611,10 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
           /* Stashed directory's local_relpath + basename. */
           dir_relpath = compute_relpath(probe_wcroot, local_dir_abspath,
                                         NULL);
-          *local_relpath = svn_relpath_join(dir_relpath,
-                                            build_relpath,
-                                            result_pool);
+          *local_relpath = svn_wc__db_intern_relpath(
+                             db, svn_relpath_join(dir_relpath,
+                                                  build_relpath,
+                                                  scratch_pool));
           return SVN_NO_ERROR;
         }
 
@@ -641,7 +674,8 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
              as the filesystem allows. */
           err = svn_wc__db_util_open_db(&sdb, local_abspath, SDB_FILE,
                                         svn_sqlite__mode_readwrite,
-                                        db->exclusive, db->timeout, NULL,
+                                        db->exclusive, db->wal_mode,
+                                        db->timeout, NULL,
                                         db->state_pool, scratch_pool);
           if (err == NULL)
             {
@@ -869,7 +903,9 @@ try_symlink_as_dir:
       dir_relpath = compute_relpath(*wcroot, local_dir_abspath, NULL);
 
       /* And the result local_relpath may include a filename.  */
-      *local_relpath = svn_relpath_join(dir_relpath, build_relpath, result_pool);
+      *local_relpath = svn_wc__db_intern_relpath(
+                         db, svn_relpath_join(dir_relpath, build_relpath,
+                                              scratch_pool));
     }
 
   if (kind == svn_node_symlink)
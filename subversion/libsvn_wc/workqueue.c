@@ -21,6 +21,9 @@
  * ====================================================================
  */
 
+#define APR_WANT_MEMFUNC
+#include <apr_want.h>
+
 #include <apr_pools.h>
 
 #include "svn_private_config.h"
@@ -68,6 +71,7 @@ typedef struct work_item_baton_t work_item_baton_t;
 
 struct work_item_dispatch {
   const char *name;
+  apr_size_t name_len;
   svn_error_t *(*func)(work_item_baton_t *wqb,
                        svn_wc__db_t *db,
                        const svn_skel_t *work_item,
@@ -476,6 +480,7 @@ run_file_install(work_item_baton_t *wqb,
   const svn_checksum_t *checksum;
   apr_hash_t *props;
   apr_time_t changed_date;
+  svn_boolean_t cloned = FALSE;
 
   local_relpath = apr_pstrmemdup(scratch_pool, arg1->data, arg1->len);
   SVN_ERR(svn_wc__db_from_relpath(&local_abspath, db, wri_abspath,
@@ -552,6 +557,11 @@ run_file_install(work_item_baton_t *wqb,
       return SVN_NO_ERROR;
     }
 
+  /* Where is the Right Place to put a temp file in this working copy?  */
+  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir_abspath,
+                                         db, wcroot_abspath,
+                                         scratch_pool, scratch_pool));
+
   if (svn_subst_translation_required(style, eol, keywords,
                                      FALSE /* special */,
                                      TRUE /* force_eol_check */))
@@ -563,30 +573,52 @@ run_file_install(work_item_baton_t *wqb,
                                                TRUE /* expand */,
                                                scratch_pool);
     }
+  else
+    {
+      /* The working file will be byte-for-byte identical to the source.
+         On filesystems with copy-on-write support, clone it into place
+         and share the data blocks instead of duplicating them.  */
+      SVN_ERR(svn_io__clone_file(&cloned, local_abspath, source_abspath,
+                                 temp_dir_abspath, scratch_pool));
+
+      /* Without cloning support, patch an existing working file in
+         place, rewriting only the blocks that changed.  For a small
+         change to a huge binary this writes megabytes instead of
+         gigabytes.  Giving up mid-file is safe: this work item stays
+         queued until it has run to completion, so cleanup re-installs
+         the file from the pristine.  */
+      if (! cloned)
+        SVN_ERR(svn_io__copy_file_differential(&cloned, local_abspath,
+                                               source_abspath,
+                                               scratch_pool));
 
-  /* Where is the Right Place to put a temp file in this working copy?  */
-  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir_abspath,
-                                         db, wcroot_abspath,
-                                         scratch_pool, scratch_pool));
+      if (cloned)
+        SVN_ERR(svn_stream_close(src_stream));
+    }
 
-  /* Translate to a temporary file. We don't want the user seeing a partial
-     file, nor let them muck with it while we translate. We may also need to
-     get its TRANSLATED_SIZE before the user can monkey it.  */
-  SVN_ERR(svn_stream__create_for_install(&dst_stream, temp_dir_abspath,
-                                         scratch_pool, scratch_pool));
+  if (! cloned)
+    {
+      /* Translate to a temporary file. We don't want the user seeing a
+         partial file, nor let them muck with it while we translate. We may
+         also need to get its TRANSLATED_SIZE before the user can monkey
+         it.  */
+      SVN_ERR(svn_stream__create_for_install(&dst_stream, temp_dir_abspath,
+                                             scratch_pool, scratch_pool));
 
-  /* Copy from the source to the dest, translating as we go. This will also
-     close both streams.  */
-  SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
-                           cancel_func, cancel_baton,
-                           scratch_pool));
+      /* Copy from the source to the dest, translating as we go. This will
+         also close both streams.  */
+      SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
+                               cancel_func, cancel_baton,
+                               scratch_pool));
 
-  /* All done. Move the file into place.  */
-  /* With a single db we might want to install files in a missing directory.
-     Simply trying this scenario on error won't do any harm and at least
-     one user reported this problem on IRC. */
-  SVN_ERR(svn_stream__install_stream(dst_stream, local_abspath,
-                                     TRUE /* make_parents*/, scratch_pool));
+      /* All done. Move the file into place.  */
+      /* With a single db we might want to install files in a missing
+         directory. Simply trying this scenario on error won't do any harm
+         and at least one user reported this problem on IRC. */
+      SVN_ERR(svn_stream__install_stream(dst_stream, local_abspath,
+                                         TRUE /* make_parents*/,
+                                         scratch_pool));
+    }
 
   /* Tweak the on-disk file according to its properties.  */
 #ifndef WIN32
@@ -1384,30 +1416,37 @@ run_set_property_conflict_marker(work_item_baton_t *wqb,
 
 /* ------------------------------------------------------------------------ */
 
+/* The operation-name lengths are precomputed so that dispatching does
+   not recompute them for every table entry of every replayed item.  */
+#define WQ_OP(op, func) { op, sizeof(op) - 1, func }
+
 static const struct work_item_dispatch dispatch_table[] = {
-  { OP_FILE_COMMIT, run_file_commit },
-  { OP_FILE_INSTALL, run_file_install },
-  { OP_FILE_REMOVE, run_file_remove },
-  { OP_FILE_MOVE, run_file_move },
-  { OP_FILE_COPY_TRANSLATED, run_file_copy_translated },
-  { OP_SYNC_FILE_FLAGS, run_sync_file_flags },
-  { OP_PREJ_INSTALL, run_prej_install },
-  { OP_DIRECTORY_REMOVE, run_dir_remove },
-  { OP_DIRECTORY_INSTALL, run_dir_install },
+  WQ_OP(OP_FILE_COMMIT, run_file_commit),
+  WQ_OP(OP_FILE_INSTALL, run_file_install),
+  WQ_OP(OP_FILE_REMOVE, run_file_remove),
+  WQ_OP(OP_FILE_MOVE, run_file_move),
+  WQ_OP(OP_FILE_COPY_TRANSLATED, run_file_copy_translated),
+  WQ_OP(OP_SYNC_FILE_FLAGS, run_sync_file_flags),
+  WQ_OP(OP_PREJ_INSTALL, run_prej_install),
+  WQ_OP(OP_DIRECTORY_REMOVE, run_dir_remove),
+  WQ_OP(OP_DIRECTORY_INSTALL, run_dir_install),
 
   /* Upgrade steps */
-  { OP_POSTUPGRADE, run_postupgrade },
+  WQ_OP(OP_POSTUPGRADE, run_postupgrade),
 
   /* Legacy workqueue items. No longer created */
-  { OP_BASE_REMOVE, run_base_remove },
-  { OP_RECORD_FILEINFO, run_record_fileinfo },
-  { OP_TMP_SET_TEXT_CONFLICT_MARKERS, run_set_text_conflict_markers },
-  { OP_TMP_SET_PROPERTY_CONFLICT_MARKER, run_set_property_conflict_marker },
+  WQ_OP(OP_BASE_REMOVE, run_base_remove),
+  WQ_OP(OP_RECORD_FILEINFO, run_record_fileinfo),
+  WQ_OP(OP_TMP_SET_TEXT_CONFLICT_MARKERS, run_set_text_conflict_markers),
+  WQ_OP(OP_TMP_SET_PROPERTY_CONFLICT_MARKER,
+        run_set_property_conflict_marker),
 
   /* Sentinel.  */
   { NULL }
 };
 
+#undef WQ_OP
+
 struct work_item_baton_t
 {
   apr_pool_t *result_pool; /* Pool to allocate result in */
@@ -1427,12 +1466,16 @@ dispatch_work_item(work_item_baton_t *wqb,
                    void *cancel_baton,
                    apr_pool_t *scratch_pool)
 {
+  const svn_skel_t *operation = work_item->children;
   const struct work_item_dispatch *scan;
 
   /* Scan the dispatch table for a function to handle this work item.  */
   for (scan = &dispatch_table[0]; scan->name != NULL; ++scan)
     {
-      if (svn_skel__matches_atom(work_item->children, scan->name))
+      if (operation != NULL
+          && operation->is_atom
+          && operation->len == scan->name_len
+          && memcmp(operation->data, scan->name, scan->name_len) == 0)
         {
 
 #ifdef SVN_DEBUG_WORK_QUEUE
@@ -1482,6 +1525,7 @@ svn_wc__wq_run(svn_wc__db_t *db,
                apr_pool_t *scratch_pool)
 {
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_pool_t *itempool = svn_pool_create(scratch_pool);
   apr_uint64_t last_id = 0;
   work_item_baton_t wib = { 0 };
   wib.result_pool = svn_pool_create(scratch_pool);
@@ -1502,66 +1546,72 @@ svn_wc__wq_run(svn_wc__db_t *db,
 
   while (TRUE)
     {
-      apr_uint64_t id;
-      svn_skel_t *work_item;
-      svn_error_t *err;
+      apr_array_header_t *items;
+      int i;
 
       svn_pool_clear(iterpool);
 
-      if (! wib.used)
-        {
-          /* Make sure to do this *early* in the loop iteration. There may
-             be a LAST_ID that needs to be marked as completed, *before* we
-             start worrying about anything else.  */
-          SVN_ERR(svn_wc__db_wq_fetch_next(&id, &work_item, db, wri_abspath,
-                                           last_id, iterpool, iterpool));
-        }
-      else
-        {
-          /* Make sure to do this *early* in the loop iteration. There may
-             be a LAST_ID that needs to be marked as completed, *before* we
-             start worrying about anything else.  */
-          SVN_ERR(svn_wc__db_wq_record_and_fetch_next(&id, &work_item,
-                                                      db, wri_abspath,
-                                                      last_id, wib.record_map,
-                                                      iterpool,
-                                                      wib.result_pool));
+      /* Make sure to do this *early* in the loop iteration. There may
+         be a LAST_ID (and a whole range of items before it) that needs
+         to be marked as completed, *before* we start worrying about
+         anything else.
+
+         Fetching a chunk of work items per transaction keeps the number
+         of wc_db round trips (and journal flushes) proportional to the
+         chunk size instead of the queue length.  */
+      SVN_ERR(svn_wc__db_wq_fetch_batch(&items, db, wri_abspath, last_id,
+                                        wib.used ? wib.record_map : NULL,
+                                        iterpool, iterpool));
 
+      if (wib.used)
+        {
           svn_pool_clear(wib.result_pool);
           wib.record_map = NULL;
           wib.used = FALSE;
         }
 
-      /* Stop work queue processing, if requested. A future 'svn cleanup'
-         should be able to continue the processing. Note that we may
-         have WORK_ITEM, but we'll just skip its processing for now.  */
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
-
-      /* If we have a WORK_ITEM, then process the sucker. Otherwise,
+      /* If we have work items, then process the suckers. Otherwise,
          we're done.  */
-      if (work_item == NULL)
+      if (items->nelts == 0)
         break;
 
-      err = dispatch_work_item(&wib, db, wri_abspath, work_item,
-                               cancel_func, cancel_baton, iterpool);
-      if (err)
+      for (i = 0; i < items->nelts; i++)
         {
-          const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
-
-          return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
-                                   _("Failed to run the WC DB work queue "
-                                     "associated with '%s', work item %d %s"),
-                                   svn_dirent_local_style(wri_abspath,
-                                                          scratch_pool),
-                                   (int)id, skel);
+          const svn_wc__db_wq_item_t *item
+            = APR_ARRAY_IDX(items, i, svn_wc__db_wq_item_t *);
+          svn_error_t *err;
+
+          svn_pool_clear(itempool);
+
+          /* Stop work queue processing, if requested. A future 'svn cleanup'
+             should be able to continue the processing. Note that the items
+             we fetched but did not run simply stay queued.  */
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+
+          err = dispatch_work_item(&wib, db, wri_abspath, item->work_item,
+                                   cancel_func, cancel_baton, itempool);
+          if (err)
+            {
+              const char *skel = svn_skel__unparse(item->work_item,
+                                                   scratch_pool)->data;
+
+              return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
+                                       _("Failed to run the WC DB work queue "
+                                         "associated with '%s', work item "
+                                         "%d %s"),
+                                       svn_dirent_local_style(wri_abspath,
+                                                              scratch_pool),
+                                       (int)item->id, skel);
+            }
+
+          /* The work item finished without error. Mark it (and any items
+             queued before it) completed in the next fetch.  */
+          last_id = item->id;
         }
-
-      /* The work item finished without error. Mark it completed
-         in the next loop.  */
-      last_id = id;
     }
 
+  svn_pool_destroy(itempool);
   svn_pool_destroy(iterpool);
   return SVN_NO_ERROR;
 }
@@ -36,6 +36,7 @@
 #include "svn_repos.h"
 #include "svn_path.h"
 #include "svn_xml.h"
+#include "private/svn_cache.h"
 #include "private/svn_dav_protocol.h"
 #include "private/svn_skel.h"
 #include "mod_authz_svn.h"
@@ -336,6 +337,15 @@ svn_boolean_t dav_svn__get_txdelta_cache_flag(request_rec *r);
 /* for the repository referred to by this request, is fulltext caching active? */
 svn_boolean_t dav_svn__get_fulltext_cache_flag(request_rec *r);
 
+/* for the repository referred to by this request, is response body caching
+   active? */
+svn_boolean_t dav_svn__get_body_cache_flag(request_rec *r);
+
+/* Return the process-wide cache of GET response bodies, keyed by content
+   checksum, or NULL if body caching is disabled for this request or no
+   in-memory cache is available.  See dav_svn__get_body_cache_flag(). */
+svn_cache__t *dav_svn__get_body_cache(request_rec *r);
+
 /* for the repository referred to by this request, is revprop caching active? */
 svn_boolean_t dav_svn__get_revprop_cache_flag(request_rec *r);
 
@@ -535,6 +545,13 @@ int dav_svn__status(request_rec *r);
 
 /*** repos.c ***/
 
+/* Initialize the per-process cache of open repository handles.  To be
+   called once per child process, with a pool of child lifetime.  If
+   this is never called, handle pooling is disabled and repositories
+   are opened per connection. */
+void
+dav_svn__init_repos_handle_cache(apr_pool_t *pool);
+
 /* generate an ETag for RESOURCE and return it, allocated in POOL. */
 const char *
 dav_svn__getetag(const dav_resource *resource, apr_pool_t *pool);
@@ -705,6 +722,7 @@ static const dav_report_elem dav_svn__reports_list[] = {
   { SVN_XML_NAMESPACE, SVN_DAV__MERGEINFO_REPORT },
   { SVN_XML_NAMESPACE, SVN_DAV__INHERITED_PROPS_REPORT },
   { SVN_XML_NAMESPACE, "list-report" },
+  { SVN_XML_NAMESPACE, "proplist-report" },
   { NULL, NULL },
 };
 
@@ -762,6 +780,11 @@ dav_svn__list_report(const dav_resource *resource,
                      const apr_xml_doc *doc,
                      dav_svn__output *output);
 
+dav_error *
+dav_svn__proplist_report(const dav_resource *resource,
+                         const apr_xml_doc *doc,
+                         dav_svn__output *output);
+
 /*** posts/ ***/
 
 /* The various POST handlers, defined in posts/, and used by repos.c.  */
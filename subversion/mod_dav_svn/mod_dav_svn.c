@@ -107,6 +107,7 @@ typedef struct dir_conf_t {
   enum conf_flag revprop_cache;      /* whether to enable revprop caching */
   enum conf_flag nodeprop_cache;     /* whether to enable nodeprop caching */
   enum conf_flag block_read;         /* whether to enable block read mode */
+  enum conf_flag body_cache;         /* whether to cache GET response bodies */
   const char *hooks_env;             /* path to hook script env config file */
 } dir_conf_t;
 
@@ -153,6 +154,14 @@ init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
   return OK;
 }
 
+/* Implements the child_init hook.  PCHILD has the lifetime of the
+   child process. */
+static void
+child_init(apr_pool_t *pchild, server_rec *s)
+{
+  dav_svn__init_repos_handle_cache(pchild);
+}
+
 static svn_error_t *
 malfunction_handler(svn_boolean_t can_return,
                     const char *file, int line,
@@ -286,6 +295,7 @@ merge_dir_config(apr_pool_t *p, void *base, void *overrides)
   newconf->revprop_cache = INHERIT_VALUE(parent, child, revprop_cache);
   newconf->nodeprop_cache = INHERIT_VALUE(parent, child, nodeprop_cache);
   newconf->block_read = INHERIT_VALUE(parent, child, block_read);
+  newconf->body_cache = INHERIT_VALUE(parent, child, body_cache);
   newconf->root_dir = INHERIT_VALUE(parent, child, root_dir);
   newconf->hooks_env = INHERIT_VALUE(parent, child, hooks_env);
 
@@ -611,6 +621,19 @@ SVNBlockRead_cmd(cmd_parms *cmd, void *config, int arg)
   return NULL;
 }
 
+static const char *
+SVNCacheResponseBodies_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  dir_conf_t *conf = config;
+
+  if (arg)
+    conf->body_cache = CONF_FLAG_ON;
+  else
+    conf->body_cache = CONF_FLAG_OFF;
+
+  return NULL;
+}
+
 static const char *
 SVNInMemoryCacheSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -1001,6 +1024,18 @@ dav_svn__get_fulltext_cache_flag(request_rec *r)
 }
 
 
+svn_boolean_t
+dav_svn__get_body_cache_flag(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* response body caching is disabled by default. */
+  return get_conf_flag(conf->body_cache, FALSE);
+}
+
+
 svn_boolean_t
 dav_svn__get_revprop_cache_flag(request_rec *r)
 {
@@ -1382,6 +1417,14 @@ static const command_rec cmds[] =
                "if sufficient in-memory cache is available"
                "(default is On)."),
 
+  /* per directory/location */
+  AP_INIT_FLAG("SVNCacheResponseBodies", SVNCacheResponseBodies_cmd, NULL,
+               ACCESS_CONF|RSRC_CONF,
+               "serves repeated GET requests for file contents directly "
+               "from the in-memory cache (see SVNInMemoryCacheSize), "
+               "without touching the repository layer "
+               "(default is Off)."),
+
   /* per directory/location */
   AP_INIT_FLAG("SVNBlockRead", SVNBlockRead_cmd, NULL,
                ACCESS_CONF|RSRC_CONF,
@@ -1436,6 +1479,7 @@ register_hooks(apr_pool_t *pconf)
 {
   ap_hook_pre_config(init_dso, NULL, NULL, APR_HOOK_REALLY_FIRST);
   ap_hook_post_config(init, NULL, NULL, APR_HOOK_MIDDLE);
+  ap_hook_child_init(child_init, NULL, NULL, APR_HOOK_MIDDLE);
 
   /* our provider */
   dav_register_provider(pconf, "svn", &provider);
@@ -39,6 +39,7 @@
 
 #include "private/svn_log.h"
 #include "private/svn_fspath.h"
+#include "private/svn_repos_private.h"
 
 #include "../dav_svn.h"
 
@@ -369,6 +370,8 @@ dav_svn__log_report(const dav_resource *resource,
   int limit = 0;
   int ns;
   svn_boolean_t seen_revprop_element;
+  const char *resume_token = NULL;
+  const char *next_resume_token = NULL;
 
   /* These get determined from the request document. */
   svn_revnum_t start = SVN_INVALID_REVNUM;   /* defaults to HEAD */
@@ -431,6 +434,8 @@ dav_svn__log_report(const dav_resource *resource,
         include_merged_revisions = TRUE; /* presence indicates positivity */
       else if (strcmp(child->name, "encode-binary-props") == 0)
         lrb.encode_binary_props = TRUE; /* presence indicates positivity */
+      else if (strcmp(child->name, "resume-token") == 0)
+        resume_token = dav_xml_get_cdata(child, resource->pool, 1);
       else if (strcmp(child->name, "all-revprops") == 0)
         {
           revprops = NULL; /* presence indicates fetch all revprops */
@@ -504,8 +509,10 @@ dav_svn__log_report(const dav_resource *resource,
      that the header has already been sent (checking the needs_header
      flag in our log_receiver_baton structure). */
 
-  /* Send zero or more log items. */
-  serr = svn_repos_get_logs5(repos->repos,
+  /* Send zero or more log items.  A resume token from an earlier,
+     otherwise identical request continues that walk without re-scanning
+     the pages already sent. */
+  serr = svn_repos__get_logs_resumable(repos->repos,
                              paths,
                              start,
                              end,
@@ -513,6 +520,8 @@ dav_svn__log_report(const dav_resource *resource,
                              strict_node_history,
                              include_merged_revisions,
                              revprops,
+                             resume_token,
+                             &next_resume_token,
                              dav_svn__authz_read_func(&arb),
                              &arb,
                              discover_changed_paths ? log_change_receiver
@@ -520,6 +529,7 @@ dav_svn__log_report(const dav_resource *resource,
                              &lrb,
                              log_revision_receiver,
                              &lrb,
+                             resource->pool,
                              resource->pool);
   if (serr)
     {
@@ -536,6 +546,24 @@ dav_svn__log_report(const dav_resource *resource,
       goto cleanup;
     }
 
+  /* Tell the client where the next page starts; clients that do not
+     know the element simply ignore it. */
+  if (next_resume_token)
+    {
+      if ((serr = dav_svn__brigade_printf(lrb.bb, lrb.output,
+                                          "<S:resume-token>%s"
+                                          "</S:resume-token>" DEBUG_CR,
+                                          apr_xml_quote_string(
+                                            resource->pool,
+                                            next_resume_token, 0))))
+        {
+          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                      "Error writing REPORT response.",
+                                      resource->pool);
+          goto cleanup;
+        }
+    }
+
   if ((serr = dav_svn__brigade_puts(lrb.bb, lrb.output,
                                     "</S:log-report>" DEBUG_CR)))
     {
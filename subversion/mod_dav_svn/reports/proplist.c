@@ -0,0 +1,254 @@
+/*
+ * proplist.c: mod_dav_svn REPORT handler for recursive property listings
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_strings.h>
+#include <apr_xml.h>
+
+#include <mod_dav.h>
+
+#include "svn_repos.h"
+#include "svn_string.h"
+#include "svn_types.h"
+#include "svn_base64.h"
+#include "svn_xml.h"
+#include "svn_path.h"
+#include "svn_dav.h"
+#include "svn_pools.h"
+#include "svn_props.h"
+
+#include "private/svn_repos_private.h"
+#include "private/svn_log.h"
+#include "private/svn_fspath.h"
+
+#include "../dav_svn.h"
+
+/* Baton type to be used with proplist_receiver. */
+typedef struct proplist_receiver_baton_t
+{
+  /* this buffers the output for a bit and is automatically flushed,
+     at appropriate times, by the Apache filter system. */
+  apr_bucket_brigade *bb;
+
+  /* where to deliver the output */
+  dav_svn__output *output;
+
+  /* Whether we've written the <S:proplist-report> header.  Allows for
+     lazy writes to support mod_dav-based error handling. */
+  svn_boolean_t needs_header;
+} proplist_receiver_baton_t;
+
+
+/* If PRB->needs_header is true, send the "<S:proplist-report>" start
+   element and set PRB->needs_header to zero.  Else do nothing. */
+static svn_error_t *
+maybe_send_header(proplist_receiver_baton_t *prb)
+{
+  if (prb->needs_header)
+    {
+      SVN_ERR(dav_svn__brigade_puts(prb->bb, prb->output,
+                                    DAV_XML_HEADER DEBUG_CR
+                                    "<S:proplist-report xmlns:S=\""
+                                    SVN_XML_NAMESPACE "\" "
+                                    "xmlns:D=\"DAV:\">" DEBUG_CR));
+      prb->needs_header = FALSE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Implements svn_repos__proplist_receiver_t, sending PATH, KIND and
+ * PROPS to the client.  BATON must be a proplist_receiver_baton_t. */
+static svn_error_t *
+proplist_receiver(const char *path,
+                  svn_node_kind_t kind,
+                  apr_hash_t *props,
+                  void *baton,
+                  apr_pool_t *pool)
+{
+  proplist_receiver_baton_t *b = baton;
+  apr_hash_index_t *hi;
+
+  SVN_ERR(maybe_send_header(b));
+
+  SVN_ERR(dav_svn__brigade_printf(b->bb, b->output,
+                                  "<S:item node-kind=\"%s\" path=\"%s\">"
+                                  DEBUG_CR,
+                                  svn_node_kind_to_word(kind),
+                                  apr_xml_quote_string(pool, path, 1)));
+
+  for (hi = apr_hash_first(pool, props); hi; hi = apr_hash_next(hi))
+    {
+      const char *propname = apr_hash_this_key(hi);
+      svn_string_t *propval = apr_hash_this_val(hi);
+
+      SVN_ERR(dav_svn__brigade_printf(
+                b->bb, b->output,
+                "<S:propname>%s</S:propname>" DEBUG_CR,
+                apr_xml_quote_string(pool, propname, 0)));
+
+      if (svn_xml_is_xml_safe(propval->data, propval->len))
+        {
+          svn_stringbuf_t *tmp = NULL;
+          svn_xml_escape_cdata_string(&tmp, propval, pool);
+          SVN_ERR(dav_svn__brigade_printf(
+                    b->bb, b->output,
+                    "<S:propval>%s</S:propval>" DEBUG_CR, tmp->data));
+        }
+      else
+        {
+          const char *encoded
+            = svn_base64_encode_string2(propval, TRUE, pool)->data;
+          SVN_ERR(dav_svn__brigade_printf(
+                    b->bb, b->output,
+                    "<S:propval encoding=\"base64\">%s</S:propval>"
+                    DEBUG_CR, encoded));
+        }
+    }
+
+  SVN_ERR(dav_svn__brigade_puts(b->bb, b->output, "</S:item>" DEBUG_CR));
+
+  return SVN_NO_ERROR;
+}
+
+dav_error *
+dav_svn__proplist_report(const dav_resource *resource,
+                         const apr_xml_doc *doc,
+                         dav_svn__output *output)
+{
+  svn_error_t *serr;
+  dav_error *derr = NULL;
+  apr_xml_elem *child;
+  proplist_receiver_baton_t prb = { 0 };
+  dav_svn__authz_read_baton arb;
+  const dav_svn_repos *repos = resource->info->repos;
+  int ns;
+  const char *full_path = NULL;
+  svn_fs_root_t *root;
+  svn_depth_t depth = svn_depth_unknown;
+
+  /* These get determined from the request document. */
+  svn_revnum_t rev = SVN_INVALID_REVNUM;     /* defaults to HEAD */
+
+  /* Sanity check. */
+  if (!resource->info->repos_path)
+    return dav_svn__new_error(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                              "The request does not specify a repository path");
+  ns = dav_svn__find_ns(doc->namespaces, SVN_XML_NAMESPACE);
+  if (ns == -1)
+    {
+      return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                    "The request does not contain the 'svn:' "
+                                    "namespace, so it is not going to have "
+                                    "certain required elements");
+    }
+
+  for (child = doc->root->first_child; child != NULL; child = child->next)
+    {
+      /* if this element isn't one of ours, then skip it */
+      if (child->ns != ns)
+        continue;
+
+      else if (strcmp(child->name, "path") == 0)
+        {
+          const char *rel_path = dav_xml_get_cdata(child, resource->pool, 0);
+          if ((derr = dav_svn__test_canonical(rel_path, resource->pool)))
+            return derr;
+
+          /* Force REL_PATH to be a relative path, not an fspath. */
+          rel_path = svn_relpath_canonicalize(rel_path, resource->pool);
+
+          /* Append the REL_PATH to the base FS path to get an
+             absolute repository path. */
+          full_path = svn_fspath__join(resource->info->repos_path, rel_path,
+                                       resource->pool);
+        }
+      else if (strcmp(child->name, "revision") == 0)
+        rev = SVN_STR_TO_REV(dav_xml_get_cdata(child, resource->pool, 1));
+      else if (strcmp(child->name, "depth") == 0)
+        depth = svn_depth_from_word(dav_xml_get_cdata(child, resource->pool,
+                                                      1));
+      /* else unknown element; skip it */
+    }
+
+  if (! full_path)
+    {
+      return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                    "Request was missing the path argument");
+    }
+
+  /* Build authz read baton */
+  arb.r = resource->info->r;
+  arb.repos = resource->info->repos;
+
+  /* Build proplist receiver baton */
+  prb.bb = apr_brigade_create(resource->pool,  /* not the subpool! */
+                              dav_svn__output_get_bucket_alloc(output));
+  prb.output = output;
+  prb.needs_header = TRUE;
+
+  /* Fetch the root of the appropriate revision. */
+  serr = svn_fs_revision_root(&root, repos->fs, rev, resource->pool);
+  if (!serr)
+    {
+      /* Walk the tree and stream the property lists immediately. */
+      serr = svn_repos__proplist(root, full_path, depth,
+                                 dav_svn__authz_read_func(&arb), &arb,
+                                 proplist_receiver, &prb, NULL, NULL,
+                                 resource->pool);
+    }
+
+  if (serr)
+    {
+      derr = dav_svn__convert_err(serr, HTTP_BAD_REQUEST, NULL,
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  if ((serr = maybe_send_header(&prb)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error beginning REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  if ((serr = dav_svn__brigade_puts(prb.bb, prb.output,
+                                    "</S:proplist-report>" DEBUG_CR)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error ending REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+ cleanup:
+
+  dav_svn__operational_log(resource->info,
+                           svn_log__proplist(full_path, rev, depth,
+                                             resource->pool));
+
+  return dav_svn__final_flush_or_error(resource->info->r, prb.bb, output,
+                                       derr, resource->pool);
+}
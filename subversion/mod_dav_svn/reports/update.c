@@ -752,7 +752,16 @@ upd_open_file(const char *path,
 /* We have our own window handler and baton as a simple wrapper around
    the real handler (which converts txdelta windows to base64-encoded
    svndiff data).  The wrapper is responsible for sending the opening
-   and closing XML tags around the svndiff data. */
+   and closing XML tags around the svndiff data.
+
+   Note on threading: the whole report body -- FS traversal, svndiff
+   and base64 encoding, and XML generation -- is deliberately produced
+   on the request thread.  Bucket brigades, bucket allocators and the
+   request pool's allocator are not synchronized, and the authz
+   callbacks driven by the editor need the request_rec, so none of
+   this work can be handed to helper threads without copying every
+   window out of httpd's pool hierarchy first.  Measurements so far
+   have not justified that copy; revisit here if they ever do. */
 struct window_handler_baton
 {
   svn_boolean_t seen_first_window;  /* False until first window seen. */
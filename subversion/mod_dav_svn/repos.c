@@ -26,6 +26,7 @@
 #include <apr_strings.h>
 #include <apr_hash.h>
 #include <apr_lib.h>
+#include <apr_thread_mutex.h>
 
 #include <httpd.h>
 #include <http_request.h>
@@ -60,9 +61,15 @@
 
 #include "dav_svn.h"
 
+#include "svn_private_config.h"  /* for SVN_HAVE_ZSTD */
+
 
 #define DEFAULT_ACTIVITY_DB "dav/activities.d"
 
+/* Largest GET response body we bother to keep in the response body
+   cache; bigger texts would be evicted from the membuffer right away. */
+#define BODY_CACHE_MAX_ITEM_SIZE (4 * 1024 * 1024)
+
 
 struct dav_stream {
   const dav_resource *res;
@@ -1577,6 +1584,243 @@ cleanup_req_logging(void *data)
   return APR_SUCCESS;
 }
 
+
+/*** Per-process repository handle cache ***/
+
+/* A pooled repository handle.  While checked out, it is owned
+   exclusively by one connection; idle handles are linked into the
+   per-key free lists of the cache below. */
+typedef struct repos_handle_t
+{
+  /* The open repository, allocated in POOL below. */
+  svn_repos_t *repos;
+
+  /* Private pool of this handle; a subpool of the cache pool. */
+  apr_pool_t *pool;
+
+  /* Cache key: the FS path plus the FS config flags the repository was
+     opened with. */
+  const char *key;
+
+  /* Modification times of the repository's and the filesystem's format
+     file when the handle was opened.  A repository upgrade or a hotcopy
+     over the repository changes them and invalidates the handle. */
+  apr_time_t repos_format_mtime;
+  apr_time_t fs_format_mtime;
+
+  /* Next idle handle with the same key. */
+  struct repos_handle_t *next;
+} repos_handle_t;
+
+/* Head of the free list for one cache key.  Allocated in the cache
+   pool and never removed, so the cache's hash keys always stay valid
+   even when individual handles get destroyed. */
+typedef struct repos_handle_list_t
+{
+  repos_handle_t *head;
+} repos_handle_list_t;
+
+/* The cache.  Initialized once per child process from the child_init
+   hook; remains NULL if that hook did not run, in which case handle
+   pooling is simply disabled and we fall back to per-connection opens. */
+static apr_pool_t *handle_cache_pool = NULL;
+static apr_hash_t *handle_cache = NULL;  /* key -> repos_handle_list_t * */
+#if APR_HAS_THREADS
+static apr_thread_mutex_t *handle_cache_mutex = NULL;
+#endif
+
+/* Serialize access to HANDLE_CACHE and subpool creation from
+   HANDLE_CACHE_POOL. */
+static void
+handle_cache_lock(void)
+{
+#if APR_HAS_THREADS
+  if (handle_cache_mutex)
+    apr_thread_mutex_lock(handle_cache_mutex);
+#endif
+}
+
+static void
+handle_cache_unlock(void)
+{
+#if APR_HAS_THREADS
+  if (handle_cache_mutex)
+    apr_thread_mutex_unlock(handle_cache_mutex);
+#endif
+}
+
+void
+dav_svn__init_repos_handle_cache(apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  if (apr_thread_mutex_create(&handle_cache_mutex,
+                              APR_THREAD_MUTEX_DEFAULT, pool))
+    {
+      /* Without a mutex, the cache would not be safe under a threaded
+         MPM.  Leave it disabled. */
+      handle_cache_mutex = NULL;
+      return;
+    }
+#endif
+
+  handle_cache_pool = pool;
+  handle_cache = apr_hash_make(pool);
+}
+
+/* svn_fs_warning_callback_t for pooled handles that are not attached to
+   any connection.  The FS is idle then, so this should never fire; it
+   exists only so that an idle handle never points at a dead request or
+   connection. */
+static void
+log_warning_idle(void *baton, svn_error_t *err)
+{
+  /* There is no log context to write to. */
+}
+
+/* Set *REPOS_MTIME and *FS_MTIME to the modification times of the
+   format files of the repository at FS_PATH and of its filesystem,
+   respectively. */
+static svn_error_t *
+get_format_mtimes(apr_time_t *repos_mtime,
+                  apr_time_t *fs_mtime,
+                  const char *fs_path,
+                  apr_pool_t *scratch_pool)
+{
+  const svn_io_dirent2_t *dirent;
+
+  SVN_ERR(svn_io_stat_dirent2(&dirent,
+                              svn_dirent_join(fs_path, "format",
+                                              scratch_pool),
+                              FALSE, TRUE, scratch_pool, scratch_pool));
+  *repos_mtime = dirent->mtime;
+
+  SVN_ERR(svn_io_stat_dirent2(&dirent,
+                              svn_dirent_join(fs_path, "db/format",
+                                              scratch_pool),
+                              FALSE, TRUE, scratch_pool, scratch_pool));
+  *fs_mtime = dirent->mtime;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *HANDLE_P to an idle pooled handle for KEY, or to NULL if the
+   cache has none (or is disabled).  FS_PATH is the repository path that
+   KEY refers to.  Handles that fail the format-file generation check
+   are destroyed rather than returned. */
+static svn_error_t *
+checkout_repos_handle(repos_handle_t **handle_p,
+                      const char *key,
+                      const char *fs_path,
+                      apr_pool_t *scratch_pool)
+{
+  *handle_p = NULL;
+  if (handle_cache == NULL)
+    return SVN_NO_ERROR;
+
+  while (TRUE)
+    {
+      repos_handle_list_t *list;
+      repos_handle_t *handle;
+      apr_time_t repos_mtime, fs_mtime;
+      svn_error_t *err;
+
+      handle_cache_lock();
+      list = svn_hash_gets(handle_cache, key);
+      handle = list ? list->head : NULL;
+      if (handle)
+        list->head = handle->next;
+      handle_cache_unlock();
+
+      if (handle == NULL)
+        return SVN_NO_ERROR;
+
+      /* Generation check: the handle is only valid as long as the
+         format files are unchanged. */
+      err = get_format_mtimes(&repos_mtime, &fs_mtime, fs_path,
+                              scratch_pool);
+      if (!err
+          && repos_mtime == handle->repos_format_mtime
+          && fs_mtime == handle->fs_format_mtime)
+        {
+          *handle_p = handle;
+          return SVN_NO_ERROR;
+        }
+
+      svn_error_clear(err);
+      svn_pool_destroy(handle->pool);
+    }
+}
+
+/* Open a new pooled repository handle for FS_PATH, using a copy of
+   FS_CONFIG, and return it in *HANDLE_P.  KEY is the cache key the
+   handle will be filed under once it is returned to the cache. */
+static svn_error_t *
+open_repos_handle(repos_handle_t **handle_p,
+                  const char *key,
+                  const char *fs_path,
+                  apr_hash_t *fs_config,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *handle_pool;
+  repos_handle_t *handle;
+  svn_error_t *err;
+
+  handle_cache_lock();
+  handle_pool = svn_pool_create(handle_cache_pool);
+  handle_cache_unlock();
+
+  handle = apr_pcalloc(handle_pool, sizeof(*handle));
+  handle->pool = handle_pool;
+  handle->key = apr_pstrdup(handle_pool, key);
+
+  err = svn_repos_open3(&handle->repos, fs_path,
+                        apr_hash_copy(handle_pool, fs_config),
+                        handle_pool, scratch_pool);
+  if (!err)
+    err = get_format_mtimes(&handle->repos_format_mtime,
+                            &handle->fs_format_mtime, fs_path,
+                            scratch_pool);
+  if (err)
+    {
+      svn_pool_destroy(handle_pool);
+      return svn_error_trace(err);
+    }
+
+  *handle_p = handle;
+  return SVN_NO_ERROR;
+}
+
+/* Pool cleanup handler, registered on the connection pool of the
+   connection that checked out a pooled handle: detach the handle from
+   the dying connection and return it to the cache. */
+static apr_status_t
+return_repos_handle(void *data)
+{
+  repos_handle_t *handle = data;
+  repos_handle_list_t *list;
+
+  /* The connection's logging context and capability list are about to
+     be freed. */
+  svn_fs_set_warning_func(svn_repos_fs(handle->repos),
+                          log_warning_idle, NULL);
+  svn_error_clear(svn_repos_remember_client_capabilities(handle->repos,
+                                                         NULL));
+
+  handle_cache_lock();
+  list = svn_hash_gets(handle_cache, handle->key);
+  if (list == NULL)
+    {
+      list = apr_pcalloc(handle_cache_pool, sizeof(*list));
+      svn_hash_sets(handle_cache,
+                    apr_pstrdup(handle_cache_pool, handle->key), list);
+    }
+  handle->next = list->head;
+  list->head = handle;
+  handle_cache_unlock();
+
+  return APR_SUCCESS;
+}
+
 /* Helper func to construct a special 'parentpath' private resource. */
 static dav_error *
 get_parentpath_resource(request_rec *r,
@@ -1771,6 +2015,11 @@ static int sort_encoding_pref(const void *accept_rec1, const void *accept_rec2)
 
 static int get_svndiff_version(const struct accept_rec *rec)
 {
+#ifdef SVN_HAVE_ZSTD
+  /* Only consider emitting svndiff3 if we can actually encode zstd. */
+  if (strcmp(rec->name, "svndiff3") == 0)
+    return 3;
+#endif
   if (strcmp(rec->name, "svndiff2") == 0)
     return 2;
   else if (strcmp(rec->name, "svndiff1") == 0)
@@ -1796,6 +2045,7 @@ negotiate_encoding_prefs(request_rec *r, int *svndiff_version)
   apr_array_header_t *encoding_prefs;
   apr_array_header_t *svndiff_encodings;
   svn_boolean_t accepts_svndiff2 = FALSE;
+  svn_boolean_t accepts_svndiff3 = FALSE;
 
   encoding_prefs = do_header_line(r->pool,
                                   apr_table_get(r->headers_in,
@@ -1819,6 +2069,9 @@ negotiate_encoding_prefs(request_rec *r, int *svndiff_version)
 
       if (version == 2)
         accepts_svndiff2 = TRUE;
+
+      if (version == 3)
+        accepts_svndiff3 = TRUE;
     }
 
   if (dav_svn__get_compression_level(r) == 0)
@@ -1827,6 +2080,14 @@ negotiate_encoding_prefs(request_rec *r, int *svndiff_version)
        * svndiff0 format, which we assume is always supported. */
       *svndiff_version = 0;
     }
+  else if (accepts_svndiff3)
+    {
+      /* Prefer svndiff3 whenever the client can read it: it offers a
+       * compression ratio comparable to svndiff1's at a fraction of the
+       * CPU cost, independently of the configured compression level.
+       */
+      *svndiff_version = 3;
+    }
   else if (accepts_svndiff2 && dav_svn__get_compression_level(r) == 1)
     {
       /* Enable svndiff2 if the client can read it, and if the server-side
@@ -2431,6 +2692,9 @@ get_resource(request_rec *r,
   if (repos->repos == NULL)
     {
       const char *fs_type;
+      const char *handle_key;
+      repos_handle_t *handle = NULL;
+      svn_boolean_t reused_handle = FALSE;
 
       /* construct FS configuration parameters */
       fs_config = apr_hash_make(r->connection->pool);
@@ -2444,6 +2708,20 @@ get_resource(request_rec *r,
                     dav_svn__get_nodeprop_cache_flag(r) ? "1" :"0");
       svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_BLOCK_READ,
                     dav_svn__get_block_read_flag(r) ? "1" :"0");
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_PRIORITY, "high");
+
+      /* Key the per-process handle cache on the FS path plus the FS
+         config flags and the hooks environment, in case different
+         <Location>s address the same repository with different
+         settings. */
+      handle_key = apr_psprintf(r->pool, "%s:%d%d%d%d%d:%s", repos_key,
+                                dav_svn__get_txdelta_cache_flag(r) ? 1 : 0,
+                                dav_svn__get_fulltext_cache_flag(r) ? 1 : 0,
+                                dav_svn__get_revprop_cache_flag(r) ? 1 : 0,
+                                dav_svn__get_nodeprop_cache_flag(r) ? 1 : 0,
+                                dav_svn__get_block_read_flag(r) ? 1 : 0,
+                                dav_svn__get_hooks_env(r)
+                                  ? dav_svn__get_hooks_env(r) : "");
 
       /* Disallow BDB/event until issue 4157 is fixed. */
       if (!strcmp(ap_show_mpm(), "event"))
@@ -2464,8 +2742,29 @@ get_resource(request_rec *r,
       else
         serr = NULL;
 
-      /* open the FS */
+      /* Try to reuse an idle repository handle from the per-process
+         cache; open a new pooled handle on a cache miss.  This skips
+         re-reading the format and uuid files on every connection. */
       if (!serr)
+        serr = checkout_repos_handle(&handle, handle_key, fs_path, r->pool);
+      if (!serr && handle != NULL)
+        reused_handle = TRUE;
+      if (!serr && handle == NULL && handle_cache != NULL)
+        serr = open_repos_handle(&handle, handle_key, fs_path, fs_config,
+                                 r->pool);
+      if (!serr && handle != NULL)
+        {
+          repos->repos = handle->repos;
+
+          /* Hand the handle back to the cache when this connection
+             goes away. */
+          apr_pool_cleanup_register(r->connection->pool, handle,
+                                    return_repos_handle,
+                                    apr_pool_cleanup_null);
+        }
+
+      /* open the FS (fallback when handle pooling is disabled) */
+      if (!serr && repos->repos == NULL)
         serr = svn_repos_open3(&(repos->repos), fs_path, fs_config,
                                r->connection->pool, r->pool);
       if (serr != NULL)
@@ -2491,8 +2790,9 @@ get_resource(request_rec *r,
       apr_pool_userdata_set(repos->repos, repos_key,
                             NULL, r->connection->pool);
 
-      /* Store the capabilities of the current connection, making sure
-         to use the same pool repos->repos itself was created in. */
+      /* Store the capabilities of the current connection.  For pooled
+         handles, return_repos_handle() clears this again before the
+         connection pool goes away. */
       serr = svn_repos_remember_client_capabilities
         (repos->repos, capabilities_as_list(repos->client_capabilities,
                                             r->connection->pool));
@@ -2504,13 +2804,19 @@ get_resource(request_rec *r,
                                          HTTP_INTERNAL_SERVER_ERROR, r);
         }
 
-      /* Configure hook script environment variables. */
-      serr = svn_repos_hooks_setenv(repos->repos, dav_svn__get_hooks_env(r),
-                                    r->pool);
-      if (serr)
-        return dav_svn__sanitize_error(serr,
-                                       "Error settings hooks environment",
-                                       HTTP_INTERNAL_SERVER_ERROR, r);
+      /* Configure hook script environment variables.  A reused pooled
+         handle was set up with the same hooks env (it is part of the
+         cache key), so don't grow its pool by setting it again. */
+      if (!reused_handle)
+        {
+          serr = svn_repos_hooks_setenv(repos->repos,
+                                        dav_svn__get_hooks_env(r),
+                                        r->pool);
+          if (serr)
+            return dav_svn__sanitize_error(serr,
+                                           "Error settings hooks environment",
+                                           HTTP_INTERNAL_SERVER_ERROR, r);
+        }
     }
 
   /* cache the filesystem object */
@@ -3944,6 +4250,82 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
     {
       svn_stream_t *stream;
       char *block;
+      svn_cache__t *body_cache = NULL;
+      svn_checksum_t *sha1_checksum = NULL;
+      svn_stringbuf_t *collected = NULL;
+
+      /* Response bodies are cached by content checksum, so only texts
+         with a stable identity qualify: committed contents delivered
+         verbatim.  Keyword substitution depends on the request URI. */
+      if (!resource->info->keyword_subst
+          && svn_fs_is_revision_root(resource->info->root.root))
+        body_cache = dav_svn__get_body_cache(resource->info->r);
+
+      if (body_cache)
+        {
+          serr = svn_fs_file_checksum(&sha1_checksum, svn_checksum_sha1,
+                                      resource->info->root.root,
+                                      resource->info->repos_path, FALSE,
+                                      resource->pool);
+          if (serr != NULL)
+            {
+              /* Caching is an optimization; deliver from the FS. */
+              svn_error_clear(serr);
+              sha1_checksum = NULL;
+            }
+        }
+
+      if (sha1_checksum)
+        {
+          svn_stringbuf_t *body;
+          svn_boolean_t found = FALSE;
+
+          serr = svn_cache__get((void **)&body, &found, body_cache,
+                                sha1_checksum->digest, resource->pool);
+          if (serr != NULL)
+            {
+              svn_error_clear(serr);
+              found = FALSE;
+            }
+
+          if (found)
+            {
+              /* Serve the hot text straight from memory. */
+              bb = apr_brigade_create(resource->pool,
+                                      dav_svn__output_get_bucket_alloc(output));
+              bkt = apr_bucket_transient_create(
+                      body->data, body->len,
+                      dav_svn__output_get_bucket_alloc(output));
+              APR_BRIGADE_INSERT_TAIL(bb, bkt);
+              bkt = apr_bucket_eos_create(
+                      dav_svn__output_get_bucket_alloc(output));
+              APR_BRIGADE_INSERT_TAIL(bb, bkt);
+              serr = dav_svn__output_pass_brigade(output, bb);
+              apr_brigade_destroy(bb);
+              if (serr != NULL)
+                return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                            "Could not write data to filter.",
+                                            resource->pool);
+
+              return NULL;
+            }
+          else
+            {
+              svn_filesize_t length;
+
+              /* Collect the body for caching, unless it is too large to
+                 have a chance of staying in the membuffer anyway. */
+              serr = svn_fs_file_length(&length, resource->info->root.root,
+                                        resource->info->repos_path,
+                                        resource->pool);
+              if (serr != NULL)
+                svn_error_clear(serr);
+              else if (length <= BODY_CACHE_MAX_ITEM_SIZE)
+                collected
+                  = svn_stringbuf_create_ensure((apr_size_t)length,
+                                                resource->pool);
+            }
+        }
 
       serr = svn_fs_file_contents(&stream,
                                   resource->info->root.root,
@@ -4049,6 +4431,9 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
         if (bufsize == 0)
           break;
 
+        if (collected)
+          svn_stringbuf_appendbytes(collected, block, bufsize);
+
         /* write to the filter ... */
         bkt = apr_bucket_transient_create(
           block, bufsize, dav_svn__output_get_bucket_alloc(output));
@@ -4077,6 +4462,15 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
                                       resource->pool);
         }
 
+      /* Remember the complete body for the next request. */
+      if (collected)
+        {
+          serr = svn_cache__set(body_cache, sha1_checksum->digest, collected,
+                                resource->pool);
+          if (serr != NULL)
+            svn_error_clear(serr);
+        }
+
       apr_brigade_destroy(bb);
       return NULL;
     }
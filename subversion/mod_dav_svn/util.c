@@ -28,6 +28,7 @@
 #include <apr_errno.h>
 #include <apr_uri.h>
 #include <apr_buckets.h>
+#include <apr_sha1.h>
 
 #include <mod_dav.h>
 #include <http_protocol.h>
@@ -39,7 +40,10 @@
 #include "svn_base64.h"
 #include "svn_ctype.h"
 
+#include "svn_pools.h"
+
 #include "dav_svn.h"
+#include "private/svn_atomic.h"
 #include "private/svn_fspath.h"
 #include "private/svn_string_private.h"
 
@@ -1000,3 +1004,57 @@ dav_svn__fuzzy_escape_author(const char *author,
 
   return apr_xml_quote_string(result_pool, author, 1);
 }
+
+
+/* The process-wide cache of GET response bodies, created on first use.
+   Lives on top of the membuffer configured via SVNInMemoryCacheSize, so
+   hot file contents compete for the same memory as the FS caches. */
+static svn_cache__t *body_cache = NULL;
+static volatile svn_atomic_t body_cache_state = 0;
+
+/* Implements svn_atomic__err_init_func_t.
+   Create BODY_CACHE on top of the process-wide membuffer, if one has
+   been configured.  Entries are keyed by SHA-1 content checksum. */
+static svn_error_t *
+init_body_cache(void *baton, apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+  if (membuffer)
+    {
+      /* The cache must survive this request; give it its own pool. */
+      apr_pool_t *cache_pool = svn_pool_create(NULL);
+
+      SVN_ERR(svn_cache__create_membuffer_cache(
+                  &body_cache, membuffer,
+                  NULL, NULL,       /* default (svn_stringbuf_t) serializers */
+                  APR_SHA1_DIGESTSIZE,
+                  "mod_dav_svn:BODY",
+                  SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                  TRUE /* thread_safe */,
+                  FALSE /* short_lived */,
+                  cache_pool, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_cache__t *
+dav_svn__get_body_cache(request_rec *r)
+{
+  svn_error_t *err;
+
+  if (!dav_svn__get_body_cache_flag(r))
+    return NULL;
+
+  err = svn_atomic__init_once(&body_cache_state, init_body_cache, NULL,
+                              r->pool);
+  if (err)
+    {
+      /* Caching is an optimization; deliver from the FS instead. */
+      svn_error_clear(err);
+      return NULL;
+    }
+
+  return body_cache;
+}
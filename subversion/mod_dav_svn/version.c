@@ -47,6 +47,8 @@
 
 #include "dav_svn.h"
 
+#include "svn_private_config.h"  /* for SVN_HAVE_ZSTD */
+
 
 svn_error_t *
 dav_svn__attach_auto_revprops(svn_fs_txn_t *txn,
@@ -197,6 +199,9 @@ get_option(const dav_resource *resource,
     { SVN_DAV_NS_DAV_SVN_EPHEMERAL_TXNPROPS,  { 1,  8, 0, ""} },
     { SVN_DAV_NS_DAV_SVN_SVNDIFF1,            { 1, 10, 0, ""} },
     { SVN_DAV_NS_DAV_SVN_SVNDIFF2,            { 1, 10, 0, ""} },
+#ifdef SVN_HAVE_ZSTD
+    { SVN_DAV_NS_DAV_SVN_SVNDIFF3,            { 1, 15, 0, ""} },
+#endif
     { SVN_DAV_NS_DAV_SVN_PUT_RESULT_CHECKSUM, { 1, 10, 0, ""} },
   };
 
@@ -1180,6 +1185,10 @@ deliver_report(request_rec *r,
         {
           return dav_svn__list_report(resource, doc, output);
         }
+      else if (strcmp(doc->root->name, "proplist-report") == 0)
+        {
+          return dav_svn__proplist_report(resource, doc, output);
+        }
       /* NOTE: if you add a report, don't forget to add it to the
        *       dav_svn__reports_list[] array.
        */
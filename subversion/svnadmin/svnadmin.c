@@ -34,8 +34,10 @@
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 #include "svn_config.h"
+#include "svn_ctype.h"
 #include "svn_repos.h"
 #include "svn_cache_config.h"
+#include "svn_checksum.h"
 #include "svn_version.h"
 #include "svn_props.h"
 #include "svn_sorts.h"
@@ -44,8 +46,10 @@
 #include "svn_xml.h"
 #include "svn_fs.h"
 
+#include "private/svn_cache.h"
 #include "private/svn_cmdline_private.h"
 #include "private/svn_opt_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_cmdline_private.h"
@@ -125,7 +129,8 @@ static svn_opt_subcommand_t
   subcommand_setuuid,
   subcommand_unlock,
   subcommand_upgrade,
-  subcommand_verify;
+  subcommand_verify,
+  subcommand_warm;
 
 enum svnadmin__cmdline_options_t
   {
@@ -159,7 +164,9 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__threads,
+    svnadmin__compress
   };
 
 /* Option codes and descriptions.
@@ -292,6 +299,19 @@ static const apr_getopt_option_t options_table[] =
     {"include", svnadmin__include, 1,
      N_("filter out nodes without given prefix(es) from dump")},
 
+    {"threads", svnadmin__threads, 1,
+     N_("produce the records of up to ARG revisions\n"
+        "                             concurrently, while writing them out strictly\n"
+        "                             in revision order. Default: 1 (serial)")},
+
+    {"compress", svnadmin__compress, 0,
+     N_("compress the emitted dump data into blocks of\n"
+        "                             zstd with an embedded revision index;\n"
+        "                             'svnadmin load' unpacks such files\n"
+        "                             transparently and, when loading a revision\n"
+        "                             range with -r from a file, seeks directly\n"
+        "                             to the requested revisions")},
+
     {"pattern", svnadmin__glob, 0,
      N_("treat the path prefixes as file glob patterns.\n"
         "                             Glob special characters are '*' '?' '[]' and '\\'.\n"
@@ -383,7 +403,8 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "excluded, the copy is transformed into an add (unlike in 'svndumpfilter').\n"
    )},
   {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F',
-   svnadmin__exclude, svnadmin__include, svnadmin__glob },
+   svnadmin__exclude, svnadmin__include, svnadmin__glob,
+   svnadmin__threads, svnadmin__compress },
   {{'F', N_("write to file ARG instead of stdout")}} },
 
   {"dump-revprops", subcommand_dump_revprops, {0}, {N_(
@@ -628,9 +649,38 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "usage: svnadmin verify REPOS_PATH\n"
     "\n"), N_(
     "Verify the data stored in the repository.\n"
+    "\n"), N_(
+    "With --incremental, maintain a journal of already-verified packed\n"
+    "shards in the repository's db/ directory and verify only shards that\n"
+    "are new or whose pack file changed since they were recorded, plus all\n"
+    "not-yet-packed revisions.  Since packed shards are immutable, regular\n"
+    "incremental runs provide full coverage at a fraction of the cost of\n"
+    "a complete verification.\n"
    )},
    {'t', 'r', 'q', svnadmin__keep_going, 'M',
-    svnadmin__check_normalization, svnadmin__metadata_only} },
+    svnadmin__check_normalization, svnadmin__metadata_only,
+    svnadmin__incremental},
+   {{svnadmin__incremental,
+     N_("verify only packed shards not recorded in the\n"
+        "                             repository's verification journal, plus all\n"
+        "                             not-yet-packed revisions")}} },
+
+  {"warm", subcommand_warm, {0}, {N_(
+    "usage: svnadmin warm REPOS_PATH\n"
+    "\n"), N_(
+    "Walk the tree of revision N (default: the youngest revision), reading\n"
+    "directories, node properties and the beginning of each file's content\n"
+    "through the standard caching layer.  Use this to prewarm the caches\n"
+    "of a freshly (re)started server host before exposing it to client\n"
+    "traffic.\n"
+    "\n"), N_(
+    "If -F is given, only the repository paths listed in FILE and their\n"
+    "subtrees are warmed, in the given order.  List the most frequently\n"
+    "accessed paths first; each non-empty line names one path, optionally\n"
+    "preceded by an access count, and lines starting with '#' are ignored.\n"
+   )},
+   {'r', 'q', 'M', 'F'},
+   {{'F', N_("read repository paths from file ARG")}} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
 };
@@ -664,6 +714,9 @@ struct svnadmin_opt_state
   svn_boolean_t bypass_prop_validation;             /* --bypass-prop-validation */
   svn_boolean_t ignore_dates;                       /* --ignore-dates */
   svn_boolean_t no_flush_to_disk;                   /* --no-flush-to-disk */
+  svn_boolean_t bulk_reads;                         /* set by bulk subcommands,
+                                                       not a command line
+                                                       option */
   svn_boolean_t normalize_props;                    /* --normalize_props */
   enum svn_repos_load_uuid uuid_action;             /* --ignore-uuid,
                                                        --force-uuid */
@@ -673,6 +726,8 @@ struct svnadmin_opt_state
   apr_array_header_t *exclude;                      /* --exclude */
   apr_array_header_t *include;                      /* --include */
   svn_boolean_t glob;                               /* --pattern */
+  apr_uint64_t threads;                             /* --threads */
+  svn_boolean_t compress;                           /* --compress */
 
   const char *config_dir;    /* Overriding Configuration Directory */
 };
@@ -702,6 +757,11 @@ open_repos(svn_repos_t **repos,
                            use_block_read ? "1" : "0");
   svn_hash_sets(fs_config, SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                            opt_state->no_flush_to_disk ? "1" : "0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_BULK_READS,
+                           opt_state->bulk_reads ? "1" : "0");
+  /* svnadmin runs maintenance operations; when the membuffer cache is
+   * shared with a live server, don't let them evict its working set. */
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_PRIORITY, "low");
 
   /* now, open the requested repository */
   SVN_ERR(svn_repos_open3(repos, path, fs_config, pool, pool));
@@ -1435,6 +1495,9 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   /* Expect no more arguments. */
   SVN_ERR(parse_args(NULL, os, 0, 0, pool));
 
+  /* Don't evict hot data from the OS page cache with our bulk scan. */
+  opt_state->bulk_reads = TRUE;
+
   SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
   SVN_ERR(get_dump_range(&lower, &upper, repos, opt_state, pool));
 
@@ -1476,9 +1539,11 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "cannot be used simultaneously"));
     }
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
                              opt_state->incremental, opt_state->use_deltas,
                              TRUE, TRUE,
+                             (apr_size_t)opt_state->threads,
+                             opt_state->compress,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream,
                              filter_baton.prefixes ? dump_filter_func : NULL,
@@ -1522,8 +1587,9 @@ subcommand_dump_revprops(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stderr, pool);
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
                              FALSE, FALSE, TRUE, FALSE,
+                             1, FALSE,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream, NULL, NULL,
                              check_cancel, NULL, pool));
@@ -1728,6 +1794,11 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   else
     SVN_ERR(svn_stream_for_stdin2(&in_stream, TRUE, pool));
 
+  /* Transparently unpack compressed dump files.  When reading from a
+     file, this seeks straight to the requested revision range. */
+  SVN_ERR(svn_repos__compressed_dump_stream(&in_stream, in_stream,
+                                            lower, upper, pool, pool));
+
   /* Progress feedback goes to STDOUT, unless they asked to suppress it. */
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stdout, pool);
@@ -1788,6 +1859,11 @@ subcommand_load_revprops(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   else
     SVN_ERR(svn_stream_for_stdin2(&in_stream, TRUE, pool));
 
+  /* Transparently unpack compressed dump files.  When reading from a
+     file, this seeks straight to the requested revision range. */
+  SVN_ERR(svn_repos__compressed_dump_stream(&in_stream, in_stream,
+                                            lower, upper, pool, pool));
+
   /* Progress feedback goes to STDOUT, unless they asked to suppress it. */
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stdout, pool);
@@ -2199,6 +2275,9 @@ subcommand_pack(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   /* Expect no more arguments. */
   SVN_ERR(parse_args(NULL, os, 0, 0, pool));
 
+  /* Don't evict hot data from the OS page cache with our bulk scan. */
+  opt_state->bulk_reads = TRUE;
+
   SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
 
   /* Progress feedback goes to STDOUT, unless they asked to suppress it. */
@@ -2211,6 +2290,275 @@ subcommand_pack(apr_getopt_t *os, void *baton, apr_pool_t *pool)
 }
 
 
+/* One entry of the incremental-verification journal: a packed shard
+   that has been fully verified. */
+struct verify_journal_entry
+{
+  apr_int64_t shard;
+
+  /* Size of the shard's pack file when it was verified.  A mismatch on
+     a later run indicates a repack, so the shard gets verified again. */
+  svn_filesize_t pack_size;
+
+  /* Hex SHA1 of the pack file when it was verified, kept for manual
+     auditing, or "-" if it could not be determined. */
+  const char *checksum;
+};
+
+/* Return the path of the verification journal of REPOS,
+   allocated in POOL. */
+static const char *
+verify_journal_path(svn_repos_t *repos, apr_pool_t *pool)
+{
+  return svn_dirent_join(svn_repos_db_env(repos, pool), "verify-journal",
+                         pool);
+}
+
+/* Return the path of the pack file of SHARD in REPOS, following the
+   standard FSFS / FSX layout.  Allocate the result in POOL. */
+static const char *
+pack_file_path(svn_repos_t *repos, apr_int64_t shard, apr_pool_t *pool)
+{
+  return svn_dirent_join_many(pool, svn_repos_db_env(repos, pool), "revs",
+                              apr_psprintf(pool,
+                                           "%" APR_INT64_T_FMT ".pack",
+                                           shard),
+                              "pack", SVN_VA_NULL);
+}
+
+/* Read the verification journal at PATH into *JOURNAL, a hash mapping
+   the decimal shard number to a struct verify_journal_entry *.  If the
+   journal does not exist yet, return an empty hash.  Malformed lines
+   are ignored; the affected shards simply get verified again.
+   Allocate the result in POOL. */
+static svn_error_t *
+read_verify_journal(apr_hash_t **journal,
+                    const char *path,
+                    apr_pool_t *pool)
+{
+  svn_stringbuf_t *contents;
+  apr_array_header_t *lines;
+  svn_node_kind_t kind;
+  int i;
+
+  *journal = apr_hash_make(pool);
+
+  SVN_ERR(svn_io_check_path(path, &kind, pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents, path, pool));
+  lines = svn_cstring_split(contents->data, "\n\r", FALSE, pool);
+
+  for (i = 0; i < lines->nelts; ++i)
+    {
+      const char *line = APR_ARRAY_IDX(lines, i, const char *);
+      apr_array_header_t *fields;
+      struct verify_journal_entry *entry;
+      svn_error_t *err;
+
+      if (*line == '#')
+        continue;
+
+      fields = svn_cstring_split(line, " \t", TRUE, pool);
+      if (fields->nelts != 3)
+        continue;
+
+      entry = apr_pcalloc(pool, sizeof(*entry));
+      err = svn_cstring_atoi64(&entry->shard,
+                               APR_ARRAY_IDX(fields, 0, const char *));
+      if (!err)
+        err = svn_cstring_atoi64(&entry->pack_size,
+                                 APR_ARRAY_IDX(fields, 1, const char *));
+      if (err)
+        {
+          svn_error_clear(err);
+          continue;
+        }
+      entry->checksum = APR_ARRAY_IDX(fields, 2, const char *);
+
+      svn_hash_sets(*journal, APR_ARRAY_IDX(fields, 0, const char *),
+                    entry);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *SIZE to the size of the file at PATH and return TRUE, or return
+   FALSE if it cannot be determined.  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_boolean_t
+get_pack_file_size(svn_filesize_t *size,
+                   const char *path,
+                   apr_pool_t *scratch_pool)
+{
+  apr_finfo_t finfo;
+  svn_error_t *err = svn_io_stat(&finfo, path, APR_FINFO_SIZE,
+                                 scratch_pool);
+
+  if (err)
+    {
+      svn_error_clear(err);
+      return FALSE;
+    }
+
+  *size = finfo.size;
+  return TRUE;
+}
+
+/* Atomically (re-)write the verification journal at PATH from ENTRIES,
+   an array of struct verify_journal_entry *.  Use SCRATCH_POOL for
+   temporary allocations. */
+static svn_error_t *
+write_verify_journal(const char *path,
+                     apr_array_header_t *entries,
+                     apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *buf = svn_stringbuf_create(
+    "# Verification journal.  Lines: SHARD PACK-SIZE PACK-SHA1\n",
+    scratch_pool);
+  int i;
+
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      const struct verify_journal_entry *entry
+        = APR_ARRAY_IDX(entries, i, struct verify_journal_entry *);
+
+      svn_stringbuf_appendcstr(buf,
+                               apr_psprintf(scratch_pool,
+                                            "%" APR_INT64_T_FMT
+                                            " %" SVN_FILESIZE_T_FMT " %s\n",
+                                            entry->shard, entry->pack_size,
+                                            entry->checksum));
+    }
+
+  return svn_error_trace(svn_io_write_atomic2(path, buf->data, buf->len,
+                                              NULL, FALSE, scratch_pool));
+}
+
+/* Incrementally verify REPOS: verify only packed shards that are new,
+   or whose pack file size changed, since they were recorded in the
+   verification journal, followed by all not-yet-packed revisions.
+   Record each newly verified shard - with the size and SHA1 of its
+   pack file - in the journal right away, so that progress survives a
+   verification that fails further into the repository. */
+static svn_error_t *
+verify_incremental(svn_repos_t *repos,
+                   struct svnadmin_opt_state *opt_state,
+                   apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  const svn_fs_info_placeholder_t *info;
+  const svn_fs_fsfs_info_t *fsfs_info;
+  const char *journal_path = verify_journal_path(repos, pool);
+  svn_stream_t *feedback_stream = NULL;
+  apr_hash_t *journal;
+  apr_array_header_t *entries;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t youngest;
+  svn_revnum_t min_unpacked;
+  apr_int64_t shard_size;
+  apr_int64_t packed_shards;
+  apr_int64_t shard;
+  apr_int64_t skipped = 0;
+
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
+
+  /* The shard layout comes from the public FS info API.  FSX reports
+     the same fields at the same offsets, so treat it alike. */
+  SVN_ERR(svn_fs_info(&info, fs, pool, pool));
+  if (strcmp(info->fs_type, SVN_FS_TYPE_FSFS) != 0
+      && strcmp(info->fs_type, SVN_FS_TYPE_FSX) != 0)
+    return svn_error_createf(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                             _("Incremental verification is not supported "
+                               "for filesystem type '%s'"),
+                             info->fs_type);
+
+  fsfs_info = (const svn_fs_fsfs_info_t *)info;
+  shard_size = fsfs_info->shard_size;
+  min_unpacked = fsfs_info->min_unpacked_rev;
+  packed_shards = (shard_size > 0) ? min_unpacked / shard_size : 0;
+
+  SVN_ERR(read_verify_journal(&journal, journal_path, pool));
+  entries = apr_array_make(pool, (int)packed_shards,
+                           sizeof(struct verify_journal_entry *));
+
+  if (!opt_state->quiet)
+    feedback_stream = recode_stream_create(stdout, pool);
+
+  for (shard = 0; shard < packed_shards; ++shard)
+    {
+      const char *key;
+      const char *pack_path;
+      struct verify_journal_entry *entry;
+      svn_checksum_t *checksum;
+      svn_filesize_t pack_size;
+
+      svn_pool_clear(iterpool);
+
+      key = apr_psprintf(pool, "%" APR_INT64_T_FMT, shard);
+      pack_path = pack_file_path(repos, shard, iterpool);
+      entry = svn_hash_gets(journal, key);
+
+      /* Skip shards whose pack file is unchanged since we verified it. */
+      if (entry
+          && get_pack_file_size(&pack_size, pack_path, iterpool)
+          && pack_size == entry->pack_size)
+        {
+          APR_ARRAY_PUSH(entries, struct verify_journal_entry *) = entry;
+          ++skipped;
+          continue;
+        }
+
+      SVN_ERR(svn_repos_verify_fs3(repos,
+                                   (svn_revnum_t)(shard * shard_size),
+                                   (svn_revnum_t)((shard + 1) * shard_size
+                                                  - 1),
+                                   opt_state->check_normalization,
+                                   opt_state->metadata_only,
+                                   !opt_state->quiet
+                                     ? repos_notify_handler : NULL,
+                                   feedback_stream, NULL, NULL,
+                                   check_cancel, NULL, iterpool));
+
+      /* Record the shard while its pack file is still hot in cache. */
+      entry = apr_pcalloc(pool, sizeof(*entry));
+      entry->shard = shard;
+      entry->checksum = "-";
+      if (get_pack_file_size(&entry->pack_size, pack_path, iterpool))
+        {
+          SVN_ERR(svn_io_file_checksum2(&checksum, pack_path,
+                                        svn_checksum_sha1, iterpool));
+          entry->checksum = svn_checksum_to_cstring(checksum, pool);
+        }
+
+      APR_ARRAY_PUSH(entries, struct verify_journal_entry *) = entry;
+      SVN_ERR(write_verify_journal(journal_path, entries, iterpool));
+    }
+
+  /* The not-yet-packed tail can still grow and get packed, so verify
+     it on every run. */
+  if (min_unpacked <= youngest)
+    SVN_ERR(svn_repos_verify_fs3(repos, min_unpacked, youngest,
+                                 opt_state->check_normalization,
+                                 opt_state->metadata_only,
+                                 !opt_state->quiet
+                                   ? repos_notify_handler : NULL,
+                                 feedback_stream, NULL, NULL,
+                                 check_cancel, NULL, pool));
+
+  if (!opt_state->quiet)
+    SVN_ERR(svn_cmdline_printf(pool,
+                               _("Skipped %" APR_INT64_T_FMT " of %"
+                                 APR_INT64_T_FMT
+                                 " packed shards already verified.\n"),
+                               skipped, packed_shards));
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+
 /* This implements `svn_opt_subcommand_t'. */
 static svn_error_t *
 subcommand_verify(apr_getopt_t *os, void *baton, apr_pool_t *pool)
@@ -2234,10 +2582,25 @@ subcommand_verify(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "are mutually exclusive"));
     }
 
+  if (opt_state->incremental
+      && (opt_state->txn_id
+          || opt_state->keep_going
+          || opt_state->start_revision.kind != svn_opt_revision_unspecified
+          || opt_state->end_revision.kind != svn_opt_revision_unspecified))
+    {
+      return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                               _("--incremental cannot be combined with "
+                                 "--revision (-r), --transaction (-t) or "
+                                 "--keep-going"));
+    }
+
   SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
   fs = svn_repos_fs(repos);
   SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
 
+  if (opt_state->incremental)
+    return svn_error_trace(verify_incremental(repos, opt_state, pool));
+
   /* Usage 2. */
   if (opt_state->txn_id)
     {
@@ -2354,6 +2717,193 @@ subcommand_verify(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* How much of each file's content subcommand_warm pulls through the
+   caches: enough to cover the first delta window of its rep. */
+#define WARM_CONTENT_CHUNK SVN__STREAM_CHUNK_SIZE
+
+/* Tallies for the tree walk of subcommand_warm. */
+struct warm_baton
+{
+  /* Number of directories and files pulled through the caches. */
+  apr_int64_t dir_count;
+  apr_int64_t file_count;
+
+  /* Number of listed paths not present in the warmed revision. */
+  apr_int64_t missing_count;
+};
+
+/* Pull the noderev, properties and the first WARM_CONTENT_CHUNK bytes
+   of content of the file at PATH in ROOT through the caches, counting
+   it in BATON.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+warm_file(svn_fs_root_t *root,
+          const char *path,
+          struct warm_baton *baton,
+          apr_pool_t *scratch_pool)
+{
+  apr_hash_t *props;
+  svn_stream_t *contents;
+  char buffer[WARM_CONTENT_CHUNK];
+  apr_size_t len = sizeof(buffer);
+
+  SVN_ERR(svn_fs_node_proplist(&props, root, path, scratch_pool));
+  SVN_ERR(svn_fs_file_contents(&contents, root, path, scratch_pool));
+  SVN_ERR(svn_stream_read_full(contents, buffer, &len));
+  SVN_ERR(svn_stream_close(contents));
+
+  baton->file_count++;
+  return SVN_NO_ERROR;
+}
+
+/* Recursively pull the directory at PATH in ROOT, its node properties
+   and the first content windows of the files below it through the
+   caches, counting them in BATON.  Checks for cancellation once per
+   directory.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+warm_tree(svn_fs_root_t *root,
+          const char *path,
+          struct warm_baton *baton,
+          apr_pool_t *scratch_pool)
+{
+  apr_hash_t *props;
+  apr_hash_t *entries;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  SVN_ERR(check_cancel(NULL));
+
+  SVN_ERR(svn_fs_node_proplist(&props, root, path, scratch_pool));
+  SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
+  baton->dir_count++;
+
+  for (hi = apr_hash_first(scratch_pool, entries); hi; hi = apr_hash_next(hi))
+    {
+      svn_fs_dirent_t *dirent = apr_hash_this_val(hi);
+      const char *child;
+
+      svn_pool_clear(iterpool);
+      child = svn_fspath__join(path, dirent->name, iterpool);
+
+      if (dirent->kind == svn_node_dir)
+        SVN_ERR(warm_tree(root, child, baton, iterpool));
+      else if (dirent->kind == svn_node_file)
+        SVN_ERR(warm_file(root, child, baton, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Warm the paths listed in FILENAME, in the given order, counting them
+   in BATON.  Each non-empty line names one path in ROOT, optionally
+   preceded by an access count (e.g. as produced by tallying paths from
+   an access log); lines starting with '#' are ignored.  Listed paths
+   missing from ROOT are counted in BATON but otherwise skipped.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+warm_from_path_list(svn_fs_root_t *root,
+                    const char *filename,
+                    struct warm_baton *baton,
+                    apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *contents;
+  apr_array_header_t *lines;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents, filename, scratch_pool));
+  lines = svn_cstring_split(contents->data, "\n\r", FALSE, scratch_pool);
+
+  for (i = 0; i < lines->nelts; ++i)
+    {
+      const char *line = APR_ARRAY_IDX(lines, i, const char *);
+      const char *path;
+      svn_node_kind_t kind;
+
+      svn_pool_clear(iterpool);
+
+      while (*line == ' ' || *line == '\t')
+        ++line;
+      if (*line == '\0' || *line == '#')
+        continue;
+
+      /* Skip an optional leading access count. */
+      path = line;
+      if (svn_ctype_isdigit(*path))
+        {
+          while (svn_ctype_isdigit(*path))
+            ++path;
+          while (*path == ' ' || *path == '\t')
+            ++path;
+        }
+      if (*path == '\0')
+        continue;
+
+      path = svn_fspath__canonicalize(path, iterpool);
+      SVN_ERR(svn_fs_check_path(&kind, root, path, iterpool));
+      if (kind == svn_node_dir)
+        SVN_ERR(warm_tree(root, path, baton, iterpool));
+      else if (kind == svn_node_file)
+        SVN_ERR(warm_file(root, path, baton, iterpool));
+      else
+        baton->missing_count++;
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_warm(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  struct svnadmin_opt_state *opt_state = baton;
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_revnum_t youngest, rev;
+  svn_fs_root_t *root;
+  struct warm_baton wb = { 0 };
+
+  /* Expect no more arguments. */
+  SVN_ERR(parse_args(NULL, os, 0, 0, pool));
+
+  if (opt_state->end_revision.kind != svn_opt_revision_unspecified)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("'warm' accepts only a single revision"));
+
+  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+  fs = svn_repos_fs(repos);
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
+
+  SVN_ERR(get_revnum(&rev, &opt_state->start_revision, youngest, repos,
+                     pool));
+  if (rev == SVN_INVALID_REVNUM)
+    rev = youngest;
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+
+  if (opt_state->file)
+    SVN_ERR(warm_from_path_list(root, opt_state->file, &wb, pool));
+  else
+    SVN_ERR(warm_tree(root, "/", &wb, pool));
+
+  if (!opt_state->quiet)
+    {
+      SVN_ERR(svn_cmdline_printf(pool,
+                                 _("Warmed %" APR_INT64_T_FMT
+                                   " directories and %" APR_INT64_T_FMT
+                                   " files in r%ld.\n"),
+                                 wb.dir_count, wb.file_count, rev));
+      if (wb.missing_count > 0)
+        SVN_ERR(svn_cmdline_printf(pool,
+                                   _("Skipped %" APR_INT64_T_FMT
+                                     " listed paths not present in r%ld.\n"),
+                                   wb.missing_count, rev));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* This implements `svn_opt_subcommand_t'. */
 svn_error_t *
 subcommand_hotcopy(apr_getopt_t *os, void *baton, apr_pool_t *pool)
@@ -3076,6 +3626,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.threads = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -3290,6 +3841,12 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case svnadmin__glob:
         opt_state.glob = TRUE;
         break;
+      case svnadmin__threads:
+        SVN_ERR(svn_cstring_atoui64(&opt_state.threads, opt_arg));
+        break;
+      case svnadmin__compress:
+        opt_state.compress = TRUE;
+        break;
       default:
         {
           SVN_ERR(subcommand_help(NULL, NULL, pool));
@@ -3468,6 +4025,11 @@ main(int argc, const char *argv[])
       svn_cmdline_handle_exit_error(err, NULL, "svnadmin: ");
     }
 
+  /* If requested via $SVN_CACHE_STATS, dump the cache statistics of
+   * this run - mainly useful for sizing caches for long operations
+   * like 'svnadmin verify' or 'svnadmin pack'. */
+  svn_cache__maybe_write_stats_report(pool);
+
   svn_pool_destroy(pool);
 
   svn_cmdline__cancellation_exit();
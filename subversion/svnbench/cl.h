@@ -96,6 +96,8 @@ typedef struct svn_cl__opt_state_t
   svn_boolean_t trust_server_cert_not_yet_valid;
   svn_boolean_t trust_server_cert_other_failure;
   apr_array_header_t* search_patterns; /* pattern arguments for --search */
+  const char *baseline_file;     /* compare fs-bench results to this file */
+  const char *record_file;       /* write fs-bench results to this file */
 } svn_cl__opt_state_t;
 
 
@@ -113,7 +115,8 @@ svn_opt_subcommand_t
   svn_cl__null_export,
   svn_cl__null_list,
   svn_cl__null_log,
-  svn_cl__null_info;
+  svn_cl__null_info,
+  svn_cl__fs_bench;
 
 
 /* See definition in main.c for documentation. */
@@ -0,0 +1,544 @@
+/*
+ * fs-bench-cmd.c -- Benchmark server-side filesystem operations
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* ==================================================================== */
+
+
+
+/*** Includes. ***/
+
+#include <stdlib.h>
+
+#include <apr_time.h>
+
+#include "svn_cmdline.h"
+#include "svn_config.h"
+#include "svn_dirent_uri.h"
+#include "svn_error.h"
+#include "svn_fs.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_opt.h"
+#include "svn_pools.h"
+#include "svn_string.h"
+#include "cl.h"
+
+#include "private/svn_fspath.h"
+#include "svn_private_config.h"
+
+
+/*** The benchmarks. ***/
+
+/* Maximum number of files whose contents get reconstructed by the
+ * "file-read" pass, unless overridden with --limit. */
+#define DEFAULT_FILE_LIMIT 1000
+
+/* Number of revisions walked by the "rev-walk" pass if no -r range has
+ * been given (clipped to the revisions that actually exist). */
+#define DEFAULT_REVISION_COUNT 64
+
+/* Number of single-file commits performed by the "commit" pass into a
+ * scratch filesystem. */
+#define COMMIT_COUNT 16
+
+/* Relative slowdown vs. the baseline at which we call a result a
+ * regression. */
+#define REGRESSION_THRESHOLD 1.10
+
+/* Config section used in baseline / record files. */
+#define BASELINE_SECTION "fs-bench"
+
+/* Result of a single benchmark pass. */
+typedef struct bench_result_t
+{
+  /* Short, stable identifier; also the key in baseline files. */
+  const char *name;
+
+  /* Number of primitive operations performed. */
+  apr_uint64_t ops;
+
+  /* Number of content bytes processed, if meaningful, else 0. */
+  apr_uint64_t bytes;
+
+  /* Total wall-clock time spent. */
+  apr_time_t taken;
+} bench_result_t;
+
+/* Return the cost per operation of RESULT in microseconds. */
+static double
+usec_per_op(const bench_result_t *result)
+{
+  return result->ops ? (double)result->taken / (double)result->ops : 0.0;
+}
+
+/* Append a result with the given fields to RESULTS. */
+static void
+add_result(apr_array_header_t *results,
+           const char *name,
+           apr_uint64_t ops,
+           apr_uint64_t bytes,
+           apr_time_t taken)
+{
+  bench_result_t *result = apr_pcalloc(results->pool, sizeof(*result));
+
+  result->name = name;
+  result->ops = ops;
+  result->bytes = bytes;
+  result->taken = taken;
+
+  APR_ARRAY_PUSH(results, bench_result_t *) = result;
+}
+
+/* Walk the changed paths of revisions START_REV to END_REV (inclusive)
+ * in FS, reading the noderev of every changed path.  This exercises the
+ * revision / pack file indexes and the noderev parser in the same
+ * pattern as log and report generation on the server.  Append the result
+ * to RESULTS. */
+static svn_error_t *
+bench_rev_walk(apr_array_header_t *results,
+               svn_fs_t *fs,
+               svn_revnum_t start_rev,
+               svn_revnum_t end_rev,
+               apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_uint64_t ops = 0;
+  svn_revnum_t revision;
+  apr_time_t started = apr_time_now();
+
+  for (revision = start_rev; revision <= end_rev; ++revision)
+    {
+      svn_fs_root_t *root;
+      apr_hash_t *changes;
+      apr_hash_index_t *hi;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&root, fs, revision, iterpool));
+      SVN_ERR(svn_fs_paths_changed2(&changes, root, iterpool));
+
+      for (hi = apr_hash_first(iterpool, changes); hi; hi = apr_hash_next(hi))
+        {
+          const char *path = apr_hash_this_key(hi);
+          svn_node_kind_t kind;
+
+          SVN_ERR(svn_fs_check_path(&kind, root, path, iterpool));
+          if (kind != svn_node_none)
+            {
+              svn_revnum_t created_rev;
+              SVN_ERR(svn_fs_node_created_rev(&created_rev, root, path,
+                                              iterpool));
+            }
+
+          ++ops;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  add_result(results, "rev-walk", ops, 0, apr_time_now() - started);
+
+  return SVN_NO_ERROR;
+}
+
+/* Recursively list ROOT:PATH, appending up to FILE_LIMIT file paths
+ * (allocated in FILES->pool) to FILES and counting each directory entry
+ * read in *OPS. */
+static svn_error_t *
+walk_tree(apr_uint64_t *ops,
+          apr_array_header_t *files,
+          int file_limit,
+          svn_fs_root_t *root,
+          const char *path,
+          apr_pool_t *scratch_pool)
+{
+  apr_hash_t *entries;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
+  for (hi = apr_hash_first(scratch_pool, entries); hi; hi = apr_hash_next(hi))
+    {
+      const svn_fs_dirent_t *dirent = apr_hash_this_val(hi);
+      const char *entry_path;
+
+      svn_pool_clear(iterpool);
+      entry_path = svn_fspath__join(path, dirent->name, iterpool);
+      ++*ops;
+
+      if (dirent->kind == svn_node_dir)
+        SVN_ERR(walk_tree(ops, files, file_limit, root, entry_path,
+                          iterpool));
+      else if (files->nelts < file_limit)
+        APR_ARRAY_PUSH(files, const char *) = apr_pstrdup(files->pool,
+                                                          entry_path);
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* List the complete tree of REVISION in FS, then reconstruct the
+ * contents of up to FILE_LIMIT of the files found.  The former measures
+ * directory noderev and rep access, the latter delta chain combination.
+ * Set *ROOT_P to the revision root and *FILES_P to the files collected,
+ * both allocated in RESULT_POOL, and append a "tree-walk" result to
+ * RESULTS. */
+static svn_error_t *
+bench_tree_walk(svn_fs_root_t **root_p,
+                apr_array_header_t **files_p,
+                apr_array_header_t *results,
+                svn_fs_t *fs,
+                svn_revnum_t revision,
+                int file_limit,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  apr_uint64_t ops = 0;
+  apr_time_t started = apr_time_now();
+
+  SVN_ERR(svn_fs_revision_root(root_p, fs, revision, result_pool));
+  *files_p = apr_array_make(result_pool, file_limit, sizeof(const char *));
+  SVN_ERR(walk_tree(&ops, *files_p, file_limit, *root_p, "/", scratch_pool));
+
+  add_result(results, "tree-walk", ops, 0, apr_time_now() - started);
+  return SVN_NO_ERROR;
+}
+
+/* Reconstruct and drain the contents of all FILES in ROOT, appending a
+ * "file-read" result to RESULTS. */
+static svn_error_t *
+bench_file_read(apr_array_header_t *results,
+                svn_fs_root_t *root,
+                apr_array_header_t *files,
+                apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  char *buffer = apr_palloc(scratch_pool, SVN__STREAM_CHUNK_SIZE);
+  apr_uint64_t bytes = 0;
+  apr_time_t started = apr_time_now();
+  int i;
+
+  for (i = 0; i < files->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(files, i, const char *);
+      svn_stream_t *contents;
+      apr_size_t len;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_file_contents(&contents, root, path, iterpool));
+      do
+        {
+          len = SVN__STREAM_CHUNK_SIZE;
+          SVN_ERR(svn_stream_read_full(contents, buffer, &len));
+          bytes += len;
+        }
+      while (len == SVN__STREAM_CHUNK_SIZE);
+      SVN_ERR(svn_stream_close(contents));
+    }
+
+  svn_pool_destroy(iterpool);
+  add_result(results, "file-read", files->nelts, bytes,
+             apr_time_now() - started);
+
+  return SVN_NO_ERROR;
+}
+
+/* Perform COMMIT_COUNT single-file commits into a scratch filesystem
+ * created in the system temp area, appending a "commit" result to
+ * RESULTS.  Since each commit rewrites only a handful of bytes, the time
+ * per commit is dominated by the filesystem's write and fsync pattern.
+ * The scratch filesystem is removed afterwards; the benchmarked
+ * repository is never modified. */
+static svn_error_t *
+bench_commit(apr_array_header_t *results,
+             apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  const char *temp_dir;
+  const char *fs_path;
+  svn_fs_t *fs;
+  svn_revnum_t head = 0;
+  apr_time_t started;
+  int i;
+
+  SVN_ERR(svn_io_temp_dir(&temp_dir, scratch_pool));
+  fs_path = svn_dirent_join(temp_dir,
+                            apr_psprintf(scratch_pool,
+                                         "svnbench-fs-%" APR_TIME_T_FMT,
+                                         apr_time_now()),
+                            scratch_pool);
+  SVN_ERR(svn_fs_create2(&fs, fs_path, NULL, scratch_pool, scratch_pool));
+
+  started = apr_time_now();
+  for (i = 0; i < COMMIT_COUNT; ++i)
+    {
+      svn_fs_txn_t *txn;
+      svn_fs_root_t *txn_root;
+      svn_stream_t *contents;
+      const char *conflict;
+      svn_string_t *text;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, head, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      if (i == 0)
+        SVN_ERR(svn_fs_make_file(txn_root, "/file", iterpool));
+
+      text = svn_string_createf(iterpool, "change %d\n", i);
+      SVN_ERR(svn_fs_apply_text(&contents, txn_root, "/file", NULL,
+                                iterpool));
+      SVN_ERR(svn_stream_write(contents, text->data, &text->len));
+      SVN_ERR(svn_stream_close(contents));
+
+      SVN_ERR(svn_fs_commit_txn(&conflict, &head, txn, iterpool));
+    }
+  add_result(results, "commit", COMMIT_COUNT, 0, apr_time_now() - started);
+
+  svn_pool_destroy(iterpool);
+  return svn_error_trace(svn_io_remove_dir2(fs_path, TRUE, NULL, NULL,
+                                            scratch_pool));
+}
+
+
+/*** Output. ***/
+
+/* Write C as a JSON string literal (including the quotes) to the
+ * console. */
+static svn_error_t *
+print_json_string(const char *c, apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *buf = svn_stringbuf_create("\"", scratch_pool);
+
+  for (; *c; ++c)
+    {
+      if (*c == '"' || *c == '\\')
+        {
+          svn_stringbuf_appendbyte(buf, '\\');
+          svn_stringbuf_appendbyte(buf, *c);
+        }
+      else if ((unsigned char)*c < 0x20)
+        svn_stringbuf_appendcstr(buf,
+                                 apr_psprintf(scratch_pool, "\\u%04x", *c));
+      else
+        svn_stringbuf_appendbyte(buf, *c);
+    }
+  svn_stringbuf_appendbyte(buf, '"');
+
+  return svn_error_trace(svn_cmdline_printf(scratch_pool, "%s", buf->data));
+}
+
+/* Print all RESULTS for the repository at REPOS_PATH with head revision
+ * HEAD as a JSON document on the console. */
+static svn_error_t *
+print_json(apr_array_header_t *results,
+           const char *repos_path,
+           svn_revnum_t head,
+           apr_pool_t *scratch_pool)
+{
+  int i;
+
+  SVN_ERR(svn_cmdline_printf(scratch_pool, "{\n  \"repository\": "));
+  SVN_ERR(print_json_string(repos_path, scratch_pool));
+  SVN_ERR(svn_cmdline_printf(scratch_pool,
+                             ",\n  \"head\": %ld,\n  \"results\": [\n",
+                             head));
+
+  for (i = 0; i < results->nelts; ++i)
+    {
+      const bench_result_t *result
+        = APR_ARRAY_IDX(results, i, bench_result_t *);
+
+      SVN_ERR(svn_cmdline_printf(scratch_pool,
+                 "    {\"name\": \"%s\", \"ops\": %" APR_UINT64_T_FMT
+                 ", \"bytes\": %" APR_UINT64_T_FMT
+                 ", \"microseconds\": %" APR_TIME_T_FMT
+                 ", \"usec_per_op\": %.3f}%s\n",
+                 result->name, result->ops, result->bytes, result->taken,
+                 usec_per_op(result),
+                 i + 1 < results->nelts ? "," : ""));
+    }
+
+  return svn_error_trace(svn_cmdline_printf(scratch_pool, "  ]\n}\n"));
+}
+
+/* Write the per-operation costs of all RESULTS to a baseline file at
+ * PATH, in a format that svn_config_read3() and hence --baseline can
+ * read back. */
+static svn_error_t *
+record_results(apr_array_header_t *results,
+               const char *path,
+               apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *buf
+    = svn_stringbuf_create("[" BASELINE_SECTION "]\n", scratch_pool);
+  int i;
+
+  for (i = 0; i < results->nelts; ++i)
+    {
+      const bench_result_t *result
+        = APR_ARRAY_IDX(results, i, bench_result_t *);
+
+      svn_stringbuf_appendcstr(buf,
+                               apr_psprintf(scratch_pool, "%s = %.3f\n",
+                                            result->name,
+                                            usec_per_op(result)));
+    }
+
+  return svn_error_trace(svn_io_file_create(path, buf->data, scratch_pool));
+}
+
+/* Compare all RESULTS against the per-operation costs recorded in the
+ * baseline file at PATH and report the relative change on the console.
+ * Set *REGRESSED to TRUE if any benchmark is more than
+ * REGRESSION_THRESHOLD slower than its baseline. */
+static svn_error_t *
+compare_results(svn_boolean_t *regressed,
+                apr_array_header_t *results,
+                const char *path,
+                apr_pool_t *scratch_pool)
+{
+  svn_config_t *baseline;
+  int i;
+
+  *regressed = FALSE;
+  SVN_ERR(svn_config_read3(&baseline, path, TRUE, TRUE, FALSE,
+                           scratch_pool));
+
+  for (i = 0; i < results->nelts; ++i)
+    {
+      const bench_result_t *result
+        = APR_ARRAY_IDX(results, i, bench_result_t *);
+      const char *recorded;
+      double old_cost, new_cost;
+
+      svn_config_get(baseline, &recorded, BASELINE_SECTION, result->name,
+                     NULL);
+      if (recorded == NULL)
+        {
+          SVN_ERR(svn_cmdline_printf(scratch_pool,
+                                     _("%-10s  no baseline value\n"),
+                                     result->name));
+          continue;
+        }
+
+      old_cost = atof(recorded);
+      new_cost = usec_per_op(result);
+      if (old_cost <= 0.0)
+        continue;
+
+      SVN_ERR(svn_cmdline_printf(scratch_pool,
+                 _("%-10s  %10.3f usec/op, baseline %10.3f (%+.1f%%)%s\n"),
+                 result->name, new_cost, old_cost,
+                 100.0 * (new_cost - old_cost) / old_cost,
+                 new_cost > old_cost * REGRESSION_THRESHOLD
+                   ? _("  REGRESSION") : ""));
+
+      if (new_cost > old_cost * REGRESSION_THRESHOLD)
+        *regressed = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* This implements the `svn_opt_subcommand_t' interface. */
+svn_error_t *
+svn_cl__fs_bench(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  svn_cl__opt_state_t *opt_state = ((svn_cl__cmd_baton_t *) baton)->opt_state;
+  apr_array_header_t *args;
+  apr_array_header_t *results
+    = apr_array_make(pool, 4, sizeof(bench_result_t *));
+  const char *repos_path;
+  const char *fs_path;
+  svn_node_kind_t kind;
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  apr_array_header_t *files;
+  svn_revnum_t head, start_rev, end_rev;
+  int file_limit = opt_state->limit > 0 ? opt_state->limit
+                                        : DEFAULT_FILE_LIMIT;
+
+  SVN_ERR(svn_opt_parse_all_args(&args, os, pool));
+  if (args->nelts != 1)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("'fs-bench' requires exactly one "
+                              "repository path argument"));
+
+  repos_path = svn_dirent_internal_style(APR_ARRAY_IDX(args, 0, const char *),
+                                         pool);
+  SVN_ERR(svn_dirent_get_absolute(&repos_path, repos_path, pool));
+
+  /* Accept both the repository and its db/ sub-directory. */
+  fs_path = svn_dirent_join(repos_path, "db", pool);
+  SVN_ERR(svn_io_check_path(fs_path, &kind, pool));
+  if (kind != svn_node_dir)
+    fs_path = repos_path;
+
+  SVN_ERR(svn_fs_open2(&fs, fs_path, NULL, pool, pool));
+  SVN_ERR(svn_fs_youngest_rev(&head, fs, pool));
+
+  /* Map the -r range onto existing revisions; default to the most
+   * recent DEFAULT_REVISION_COUNT revisions. */
+  if (opt_state->start_revision.kind == svn_opt_revision_number)
+    start_rev = opt_state->start_revision.value.number;
+  else
+    start_rev = head > DEFAULT_REVISION_COUNT ? head - DEFAULT_REVISION_COUNT
+                                              : 1;
+  if (opt_state->end_revision.kind == svn_opt_revision_number)
+    end_rev = opt_state->end_revision.value.number;
+  else
+    end_rev = head;
+  if (start_rev < 1)
+    start_rev = 1;
+  if (end_rev > head)
+    end_rev = head;
+  if (start_rev > end_rev)
+    return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                             _("Revision range %ld:%ld is empty"),
+                             start_rev, end_rev);
+
+  SVN_ERR(bench_rev_walk(results, fs, start_rev, end_rev, pool));
+  SVN_ERR(bench_tree_walk(&root, &files, results, fs, end_rev, file_limit,
+                          pool, pool));
+  SVN_ERR(bench_file_read(results, root, files, pool));
+  SVN_ERR(bench_commit(results, pool));
+
+  if (!opt_state->quiet)
+    SVN_ERR(print_json(results, repos_path, head, pool));
+
+  if (opt_state->record_file)
+    SVN_ERR(record_results(results, opt_state->record_file, pool));
+
+  if (opt_state->baseline_file)
+    {
+      svn_boolean_t regressed;
+
+      SVN_ERR(compare_results(&regressed, results,
+                              opt_state->baseline_file, pool));
+      if (regressed)
+        return svn_error_create(SVN_ERR_BASE, NULL,
+                                _("Performance regression detected"));
+    }
+
+  return SVN_NO_ERROR;
+}
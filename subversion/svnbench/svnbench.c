@@ -32,6 +32,7 @@
 
 #include "svn_cmdline.h"
 #include "svn_dirent_uri.h"
+#include "svn_fs.h"
 #include "svn_pools.h"
 #include "svn_utf.h"
 #include "svn_version.h"
@@ -70,7 +71,9 @@ typedef enum svn_cl__longopt_t {
   opt_trust_server_cert,
   opt_trust_server_cert_failures,
   opt_changelist,
-  opt_search
+  opt_search,
+  opt_baseline,
+  opt_record
 } svn_cl__longopt_t;
 
 
@@ -171,6 +174,14 @@ const apr_getopt_option_t svn_cl__options[] =
                        "history")},
   {"search", opt_search, 1,
                        N_("use ARG as search pattern (glob syntax)")},
+  {"baseline",      opt_baseline, 1,
+                    N_("compare benchmark results against the baseline\n"
+                       "                             "
+                       "recorded in file ARG and fail on regressions")},
+  {"record",        opt_record, 1,
+                    N_("record benchmark results as a new baseline in\n"
+                       "                             "
+                       "file ARG")},
 
   /* Long-opt Aliases
    *
@@ -316,6 +327,30 @@ const svn_opt_subcommand_desc3_t svn_cl__cmd_table[] =
     {'r', 'R', opt_depth, opt_targets, opt_changelist}
   },
 
+  { "fs-bench", svn_cl__fs_bench, {0}, {N_(
+     "Benchmark server-side filesystem operations.\n"
+     "usage: fs-bench [-rM:N] REPOS_PATH\n"
+     "\n"), N_(
+     "  Run a fixed set of benchmarks directly against the repository at\n"
+     "  REPOS_PATH on local disk, bypassing the network layer:\n"
+     "\n"), N_(
+     "    rev-walk   read the changed paths and node revisions of the\n"
+     "               revisions in the -r range (default: the most recent 64)\n"
+     "    tree-walk  list the complete tree of the newest revision in range\n"
+     "    file-read  reconstruct the contents of the files found by the\n"
+     "               tree walk, up to --limit files (default: 1000)\n"
+     "    commit     perform a series of small commits into a temporary\n"
+     "               scratch filesystem, stressing the sync-to-disk path\n"
+     "\n"), N_(
+     "  Results are printed as a JSON document unless -q is given.  With\n"
+     "  --record FILE, per-operation costs are also written to FILE; a file\n"
+     "  written that way can later be passed via --baseline FILE to print\n"
+     "  relative changes and make the command fail if any benchmark is more\n"
+     "  than 10% slower than the recorded baseline.\n"
+    )},
+    {'r', 'q', 'l', opt_baseline, opt_record},
+    {{'l', N_("maximum number of files to read")}} },
+
   { NULL, NULL, {0}, {NULL}, {0} }
 };
 
@@ -331,6 +366,7 @@ check_lib_versions(void)
       { "svn_wc",     svn_wc_version },
       { "svn_ra",     svn_ra_version },
       { "svn_delta",  svn_delta_version },
+      { "svn_fs",     svn_fs_version },
       { NULL, NULL }
     };
   SVN_VERSION_DEFINE(my_version);
@@ -704,6 +740,21 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                                  apr_pstrdup(pool, utf8_opt_arg),
                                  pool);
         break;
+      case opt_baseline:
+        {
+          const char *path_utf8;
+          SVN_ERR(svn_utf_cstring_to_utf8(&path_utf8, opt_arg, pool));
+          opt_state.baseline_file = svn_dirent_internal_style(path_utf8,
+                                                              pool);
+        }
+        break;
+      case opt_record:
+        {
+          const char *path_utf8;
+          SVN_ERR(svn_utf_cstring_to_utf8(&path_utf8, opt_arg, pool));
+          opt_state.record_file = svn_dirent_internal_style(path_utf8, pool);
+        }
+        break;
       default:
         /* Hmmm. Perhaps this would be a good place to squirrel away
            opts that commands like svn diff might need. Hmmm indeed. */
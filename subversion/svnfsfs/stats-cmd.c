@@ -508,6 +508,7 @@ subcommand__stats(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   SVN_ERR(open_fs(&fs, opt_state->repository_path, pool));
 
   input.progress_func = print_progress;
+  input.num_threads = (apr_size_t)opt_state->threads;
   SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_GET_STATS, &input, (void **)&output,
                        check_cancel, NULL, pool, pool));
   print_stats(output->stats, pool);
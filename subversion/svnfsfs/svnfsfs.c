@@ -76,7 +76,8 @@ check_lib_versions(void)
 
 enum svnfsfs__cmdline_options_t
   {
-    svnfsfs__version = SVN_OPT_FIRST_LONGOPT_ID
+    svnfsfs__version = SVN_OPT_FIRST_LONGOPT_ID,
+    svnfsfs__threads
   };
 
 /* Option codes and descriptions.
@@ -104,6 +105,10 @@ static const apr_getopt_option_t options_table[] =
      N_("size of the extra in-memory cache in MB used to\n"
         "                             minimize redundant operations. Default: 16.")},
 
+    {"threads", svnfsfs__threads, 1,
+     N_("scan up to ARG packed shards concurrently.\n"
+        "                             Default: 1 (serial)")},
+
     {NULL}
   };
 
@@ -167,7 +172,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "\n"), N_(
     "Write object size statistics to console.\n"
    )},
-   {'M'} },
+   {'M', svnfsfs__threads} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
 };
@@ -259,6 +264,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.threads = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -323,6 +329,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case svnfsfs__version:
         opt_state.version = TRUE;
         break;
+      case svnfsfs__threads:
+        SVN_ERR(svn_cstring_atoui64(&opt_state.threads, opt_arg));
+        break;
       default:
         {
           SVN_ERR(subcommand__help(NULL, NULL, pool));
@@ -45,6 +45,7 @@ typedef struct svnfsfs__opt_state
   svn_boolean_t version;                            /* --version */
   svn_boolean_t quiet;                              /* --quiet */
   apr_uint64_t memory_cache_size;                   /* --memory-cache-size M */
+  apr_uint64_t threads;                             /* --threads */
 } svnfsfs__opt_state;
 
 /* Declare all the command procedures */
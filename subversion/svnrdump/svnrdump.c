@@ -31,6 +31,7 @@
 #include "svn_ra.h"
 #include "svn_repos.h"
 #include "svn_path.h"
+#include "svn_io.h"
 #include "svn_utf.h"
 #include "svn_private_config.h"
 #include "svn_string.h"
@@ -65,6 +66,7 @@ enum svn_svnrdump__longopt_t
     opt_skip_revprop,
     opt_force_interactive,
     opt_incremental,
+    opt_segment_size,
     opt_trust_server_cert,
     opt_trust_server_cert_failures,
     opt_version
@@ -89,8 +91,17 @@ static const svn_opt_subcommand_desc3_t svnrdump__cmd_table[] =
        "Dump revisions LOWER to UPPER of repository at remote URL to stdout\n"
        "in a 'dumpfile' portable format.  If only LOWER is given, dump that\n"
        "one revision.\n"
+       "\n"), N_(
+       "If --segment-size is given, write the dump as a series of\n"
+       "self-contained dumpfiles FILE.rLOWER-UPPER of at most ARG revisions\n"
+       "each instead of one stream; segments whose file already exists are\n"
+       "skipped, so an interrupted dump can be resumed by re-running the\n"
+       "same command.  The segment files can be loaded in ascending order,\n"
+       "or disjoint ranges can be dumped by concurrent svnrdump processes.\n"
+       "Requires -F.\n"
     )},
-    { 'r', 'q', opt_incremental, 'F', SVN_SVNRDUMP__BASE_OPTIONS },
+    { 'r', 'q', opt_incremental, 'F', opt_segment_size,
+      SVN_SVNRDUMP__BASE_OPTIONS },
     {{'F', N_("write to file ARG instead of stdout")}} },
   { "load", load_cmd, { 0 }, {N_(
        "usage: svnrdump load URL\n"
@@ -116,6 +127,10 @@ static const apr_getopt_option_t svnrdump__options[] =
                       N_("no progress (only errors) to stderr")},
     {"incremental",   opt_incremental, 0,
                       N_("dump incrementally")},
+    {"segment-size",  opt_segment_size, 1,
+                      N_("dump in resumable segments of ARG revisions,\n"
+                         "                             "
+                         "each to its own file (dump only; requires -F)")},
     {"skip-revprop",  opt_skip_revprop, 1,
                       N_("skip revision property ARG (e.g., \"svn:author\")")},
     {"config-dir",    opt_config_dir, 1,
@@ -195,6 +210,7 @@ typedef struct opt_baton_t {
   svn_opt_revision_t end_revision;
   svn_boolean_t quiet;
   svn_boolean_t incremental;
+  svn_revnum_t segment_size;
   apr_hash_t *skip_revprops;
 } opt_baton_t;
 
@@ -552,6 +568,76 @@ replay_revisions(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+/* Dump the revision range of OPT_BATON in segments of at most
+ * OPT_BATON->segment_size revisions, each to a self-contained dumpfile
+ * named <dumpfile>.rLOWER-UPPER.  Each segment is written to a
+ * temporary file and renamed into place only when complete, and
+ * segments whose file already exists are skipped; an interrupted dump
+ * can therefore be resumed by re-running the same command, and
+ * disjoint ranges can be dumped by concurrent svnrdump processes.
+ * EXTRA_RA_SESSION is the backdoor session used by the dump editor.
+ */
+static svn_error_t *
+dump_segments(opt_baton_t *opt_baton,
+              svn_ra_session_t *extra_ra_session,
+              apr_pool_t *pool)
+{
+  svn_revnum_t start = opt_baton->start_revision.value.number;
+  svn_revnum_t end = opt_baton->end_revision.value.number;
+  svn_boolean_t incremental = opt_baton->incremental;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  while (start <= end)
+    {
+      svn_revnum_t segment_end;
+      const char *segment_path;
+      svn_node_kind_t kind;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(check_cancel(NULL));
+
+      segment_end = start + opt_baton->segment_size - 1;
+      if (segment_end > end)
+        segment_end = end;
+
+      segment_path = apr_psprintf(iterpool, "%s.r%ld-%ld",
+                                  opt_baton->dumpfile, start, segment_end);
+
+      SVN_ERR(svn_io_check_path(segment_path, &kind, iterpool));
+      if (kind == svn_node_file)
+        {
+          if (! opt_baton->quiet)
+            SVN_ERR(svn_cmdline_fprintf(stderr, iterpool,
+                                        _("* Skipped existing segment "
+                                          "'%s'.\n"),
+                                        segment_path));
+        }
+      else
+        {
+          const char *tmp_path = apr_pstrcat(iterpool, segment_path, ".tmp",
+                                             SVN_VA_NULL);
+
+          SVN_ERR(replay_revisions(opt_baton->session, extra_ra_session,
+                                   start, segment_end, opt_baton->quiet,
+                                   incremental, tmp_path, iterpool));
+          SVN_ERR(svn_io_file_rename2(tmp_path, segment_path, FALSE,
+                                      iterpool));
+
+          if (! opt_baton->quiet)
+            SVN_ERR(svn_cmdline_fprintf(stderr, iterpool,
+                                        _("* Dumped segment '%s'.\n"),
+                                        segment_path));
+        }
+
+      /* Later segments always continue an earlier dump. */
+      incremental = TRUE;
+      start = segment_end + 1;
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 /* Read a dumpstream from stdin, and use it to feed a loader capable
  * of transmitting that information to the repository located at URL
  * (to which SESSION has been opened).  AUX_SESSION is a second RA
@@ -644,6 +730,9 @@ dump_cmd(apr_getopt_t *os,
   SVN_ERR(svn_ra_get_repos_root2(extra_ra_session, &repos_root, pool));
   SVN_ERR(svn_ra_reparent(extra_ra_session, repos_root, pool));
 
+  if (opt_baton->segment_size > 0)
+    return dump_segments(opt_baton, extra_ra_session, pool);
+
   return replay_revisions(opt_baton->session, extra_ra_session,
                           opt_baton->start_revision.value.number,
                           opt_baton->end_revision.value.number,
@@ -900,6 +989,19 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
         case opt_incremental:
           opt_baton->incremental = TRUE;
           break;
+        case opt_segment_size:
+          {
+            apr_int64_t size;
+
+            SVN_ERR(svn_utf_cstring_to_utf8(&opt_arg, opt_arg, pool));
+            SVN_ERR(svn_cstring_atoi64(&size, opt_arg));
+            if (size < 1)
+              return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                       _("Invalid segment size '%s'"),
+                                       opt_arg);
+            opt_baton->segment_size = (svn_revnum_t)size;
+          }
+          break;
         case opt_skip_revprop:
           SVN_ERR(svn_utf_cstring_to_utf8(&opt_arg, opt_arg, pool));
           svn_hash_sets(opt_baton->skip_revprops, opt_arg, opt_arg);
@@ -1055,6 +1157,15 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                                 "--non-interactive"));
     }
 
+  if (strcmp(subcommand->name, "dump") == 0)
+    {
+      if (opt_baton->segment_size > 0 && opt_baton->dumpfile == NULL)
+        {
+          return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                  _("--segment-size requires -F"));
+        }
+    }
+
   if (strcmp(subcommand->name, "load") == 0)
     {
       if (read_pass_from_stdin && opt_baton->dumpfile == NULL)
@@ -32,6 +32,14 @@
 #include <apr_general.h>
 #include <apr_lib.h>
 #include <apr_strings.h>
+#include <apr_portable.h>
+
+#if APR_HAVE_NETINET_IN_H
+#include <netinet/in.h>   /* for IPPROTO_TCP */
+#endif
+#if APR_HAVE_NETINET_TCP_H
+#include <netinet/tcp.h>  /* for TCP_NOTSENT_LOWAT */
+#endif
 
 #include "svn_compat.h"
 #include "svn_private_config.h"  /* For SVN_PATH_LOCAL_SEPARATOR */
@@ -51,15 +59,24 @@
 #include "svn_mergeinfo.h"
 #include "svn_user.h"
 
+#include "private/svn_cache.h"
+#include "private/svn_delta_private.h"
 #include "private/svn_log.h"
 #include "private/svn_mergeinfo_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_ra_svn_private.h"
+#include "private/svn_fs_fs_private.h"
 #include "private/svn_fspath.h"
+#include "private/svn_subr_private.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>   /* For getpid() */
 #endif
 
+#ifndef WIN32
+#include <sys/resource.h>   /* For getrusage() */
+#endif
+
 #include "server.h"
 #include "logger.h"
 
@@ -102,6 +119,13 @@ typedef struct fs_warning_baton_t {
   svn_ra_svn_conn_t *conn;
 } fs_warning_baton_t;
 
+/* Defined below; needed by the write commands that proxy to the master
+   repository in replica mode. */
+static svn_error_t *
+get_master_session(svn_ra_session_t **session,
+                   server_baton_t *b,
+                   apr_pool_t *scratch_pool);
+
 typedef struct authz_baton_t {
   server_baton_t *server;
   svn_ra_svn_conn_t *conn;
@@ -149,6 +173,61 @@ log_fail_and_flush(svn_error_t *err, server_baton_t *server,
   return svn_ra_svn__flush(conn, pool);
 }
 
+/* Return the peak resident set size of this process in kBytes, or 0 if
+   that information is not available on this platform. */
+static apr_uint64_t
+get_peak_rss(void)
+{
+#ifndef WIN32
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#ifdef __APPLE__
+      /* Darwin reports ru_maxrss in bytes, not kBytes. */
+      return (apr_uint64_t)usage.ru_maxrss / 1024;
+#else
+      return (apr_uint64_t)usage.ru_maxrss;
+#endif
+    }
+#endif
+
+  return 0;
+}
+
+/* If the process memory high-water mark has grown since the last logged
+   command, write a line reporting the new mark to B's log file.  Use
+   POOL for temporary allocations. */
+static svn_error_t *log_memory_growth(server_baton_t *b,
+                                      apr_pool_t *pool)
+{
+  apr_uint64_t peak_rss = get_peak_rss();
+  apr_size_t pool_bytes;
+  const char *timestr, *line;
+
+  if (peak_rss <= b->peak_rss)
+    return SVN_NO_ERROR;
+
+  /* Exact pool accounting is only available in APR pool-debug builds;
+     0 means "unknown". */
+  pool_bytes = svn_pool__bytes_used(b->pool);
+  timestr = svn_time_to_cstring(apr_time_now(), pool);
+
+  line = apr_psprintf(pool, "%" APR_PID_T_FMT
+                      " %s - - %s memory: peak RSS %" APR_UINT64_T_FMT
+                      " kB (+%" APR_UINT64_T_FMT " kB since last command)"
+                      "%s" APR_EOL_STR,
+                      getpid(), timestr, b->repository->repos_name,
+                      peak_rss, peak_rss - b->peak_rss,
+                      pool_bytes
+                        ? apr_psprintf(pool, ", connection pool %"
+                                       APR_SIZE_T_FMT " bytes", pool_bytes)
+                        : "");
+  b->peak_rss = peak_rss;
+
+  return logger__write(b->logger, line, strlen(line));
+}
+
 /* Log a client command. */
 static svn_error_t *log_command(server_baton_t *b,
                                 svn_ra_svn_conn_t *conn,
@@ -177,7 +256,140 @@ static svn_error_t *log_command(server_baton_t *b,
                       b->repository->repos_name, log);
   nbytes = strlen(line);
 
-  return logger__write(b->logger, line, nbytes);
+  SVN_ERR(logger__write(b->logger, line, nbytes));
+
+  /* Commands are logged when they start, so a mark reported here grew
+     while the *previous* line's command was running. */
+  return log_memory_growth(b, pool);
+}
+
+/* Append the JSON string literal encoding of STR (may be NULL) to BUF,
+   including the surrounding double quotes. */
+static void
+append_json_string(svn_stringbuf_t *buf,
+                   const char *str)
+{
+  svn_stringbuf_appendbyte(buf, '"');
+  for (; str && *str; ++str)
+    {
+      unsigned char c = (unsigned char)*str;
+
+      if (c == '"' || c == '\\')
+        {
+          svn_stringbuf_appendbyte(buf, '\\');
+          svn_stringbuf_appendbyte(buf, c);
+        }
+      else if (c < 0x20)
+        {
+          char escaped[8];
+          apr_snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          svn_stringbuf_appendcstr(buf, escaped);
+        }
+      else
+        {
+          svn_stringbuf_appendbyte(buf, c);
+        }
+    }
+  svn_stringbuf_appendbyte(buf, '"');
+}
+
+/* Write a JSON telemetry record for the command CMD_NAME received over
+   CONN to B's log file.  The command took DURATION and the global
+   membuffer cache counters stood at CACHE_BEFORE (may be NULL) when it
+   started.  Use POOL for temporary allocations. */
+static svn_error_t *
+log_telemetry(server_baton_t *b,
+              svn_ra_svn_conn_t *conn,
+              const char *cmd_name,
+              apr_time_t duration,
+              const svn_cache__info_t *cache_before,
+              apr_pool_t *pool)
+{
+  const char *remote_host = svn_ra_svn_conn_remote_host(conn);
+  apr_uint64_t bytes_in, bytes_out;
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(pool);
+
+  svn_ra_svn__get_command_io_counters(&bytes_in, &bytes_out, conn);
+
+  svn_stringbuf_appendcstr(buf, "{\"telemetry\":{\"time\":");
+  append_json_string(buf, svn_time_to_cstring(apr_time_now(), pool));
+  svn_stringbuf_appendcstr(buf,
+                           apr_psprintf(pool, ",\"pid\":%" APR_PID_T_FMT,
+                                        getpid()));
+  svn_stringbuf_appendcstr(buf, ",\"repos\":");
+  append_json_string(buf, b->repository->repos_name);
+  svn_stringbuf_appendcstr(buf, ",\"user\":");
+  append_json_string(buf, b->client_info->user);
+  svn_stringbuf_appendcstr(buf, ",\"client\":");
+  append_json_string(buf, remote_host);
+  svn_stringbuf_appendcstr(buf, ",\"command\":");
+  append_json_string(buf, cmd_name);
+  svn_stringbuf_appendcstr(buf,
+      apr_psprintf(pool,
+                   ",\"duration_us\":%" APR_INT64_T_FMT
+                   ",\"bytes_in\":%" APR_UINT64_T_FMT
+                   ",\"bytes_out\":%" APR_UINT64_T_FMT,
+                   (apr_int64_t)duration, bytes_in, bytes_out));
+
+  /* The membuffer counters are process-global, so in threaded mode
+     concurrent connections show up in each other's deltas.  Still good
+     enough to tell cache-hot from cache-cold commands. */
+  if (cache_before && svn_cache__get_global_membuffer_cache())
+    {
+      svn_cache__info_t *cache_after
+        = svn_cache__membuffer_get_global_info(pool);
+
+      svn_stringbuf_appendcstr(buf,
+          apr_psprintf(pool,
+                       ",\"cache_gets\":%" APR_UINT64_T_FMT
+                       ",\"cache_hits\":%" APR_UINT64_T_FMT,
+                       cache_after->gets - cache_before->gets,
+                       cache_after->hits - cache_before->hits));
+    }
+
+  svn_stringbuf_appendcstr(buf, "}}" APR_EOL_STR);
+
+  return logger__write(b->logger, buf->data, buf->len);
+}
+
+/* Like svn_ra_svn__handle_command2() on CONNECTION's command stream but,
+   if telemetry is enabled, write a JSON record describing every Nth
+   command (N given by the --log-telemetry option) to the log file. */
+static svn_error_t *
+handle_command_with_telemetry(svn_boolean_t *terminate,
+                              apr_hash_t *cmd_hash,
+                              connection_t *connection,
+                              apr_pool_t *pool)
+{
+  server_baton_t *b = connection->baton;
+  apr_uint64_t rate = connection->params->telemetry_sample_rate;
+  const svn_cache__info_t *cache_before = NULL;
+  const char *cmd_name;
+  apr_time_t start;
+  svn_error_t *err;
+
+  if (rate == 0 || b == NULL || b->logger == NULL
+      || ++b->command_count % rate != 0)
+    return svn_error_trace(svn_ra_svn__handle_command(terminate, cmd_hash,
+                                                      b, connection->conn,
+                                                      FALSE, pool));
+
+  if (svn_cache__get_global_membuffer_cache())
+    cache_before = svn_cache__membuffer_get_global_info(pool);
+
+  start = apr_time_now();
+  err = svn_ra_svn__handle_command2(terminate, &cmd_name, cmd_hash, b,
+                                    connection->conn, FALSE, pool);
+
+  /* No word read usually means the client simply disconnected. */
+  if (cmd_name)
+    err = svn_error_compose_create(err,
+                                   log_telemetry(b, connection->conn,
+                                                 cmd_name,
+                                                 apr_time_now() - start,
+                                                 cache_before, pool));
+
+  return svn_error_trace(err);
 }
 
 /* Log an authz failure */
@@ -1209,6 +1421,20 @@ static svn_error_t *do_change_rev_prop(svn_ra_svn_conn_t *conn,
   SVN_ERR(must_have_access(conn, pool, b, svn_authz_write, NULL, FALSE));
   SVN_ERR(log_command(b, conn, pool, "%s",
                       svn_log__change_rev_prop(rev, name, pool)));
+
+  /* On a read replica, forward the change to the master. */
+  if (b->repository->master_url)
+    {
+      svn_ra_session_t *session;
+
+      SVN_CMD_ERR(get_master_session(&session, b, pool));
+      SVN_CMD_ERR(svn_ra_change_rev_prop2(session, rev, name, old_value_p,
+                                          value, pool));
+      SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+
+      return SVN_NO_ERROR;
+    }
+
   SVN_CMD_ERR(svn_repos_fs_change_rev_prop4(b->repository->repos, rev,
                                             b->client_info->user,
                                             name, old_value_p, value,
@@ -1467,6 +1693,166 @@ unlock_paths(const svn_ra_svn__list_t *lock_tokens,
   return SVN_NO_ERROR;
 }
 
+/* Set *SESSION to an RA session to the master repository of B, opening
+ * it if this is the first proxied write command on this connection.
+ * The session is parented at the master's counterpart of the
+ * connection's current location, so path arguments sent by the client
+ * apply to it unchanged. */
+static svn_error_t *
+get_master_session(svn_ra_session_t **session,
+                   server_baton_t *b,
+                   apr_pool_t *scratch_pool)
+{
+  repository_t *repository = b->repository;
+  const char *location = repository->master_url;
+
+  if (strcmp(repository->fs_path->data, "/") != 0)
+    location = apr_pstrcat(scratch_pool, location,
+                           svn_path_uri_encode(repository->fs_path->data,
+                                               scratch_pool),
+                           SVN_VA_NULL);
+
+  if (repository->master_session == NULL)
+    {
+      svn_ra_callbacks2_t *callbacks;
+      svn_auth_baton_t *auth_baton;
+      svn_revnum_t master_head;
+      svn_revnum_t replica_head;
+
+      SVN_ERR(svn_ra_create_callbacks(&callbacks, b->pool));
+      svn_auth_open(&auth_baton,
+                    apr_array_make(b->pool, 0,
+                                   sizeof(svn_auth_provider_object_t *)),
+                    b->pool);
+      callbacks->auth_baton = auth_baton;
+
+      /* Passing the replica's UUID makes sure we only ever forward
+         writes to the repository this one actually mirrors. */
+      SVN_ERR(svn_ra_open4(&repository->master_session, NULL, location,
+                           repository->uuid, callbacks, b, NULL, b->pool));
+
+      /* A lagging mirror is not an error - the mirror tool will catch
+         up - but it is worth an operational log entry. */
+      SVN_ERR(svn_ra_get_latest_revnum(repository->master_session,
+                                       &master_head, scratch_pool));
+      SVN_ERR(svn_fs_youngest_rev(&replica_head, repository->fs,
+                                  scratch_pool));
+      if (replica_head < master_head)
+        {
+          svn_error_t *warning
+            = svn_error_createf(SVN_ERR_RA_OUT_OF_DATE, NULL,
+                                "Replica is at r%ld but the master is at "
+                                "r%ld", replica_head, master_head);
+          log_warning(warning, b);
+          svn_error_clear(warning);
+        }
+    }
+  else
+    SVN_ERR(svn_ra_reparent(repository->master_session, location,
+                            scratch_pool));
+
+  *session = repository->master_session;
+
+  return SVN_NO_ERROR;
+}
+
+/* Proxy a commit to the master repository:  obtain a commit editor
+ * from B's master session and let the client drive it, just like
+ * commit() drives the local repository editor.  REVPROP_TABLE,
+ * LOCK_TOKENS and KEEP_LOCKS are as parsed by commit(). */
+static svn_error_t *
+proxy_commit(svn_ra_svn_conn_t *conn,
+             server_baton_t *b,
+             apr_hash_t *revprop_table,
+             const svn_ra_svn__list_t *lock_tokens,
+             svn_boolean_t keep_locks,
+             apr_pool_t *pool)
+{
+  svn_ra_session_t *session;
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+  apr_hash_t *token_hash = NULL;
+  svn_boolean_t aborted;
+  commit_callback_baton_t ccb;
+  svn_revnum_t new_rev;
+  const char *date = NULL;
+  const char *author = NULL;
+  const char *post_commit_err = NULL;
+
+  SVN_CMD_ERR(get_master_session(&session, b, pool));
+
+  /* The lock tokens travel on unchanged:  they name paths relative to
+     the session root, which matches on both sides. */
+  if (lock_tokens && lock_tokens->nelts)
+    {
+      int i;
+
+      token_hash = apr_hash_make(pool);
+      for (i = 0; i < lock_tokens->nelts; ++i)
+        {
+          const char *canonical_path;
+          svn_ra_svn__item_t *path_item, *token_item;
+          svn_ra_svn__item_t *item
+            = &SVN_RA_SVN__LIST_ITEM(lock_tokens, i);
+
+          if (item->kind != SVN_RA_SVN_LIST)
+            return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                    "Lock tokens aren't a list of lists");
+
+          path_item = &SVN_RA_SVN__LIST_ITEM(&item->u.list, 0);
+          token_item = &SVN_RA_SVN__LIST_ITEM(&item->u.list, 1);
+          if (path_item->kind != SVN_RA_SVN_STRING
+              || token_item->kind != SVN_RA_SVN_STRING)
+            return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                    "Lock token isn't a string");
+
+          SVN_ERR(svn_relpath_canonicalize_safe(&canonical_path, NULL,
+                                                path_item->u.string.data,
+                                                pool, pool));
+          svn_hash_sets(token_hash, canonical_path,
+                        token_item->u.string.data);
+        }
+    }
+
+  ccb.pool = pool;
+  ccb.new_rev = &new_rev;
+  ccb.date = &date;
+  ccb.author = &author;
+  ccb.post_commit_err = &post_commit_err;
+
+  SVN_CMD_ERR(svn_ra_get_commit_editor3(session, &editor, &edit_baton,
+                                        revprop_table, commit_done, &ccb,
+                                        token_hash, keep_locks, pool));
+  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+  SVN_ERR(svn_ra_svn_drive_editor2(conn, pool, editor, edit_baton,
+                                   &aborted, FALSE));
+  if (!aborted)
+    {
+      SVN_ERR(log_command(b, conn, pool, "%s",
+                          svn_log__commit(new_rev, pool)));
+      SVN_ERR(trivial_auth_request(conn, pool, b));
+      SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "r(?c)(?c)(?c)",
+                                      new_rev, date, author,
+                                      post_commit_err));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Return an error if B serves a read replica:  lock state is neither
+ * mirrored nor proxied, so lock commands must go to the master. */
+static svn_error_t *
+reject_locks_on_replica(server_baton_t *b)
+{
+  if (b->repository->master_url)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                            "Lock commands are not supported on a read "
+                            "replica; run them against the master "
+                            "repository");
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 commit(svn_ra_svn_conn_t *conn,
        apr_pool_t *pool,
@@ -1519,8 +1905,8 @@ commit(svn_ra_svn_conn_t *conn,
                            (lock_tokens && lock_tokens->nelts)));
 
   /* Authorize the lock tokens and give them to the FS if we got
-     any. */
-  if (lock_tokens && lock_tokens->nelts)
+     any.  On a replica they are forwarded to the master instead. */
+  if (lock_tokens && lock_tokens->nelts && !b->repository->master_url)
     SVN_CMD_ERR(add_lock_tokens(lock_tokens, b, pool));
 
   /* Ignore LOG_MSG, per the protocol.  See ra_svn_commit(). */
@@ -1540,6 +1926,11 @@ commit(svn_ra_svn_conn_t *conn,
                    ? svn_string_create(b->client_info->user, pool)
                    : NULL);
 
+  /* On a read replica, forward the whole commit to the master. */
+  if (b->repository->master_url)
+    return proxy_commit(conn, b, revprop_table, lock_tokens, keep_locks,
+                        pool);
+
   ccb.pool = pool;
   ccb.new_rev = &new_rev;
   ccb.date = &date;
@@ -1582,6 +1973,11 @@ commit(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Minimum content size in bytes before get_file attempts zero-copy
+   delivery.  Smaller contents are cheap to copy and tend to be served
+   from the cache anyway. */
+#define GET_FILE_SENDFILE_THRESHOLD (64 * 1024)
+
 static svn_error_t *
 get_file(svn_ra_svn_conn_t *conn,
          apr_pool_t *pool,
@@ -1603,6 +1999,9 @@ get_file(svn_ra_svn_conn_t *conn,
   svn_checksum_t *checksum;
   svn_error_t *err, *write_err;
   int i;
+  apr_file_t *raw_file = NULL;
+  apr_off_t raw_offset = 0;
+  svn_filesize_t raw_len = 0;
   authz_baton_t ab;
 
   ab.server = b;
@@ -1647,7 +2046,46 @@ get_file(svn_ra_svn_conn_t *conn,
                           &ab, root, full_path,
                           pool));
   if (want_contents)
-    SVN_CMD_ERR(svn_fs_file_contents(&contents, root, full_path, pool));
+    {
+      /* If the connection can send file data without copying it through
+         user space, ask the FS layer whether the contents are stored as
+         a raw fulltext in some rev / pack file.  That is only the case
+         for non-deltified, non-compressed representations; everything
+         else takes the generic stream path below. */
+      if (svn_ra_svn__can_sendfile(conn))
+        {
+          svn_fs_fs__ioctl_get_raw_contents_input_t input;
+          void *output_void;
+
+          input.root = root;
+          input.path = full_path;
+          err = svn_fs_ioctl(b->repository->fs,
+                             SVN_FS_FS__IOCTL_GET_RAW_CONTENTS,
+                             &input, &output_void, NULL, NULL, pool, pool);
+          if (err)
+            {
+              /* Other FS backends don't implement this ioctl; genuine
+                 I/O problems will resurface in the fallback path. */
+              svn_error_clear(err);
+            }
+          else
+            {
+              svn_fs_fs__ioctl_get_raw_contents_output_t *output
+                = output_void;
+
+              if (output->available
+                  && output->len >= GET_FILE_SENDFILE_THRESHOLD)
+                {
+                  raw_file = output->file;
+                  raw_offset = output->offset;
+                  raw_len = output->len;
+                }
+            }
+        }
+
+      if (!raw_file)
+        SVN_CMD_ERR(svn_fs_file_contents(&contents, root, full_path, pool));
+    }
 
   /* Send successful command response with revision and props. */
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "w((?c)r(!", "success",
@@ -1677,7 +2115,16 @@ get_file(svn_ra_svn_conn_t *conn,
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!))"));
 
   /* Now send the file's contents. */
-  if (want_contents)
+  if (want_contents && raw_file)
+    {
+      /* Zero-copy path.  Errors from here on may leave partial framing
+         on the wire and are therefore fatal for the connection. */
+      SVN_ERR(svn_ra_svn__write_from_file(conn, pool, raw_file,
+                                          raw_offset, raw_len));
+      SVN_ERR(svn_ra_svn__write_cstring(conn, pool, ""));
+      SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+    }
+  else if (want_contents)
     {
       err = SVN_NO_ERROR;
       while (1)
@@ -2441,17 +2888,19 @@ log_cmd(svn_ra_svn_conn_t *conn,
   svn_ra_svn__item_t *elt;
   int i;
   apr_uint64_t limit, include_merged_revs_param;
+  const char *resume_token, *next_resume_token;
   log_baton_t lb;
   authz_baton_t ab;
 
   ab.server = b;
   ab.conn = conn;
 
-  SVN_ERR(svn_ra_svn__parse_tuple(params, "l(?r)(?r)bb?n?Bwl", &paths,
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "l(?r)(?r)bb?n?Bwl?c", &paths,
                                   &start_rev, &end_rev, &send_changed_paths,
                                   &strict_node, &limit,
                                   &include_merged_revs_param,
-                                  &revprop_word, &revprop_items));
+                                  &revprop_word, &revprop_items,
+                                  &resume_token));
 
   if (include_merged_revs_param == SVN_RA_SVN_UNSPECIFIED_NUMBER)
     include_merged_revisions = FALSE;
@@ -2511,18 +2960,22 @@ log_cmd(svn_ra_svn_conn_t *conn,
                                    strict_node, include_merged_revisions,
                                    revprops, pool)));
 
-  /* Get logs.  (Can't report errors back to the client at this point.) */
+  /* Get logs.  (Can't report errors back to the client at this point.)
+     Continuation requests carry a resume token; restarting the walk at
+     the token's revision avoids re-scanning the pages already sent. */
   lb.fs_path = b->repository->fs_path->data;
   lb.conn = conn;
   lb.stack_depth = 0;
   lb.started = FALSE;
-  err = svn_repos_get_logs5(b->repository->repos, full_paths, start_rev,
-                            end_rev, (int) limit,
+  next_resume_token = NULL;
+  err = svn_repos__get_logs_resumable(b->repository->repos, full_paths,
+                            start_rev, end_rev, (int) limit,
                             strict_node, include_merged_revisions,
-                            revprops, authz_check_access_cb_func(b), &ab,
+                            revprops, resume_token, &next_resume_token,
+                            authz_check_access_cb_func(b), &ab,
                             send_changed_paths ? path_change_receiver : NULL,
                             send_changed_paths ? &lb : NULL,
-                            revision_receiver, &lb, pool);
+                            revision_receiver, &lb, pool, pool);
 
   write_err = svn_ra_svn__write_word(conn, pool, "done");
   if (write_err)
@@ -2531,7 +2984,10 @@ log_cmd(svn_ra_svn_conn_t *conn,
       return write_err;
     }
   SVN_CMD_ERR(err);
-  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+
+  /* Old clients ignore the extra response element. */
+  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, "(?c)",
+                                         next_resume_token));
   return SVN_NO_ERROR;
 }
 
@@ -2879,9 +3335,12 @@ static svn_error_t *file_rev_handler(void *baton, const char *path,
       svn_stream_set_write(stream, svndiff_handler);
       svn_stream_set_close(stream, svndiff_close_handler);
 
-      svn_txdelta_to_svndiff3(d_handler, d_baton, stream,
-                              svn_ra_svn__svndiff_version(frb->conn),
-                              svn_ra_svn_compression_level(frb->conn), pool);
+      /* Compress the windows on a background thread; the writes to
+         STREAM stay on the connection thread. */
+      svn_txdelta__to_svndiff_pipelined(d_handler, d_baton, stream,
+                                        svn_ra_svn__svndiff_version(frb->conn),
+                                        svn_ra_svn_compression_level(frb->conn),
+                                        pool);
     }
   else
     SVN_ERR(svn_ra_svn__write_cstring(frb->conn, pool, ""));
@@ -2975,6 +3434,7 @@ lock(svn_ra_svn_conn_t *conn,
   SVN_ERR(log_command(b, conn, pool, "%s",
                       svn_log__lock_one_path(full_path, steal_lock, pool)));
 
+  SVN_CMD_ERR(reject_locks_on_replica(b));
   SVN_CMD_ERR(svn_repos_fs_lock(&l, b->repository->repos, full_path, NULL,
                                 comment, 0, 0, /* No expiration time. */
                                 current_rev, steal_lock, pool));
@@ -3089,6 +3549,8 @@ lock_many(svn_ra_svn_conn_t *conn,
   SVN_ERR(log_command(b, conn, subpool, "%s",
                       svn_log__lock(targets, steal_lock, subpool)));
 
+  SVN_CMD_ERR(reject_locks_on_replica(b));
+
   /* Check authz.
 
      Note: From here on we need to make sure any errors in authz_results, or
@@ -3211,6 +3673,7 @@ unlock(svn_ra_svn_conn_t *conn,
   SVN_ERR(log_command(b, conn, pool, "%s",
                       svn_log__unlock_one_path(full_path, break_lock, pool)));
 
+  SVN_CMD_ERR(reject_locks_on_replica(b));
   SVN_CMD_ERR(svn_repos_fs_unlock(b->repository->repos, full_path, token,
                                   break_lock, pool));
 
@@ -3274,6 +3737,8 @@ unlock_many(svn_ra_svn_conn_t *conn,
   SVN_ERR(log_command(b, conn, subpool, "%s",
                       svn_log__unlock(targets, break_lock, subpool)));
 
+  SVN_CMD_ERR(reject_locks_on_replica(b));
+
   /* Check authz.
 
      Note: From here on we need to make sure any errors in authz_results, or
@@ -3780,6 +4245,94 @@ list(svn_ra_svn_conn_t *conn,
   return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
 }
 
+/* Baton type to be used with proplist_receiver. */
+typedef struct proplist_receiver_baton_t
+{
+  /* Send the data through this connection. */
+  svn_ra_svn_conn_t *conn;
+} proplist_receiver_baton_t;
+
+/* Implements svn_repos__proplist_receiver_t, sending PATH, KIND and PROPS
+ * to the client.  BATON must be a proplist_receiver_baton_t. */
+static svn_error_t *
+proplist_receiver(const char *path,
+                  svn_node_kind_t kind,
+                  apr_hash_t *props,
+                  void *baton,
+                  apr_pool_t *pool)
+{
+  proplist_receiver_baton_t *b = baton;
+
+  SVN_ERR(svn_ra_svn__write_tuple(b->conn, pool, "cw(!", path,
+                                  svn_node_kind_to_word(kind)));
+  SVN_ERR(svn_ra_svn__write_proplist(b->conn, pool, props));
+  SVN_ERR(svn_ra_svn__write_tuple(b->conn, pool, "!)"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the versioned properties of a whole sub-tree in a single walk,
+ * saving the client one 'get-dir' round trip per directory. */
+static svn_error_t *
+proplist(svn_ra_svn_conn_t *conn,
+         apr_pool_t *pool,
+         svn_ra_svn__list_t *params,
+         void *baton)
+{
+  server_baton_t *b = baton;
+  const char *path, *full_path, *canonical_path;
+  svn_revnum_t rev;
+  svn_depth_t depth;
+  svn_fs_root_t *root;
+  const char *depth_word;
+  proplist_receiver_baton_t rb;
+  svn_error_t *err, *write_err;
+
+  authz_baton_t ab;
+  ab.server = b;
+  ab.conn = conn;
+
+  /* Read the command parameters. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "c(?r)w", &path, &rev,
+                                  &depth_word));
+
+  depth = svn_depth_from_word(depth_word);
+  SVN_ERR(svn_relpath_canonicalize_safe(&canonical_path, NULL, path,
+                                        pool, pool));
+  full_path = svn_fspath__join(b->repository->fs_path->data,
+                               canonical_path, pool);
+
+  /* Check authorizations */
+  SVN_ERR(must_have_access(conn, pool, b, svn_authz_read,
+                           full_path, FALSE));
+
+  if (!SVN_IS_VALID_REVNUM(rev))
+    SVN_CMD_ERR(svn_fs_youngest_rev(&rev, b->repository->fs, pool));
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__proplist(full_path, rev, depth, pool)));
+
+  /* Fetch the root of the appropriate revision. */
+  SVN_CMD_ERR(svn_fs_revision_root(&root, b->repository->fs, rev, pool));
+
+  /* Walk the tree and stream the (path, kind, props) tuples. */
+  rb.conn = conn;
+  err = svn_repos__proplist(root, full_path, depth,
+                            authz_check_access_cb_func(b), &ab,
+                            proplist_receiver, &rb, NULL, NULL, pool);
+
+  /* Finish response. */
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
 static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "reparent",        reparent },
   { "get-latest-rev",  get_latest_rev },
@@ -3813,6 +4366,7 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "get-deleted-rev", get_deleted_rev },
   { "get-iprops",      get_inherited_props },
   { "list",            list },
+  { "proplist",        proplist },
   { NULL }
 };
 
@@ -4238,12 +4792,16 @@ construct_server_baton(server_baton_t **baton,
   /* Send greeting.  We don't support version 1 any more, so we can
    * send an empty mechlist. */
   if (params->compression_level > 0)
+#ifdef SVN_HAVE_ZSTD
+    /* Only accept the zstd-based svndiff3 format and offer zstd frame
+     * compression if we can decode them. */
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
                                            SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+                                           SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
                                            SVN_RA_SVN_CAP_COMMIT_REVPROPS,
                                            SVN_RA_SVN_CAP_DEPTH,
@@ -4253,11 +4811,35 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_PUT_FILE,
+                                           SVN_RA_SVN_CAP_FRAME_COMPRESSION_LZ4,
+                                           SVN_RA_SVN_CAP_FRAME_COMPRESSION_ZSTD
                                            ));
+#else
+    SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
+                                           "nn()(wwwwwwwwwwwwwww)",
+                                           (apr_uint64_t) 2, (apr_uint64_t) 2,
+                                           SVN_RA_SVN_CAP_EDIT_PIPELINE,
+                                           SVN_RA_SVN_CAP_SVNDIFF1,
+                                           SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+                                           SVN_RA_SVN_CAP_ABSENT_ENTRIES,
+                                           SVN_RA_SVN_CAP_COMMIT_REVPROPS,
+                                           SVN_RA_SVN_CAP_DEPTH,
+                                           SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                           SVN_RA_SVN_CAP_ATOMIC_REVPROPS,
+                                           SVN_RA_SVN_CAP_PARTIAL_REPLAY,
+                                           SVN_RA_SVN_CAP_INHERITED_PROPS,
+                                           SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
+                                           SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_PUT_FILE,
+                                           SVN_RA_SVN_CAP_FRAME_COMPRESSION_LZ4
+                                           ));
+#endif
   else
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -4269,7 +4851,8 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_PUT_FILE
                                            ));
 
   /* Read client response, which we assume to be in version 2 format:
@@ -4296,6 +4879,19 @@ construct_server_baton(server_baton_t **baton,
     return svn_error_create(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
                             "Missing edit-pipeline capability");
 
+  /* If the client echoed one of the frame compression capabilities we
+   * advertised, switch the transport to compressed frames now.  The
+   * client makes the same decision right after sending its response,
+   * so everything from the auth request onwards is framed. */
+  if (params->compression_level > 0)
+    {
+      int method = svn_ra_svn__preferred_frame_compression(conn);
+
+      if (method != SVN_RA_SVN__FRAME_COMPRESSION_NONE)
+        SVN_ERR(svn_ra_svn__enable_frame_compression(conn, method,
+                                                     scratch_pool));
+    }
+
   /* find_repos needs the capabilities as a list of words (eventually
      they get handed to the start-commit hook).  While we could add a
      new interface to re-retrieve them from conn and convert the
@@ -4340,6 +4936,16 @@ construct_server_baton(server_baton_t **baton,
                                        handle_authz_warning, b,
                                        conn_pool, scratch_pool),
                             b);
+  if (!err && params->master_url)
+    {
+      /* The master mirrors our --root, so the repository sits at the
+         same path below the master URL. */
+      b->repository->master_url = b->repository->authz_repos_name
+        ? svn_path_url_add_component2(params->master_url,
+                                      b->repository->authz_repos_name,
+                                      conn_pool)
+        : params->master_url;
+    }
   if (!err)
     {
       if (b->repository->anon_access == NO_ACCESS
@@ -4453,6 +5059,38 @@ serve_interruptable(svn_boolean_t *terminate_p,
     {
       apr_status_t ar;
 
+      /* Apply the configured socket buffer sizes, if any.  The OS
+       * default (typically autotuned) buffers stall on high-latency
+       * links, so admins of WAN-facing servers may configure larger
+       * ones via --sock-buffer-size. */
+      if (connection->params->sock_buffer_size > 0)
+        {
+          apr_size_t size = connection->params->sock_buffer_size;
+
+          /* It's not a fatal error if the OS rejects these. */
+          ar = apr_socket_opt_set(connection->usock, APR_SO_SNDBUF,
+                                  (apr_int32_t)size);
+          ar = apr_socket_opt_set(connection->usock, APR_SO_RCVBUF,
+                                  (apr_int32_t)size);
+
+#ifdef TCP_NOTSENT_LOWAT
+          /* A large send buffer lets us queue far more unsent data than
+           * needed to keep the link busy, hurting interactive latency
+           * on fast networks.  Cap the unsent backlog at a quarter of
+           * the buffer where the OS supports it. */
+          {
+            apr_os_sock_t fd;
+
+            if (apr_os_sock_get(&fd, connection->usock) == APR_SUCCESS)
+              {
+                int lowat = (int)(size / 4);
+                setsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT,
+                           (const void *)&lowat, sizeof(lowat));
+              }
+          }
+#endif
+        }
+
       /* Enable TCP keep-alives on the socket so we time out when
        * the connection breaks due to network-layer problems.
        * If the peer has dropped the connection due to a network partition
@@ -4500,10 +5138,8 @@ serve_interruptable(svn_boolean_t *terminate_p,
           err = svn_ra_svn__has_command(&has_command, &terminate,
                                         connection->conn, iterpool);
           if (!err && has_command)
-            err = svn_ra_svn__handle_command(&terminate, cmd_hash,
-                                             connection->baton,
-                                             connection->conn,
-                                             FALSE, iterpool);
+            err = handle_command_with_telemetry(&terminate, cmd_hash,
+                                                connection, iterpool);
 
           break;
         }
@@ -4514,10 +5150,8 @@ serve_interruptable(svn_boolean_t *terminate_p,
            * busy() callback test to return TRUE while there are still some
            * resources left.
            */
-          err = svn_ra_svn__handle_command(&terminate, cmd_hash,
-                                           connection->baton,
-                                           connection->conn,
-                                           FALSE, iterpool);
+          err = handle_command_with_telemetry(&terminate, cmd_hash,
+                                              connection, iterpool);
         }
     }
 
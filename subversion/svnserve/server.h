@@ -33,6 +33,7 @@ extern "C" {
 #endif /* __cplusplus */
 
 #include "svn_config.h"
+#include "svn_ra.h"
 #include "svn_repos.h"
 #include "svn_ra_svn.h"
 
@@ -73,6 +74,12 @@ typedef struct repository_t {
   enum access_type auth_access; /* access granted to authenticated users */
   enum access_type anon_access; /* access granted to anonymous users */
 
+  const char *master_url;  /* URL of the master repository if this is a
+                              read replica, else NULL */
+  svn_ra_session_t *master_session;
+                           /* Lazily opened session to MASTER_URL; NULL
+                              until the first proxied write command */
+
 } repository_t;
 
 typedef struct client_info_t {
@@ -90,6 +97,11 @@ typedef struct server_baton_t {
                               May be NULL even if log_file is not. */
   svn_boolean_t read_only; /* Disallow write access (global flag) */
   svn_boolean_t vhost;     /* Use virtual-host-based path to repo. */
+  apr_uint64_t peak_rss;   /* Peak process RSS in kBytes at the time of
+                              the last logged command; 0 if unknown.
+                              Used to log memory high-water growth. */
+  apr_uint64_t command_count; /* Number of commands received on this
+                                 connection; used for telemetry sampling. */
   apr_pool_t *pool;
 } server_baton_t;
 
@@ -159,6 +171,22 @@ typedef struct serve_params_t {
 
   /* Use virtual-host-based path to repo. */
   svn_boolean_t vhost;
+
+  /* If not NULL, the served repositories are read replicas of the
+     repositories below this URL.  Read commands are answered from the
+     local mirror; commits and revision property changes are proxied
+     to the master. */
+  const char *master_url;
+
+  /* If not 0, write a JSON telemetry record (duration, bytes in / out,
+     cache hit rates) for every Nth command on each connection to the
+     log file. */
+  apr_uint64_t telemetry_sample_rate;
+
+  /* If not 0, set the TCP send and receive buffers of client
+     connections to this many bytes instead of relying on the OS
+     defaults / autotuning. */
+  apr_size_t sock_buffer_size;
 } serve_params_t;
 
 /* This structure contains all data that describes a client / server
@@ -28,6 +28,7 @@
 #include <apr_general.h>
 #include <apr_getopt.h>
 #include <apr_network_io.h>
+#include <apr_poll.h>
 #include <apr_signal.h>
 #include <apr_thread_proc.h>
 #include <apr_portable.h>
@@ -52,10 +53,13 @@
 
 #include "svn_private_config.h"
 
+#include "private/svn_cache.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_cmdline_private.h"
 #include "private/svn_atomic.h"
 #include "private/svn_mutex.h"
+#include "private/svn_perf.h"
+#include "private/svn_ra_svn_private.h"
 #include "private/svn_subr_private.h"
 
 #if APR_HAS_THREADS
@@ -145,6 +149,13 @@ enum run_mode {
  */
 #define THREADPOOL_THREAD_IDLE_LIMIT 1000000
 
+/* Maximum number of pollset events to process per call in the idle
+ * connection poller.  With the epoll / kqueue based pollset backends,
+ * this merely limits how many wakeups get handled in a single batch;
+ * the number of parked connections is unbounded.
+ */
+#define POLLSET_SIZE 4096
+
 /* Number of client to server connections that may concurrently in the
  * TCP 3-way handshake state, i.e. are in the process of being created.
  *
@@ -222,6 +233,10 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_CACHE_IMAGE     277
+#define SVNSERVE_OPT_MASTER_URL      278
+#define SVNSERVE_OPT_LOG_TELEMETRY   279
+#define SVNSERVE_OPT_SOCK_BUFFER     280
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -297,6 +312,16 @@ static const apr_getopt_option_t svnserve__options[] =
         "0 switches to dynamically sized caches.\n"
         "                             "
         "[used for FSFS and FSX repositories only]")},
+    {"cache-image", SVNSERVE_OPT_CACHE_IMAGE, 1,
+     N_("warm-start image file for the in-memory cache.\n"
+        "                             "
+        "If the file exists at startup, the cache will be\n"
+        "                             "
+        "pre-loaded from it; on normal exit, the current\n"
+        "                             "
+        "cache contents will be saved back to it.\n"
+        "                             "
+        "[used for FSFS and FSX repositories only]")},
     {"cache-txdeltas", SVNSERVE_OPT_CACHE_TXDELTAS, 1,
      N_("enable or disable caching of deltas between older\n"
         "                             "
@@ -333,6 +358,18 @@ static const apr_getopt_option_t svnserve__options[] =
         "ARG Mbit/s.\n"
         "                             "
         "Default is 0 (optimizations disabled).")},
+    {"sock-buffer-size", SVNSERVE_OPT_SOCK_BUFFER, 1,
+     N_("set the TCP send and receive buffers of client\n"
+        "                             "
+        "connections to ARG bytes.  Larger buffers improve\n"
+        "                             "
+        "throughput on high-latency links; where the OS\n"
+        "                             "
+        "supports it, the unsent backlog is capped at a\n"
+        "                             "
+        "quarter of ARG to preserve interactive latency.\n"
+        "                             "
+        "Default is 0 (keep the OS defaults / autotuning).")},
     {"block-read", SVNSERVE_OPT_BLOCK_READ, 1,
      N_("Parse and cache all data found in block instead\n"
         "                             "
@@ -386,6 +423,26 @@ static const apr_getopt_option_t svnserve__options[] =
         "checking out at the wrong path level.\n"
         "                             "
         "Default is 0 (disabled).")},
+    {"master-url",       SVNSERVE_OPT_MASTER_URL, 1,
+     N_("act as a read replica of the repositories at\n"
+        "                             "
+        "URL ARG, which mirrors this server's --root.\n"
+        "                             "
+        "Read commands are served from the local mirror\n"
+        "                             "
+        "(maintained e.g. with svnsync); commits and\n"
+        "                             "
+        "revision property changes are proxied to the\n"
+        "                             "
+        "master.  Lock commands are rejected.")},
+    {"log-telemetry",    SVNSERVE_OPT_LOG_TELEMETRY, 1,
+     N_("write a JSON telemetry record (duration, bytes\n"
+        "                             "
+        "in / out, cache hit rates) for every ARG-th\n"
+        "                             "
+        "client command to the log file.  1 records\n"
+        "                             "
+        "every command; default is 0 (disabled).")},
     {"foreground",        SVNSERVE_OPT_FOREGROUND, 0,
      N_("run in foreground (useful for debugging)\n"
         "                             "
@@ -605,6 +662,10 @@ serve_socket(connection_t *connection,
   return svn_error_trace(err);
 }
 
+/* Path of the membuffer cache warm-start image file, or NULL.
+   See the --cache-image option. */
+static const char *cache_image_path;
+
 #if APR_HAS_THREADS
 
 /* allocate and recycle root pools for connection objects.
@@ -614,6 +675,14 @@ static svn_root_pools__t *connection_pools;
 /* The global thread pool serving all connections. */
 static apr_thread_pool_t *threads;
 
+/* The pollset where idle connections get parked while the thread pool
+   is busy, or NULL if no thread-safe pollset is available on this
+   platform.  APR implements this via epoll, kqueue etc. where possible,
+   so thousands of parked connections cost a few bytes of kernel state
+   each instead of a queued thread pool task.  poll_thread() moves them
+   back into the thread pool once their sockets become readable. */
+static apr_pollset_t *pollset;
+
 /* Very simple load determination callback for serve_interruptable:
    With less than half the threads in THREADS in use, we can afford to
    wait in the socket read() function.  Otherwise, poll them round-robin. */
@@ -624,9 +693,66 @@ is_busy(connection_t *connection)
        > apr_thread_pool_thread_max_get(threads);
 }
 
+/* Add CONNECTION to the global POLLSET, waiting for incoming data or a
+   hang-up on its socket.  Returns TRUE on success.  The caller must have
+   verified that no complete command is already waiting in the
+   connection's receive buffers - data sitting there is invisible to the
+   poller and the connection would stall until the client sends more. */
+static svn_boolean_t
+park_connection(connection_t *connection)
+{
+  apr_pollfd_t pfd = { 0 };
+
+  pfd.desc_type = APR_POLL_SOCKET;
+  pfd.desc.s = connection->usock;
+  pfd.reqevents = APR_POLLIN | APR_POLLHUP | APR_POLLERR;
+  pfd.client_data = connection;
+
+  return apr_pollset_add(pollset, &pfd) == APR_SUCCESS;
+}
+
+/* Forward declaration, serve_thread and poll_thread re-schedule each
+   other's connections. */
+static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data);
+
+/* Thread routine waiting on the parked connections in POLLSET and
+   moving them back into the worker thread pool as soon as their sockets
+   become readable (or report an error / hang-up, in which case the
+   worker will run into it and close the connection). */
+static void * APR_THREAD_FUNC poll_thread(apr_thread_t *tid, void *data)
+{
+  while (TRUE)
+    {
+      apr_int32_t num = 0;
+      apr_int32_t i;
+      const apr_pollfd_t *descriptors = NULL;
+      apr_status_t status = apr_pollset_poll(pollset, -1, &num,
+                                             &descriptors);
+
+      if (status && !APR_STATUS_IS_EINTR(status)
+          && !APR_STATUS_IS_TIMEUP(status))
+        {
+          /* Transient resource shortage etc.  Don't spin on it. */
+          apr_sleep(apr_time_from_sec(1));
+          continue;
+        }
+
+      for (i = 0; i < num; i++)
+        {
+          connection_t *connection = descriptors[i].client_data;
+
+          apr_pollset_remove(pollset, &descriptors[i]);
+          apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
+        }
+    }
+
+  /* NOTREACHED */
+}
+
 /* Serve the connection given by DATA.  Under high load, serve only
-   the current command (if any) and then put the connection back into
-   THREAD's task pool. */
+   the current command (if any) and then park the connection in the
+   pollset until more data arrives - or, lacking a pollset, put it back
+   into THREAD's task pool. */
 static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
 {
   svn_boolean_t done;
@@ -645,6 +771,33 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
       svn_error_clear(err);
       done = TRUE;
     }
+
+  /* If the connection went idle, i.e. there is no further command either
+     buffered or pending on the socket, park it in the pollset instead of
+     letting it rotate through the thread pool.  Memory and thread usage
+     then scale with the number of active requests rather than the number
+     of open connections. */
+  if (!done && pollset)
+    {
+      svn_boolean_t has_command;
+
+      err = svn_ra_svn__has_command(&has_command, &done, connection->conn,
+                                    pool);
+      if (err)
+        {
+          logger__log_error(connection->params->logger, err, NULL,
+                            get_client_info(connection->conn,
+                                            connection->params, pool));
+          svn_error_clear(err);
+          done = TRUE;
+        }
+      else if (!done && !has_command && park_connection(connection))
+        {
+          svn_root_pools__release_pool(pool, connection_pools);
+          return NULL;
+        }
+    }
+
   svn_root_pools__release_pool(pool, connection_pools);
 
   /* Close or re-schedule connection. */
@@ -774,6 +927,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   params.error_check_interval = 4096;
   params.max_request_size = MAX_REQUEST_SIZE * 0x100000;
   params.max_response_size = 0;
+  params.master_url = NULL;
+  params.telemetry_sample_rate = 0;
+  params.sock_buffer_size = 0;
 
   while (1)
     {
@@ -909,6 +1065,12 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           }
           break;
 
+        case SVNSERVE_OPT_CACHE_IMAGE:
+          SVN_ERR(svn_utf_cstring_to_utf8(&cache_image_path, arg, pool));
+          cache_image_path = svn_dirent_internal_style(cache_image_path,
+                                                       pool);
+          break;
+
         case SVNSERVE_OPT_CACHE_TXDELTAS:
           cache_txdeltas = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
@@ -954,6 +1116,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           params.max_response_size = 0x100000 * apr_strtoi64(arg, NULL, 0);
           break;
 
+        case SVNSERVE_OPT_LOG_TELEMETRY:
+          params.telemetry_sample_rate = apr_strtoi64(arg, NULL, 0);
+          break;
+
+        case SVNSERVE_OPT_SOCK_BUFFER:
+          params.sock_buffer_size = (apr_size_t)apr_strtoi64(arg, NULL, 0);
+          break;
+
         case SVNSERVE_OPT_MIN_THREADS:
           min_thread_count = (apr_size_t)apr_strtoi64(arg, NULL, 0);
           break;
@@ -972,6 +1142,18 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           break;
 #endif
 
+        case SVNSERVE_OPT_MASTER_URL:
+          {
+            const char *master_url;
+
+            SVN_ERR(svn_utf_cstring_to_utf8(&master_url, arg, pool));
+            if (!svn_path_is_url(master_url))
+              return svn_error_createf(SVN_ERR_BAD_URL, NULL,
+                                       _("'%s' is not a URL"), master_url);
+            params.master_url = svn_uri_canonicalize(master_url, pool);
+          }
+          break;
+
         case SVNSERVE_OPT_CONFIG_FILE:
           SVN_ERR(svn_utf_cstring_to_utf8(&config_filename, arg, pool));
           config_filename = svn_dirent_internal_style(config_filename, pool);
@@ -1049,6 +1231,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                 cache_revprops ? "2" :"0");
   svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSFS_BLOCK_READ,
                 use_block_read ? "1" :"0");
+  svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSFS_CACHE_PRIORITY,
+                "high");
 
   SVN_ERR(svn_repos__config_pool_create(&params.config_pool,
                                         is_multi_threaded,
@@ -1295,8 +1479,48 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       }
 
     svn_cache_config_set(&settings);
+
+    /* When forking a process per connection, let all children share one
+     * cache in shared memory instead of filling many small per-process
+     * caches with the same data.  The cache must exist before the first
+     * fork(), so create it right away.  Where shared memory is not
+     * available, this silently keeps the per-process behavior. */
+    if (handling_mode == connection_mode_fork && settings.cache_size > 0)
+      {
+        svn_cache__set_global_membuffer_cache_shared();
+        svn_cache__get_global_membuffer_cache();
+      }
   }
 
+  /* If we have a warm-start image from a previous run, pre-load the
+   * cache from it.  A missing image file is not an error - there is
+   * simply nothing to warm up with. */
+  if (cache_image_path)
+    {
+      svn_node_kind_t kind;
+
+      SVN_ERR(svn_io_check_path(cache_image_path, &kind, pool));
+      if (kind == svn_node_file)
+        {
+          svn_membuffer_t *membuffer
+            = svn_cache__get_global_membuffer_cache();
+
+          if (membuffer)
+            {
+              /* A stale or corrupt image shall never prevent the server
+               * from starting. */
+              err = svn_cache__membuffer_load_image(membuffer,
+                                                    cache_image_path,
+                                                    pool);
+              if (err)
+                {
+                  svn_error_clear(err);
+                  err = SVN_NO_ERROR;
+                }
+            }
+        }
+    }
+
 #if APR_HAS_THREADS
   SVN_ERR(svn_root_pools__create(&connection_pools));
 
@@ -1323,6 +1547,28 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
       /* don't queue requests unless we reached the worker thread limit */
       apr_thread_pool_threshold_set(threads, 0);
+
+      /* Create the parking lot for idle connections plus the thread
+         waiting on it.  If the platform does not provide a thread-safe
+         pollset (or no thread can be created), we simply keep cycling
+         idle connections through the thread pool as before. */
+      status = apr_pollset_create(&pollset, POLLSET_SIZE, pool,
+                                  APR_POLLSET_THREADSAFE);
+      if (status)
+        {
+          pollset = NULL;
+        }
+      else
+        {
+          apr_thread_t *tid;
+
+          status = apr_thread_create(&tid, NULL, poll_thread, NULL, pool);
+          if (status)
+            {
+              apr_pollset_destroy(pollset);
+              pollset = NULL;
+            }
+        }
     }
   else
     {
@@ -1410,6 +1656,18 @@ main(int argc, const char *argv[])
 
   err = sub_main(&exit_code, argc, argv, pool);
 
+  /* On normal exit, save the current cache contents as the warm-start
+   * image for the next run.  Modes that serve until being killed will
+   * not reach this point - they keep whatever image they started with. */
+  if (!err && cache_image_path)
+    {
+      svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+      if (membuffer)
+        err = svn_cache__membuffer_dump_image(membuffer, cache_image_path,
+                                              pool);
+    }
+
   /* Flush stdout and report if it fails. It would be flushed on exit anyway
      but this makes sure that output is not silently lost if it fails. */
   err = svn_error_compose_create(err, svn_cmdline_fflush(stdout));
@@ -1428,6 +1686,14 @@ main(int argc, const char *argv[])
     apr_thread_pool_destroy(threads);
 #endif
 
+  /* In instrumented builds, dump the probe statistics to the file named
+   * by $SVN_PERF_REPORT, if any.  A no-op in regular builds. */
+  svn_perf__maybe_write_report(pool);
+
+  /* Likewise for per-namespace cache statistics and the file named by
+   * $SVN_CACHE_STATS; this one works in any build. */
+  svn_cache__maybe_write_stats_report(pool);
+
   /* this will also close the server's socket */
   svn_pool_destroy(pool);
   return exit_code;
@@ -1398,7 +1398,14 @@ replay_rev_finished(svn_revnum_t revision,
 
   rev_str = svn_string_createf(subpool, "%ld", revision);
 
-  /* Ok, we're done, bring the last-merged-rev property up to date. */
+  /* Ok, we're done, bring the last-merged-rev property up to date.
+
+     We deliberately leave the currently-copying prop in place: with
+     last-merged-rev equal to it, a restarted sync recognizes the
+     revision as fully copied, and the next replay_rev_started simply
+     overwrites the stale value.  Dropping it here would cost one more
+     round trip to the mirror for every replayed revision; instead
+     do_synchronize() drops it once after the whole range. */
   SVN_ERR(svn_ra_change_rev_prop2(
            rb->to_session,
            0,
@@ -1407,14 +1414,6 @@ replay_rev_finished(svn_revnum_t revision,
            rev_str,
            subpool));
 
-  /* And finally drop the currently copying prop, since we're done
-     with this revision. */
-  SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
-                                  SVNSYNC_PROP_CURRENTLY_COPYING,
-                                  rb->has_atomic_revprops_capability
-                                    ? &rev_str : NULL,
-                                  NULL, subpool));
-
   /* Notify the user that we copied revision properties. */
   if (! rb->sb->quiet)
     SVN_ERR(log_properties_copied(filtered_count > 0, revision, subpool));
@@ -1560,6 +1559,20 @@ do_synchronize(svn_ra_session_t *to_session,
                               0, TRUE, replay_rev_started,
                               replay_rev_finished, rb, pool));
 
+  /* replay_rev_finished() leaves the currently-copying prop in place to
+     save a round trip per revision; drop it once now that the whole
+     range has been mirrored. */
+  {
+    const svn_string_t *rev_str = svn_string_createf(pool, "%ld",
+                                                     end_revision);
+
+    SVN_ERR(svn_ra_change_rev_prop2(to_session, 0,
+                                    SVNSYNC_PROP_CURRENTLY_COPYING,
+                                    rb->has_atomic_revprops_capability
+                                      ? &rev_str : NULL,
+                                    NULL, pool));
+  }
+
   SVN_ERR(log_properties_normalized(rb->normalized_rev_props_count
                                       + normalized_rev_props_count,
                                     rb->normalized_node_props_count,
@@ -38,6 +38,15 @@
 #include "svn_error.h"
 
 #include "../../libsvn_delta/delta.h"
+#include "svn_private_config.h"
+
+/* Number of svndiff versions to cycle through when encoding; version 3
+   requires zstd support. */
+#ifdef SVN_HAVE_ZSTD
+#define NUM_SVNDIFF_VERSIONS 4
+#else
+#define NUM_SVNDIFF_VERSIONS 3
+#endif
 #include "delta-window-test.h"
 
 
@@ -330,8 +339,8 @@ do_random_test(apr_pool_t *pool,
 
       /* Make stage 2: encode the text delta in svndiff format using
                        varying svndiff versions and compression levels. */
-      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream, i % 3,
-                              i % 10, delta_pool);
+      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream,
+                              i % NUM_SVNDIFF_VERSIONS, i % 10, delta_pool);
 
       /* Make stage 1: create the text delta.  */
       svn_txdelta2(&txdelta_stream,
@@ -426,8 +435,8 @@ do_random_combine_test(apr_pool_t *pool,
 
       /* Make stage 2: encode the text delta in svndiff format using
                        varying svndiff versions and compression levels. */
-      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream, i % 3,
-                              i % 10, delta_pool);
+      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream,
+                              i % NUM_SVNDIFF_VERSIONS, i % 10, delta_pool);
 
       /* Make stage 1: create the text deltas.  */
 
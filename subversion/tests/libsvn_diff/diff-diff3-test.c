@@ -3065,6 +3065,66 @@ three_way_double_add(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_two_way_histogram(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *diff_opts = svn_diff_file_options_create(pool);
+
+  diff_opts->use_histogram_diff = TRUE;
+
+  /* A simple substitution; histogram and the default algorithm agree. */
+  SVN_ERR(two_way_diff("foo17", "bar17",
+                       "Aa\n"
+                       "Bb\n"
+                       "Cc\n",
+
+                       "Aa\n"
+                       "Xx\n"
+                       "Cc\n",
+
+                       "--- foo17"        NL
+                       "+++ bar17"        NL
+                       "@@ -1,3 +1,3 @@"  NL
+                       " Aa\n"
+                       "-Bb\n"
+                       "+Xx\n"
+                       " Cc\n",
+                       diff_opts, pool));
+
+  /* Changes at both ends keep the identical prefix/suffix from being
+     stripped, so the histogram core has to anchor the repeated middle
+     lines on the unique ones. */
+  SVN_ERR(two_way_diff("foo17b", "bar17b",
+                       "Qq\n"
+                       "Aa\n"
+                       "Xx\n"
+                       "Xx\n"
+                       "Bb\n"
+                       "Rr\n",
+
+                       "Ww\n"
+                       "Aa\n"
+                       "Xx\n"
+                       "Xx\n"
+                       "Bb\n"
+                       "Ss\n",
+
+                       "--- foo17b"       NL
+                       "+++ bar17b"       NL
+                       "@@ -1,6 +1,6 @@"  NL
+                       "-Qq\n"
+                       "+Ww\n"
+                       " Aa\n"
+                       " Xx\n"
+                       " Xx\n"
+                       " Bb\n"
+                       "-Rr\n"
+                       "+Ss\n",
+                       diff_opts, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* ========================================================================== */
 
 
@@ -3109,6 +3169,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "2-way issue #3362 test v2"),
     SVN_TEST_XFAIL2(three_way_double_add,
                    "3-way merge, double add"),
+    SVN_TEST_PASS2(test_two_way_histogram,
+                   "2-way unified diff using the histogram algorithm"),
     SVN_TEST_NULL
   };
 
@@ -511,6 +511,54 @@ reposful_reposless_stanzas_inherit(apr_pool_t *pool)
    return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+wildcard_pattern_rules(apr_pool_t *pool)
+{
+   /* Rules whose wildcard segments do not reduce to the simple
+    * prefix / suffix / any cases, i.e. rules that exercise the
+    * general pattern matcher. */
+   const char rules[] =
+     "[:glob:/branches/rel-[0-9].[0-9]/*]" NL
+     "userA = rw"                          NL
+     ""                                    NL
+     "[:glob:/tags/*-final?]"              NL
+     "userB = r"                           NL
+     ;
+
+   svn_stringbuf_t *buf = svn_stringbuf_create(rules, pool);
+   svn_stream_t *stream = svn_stream_from_stringbuf(buf, pool);
+   svn_authz_t *authz;
+   svn_boolean_t access_granted;
+
+   SVN_ERR(svn_repos_authz_parse2(&authz, stream, NULL, NULL, NULL, pool, pool));
+
+   SVN_ERR(svn_repos_authz_check_access(authz, "repo",
+                                        "/branches/rel-1.7/README", "userA",
+                                        svn_authz_write, &access_granted,
+                                        pool));
+   SVN_TEST_ASSERT(access_granted == TRUE);
+
+   SVN_ERR(svn_repos_authz_check_access(authz, "repo",
+                                        "/branches/rel-17/README", "userA",
+                                        svn_authz_write, &access_granted,
+                                        pool));
+   SVN_TEST_ASSERT(access_granted == FALSE);
+
+   SVN_ERR(svn_repos_authz_check_access(authz, "repo",
+                                        "/tags/1.8-final1", "userB",
+                                        svn_authz_read, &access_granted,
+                                        pool));
+   SVN_TEST_ASSERT(access_granted == TRUE);
+
+   SVN_ERR(svn_repos_authz_check_access(authz, "repo",
+                                        "/tags/1.8-final", "userB",
+                                        svn_authz_read, &access_granted,
+                                        pool));
+   SVN_TEST_ASSERT(access_granted == FALSE);
+
+   return SVN_NO_ERROR;
+}
+
 static int max_threads = 4;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -522,6 +570,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test svn_authz__get_global_rights"),
     SVN_TEST_PASS2(issue_4741_groups,
                    "issue 4741 groups"),
+    SVN_TEST_PASS2(wildcard_pattern_rules,
+                   "wildcard rules with general patterns"),
     SVN_TEST_PASS2(reposful_reposless_stanzas_inherit,
                     "[foo:/] inherits [/]"),
     SVN_TEST_NULL
@@ -76,8 +76,9 @@ test_dump_bad_props(svn_stringbuf_t **dump_data_p,
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
 
   /* Test that a dump completes without error. */
-  SVN_ERR(svn_repos_dump_fs4(repos, stream, start_rev, end_rev,
+  SVN_ERR(svn_repos_dump_fs5(repos, stream, start_rev, end_rev,
                              FALSE, FALSE, TRUE, TRUE,
+                             1, FALSE,
                              notify_func, notify_baton,
                              NULL, NULL, NULL, NULL,
                              pool));
@@ -277,6 +278,56 @@ test_load_r0_mergeinfo(const svn_test_opts_t *opts,
 
 static int max_threads = 4;
 
+/* Check that a parallel dump produces exactly the same dumpstream as a
+ * serial dump of the same repository. */
+static svn_error_t *
+test_parallel_dump(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *serial_data = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *parallel_data = svn_stringbuf_create_empty(pool);
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-parallel-dump",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* A handful of revisions to dump. */
+  for (i = 0; i < 5; i++)
+    {
+      const char *path = apr_psprintf(pool, "/file-%d", i);
+      const char *contents = apr_psprintf(pool, "contents of %s\n", path);
+
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+      SVN_ERR(svn_fs_make_file(txn_root, path, pool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, path, contents, pool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+      SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+    }
+
+  /* Dump the whole repository, serially and with multiple threads. */
+  SVN_ERR(svn_repos_dump_fs5(repos,
+                             svn_stream_from_stringbuf(serial_data, pool),
+                             0, youngest_rev, FALSE, TRUE, TRUE, TRUE,
+                             1, FALSE, NULL, NULL, NULL, NULL, NULL, NULL,
+                             pool));
+  SVN_ERR(svn_repos_dump_fs5(repos,
+                             svn_stream_from_stringbuf(parallel_data, pool),
+                             0, youngest_rev, FALSE, TRUE, TRUE, TRUE,
+                             3, FALSE, NULL, NULL, NULL, NULL, NULL, NULL,
+                             pool));
+
+  SVN_TEST_ASSERT(svn_stringbuf_compare(serial_data, parallel_data));
+
+  return SVN_NO_ERROR;
+}
+
 static struct svn_test_descriptor_t test_funcs[] =
   {
     SVN_TEST_NULL,
@@ -284,6 +335,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test dumping with r0 mergeinfo"),
     SVN_TEST_OPTS_PASS(test_load_r0_mergeinfo,
                        "test loading with r0 mergeinfo"),
+    SVN_TEST_OPTS_PASS(test_parallel_dump,
+                       "parallel dump matches serial dump"),
     SVN_TEST_NULL
   };
 
@@ -0,0 +1,397 @@
+/*
+ * bench-primitives.c:  micro-benchmarks for hot library primitives
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ *
+ * This is not a test but a standalone benchmark driver for the
+ * primitives that dominate profiles of real-world svn operations:
+ * delta application, diff, skel parsing, UTF-8 validation and the
+ * membuffer cache.  Run it before and after an optimization to get
+ * per-operation costs; the workloads are deterministic, so runs are
+ * directly comparable on the same machine.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <apr_time.h>
+
+#include "svn_delta.h"
+#include "svn_diff.h"
+#include "svn_error.h"
+#include "svn_pools.h"
+#include "svn_string.h"
+
+#include "private/svn_cache.h"
+#include "private/svn_skel.h"
+#include "private/svn_string_private.h"
+#include "private/svn_utf_private.h"
+
+/* Size of the source / target texts used by the delta, diff and UTF-8
+ * benchmarks. */
+#define TEXT_SIZE (1024 * 1024)
+
+/* Simple deterministic PRNG, so every run benchmarks the same data.
+ * Returns STATE updated in place. */
+static apr_uint32_t
+prng_next(apr_uint32_t *state)
+{
+  *state = *state * 1103515245u + 12345u;
+  return (*state >> 16) & 0x7fff;
+}
+
+/* Print one result line.  OPS operations over BYTES bytes (0 if not
+ * meaningful) took TAKEN microseconds. */
+static void
+report(const char *name,
+       apr_uint64_t ops,
+       apr_uint64_t bytes,
+       apr_time_t taken)
+{
+  printf("%-30s %12" APR_UINT64_T_FMT " ops %10.1f ns/op",
+         name, ops, ops ? 1000.0 * (double)taken / (double)ops : 0.0);
+  if (bytes && taken)
+    printf(" %9.1f MB/s", (double)bytes / (double)taken);
+  printf("\n");
+  fflush(stdout);
+}
+
+/* Fill *ORIGINAL and *MODIFIED with a pseudo-text of TEXT_SIZE bytes
+ * made of short "words" and newlines, the latter differing from the
+ * former in roughly one out of SHARE lines. */
+static void
+make_texts(svn_stringbuf_t **original,
+           svn_stringbuf_t **modified,
+           int share,
+           apr_pool_t *pool)
+{
+  apr_uint32_t state = 42;
+  svn_stringbuf_t *text = svn_stringbuf_create_ensure(TEXT_SIZE, pool);
+  int column = 0;
+
+  while (text->len < TEXT_SIZE)
+    {
+      apr_uint32_t word = prng_next(&state);
+
+      svn_stringbuf_appendcstr(text,
+                               apr_psprintf(pool, "word%u ", word % 997));
+      if (++column == 8)
+        {
+          svn_stringbuf_appendbyte(text, '\n');
+          column = 0;
+        }
+    }
+
+  *original = text;
+  *modified = svn_stringbuf_dup(text, pool);
+
+  /* Tweak one byte in every SHARE-th line of the copy. */
+  {
+    apr_size_t i;
+    int line = 0;
+
+    for (i = 0; i < (*modified)->len; ++i)
+      if ((*modified)->data[i] == '\n')
+        if (++line % share == 0 && i > 0)
+          (*modified)->data[i - 1] = '#';
+  }
+}
+
+/* Benchmark svn_txdelta_apply_instructions() by repeatedly re-applying
+ * the windows of a delta between two similar 1MB texts. */
+static svn_error_t *
+bench_txdelta_apply(apr_pool_t *pool)
+{
+  svn_stringbuf_t *original, *modified;
+  svn_txdelta_stream_t *txstream;
+  apr_array_header_t *windows
+    = apr_array_make(pool, 16, sizeof(svn_txdelta_window_t *));
+  char *tbuf;
+  apr_size_t max_tview_len = 0;
+  apr_uint64_t ops = 0, bytes = 0;
+  apr_time_t started;
+  int i, k;
+
+  make_texts(&original, &modified, 20, pool);
+  svn_txdelta2(&txstream,
+               svn_stream_from_stringbuf(original, pool),
+               svn_stream_from_stringbuf(modified, pool),
+               FALSE, pool);
+
+  while (TRUE)
+    {
+      svn_txdelta_window_t *window;
+
+      SVN_ERR(svn_txdelta_next_window(&window, txstream, pool));
+      if (window == NULL)
+        break;
+      if (window->tview_len > max_tview_len)
+        max_tview_len = window->tview_len;
+      APR_ARRAY_PUSH(windows, svn_txdelta_window_t *) = window;
+    }
+
+  tbuf = apr_palloc(pool, max_tview_len);
+  started = apr_time_now();
+  for (i = 0; i < 200; ++i)
+    for (k = 0; k < windows->nelts; ++k)
+      {
+        svn_txdelta_window_t *window
+          = APR_ARRAY_IDX(windows, k, svn_txdelta_window_t *);
+        apr_size_t tlen = max_tview_len;
+
+        svn_txdelta_apply_instructions(window,
+                                       original->data + window->sview_offset,
+                                       tbuf, &tlen);
+        ++ops;
+        bytes += tlen;
+      }
+
+  report("txdelta_apply_instructions", ops, bytes, apr_time_now() - started);
+  return SVN_NO_ERROR;
+}
+
+/* Benchmark the LCS-based diff engine, via svn_diff_mem_string_diff(),
+ * on two similar 1MB texts. */
+static svn_error_t *
+bench_diff(apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_stringbuf_t *original, *modified;
+  const svn_string_t *left, *right;
+  const svn_diff_file_options_t *options
+    = svn_diff_file_options_create(pool);
+  apr_uint64_t ops = 0, bytes = 0;
+  apr_time_t started;
+  int i;
+
+  make_texts(&original, &modified, 20, pool);
+  left = svn_stringbuf__morph_into_string(original);
+  right = svn_stringbuf__morph_into_string(modified);
+
+  started = apr_time_now();
+  for (i = 0; i < 50; ++i)
+    {
+      svn_diff_t *diff;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_diff_mem_string_diff(&diff, left, right, options,
+                                       iterpool));
+      ++ops;
+      bytes += left->len + right->len;
+    }
+
+  report("diff (lcs)", ops, bytes, apr_time_now() - started);
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Benchmark svn_skel__parse() on a proplist-sized skel. */
+static svn_error_t *
+bench_skel_parse(apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_skel_t *skel = svn_skel__make_empty_list(pool);
+  svn_stringbuf_t *unparsed;
+  apr_uint64_t ops = 0, bytes = 0;
+  apr_time_t started;
+  int i;
+
+  /* A list of 64 name / value atom pairs, roughly what a node's
+   * property list looks like on disk. */
+  for (i = 0; i < 64; ++i)
+    {
+      svn_skel__prepend_str(apr_psprintf(pool, "value-%d-abcdefghij", i),
+                            skel, pool);
+      svn_skel__prepend_str(apr_psprintf(pool, "svn:property-%d", i),
+                            skel, pool);
+    }
+  unparsed = svn_skel__unparse(skel, pool);
+
+  started = apr_time_now();
+  for (i = 0; i < 100000; ++i)
+    {
+      svn_skel_t *parsed;
+
+      svn_pool_clear(iterpool);
+      parsed = svn_skel__parse(unparsed->data, unparsed->len, iterpool);
+      if (parsed == NULL)
+        return svn_error_create(SVN_ERR_FS_MALFORMED_SKEL, NULL,
+                                "unparsed skel did not parse back");
+      ++ops;
+      bytes += unparsed->len;
+    }
+
+  report("skel_parse", ops, bytes, apr_time_now() - started);
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Benchmark UTF-8 validation over pure ASCII and over mixed multi-byte
+ * data; the former hits the accelerated all-ASCII path. */
+static svn_error_t *
+bench_utf_validate(apr_pool_t *pool)
+{
+  char *ascii = apr_palloc(pool, TEXT_SIZE);
+  char *mixed = apr_palloc(pool, TEXT_SIZE);
+  apr_uint32_t state = 4711;
+  apr_uint64_t ops, bytes;
+  apr_time_t started;
+  apr_size_t i;
+  int k;
+
+  for (i = 0; i < TEXT_SIZE; ++i)
+    ascii[i] = (char)(' ' + prng_next(&state) % 94);
+
+  memcpy(mixed, ascii, TEXT_SIZE);
+  for (i = 0; i + 1 < TEXT_SIZE; i += 64)
+    {
+      /* U+00Ax, a two-byte sequence. */
+      mixed[i] = (char)0xc2;
+      mixed[i + 1] = (char)(0xa0 + prng_next(&state) % 32);
+    }
+
+  ops = bytes = 0;
+  started = apr_time_now();
+  for (k = 0; k < 500; ++k)
+    {
+      if (!svn_utf__is_valid(ascii, TEXT_SIZE))
+        return svn_error_create(SVN_ERR_BASE, NULL, "ASCII flagged invalid");
+      ++ops;
+      bytes += TEXT_SIZE;
+    }
+  report("utf_validate (ascii)", ops, bytes, apr_time_now() - started);
+
+  ops = bytes = 0;
+  started = apr_time_now();
+  for (k = 0; k < 500; ++k)
+    {
+      if (!svn_utf__is_valid(mixed, TEXT_SIZE))
+        return svn_error_create(SVN_ERR_BASE, NULL, "UTF-8 flagged invalid");
+      ++ops;
+      bytes += TEXT_SIZE;
+    }
+  report("utf_validate (mixed)", ops, bytes, apr_time_now() - started);
+
+  return SVN_NO_ERROR;
+}
+
+/* Benchmark membuffer cache get and set on a 16MB cache holding 1024
+ * entries of 256 bytes each.  Values pass through the cache as
+ * svn_stringbuf_t, i.e. without serialization overhead, so this
+ * measures the cache machinery itself. */
+static svn_error_t *
+bench_membuffer(apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_membuffer_t *membuffer;
+  svn_cache__t *cache;
+  svn_stringbuf_t *value = svn_stringbuf_create_ensure(256, pool);
+  apr_uint32_t state = 1234;
+  apr_uint64_t ops, bytes;
+  apr_time_t started;
+  int i;
+
+  while (value->len < 256)
+    svn_stringbuf_appendbyte(value, (char)(' ' + prng_next(&state) % 94));
+
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 16 * 1024 * 1024,
+                                            16 * 1024, 1, FALSE, TRUE,
+                                            pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(&cache, membuffer, NULL, NULL,
+                                            sizeof(apr_uint32_t), "bench:",
+                                            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                            FALSE, FALSE, pool, pool));
+
+  ops = bytes = 0;
+  started = apr_time_now();
+  for (i = 0; i < 100000; ++i)
+    {
+      apr_uint32_t key = (apr_uint32_t)i % 1024;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_cache__set(cache, &key, value, iterpool));
+      ++ops;
+      bytes += value->len;
+    }
+  report("membuffer set", ops, bytes, apr_time_now() - started);
+
+  ops = bytes = 0;
+  started = apr_time_now();
+  for (i = 0; i < 500000; ++i)
+    {
+      apr_uint32_t key = (apr_uint32_t)i % 1024;
+      svn_stringbuf_t *fetched;
+      svn_boolean_t found;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_cache__get((void **)&fetched, &found, cache, &key,
+                             iterpool));
+      if (!found)
+        return svn_error_create(SVN_ERR_BASE, NULL, "cache entry evicted");
+      ++ops;
+      bytes += fetched->len;
+    }
+  report("membuffer get", ops, bytes, apr_time_now() - started);
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+run_benchmarks(apr_pool_t *pool)
+{
+  apr_pool_t *subpool = svn_pool_create(pool);
+
+  SVN_ERR(bench_txdelta_apply(subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(bench_diff(subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(bench_skel_parse(subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(bench_utf_validate(subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(bench_membuffer(subpool));
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+int main(int argc, const char *argv[])
+{
+  apr_pool_t *pool;
+  svn_error_t *err;
+
+  if (apr_initialize())
+    {
+      fprintf(stderr, "apr_initialize failed\n");
+      exit(EXIT_FAILURE);
+    }
+  pool = svn_pool_create(NULL);
+
+  err = run_benchmarks(pool);
+  if (err)
+    svn_handle_error2(err, stderr, TRUE, "bench-primitives: ");
+
+  svn_pool_destroy(pool);
+  apr_terminate();
+
+  return EXIT_SUCCESS;
+}
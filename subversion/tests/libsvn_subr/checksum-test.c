@@ -91,6 +91,69 @@ test_checksum_empty(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Stream data of various sizes through a checksum context in odd sized
+ * chunks and expect the same digest as from the one-shot interface.
+ * This covers the internal block handling of the (possibly hardware
+ * accelerated) digest implementations.
+ */
+static svn_error_t *
+test_checksum_update(apr_pool_t *pool)
+{
+  static const apr_size_t sizes[] = { 0, 1, 55, 56, 57, 63, 64, 65,
+                                      127, 128, 1000, 65537 };
+  svn_stringbuf_t *data = svn_stringbuf_create_ensure(65537, pool);
+  svn_checksum_kind_t kind;
+  apr_size_t i;
+
+  for (i = 0; i < 65537; ++i)
+    svn_stringbuf_appendbyte(data, (char)(i * 131 + 7));
+
+  /* Anchor the whole scheme against a known SHA-1 test vector. */
+  {
+    svn_checksum_t *expected;
+    svn_checksum_t *actual;
+
+    SVN_ERR(svn_checksum_parse_hex(&expected, svn_checksum_sha1,
+                                   "a9993e364706816aba3e25717850c26c9cd0d89d",
+                                   pool));
+    SVN_ERR(svn_checksum(&actual, svn_checksum_sha1, "abc", 3, pool));
+    SVN_TEST_ASSERT(svn_checksum_match(expected, actual));
+  }
+
+  for (kind = svn_checksum_md5; kind <= svn_checksum_fnv1a_32x4; ++kind)
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+      {
+        const apr_size_t size = sizes[i];
+        svn_checksum_ctx_t *ctx = svn_checksum_ctx_create(kind, pool);
+        svn_checksum_t *expected;
+        svn_checksum_t *actual;
+        apr_size_t offset;
+
+        SVN_ERR(svn_checksum(&expected, kind, data->data, size, pool));
+
+        for (offset = 0; offset < size; )
+          {
+            apr_size_t chunk = (offset % 97) + 1;
+            if (chunk > size - offset)
+              chunk = size - offset;
+
+            SVN_ERR(svn_checksum_update(ctx, data->data + offset, chunk));
+            offset += chunk;
+          }
+
+        SVN_ERR(svn_checksum_final(&actual, ctx, pool));
+        SVN_TEST_ASSERT(svn_checksum_match(expected, actual));
+
+        /* A reset context must produce the same digest again. */
+        SVN_ERR(svn_checksum_ctx_reset(ctx));
+        SVN_ERR(svn_checksum_update(ctx, data->data, size));
+        SVN_ERR(svn_checksum_final(&actual, ctx, pool));
+        SVN_TEST_ASSERT(svn_checksum_match(expected, actual));
+      }
+
+  return SVN_NO_ERROR;
+}
+
 /* Verify that "zero" checksums work properly for the given checksum KIND.
  */
 static svn_error_t *
@@ -375,6 +438,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "checksum parse"),
     SVN_TEST_PASS2(test_checksum_empty,
                    "checksum emptiness"),
+    SVN_TEST_PASS2(test_checksum_update,
+                   "checksum context update in odd sized chunks"),
     SVN_TEST_PASS2(zero_match,
                    "zero checksum matching"),
     SVN_TEST_OPTS_PASS(zlib_expansion_test,
@@ -1229,6 +1229,100 @@ test_rmtree_all_readonly(apr_pool_t *pool)
 }
 
 
+static svn_error_t *
+test_clone_file(apr_pool_t *pool)
+{
+  const char *tmp_dir;
+  const char *src_abspath;
+  const char *dst_abspath;
+  svn_boolean_t cloned;
+  svn_node_kind_t kind;
+  svn_stringbuf_t *actual_content;
+
+  /* Create an empty directory. */
+  SVN_ERR(svn_test_make_sandbox_dir(&tmp_dir, "test_clone_file", pool));
+
+  src_abspath = svn_dirent_join(tmp_dir, "source", pool);
+  SVN_ERR(svn_io_file_create(src_abspath, "source content", pool));
+  SVN_ERR(svn_io_set_file_read_only(src_abspath, FALSE, pool));
+
+  /* The destination's parent does not exist yet; cloning should create
+     it, like svn_stream__install_stream() does. */
+  dst_abspath = svn_dirent_join(tmp_dir, "sub/clone", pool);
+
+  SVN_ERR(svn_io__clone_file(&cloned, dst_abspath, src_abspath,
+                             tmp_dir, pool));
+
+  if (cloned)
+    {
+      /* The clone must read back as a normal, writable copy. */
+      SVN_ERR(svn_stringbuf_from_file2(&actual_content, dst_abspath, pool));
+      SVN_TEST_STRING_ASSERT(actual_content->data, "source content");
+
+      SVN_ERR(svn_io_file_create(dst_abspath, "modified", pool));
+      SVN_ERR(svn_stringbuf_from_file2(&actual_content, src_abspath, pool));
+      SVN_TEST_STRING_ASSERT(actual_content->data, "source content");
+    }
+  else
+    {
+      /* Not supported here; the destination must be left untouched. */
+      SVN_ERR(svn_io_check_path(dst_abspath, &kind, pool));
+      SVN_TEST_ASSERT(kind == svn_node_none);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+static svn_error_t *
+test_copy_file_differential(apr_pool_t *pool)
+{
+  const char *tmp_dir;
+  const char *src_abspath;
+  const char *dst_abspath;
+  svn_boolean_t patched;
+  svn_stringbuf_t *actual_content;
+
+  SVN_ERR(svn_test_make_sandbox_dir(&tmp_dir, "test_copy_file_differential",
+                                    pool));
+
+  src_abspath = svn_dirent_join(tmp_dir, "source", pool);
+  dst_abspath = svn_dirent_join(tmp_dir, "dest", pool);
+
+  /* A missing destination must result in a clean refusal. */
+  SVN_ERR(svn_io_file_create(src_abspath, "new content", pool));
+  SVN_ERR(svn_io__copy_file_differential(&patched, dst_abspath, src_abspath,
+                                         pool));
+  SVN_TEST_ASSERT(!patched);
+
+  /* Patching a longer destination must truncate it. */
+  SVN_ERR(svn_io_file_create(dst_abspath, "old content, and then some",
+                             pool));
+  SVN_ERR(svn_io__copy_file_differential(&patched, dst_abspath, src_abspath,
+                                         pool));
+  SVN_TEST_ASSERT(patched);
+  SVN_ERR(svn_stringbuf_from_file2(&actual_content, dst_abspath, pool));
+  SVN_TEST_STRING_ASSERT(actual_content->data, "new content");
+
+  /* Patching a shorter destination must extend it. */
+  SVN_ERR(svn_io_file_create(dst_abspath, "short", pool));
+  SVN_ERR(svn_io__copy_file_differential(&patched, dst_abspath, src_abspath,
+                                         pool));
+  SVN_TEST_ASSERT(patched);
+  SVN_ERR(svn_stringbuf_from_file2(&actual_content, dst_abspath, pool));
+  SVN_TEST_STRING_ASSERT(actual_content->data, "new content");
+
+  /* Identical content must be a no-op that still reports success. */
+  SVN_ERR(svn_io__copy_file_differential(&patched, dst_abspath, src_abspath,
+                                         pool));
+  SVN_TEST_ASSERT(patched);
+  SVN_ERR(svn_stringbuf_from_file2(&actual_content, dst_abspath, pool));
+  SVN_TEST_STRING_ASSERT(actual_content->data, "new content");
+
+  return SVN_NO_ERROR;
+}
+
+
 /* The test table.  */
 
 static int max_threads = 3;
@@ -1274,6 +1368,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test svn_io_remove_dir2() with read-only directory"),
     SVN_TEST_PASS2(test_rmtree_all_readonly,
                    "test svn_io_remove_dir2() with read-only tree"),
+    SVN_TEST_PASS2(test_clone_file,
+                   "test svn_io__clone_file()"),
+    SVN_TEST_PASS2(test_copy_file_differential,
+                   "test svn_io__copy_file_differential()"),
     SVN_TEST_NULL
   };
 
@@ -2481,6 +2481,28 @@ test_mergeinfo_merge_random_non_validated_inputs(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_parse_cached(apr_pool_t *pool)
+{
+  const char *input = "/trunk:5-9,13,17-20\n/branches/b1*:21-30";
+  svn_mergeinfo_t parsed, cached_1st, cached_2nd;
+  svn_boolean_t is_equal;
+
+  SVN_ERR(svn_mergeinfo_parse(&parsed, input, pool));
+
+  /* The first call typically populates the cache, the second one reads
+     back the compact binary form; both must match the plain parse. */
+  SVN_ERR(svn_mergeinfo__parse_cached(&cached_1st, input, pool, pool));
+  SVN_ERR(svn_mergeinfo__parse_cached(&cached_2nd, input, pool, pool));
+
+  SVN_ERR(svn_mergeinfo__equals(&is_equal, parsed, cached_1st, TRUE, pool));
+  SVN_TEST_ASSERT(is_equal);
+  SVN_ERR(svn_mergeinfo__equals(&is_equal, parsed, cached_2nd, TRUE, pool));
+  SVN_TEST_ASSERT(is_equal);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -2540,6 +2562,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test rangelist merge random non-validated inputs"),
     SVN_TEST_PASS2(test_mergeinfo_merge_random_non_validated_inputs,
                    "test mergeinfo merge random non-validated inputs"),
+    SVN_TEST_PASS2(test_parse_cached,
+                   "cached mergeinfo parsing"),
     SVN_TEST_NULL
   };
 
@@ -98,7 +98,8 @@ test_spillbuf_basic_spill_all(apr_pool_t *pool)
 {
   apr_size_t len = strlen(basic_data);  /* Don't include basic_data's NUL  */
   svn_spillbuf_t *buf =
-    svn_spillbuf__create_extended(len, 10 * len, TRUE, TRUE, NULL, pool);
+    svn_spillbuf__create_extended(len, 10 * len, TRUE, TRUE, FALSE,
+                                  NULL, pool);
   return test_spillbuf__basic(pool, len, buf);
 }
 
@@ -161,6 +162,7 @@ test_spillbuf_callback_spill_all(apr_pool_t *pool)
                           10 * sizeof(basic_data) /* maxsize */,
                           TRUE /* delte on close */,
                           TRUE /* spill all data */,
+                          FALSE /* mmap readback */,
                           NULL, pool);
   return test_spillbuf__callback(pool, buf);
 }
@@ -249,6 +251,7 @@ test_spillbuf_file_spill_all(apr_pool_t *pool)
                           2 * sizeof(basic_data)  /* maxsize */,
                           TRUE /* delte on close */,
                           TRUE /* spill all data */,
+                          FALSE /* mmap readback */,
                           NULL, pool);
   return test_spillbuf__file(pool, altsize, buf);
 }
@@ -300,6 +303,7 @@ test_spillbuf_interleaving_spill_all(apr_pool_t *pool)
                           15 /* maxsize */,
                           TRUE /* delte on close */,
                           TRUE /* spill all data */,
+                          FALSE /* mmap readback */,
                           NULL, pool);
   return test_spillbuf__interleaving(pool, buf);
 }
@@ -435,6 +439,7 @@ test_spillbuf_rwfile_spill_all(apr_pool_t *pool)
                           10 /* maxsize */,
                           TRUE /* delte on close */,
                           TRUE /* spill all data */,
+                          FALSE /* mmap readback */,
                           NULL, pool);
   return test_spillbuf__rwfile(pool, buf);
 }
@@ -506,6 +511,7 @@ test_spillbuf_eof_spill_all(apr_pool_t *pool)
                           10 /* maxsize */,
                           TRUE /* delte on close */,
                           TRUE /* spill all data */,
+                          FALSE /* mmap readback */,
                           NULL, pool);
   return test_spillbuf__eof(pool, buf);
 }
@@ -554,10 +560,105 @@ test_spillbuf_file_attrs_spill_all(apr_pool_t *pool)
                           10 /* maxsize */,
                           TRUE /* delte on close */,
                           TRUE /* spill all data */,
+                          FALSE /* mmap readback */,
                           NULL, pool);
   return test_spillbuf__file_attrs(pool, TRUE, buf);
 }
 
+static svn_error_t *
+test_spillbuf_mmap(apr_pool_t *pool)
+{
+  apr_size_t len = strlen(basic_data);  /* Don't include basic_data's NUL  */
+  svn_spillbuf_t *buf = svn_spillbuf__create_extended(
+                          len /* blocksize */,
+                          10 * len /* maxsize */,
+                          TRUE /* delete on close */,
+                          FALSE /* spill all data */,
+                          TRUE /* mmap readback */,
+                          NULL, pool);
+  int cycle;
+
+  /* Write and drain the buffer twice, so that the second cycle runs
+     against a freshly-created spill file after the readback window of
+     the first file has been dropped.  */
+  for (cycle = 0; cycle < 2; cycle++)
+    {
+      svn_filesize_t remaining;
+      int i;
+
+      for (i = 20; i--; )
+        SVN_ERR(svn_spillbuf__write(buf, basic_data, len, pool));
+
+      /* Drain the buffer, verifying the content as it arrives.  The
+         chunks handed out may be (much) larger than the blocksize when
+         the mmap window is in use, so verify against the read position
+         rather than assuming a fixed chunking.  */
+      remaining = svn_spillbuf__get_size(buf);
+      SVN_TEST_ASSERT(remaining == 20 * (svn_filesize_t)len);
+      while (remaining > 0)
+        {
+          const char *readptr;
+          apr_size_t readlen;
+          apr_size_t pos = (apr_size_t)(20 * (svn_filesize_t)len - remaining);
+
+          SVN_ERR(svn_spillbuf__read(&readptr, &readlen, buf, pool));
+          SVN_TEST_ASSERT(readptr != NULL && readlen > 0);
+          for (i = 0; i < (int)readlen; i++)
+            SVN_TEST_ASSERT(readptr[i] == basic_data[(pos + i) % len]);
+          remaining -= readlen;
+        }
+
+      SVN_TEST_ASSERT(svn_spillbuf__get_size(buf) == 0);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_spillbuf_read_iovec(apr_pool_t *pool)
+{
+  svn_spillbuf_t *buf = svn_spillbuf__create_extended(
+                          4 /* blocksize */,
+                          10 /* maxsize */,
+                          TRUE /* delete on close */,
+                          FALSE /* spill all data */,
+                          TRUE /* mmap readback */,
+                          NULL, pool);
+  struct iovec vecs[2];
+  char actual[18];
+  apr_size_t pos = 0;
+
+  SVN_ERR(svn_spillbuf__write(buf, "abcdef", 6, pool));
+  SVN_ERR(svn_spillbuf__write(buf, "ghijkl", 6, pool));
+  SVN_ERR(svn_spillbuf__write(buf, "mnopqr", 6, pool));
+  /* now: two blocks: 4 and 2 bytes, and 12 bytes in spill file.  */
+
+  /* Gather everything, two chunks at a time. All chunks within one
+     batch must be valid at the same time.  */
+  while (TRUE)
+    {
+      int nvecs = 2;
+      int i;
+
+      SVN_ERR(svn_spillbuf__read_iovec(vecs, &nvecs, buf, pool));
+      if (nvecs == 0)
+        break;
+      SVN_TEST_ASSERT(nvecs <= 2);
+      for (i = 0; i < nvecs; i++)
+        {
+          SVN_TEST_ASSERT(pos + vecs[i].iov_len <= sizeof(actual));
+          memcpy(actual + pos, vecs[i].iov_base, vecs[i].iov_len);
+          pos += vecs[i].iov_len;
+        }
+    }
+
+  SVN_TEST_ASSERT(pos == 18
+                  && memcmp(actual, "abcdefghijklmnopqr", 18) == 0);
+  SVN_TEST_ASSERT(svn_spillbuf__get_size(buf) == 0);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 1;
@@ -589,6 +690,9 @@ static struct svn_test_descriptor_t test_funcs[] =
     SVN_TEST_PASS2(test_spillbuf_file_attrs, "check spill file properties"),
     SVN_TEST_PASS2(test_spillbuf_file_attrs_spill_all,
                    "check spill file properties (spill-all-data)"),
+    SVN_TEST_PASS2(test_spillbuf_mmap,
+                   "read back through a memory-mapped window"),
+    SVN_TEST_PASS2(test_spillbuf_read_iovec, "vectored read"),
     SVN_TEST_NULL
   };
 
@@ -79,6 +79,8 @@ static const int schema_statements[] =
   STMT_CREATE_REVERT_LIST,
   STMT_CREATE_DELETE_LIST,
   STMT_CREATE_UPDATE_MOVE_LIST,
+  /* On-demand tables */
+  STMT_CREATE_CHANGE_JOURNAL,
   -1 /* final marker */
 };
 
@@ -109,6 +111,7 @@ static const int slow_statements[] =
    * STMT_DELETE_PRISTINE_IF_UNREFERENCED,
    */
   STMT_HAVE_STAT1_TABLE, /* Queries sqlite_master which has no index */
+  STMT_HAVE_CHANGE_JOURNAL_TABLE, /* Queries sqlite_master too */
 
   -1 /* final marker */
 };
@@ -122,6 +125,7 @@ static const int primary_key_statements[] =
      and primary key instead of adding a list? */
   STMT_LOOK_FOR_WORK,
   STMT_SELECT_WORK_ITEM,
+  STMT_SELECT_WORK_ITEMS,
 
   -1 /* final marker */
 };